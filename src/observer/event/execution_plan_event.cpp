@@ -1,5 +1,6 @@
 #include "event/execution_plan_event.h"
 #include "event/sql_event.h"
+#include "sql/plan_cache/plan_cache.h"
 
 ExecutionPlanEvent::ExecutionPlanEvent(SQLStageEvent *sql_event, Query *sqls) : sql_event_(sql_event), sqls_(sqls) {
 }
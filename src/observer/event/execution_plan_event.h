@@ -1,10 +1,13 @@
 #ifndef __OBSERVER_EVENT_EXECUTION_PLAN_EVENT_H__
 #define __OBSERVER_EVENT_EXECUTION_PLAN_EVENT_H__
 
+#include <memory>
+
 #include "common/seda/stage_event.h"
 #include "sql/parser/parse.h"
 
 class SQLStageEvent;
+class CachedPlan;
 
 class ExecutionPlanEvent : public common::StageEvent {
 public:
@@ -18,9 +21,18 @@ public:
   SQLStageEvent * sql_event() const {
     return sql_event_;
   }
+
+  // sqls来自计划缓存时，对应的缓存项
+  const std::shared_ptr<CachedPlan> &cached_plan() const {
+    return cached_plan_;
+  }
+  void set_cached_plan(const std::shared_ptr<CachedPlan> &cached_plan) {
+    cached_plan_ = cached_plan;
+  }
 private:
   SQLStageEvent *      sql_event_;
   Query *             sqls_;
+  std::shared_ptr<CachedPlan> cached_plan_;
 };
 
 #endif // __OBSERVER_EVENT_EXECUTION_PLAN_EVENT_H__
\ No newline at end of file
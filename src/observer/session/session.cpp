@@ -20,7 +20,8 @@ Session &Session::default_session() {
   return session;
 }
 
-Session::Session(const Session &other) : current_db_(other.current_db_){
+Session::Session(const Session &other) : current_db_(other.current_db_), parallel_degree_(other.parallel_degree_),
+    sort_buffer_size_(other.sort_buffer_size_), index_key_compress_(other.index_key_compress_){
 }
 
 Session::~Session() {
@@ -43,6 +44,46 @@ bool Session::is_trx_multi_operation_mode() const {
   return trx_multi_operation_mode_;
 }
 
+void Session::set_parallel_degree(int parallel_degree) {
+  parallel_degree_ = parallel_degree;
+}
+
+int Session::parallel_degree() const {
+  return parallel_degree_;
+}
+
+void Session::set_sort_buffer_size(int sort_buffer_size) {
+  sort_buffer_size_ = sort_buffer_size;
+}
+
+int Session::sort_buffer_size() const {
+  return sort_buffer_size_;
+}
+
+void Session::set_index_key_compress(bool index_key_compress) {
+  index_key_compress_ = index_key_compress;
+}
+
+bool Session::index_key_compress() const {
+  return index_key_compress_;
+}
+
+std::shared_ptr<PreparedStatement> Session::find_prepared_statement(const std::string &name) const {
+  auto iter = prepared_statements_.find(name);
+  if (iter == prepared_statements_.end()) {
+    return nullptr;
+  }
+  return iter->second;
+}
+
+void Session::set_prepared_statement(const std::string &name, const std::shared_ptr<PreparedStatement> &statement) {
+  prepared_statements_[name] = statement;
+}
+
+bool Session::remove_prepared_statement(const std::string &name) {
+  return prepared_statements_.erase(name) > 0;
+}
+
 Trx *Session::current_trx() {
   if (trx_ == nullptr) {
     trx_ = new Trx;
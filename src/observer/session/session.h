@@ -1,9 +1,12 @@
 #ifndef __OBSERVER_SESSION_SESSION_H__
 #define __OBSERVER_SESSION_SESSION_H__
 
+#include <memory>
 #include <string>
+#include <unordered_map>
 
 class Trx;
+class PreparedStatement;
 
 class Session {
 public:
@@ -25,10 +28,43 @@ public:
 
   Trx * current_trx();
 
+  /**
+   * 查询内的并行度，1表示不并行。通过 set parallel_degree = n 设置
+   */
+  void set_parallel_degree(int parallel_degree);
+  int parallel_degree() const;
+
+  /**
+   * 排序可以使用的内存(字节)，超过后把有序的run写到临时文件再归并。通过 set sort_buffer_size = n 设置
+   */
+  void set_sort_buffer_size(int sort_buffer_size);
+  int sort_buffer_size() const;
+
+  /**
+   * 之后创建的CHARS类型B+树索引是否对key做前缀压缩。通过 set index_key_compress = 0/1 设置，
+   * 只影响新建的索引，已有索引的格式记录在索引文件头中
+   */
+  void set_index_key_compress(bool index_key_compress);
+  bool index_key_compress() const;
+
+  /**
+   * PREPARE创建的预处理语句，名字相同时替换原来的语句，会话结束时释放
+   */
+  std::shared_ptr<PreparedStatement> find_prepared_statement(const std::string &name) const;
+  void set_prepared_statement(const std::string &name, const std::shared_ptr<PreparedStatement> &statement);
+  bool remove_prepared_statement(const std::string &name);
+
+public:
+  static const int DEFAULT_SORT_BUFFER_SIZE = 64 * 1024 * 1024;
+
 private:
   std::string  current_db_;
   Trx         *trx_ = nullptr;
   bool         trx_multi_operation_mode_ = false; // 当前事务的模式，是否多语句模式. 单语句模式自动提交
+  int          parallel_degree_ = 1;
+  int          sort_buffer_size_ = DEFAULT_SORT_BUFFER_SIZE;
+  bool         index_key_compress_ = false;
+  std::unordered_map<std::string, std::shared_ptr<PreparedStatement>> prepared_statements_;
 };
 
 #endif // __OBSERVER_SESSION_SESSION_H__
\ No newline at end of file
@@ -1,54 +1,126 @@
 #include "agg_executor.h"
 #include "storage/common/table.h"
 #include "aggregate_execution_node.h"
+#include "scan_executor.h"
 
 AggExecutor::AggExecutor(ExecutorContext* context, const TupleSchema &output_schema,
                          Executor* executor):Executor(context, output_schema), executor_(executor) {};
 
-RC AggExecutor::init() {
+RC AggExecutor::do_init() {
   aht_.init(output_schema_.Get_agg_descs());
   return executor_->init();
 }
+void AggExecutor::build_index(TupleSchema &left_tuple_schema, std::vector<int> &key_index,
+                              std::vector<int> &value_index) {
+  const std::map<std::string, std::map<std::string, int>> &field_index = left_tuple_schema.table_field_index();
+  key_index.clear();
+  value_index.clear();
+  for (const auto &field : output_schema_.fields()) {
+    key_index.push_back(field_index.at(field.table_name()).at(field.field_name()));
+  }
+  for (const auto &agg_desc : output_schema_.Get_agg_descs()) {
+    if (agg_desc->is_attr) {
+      // agg(relation_name,attr_name)
+      value_index.push_back(field_index.at(agg_desc->relation_name).at(agg_desc->attr_name));
+    } else {
+      // agg(*)
+      // agg(12.3)
+      value_index.push_back(-1);
+    }
+  }
+}
+
 // build schema after filter and use this schema to build output tuple_set
-RC AggExecutor::next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
+RC AggExecutor::do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
   tuple_set.clear();
   tuple_set.set_schema(output_schema_);
 
-  TupleSet left_tuple_set;
-  executor_->next(left_tuple_set, filters);
-  TupleSchema left_output_schema = executor_->output_schema();
-  aht_.clear();
-  for (const auto &tuple : left_tuple_set.tuples()) {
-    AggregateKey agg_key = MakeKey(left_output_schema, &tuple);
-    AggregateValue agg_val = MakeVal(left_output_schema, &tuple);
-    aht_.InsertCombine(agg_key, agg_val);
+  RC rc;
+  if (!built_) {
+    aht_.clear();
+    rc = aggregate_child(filters);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    aht_.sort_groups();
+    output_pos_ = 0;
+    built_ = true;
   }
-  aht_iterator_ = aht_.Begin();
-  while (aht_iterator_ != aht_.End()) {
+
+  while (output_pos_ < aht_.group_count() && tuple_set.size() < BATCH_SIZE) {
     Tuple output_tuple;
-    const AggregateKey &agg_key = aht_iterator_.Key();
-    const AggregateValue &agg_val = aht_iterator_.Val();
+    aht_.output(output_pos_++, output_tuple);
+    tuple_set.add(std::move(output_tuple));
+  }
+  return tuple_set.size() > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+}
 
-    for(int i = 0; i < agg_key.group_bys_.size(); i++) {
-      output_tuple.add(agg_key.group_bys_[i]);
+RC AggExecutor::aggregate_child(std::vector<Filter*> *filters) {
+  std::vector<int> key_index;
+  std::vector<int> value_index;
+  int parallel_degree = exe_ctx_->parallel_degree();
+  // 子节点是可以并行的表扫描时，扫描线程直接做局部聚合，不经过next
+  ScanExecutor *scan_executor = dynamic_cast<ScanExecutor *>(executor_);
+  if (parallel_degree > 1 && scan_executor != nullptr) {
+    TupleSchema scan_schema = scan_executor->output_schema();
+    build_index(scan_schema, key_index, value_index);
+    ParallelAggregator aggregator(aht_, parallel_degree);
+    bool fused = false;
+    RC rc = scan_executor->aggregate_parallel(filters, aggregator, key_index, value_index, fused);
+    if (rc != RC::SUCCESS) {
+      return rc;
     }
-    for (int i = 0; i < agg_val.aggregates_.size(); i++) {
-      if (output_schema_.Get_agg_descs()[i]->aggre_type == AggreType::AVGS
-      && agg_val.aggregates_[i]->Type() != AttrType::UNDEFINED) {
-        float avg = agg_val.aggregates_[i]->value() / agg_val.count_[i];
-        output_tuple.add(new FloatValue(avg));
-      } else {
-        output_tuple.add(agg_val.aggregates_[i]);
-      }
+    if (fused) {
+      aggregator.finish();
+      return RC::SUCCESS;
     }
-    tuple_set.add(std::move(output_tuple));
+    key_index.clear();
+    value_index.clear();
+  }
 
-    ++(aht_iterator_);
+  RC rc;
+  TupleSet left_tuple_set;
+  std::unique_ptr<ParallelAggregator> aggregator;
+  std::vector<Tuple> buffer;  // 并行聚合时攒够一批再分给各个线程
+  while ((rc = executor_->next(left_tuple_set, filters)) == RC::SUCCESS) {
+    if (key_index.empty() && value_index.empty()) {
+      build_index(left_tuple_set.get_schema(), key_index, value_index);
+    }
+    if (parallel_degree <= 1) {
+      for (const auto &tuple : left_tuple_set.tuples()) {
+        aht_.insert_combine(tuple, key_index, value_index);
+      }
+      continue;
+    }
+    for (auto &tuple : left_tuple_set.tuples()) {
+      buffer.push_back(std::move(tuple));
+    }
+    if (buffer.size() >= PARALLEL_BUFFER_SIZE) {
+      if (aggregator == nullptr) {
+        aggregator.reset(new ParallelAggregator(aht_, parallel_degree));
+      }
+      aggregator->aggregate(buffer, key_index, value_index);
+      buffer.clear();
+    }
+  }
+  if (rc != RC::RECORD_EOF) {
+    return rc;
+  }
+  for (const auto &tuple : buffer) {
+    aht_.insert_combine(tuple, key_index, value_index);
+  }
+  if (aggregator != nullptr) {
+    aggregator->finish();
   }
-  
   return RC::SUCCESS;
 }
 
+RC AggExecutor::rewind() {
+  built_ = false;
+  aht_.clear();
+  return executor_->rewind();
+}
+
 // add group_by and aggre_descs
 RC AggExecutor::build_agg_output_schema(Db *db, Selects *selects, TupleSchema &schema) {
   assert(selects->aggre_num > 0);
@@ -118,7 +190,8 @@ RC AggExecutor::build_agg_output_schema(Db *db, Selects *selects, TupleSchema &s
   for (int i = 0; i < selects->group_num; i++) {
     if (selects->group_bys[i].relation_name == nullptr) {
       if (selects->relation_num == 1) {
-        selects->group_bys[i].relation_name = selects->relations[0];
+        // query释放时group by字段和relations[0]分别释放
+        selects->group_bys[i].relation_name = strdup(selects->relations[0]);
       } else {
         return RC::INTERNAL;
       }
@@ -131,3 +204,12 @@ RC AggExecutor::build_agg_output_schema(Db *db, Selects *selects, TupleSchema &s
 }
 
 
+
+void AggExecutor::describe(ExplainNode &node) {
+  node.name = "HashAggregate";
+  node.detail = schema_to_string(output_schema_);
+}
+
+std::vector<Executor *> AggExecutor::children() {
+  return {executor_};
+}
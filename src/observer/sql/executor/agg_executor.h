@@ -12,49 +12,39 @@ public:
 
   ~AggExecutor() = default;
 
-  RC init() override;
-
-  RC next(TupleSet &tuple_set, std::vector<Filter*> *filters = nullptr) override;
-
-  /** @return the tuple as an AggregateKey */
-  AggregateKey MakeKey(TupleSchema &left_tuple_schema, const Tuple *tuple) {
-    std::vector<std::shared_ptr<TupleValue>> keys;
-    for (const auto &field : output_schema_.fields()) {
-      int index = left_tuple_schema.table_field_index().at(field.table_name()).at(field.field_name());
-      keys.emplace_back(tuple->values()[index]);
-    }
-    return {keys};
-  }
-
-  /** @return the tuple as an AggregateValue */
-  AggregateValue MakeVal(TupleSchema &left_tuple_schema, const Tuple *tuple) {
-    std::vector<std::shared_ptr<TupleValue>> vals;
-    std::vector<int> counts(output_schema_.Get_agg_descs().size(), 1);
-    for (int i = 0 ; i < output_schema_.Get_agg_descs().size(); i++) {
-      const AggreDesc *agg_desc = output_schema_.Get_agg_descs()[i].get();
-      if (agg_desc->is_attr) {
-        // agg(relation_name,attr_name)
-        char *table_name = agg_desc->relation_name;
-        int index = left_tuple_schema.table_field_index().at(table_name).at(agg_desc->attr_name);
-        vals.emplace_back(tuple->values()[index]);
-      } else {
-        // agg(*)
-        // agg(12.3)
-        vals.emplace_back(new FloatValue(agg_desc->value));
-      }
-    }
-    return {vals, counts};
-  }
+  RC rewind() override;
 
   static RC build_agg_output_schema(Db *db, Selects *selects, TupleSchema &schema);
 
+public:
+  // 并行度大于1时，子节点的输出每攒够这么多条交给ParallelAggregator
+  static const size_t PARALLEL_BUFFER_SIZE = 64 * 1024;
+
+protected:
+  RC do_init() override;
+  /**
+   * 第一次调用时把子节点的所有批次聚合到hash表中，之后按批输出各个分组
+   */
+  RC do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) override;
+  void describe(ExplainNode &node) override;
+  std::vector<Executor *> children() override;
+
+private:
+  /**
+   * 把子节点的全部结果聚合到aht_中。并行度大于1时分给多个线程，子节点是表扫描时与扫描融合
+   */
+  RC aggregate_child(std::vector<Filter*> *filters);
+  /**
+   * group by字段和各个聚合函数的输入在子节点输出中的下标，聚合函数的输入为常量时是-1
+   */
+  void build_index(TupleSchema &left_tuple_schema, std::vector<int> &key_index, std::vector<int> &value_index);
+
 private:
 
   Executor *executor_;
-  /** Simple aggregation hash table. */
-  SimpleAggregationHashTable aht_{};
-  /** Simple aggregation hash table iterator. */
-  SimpleAggregationHashTable::Iterator aht_iterator_;
+  bool built_ = false;
+  AggregationHashTable aht_;
+  int output_pos_ = 0;  // 下一个要输出的分组
 };
 
 
@@ -10,37 +10,69 @@ RC AggregationExeNode::init(Trx *trx, Table *table, TupleSchema &&group_bys, Tup
 	return RC::SUCCESS;
 }
 
+void AggregationExeNode::build_index(std::vector<int> &key_index, std::vector<int> &value_index) {
+  const std::map<std::string, std::map<std::string, int>> &field_index = tuple_set_.get_schema().table_field_index();
+  for (const auto &field : group_bys_.fields()) {
+    key_index.push_back(field_index.at(field.table_name()).at(field.field_name()));
+  }
+  for (const auto &agg_desc : agg_descs_) {
+    if (agg_desc->is_attr) {
+      // agg(relation_name,attr_name)
+      const char *table_name = agg_desc->relation_name;
+      if (table_name == nullptr) {
+        table_name = table_->table_meta().name();
+      }
+      value_index.push_back(field_index.at(table_name).at(agg_desc->attr_name));
+    } else {
+      // agg(*)
+      // agg(12.3)
+      value_index.push_back(-1);
+    }
+  }
+}
+
 RC AggregationExeNode::execute(TupleSet &output_tuple_set) {
   output_tuple_set.clear();
   output_tuple_set.set_schema(group_bys_);
-  std::vector<Tuple> &tuples = const_cast<std::vector<Tuple> &>(tuple_set_.tuples());
-	for (const Tuple &tuple : tuples) {
-    AggregateKey agg_key = MakeKey(&tuple);
-    AggregateValue agg_val = MakeVal(&tuple);
-    aht_.InsertCombine(agg_key, agg_val);
-	}
-	aht_iterator_ = aht_.Begin();
-	while (aht_iterator_ != aht_.End()) {
-    Tuple output_tuple;
-    const AggregateKey &agg_key = aht_iterator_.Key();
-    const AggregateValue &agg_val = aht_iterator_.Val();
-
-    for(int i = 0; i < agg_key.group_bys_.size(); i++) {
-      output_tuple.add(agg_key.group_bys_[i]);
+  std::vector<int> key_index;
+  std::vector<int> value_index;
+  build_index(key_index, value_index);
+  if (source_ != nullptr) {
+    bool fused = false;
+    if (parallel_degree_ > 1) {
+      ParallelAggregator aggregator(aht_, parallel_degree_);
+      RC rc = source_->aggregate_parallel(aggregator, key_index, value_index, fused, input_rows_);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      if (fused) {
+        aggregator.finish();
+      }
     }
-		for (int i = 0; i < agg_val.aggregates_.size(); i++) {
-			if (agg_descs_[i]->aggre_type == AggreType::AVGS 
-          && agg_val.aggregates_[i]->Type() != AttrType::UNDEFINED) {
-				float avg = agg_val.aggregates_[i]->value() / agg_val.count_[i];
-				output_tuple.add(new FloatValue(avg));
-			} else {
-				output_tuple.add(agg_val.aggregates_[i]);
-			}
-		}
-		output_tuple_set.add(std::move(output_tuple));
-
-		++(aht_iterator_);
-	}
-  
-	return RC::SUCCESS;
-}
\ No newline at end of file
+    if (!fused) {
+      RC rc = source_->execute(tuple_set_);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      input_rows_ = tuple_set_.size();
+    }
+  } else {
+    input_rows_ = tuple_set_.size();
+  }
+  if (parallel_degree_ > 1 && tuple_set_.size() > ParallelAggregator::MORSEL_TUPLES) {
+    ParallelAggregator aggregator(aht_, parallel_degree_);
+    aggregator.aggregate(tuple_set_.tuples(), key_index, value_index);
+    aggregator.finish();
+  } else {
+    for (const Tuple &tuple : tuple_set_.tuples()) {
+      aht_.insert_combine(tuple, key_index, value_index);
+    }
+  }
+  aht_.sort_groups();
+  for (int i = 0; i < aht_.group_count(); i++) {
+    Tuple output_tuple;
+    aht_.output(i, output_tuple);
+    output_tuple_set.add(std::move(output_tuple));
+  }
+  return RC::SUCCESS;
+}
@@ -0,0 +1,505 @@
+#include <string.h>
+#include <algorithm>
+
+#include "sql/executor/aggregation_hash_table.h"
+#include "storage/common/table.h"
+#include "util/worker_pool.h"
+
+// key中每个group by值的第一个字节
+static const char KEY_NULL = 'N';
+static const char KEY_INT = 'I';
+static const char KEY_FLOAT = 'F';
+static const char KEY_STRING = 'S';  // 之后是4字节长度、内容和结尾的'\0'
+
+// 与FloatValue::compare相同的误差
+static const float FLOAT_EPSILON = 1e-5;
+
+char *Arena::allocate(size_t size) {
+  if (size > remain_) {
+    size_t block_size = std::max(block_size_, size);
+    blocks_.emplace_back(new char[block_size]);
+    current_ = blocks_.back().get();
+    remain_ = block_size;
+    memory_usage_ += block_size;
+  }
+  char *result = current_;
+  current_ += size;
+  remain_ -= size;
+  return result;
+}
+
+void Arena::clear() {
+  blocks_.clear();
+  current_ = nullptr;
+  remain_ = 0;
+  memory_usage_ = 0;
+}
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t fmix64(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+// murmur3风格的hash，每次处理8个字节
+static uint64_t hash_bytes(const char *data, size_t length) {
+  uint64_t h = 0x9e3779b97f4a7c15ULL ^ length;
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    uint64_t k;
+    memcpy(&k, data + i, 8);
+    k *= 0x87c37b91114253d5ULL;
+    k = rotl64(k, 31);
+    k *= 0x4cf5ad432745937fULL;
+    h ^= k;
+    h = rotl64(h, 27) * 5 + 0x52dce729;
+  }
+  uint64_t tail = 0;
+  memcpy(&tail, data + i, length - i);
+  h ^= tail * 0x87c37b91114253d5ULL;
+  return fmix64(h);
+}
+
+// 与TupleValue::compare的结果一致，null排在最前面。返回值与key中下一个值的位置
+static int compare_key_value(const char *&a, const char *&b) {
+  char tag_a = *a++;
+  char tag_b = *b++;
+  if (tag_a == KEY_NULL || tag_b == KEY_NULL) {
+    // 同一列的值类型相同，一边是null时另一边的内容不需要跳过
+    return (tag_a == KEY_NULL ? 0 : 1) - (tag_b == KEY_NULL ? 0 : 1);
+  }
+  switch (tag_a) {
+    case KEY_INT: {
+      int va, vb;
+      memcpy(&va, a, sizeof(int));
+      memcpy(&vb, b, sizeof(int));
+      a += sizeof(int);
+      b += sizeof(int);
+      return va < vb ? -1 : (va > vb ? 1 : 0);
+    }
+    case KEY_FLOAT: {
+      float va, vb;
+      memcpy(&va, a, sizeof(float));
+      memcpy(&vb, b, sizeof(float));
+      a += sizeof(float);
+      b += sizeof(float);
+      float result = va - vb;
+      if (-FLOAT_EPSILON < result && result < FLOAT_EPSILON) {
+        return 0;
+      }
+      return result > 0 ? 1 : -1;
+    }
+    default: {
+      uint32_t la, lb;
+      memcpy(&la, a, sizeof(uint32_t));
+      memcpy(&lb, b, sizeof(uint32_t));
+      a += sizeof(uint32_t);
+      b += sizeof(uint32_t);
+      int result = strcmp(a, b);
+      a += la + 1;
+      b += lb + 1;
+      return result;
+    }
+  }
+}
+
+void AggregationHashTable::init(const std::vector<std::shared_ptr<AggreDesc>> &agg_descs) {
+  agg_descs_ = agg_descs;
+  clear();
+}
+
+void AggregationHashTable::clear() {
+  arena_.clear();
+  slots_.clear();
+  groups_.clear();
+  states_.clear();
+  sorted_groups_.clear();
+}
+
+void AggregationHashTable::append_key(TupleValue &value) {
+  void *data = value.value_pointer();
+  if (data == nullptr) {
+    key_buffer_.push_back(KEY_NULL);
+    return;
+  }
+  switch (value.Type()) {
+    case INTS:
+      key_buffer_.push_back(KEY_INT);
+      key_buffer_.append((const char *)data, sizeof(int));
+      break;
+    case FLOATS: {
+      float v = *(float *)data;
+      if (v == 0) {
+        v = 0; // -0.0与0.0是同一个分组
+      }
+      key_buffer_.push_back(KEY_FLOAT);
+      key_buffer_.append((const char *)&v, sizeof(float));
+    } break;
+    default: {
+      const std::string &s = *(std::string *)data;
+      uint32_t length = s.size();
+      key_buffer_.push_back(KEY_STRING);
+      key_buffer_.append((const char *)&length, sizeof(length));
+      key_buffer_.append(s.data(), length);
+      key_buffer_.push_back('\0');
+    } break;
+  }
+}
+
+void AggregationHashTable::grow() {
+  size_t capacity = slots_.empty() ? 1024 : slots_.size() * 2;
+  std::vector<Slot> slots(capacity, Slot{0, -1});
+  size_t mask = capacity - 1;
+  for (const Slot &slot : slots_) {
+    if (slot.group < 0) {
+      continue;
+    }
+    size_t pos = slot.hash & mask;
+    while (slots[pos].group >= 0) {
+      pos = (pos + 1) & mask;
+    }
+    slots[pos] = slot;
+  }
+  slots_.swap(slots);
+}
+
+int AggregationHashTable::find_or_insert(uint64_t hash) {
+  // 负载因子不超过1/2
+  if ((groups_.size() + 1) * 2 > slots_.size()) {
+    grow();
+  }
+  size_t mask = slots_.size() - 1;
+  size_t pos = hash & mask;
+  while (true) {
+    Slot &slot = slots_[pos];
+    if (slot.group < 0) {
+      break;
+    }
+    if (slot.hash == hash) {
+      const GroupKey &key = groups_[slot.group];
+      if (key.length == key_buffer_.size() && memcmp(key.data, key_buffer_.data(), key.length) == 0) {
+        return slot.group;
+      }
+    }
+    pos = (pos + 1) & mask;
+  }
+
+  char *data = arena_.allocate(key_buffer_.size());
+  memcpy(data, key_buffer_.data(), key_buffer_.size());
+  int group = groups_.size();
+  groups_.push_back(GroupKey{data, (uint32_t)key_buffer_.size()});
+  states_.resize(states_.size() + agg_descs_.size());
+  slots_[pos] = Slot{hash, group};
+  return group;
+}
+
+void AggregationHashTable::combine(AggregateState &state, AggreType aggre_type, AttrType type, void *data) {
+  state.count++;
+  switch (aggre_type) {
+    case AggreType::COUNTS:
+      break;
+    case AggreType::SUMS:
+    case AggreType::AVGS:
+      if (type == INTS && state.type != FLOATS) {
+        state.type = INTS;
+        state.int_value += *(int *)data;
+      } else {
+        if (state.type == INTS) {
+          state.float_value = state.int_value;
+        }
+        state.type = FLOATS;
+        state.float_value += type == INTS ? *(int *)data : *(float *)data;
+      }
+      break;
+    case AggreType::MAXS:
+    case AggreType::MINS: {
+      AggregateState value;
+      if (type == INTS) {
+        value.type = INTS;
+        value.int_value = *(int *)data;
+      } else if (type == FLOATS) {
+        value.type = FLOATS;
+        value.float_value = *(float *)data;
+      } else {
+        const std::string &s = *(std::string *)data;
+        value.type = CHARS;
+        value.string_value = s.c_str();
+        value.string_length = s.size();
+      }
+      update_extreme(state, aggre_type == AggreType::MAXS, value);
+    } break;
+    default:
+      assert(false);
+  }
+}
+
+void AggregationHashTable::update_extreme(AggregateState &state, bool is_max, const AggregateState &value) {
+  bool better;
+  if (state.type == UNDEFINED) {
+    better = true;
+  } else if (value.type == CHARS) {
+    int result = strcmp(value.string_value, state.string_value);
+    better = is_max ? result > 0 : result < 0;
+  } else if (value.type == INTS && state.type == INTS) {
+    better = is_max ? value.int_value > state.int_value : value.int_value < state.int_value;
+  } else {
+    float v = value.type == INTS ? value.int_value : value.float_value;
+    float current = state.type == INTS ? state.int_value : state.float_value;
+    better = is_max ? v - current >= FLOAT_EPSILON : v - current <= -FLOAT_EPSILON;
+  }
+  if (!better) {
+    return;
+  }
+  state.type = value.type;
+  if (value.type == INTS) {
+    state.int_value = value.int_value;
+  } else if (value.type == FLOATS) {
+    state.float_value = value.float_value;
+  } else {
+    char *copy = arena_.allocate(value.string_length + 1);
+    memcpy(copy, value.string_value, value.string_length + 1);
+    state.string_value = copy;
+    state.string_length = value.string_length;
+  }
+}
+
+void AggregationHashTable::merge_state(AggregateState &state, AggreType aggre_type, const AggregateState &other) {
+  if (other.count == 0) {
+    return;
+  }
+  state.count += other.count;
+  switch (aggre_type) {
+    case AggreType::COUNTS:
+      break;
+    case AggreType::SUMS:
+    case AggreType::AVGS:
+      if (other.type == INTS && state.type != FLOATS) {
+        state.type = INTS;
+        state.int_value += other.int_value;
+      } else {
+        if (state.type == INTS) {
+          state.float_value = state.int_value;
+        }
+        state.type = FLOATS;
+        state.float_value += other.type == INTS ? other.int_value : other.float_value;
+      }
+      break;
+    case AggreType::MAXS:
+    case AggreType::MINS:
+      update_extreme(state, aggre_type == AggreType::MAXS, other);
+      break;
+    default:
+      assert(false);
+  }
+}
+
+void AggregationHashTable::merge(const AggregationHashTable &other) {
+  for (size_t i = 0; i < other.groups_.size(); i++) {
+    const GroupKey &key = other.groups_[i];
+    key_buffer_.assign(key.data, key.length);
+    int group = find_or_insert(hash_bytes(key_buffer_.data(), key_buffer_.size()));
+
+    AggregateState *states = states_.data() + (size_t)group * agg_descs_.size();
+    const AggregateState *other_states = other.states_.data() + i * agg_descs_.size();
+    for (size_t j = 0; j < agg_descs_.size(); j++) {
+      merge_state(states[j], agg_descs_[j]->aggre_type, other_states[j]);
+    }
+  }
+}
+
+void AggregationHashTable::insert_combine(const Tuple &tuple, const std::vector<int> &key_index,
+                                          const std::vector<int> &value_index) {
+  key_buffer_.clear();
+  for (int index : key_index) {
+    append_key(*tuple.get_pointer(index));
+  }
+  int group = find_or_insert(hash_bytes(key_buffer_.data(), key_buffer_.size()));
+
+  AggregateState *states = states_.data() + (size_t)group * agg_descs_.size();
+  for (size_t i = 0; i < agg_descs_.size(); i++) {
+    const AggreDesc *agg_desc = agg_descs_[i].get();
+    if (value_index[i] < 0) {
+      // agg(*)、agg(12.3)
+      float value = agg_desc->value;
+      combine(states[i], agg_desc->aggre_type, FLOATS, &value);
+      continue;
+    }
+    TupleValue &value = *tuple.get_pointer(value_index[i]);
+    void *data = value.value_pointer();
+    if (data == nullptr) { // null不参与聚合
+      continue;
+    }
+    combine(states[i], agg_desc->aggre_type, value.Type(), data);
+  }
+}
+
+void AggregationHashTable::sort_groups() {
+  sorted_groups_.resize(groups_.size());
+  for (size_t i = 0; i < groups_.size(); i++) {
+    sorted_groups_[i] = i;
+  }
+  std::sort(sorted_groups_.begin(), sorted_groups_.end(), [this](int left, int right) {
+    const GroupKey &left_key = groups_[left];
+    const GroupKey &right_key = groups_[right];
+    const char *a = left_key.data;
+    const char *b = right_key.data;
+    const char *a_end = a + left_key.length;
+    while (a < a_end) {
+      int result = compare_key_value(a, b);
+      if (result != 0) {
+        return result < 0;
+      }
+    }
+    return false;
+  });
+}
+
+void AggregationHashTable::add_key_values(const GroupKey &key, Tuple &tuple) const {
+  const char *p = key.data;
+  const char *end = key.data + key.length;
+  while (p < end) {
+    char tag = *p++;
+    switch (tag) {
+      case KEY_NULL:
+        tuple.add(new NullValue());
+        break;
+      case KEY_INT: {
+        int v;
+        memcpy(&v, p, sizeof(int));
+        p += sizeof(int);
+        tuple.add(v);
+      } break;
+      case KEY_FLOAT: {
+        float v;
+        memcpy(&v, p, sizeof(float));
+        p += sizeof(float);
+        tuple.add(v);
+      } break;
+      default: {
+        uint32_t length;
+        memcpy(&length, p, sizeof(length));
+        p += sizeof(length);
+        tuple.add(p, length);
+        p += length + 1;
+      } break;
+    }
+  }
+}
+
+void AggregationHashTable::output(int index, Tuple &tuple) const {
+  int group = sorted_groups_.empty() ? index : sorted_groups_[index];
+  add_key_values(groups_[group], tuple);
+
+  const AggregateState *states = states_.data() + (size_t)group * agg_descs_.size();
+  for (size_t i = 0; i < agg_descs_.size(); i++) {
+    const AggregateState &state = states[i];
+    AggreType aggre_type = agg_descs_[i]->aggre_type;
+    if (aggre_type == AggreType::COUNTS) {
+      tuple.add(new FloatValue((float)state.count));
+      continue;
+    }
+    if (state.count == 0) {
+      tuple.add(new NullValue());
+      continue;
+    }
+    switch (aggre_type) {
+      case AggreType::SUMS:
+        tuple.add(new FloatValue(state.type == INTS ? (float)state.int_value : state.float_value));
+        break;
+      case AggreType::AVGS: {
+        float sum = state.type == INTS ? (float)state.int_value : state.float_value;
+        tuple.add(new FloatValue(sum / state.count));
+      } break;
+      default:  // MAXS、MINS
+        if (state.type == INTS) {
+          tuple.add(new IntValue((int)state.int_value));
+        } else if (state.type == FLOATS) {
+          tuple.add(new FloatValue(state.float_value));
+        } else {
+          tuple.add(state.string_value, state.string_length);
+        }
+        break;
+    }
+  }
+}
+
+ParallelAggregator::ParallelAggregator(AggregationHashTable &result, int dop) : result_(result), dop_(dop) {
+  for (int i = 0; i < dop; i++) {
+    partials_.emplace_back(new AggregationHashTable());
+    partials_.back()->init(result.agg_descs());
+  }
+}
+
+void ParallelAggregator::aggregate(const std::vector<Tuple> &tuples, const std::vector<int> &key_index,
+                                   const std::vector<int> &value_index) {
+  int morsel_count = (tuples.size() + MORSEL_TUPLES - 1) / MORSEL_TUPLES;
+  WorkerPool::instance().run(dop_, morsel_count, [&](int worker, int morsel) {
+    AggregationHashTable &table = *partials_[worker];
+    size_t end = std::min(tuples.size(), (size_t)(morsel + 1) * MORSEL_TUPLES);
+    for (size_t i = (size_t)morsel * MORSEL_TUPLES; i < end; i++) {
+      table.insert_combine(tuples[i], key_index, value_index);
+    }
+    return RC::SUCCESS;
+  });
+}
+
+/**
+ * aggregate_scan中每个扫描线程的状态：记录解码到tuple_set中，聚合后马上清空
+ */
+struct ScanAggregateWorker {
+  TupleSet tuple_set;
+  std::unique_ptr<TupleRecordConverter> converter;
+  int64_t rows = 0;
+};
+struct ScanAggregateContext {
+  std::vector<std::unique_ptr<ScanAggregateWorker>> workers;
+  std::vector<std::unique_ptr<AggregationHashTable>> *partials;
+  const std::vector<int> *key_index;
+  const std::vector<int> *value_index;
+};
+
+static RC scan_aggregate_reader(int worker, int morsel, const char *data, void *context) {
+  ScanAggregateContext *scan = (ScanAggregateContext *)context;
+  ScanAggregateWorker &state = *scan->workers[worker];
+  state.converter->add_record(data);
+  std::vector<Tuple> &tuples = state.tuple_set.tuples();
+  (*scan->partials)[worker]->insert_combine(tuples.back(), *scan->key_index, *scan->value_index);
+  tuples.clear();
+  state.rows++;
+  return RC::SUCCESS;
+}
+
+RC ParallelAggregator::aggregate_scan(Table *table, Trx *trx, ConditionFilter *filter, int morsel_count,
+                                      const TupleSchema &schema, const std::vector<int> &key_index,
+                                      const std::vector<int> &value_index, int64_t &rows) {
+  ScanAggregateContext scan;
+  scan.partials = &partials_;
+  scan.key_index = &key_index;
+  scan.value_index = &value_index;
+  for (int i = 0; i < dop_; i++) {
+    ScanAggregateWorker *state = new ScanAggregateWorker();
+    scan.workers.emplace_back(state);
+    state->tuple_set.set_schema(schema);
+    state->converter.reset(new TupleRecordConverter(table, state->tuple_set));
+  }
+  RC rc = table->scan_record_parallel(trx, filter, dop_, morsel_count, &scan, scan_aggregate_reader);
+  rows = 0;
+  for (const auto &state : scan.workers) {
+    rows += state->rows;
+  }
+  return rc;
+}
+
+void ParallelAggregator::finish() {
+  for (auto &partial : partials_) {
+    result_.merge(*partial);
+    partial->clear();
+  }
+}
@@ -0,0 +1,149 @@
+#ifndef __OBSERVER_SQL_EXECUTOR_AGGREGATION_HASH_TABLE_H_
+#define __OBSERVER_SQL_EXECUTOR_AGGREGATION_HASH_TABLE_H_
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sql/executor/tuple.h"
+
+class Table;
+class Trx;
+class ConditionFilter;
+
+/**
+ * 只分配、整体释放的内存池，分组的key和MIN/MAX的字符串结果都放在这里
+ */
+class Arena {
+public:
+  explicit Arena(size_t block_size = 64 * 1024) : block_size_(block_size) {}
+  ~Arena() = default;
+
+  char *allocate(size_t size);
+  void clear();
+  size_t memory_usage() const { return memory_usage_; }
+
+private:
+  size_t block_size_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char *current_ = nullptr;
+  size_t remain_ = 0;
+  size_t memory_usage_ = 0;
+};
+
+/**
+ * 一个分组上一个聚合函数的中间状态。
+ * SUM/AVG对INTS用int64累加，对FLOATS用float累加(与原来FloatValue::plus的结果相同)
+ */
+struct AggregateState {
+  AttrType type = UNDEFINED;          // 输入值的类型，UNDEFINED表示还没有非null的输入
+  int64_t count = 0;                  // 非null输入的个数
+  int64_t int_value = 0;              // INTS的SUM/AVG/MIN/MAX
+  float float_value = 0;              // FLOATS的SUM/AVG/MIN/MAX
+  const char *string_value = nullptr; // 字符串的MIN/MAX，存放在arena中
+  int string_length = 0;
+};
+
+/**
+ * 分组聚合用的hash表：开放寻址(线性探测)，group by的值序列化之后放在arena中作为key，
+ * 每个分组的聚合状态连续存放在states_中。
+ * 输出前按group by的值排序，输出的顺序与之前用std::map实现时相同。
+ * FLOATS的分组按值精确区分(只把-0.0与0.0看作同一个值)，与ORDER BY的顺序一致；
+ * 之前的std::map用TupleValue::compare比较key，相差小于1e-5的浮点数会落在同一个分组里
+ */
+class AggregationHashTable {
+public:
+  AggregationHashTable() = default;
+  ~AggregationHashTable() = default;
+
+  void init(const std::vector<std::shared_ptr<AggreDesc>> &agg_descs);
+  void clear();
+
+  /**
+   * 把一个tuple合并到它所在的分组中
+   * @param key_index group by字段在tuple中的下标
+   * @param value_index 每个聚合函数的输入在tuple中的下标，-1表示常量，如count(*)、sum(1)
+   */
+  void insert_combine(const Tuple &tuple, const std::vector<int> &key_index, const std::vector<int> &value_index);
+
+  /**
+   * 把另一个hash表中的分组合并进来，两个表的聚合函数必须相同。用于合并并行聚合的局部结果
+   */
+  void merge(const AggregationHashTable &other);
+
+  int group_count() const { return groups_.size(); }
+  const std::vector<std::shared_ptr<AggreDesc>> &agg_descs() const { return agg_descs_; }
+
+  /**
+   * 按group by的值排序，之后output按排序后的顺序输出
+   */
+  void sort_groups();
+
+  /**
+   * 输出排序后的第index个分组：先是group by的值，然后是各个聚合函数的结果
+   */
+  void output(int index, Tuple &tuple) const;
+
+private:
+  struct GroupKey {
+    const char *data;
+    uint32_t length;
+  };
+  struct Slot {
+    uint64_t hash;
+    int group;  // 小于0表示空位置
+  };
+
+  void append_key(TupleValue &value);
+  int find_or_insert(uint64_t hash);
+  void grow();
+  void combine(AggregateState &state, AggreType aggre_type, AttrType type, void *data);
+  // MIN/MAX：value比state更小/更大时替换state，字符串复制到arena中
+  void update_extreme(AggregateState &state, bool is_max, const AggregateState &value);
+  void merge_state(AggregateState &state, AggreType aggre_type, const AggregateState &other);
+  void add_key_values(const GroupKey &key, Tuple &tuple) const;
+
+private:
+  std::vector<std::shared_ptr<AggreDesc>> agg_descs_;
+  Arena arena_;
+  std::string key_buffer_;  // 当前tuple序列化之后的key
+  std::vector<Slot> slots_;
+  std::vector<GroupKey> groups_;
+  std::vector<AggregateState> states_;  // 第i个分组的状态为 states_[i * agg_descs_.size(), ...)
+  std::vector<int> sorted_groups_;
+};
+
+/**
+ * 并行聚合：输入的tuple按morsel分给WorkerPool中的dop个线程，每个线程聚合到自己的局部hash表，
+ * finish时把局部结果合并到result中。FLOATS的SUM/AVG累加顺序与串行时不同，结果可能有舍入误差
+ */
+class ParallelAggregator {
+public:
+  ParallelAggregator(AggregationHashTable &result, int dop);
+  ~ParallelAggregator() = default;
+
+  /**
+   * 可以多次调用，每次调用等到这批tuple全部聚合完成后返回
+   */
+  void aggregate(const std::vector<Tuple> &tuples, const std::vector<int> &key_index,
+                 const std::vector<int> &value_index);
+  /**
+   * 扫描与局部聚合融合：按morsel并行扫描table，各线程把满足filter的记录解码为schema中的字段后
+   * 直接聚合到自己的局部hash表中，不物化扫描结果。morsel_count由Table::scan_morsel_count得到
+   * @param rows 返回扫描出的记录数
+   */
+  RC aggregate_scan(Table *table, Trx *trx, ConditionFilter *filter, int morsel_count, const TupleSchema &schema,
+                    const std::vector<int> &key_index, const std::vector<int> &value_index, int64_t &rows);
+  void finish();
+
+public:
+  static const int MORSEL_TUPLES = 4096;
+
+private:
+  AggregationHashTable &result_;
+  int dop_;
+  std::vector<std::unique_ptr<AggregationHashTable>> partials_;  // 每个线程一个
+};
+
+#endif //__OBSERVER_SQL_EXECUTOR_AGGREGATION_HASH_TABLE_H_
@@ -0,0 +1,189 @@
+#include <string.h>
+
+#include "sql/executor/column_batch.h"
+#include "common/log/log.h"
+
+void ColumnVector::clear() {
+  size_ = 0;
+  null_count_ = 0;
+  nulls_.clear();
+  ints_.clear();
+  floats_.clear();
+  offsets_.resize(1);
+  strings_.clear();
+}
+
+void ColumnVector::reserve(int rows) {
+  nulls_.reserve((rows + 7) / 8);
+  switch (type_) {
+    case INTS:
+      ints_.reserve(rows);
+      break;
+    case FLOATS:
+      floats_.reserve(rows);
+      break;
+    default:
+      offsets_.reserve(rows + 1);
+      break;
+  }
+}
+
+void ColumnVector::append_null_bit(bool is_null) {
+  if ((size_ & 7) == 0) {
+    nulls_.push_back(0);
+  }
+  if (is_null) {
+    nulls_.back() |= (uint8_t)(1 << (size_ & 7));
+    null_count_++;
+  }
+  size_++;
+}
+
+void ColumnVector::append_null() {
+  switch (type_) {
+    case INTS:
+      ints_.push_back(0);
+      break;
+    case FLOATS:
+      floats_.push_back(0);
+      break;
+    default:
+      strings_.push_back('\0');
+      offsets_.push_back(strings_.size());
+      break;
+  }
+  append_null_bit(true);
+}
+
+void ColumnVector::append_int(int value) {
+  ints_.push_back(value);
+  append_null_bit(false);
+}
+
+void ColumnVector::append_float(float value) {
+  floats_.push_back(value);
+  append_null_bit(false);
+}
+
+void ColumnVector::append_string(const char *s, int len) {
+  strings_.insert(strings_.end(), s, s + len);
+  strings_.push_back('\0');
+  offsets_.push_back(strings_.size());
+  append_null_bit(false);
+}
+
+void ColumnVector::append_from(const ColumnVector &other, int row) {
+  if (other.is_null(row)) {
+    append_null();
+    return;
+  }
+  switch (type_) {
+    case INTS:
+      append_int(other.get_int(row));
+      break;
+    case FLOATS:
+      append_float(other.get_float(row));
+      break;
+    default:
+      append_string(other.get_string(row), other.string_length(row));
+      break;
+  }
+}
+
+std::shared_ptr<TupleValue> ColumnVector::value(int row) const {
+  if (is_null(row)) {
+    return std::make_shared<NullValue>();
+  }
+  switch (type_) {
+    case INTS:
+      return std::make_shared<IntValue>(ints_[row]);
+    case FLOATS:
+      return std::make_shared<FloatValue>(floats_[row]);
+    default:
+      return std::make_shared<StringValue>(get_string(row), string_length(row));
+  }
+}
+
+void ColumnBatch::init(const TupleSchema &schema) {
+  schema_ = schema;
+  columns_.clear();
+  for (const TupleField &field : schema_.fields()) {
+    columns_.emplace_back(field.type());
+  }
+  row_count_ = 0;
+  selection_.clear();
+}
+
+void ColumnBatch::clear() {
+  for (ColumnVector &column : columns_) {
+    column.clear();
+  }
+  row_count_ = 0;
+  selection_.clear();
+}
+
+void ColumnBatch::append_row(const ColumnBatch &other, int row) {
+  for (size_t i = 0; i < columns_.size(); i++) {
+    columns_[i].append_from(other.columns_[i], row);
+  }
+  finish_row();
+}
+
+void ColumnBatch::add_to_tuple(int row, const std::vector<int> &column_index, Tuple &tuple) const {
+  for (int index : column_index) {
+    tuple.add(columns_[index].value(row));
+  }
+}
+
+void ColumnBatch::to_tuple(int row, Tuple &tuple) const {
+  for (const ColumnVector &column : columns_) {
+    tuple.add(column.value(row));
+  }
+}
+
+void ColumnBatch::to_tuple_set(TupleSet &tuple_set) const {
+  tuple_set.clear();
+  tuple_set.set_schema(schema_);
+  for (int row : selection_) {
+    Tuple tuple;
+    to_tuple(row, tuple);
+    tuple_set.add(std::move(tuple));
+  }
+}
+
+void ColumnBatch::from_tuple_set(TupleSet &tuple_set) {
+  init(tuple_set.get_schema());
+  for (ColumnVector &column : columns_) {
+    column.reserve(tuple_set.size());
+  }
+  for (const Tuple &tuple : tuple_set.tuples()) {
+    for (size_t i = 0; i < columns_.size(); i++) {
+      ColumnVector &column = columns_[i];
+      TupleValue *value = tuple.get_pointer(i).get();
+      void *data = value->value_pointer();
+      if (data == nullptr) {
+        column.append_null();
+        continue;
+      }
+      switch (column.type()) {
+        case INTS:
+          column.append_int(*(int *)data);
+          break;
+        case FLOATS:
+          column.append_float(*(float *)data);
+          break;
+        case CHARS:
+        case DATES:
+        case TEXTS: {
+          const std::string &s = *(std::string *)data;
+          column.append_string(s.c_str(), strlen(s.c_str()));
+        }
+          break;
+        default:
+          LOG_PANIC("Unsupported column type. type=%d", column.type());
+          break;
+      }
+    }
+    finish_row();
+  }
+}
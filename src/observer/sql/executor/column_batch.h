@@ -0,0 +1,113 @@
+#ifndef __OBSERVER_SQL_EXECUTOR_COLUMN_BATCH_H_
+#define __OBSERVER_SQL_EXECUTOR_COLUMN_BATCH_H_
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "sql/executor/tuple.h"
+
+/**
+ * 列存格式的一列。INTS/FLOATS按类型连续存放；
+ * 字符串类型(CHARS/DATES/TEXTS)的内容以'\0'结尾依次拼接在strings_中，offsets_记录每行的起始位置。
+ * null的行在nulls_中对应的位为1，值部分填0或空串
+ */
+class ColumnVector {
+public:
+  explicit ColumnVector(AttrType type = UNDEFINED) : type_(type) {}
+
+  AttrType type() const { return type_; }
+  int size() const { return size_; }
+  void clear();
+  void reserve(int rows);
+
+  void append_null();
+  void append_int(int value);
+  void append_float(float value);
+  void append_string(const char *s, int len);
+  // 从另一个同类型的列追加一行
+  void append_from(const ColumnVector &other, int row);
+
+  bool is_null(int row) const { return (nulls_[row >> 3] >> (row & 7)) & 1; }
+  bool has_null() const { return null_count_ > 0; }
+  int get_int(int row) const { return ints_[row]; }
+  float get_float(int row) const { return floats_[row]; }
+  const char *get_string(int row) const { return strings_.data() + offsets_[row]; }
+  int string_length(int row) const { return offsets_[row + 1] - offsets_[row] - 1; }
+
+  const int *int_data() const { return ints_.data(); }
+  const float *float_data() const { return floats_.data(); }
+  const uint8_t *null_data() const { return nulls_.data(); }
+
+  /**
+   * 第row行的值，转换为行格式时使用
+   */
+  std::shared_ptr<TupleValue> value(int row) const;
+
+private:
+  void append_null_bit(bool is_null);
+  bool is_string_type() const { return type_ == CHARS || type_ == DATES || type_ == TEXTS; }
+
+private:
+  AttrType type_;
+  int size_ = 0;
+  int null_count_ = 0;
+  std::vector<uint8_t> nulls_;
+  std::vector<int> ints_;
+  std::vector<float> floats_;
+  std::vector<uint32_t> offsets_{0};
+  std::vector<char> strings_;
+};
+
+/**
+ * 执行器之间传递的列存批次，列的顺序与schema中的字段相同。
+ * selection_为参与后续计算的行号(递增)，过滤只修改selection_而不移动数据
+ */
+class ColumnBatch {
+public:
+  ColumnBatch() = default;
+  ~ColumnBatch() = default;
+
+  void init(const TupleSchema &schema);
+  // 清空数据，保留schema
+  void clear();
+
+  const TupleSchema &schema() const { return schema_; }
+  TupleSchema &get_schema() { return schema_; }
+
+  int column_num() const { return columns_.size(); }
+  ColumnVector &column(int index) { return columns_[index]; }
+  const ColumnVector &column(int index) const { return columns_[index]; }
+
+  // 实际存放的行数
+  int row_count() const { return row_count_; }
+  // 选中的行数
+  int size() const { return selection_.size(); }
+  int selected(int i) const { return selection_[i]; }
+  std::vector<int> &selection() { return selection_; }
+
+  /**
+   * 每一列都追加了一个值之后调用，新的行默认被选中
+   */
+  void finish_row() { selection_.push_back(row_count_++); }
+  // 追加另一个批次(列类型相同)中的第row行
+  void append_row(const ColumnBatch &other, int row);
+
+  /**
+   * 把第row行中column_index指定的列依次加到tuple中，与Tuple::add(tuple, field_index)对应
+   */
+  void add_to_tuple(int row, const std::vector<int> &column_index, Tuple &tuple) const;
+  void to_tuple(int row, Tuple &tuple) const;
+  // 选中的行转换为行格式
+  void to_tuple_set(TupleSet &tuple_set) const;
+  // 行格式转换为列存格式，用于没有实现列存输出的执行器
+  void from_tuple_set(TupleSet &tuple_set);
+
+private:
+  TupleSchema schema_;
+  std::vector<ColumnVector> columns_;
+  int row_count_ = 0;
+  std::vector<int> selection_;
+};
+
+#endif //__OBSERVER_SQL_EXECUTOR_COLUMN_BATCH_H_
@@ -15,7 +15,9 @@ See the Mulan PSL v2 for more details. */
 #include <string>
 #include <sstream>
 #include <map>
+#include <memory>
 #include <unordered_set>
+#include <algorithm>
 
 #include "execute_stage.h"
 
@@ -31,10 +33,14 @@ See the Mulan PSL v2 for more details. */
 #include "sql/executor/execution_node.h"
 #include "sql/executor/aggregate_execution_node.h"
 #include "sql/executor/exp_execution_node.h"
+#include "sql/executor/explain.h"
+#include "sql/plan_cache/plan_cache.h"
+#include "storage/common/db.h"
 #include "storage/common/table.h"
 #include "storage/default/default_handler.h"
 #include "storage/common/condition_filter.h"
 #include "storage/trx/trx.h"
+#include "util/worker_pool.h"
 #include "executor.h"
 #include "executor_builder.h"
 
@@ -231,7 +237,13 @@ RC pre_check(const char *db, Query *sql, SessionEvent *session_event) {
           }
         }
       } // attr condition check
-    }
+    } break;
+    case SCF_SET_VARIABLE: {
+      // 变量名和值在Session::set_variable中检查
+    } break;
+    case SCF_ANALYZE_TABLE: {
+      // 表是否存在由DefaultHandler::analyze_table检查
+    } break;
   }
   return RC::SUCCESS;
 }
@@ -249,6 +261,41 @@ bool select_with_join_or_subselect(Query *sql) {
   return false;
 }
 
+static const int MIN_SORT_BUFFER_SIZE = 1024;
+
+// set parallel_degree = n，n超过WorkerPool的最大并行度时取最大并行度
+// set sort_buffer_size = n，排序使用的内存(字节)
+static RC set_variable(Session *session, const SetVariable &set_variable) {
+  if (0 == strcasecmp(set_variable.name, "parallel_degree")) {
+    if (set_variable.value.type != INTS || *(int *)set_variable.value.data < 1) {
+      LOG_WARN("Invalid parallel_degree");
+      return RC::INVALID_ARGUMENT;
+    }
+    int parallel_degree = std::min(*(int *)set_variable.value.data, WorkerPool::instance().max_dop());
+    session->set_parallel_degree(parallel_degree);
+    return RC::SUCCESS;
+  }
+  if (0 == strcasecmp(set_variable.name, "sort_buffer_size")) {
+    if (set_variable.value.type != INTS || *(int *)set_variable.value.data < MIN_SORT_BUFFER_SIZE) {
+      LOG_WARN("Invalid sort_buffer_size, at least %d", MIN_SORT_BUFFER_SIZE);
+      return RC::INVALID_ARGUMENT;
+    }
+    session->set_sort_buffer_size(*(int *)set_variable.value.data);
+    return RC::SUCCESS;
+  }
+  if (0 == strcasecmp(set_variable.name, "index_key_compress")) {
+    if (set_variable.value.type != INTS ||
+        (*(int *)set_variable.value.data != 0 && *(int *)set_variable.value.data != 1)) {
+      LOG_WARN("Invalid index_key_compress, should be 0 or 1");
+      return RC::INVALID_ARGUMENT;
+    }
+    session->set_index_key_compress(*(int *)set_variable.value.data == 1);
+    return RC::SUCCESS;
+  }
+  LOG_WARN("Unknown variable: %s", set_variable.name);
+  return RC::INVALID_ARGUMENT;
+}
+
 void ExecuteStage::handle_request(common::StageEvent *event) {
   RC rc;
   ExecutionPlanEvent *exe_event = static_cast<ExecutionPlanEvent *>(event);
@@ -264,18 +311,32 @@ void ExecuteStage::handle_request(common::StageEvent *event) {
   }
   exe_event->push_callback(cb);
 
-  rc = pre_check(current_db, sql, exe_event->sql_event()->session_event());
-  if (rc != RC::SUCCESS) {
-    session_event->set_response("FAILURE\n");
-    exe_event->done_immediate();
-    return;
+  // 缓存的计划在表没有变化时已经检查过了
+  const std::shared_ptr<CachedPlan> &cached_plan = exe_event->cached_plan();
+  Db *db = DefaultHandler::get_default().find_db(current_db);
+  CachedPlan::SchemaVersions schema_versions;
+  if (cached_plan != nullptr && db != nullptr) {
+    schema_versions = cached_plan->schema_versions(db);
+  }
+  if (cached_plan == nullptr || db == nullptr || !cached_plan->checked(schema_versions)) {
+    rc = pre_check(current_db, sql, exe_event->sql_event()->session_event());
+    if (rc != RC::SUCCESS) {
+      session_event->set_response("FAILURE\n");
+      exe_event->done_immediate();
+      return;
+    }
+    if (cached_plan != nullptr && db != nullptr) {
+      cached_plan->set_checked(schema_versions);
+    }
   }
 
   switch (sql->flag) {
     case SCF_SELECT: { // select
       const Selects &selects = sql->sstr.selection;
       bool use_v2 = select_with_join_or_subselect(sql);
-      if (use_v2) {
+      if (sql->explain != EXPLAIN_NONE) {
+        rc = do_explain(current_db, sql, exe_event->sql_event()->session_event());
+      } else if (use_v2) {
         rc = do_select_v2(current_db, sql, exe_event->sql_event()->session_event());
       } else {
         rc = do_select(current_db, sql, exe_event->sql_event()->session_event());
@@ -294,6 +355,7 @@ void ExecuteStage::handle_request(common::StageEvent *event) {
     case SCF_CREATE_TABLE:
     case SCF_SHOW_TABLES:
     case SCF_DESC_TABLE:
+    case SCF_ANALYZE_TABLE:
     case SCF_DROP_TABLE:
     case SCF_CREATE_INDEX:
     case SCF_DROP_INDEX: 
@@ -336,6 +398,12 @@ void ExecuteStage::handle_request(common::StageEvent *event) {
       exe_event->done_immediate();
     }
     break;
+    case SCF_SET_VARIABLE: {
+      rc = set_variable(session_event->get_client()->session, sql->sstr.set_variable);
+      session_event->set_response(rc == RC::SUCCESS ? "SUCCESS\n" : "FAILURE\n");
+      exe_event->done_immediate();
+    }
+    break;
     case SCF_HELP: {
       const char *response = "show tables;\n"
           "desc `table name`;\n"
@@ -344,7 +412,11 @@ void ExecuteStage::handle_request(common::StageEvent *event) {
           "insert into `table` values(`value1`,`value2`);\n"
           "update `table` set column=value [where `column`=`value`];\n"
           "delete from `table` [where `column`=`value`];\n"
-          "select [ * | `columns` ] from `table`;\n";
+          "select [ * | `columns` ] from `table`;\n"
+          "explain [analyze] select ...;\n"
+          "set parallel_degree = `n`;\n"
+          "set sort_buffer_size = `bytes`;\n"
+          "set index_key_compress = `0|1`;\n";
       session_event->set_response(response);
       exe_event->done_immediate();
     }
@@ -376,12 +448,53 @@ void end_trx_if_need(Session *session, Trx *trx, bool all_right) {
 // 这里没有对输入的某些信息做合法性校验，比如查询的列名、where条件中的列名等，没有做必要的合法性校验
 // 需要补充上这一部分. 校验部分也可以放在resolve，不过跟execution放一起也没有关系
 // 流程:selectnode->cartesiannode(如果需要)->orderbynode(如果需要)->aggregatenode(如果需要)->outputnode
-RC ExecuteStage::do_select(const char *db, Query *sql, SessionEvent *session_event) {
+// 只保留前limit个tuple，limit小于0时不做处理
+static void truncate_to_limit(TupleSet &tuple_set, int limit) {
+  std::vector<Tuple> &tuples = tuple_set.tuples();
+  if (limit >= 0 && limit < (int)tuples.size()) {
+    tuples.erase(tuples.begin() + limit, tuples.end());
+  }
+}
+
+// EXPLAIN时在执行计划的最上面加一个节点，原来的节点作为它的子节点，统计包含子节点的时间和页数
+// 带表达式的条件只在最后的ExpExeNode中求值，之前的节点不能按limit提前停止或截断
+static bool has_expression_condition(const Selects &selects) {
+  for (size_t i = 0; i < selects.condition_num; i++) {
+    if (selects.conditions[i].left_ast != nullptr || selects.conditions[i].right_ast != nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void push_explain_node(ExplainNode &top, const char *name, const std::string &detail) {
+  ExplainNode parent;
+  parent.name = name;
+  parent.detail = detail;
+  parent.stats.add_cost(top.stats);
+  parent.children.push_back(std::move(top));
+  top = std::move(parent);
+}
+
+static std::string rel_attr_to_string(const RelAttr &attr) {
+  if (attr.relation_name == nullptr) {
+    return attr.attribute_name;
+  }
+  return std::string(attr.relation_name) + "." + attr.attribute_name;
+}
+
+RC ExecuteStage::do_select(const char *db, Query *sql, SessionEvent *session_event, ExplainNode *plan) {
 
   RC rc = RC::SUCCESS;
   Session *session = session_event->get_client()->session;
   Trx *trx = session->current_trx();
   const Selects &selects = sql->sstr.selection;
+  // 每一步都是物化的，EXPLAIN ANALYZE分别统计每一步；只EXPLAIN时不扫描表，之后的每一步处理的都是空的结果
+  const bool analyze = plan != nullptr && sql->explain == EXPLAIN_ANALYZE;
+  const bool scan = plan == nullptr || analyze;
+  ExplainNode top;
+  // 表达式条件过滤之前可以使用的limit，小于0表示只能在表达式条件过滤之后截断
+  const int pushed_limit = has_expression_condition(selects) ? -1 : selects.limit;
   // 1. 把所有的表和只跟这张表关联的condition都拿出来，生成最底层的select 执行节点
   std::vector<SelectExeNode *> select_nodes;
   for (int i = selects.relation_num - 1; i >= 0; i--) {
@@ -396,6 +509,11 @@ RC ExecuteStage::do_select(const char *db, Query *sql, SessionEvent *session_eve
       end_trx_if_need(session, trx, false);
       return rc;
     }
+    select_node->set_parallel_degree(session->parallel_degree());
+    if (selects.relation_num == 1 && selects.aggre_num == 0 && selects.order_num == 0) {
+      // 单表没有排序和聚合时，扫描到limit条满足条件的记录就可以停止
+      select_node->set_limit(pushed_limit);
+    }
     select_nodes.push_back(select_node);
   }
 
@@ -405,10 +523,29 @@ RC ExecuteStage::do_select(const char *db, Query *sql, SessionEvent *session_eve
     return RC::SQL_SYNTAX;
   }
   // 执行所有的selectNode,生成每个"表"的结果集
+  // 单表聚合时扫描推迟到聚合节点中，可以并行扫描时各线程直接做局部聚合，不物化扫描结果
+  const bool aggregate_scan = scan && selects.relation_num == 1 && selects.aggre_num != 0;
+  std::unique_ptr<SelectExeNode> aggregate_source;
   std::vector<TupleSet> tuple_sets;
+  std::vector<ExplainNode> scan_plans;
   for (SelectExeNode *&node: select_nodes) {
     TupleSet tuple_set;
-    rc = node->execute(tuple_set);
+    ExplainNode scan_plan;
+    if (plan != nullptr) {
+      node->explain(scan_plan);
+    }
+    if (aggregate_scan) {
+      tuple_set.set_schema(node->schema());
+      aggregate_source.reset(node);
+      node = nullptr;
+    } else if (scan) {
+      OperatorTimer timer(analyze ? &scan_plan.stats : nullptr);
+      rc = node->execute(tuple_set);
+    } else {
+      tuple_set.set_schema(node->schema());
+    }
+    scan_plan.stats.rows = tuple_set.size();
+    scan_plans.push_back(std::move(scan_plan));
     if (rc != RC::SUCCESS) {
       for (SelectExeNode *& tmp_node: select_nodes) {
         delete tmp_node;
@@ -439,9 +576,38 @@ RC ExecuteStage::do_select(const char *db, Query *sql, SessionEvent *session_eve
     cartesianExeNode cartesian_exe_node;
     rc = create_cartesian_executor(trx, selects, db, std::move(tuple_sets), cartesian_exe_node, field_index);
     assert(rc == RC::SUCCESS);
-    cartesian_exe_node.execute(tmp_tuple_set);
+    if (selects.aggre_num == 0 && selects.order_num == 0) {
+      cartesian_exe_node.set_limit(pushed_limit);
+    }
+    if (plan != nullptr) {
+      top.name = "Join";
+      for (size_t i = 0; i < selects.join_order_num; i++) {
+        top.detail += (i == 0 ? "order=" : ",") + std::string(selects.relations[selects.join_order[i]]);
+      }
+      std::string conditions;
+      for (size_t i = 0; i < selects.condition_num; i++) {
+        const Condition &condition = selects.conditions[i];
+        if (condition.left_is_attr == 1 && condition.right_is_attr == 1) {
+          conditions += (conditions.empty() ? "" : " and ") + rel_attr_to_string(condition.left_attr) + " " +
+                        comp_op_to_string(condition.comp) + " " + rel_attr_to_string(condition.right_attr);
+        }
+      }
+      if (!conditions.empty()) {
+        top.detail += (top.detail.empty() ? "on " : " on ") + conditions;
+      }
+      for (ExplainNode &scan_plan : scan_plans) {
+        top.stats.add_cost(scan_plan.stats);
+        top.children.push_back(std::move(scan_plan));
+      }
+    }
+    {
+      OperatorTimer timer(analyze ? &top.stats : nullptr);
+      cartesian_exe_node.execute(tmp_tuple_set);
+    }
+    top.stats.rows = tmp_tuple_set.size();
   } else {
     tmp_tuple_set = std::move(tuple_sets.front());
+    top = std::move(scan_plans.front());
   }
   // 3. aggregate node
   if (selects.aggre_num != 0) {
@@ -450,7 +616,28 @@ RC ExecuteStage::do_select(const char *db, Query *sql, SessionEvent *session_eve
     if (rc != RC::SUCCESS) {
       return rc;
     }
-    aggregationExeNode.execute(tmp_tuple_set);
+    aggregationExeNode.set_parallel_degree(session->parallel_degree());
+    aggregationExeNode.set_source(aggregate_source.get());
+    push_explain_node(top, "Aggregate", "");
+    {
+      OperatorTimer timer(analyze ? &top.stats : nullptr);
+      rc = aggregationExeNode.execute(tmp_tuple_set);
+    }
+    if (rc != RC::SUCCESS) {
+      end_trx_if_need(session, trx, false);
+      return rc;
+    }
+    if (aggregate_source != nullptr) {
+      // 扫描在聚合节点中完成，时间和页数都计入聚合节点
+      top.children.front().stats.rows = aggregationExeNode.input_rows();
+    }
+    top.stats.rows = tmp_tuple_set.size();
+    top.detail = schema_to_string(tmp_tuple_set.get_schema());
+    truncate_to_limit(tmp_tuple_set, selects.limit);
+    if (selects.limit >= 0) {
+      push_explain_node(top, "Limit", std::to_string(selects.limit));
+      top.stats.rows = tmp_tuple_set.size();
+    }
     // 此时的tmp_tuple_set可以直接打印了
     tmp_tuple_set.print(ss, is_multi_table);
   } else {
@@ -460,7 +647,31 @@ RC ExecuteStage::do_select(const char *db, Query *sql, SessionEvent *session_eve
       OrderByExeNode orderByExeNode;
       rc = create_orderby_executor(trx, selects, db, orderByExeNode, field_index);
       assert(rc == RC::SUCCESS);
-      orderByExeNode.execute(tmp_tuple_set);
+      orderByExeNode.set_limit(pushed_limit);
+      orderByExeNode.set_sort_buffer_size(session->sort_buffer_size());
+      std::string order_by;
+      for (size_t i = 0; i < selects.order_num; i++) {
+        order_by += (i == 0 ? "" : ", ") + rel_attr_to_string(selects.order_by[i].attribute) +
+                    (selects.order_by[i].order ? " desc" : "");
+      }
+      if (pushed_limit >= 0) {
+        order_by += " limit=" + std::to_string(pushed_limit);
+      }
+      push_explain_node(top, pushed_limit >= 0 ? "TopN" : "Sort", order_by);
+      {
+        OperatorTimer timer(analyze ? &top.stats : nullptr);
+        rc = orderByExeNode.execute(tmp_tuple_set);
+      }
+      top.stats.rows = tmp_tuple_set.size();
+      if (rc != RC::SUCCESS) {
+        end_trx_if_need(session, trx, false);
+        return rc;
+      }
+    }
+    truncate_to_limit(tmp_tuple_set, pushed_limit);
+    if (pushed_limit >= 0 && selects.order_num == 0) {
+      push_explain_node(top, "Limit", std::to_string(pushed_limit));
+      top.stats.rows = tmp_tuple_set.size();
     }
     // 5. 生成输出tupleset
     OutputExeNode outputExeNode;
@@ -471,9 +682,26 @@ RC ExecuteStage::do_select(const char *db, Query *sql, SessionEvent *session_eve
       // todo(wq): expression流转到exp直接打印返回，先通过样例再考虑重构
       ExpExeNode expression_exe_node;
       rc = create_expression_executor(selects, expression_exe_node, std::move(outputExeNode.TmpTupleSet()), outputExeNode.OutputSchema(), field_index);
-      assert(rc == RC::SUCCESS);
+      if (rc != RC::SUCCESS) {
+        end_trx_if_need(session, trx, false);
+        return rc;
+      }
       TupleSet exp_tuple_set;
-      expression_exe_node.execute(exp_tuple_set);
+      push_explain_node(top, "Project", "");
+      {
+        OperatorTimer timer(analyze ? &top.stats : nullptr);
+        expression_exe_node.execute(exp_tuple_set);
+      }
+      top.stats.rows = exp_tuple_set.size();
+      top.detail = schema_to_string(exp_tuple_set.get_schema());
+      if (pushed_limit < 0 && selects.limit >= 0) {
+        truncate_to_limit(exp_tuple_set, selects.limit);
+        push_explain_node(top, "Limit", std::to_string(selects.limit));
+        top.stats.rows = exp_tuple_set.size();
+      }
+      if (plan != nullptr) {
+        *plan = std::move(top);
+      }
       exp_tuple_set.print(ss, is_multi_table);
       session_event->set_response(ss.str());
       end_trx_if_need(session, trx, true);
@@ -481,21 +709,33 @@ RC ExecuteStage::do_select(const char *db, Query *sql, SessionEvent *session_eve
     }
     assert(rc == RC::SUCCESS);
     TupleSet output_tuple_set;
-    outputExeNode.execute(output_tuple_set);
+    push_explain_node(top, "Project", schema_to_string(outputExeNode.OutputSchema()));
+    {
+      OperatorTimer timer(analyze ? &top.stats : nullptr);
+      outputExeNode.execute(output_tuple_set);
+    }
+    top.stats.rows = output_tuple_set.size();
     output_tuple_set.print(ss, is_multi_table);
   }
+  if (plan != nullptr) {
+    *plan = std::move(top);
+  }
   session_event->set_response(ss.str());
   end_trx_if_need(session, trx, true);
   return rc;
 }
 
 // solve select -> join and subselect
-RC ExecuteStage::do_select_v2(const char *db, Query *sql, SessionEvent *session_event) {
+RC ExecuteStage::do_select_v2(const char *db, Query *sql, SessionEvent *session_event, ExplainNode *plan) {
   Session *session = session_event->get_client()->session;
   Trx *trx = session->current_trx();
   auto executor_builder = new ExecutorBuilder(db, sql, session_event);
   Executor *executor = executor_builder->build();
   assert(executor != nullptr);
+  const bool analyze = plan != nullptr && sql->explain == EXPLAIN_ANALYZE;
+  if (analyze) {
+    executor->enable_stats();
+  }
   TupleSet result;
   RC rc = executor->init();
   if (rc != RC::SUCCESS) {
@@ -504,21 +744,65 @@ RC ExecuteStage::do_select_v2(const char *db, Query *sql, SessionEvent *session_
     end_trx_if_need(session, trx, false);
     return rc;
   }
-  rc = executor->next(result);
-  if (rc != RC::SUCCESS) {
+  // 分批取出结果，第一批带上表头
+  std::stringstream ss;
+  bool multi_table = (sql->sstr.selection.relation_num > 1) || (sql->sstr.selection.join_num > 0);
+  bool first_batch = true;
+  // 只EXPLAIN时init之后就可以生成执行计划，不取结果
+  while ((plan == nullptr || analyze) && (rc = executor->next(result)) == RC::SUCCESS) {
+    if (first_batch) {
+      result.print(ss, multi_table);
+      first_batch = false;
+    } else {
+      result.print_tuples(ss);
+    }
+  }
+  if (rc != RC::RECORD_EOF && rc != RC::SUCCESS) {
+    // 出错时子节点中可能还有没有读完的并行扫描，rewind让它们停下来
+    executor->rewind();
     delete executor_builder;
     delete executor;
     end_trx_if_need(session, trx, false);
     return rc;
   }
-  std::stringstream ss;
-  bool multi_table = (sql->sstr.selection.relation_num > 1) || (sql->sstr.selection.join_num > 0);
-  result.print(ss, multi_table);
+  rc = RC::SUCCESS;
+  if (first_batch) {
+    result.set_schema(executor->output_schema());
+    result.print(ss, multi_table);
+  }
+  if (plan != nullptr) {
+    // 投影在最上层节点的next中完成，没有单独的算子，统计与最上层节点相同
+    TupleSchema output_schema = executor->output_schema();
+    plan->name = "Project";
+    plan->detail = schema_to_string(output_schema);
+    plan->children.emplace_back();
+    executor->explain(plan->children.back());
+    plan->stats = plan->children.back().stats;
+  }
+  // LIMIT提前结束或只EXPLAIN时，停止子节点中还没有读完的并行扫描
+  executor->rewind();
   session_event->set_response(ss.str());
   end_trx_if_need(session, trx, true);
   return rc;
 }
 
+RC ExecuteStage::do_explain(const char *db, Query *sql, SessionEvent *session_event) {
+  ExplainNode plan;
+  RC rc;
+  if (select_with_join_or_subselect(sql)) {
+    rc = do_select_v2(db, sql, session_event, &plan);
+  } else {
+    rc = do_select(db, sql, session_event, &plan);
+  }
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  std::stringstream ss;
+  print_explain(plan, sql->explain == EXPLAIN_ANALYZE, ss);
+  session_event->set_response(ss.str());
+  return rc;
+}
+
 bool match_table(const Selects &selects, const char *table_name_in_condition, const char *table_name_to_match) {
   if (table_name_in_condition != nullptr) {
     return 0 == strcmp(table_name_in_condition, table_name_to_match);
@@ -539,6 +823,67 @@ static RC schema_add_field(Table *table, const char *field_name, TupleSchema &sc
   return RC::SUCCESS;
 }
 
+// 如果单表查询只引用了一个字段（select列、聚合、order by、group by、where条件），
+// 并且该字段上有索引，返回这个字段名，可以只扫描索引而不回表
+static const char *find_index_only_field(const Selects &selects, Table *table) {
+  if (selects.relation_num != 1 || selects.join_num != 0 || selects.attr_exp_num != 0) {
+    return nullptr;
+  }
+  const char *field_name = nullptr;
+  auto refer = [&field_name](const char *name) {
+    if (name == nullptr || 0 == strcmp(name, "*")) {
+      return false;
+    }
+    if (field_name == nullptr) {
+      field_name = name;
+    }
+    return 0 == strcmp(field_name, name);
+  };
+
+  for (size_t i = 0; i < selects.attr_num; i++) {
+    if (!refer(selects.attributes[i].attribute_name)) {
+      return nullptr;
+    }
+  }
+  for (size_t i = 0; i < selects.aggre_num; i++) {
+    const Aggregate &aggregate = selects.aggregates[i];
+    // count(*) 不需要任何字段
+    if (aggregate.is_attr == 0 || 0 == strcmp("*", aggregate.attr.attribute_name)) {
+      continue;
+    }
+    if (!refer(aggregate.attr.attribute_name)) {
+      return nullptr;
+    }
+  }
+  for (size_t i = 0; i < selects.order_num; i++) {
+    if (!refer(selects.order_by[i].attribute.attribute_name)) {
+      return nullptr;
+    }
+  }
+  for (size_t i = 0; i < selects.group_num; i++) {
+    if (!refer(selects.group_bys[i].attribute_name)) {
+      return nullptr;
+    }
+  }
+  for (size_t i = 0; i < selects.condition_num; i++) {
+    const Condition &condition = selects.conditions[i];
+    if (condition.left_ast != nullptr || condition.right_ast != nullptr ||
+        condition.left_is_select || condition.right_is_select) {
+      return nullptr;
+    }
+    if ((condition.left_is_attr && !refer(condition.left_attr.attribute_name)) ||
+        (condition.right_is_attr && !refer(condition.right_attr.attribute_name))) {
+      return nullptr;
+    }
+  }
+
+  // 索引里不包含null值，还要求where条件能够走这个索引，由Table::scan_record_index_only判断
+  if (field_name == nullptr || table->table_meta().find_index_by_field(field_name) == nullptr) {
+    return nullptr;
+  }
+  return field_name;
+}
+
 // 把所有的表和只跟这张表关联的condition都拿出来，生成最底层的select 执行节点
 RC create_selection_executor(Trx *trx, const Selects &selects, const char *db, const char *table_name, SelectExeNode &select_node) {
   // 列出跟这张表关联的Attr
@@ -577,7 +922,15 @@ RC create_selection_executor(Trx *trx, const Selects &selects, const char *db, c
       condition_filters.push_back(condition_filter);
     }
   }
-  return select_node.init(trx, table, std::move(schema), std::move(condition_filters));
+  RC rc = select_node.init(trx, table, std::move(schema), std::move(condition_filters));
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  const char *index_only_field = find_index_only_field(selects, table);
+  if (index_only_field != nullptr) {
+    select_node.set_index_only_field(index_only_field);
+  }
+  return rc;
 }
 
 RC create_field_index(const Selects &selects, const char *db, 
@@ -624,6 +977,12 @@ RC create_cartesian_executor(Trx *trx, const Selects &selects, const char *db, s
     TupleSchema::from_table(table, cartesian_schema);
   }
   
+  // join_order是relations中的下标，tuple_sets与relations的顺序相反
+  std::vector<int> join_order;
+  for (size_t i = 0; i < selects.join_order_num; i++) {
+    join_order.push_back(selects.relation_num - 1 - selects.join_order[i]);
+  }
+  cartesian_exe_node.set_join_order(std::move(join_order));
   return cartesian_exe_node.init(trx, std::move(tuple_sets), condition_filter, std::move(cartesian_schema));
 }
 
@@ -8,6 +8,7 @@
 #include "sql/executor/tuple.h"
 
 class SessionEvent;
+struct ExplainNode;
 
 class ExecuteStage : public common::Stage {
 public:
@@ -26,8 +27,13 @@ protected:
                      common::CallbackContext *context) override;
 
   void handle_request(common::StageEvent *event);
-  RC do_select(const char *db, Query *sql, SessionEvent *session_event);
-  RC do_select_v2(const char *db, Query *sql, SessionEvent *session_event);
+  /**
+   * plan不为nullptr时是EXPLAIN [ANALYZE]，在plan中返回执行计划。
+   * 只EXPLAIN时不读取表中的数据，EXPLAIN ANALYZE时正常执行并统计每个算子
+   */
+  RC do_select(const char *db, Query *sql, SessionEvent *session_event, ExplainNode *plan = nullptr);
+  RC do_select_v2(const char *db, Query *sql, SessionEvent *session_event, ExplainNode *plan = nullptr);
+  RC do_explain(const char *db, Query *sql, SessionEvent *session_event);
   RC do_aggregate(const char *db, Query *sql, SessionEvent *session_event);
 protected:
 private:
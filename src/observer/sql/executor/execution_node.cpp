@@ -1,9 +1,13 @@
 #include "algorithm"
+#include <string>
+#include <unordered_map>
 
 #include "sql/executor/execution_node.h"
 #include "storage/common/table.h"
 #include "common/log/log.h"
 #include "sql/executor/util.h"
+#include "sql/executor/external_sort.h"
+#include "sql/executor/aggregation_hash_table.h"
 
 SelectExeNode::SelectExeNode() : table_(nullptr) {
 }
@@ -35,10 +39,132 @@ RC SelectExeNode::execute(TupleSet &tuple_set) {
   tuple_set.clear();
   tuple_set.set_schema(tuple_schema_);
   TupleRecordConverter converter(table_, tuple_set);
-  RC rc = table_->scan_record(trx_, &condition_filter, -1, (void *)&converter, record_reader);
+  if (!index_only_field_.empty()) {
+    RC rc = table_->scan_record_index_only(trx_, &condition_filter, index_only_field_.c_str(), limit_,
+                                           (void *)&converter, record_reader);
+    if (rc != RC::SCHEMA_INDEX_NOT_EXIST) {
+      return rc;
+    }
+    LOG_TRACE("Index only scan is not available. table=%s, field=%s", table_->name(), index_only_field_.c_str());
+  }
+  if (parallel_degree_ > 1 && limit_ < 0) {
+    int morsel_count = table_->scan_morsel_count(&condition_filter);
+    if (morsel_count > 1) {
+      return execute_parallel(&condition_filter, morsel_count, tuple_set);
+    }
+  }
+  RC rc = table_->scan_record(trx_, &condition_filter, limit_, (void *)&converter, record_reader);
   return rc;
 }
 
+static RC morsel_record_reader(int worker, int morsel, const char *data, void *context) {
+  std::vector<std::unique_ptr<TupleRecordConverter>> &converters =
+      *(std::vector<std::unique_ptr<TupleRecordConverter>> *)context;
+  converters[morsel]->add_record(data);
+  return RC::SUCCESS;
+}
+
+RC SelectExeNode::execute_parallel(ConditionFilter *condition_filter, int morsel_count, TupleSet &tuple_set) {
+  // 每个morsel解码到自己的TupleSet中，扫描完成后按morsel的顺序拼接
+  std::vector<TupleSet> morsel_tuple_sets(morsel_count);
+  std::vector<std::unique_ptr<TupleRecordConverter>> converters;
+  for (TupleSet &morsel_tuple_set : morsel_tuple_sets) {
+    morsel_tuple_set.set_schema(tuple_schema_);
+    converters.emplace_back(new TupleRecordConverter(table_, morsel_tuple_set));
+  }
+  RC rc = table_->scan_record_parallel(trx_, condition_filter, parallel_degree_, morsel_count, (void *)&converters,
+                                       morsel_record_reader);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  for (TupleSet &morsel_tuple_set : morsel_tuple_sets) {
+    for (Tuple &tuple : morsel_tuple_set.tuples()) {
+      tuple_set.add(std::move(tuple));
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC SelectExeNode::aggregate_parallel(ParallelAggregator &aggregator, const std::vector<int> &key_index,
+                                     const std::vector<int> &value_index, bool &fused, int64_t &rows) {
+  fused = false;
+  rows = 0;
+  if (parallel_degree_ <= 1 || limit_ >= 0) {
+    return RC::SUCCESS;
+  }
+  CompositeConditionFilter condition_filter;
+  condition_filter.init((const ConditionFilter **)condition_filters_.data(), condition_filters_.size());
+  // 与execute的选择相同：覆盖索引可用时不并行扫描
+  if (!index_only_field_.empty()) {
+    std::vector<std::string> index_names;
+    table_->scan_index_names(&condition_filter, index_only_field_.c_str(), index_names);
+    if (!index_names.empty()) {
+      return RC::SUCCESS;
+    }
+  }
+  int morsel_count = table_->scan_morsel_count(&condition_filter);
+  if (morsel_count <= 1) {
+    return RC::SUCCESS;
+  }
+  fused = true;
+  return aggregator.aggregate_scan(table_, trx_, &condition_filter, morsel_count, tuple_schema_, key_index,
+                                   value_index, rows);
+}
+
+static std::string con_desc_to_string(const Table *table, const ConDesc &desc, AttrType type) {
+  if (desc.is_attr) {
+    const FieldMeta *field_meta = table->table_meta().find_field_by_offset(desc.attr_offset);
+    return std::string(table->name()) + "." + (field_meta != nullptr ? field_meta->name() : "?");
+  }
+  return value_to_string(type, desc.is_null ? nullptr : desc.value);
+}
+
+void SelectExeNode::explain(ExplainNode &node) {
+  CompositeConditionFilter condition_filter;
+  condition_filter.init((const ConditionFilter **)condition_filters_.data(), condition_filters_.size());
+
+  // 与execute的选择相同：先尝试覆盖索引，再尝试按条件走索引，都不行时全表扫描(可能并行)
+  node.name = "TableScan";
+  node.detail = table_->name();
+  std::vector<std::string> index_names;
+  if (!index_only_field_.empty()) {
+    table_->scan_index_names(&condition_filter, index_only_field_.c_str(), index_names);
+    if (!index_names.empty()) {
+      node.name = "IndexOnlyScan";
+    }
+  }
+  if (index_names.empty()) {
+    table_->scan_index_names(&condition_filter, nullptr, index_names);
+    if (!index_names.empty()) {
+      node.name = "IndexScan";
+    }
+  }
+  if (!index_names.empty()) {
+    node.detail += " index=" + index_names[0];
+    for (size_t i = 1; i < index_names.size(); i++) {
+      node.detail += "&" + index_names[i];
+    }
+  } else if (parallel_degree_ > 1 && limit_ < 0 && table_->scan_morsel_count(&condition_filter) > 1) {
+    node.detail += " parallel=" + std::to_string(parallel_degree_);
+  }
+  if (limit_ >= 0) {
+    node.detail += " limit=" + std::to_string(limit_);
+  }
+
+  std::string filters;
+  for (const DefaultConditionFilter *filter : condition_filters_) {
+    if (!filters.empty()) {
+      filters += " and ";
+    }
+    filters += con_desc_to_string(table_, filter->left(), filter->attr_type()) + " " +
+               comp_op_to_string(filter->comp_op()) + " " +
+               con_desc_to_string(table_, filter->right(), filter->attr_type());
+  }
+  if (!filters.empty()) {
+    node.detail += " filter: " + filters;
+  }
+}
+
 RC cartesianExeNode::init(Trx *trx, std::vector<TupleSet> &&tuple_sets, CompositeCartesianFilter *condition_filter, TupleSchema &&cartesian_schema) {
   trx_ = trx;
   tuple_sets_ = std::move(tuple_sets);
@@ -47,19 +173,212 @@ RC cartesianExeNode::init(Trx *trx, std::vector<TupleSet> &&tuple_sets, Composit
   return RC::SUCCESS;
 }
 
+bool cartesianExeNode::valid_join_order() const {
+  if (join_order_.size() != tuple_sets_.size()) {
+    return false;
+  }
+  std::vector<bool> seen(tuple_sets_.size(), false);
+  for (int table : join_order_) {
+    if (table < 0 || table >= (int)tuple_sets_.size() || seen[table]) {
+      return false;
+    }
+    seen[table] = true;
+  }
+  return true;
+}
+
+bool cartesianExeNode::match(const JoinCondition &condition, const int *row) const {
+  const Tuple &left = tuple_sets_[condition.left_table].get(row[condition.left_table]);
+  const Tuple &right = tuple_sets_[condition.right_table].get(row[condition.right_table]);
+  return condition.filter->filter(*left.get_pointer(condition.left_index), *right.get_pointer(condition.right_index));
+}
+
+// FLOATS的比较带有误差，不能作为hash key
+static bool hashable_type(AttrType type) {
+  return type == INTS || type == CHARS;
+}
+
+void cartesianExeNode::join_table(int table, const std::vector<bool> &joined, std::vector<JoinCondition> &conditions,
+                                  std::vector<int> &rows, int limit) const {
+  const int table_num = tuple_sets_.size();
+  const TupleSet &tuple_set = tuple_sets_[table];
+
+  // 加入table之后两侧都已经连接的条件，其中第一个两侧类型相同的等值条件作为hash key
+  std::vector<const JoinCondition *> step_conditions;
+  const JoinCondition *key = nullptr;
+  int key_index = -1;    // key在table中的下标
+  int probe_table = -1;  // key另一侧所在的表
+  int probe_index = -1;
+  for (JoinCondition &condition : conditions) {
+    if (condition.applied || (condition.left_table != table && condition.right_table != table)) {
+      continue;
+    }
+    if ((condition.left_table != table && !joined[condition.left_table]) ||
+        (condition.right_table != table && !joined[condition.right_table])) {
+      continue;
+    }
+    condition.applied = true;
+    if (key == nullptr && condition.filter->comp_op() == EQUAL_TO && condition.left_table != condition.right_table) {
+      bool left_is_table = condition.left_table == table;
+      int index = left_is_table ? condition.left_index : condition.right_index;
+      int other_table = left_is_table ? condition.right_table : condition.left_table;
+      int other_index = left_is_table ? condition.right_index : condition.left_index;
+      AttrType type = tuple_set.schema().field(index).type();
+      if (hashable_type(type) && type == tuple_sets_[other_table].schema().field(other_index).type()) {
+        key = &condition;
+        key_index = index;
+        probe_table = other_table;
+        probe_index = other_index;
+        continue;
+      }
+    }
+    step_conditions.push_back(&condition);
+  }
+
+  std::vector<int> all_rows;
+  std::unordered_map<int, std::vector<int>> int_table;
+  std::unordered_map<std::string, std::vector<int>> string_table;
+  const bool int_key = key != nullptr && tuple_set.schema().field(key_index).type() == INTS;
+  if (key == nullptr) {
+    all_rows.resize(tuple_set.size());
+    for (int i = 0; i < tuple_set.size(); i++) {
+      all_rows[i] = i;
+    }
+  } else {
+    for (int i = 0; i < tuple_set.size(); i++) {
+      const std::shared_ptr<TupleValue> &value = tuple_set.get(i).get_pointer(key_index);
+      if (value->Type() == UNDEFINED) {  // null与任何值都不相等
+        continue;
+      }
+      if (int_key) {
+        int_table[*(int *)value->value_pointer()].push_back(i);
+      } else {
+        string_table[*(std::string *)value->value_pointer()].push_back(i);
+      }
+    }
+  }
+
+  std::vector<int> result;
+  std::vector<int> new_row(table_num);
+  for (size_t base = 0; base < rows.size(); base += table_num) {
+    if (limit >= 0 && result.size() >= (size_t)limit * table_num) {
+      break;
+    }
+    const int *row = &rows[base];
+    const std::vector<int> *candidates = &all_rows;
+    if (key != nullptr) {
+      const std::shared_ptr<TupleValue> &value = tuple_sets_[probe_table].get(row[probe_table]).get_pointer(probe_index);
+      if (value->Type() == UNDEFINED) {
+        continue;
+      }
+      if (int_key) {
+        auto iter = int_table.find(*(int *)value->value_pointer());
+        if (iter == int_table.end()) {
+          continue;
+        }
+        candidates = &iter->second;
+      } else {
+        auto iter = string_table.find(*(std::string *)value->value_pointer());
+        if (iter == string_table.end()) {
+          continue;
+        }
+        candidates = &iter->second;
+      }
+    }
+    std::copy(row, row + table_num, new_row.begin());
+    for (int candidate : *candidates) {
+      new_row[table] = candidate;
+      bool valid = true;
+      for (const JoinCondition *condition : step_conditions) {
+        if (!match(*condition, new_row.data())) {
+          valid = false;
+          break;
+        }
+      }
+      if (valid) {
+        result.insert(result.end(), new_row.begin(), new_row.end());
+        if (limit >= 0 && result.size() >= (size_t)limit * table_num) {
+          break;
+        }
+      }
+    }
+  }
+  rows.swap(result);
+}
+
 RC cartesianExeNode::execute(TupleSet &tuple_set) {
   tuple_set.set_schema(cartesian_schema_);
-  for (auto iter = TupleSetDescartesIterator(&tuple_sets_); !iter.End(); ++iter) {
-    std::unique_ptr<std::vector<Tuple>> tuples = *iter;
+  const int table_num = tuple_sets_.size();
+
+  // 条件中的value_index是在笛卡尔积tuple中的下标，换算成所在的tuple_set和其中的下标
+  std::vector<int> offsets(table_num + 1, 0);
+  for (int i = 0; i < table_num; i++) {
+    offsets[i + 1] = offsets[i] + tuple_sets_[i].get_schema().fields().size();
+  }
+  auto locate = [&offsets](int value_index, int &table, int &index) {
+    table = std::upper_bound(offsets.begin(), offsets.end(), value_index) - offsets.begin() - 1;
+    index = value_index - offsets[table];
+  };
+  std::vector<JoinCondition> conditions;
+  for (const DefaultCartesianFilter *filter : condition_filter_->filters()) {
+    JoinCondition condition;
+    condition.filter = filter;
+    locate(filter->left().value_index, condition.left_table, condition.left_index);
+    locate(filter->right().value_index, condition.right_table, condition.right_index);
+    condition.applied = false;
+    conditions.push_back(condition);
+  }
+
+  std::vector<int> join_order = join_order_;
+  if (!valid_join_order()) {
+    join_order.resize(table_num);
+    for (int i = 0; i < table_num; i++) {
+      join_order[i] = i;
+    }
+  }
+
+  // 按tuple_sets的顺序连接时，生成的结果已经是输出的顺序，最后一张表连接出limit行就可以停止；
+  // 调整过连接顺序时，要连接出全部结果排序之后才能确定前limit行
+  bool natural_order = true;
+  for (int i = 0; i < table_num; i++) {
+    natural_order = natural_order && join_order[i] == i;
+  }
+
+  // 每table_num个数是一行结果在各个tuple_set中的行号，还没有连接的表为-1
+  std::vector<int> rows(table_num, -1);
+  std::vector<bool> joined(table_num, false);
+  for (int step = 0; step < table_num; step++) {
+    const int table = join_order[step];
+    join_table(table, joined, conditions, rows, natural_order && step == table_num - 1 ? limit_ : -1);
+    joined[table] = true;
+    if (rows.empty()) {
+      break;
+    }
+  }
+
+  const int row_num = rows.size() / table_num;
+  std::vector<int> sorted(row_num);
+  for (int i = 0; i < row_num; i++) {
+    sorted[i] = i;
+  }
+  if (!natural_order) {
+    std::sort(sorted.begin(), sorted.end(), [&rows, table_num](int lhs, int rhs) {
+      return std::lexicographical_compare(rows.begin() + (long)lhs * table_num, rows.begin() + (long)(lhs + 1) * table_num,
+                                          rows.begin() + (long)rhs * table_num, rows.begin() + (long)(rhs + 1) * table_num);
+    });
+  }
+  for (int row : sorted) {
+    if (limit_ >= 0 && tuple_set.size() >= limit_) {
+      break;
+    }
     Tuple tmp_tuple;
-    for (auto &tuple : *tuples) {
+    for (int table = 0; table < table_num; table++) {
+      const Tuple &tuple = tuple_sets_[table].get(rows[(long)row * table_num + table]);
       for (int i = 0; i < tuple.size(); i++) {
         tmp_tuple.add(tuple.get_pointer(i));
       }
     }
-    if (condition_filter_->filter(tmp_tuple)) {
-      tuple_set.add(std::move(tmp_tuple));
-    }
+    tuple_set.add(std::move(tmp_tuple));
   }
   return RC::SUCCESS;
 }
@@ -75,7 +394,42 @@ RC OrderByExeNode::init(Trx *trx, TupleSchema &&order_by_schema,
 RC OrderByExeNode::execute(TupleSet &tmp_tuple_set) {
   TupleSortUtil::set(*field_index_, order_by_schema_);
   std::vector<Tuple> &tuples = const_cast<std::vector<Tuple> &>(tmp_tuple_set.tuples());
-  std::sort(tuples.begin(), tuples.end(), TupleSortUtil::cmp);
+  if (limit_ >= 0 && limit_ < (int)tuples.size()) {
+    TupleTopN top_n(limit_, TupleSortUtil::cmp);
+    for (Tuple &tuple : tuples) {
+      top_n.add(std::move(tuple));
+    }
+    top_n.finish(tuples);
+    return RC::SUCCESS;
+  }
+
+  std::vector<int> key_index;
+  std::vector<int> orders;
+  for (const TupleField &field : order_by_schema_.fields()) {
+    key_index.push_back(field_index_->at(field.table_name()).at(field.field_name()));
+    orders.push_back(field.order());
+  }
+  ExternalSorter sorter(key_index, orders, sort_buffer_size_);
+  RC rc = RC::SUCCESS;
+  for (Tuple &tuple : tuples) {
+    if (rc == RC::SUCCESS) {
+      rc = sorter.add(std::move(tuple));
+    }
+  }
+  if (rc == RC::SUCCESS) {
+    rc = sorter.finish();
+  }
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to sort tuples. rc=%d:%s", rc, strrc(rc));
+    return rc;
+  }
+  for (Tuple &tuple : tuples) {
+    rc = sorter.next(tuple);
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to read sorted tuples. rc=%d:%s", rc, strrc(rc));
+      return rc;
+    }
+  }
   return RC::SUCCESS;
 }
 
@@ -3,11 +3,15 @@
 
 #include <vector>
 #include <map>
+#include <string>
 #include "storage/common/condition_filter.h"
 #include "sql/executor/tuple.h"
+#include "sql/executor/explain.h"
+#include "session/session.h"
 
 class Table;
 class Trx;
+class ParallelAggregator;
 
 class ExecutionNode {
 public:
@@ -24,16 +28,42 @@ public:
   virtual ~SelectExeNode();
 
   RC init(Trx *trx, Table *table, TupleSchema && tuple_schema, std::vector<DefaultConditionFilter *> &&condition_filters);
+  // 查询只用到这一个字段时，优先尝试只扫描该字段上的索引（覆盖索引）
+  void set_index_only_field(const char *field_name) { index_only_field_ = field_name; }
+  // 大于1时按morsel并行扫描，各morsel的结果按顺序拼接
+  void set_parallel_degree(int parallel_degree) { parallel_degree_ = parallel_degree; }
+  // 不需要排序和聚合时，扫描到limit条记录就停止
+  void set_limit(int limit) { limit_ = limit; }
 
   RC execute(TupleSet &tuple_set) override;
+  /**
+   * 扫描与局部聚合融合：可以并行扫描时，各线程把记录直接聚合到aggregator中自己的局部hash表，不物化扫描结果。
+   * 不能并行扫描(或者覆盖索引可用)时fused为false，由调用者用execute扫描。rows返回扫描出的记录数
+   */
+  RC aggregate_parallel(ParallelAggregator &aggregator, const std::vector<int> &key_index,
+                        const std::vector<int> &value_index, bool &fused, int64_t &rows);
+
+  // 所有字段的schema，EXPLAIN不扫描表时用来构造空的结果
+  const TupleSchema &schema() const { return tuple_schema_; }
+  // EXPLAIN：扫描的表、使用的索引、并行度和过滤条件
+  void explain(ExplainNode &node);
+private:
+  RC execute_parallel(ConditionFilter *condition_filter, int morsel_count, TupleSet &tuple_set);
+
 private:
   Trx *trx_ = nullptr;
   Table  * table_;
   TupleSchema  tuple_schema_; // all attribute schema
   std::vector<DefaultConditionFilter *> condition_filters_;
+  std::string index_only_field_;
+  int parallel_degree_ = 1;
+  int limit_ = -1;
 };
 
 // 用于生成全字段笛卡尔积
+// 按join_order依次连接各个表，每加入一张表就对已经连接的表求值所有能求值的条件，
+// 有可以作为hash key的等值条件时在新加入的表上建hash表。
+// 结果按各表在tuple_sets中的顺序排序，与直接迭代笛卡尔积后过滤的顺序相同
 class cartesianExeNode : public ExecutionNode {
 public:
   cartesianExeNode() = default;
@@ -44,11 +74,35 @@ public:
 
   RC execute(TupleSet &tuple_set) override;
 
+  // 不需要排序和聚合时，得到limit条结果就停止
+  void set_limit(int limit) { limit_ = limit; }
+  // tuple_sets的下标的连接顺序，不设置时按tuple_sets的顺序
+  void set_join_order(std::vector<int> &&join_order) { join_order_ = std::move(join_order); }
+
+private:
+  // 条件两侧在第几个tuple_set中以及在其中的下标
+  struct JoinCondition {
+    const DefaultCartesianFilter *filter;
+    int left_table;
+    int left_index;
+    int right_table;
+    int right_index;
+    bool applied;
+  };
+  bool valid_join_order() const;
+  // 把已经连接的各行rows与第table个tuple_set连接，求值此时可以求值的conditions，
+  // limit不小于0时得到limit行就停止
+  void join_table(int table, const std::vector<bool> &joined, std::vector<JoinCondition> &conditions,
+                  std::vector<int> &rows, int limit) const;
+  bool match(const JoinCondition &condition, const int *row) const;
+
 private:
   Trx *trx_ = nullptr;
+  int limit_ = -1;
   std::vector<TupleSet> tuple_sets_; // 多表的tuple_sets,用来迭代生成笛卡尔积
-  CompositeCartesianFilter *condition_filter_;
+  CompositeCartesianFilter *condition_filter_ = nullptr;
   TupleSchema cartesian_schema_;
+  std::vector<int> join_order_;
 };
 
 // 用于生成最终输出字段和记录
@@ -81,8 +135,16 @@ public:
           const std::map<std::string, std::map<std::string, int>> &field_index);
 
   RC execute(TupleSet &sorted_tuple_set) override;
+
+  // 只需要排在前面的limit个tuple时，用TupleTopN代替全部排序，执行后只保留这些tuple
+  void set_limit(int limit) { limit_ = limit; }
+  // 没有limit时使用ExternalSorter排序，超过这个大小的部分写到临时文件。
+  // 输入的TupleSet已经全部在内存中，峰值内存只在TopNExecutor中受sort_buffer_size限制
+  void set_sort_buffer_size(int sort_buffer_size) { sort_buffer_size_ = sort_buffer_size; }
 private:
   Trx *trx_ = nullptr;
+  int limit_ = -1;
+  int sort_buffer_size_ = Session::DEFAULT_SORT_BUFFER_SIZE;
   const std::map<std::string, std::map<std::string, int>> *field_index_;
   TupleSchema order_by_schema_; //存储需要order by关键字中的field
 };
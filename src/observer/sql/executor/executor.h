@@ -2,19 +2,38 @@
 #define MINIDB_EXECUTOR_H
 
 
+#include <memory>
+
 #include <storage/common/condition_filter.h>
 #include <storage/trx/trx.h>
 #include "tuple.h"
+#include "session/session.h"
+#include "column_batch.h"
+#include "explain.h"
 
 class ExecutorContext {
 public:
   explicit ExecutorContext(): trx_(nullptr) {}
+  ExecutorContext(int parallel_degree, int sort_buffer_size)
+      : trx_(nullptr), parallel_degree_(parallel_degree), sort_buffer_size_(sort_buffer_size) {}
 
   Trx * get_trx() {
     return trx_;
   }
+
+  // 查询内的并行度，来自session
+  int parallel_degree() const {
+    return parallel_degree_;
+  }
+
+  // 排序可以使用的内存，来自session
+  int sort_buffer_size() const {
+    return sort_buffer_size_;
+  }
 private:
   Trx *trx_ = nullptr;
+  int parallel_degree_ = 1;
+  int sort_buffer_size_ = Session::DEFAULT_SORT_BUFFER_SIZE;
 
 };
 
@@ -23,14 +42,89 @@ public:
   explicit Executor(ExecutorContext* context, const TupleSchema& output_schema): exe_ctx_(context), output_schema_(output_schema) {}
   virtual ~Executor() = default;
 
-  virtual RC init() = 0;
+  // init/next/next_batch由子类实现do_init/do_next/do_next_batch，这里在EXPLAIN ANALYZE时统计
+  RC init() {
+    OperatorTimer timer(stats_.get());
+    return do_init();
+  }
 
   /**
-   * 每次查询一批记录
-   * @param tuple_set 返回的查询结果，所有结果属于同一个Table
-   * @param filters 可以作为临时加入的查询条件，一般该条件在父节点执行过程中被确定
+   * 每次查询一批记录，最多BATCH_SIZE条，需要反复调用直到返回RECORD_EOF
+   * @param tuple_set 返回的查询结果，返回SUCCESS时不为空，返回RECORD_EOF时为空
+   * @param filters 可以作为临时加入的查询条件，一般该条件在父节点执行过程中被确定；
+   *                从开始(或rewind)到RECORD_EOF之间的每次调用必须传入相同的filters，
+   *                并且在RECORD_EOF或rewind之前不能释放(并行扫描在后台线程中使用它们)
    */
-  virtual RC next(TupleSet &tuple_set, std::vector<Filter*> *filters = nullptr) = 0;
+  RC next(TupleSet &tuple_set, std::vector<Filter*> *filters = nullptr) {
+    OperatorTimer timer(stats_.get());
+    RC rc = do_next(tuple_set, filters);
+    if (stats_ != nullptr && rc == RC::SUCCESS) {
+      stats_->rows += tuple_set.size();
+    }
+    return rc;
+  }
+
+  /**
+   * 列存格式的next，语义与next相同，batch中只有选中的行有效
+   */
+  RC next_batch(ColumnBatch &batch, std::vector<Filter*> *filters = nullptr) {
+    OperatorTimer timer(stats_.get());
+    RC rc = do_next_batch(batch, filters);
+    if (stats_ != nullptr && rc == RC::SUCCESS) {
+      stats_->rows += batch.size();
+    }
+    return rc;
+  }
+
+  /**
+   * 回到结果的开头，下一次next重新开始返回结果(可以带上不同的filters)。
+   * 用于nested loop join的内表和关联子查询的反复执行
+   */
+  virtual RC rewind() = 0;
+
+  /**
+   * 取出剩余的全部结果，合并到tuple_set中
+   */
+  RC next_all(TupleSet &tuple_set, std::vector<Filter*> *filters = nullptr) {
+    TupleSet batch;
+    RC rc;
+    while ((rc = next(batch, filters)) == RC::SUCCESS) {
+      if (tuple_set.get_schema().empty()) {
+        tuple_set.set_schema(batch.get_schema());
+      }
+      for (Tuple &tuple : batch.tuples()) {
+        tuple_set.add(std::move(tuple));
+      }
+    }
+    if (tuple_set.get_schema().empty()) {
+      tuple_set.set_schema(output_schema_);
+    }
+    return rc == RC::RECORD_EOF ? RC::SUCCESS : rc;
+  }
+
+  /**
+   * EXPLAIN ANALYZE：在执行之前调用，之后这个节点和所有子节点的init/next都会统计时间、页数和输出的行数
+   */
+  void enable_stats() {
+    stats_.reset(new OperatorStats());
+    for (Executor *child : children()) {
+      child->enable_stats();
+    }
+  }
+
+  /**
+   * 生成以这个节点为根的执行计划，在init之后调用。启用了统计时带上统计结果
+   */
+  void explain(ExplainNode &node) {
+    describe(node);
+    if (stats_ != nullptr) {
+      node.stats = *stats_;
+    }
+    for (Executor *child : children()) {
+      node.children.emplace_back();
+      child->explain(node.children.back());
+    }
+  }
 
   TupleSchema output_schema() {
     return output_schema_;
@@ -40,9 +134,40 @@ public:
     output_schema_ = output_schema;
   }
 
+public:
+  static const int BATCH_SIZE = 1024;
+
+protected:
+  virtual RC do_init() = 0;
+  virtual RC do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) = 0;
+
+  /**
+   * 默认实现调用do_next再转换为列存，ScanExecutor直接把记录解码到各列中
+   */
+  virtual RC do_next_batch(ColumnBatch &batch, std::vector<Filter*> *filters) {
+    TupleSet tuple_set;
+    RC rc = do_next(tuple_set, filters);
+    if (rc != RC::SUCCESS) {
+      batch.init(output_schema_);
+      return rc;
+    }
+    batch.from_tuple_set(tuple_set);
+    return RC::SUCCESS;
+  }
+
+  // EXPLAIN中这个节点的名字和说明，不包括子节点
+  virtual void describe(ExplainNode &node) = 0;
+  // EXPLAIN中列出的子节点
+  virtual std::vector<Executor *> children() = 0;
+  // 不经过init/next完成的工作(如扫描与聚合融合)由子类自己统计，只有EXPLAIN ANALYZE时不为空
+  OperatorStats *stats() { return stats_.get(); }
+
 protected:
   ExecutorContext *exe_ctx_;
   TupleSchema  output_schema_;
+
+private:
+  std::unique_ptr<OperatorStats> stats_;  // 只有EXPLAIN ANALYZE时不为空
 };
 
 
@@ -1,6 +1,63 @@
+#include <algorithm>
+
 #include "executor_builder.h"
 #include "nest_loop_join_executor.h"
+#include "hash_join_executor.h"
+#include "index_nest_loop_join_executor.h"
 #include "agg_executor.h"
+#include "limit_executor.h"
+#include "top_n_executor.h"
+#include "session/session.h"
+#include "common/log/log.h"
+
+// 左侧每一行在索引上查找一次的代价，相对于顺序扫描一条记录
+static const double INDEX_LOOKUP_COST = 4;
+
+// 估计扫描输出的行数。没有统计信息，与常量等值比较的选择率按1/10，其它比较按1/3
+static double estimate_scan_rows(ScanExecutor *scan) {
+  if (scan->ban_all()) {
+    return 0;
+  }
+  double rows = scan->table()->estimate_record_count();
+  for (Filter *filter : scan->condition_filters()) {
+    rows *= filter->comp_op() == EQUAL_TO ? 0.1 : 0.33;
+  }
+  return rows;
+}
+
+// 右表的连接属性上有索引并且左侧的行数足够少时使用index nested loop join，
+// 否则连接条件中有 左表属性 = 右表属性 时使用hash join，都没有时使用nested loop join。
+// left_rows为左侧估计的行数，返回时更新为连接结果估计的行数：等值连接假设连接属性在较大的一侧上是唯一的
+static Executor *new_join_executor(ExecutorContext *context, const TupleSchema &join_output_schema,
+                                   Executor *left_executor, ScanExecutor *right_executor,
+                                   std::vector<Filter*> &join_filters, bool ban_all, double &left_rows) {
+  TupleSchema left_schema = left_executor->output_schema();
+  TupleSchema right_schema = right_executor->output_schema();
+  double right_rows = estimate_scan_rows(right_executor);
+  int left_key_index;
+  const FieldMeta *right_key_field;
+  if (IndexNestLoopJoinExecutor::find_index_key(join_filters, left_schema, right_executor->table(),
+                                                &left_key_index, &right_key_field)
+      && left_rows * INDEX_LOOKUP_COST < right_executor->table()->estimate_record_count()) {
+    LOG_DEBUG("Use index nested loop join on %s.%s", right_executor->table()->name(), right_key_field->name());
+    left_rows = std::min(left_rows, right_rows);
+    return new IndexNestLoopJoinExecutor(context, join_output_schema, left_executor, right_executor, join_filters, ban_all);
+  }
+  if (HashJoinExecutor::has_equi_condition(join_filters, left_schema, right_schema)) {
+    left_rows = std::min(left_rows, right_rows);
+    return new HashJoinExecutor(context, join_output_schema, left_executor, right_executor, join_filters, ban_all);
+  }
+  left_rows *= right_rows;
+  return new NestLoopJoinExecutor(context, join_output_schema, left_executor, right_executor, join_filters, ban_all);
+}
+
+ExecutorContext *ExecutorBuilder::new_context() {
+  if (session_event_ == nullptr) {
+    return new ExecutorContext();
+  }
+  Session *session = session_event_->get_client()->session;
+  return new ExecutorContext(session->parallel_degree(), session->sort_buffer_size());
+}
 
 // select with join and subselects
 Executor* ExecutorBuilder::build() {
@@ -8,18 +65,174 @@ Executor* ExecutorBuilder::build() {
 }
 
 Executor* ExecutorBuilder::build(Selects *selects) {
+  if (root_selects_ == nullptr) {
+    // 第一次build的是最外层的查询，子查询中关联的外层字段也在这里收集
+    root_selects_ = selects;
+    collect_referenced_fields(selects, true);
+    late_materialize_ = use_late_materialize(selects);
+  }
   Executor *select_executor = build_select_executor(selects);
   Executor *executor = build_join_executor(select_executor, selects);
+  if (selects == root_selects_ && !late_tables_.empty()) {
+    executor = new LateMaterializeExecutor(new_context(), executor, std::move(late_tables_));
+    late_tables_.clear();
+  }
 
   if (selects->aggre_num != 0) {
     TupleSchema output_schema;
     AggExecutor::build_agg_output_schema(db_, selects, output_schema);
-    executor = new AggExecutor(new ExecutorContext(), output_schema, executor);
+    executor = new AggExecutor(new_context(), output_schema, executor);
+  } else if (selects->order_num != 0) {
+    // 子节点保留完整的字段，排序之后再投影
+    executor = new TopNExecutor(new_context(), build_output_schema(selects), executor,
+                                build_order_by_schema(selects), selects->limit);
+    return executor;
   } else {
     executor->set_output_schema(build_output_schema(selects));
   }
+  if (selects->limit >= 0) {
+    executor = new LimitExecutor(new_context(), executor, selects->limit);
+  }
   return executor;
-} 
+}
+
+void ExecutorBuilder::add_referenced_field(const RelAttr &attr, std::set<std::string> &fields) {
+  std::string field(attr.relation_name == nullptr ? "*" : attr.relation_name);
+  field.append(".");
+  field.append(attr.attribute_name == nullptr ? "*" : attr.attribute_name);
+  fields.insert(field);
+}
+
+bool ExecutorBuilder::field_referenced(const std::set<std::string> &fields, const char *table_name,
+                                       const char *field_name) {
+  std::string table(table_name);
+  return fields.count("*.*") != 0 || fields.count(table + ".*") != 0 ||
+         fields.count(table + "." + field_name) != 0 || fields.count(std::string("*.") + field_name) != 0;
+}
+
+void ExecutorBuilder::collect_referenced_fields(Selects *selects, bool outermost) {
+  if (selects->attr_exp_num != 0) {
+    reference_all_ = true;
+  }
+  for (size_t i = 0; i < selects->attr_num; i++) {
+    add_referenced_field(selects->attributes[i], outermost ? output_fields_ : referenced_fields_);
+  }
+  for (size_t i = 0; i < selects->aggre_num; i++) {
+    // count(*)不引用任何字段
+    if (selects->aggregates[i].is_attr && 0 != strcmp("*", selects->aggregates[i].attr.attribute_name)) {
+      add_referenced_field(selects->aggregates[i].attr, referenced_fields_);
+    }
+  }
+  for (size_t i = 0; i < selects->group_num; i++) {
+    add_referenced_field(selects->group_bys[i], referenced_fields_);
+  }
+  for (size_t i = 0; i < selects->order_num; i++) {
+    add_referenced_field(selects->order_by[i].attribute, referenced_fields_);
+  }
+  auto collect_conditions = [this](Condition conditions[], size_t condition_num) {
+    for (size_t i = 0; i < condition_num; i++) {
+      Condition &condition = conditions[i];
+      if (condition.left_ast != nullptr || condition.right_ast != nullptr) {
+        reference_all_ = true;
+      }
+      if (condition.left_is_select) {
+        collect_referenced_fields(condition.left_selects, false);
+      } else if (condition.left_is_attr) {
+        add_referenced_field(condition.left_attr, referenced_fields_);
+      }
+      if (condition.right_is_select) {
+        collect_referenced_fields(condition.right_selects, false);
+      } else if (condition.right_is_attr) {
+        add_referenced_field(condition.right_attr, referenced_fields_);
+      }
+    }
+  };
+  collect_conditions(selects->conditions, selects->condition_num);
+  for (size_t i = 0; i < selects->join_num; i++) {
+    collect_conditions(selects->joins[i].conditions, selects->joins[i].condition_num);
+  }
+}
+
+bool ExecutorBuilder::use_late_materialize(Selects *selects) const {
+  if (reference_all_ || selects->aggre_num != 0 || selects->relation_num + selects->join_num < 2) {
+    return false;
+  }
+  auto has_join_condition = [](const Condition conditions[], size_t condition_num) {
+    for (size_t i = 0; i < condition_num; i++) {
+      const Condition &condition = conditions[i];
+      if (condition.left_is_attr && condition.right_is_attr && !condition.left_is_select && !condition.right_is_select
+          && condition.left_attr.relation_name != nullptr && condition.right_attr.relation_name != nullptr
+          && 0 != strcmp(condition.left_attr.relation_name, condition.right_attr.relation_name)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  if (has_join_condition(selects->conditions, selects->condition_num)) {
+    return true;
+  }
+  for (size_t i = 0; i < selects->join_num; i++) {
+    if (has_join_condition(selects->joins[i].conditions, selects->joins[i].condition_num)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ExecutorBuilder::build_scan_schema(Selects *selects, Table *table, TupleSchema &schema) {
+  if (reference_all_) {
+    TupleSchema::from_table(table, schema);
+    return;
+  }
+  bool late = late_materialize_ && selects == root_selects_;
+  LateMaterializeExecutor::LateTable late_table{table, TupleSchema()};
+  const TableMeta &table_meta = table->table_meta();
+  const FieldMeta *first_field = nullptr;
+  for (int i = 0; i < table_meta.field_num(); i++) {
+    const FieldMeta *field_meta = table_meta.field(i);
+    if (!field_meta->visible()) {
+      continue;
+    }
+    if (first_field == nullptr) {
+      first_field = field_meta;
+    }
+    bool referenced = field_referenced(referenced_fields_, table->name(), field_meta->name());
+    bool output = field_referenced(output_fields_, table->name(), field_meta->name());
+    if (late && output && !referenced) {
+      late_table.fields.add(field_meta->type(), table->name(), field_meta->name(), 0);
+    } else if (referenced || output) {
+      schema.add(field_meta->type(), table->name(), field_meta->name(), 0);
+    }
+  }
+  if (!late_table.fields.empty()) {
+    schema.add(INTS, table->name(), TupleRecordConverter::RID_PAGE_FIELD, 0);
+    schema.add(INTS, table->name(), TupleRecordConverter::RID_SLOT_FIELD, 0);
+    late_tables_.push_back(std::move(late_table));
+  }
+  // 例如 count(*)，不需要任何字段，保留一个字段使每条记录仍然对应一个tuple
+  if (schema.fields().empty() && first_field != nullptr) {
+    schema.add(first_field->type(), table->name(), first_field->name(), 0);
+  }
+}
+
+TupleSchema ExecutorBuilder::build_order_by_schema(Selects *selects) {
+  TupleSchema order_by_schema;
+  for (size_t i = 0; i < selects->order_num; i++) {
+    RelAttr &attr = selects->order_by[i].attribute;
+    if (attr.relation_name == nullptr) {
+      // 与relations[0]分别释放，不能共用同一个字符串
+      attr.relation_name = strdup(selects->relations[0]);
+    }
+    Table *table = db_->find_table(attr.relation_name);
+    const FieldMeta *field_meta = table == nullptr ? nullptr : table->table_meta().field(attr.attribute_name);
+    if (field_meta == nullptr) {
+      LOG_WARN("No such order by field. %s.%s", attr.relation_name, attr.attribute_name);
+      continue;
+    }
+    order_by_schema.add_if_not_exists(field_meta->type(), table->name(), field_meta->name(), selects->order_by[i].order);
+  }
+  return order_by_schema;
+}
 
 TupleSchema ExecutorBuilder::build_output_schema(Selects *selects) {
   TupleSchema output_schema;
@@ -38,7 +251,7 @@ TupleSchema ExecutorBuilder::build_output_schema(Selects *selects) {
       RelAttr &attr = selects->attributes[i];
       // 前置校验项，对于多表查询，必须指定relation_name
       if (attr.relation_name == NULL) {
-        attr.relation_name = selects->relations[0];
+        attr.relation_name = strdup(selects->relations[0]);
       }
       Table *table = db_->find_table(attr.relation_name);
       if (0 == strcmp("*", attr.attribute_name)) {
@@ -59,20 +272,31 @@ TupleSchema ExecutorBuilder::build_output_schema(Selects *selects) {
  */
 Executor* ExecutorBuilder::build_select_executor(Selects *selects) {
   assert(selects->relation_num > 0);
-  auto *context = new ExecutorContext();
-  Table *table = DefaultHandler::get_default().find_table(db_->name(), selects->relations[selects->relation_num-1]);
+  auto *context = new_context();
+  // 按OptimizeStage选出的顺序连接FROM中的表，没有时按FROM中的顺序
+  std::vector<int> join_order;
+  if (selects->join_order_num == selects->relation_num) {
+    join_order.assign(selects->join_order, selects->join_order + selects->join_order_num);
+  } else {
+    for (int i = selects->relation_num - 1; i >= 0; --i) {
+      join_order.push_back(i);
+    }
+  }
+  Table *table = db_->find_table(selects->relations[join_order[0]]);
   TupleSchema output_schema0;
-  TupleSchema::from_table(table, output_schema0);
+  build_scan_schema(selects, table, output_schema0);
   std::vector<Filter*> filters0;
   bool ban_all0 = false;
   Filter::from_condition(selects->conditions, selects->condition_num, table, filters0, ban_all0, false, db_);
-  Executor *left_executor = new ScanExecutor(context, table, output_schema0, std::move(filters0), ban_all0);
-  Executor *right_executor;
+  ScanExecutor *scan_executor0 = new ScanExecutor(context, table, output_schema0, std::move(filters0), ban_all0);
+  estimated_rows_ = estimate_scan_rows(scan_executor0);
+  Executor *left_executor = scan_executor0;
+  ScanExecutor *right_executor;
 
-  for (int i = selects->relation_num - 2; i >= 0; --i) {
-    table = DefaultHandler::get_default().find_table(db_->name(), selects->relations[i]);
+  for (size_t i = 1; i < join_order.size(); ++i) {
+    table = db_->find_table(selects->relations[join_order[i]]);
     TupleSchema output_schema;
-    TupleSchema::from_table(table, output_schema);
+    build_scan_schema(selects, table, output_schema);
     std::vector<Filter*> filters;
     bool ban_all = false;
     Filter::from_condition(selects->conditions, selects->condition_num, table, filters, ban_all, false, db_);
@@ -83,7 +307,8 @@ Executor* ExecutorBuilder::build_select_executor(Selects *selects) {
     join_output_schema.append(right_executor->output_schema());
     std::vector<Filter*> join_filters;
     Filter::from_condition(selects->conditions, selects->condition_num, nullptr, join_filters, ban_all, true, db_);
-    left_executor = new NestLoopJoinExecutor(context, join_output_schema, left_executor, right_executor, join_filters, ban_all);
+    left_executor = new_join_executor(context, join_output_schema, left_executor, right_executor, join_filters, ban_all,
+                                      estimated_rows_);
   }
   left_executor = build_sub_query_executor(left_executor, selects->relations[0], selects->conditions, selects->condition_num);
   return left_executor;
@@ -98,14 +323,14 @@ Executor* ExecutorBuilder::build_select_executor(Selects *selects) {
 Executor* ExecutorBuilder::build_join_executor(Executor *executor, Selects *selects) {
   assert(executor);
   Table *table;
-  auto *context = new ExecutorContext();
+  auto *context = new_context();
 
   Executor *left_executor = executor;
-  Executor *right_executor = nullptr;
+  ScanExecutor *right_executor = nullptr;
   for (int i = 0; i < selects->join_num; ++i) {
-    table = DefaultHandler::get_default().find_table(db_->name(), selects->joins[i].table_name);
+    table = db_->find_table(selects->joins[i].table_name);
     TupleSchema output_schema;
-    TupleSchema::from_table(table, output_schema);
+    build_scan_schema(selects, table, output_schema);
     std::vector<Filter*> filters;
     bool ban_all = false;
     Filter::from_condition(selects->joins[i].conditions, selects->joins[i].condition_num, table, filters, ban_all, false, db_);
@@ -122,7 +347,8 @@ Executor* ExecutorBuilder::build_join_executor(Executor *executor, Selects *sele
     if (i == selects->join_num - 1 && !ban_all) { // 对于最后一个join，需要对join_condition和selects->condition中的条件一起进行过滤
       Filter::from_condition(selects->conditions, selects->condition_num, nullptr, join_filters, ban_all, true, db_);
     }
-    left_executor = new NestLoopJoinExecutor(context, join_output_schema, left_executor, right_executor, join_filters, ban_all);
+    left_executor = new_join_executor(context, join_output_schema, left_executor, right_executor, join_filters, ban_all,
+                                      estimated_rows_);
     // sub query in join conditions
     left_executor = build_sub_query_executor(left_executor, selects->relations[0], selects->joins[i].conditions, selects->joins[i].condition_num);
   }
@@ -5,10 +5,13 @@
 #include <sql/parser/parse_defs.h>
 #include <event/session_event.h>
 #include <storage/default/default_handler.h>
+#include <set>
+#include <string>
 #include "rc.h"
 #include "executor.h"
 #include "scan_executor.h"
 #include "sub_query_executor.h"
+#include "late_materialize_executor.h"
 
 class ExecutorBuilder {
 public:
@@ -29,12 +32,38 @@ public:
 
   TupleSchema build_output_schema(Selects *selects);
 
+  TupleSchema build_order_by_schema(Selects *selects);
+
+  // 扫描selects中的table时需要读出的字段，不需要的字段(包括TEXT)不会从记录中解析出来。
+  // 延迟物化时最外层查询中只用于输出的字段不在这里读取，改为输出rid，记录到late_tables_中。
+  // 引用到的字段在build最外层查询时收集
+  void build_scan_schema(Selects *selects, Table *table, TupleSchema &schema);
+
+private:
+  ExecutorContext *new_context();
+
+  // 收集整个查询(包括子查询)中引用到的字段，最外层查询的select列单独记录
+  void collect_referenced_fields(Selects *selects, bool outermost);
+  static void add_referenced_field(const RelAttr &attr, std::set<std::string> &fields);
+  static bool field_referenced(const std::set<std::string> &fields, const char *table_name, const char *field_name);
+  // 最外层查询是否使用延迟物化：多表之间有连接条件，join可能过滤掉大部分记录
+  bool use_late_materialize(Selects *selects) const;
 
 
 private:
   Db *db_;
   Query *sql_;
   SessionEvent *session_event_;
+  double estimated_rows_ = 0;  // build_select_executor和build_join_executor中当前左侧估计的行数
+
+  // 引用到的字段，格式为 表名.字段名，没有指定表名时表名为*，select * 对应 *.*
+  std::set<std::string> referenced_fields_;  // 过滤、连接、分组、排序、子查询用到的字段
+  std::set<std::string> output_fields_;      // 最外层查询的select列
+  Selects *root_selects_ = nullptr;          // 最外层的查询
+  bool reference_all_ = false;  // 有表达式时不做投影下推
+
+  bool late_materialize_ = false;
+  std::vector<LateMaterializeExecutor::LateTable> late_tables_;
 };
 
 
@@ -1,34 +1,73 @@
 #include "sql/executor/exp_execution_node.h"
 #include "sql/executor/util.h"
+#include "common/log/log.h"
+#include <algorithm>
 
 RC ExpExeNode::init(TupleSchema &&output_tuple_schema, TupleSet &&tuple_set, CompositeExpressionFilter *condition_filter,
                     const std::map<std::string, std::map<std::string, int>> &field_index) {
     output_tuple_schema_ = output_tuple_schema;
     condition_filter_ = condition_filter;
     tuple_set_ = std::move(tuple_set);
-    field_index_ = &field_index;
+
+    // 字段的下标和表达式只在这里解析一次
+    field_value_index_.clear();
+    for (const auto & field : output_tuple_schema_.fields()) {
+        field_value_index_.push_back(field_index.at(field.table_name()).at(field.field_name()));
+    }
+    exps_.clear();
+    exps_.resize(output_tuple_schema_.get_exps().size());
+    for (size_t i = 0; i < exps_.size(); i++) {
+        RC rc = exps_[i].compile(output_tuple_schema_.get_exps()[i], field_index);
+        if (rc != RC::SUCCESS) {
+            LOG_WARN("Failed to compile select expression. rc=%d:%s", rc, strrc(rc));
+            return rc;
+        }
+    }
     return RC::SUCCESS;
 }
 
 RC ExpExeNode::execute(TupleSet &output_tuple_set) {
-    RC rc = RC::SUCCESS;
     output_tuple_set.clear();
     output_tuple_set.set_schema(output_tuple_schema_);
-    std::vector<Tuple> &tuples = const_cast<std::vector<Tuple> &>(tuple_set_.tuples());
-    for (const Tuple &tuple : tuples) {
-        if (condition_filter_->filter(tuple)) {
+    const std::vector<Tuple> &tuples = tuple_set_.tuples();
+    std::vector<const Tuple *> batch;
+    std::vector<char> selected;
+    std::vector<std::vector<float>> exp_values(exps_.size());
+    std::vector<std::vector<char>> exp_valid(exps_.size());
+    for (size_t begin = 0; begin < tuples.size(); begin += BATCH_SIZE) {
+        size_t end = std::min(tuples.size(), begin + BATCH_SIZE);
+        batch.clear();
+        for (size_t i = begin; i < end; i++) {
+            batch.push_back(&tuples[i]);
+        }
+        selected.assign(batch.size(), 1);
+        condition_filter_->filter_batch(batch, selected);
+        size_t selected_num = 0;
+        for (size_t i = 0; i < batch.size(); i++) {
+            if (selected[i]) {
+                batch[selected_num++] = batch[i];
+            }
+        }
+        batch.resize(selected_num);
+
+        // 表达式按列计算整批通过过滤的tuple
+        for (size_t i = 0; i < exps_.size(); i++) {
+            exps_[i].evaluate(batch, exp_values[i], exp_valid[i]);
+        }
+        for (size_t row = 0; row < batch.size(); row++) {
+            const Tuple &tuple = *batch[row];
             Tuple output_tuple;
             // 1. 构造普通字段
-            for (const auto & field : output_tuple_schema_.fields()) {
-                int value_index = field_index_->at(field.table_name()).at(field.field_name());
+            for (int value_index : field_value_index_) {
                 output_tuple.add(tuple.get_pointer(value_index));
             }
-            // 2. 构造表达式字段
-            for (const auto & exp : output_tuple_schema_.get_exps()) {
-                std::shared_ptr<TupleValue> value;
-                rc = AstUtil::Calculate(value, tuple, *field_index_, exp);
-                assert(rc == RC::SUCCESS);
-                output_tuple.add(value);
+            // 2. 构造表达式字段，计算出错(例如除0)时输出null
+            for (size_t i = 0; i < exps_.size(); i++) {
+                if (exp_valid[i][row]) {
+                    output_tuple.add(exp_values[i][row]);
+                } else {
+                    output_tuple.add_null();
+                }
             }
             output_tuple_set.add(std::move(output_tuple));
         }
@@ -51,6 +90,7 @@ RC create_expression_executor(const Selects &selects, ExpExeNode &exp_exe_node,
             left_cond.exp_ast = condition.left_ast;
         } else if (condition.left_is_attr) {
             const char *table_name = (condition.left_attr.relation_name == nullptr ? selects.relations[0] : condition.left_attr.relation_name);
+            left_cond.is_attr = 1;
             left_cond.value_index = field_index.at(table_name).at(condition.left_attr.attribute_name);
         } else {
             left_cond.value = condition.left_value;
@@ -59,12 +99,20 @@ RC create_expression_executor(const Selects &selects, ExpExeNode &exp_exe_node,
             right_cond.exp_ast = condition.right_ast;
         } else if (condition.right_is_attr) {
             const char *table_name = (condition.right_attr.relation_name == nullptr ? selects.relations[0] : condition.right_attr.relation_name);
+            right_cond.is_attr = 1;
             right_cond.value_index = field_index.at(table_name).at(condition.right_attr.attribute_name);
         } else {
             right_cond.value = condition.right_value;
         }
         auto *condition_filter = new DefaultExpressionFilter();
-        condition_filter->init(left_cond, right_cond, condition.comp, field_index);
+        RC rc = condition_filter->init(left_cond, right_cond, condition.comp, field_index);
+        if (rc != RC::SUCCESS) {
+            delete condition_filter;
+            for (DefaultExpressionFilter *filter : condition_filters) {
+                delete filter;
+            }
+            return rc;
+        }
         condition_filters.push_back(condition_filter);
     }
     CompositeExpressionFilter *composite_condition_filter = new CompositeExpressionFilter();
@@ -8,15 +8,19 @@ public:
   ExpExeNode() = default;
   ~ExpExeNode() { delete condition_filter_; }
 
+  // 每次过滤和计算表达式的tuple个数
+  static const int BATCH_SIZE = 1024;
+
   RC init(TupleSchema &&output_tuple_schema, TupleSet &&tuple_set, CompositeExpressionFilter *condition_filter,
           const std::map<std::string, std::map<std::string, int>> &field_index);
 
   RC execute(TupleSet &output_tuple_set) override;
 private:
   TupleSchema output_tuple_schema_; // output schema
-  CompositeExpressionFilter *condition_filter_; // expression filter
+  CompositeExpressionFilter *condition_filter_ = nullptr; // expression filter
   TupleSet tuple_set_;
-  const std::map<std::string, std::map<std::string, int>> *field_index_;
+  std::vector<int> field_value_index_;    // 普通字段在tuple中的下标
+  std::vector<CompiledExpression> exps_;  // 编译好的表达式字段
 };
 
 RC create_expression_executor(const Selects &selects, ExpExeNode &exp_exe_node, TupleSet &&tuple_set, TupleSchema &output_schema, const std::map<std::string, std::map<std::string, int>> &field_index);
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <sstream>
+
+#include "sql/executor/explain.h"
+#include "sql/executor/tuple.h"
+#include "sql/executor/value.h"
+#include "storage/common/condition_filter.h"
+#include "storage/default/disk_buffer_pool.h"
+
+OperatorTimer::OperatorTimer(OperatorStats *stats) : stats_(stats) {
+  if (stats_ != nullptr) {
+    start_ = std::chrono::steady_clock::now();
+    pages_hit_ = DiskBufferPool::thread_pages_hit();
+    pages_read_ = DiskBufferPool::thread_pages_read();
+  }
+}
+
+OperatorTimer::~OperatorTimer() {
+  if (stats_ != nullptr) {
+    stats_->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    stats_->pages_hit += DiskBufferPool::thread_pages_hit() - pages_hit_;
+    stats_->pages_read += DiskBufferPool::thread_pages_read() - pages_read_;
+  }
+}
+
+static void print_node(const ExplainNode &node, bool analyze, int depth, std::ostream &os) {
+  if (depth > 0) {
+    os << std::string(depth * 2 - 2, ' ') << "-> ";
+  }
+  os << node.name;
+  if (!node.detail.empty()) {
+    os << " " << node.detail;
+  }
+  if (analyze) {
+    const OperatorStats &stats = node.stats;
+    char buf[128];
+    snprintf(buf, sizeof(buf), "  (rows=%lu time=%.3fms pages_hit=%lu pages_read=%lu)",
+             stats.rows, stats.seconds * 1000, stats.pages_hit, stats.pages_read);
+    os << buf;
+  }
+  os << std::endl;
+  for (const ExplainNode &child : node.children) {
+    print_node(child, analyze, depth + 1, os);
+  }
+}
+
+void print_explain(const ExplainNode &root, bool analyze, std::ostream &os) {
+  print_node(root, analyze, 0, os);
+}
+
+const char *comp_op_to_string(CompOp comp_op) {
+  switch (comp_op) {
+    case EQUAL_TO:
+      return "=";
+    case LESS_EQUAL:
+      return "<=";
+    case NOT_EQUAL:
+      return "<>";
+    case LESS_THAN:
+      return "<";
+    case GREAT_EQUAL:
+      return ">=";
+    case GREAT_THAN:
+      return ">";
+    case IS:
+      return "is";
+    case IS_NOT:
+      return "is not";
+    case IN_OP:
+      return "in";
+    case NOT_IN_OP:
+      return "not in";
+    default:
+      return "?";
+  }
+}
+
+std::string value_to_string(AttrType type, const void *data) {
+  if (data == nullptr) {
+    return "null";
+  }
+  std::stringstream ss;
+  switch (type) {
+    case INTS: {
+      ss << *(const int *)data;
+    } break;
+    case FLOATS: {
+      FloatValue(*(const float *)data).to_string(ss);
+    } break;
+    case CHARS:
+    case DATES:
+    case TEXTS: {
+      ss << "'" << (const char *)data << "'";
+    } break;
+    default: {
+      ss << "?";
+    } break;
+  }
+  return ss.str();
+}
+
+static std::string filter_desc_to_string(const FilterDesc &desc) {
+  if (desc.is_attr) {
+    return desc.table_name.empty() ? desc.field_name : desc.table_name + "." + desc.field_name;
+  }
+  return value_to_string(desc.value.type, desc.value.isnull ? nullptr : desc.value.data);
+}
+
+std::string filter_to_string(Filter &filter) {
+  return filter_desc_to_string(filter.left()) + " " + comp_op_to_string(filter.comp_op()) + " " +
+         filter_desc_to_string(filter.right());
+}
+
+std::string filters_to_string(const std::vector<Filter *> &filters) {
+  std::string result;
+  for (Filter *filter : filters) {
+    if (!result.empty()) {
+      result += " and ";
+    }
+    result += filter_to_string(*filter);
+  }
+  return result;
+}
+
+std::string schema_to_string(TupleSchema &schema) {
+  std::stringstream ss;
+  if (!schema.fields().empty() || !schema.Get_agg_descs().empty() || schema.has_expression()) {
+    schema.print(ss, true);
+  }
+  std::string result = ss.str();
+  while (!result.empty() && result.back() == '\n') {
+    result.pop_back();
+  }
+  return result;
+}
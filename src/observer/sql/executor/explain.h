@@ -0,0 +1,73 @@
+#ifndef __OBSERVER_SQL_EXECUTOR_EXPLAIN_H__
+#define __OBSERVER_SQL_EXECUTOR_EXPLAIN_H__
+
+#include <stdint.h>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "sql/parser/parse_defs.h"
+
+class Filter;
+class TupleSchema;
+
+/**
+ * EXPLAIN ANALYZE中一个算子的统计，包含它的子节点：
+ * rows为算子输出的行数，seconds为在这个算子中(包括调用子节点)花费的时间，
+ * pages_hit/pages_read为这段时间里当前线程在buffer pool中命中的页数和从磁盘读入的页数。
+ * 并行扫描时工作线程访问的页不计算在内
+ */
+struct OperatorStats {
+  uint64_t rows = 0;
+  double seconds = 0;
+  uint64_t pages_hit = 0;
+  uint64_t pages_read = 0;
+
+  // 累加子节点的时间和页数，行数不累加
+  void add_cost(const OperatorStats &other) {
+    seconds += other.seconds;
+    pages_hit += other.pages_hit;
+    pages_read += other.pages_read;
+  }
+};
+
+/**
+ * 在构造和析构之间统计时间和当前线程访问的页数，累加到stats中。stats为nullptr时不做任何事
+ */
+class OperatorTimer {
+public:
+  explicit OperatorTimer(OperatorStats *stats);
+  ~OperatorTimer();
+
+private:
+  OperatorStats *stats_;
+  std::chrono::steady_clock::time_point start_;
+  uint64_t pages_hit_ = 0;
+  uint64_t pages_read_ = 0;
+};
+
+/**
+ * 执行计划中的一个算子，name为算子的类型，detail为表、索引、条件等说明
+ */
+struct ExplainNode {
+  std::string name;
+  std::string detail;
+  OperatorStats stats;
+  std::vector<ExplainNode> children;
+};
+
+/**
+ * 每个算子一行，子节点缩进后列在父节点下面。analyze为true时在每行后面输出统计
+ */
+void print_explain(const ExplainNode &root, bool analyze, std::ostream &os);
+
+const char *comp_op_to_string(CompOp comp_op);
+std::string value_to_string(AttrType type, const void *data);
+std::string filter_to_string(Filter &filter);
+// 多个条件之间是AND
+std::string filters_to_string(const std::vector<Filter *> &filters);
+// 与结果的表头相同，字段都带表名
+std::string schema_to_string(TupleSchema &schema);
+
+#endif  // __OBSERVER_SQL_EXECUTOR_EXPLAIN_H__
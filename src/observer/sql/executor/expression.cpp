@@ -0,0 +1,273 @@
+#include <algorithm>
+
+#include "sql/executor/expression.h"
+#include "common/log/log.h"
+
+// 计算栈不超过这个深度时直接用函数栈上的数组
+static const int LOCAL_STACK_DEPTH = 32;
+
+RC CompiledExpression::compile(const ast *a, const std::map<std::string, std::map<std::string, int>> &field_index) {
+  program_.clear();
+  RC rc = compile_node(a, field_index);
+  if (rc != RC::SUCCESS) {
+    program_.clear();
+    return rc;
+  }
+  finish();
+  return RC::SUCCESS;
+}
+
+void CompiledExpression::compile_attr(int index) {
+  program_.clear();
+  emit(LOAD_ATTR, index);
+  finish();
+}
+
+RC CompiledExpression::compile_value(const Value &value) {
+  program_.clear();
+  if (value.isnull) {
+    emit(PUSH_NULL);
+  } else if (value.type == INTS) {
+    emit(PUSH_CONST, -1, (float)*(int *)value.data);
+  } else if (value.type == FLOATS) {
+    emit(PUSH_CONST, -1, *(float *)value.data);
+  } else {
+    LOG_WARN("Unsupported value type in expression: %d", value.type);
+    return RC::INVALID_ARGUMENT;
+  }
+  finish();
+  return RC::SUCCESS;
+}
+
+void CompiledExpression::emit(OpCode op, int index, float value) {
+  program_.push_back(Instruction{op, index, value});
+}
+
+void CompiledExpression::finish() {
+  int depth = 0;
+  stack_depth_ = 0;
+  for (const Instruction &instruction : program_) {
+    if (instruction.op == PUSH_CONST || instruction.op == PUSH_NULL || instruction.op == LOAD_ATTR) {
+      depth++;
+    } else {
+      depth--;
+    }
+    stack_depth_ = std::max(stack_depth_, depth);
+  }
+}
+
+float CompiledExpression::apply(OpCode op, float left, float right) {
+  switch (op) {
+    case ADD:
+      return left + right;
+    case SUB:
+      return left - right;
+    case MUL:
+      return left * right;
+    default:
+      return left / right;
+  }
+}
+
+RC CompiledExpression::compile_node(const ast *a, const std::map<std::string, std::map<std::string, int>> &field_index) {
+  // 与AstUtil::Calculate相同，空的子树(一元负号的左侧)当作0
+  if (a == nullptr) {
+    emit(PUSH_CONST, -1, 0);
+    return RC::SUCCESS;
+  }
+
+  switch (a->nodetype) {
+    case ADDN:
+    case SUBN:
+    case MULN:
+    case DIVN: {
+      const size_t start = program_.size();
+      RC rc = compile_node(a->l, field_index);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      const size_t mid = program_.size();
+      rc = compile_node(a->r, field_index);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      const size_t end = program_.size();
+      OpCode op = a->nodetype == ADDN ? ADD : a->nodetype == SUBN ? SUB : a->nodetype == MULN ? MUL : DIV;
+
+      // 常量折叠：两侧都是单个常量时在编译时计算。除数是0的不折叠，留到求值时报错
+      const bool left_single = mid - start == 1;
+      const bool right_single = end - mid == 1;
+      if ((left_single && program_[start].op == PUSH_NULL) || (right_single && program_[mid].op == PUSH_NULL)) {
+        program_.resize(start);
+        emit(PUSH_NULL);
+      } else if (left_single && right_single && program_[start].op == PUSH_CONST && program_[mid].op == PUSH_CONST &&
+                 !(op == DIV && program_[mid].value == 0)) {
+        float value = apply(op, program_[start].value, program_[mid].value);
+        program_.resize(start);
+        emit(PUSH_CONST, -1, value);
+      } else {
+        emit(op);
+      }
+    } break;
+    case VALN: {
+      const Value &value = ((const valnode *)a)->value;
+      if (value.isnull) {
+        emit(PUSH_NULL);
+      } else if (value.type == INTS) {
+        emit(PUSH_CONST, -1, (float)*(int *)value.data);
+      } else if (value.type == FLOATS) {
+        emit(PUSH_CONST, -1, *(float *)value.data);
+      } else {
+        LOG_WARN("Unsupported value type in expression: %d", value.type);
+        return RC::INVALID_ARGUMENT;
+      }
+    } break;
+    case ATTRN: {
+      const RelAttr &attr = ((const attrnode *)a)->attr;
+      std::map<std::string, std::map<std::string, int>>::const_iterator table_iter;
+      if (field_index.size() == 1) {
+        table_iter = field_index.begin();
+      } else if (attr.relation_name != nullptr) {
+        table_iter = field_index.find(attr.relation_name);
+      } else {
+        LOG_WARN("Field %s in expression must be qualified by table name", attr.attribute_name);
+        return RC::SCHEMA_FIELD_MISSING;
+      }
+      if (table_iter == field_index.end()) {
+        LOG_WARN("No such table %s in expression", attr.relation_name);
+        return RC::SCHEMA_TABLE_NOT_EXIST;
+      }
+      auto field_iter = table_iter->second.find(attr.attribute_name);
+      if (field_iter == table_iter->second.end()) {
+        LOG_WARN("No such field %s.%s in expression", table_iter->first.c_str(), attr.attribute_name);
+        return RC::SCHEMA_FIELD_MISSING;
+      }
+      emit(LOAD_ATTR, field_iter->second);
+    } break;
+    default: {
+      LOG_WARN("Unknown expression node type: %d", a->nodetype);
+      return RC::INVALID_ARGUMENT;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+// 只有数值字段可以参与计算
+static inline bool load_value(const Tuple &tuple, int index, float &value) {
+  TupleValue &tuple_value = *tuple.get_pointer(index);
+  switch (tuple_value.Type()) {
+    case INTS:
+      value = (float)*(int *)tuple_value.value_pointer();
+      return true;
+    case FLOATS:
+      value = *(float *)tuple_value.value_pointer();
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool CompiledExpression::evaluate(const Tuple &tuple, float &result) const {
+  float local_stack[LOCAL_STACK_DEPTH];
+  std::vector<float> heap_stack;
+  float *stack = local_stack;
+  if (stack_depth_ > LOCAL_STACK_DEPTH) {
+    heap_stack.resize(stack_depth_);
+    stack = heap_stack.data();
+  }
+
+  int top = 0;
+  for (const Instruction &instruction : program_) {
+    switch (instruction.op) {
+      case PUSH_CONST:
+        stack[top++] = instruction.value;
+        break;
+      case PUSH_NULL:
+        return false;
+      case LOAD_ATTR:
+        if (!load_value(tuple, instruction.index, stack[top++])) {
+          return false;
+        }
+        break;
+      case DIV:
+        if (stack[top - 1] == 0) {
+          return false;
+        }
+        // fallthrough
+      default:
+        top--;
+        stack[top - 1] = apply(instruction.op, stack[top - 1], stack[top]);
+        break;
+    }
+  }
+  if (top != 1) {
+    return false;
+  }
+  result = stack[0];
+  return true;
+}
+
+void CompiledExpression::evaluate(const std::vector<const Tuple *> &tuples, std::vector<float> &results,
+                                  std::vector<char> &valid) const {
+  const size_t n = tuples.size();
+  valid.assign(n, program_.empty() ? 0 : 1);
+  // 每一层栈是一列，指令依次作用在整列上
+  std::vector<std::vector<float>> stack(stack_depth_);
+  int top = 0;
+  for (const Instruction &instruction : program_) {
+    switch (instruction.op) {
+      case PUSH_CONST: {
+        stack[top++].assign(n, instruction.value);
+      } break;
+      case PUSH_NULL: {
+        stack[top++].assign(n, 0);
+        valid.assign(n, 0);
+      } break;
+      case LOAD_ATTR: {
+        std::vector<float> &column = stack[top++];
+        column.resize(n);
+        for (size_t i = 0; i < n; i++) {
+          if (valid[i] && !load_value(*tuples[i], instruction.index, column[i])) {
+            valid[i] = 0;
+          }
+        }
+      } break;
+      default: {
+        top--;
+        float *left = stack[top - 1].data();
+        const float *right = stack[top].data();
+        switch (instruction.op) {
+          case ADD:
+            for (size_t i = 0; i < n; i++) {
+              left[i] += right[i];
+            }
+            break;
+          case SUB:
+            for (size_t i = 0; i < n; i++) {
+              left[i] -= right[i];
+            }
+            break;
+          case MUL:
+            for (size_t i = 0; i < n; i++) {
+              left[i] *= right[i];
+            }
+            break;
+          default:
+            for (size_t i = 0; i < n; i++) {
+              if (right[i] == 0) {
+                valid[i] = 0;
+              } else {
+                left[i] /= right[i];
+              }
+            }
+            break;
+        }
+      } break;
+    }
+  }
+  if (top == 1) {
+    results.swap(stack[0]);
+  } else {
+    results.assign(n, 0);
+  }
+}
@@ -0,0 +1,74 @@
+#ifndef __OBSERVER_SQL_EXECUTOR_EXPRESSION_H_
+#define __OBSERVER_SQL_EXECUTOR_EXPRESSION_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "rc.h"
+#include "sql/parser/parse_defs.h"
+#include "sql/executor/tuple.h"
+
+/**
+ * 编译后的算术表达式。
+ * 每个查询只编译一次：ast转换成后缀形式的指令序列，属性在编译时解析成tuple中的下标，
+ * 只包含常量的子表达式在编译时折叠成一个常量。
+ * 与AstUtil::Calculate一样按float计算，除0是错误；另外操作数中有null时结果是null
+ */
+class CompiledExpression {
+public:
+  CompiledExpression() = default;
+  ~CompiledExpression() = default;
+
+  /**
+   * @param field_index {table_name: {field_name: 在tuple中的下标}}，只有一张表时属性可以不写表名
+   */
+  RC compile(const ast *a, const std::map<std::string, std::map<std::string, int>> &field_index);
+  // 整个表达式就是tuple中的第index个字段
+  void compile_attr(int index);
+  // 整个表达式就是一个常量
+  RC compile_value(const Value &value);
+
+  /**
+   * 对一个tuple求值
+   * @return 结果为null或者计算出错(除0，非数值字段)时返回false
+   */
+  bool evaluate(const Tuple &tuple, float &result) const;
+
+  /**
+   * 对一批tuple求值，逐条指令处理整批数据。
+   * valid[i]为0表示tuples[i]的结果为null或者计算出错
+   */
+  void evaluate(const std::vector<const Tuple *> &tuples, std::vector<float> &results,
+                std::vector<char> &valid) const;
+
+  // 表达式只是一个字段时返回它在tuple中的下标，否则返回-1
+  int attr_index() const {
+    return program_.size() == 1 && program_[0].op == LOAD_ATTR ? program_[0].index : -1;
+  }
+
+  // 指令的条数，只包含常量的表达式折叠之后只有一条指令
+  size_t instruction_count() const {
+    return program_.size();
+  }
+
+private:
+  enum OpCode { PUSH_CONST, PUSH_NULL, LOAD_ATTR, ADD, SUB, MUL, DIV };
+  struct Instruction {
+    OpCode op;
+    int index;    // LOAD_ATTR: 字段在tuple中的下标
+    float value;  // PUSH_CONST: 常量的值
+  };
+
+  RC compile_node(const ast *a, const std::map<std::string, std::map<std::string, int>> &field_index);
+  void emit(OpCode op, int index = -1, float value = 0);
+  static float apply(OpCode op, float left, float right);
+  // 计算栈的最大深度
+  void finish();
+
+private:
+  std::vector<Instruction> program_;
+  int stack_depth_ = 0;
+};
+
+#endif  // __OBSERVER_SQL_EXECUTOR_EXPRESSION_H_
@@ -0,0 +1,260 @@
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+
+#include "sql/executor/external_sort.h"
+#include "sql/executor/util.h"
+#include "common/log/log.h"
+
+// 一个TupleValue对象及其shared_ptr大约占用的内存，用于估计缓存的大小
+static const size_t VALUE_MEMORY = 64;
+
+static void append_uint32(std::string &s, uint32_t value) {
+  // 大端序，按字节比较时与数值的大小关系一致
+  char bytes[4] = {(char)(value >> 24), (char)(value >> 16), (char)(value >> 8), (char)value};
+  s.append(bytes, 4);
+}
+
+static uint32_t read_uint32(const char *data) {
+  const unsigned char *bytes = (const unsigned char *)data;
+  return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+}
+
+ExternalSorter::ExternalSorter(const std::vector<int> &key_index, const std::vector<int> &orders, size_t memory_limit)
+    : key_index_(key_index), orders_(orders), memory_limit_(memory_limit) {}
+
+ExternalSorter::~ExternalSorter() {
+  for (Run &run : runs_) {
+    if (run.file != nullptr) {
+      fclose(run.file);  // tmpfile关闭后自动删除
+    }
+  }
+}
+
+void ExternalSorter::encode_key(const Tuple &tuple, std::string &key) const {
+  key.clear();
+  for (size_t i = 0; i < key_index_.size(); i++) {
+    size_t begin = key.size();
+    const std::shared_ptr<TupleValue> &value = tuple.get_pointer(key_index_[i]);
+    if (value->Type() == UNDEFINED) {
+      key.push_back(0);
+    } else {
+      key.push_back(1);
+      switch (value->Type()) {
+        case INTS: {
+          // 翻转符号位后，负数排在正数前面
+          append_uint32(key, (uint32_t)*(int *)value->value_pointer() ^ 0x80000000u);
+        } break;
+        case FLOATS: {
+          append_uint32(key, TupleSortUtil::float_order_bits(*(float *)value->value_pointer()));
+        } break;
+        default: {
+          // 与StringValue::compare一样按strcmp比较，以'\0'结尾
+          const std::string &s = *(std::string *)value->value_pointer();
+          key.append(s.c_str(), strlen(s.c_str()));
+          key.push_back(0);
+        } break;
+      }
+    }
+    if (orders_[i] == 1) {
+      for (size_t pos = begin; pos < key.size(); pos++) {
+        key[pos] = ~key[pos];
+      }
+    }
+  }
+}
+
+void ExternalSorter::encode_tuple(const Tuple &tuple, std::string &payload) {
+  payload.clear();
+  for (int i = 0; i < tuple.size(); i++) {
+    const std::shared_ptr<TupleValue> &value = tuple.get_pointer(i);
+    payload.push_back((char)value->Type());
+    switch (value->Type()) {
+      case UNDEFINED:
+        break;
+      case INTS:
+      case FLOATS:
+        payload.append((const char *)value->value_pointer(), 4);
+        break;
+      default: {
+        const std::string &s = *(std::string *)value->value_pointer();
+        append_uint32(payload, s.size());
+        payload.append(s);
+      } break;
+    }
+  }
+}
+
+void ExternalSorter::decode_tuple(const std::string &payload, Tuple &tuple) {
+  tuple = Tuple();
+  const char *data = payload.data();
+  const char *end = data + payload.size();
+  while (data < end) {
+    AttrType type = (AttrType)*data++;
+    switch (type) {
+      case UNDEFINED:
+        tuple.add_null();
+        break;
+      case INTS: {
+        int value;
+        memcpy(&value, data, 4);
+        tuple.add(value);
+        data += 4;
+      } break;
+      case FLOATS: {
+        float value;
+        memcpy(&value, data, 4);
+        tuple.add(value);
+        data += 4;
+      } break;
+      default: {
+        uint32_t length = read_uint32(data);
+        tuple.add(data + 4, length);
+        tuple.get_pointer(tuple.size() - 1)->SetType(type);
+        data += 4 + length;
+      } break;
+    }
+  }
+}
+
+RC ExternalSorter::add(Tuple &&tuple) {
+  Entry entry;
+  encode_key(tuple, entry.key);
+  size_t memory = sizeof(Entry) + entry.key.size() + tuple.size() * VALUE_MEMORY;
+  for (int i = 0; i < tuple.size(); i++) {
+    const std::shared_ptr<TupleValue> &value = tuple.get_pointer(i);
+    if (value->Type() != UNDEFINED && value->Type() != INTS && value->Type() != FLOATS) {
+      memory += ((std::string *)value->value_pointer())->size();
+    }
+  }
+  entry.tuple = std::move(tuple);
+  entries_.push_back(std::move(entry));
+  memory_usage_ += memory;
+  if (memory_usage_ > memory_limit_) {
+    return spill();
+  }
+  return RC::SUCCESS;
+}
+
+RC ExternalSorter::spill() {
+  std::stable_sort(entries_.begin(), entries_.end(),
+                   [](const Entry &lhs, const Entry &rhs) { return lhs.key < rhs.key; });
+  FILE *file = tmpfile();
+  if (file == nullptr) {
+    LOG_ERROR("Failed to create temporary file for sort run. errno=%d:%s", errno, strerror(errno));
+    return RC::CANTOPEN;
+  }
+  setvbuf(file, nullptr, _IOFBF, RUN_FILE_BUFFER_SIZE);
+  Run run;
+  run.file = file;
+  runs_.push_back(std::move(run));
+
+  for (const Entry &entry : entries_) {
+    buffer_.clear();
+    append_uint32(buffer_, entry.key.size());
+    buffer_.append(entry.key);
+    std::string payload;
+    encode_tuple(entry.tuple, payload);
+    append_uint32(buffer_, payload.size());
+    buffer_.append(payload);
+    if (fwrite(buffer_.data(), buffer_.size(), 1, file) != 1) {
+      LOG_ERROR("Failed to write sort run. errno=%d:%s", errno, strerror(errno));
+      return RC::IOERR_WRITE;
+    }
+  }
+  LOG_DEBUG("Spilled sort run %d with %d tuples", (int)runs_.size() - 1, (int)entries_.size());
+  std::vector<Entry>().swap(entries_);
+  memory_usage_ = 0;
+  return RC::SUCCESS;
+}
+
+RC ExternalSorter::read_entry(Run &run) {
+  char length[4];
+  size_t n = fread(length, 1, 4, run.file);
+  if (n == 0 && feof(run.file)) {
+    return RC::RECORD_EOF;
+  }
+  if (n != 4) {
+    return RC::IOERR_SHORT_READ;
+  }
+  run.key.resize(read_uint32(length));
+  if (!run.key.empty() && fread(&run.key[0], run.key.size(), 1, run.file) != 1) {
+    return RC::IOERR_SHORT_READ;
+  }
+  if (fread(length, 4, 1, run.file) != 1) {
+    return RC::IOERR_SHORT_READ;
+  }
+  run.payload.resize(read_uint32(length));
+  if (!run.payload.empty() && fread(&run.payload[0], run.payload.size(), 1, run.file) != 1) {
+    return RC::IOERR_SHORT_READ;
+  }
+  return RC::SUCCESS;
+}
+
+bool ExternalSorter::run_greater(int lhs, int rhs) const {
+  int ret = runs_[lhs].key.compare(runs_[rhs].key);
+  return ret > 0 || (ret == 0 && lhs > rhs);
+}
+
+RC ExternalSorter::finish() {
+  output_pos_ = 0;
+  if (runs_.empty()) {
+    std::stable_sort(entries_.begin(), entries_.end(),
+                     [](const Entry &lhs, const Entry &rhs) { return lhs.key < rhs.key; });
+    return RC::SUCCESS;
+  }
+
+  RC rc;
+  if (!entries_.empty()) {
+    rc = spill();
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+  auto greater = [this](int lhs, int rhs) { return run_greater(lhs, rhs); };
+  heap_.clear();
+  for (int i = 0; i < (int)runs_.size(); i++) {
+    rewind(runs_[i].file);
+    rc = read_entry(runs_[i]);
+    if (rc == RC::SUCCESS) {
+      heap_.push_back(i);
+      std::push_heap(heap_.begin(), heap_.end(), greater);
+    } else if (rc != RC::RECORD_EOF) {
+      LOG_ERROR("Failed to read sort run %d. rc=%d:%s", i, rc, strrc(rc));
+      return rc;
+    }
+  }
+  LOG_INFO("Merging %d sort runs", (int)runs_.size());
+  return RC::SUCCESS;
+}
+
+RC ExternalSorter::next(Tuple &tuple) {
+  if (runs_.empty()) {
+    if (output_pos_ >= entries_.size()) {
+      return RC::RECORD_EOF;
+    }
+    tuple = std::move(entries_[output_pos_++].tuple);
+    return RC::SUCCESS;
+  }
+
+  if (heap_.empty()) {
+    return RC::RECORD_EOF;
+  }
+  auto greater = [this](int lhs, int rhs) { return run_greater(lhs, rhs); };
+  std::pop_heap(heap_.begin(), heap_.end(), greater);
+  int index = heap_.back();
+  heap_.pop_back();
+  Run &run = runs_[index];
+  decode_tuple(run.payload, tuple);
+
+  RC rc = read_entry(run);
+  if (rc == RC::SUCCESS) {
+    heap_.push_back(index);
+    std::push_heap(heap_.begin(), heap_.end(), greater);
+  } else if (rc != RC::RECORD_EOF) {
+    LOG_ERROR("Failed to read sort run %d. rc=%d:%s", index, rc, strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
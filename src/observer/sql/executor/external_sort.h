@@ -0,0 +1,82 @@
+#ifndef __OBSERVER_SQL_EXECUTOR_EXTERNAL_SORT_H_
+#define __OBSERVER_SQL_EXECUTOR_EXTERNAL_SORT_H_
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "rc.h"
+#include "sql/executor/tuple.h"
+
+/**
+ * order by使用的外部排序。
+ * 每个tuple的排序字段编码成一个可以直接按字节比较(memcmp)的key：null排在最前，DESC的字段按位取反，
+ * 顺序与TupleSortUtil::compare_value相同。
+ * 缓存的tuple超过memory_limit后，排序并写到临时文件中成为一个有序的run，
+ * finish之后对所有run做k路归并；没有写过临时文件时直接在内存中排序。
+ * key相同的tuple按加入的顺序输出
+ */
+class ExternalSorter {
+public:
+  /**
+   * @param key_index 排序字段在tuple中的下标
+   * @param orders 每个排序字段的顺序，0:ASC 1:DESC
+   * @param memory_limit 内存中缓存的tuple的大小上限(字节)
+   */
+  ExternalSorter(const std::vector<int> &key_index, const std::vector<int> &orders, size_t memory_limit);
+  ~ExternalSorter();
+
+  RC add(Tuple &&tuple);
+
+  /**
+   * 所有tuple加入之后调用，之后用next按顺序取出
+   */
+  RC finish();
+
+  /**
+   * @return 全部取出后返回RECORD_EOF
+   */
+  RC next(Tuple &tuple);
+
+  // 写到临时文件的run的个数，0表示完全在内存中排序
+  int run_count() const { return runs_.size(); }
+
+public:
+  static const int RUN_FILE_BUFFER_SIZE = 64 * 1024;
+
+private:
+  struct Entry {
+    std::string key;
+    Tuple tuple;
+  };
+  struct Run {
+    FILE *file = nullptr;
+    std::string key;      // 当前记录的key
+    std::string payload;  // 当前记录序列化之后的tuple
+  };
+
+  void encode_key(const Tuple &tuple, std::string &key) const;
+  static void encode_tuple(const Tuple &tuple, std::string &payload);
+  static void decode_tuple(const std::string &payload, Tuple &tuple);
+
+  RC spill();
+  // 读出run中的下一条记录，读到结尾时返回RECORD_EOF
+  RC read_entry(Run &run);
+  // 归并用的小顶堆，key相同时编号小(先写出)的run在前
+  bool run_greater(int lhs, int rhs) const;
+
+private:
+  std::vector<int> key_index_;
+  std::vector<int> orders_;
+  size_t memory_limit_;
+
+  std::vector<Entry> entries_;
+  size_t memory_usage_ = 0;
+  size_t output_pos_ = 0;
+
+  std::vector<Run> runs_;
+  std::vector<int> heap_;  // 还有记录的run的编号
+  std::string buffer_;
+};
+
+#endif //__OBSERVER_SQL_EXECUTOR_EXTERNAL_SORT_H_
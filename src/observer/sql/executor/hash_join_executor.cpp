@@ -0,0 +1,435 @@
+#include "hash_join_executor.h"
+
+// 属性在schema中的下标，不存在时返回-1
+static int field_index_of(const FilterDesc &desc, TupleSchema &schema) {
+  const std::map<std::string, std::map<std::string, int>> &field_index = schema.table_field_index();
+  auto find_table = field_index.find(desc.table_name);
+  if (find_table == field_index.end()) {
+    return -1;
+  }
+  auto find_field = find_table->second.find(desc.field_name);
+  if (find_field == find_table->second.end()) {
+    return -1;
+  }
+  return find_field->second;
+}
+
+// FLOATS的比较带有误差，相等的两个值hash不一定相同，不能作为hash key
+static bool hashable_type(AttrType type) {
+  return type == INTS || type == CHARS || type == DATES || type == TEXTS;
+}
+
+// 等值条件两边分别属于左右两侧时，返回true并给出左右两侧的下标
+static bool equi_key_of(Filter *filter, TupleSchema &left_schema, TupleSchema &right_schema,
+                        int *left_index, int *right_index) {
+  if (filter->comp_op() != EQUAL_TO || !filter->left().is_attr || !filter->right().is_attr) {
+    return false;
+  }
+  int l = field_index_of(filter->left(), left_schema);
+  int r = field_index_of(filter->right(), right_schema);
+  if (l < 0 || r < 0) {
+    l = field_index_of(filter->right(), left_schema);
+    r = field_index_of(filter->left(), right_schema);
+  }
+  if (l < 0 || r < 0) {
+    return false;
+  }
+  AttrType left_type = left_schema.field(l).type();
+  if (left_type != right_schema.field(r).type() || !hashable_type(left_type)) {
+    return false;
+  }
+  *left_index = l;
+  *right_index = r;
+  return true;
+}
+
+HashJoinExecutor::HashJoinExecutor(ExecutorContext* context, const TupleSchema &output_schema,
+                                   Executor *left_executor,
+                                   Executor *right_executor,
+                                   std::vector<Filter*> condition_filters,
+                                   bool ban_all):
+                                   Executor(context, output_schema),
+                                   left_executor_(left_executor), right_executor_(right_executor),
+                                   condition_filters_(), ban_all_(ban_all) {
+  // 与NestLoopJoinExecutor相同，只保留涉及的表都在当前节点中的条件
+  for (Filter * filter : condition_filters) {
+    if (filter->left().is_attr && ((TupleSchema &)output_schema).table_field_index().count(filter->left().table_name) == 0) {
+      continue;
+    }
+    if (filter->right().is_attr && ((TupleSchema &)output_schema).table_field_index().count(filter->right().table_name) == 0) {
+      continue;
+    }
+    condition_filters_.push_back(filter);
+  }
+}
+
+RC HashJoinExecutor::do_init() {
+  RC rc;
+  rc = left_executor_->init();
+  if(rc != RC::SUCCESS) {
+    return rc;
+  }
+  rc = right_executor_->init();
+  if(rc != RC::SUCCESS) {
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+bool HashJoinExecutor::has_equi_condition(const std::vector<Filter*> &condition_filters,
+                                          TupleSchema &left_schema, TupleSchema &right_schema) {
+  int left_index, right_index;
+  for (Filter *filter : condition_filters) {
+    if (equi_key_of(filter, left_schema, right_schema, &left_index, &right_index)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void HashJoinExecutor::split_filters() {
+  keys_.clear();
+  for (Filter *filter : condition_filters_) {
+    JoinKey key;
+    if (equi_key_of(filter, left_schema_, right_schema_, &key.left_index, &key.right_index)) {
+      key.type = left_schema_.field(key.left_index).type();
+      keys_.push_back(key);
+    } else {
+      residual_filters_.push_back(filter);
+    }
+  }
+}
+
+bool HashJoinExecutor::int_key_of(const ColumnBatch &batch, int row, bool is_left, int &key) const {
+  const JoinKey &join_key = keys_[0];
+  const ColumnVector &column = batch.column(is_left ? join_key.left_index : join_key.right_index);
+  if (column.is_null(row)) { // null与任何值都不相等
+    return false;
+  }
+  key = column.get_int(row);
+  return true;
+}
+
+bool HashJoinExecutor::string_key_of(const ColumnBatch &batch, int row, bool is_left, std::string &key) const {
+  key.clear();
+  for (const JoinKey &join_key : keys_) {
+    const ColumnVector &column = batch.column(is_left ? join_key.left_index : join_key.right_index);
+    if (column.is_null(row)) {
+      return false;
+    }
+    if (join_key.type == INTS) {
+      int value = column.get_int(row);
+      key.append((const char *)&value, sizeof(int));
+    } else {
+      // 字符串类型按strcmp比较，'\0'之后的内容不参与比较
+      key.append(column.get_string(row));
+      key.push_back('\0');
+    }
+  }
+  return true;
+}
+
+RC HashJoinExecutor::build(std::vector<Filter*> *filters) {
+  built_ = true;
+  // 两侧交替各取一批，直到有一侧读完，读完的一侧不会比另一侧大太多
+  std::vector<ColumnBatch> left_batches;
+  std::vector<ColumnBatch> right_batches;
+  int left_rows = 0;
+  int right_rows = 0;
+  bool left_eof = false;
+  bool right_eof = false;
+  RC rc;
+  while (!left_eof && !right_eof) {
+    ColumnBatch left_batch;
+    rc = left_executor_->next_batch(left_batch);
+    if (rc == RC::SUCCESS) {
+      left_rows += left_batch.size();
+      left_batches.emplace_back(std::move(left_batch));
+    } else if (rc == RC::RECORD_EOF) {
+      left_eof = true;
+    } else {
+      return rc;
+    }
+    if (left_eof && left_rows == 0) {
+      break;
+    }
+
+    ColumnBatch right_batch;
+    rc = right_executor_->next_batch(right_batch);
+    if (rc == RC::SUCCESS) {
+      right_rows += right_batch.size();
+      right_batches.emplace_back(std::move(right_batch));
+    } else if (rc == RC::RECORD_EOF) {
+      right_eof = true;
+    } else {
+      return rc;
+    }
+  }
+  if ((left_eof && left_rows == 0) || (right_eof && right_rows == 0)) {
+    eof_ = true;
+    return RC::SUCCESS;
+  }
+
+  build_left_ = left_eof && (!right_eof || left_rows <= right_rows);
+  probe_eof_ = build_left_ ? right_eof : left_eof;
+  left_schema_ = left_batches.front().get_schema();
+  right_schema_ = right_batches.front().get_schema();
+  left_tuple_index_ = output_schema_.index_in(left_schema_);
+  right_tuple_index_ = output_schema_.index_in(right_schema_);
+  residual_filters_.clear();
+  split_filters();
+  if (filters != nullptr) {
+    residual_filters_.insert(residual_filters_.end(), filters->begin(), filters->end());
+  }
+
+  std::vector<ColumnBatch> &build_batches = build_left_ ? left_batches : right_batches;
+  std::vector<ColumnBatch> &probe_batches = build_left_ ? right_batches : left_batches;
+  // build侧的批次合并成一个，只保留选中的行
+  build_set_.init(build_batches.front().schema());
+  for (int i = 0; i < build_set_.column_num(); i++) {
+    build_set_.column(i).reserve(build_left_ ? left_rows : right_rows);
+  }
+  for (const ColumnBatch &batch : build_batches) {
+    for (int i = 0; i < batch.size(); i++) {
+      build_set_.append_row(batch, batch.selected(i));
+    }
+  }
+  for (ColumnBatch &batch : probe_batches) {
+    probe_buffer_.emplace_back(std::move(batch));
+  }
+
+  int build_rows = build_set_.row_count();
+  if (keys_.empty()) {
+    // 运行时的schema中找不到可用的等值条件，退化为逐对比较
+    for (int i = 0; i < build_rows; i++) {
+      all_build_rows_.push_back(i);
+    }
+  } else if (keys_.size() == 1 && keys_[0].type == INTS) {
+    int key;
+    int_table_.reserve(build_rows);
+    for (int i = 0; i < build_rows; i++) {
+      if (int_key_of(build_set_, i, build_left_, key)) {
+        int_table_[key].push_back(i);
+      }
+    }
+  } else {
+    std::string key;
+    string_table_.reserve(build_rows);
+    for (int i = 0; i < build_rows; i++) {
+      if (string_key_of(build_set_, i, build_left_, key)) {
+        string_table_[key].push_back(i);
+      }
+    }
+  }
+  if (build_left_) {
+    return match_left_rows();
+  }
+  return RC::SUCCESS;
+}
+
+bool HashJoinExecutor::residual_match(const Tuple &left_tuple, const Tuple &right_tuple) {
+  for (auto &residual_filter : residual_filters_) {
+    if (!residual_filter->filter(left_tuple, left_schema_, right_tuple, right_schema_)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// build侧是左表时，直接按探测行输出会变成右表的顺序。
+// 先把右表探测完，按左表行记下匹配上的右表行，只有匹配上的右表行才保存下来，
+// 输出时再按左表的顺序遍历，与NestLoopJoinExecutor的输出顺序一致
+RC HashJoinExecutor::match_left_rows() {
+  probe_set_.init(probe_buffer_.front().schema());
+  left_matches_.assign(build_set_.row_count(), std::vector<int>());
+  ColumnBatch batch;
+  RC rc;
+  while ((rc = next_probe_batch(batch)) == RC::SUCCESS) {
+    for (int i = 0; i < batch.size(); i++) {
+      int row = batch.selected(i);
+      const std::vector<int> *bucket = find_bucket(batch, row);
+      if (bucket == nullptr || bucket->empty()) {
+        continue;
+      }
+      Tuple right_tuple;
+      if (!residual_filters_.empty()) {
+        batch.to_tuple(row, right_tuple);
+      }
+      int right_row = -1;
+      for (int left_row : *bucket) {
+        if (!residual_filters_.empty()) {
+          Tuple left_tuple;
+          build_set_.to_tuple(left_row, left_tuple);
+          if (!residual_match(left_tuple, right_tuple)) {
+            continue;
+          }
+        }
+        if (right_row < 0) {
+          right_row = probe_set_.row_count();
+          probe_set_.append_row(batch, row);
+        }
+        left_matches_[left_row].push_back(right_row);
+      }
+    }
+  }
+  return rc == RC::RECORD_EOF ? RC::SUCCESS : rc;
+}
+
+const std::vector<int> *HashJoinExecutor::find_bucket(const ColumnBatch &probe_batch, int probe_row) {
+  if (keys_.empty()) {
+    return &all_build_rows_;
+  }
+  if (keys_.size() == 1 && keys_[0].type == INTS) {
+    int key;
+    if (!int_key_of(probe_batch, probe_row, !build_left_, key)) {
+      return nullptr;
+    }
+    auto iter = int_table_.find(key);
+    return iter == int_table_.end() ? nullptr : &iter->second;
+  }
+  std::string key;
+  if (!string_key_of(probe_batch, probe_row, !build_left_, key)) {
+    return nullptr;
+  }
+  auto iter = string_table_.find(key);
+  return iter == string_table_.end() ? nullptr : &iter->second;
+}
+
+RC HashJoinExecutor::next_probe_batch(ColumnBatch &probe_batch) {
+  if (!probe_buffer_.empty()) {
+    probe_batch = std::move(probe_buffer_.front());
+    probe_buffer_.pop_front();
+    return RC::SUCCESS;
+  }
+  if (probe_eof_) {
+    return RC::RECORD_EOF;
+  }
+  Executor *probe_executor = build_left_ ? right_executor_ : left_executor_;
+  RC rc = probe_executor->next_batch(probe_batch);
+  if (rc == RC::RECORD_EOF) {
+    probe_eof_ = true;
+  }
+  return rc;
+}
+
+void HashJoinExecutor::add_result(const ColumnBatch &left_batch, int left_row,
+                                  const ColumnBatch &right_batch, int right_row, TupleSet &tuple_set) {
+  Tuple result_tuple;
+  left_batch.add_to_tuple(left_row, left_tuple_index_, result_tuple);
+  right_batch.add_to_tuple(right_row, right_tuple_index_, result_tuple);
+  tuple_set.add(std::move(result_tuple));
+}
+
+RC HashJoinExecutor::do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
+  tuple_set.clear();
+  tuple_set.set_schema(output_schema_);
+  if (ban_all_) {
+    return RC::RECORD_EOF;
+  }
+  RC rc;
+  if (!built_) {
+    rc = build(filters);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+  if (eof_) {
+    return RC::RECORD_EOF;
+  }
+
+  if (build_left_) {
+    while (tuple_set.size() < BATCH_SIZE && emit_left_ < (int)left_matches_.size()) {
+      const std::vector<int> &matches = left_matches_[emit_left_];
+      if (emit_pos_ >= matches.size()) {
+        emit_left_++;
+        emit_pos_ = 0;
+        continue;
+      }
+      add_result(build_set_, emit_left_, probe_set_, matches[emit_pos_++], tuple_set);
+    }
+    return tuple_set.size() > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+  }
+
+  // build侧是右表，按左表(探测侧)的顺序流式输出
+  while (tuple_set.size() < BATCH_SIZE) {
+    if (bucket_ == nullptr || bucket_pos_ >= bucket_->size()) {
+      // 当前探测行的匹配已经输出完，换下一行
+      probe_pos_++;
+      if (probe_pos_ >= probe_batch_.size()) {
+        rc = next_probe_batch(probe_batch_);
+        if (rc != RC::SUCCESS) {
+          if (rc != RC::RECORD_EOF) {
+            return rc;
+          }
+          eof_ = true;
+          break;
+        }
+        probe_pos_ = 0;
+      }
+      probe_row_ = probe_batch_.selected(probe_pos_);
+      bucket_ = find_bucket(probe_batch_, probe_row_);
+      bucket_pos_ = 0;
+      if (bucket_ != nullptr && !bucket_->empty() && !residual_filters_.empty()) {
+        probe_tuple_ = Tuple();
+        probe_batch_.to_tuple(probe_row_, probe_tuple_);
+      }
+      continue;
+    }
+
+    int build_row = (*bucket_)[bucket_pos_++];
+    if (!residual_filters_.empty()) {
+      // 只有hash匹配上的行才需要转换为Tuple来计算剩余的条件
+      Tuple build_tuple;
+      build_set_.to_tuple(build_row, build_tuple);
+      if (!residual_match(probe_tuple_, build_tuple)) {
+        continue;
+      }
+    }
+    add_result(probe_batch_, probe_row_, build_set_, build_row, tuple_set);
+  }
+  return tuple_set.size() > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+}
+
+RC HashJoinExecutor::rewind() {
+  built_ = false;
+  eof_ = false;
+  keys_.clear();
+  residual_filters_.clear();
+  build_set_.clear();
+  int_table_.clear();
+  string_table_.clear();
+  all_build_rows_.clear();
+  probe_buffer_.clear();
+  probe_eof_ = false;
+  probe_batch_.clear();
+  probe_set_.clear();
+  left_matches_.clear();
+  emit_left_ = 0;
+  emit_pos_ = 0;
+  probe_pos_ = -1;
+  probe_row_ = -1;
+  bucket_ = nullptr;
+  bucket_pos_ = 0;
+  RC rc = left_executor_->rewind();
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  return right_executor_->rewind();
+}
+
+void HashJoinExecutor::describe(ExplainNode &node) {
+  node.name = "HashJoin";
+  if (ban_all_) {
+    node.detail = "on false";
+  } else if (!condition_filters_.empty()) {
+    node.detail = "on " + filters_to_string(condition_filters_);
+  }
+  // build侧在执行时才确定
+  if (built_) {
+    node.detail += build_left_ ? " build=left" : " build=right";
+  }
+}
+
+std::vector<Executor *> HashJoinExecutor::children() {
+  return {left_executor_, right_executor_};
+}
@@ -0,0 +1,102 @@
+#ifndef MINIDB_HASH_JOIN_EXECUTOR_H
+#define MINIDB_HASH_JOIN_EXECUTOR_H
+
+#include "storage/common/table.h"
+#include "sql/executor/executor.h"
+#include "tuple.h"
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 等值连接：在较小的一侧上建hash表，用另一侧探测，
+ * 非等值的条件(以及无法作为hash key的等值条件)只对hash匹配上的行求值。
+ * 两侧交替各取一批，先读完的一侧作为build侧，另一侧已经读出的批次缓存起来后探测。
+ * 输出按左表的顺序，与NestLoopJoinExecutor一致：右表作为build侧时左表流式探测；
+ * 左表作为build侧时先探测完右表，按左表行记下匹配的右表行再输出。
+ * 子节点的数据以列存批次读入，hash key直接从列中取，只有匹配上的行才转换为Tuple
+ */
+class HashJoinExecutor : public Executor {
+public:
+  HashJoinExecutor(ExecutorContext* context,
+                   const TupleSchema &output_schema,
+                   Executor *left_executor,
+                   Executor *right_executor,
+                   std::vector<Filter*> condition_filters,
+                   bool ban_all=false);
+
+  ~HashJoinExecutor() = default;
+
+  RC rewind() override;
+
+  /**
+   * 条件中是否存在 左表属性 = 右表属性 的等值条件，ExecutorBuilder据此选择hash join
+   */
+  static bool has_equi_condition(const std::vector<Filter*> &condition_filters,
+                                 TupleSchema &left_schema, TupleSchema &right_schema);
+
+protected:
+  RC do_init() override;
+  RC do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) override;
+  void describe(ExplainNode &node) override;
+  std::vector<Executor *> children() override;
+
+private:
+  struct JoinKey {
+    int left_index;   // 在左侧tuple中的下标
+    int right_index;  // 在右侧tuple中的下标
+    AttrType type;
+  };
+
+  RC build(std::vector<Filter*> *filters);
+  // 把可以作为hash key的等值条件挑出来，其余放入residual_filters_
+  void split_filters();
+  bool int_key_of(const ColumnBatch &batch, int row, bool is_left, int &key) const;
+  bool string_key_of(const ColumnBatch &batch, int row, bool is_left, std::string &key) const;
+  const std::vector<int> *find_bucket(const ColumnBatch &probe_batch, int probe_row);
+  RC next_probe_batch(ColumnBatch &probe_batch);
+  bool residual_match(const Tuple &left_tuple, const Tuple &right_tuple);
+  RC match_left_rows();
+  void add_result(const ColumnBatch &left_batch, int left_row,
+                  const ColumnBatch &right_batch, int right_row, TupleSet &tuple_set);
+
+private:
+  Executor *left_executor_;
+  Executor *right_executor_;
+  std::vector<Filter *> condition_filters_;
+  bool ban_all_ = false;
+
+  bool built_ = false;
+  bool eof_ = false;
+  bool build_left_ = false;
+  TupleSchema left_schema_;
+  TupleSchema right_schema_;
+  std::vector<JoinKey> keys_;
+  std::vector<Filter *> residual_filters_;
+
+  ColumnBatch build_set_;
+  std::unordered_map<int, std::vector<int>> int_table_;  // 只有一个INTS key时使用
+  std::unordered_map<std::string, std::vector<int>> string_table_;
+  std::vector<int> all_build_rows_;  // 没有可用的等值条件时，每个探测行与所有build行比较
+
+  std::deque<ColumnBatch> probe_buffer_;  // 选择build侧时已经读出的探测侧批次
+  bool probe_eof_ = false;
+  ColumnBatch probe_batch_;
+  int probe_row_ = -1;  // probe_batch_中当前探测行的行号
+  Tuple probe_tuple_;   // 有residual条件时当前探测行转换出的Tuple
+  std::vector<int> left_tuple_index_;
+  std::vector<int> right_tuple_index_;
+  int probe_pos_ = -1;
+  const std::vector<int> *bucket_ = nullptr;
+  size_t bucket_pos_ = 0;
+
+  // build侧是左表时使用
+  ColumnBatch probe_set_;                       // 匹配上的右表行
+  std::vector<std::vector<int>> left_matches_;  // 每个左表行匹配上的probe_set_中的行
+  int emit_left_ = 0;
+  size_t emit_pos_ = 0;
+};
+
+
+#endif //MINIDB_HASH_JOIN_EXECUTOR_H
@@ -0,0 +1,251 @@
+#include "index_nest_loop_join_executor.h"
+#include "common/log/log.h"
+
+// 可以在索引上做等值查找的类型。FLOATS的比较带有误差，索引上的精确查找可能漏掉匹配的记录
+static bool index_key_type(AttrType type) {
+  return type == INTS || type == CHARS || type == DATES;
+}
+
+IndexNestLoopJoinExecutor::IndexNestLoopJoinExecutor(ExecutorContext* context, const TupleSchema &output_schema,
+                                                     Executor *left_executor,
+                                                     ScanExecutor *right_executor,
+                                                     std::vector<Filter*> condition_filters,
+                                                     bool ban_all):
+                                                     Executor(context, output_schema),
+                                                     left_executor_(left_executor), right_executor_(right_executor),
+                                                     right_table_(right_executor->table()),
+                                                     condition_filters_(), ban_all_(ban_all) {
+  // 与NestLoopJoinExecutor相同，只保留涉及的表都在当前节点中的条件
+  for (Filter * filter : condition_filters) {
+    if (filter->left().is_attr && ((TupleSchema &)output_schema).table_field_index().count(filter->left().table_name) == 0) {
+      continue;
+    }
+    if (filter->right().is_attr && ((TupleSchema &)output_schema).table_field_index().count(filter->right().table_name) == 0) {
+      continue;
+    }
+    condition_filters_.push_back(filter);
+  }
+}
+
+bool IndexNestLoopJoinExecutor::find_index_key(const std::vector<Filter*> &condition_filters, TupleSchema &left_schema,
+                                               Table *right_table, int *left_index, const FieldMeta **right_field) {
+  const TableMeta &table_meta = right_table->table_meta();
+  for (Filter *filter : condition_filters) {
+    if (filter->comp_op() != EQUAL_TO || !filter->left().is_attr || !filter->right().is_attr) {
+      continue;
+    }
+    // 右表的属性可能在条件的任意一边
+    for (int i = 0; i < 2; i++) {
+      FilterDesc &left = i == 0 ? filter->left() : filter->right();
+      FilterDesc &right = i == 0 ? filter->right() : filter->left();
+      if (0 != strcmp(right.table_name.c_str(), right_table->name())) {
+        continue;
+      }
+      const FieldMeta *field_meta = table_meta.field(right.field_name.c_str());
+      int index = left_schema.index_of_field(left.table_name.c_str(), left.field_name.c_str());
+      if (field_meta == nullptr || index < 0 || table_meta.find_index_by_field(field_meta->name()) == nullptr) {
+        continue;
+      }
+      if (field_meta->type() != left_schema.field(index).type() || !index_key_type(field_meta->type())) {
+        continue;
+      }
+      *left_index = index;
+      *right_field = field_meta;
+      return true;
+    }
+  }
+  return false;
+}
+
+RC IndexNestLoopJoinExecutor::do_init() {
+  RC rc;
+  rc = left_executor_->init();
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  // 绑定右表自己的过滤条件，取出记录时求值
+  rc = right_executor_->init();
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  right_filters_.clear();
+  right_filters_.push_back(&key_filter_);
+  for (Filter *filter : right_executor_->condition_filters()) {
+    right_filters_.push_back(filter);
+  }
+  right_filter_.init(right_filters_.data(), right_filters_.size());
+  right_tuples_.set_schema(right_executor_->output_schema());
+  converter_.reset(new TupleRecordConverter(right_table_, right_tuples_));
+  return RC::SUCCESS;
+}
+
+RC IndexNestLoopJoinExecutor::open_right(const Tuple &left_tuple) {
+  const std::shared_ptr<TupleValue> &value = left_tuple.get_pointer(left_key_index_);
+  if (value->Type() == UNDEFINED) {  // null与任何值都不相等
+    return RC::RECORD_EOF;
+  }
+  // 多留一个'\0'，与记录中占满字段长度的字符串比较时strcmp不会越界
+  key_.assign(right_key_field_->len() + 1, 0);
+  if (right_key_field_->type() == INTS) {
+    memcpy(key_.data(), value->value_pointer(), sizeof(int));
+  } else {
+    const std::string &s = *(std::string *)value->value_pointer();
+    memcpy(key_.data(), s.c_str(), std::min(s.size(), (size_t)right_key_field_->len()));
+  }
+
+  ConDesc left;
+  left.is_attr = true;
+  left.is_null = false;
+  left.attr_index = right_table_->table_meta().field_index(right_key_field_->name());
+  left.attr_length = right_key_field_->len();
+  left.attr_offset = right_key_field_->offset();
+  left.value = nullptr;
+  ConDesc right;
+  right.is_attr = false;
+  right.is_null = false;
+  right.attr_index = 0;
+  right.attr_length = 0;
+  right.attr_offset = 0;
+  right.value = key_.data();
+  RC rc = key_filter_.init(right_table_, left, right, right_key_field_->type(), EQUAL_TO);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to init index join key filter. rc=%d:%s", rc, strrc(rc));
+    return rc;
+  }
+  rc = scanner_.open(right_table_, exe_ctx_->get_trx(), &right_filter_);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to open index scanner of table %s. rc=%d:%s", right_table_->name(), rc, strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC IndexNestLoopJoinExecutor::do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
+  tuple_set.clear();
+  tuple_set.set_schema(output_schema_);
+  if (ban_all_ || right_executor_->ban_all() || left_eof_) {
+    return RC::RECORD_EOF;
+  }
+
+  RC rc = RC::SUCCESS;
+  while (tuple_set.size() < BATCH_SIZE) {
+    if (need_left_) {
+      rc = left_executor_->next(left_batch_);
+      if (rc != RC::SUCCESS) {
+        if (rc == RC::RECORD_EOF) {
+          left_eof_ = true;
+          break;
+        }
+        return rc;
+      }
+      if (left_key_index_ < 0) {
+        if (!find_index_key(condition_filters_, left_batch_.get_schema(), right_table_, &left_key_index_,
+                            &right_key_field_)) {
+          LOG_ERROR("No index join key on table %s", right_table_->name());
+          return RC::INTERNAL;
+        }
+        left_tuple_index_ = output_schema_.index_in(left_batch_.get_schema());
+        right_tuple_index_ = output_schema_.index_in(right_tuples_.get_schema());
+      }
+      left_pos_ = 0;
+      need_left_ = false;
+    }
+    if (left_pos_ >= left_batch_.size()) {
+      need_left_ = true;
+      continue;
+    }
+
+    const Tuple &left_tuple = left_batch_.get(left_pos_);
+    if (!scanning_) {
+      rc = open_right(left_tuple);
+      if (rc == RC::RECORD_EOF) {
+        left_pos_++;
+        continue;
+      }
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      scanning_ = true;
+    }
+
+    Record record;
+    while (tuple_set.size() < BATCH_SIZE && (rc = scanner_.next(&record)) == RC::SUCCESS) {
+      right_tuples_.tuples().clear();
+      converter_->add_record(record.data, &record.rid);
+      const Tuple &right_tuple = right_tuples_.get(0);
+      bool valid = true;
+      if (filters != nullptr) {
+        for (auto &tmp_filter : *filters) {
+          if (!tmp_filter->filter(left_tuple, left_batch_.get_schema(), right_tuple, right_tuples_.get_schema())) {
+            valid = false;
+            break;
+          }
+        }
+      }
+      for (auto &self_filter : condition_filters_) {
+        if (!valid) {
+          break;
+        }
+        valid = self_filter->filter(left_tuple, left_batch_.get_schema(), right_tuple, right_tuples_.get_schema());
+      }
+      if (valid) {
+        Tuple result_tuple;
+        result_tuple.add(left_tuple, left_tuple_index_);
+        result_tuple.add(right_tuple, right_tuple_index_);
+        tuple_set.add(std::move(result_tuple));
+      }
+    }
+    if (tuple_set.size() >= BATCH_SIZE && rc == RC::SUCCESS) {
+      break;
+    }
+    scanner_.close();
+    scanning_ = false;
+    if (rc != RC::RECORD_EOF) {
+      return rc;
+    }
+    left_pos_++;
+  }
+  return tuple_set.size() > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+}
+
+RC IndexNestLoopJoinExecutor::rewind() {
+  scanner_.close();
+  scanning_ = false;
+  left_batch_.clear();
+  left_pos_ = 0;
+  need_left_ = true;
+  left_eof_ = false;
+  return left_executor_->rewind();
+}
+
+// 右表不通过right_executor_读取，作为说明列出，不作为子节点
+void IndexNestLoopJoinExecutor::describe(ExplainNode &node) {
+  node.name = "IndexNestedLoopJoin";
+  node.detail = right_table_->name();
+  // 连接的字段在第一次next时才确定，EXPLAIN时还没有执行过
+  const FieldMeta *right_key_field = right_key_field_;
+  if (right_key_field == nullptr) {
+    int left_key_index = -1;
+    TupleSchema left_schema = left_executor_->output_schema();
+    find_index_key(condition_filters_, left_schema, right_table_, &left_key_index, &right_key_field);
+  }
+  const IndexMeta *index_meta = right_key_field != nullptr
+      ? right_table_->table_meta().find_index_by_field(right_key_field->name()) : nullptr;
+  if (index_meta != nullptr) {
+    node.detail += std::string(" index=") + index_meta->name();
+  }
+  if (ban_all_ || right_executor_->ban_all()) {
+    node.detail += " on false";
+    return;
+  }
+  std::vector<Filter *> filters = condition_filters_;
+  filters.insert(filters.end(), right_executor_->condition_filters().begin(),
+                 right_executor_->condition_filters().end());
+  if (!filters.empty()) {
+    node.detail += " on " + filters_to_string(filters);
+  }
+}
+
+std::vector<Executor *> IndexNestLoopJoinExecutor::children() {
+  return {left_executor_};
+}
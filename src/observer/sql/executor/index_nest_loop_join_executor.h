@@ -0,0 +1,74 @@
+#ifndef MINIDB_INDEX_NEST_LOOP_JOIN_EXECUTOR_H
+#define MINIDB_INDEX_NEST_LOOP_JOIN_EXECUTOR_H
+
+#include "storage/common/table.h"
+#include "storage/common/condition_filter.h"
+#include "sql/executor/executor.h"
+#include "sql/executor/scan_executor.h"
+#include "tuple.h"
+#include <memory>
+#include <vector>
+
+/**
+ * index nested loop join：右侧是一张表，连接条件 左侧属性 = 右表属性 中的右表属性上有索引。
+ * 对左侧的每一行，用它的值在右表的索引上做等值查找，只取出匹配的记录，不扫描整个右表。
+ * 右表自己的过滤条件在取出记录时求值，其余的连接条件对每个匹配的组合求值
+ */
+class IndexNestLoopJoinExecutor : public Executor {
+public:
+  IndexNestLoopJoinExecutor(ExecutorContext* context,
+                            const TupleSchema &output_schema,
+                            Executor *left_executor,
+                            ScanExecutor *right_executor,
+                            std::vector<Filter*> condition_filters,
+                            bool ban_all=false);
+
+  ~IndexNestLoopJoinExecutor() = default;
+
+  RC rewind() override;
+
+  /**
+   * 条件中是否存在 左侧属性 = 右表属性 并且右表属性上有索引，
+   * 有的话给出左侧属性在left_schema中的下标和右表的字段
+   */
+  static bool find_index_key(const std::vector<Filter*> &condition_filters, TupleSchema &left_schema,
+                             Table *right_table, int *left_index, const FieldMeta **right_field);
+
+protected:
+  RC do_init() override;
+  RC do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) override;
+  void describe(ExplainNode &node) override;
+  std::vector<Executor *> children() override;
+
+private:
+  // 用左侧当前行的值打开右表上的索引扫描，左侧的值是null时不会有匹配的记录，返回RECORD_EOF
+  RC open_right(const Tuple &left_tuple);
+
+private:
+  Executor *left_executor_;
+  ScanExecutor *right_executor_;
+  Table *right_table_;
+  std::vector<Filter *> condition_filters_;
+  bool ban_all_ = false;
+
+  int left_key_index_ = -1;
+  const FieldMeta *right_key_field_ = nullptr;
+  std::vector<char> key_;  // 当前在索引上查找的值，按右表字段的长度存放，后面多一个'\0'
+  DefaultConditionFilter key_filter_;
+  std::vector<const ConditionFilter *> right_filters_;  // key_filter_在最前面，保证按它选择索引
+  CompositeConditionFilter right_filter_;
+  TableScanner scanner_;
+
+  TupleSet left_batch_;
+  TupleSet right_tuples_;  // 当前记录转换出的tuple
+  std::unique_ptr<TupleRecordConverter> converter_;
+  int left_pos_ = 0;
+  bool need_left_ = true;
+  bool scanning_ = false;  // 是否正在为left_pos_这一行扫描右表
+  bool left_eof_ = false;
+  std::vector<int> left_tuple_index_;
+  std::vector<int> right_tuple_index_;
+};
+
+
+#endif //MINIDB_INDEX_NEST_LOOP_JOIN_EXECUTOR_H
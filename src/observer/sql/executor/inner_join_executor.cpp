@@ -9,7 +9,7 @@ InnerJoinExecutor::InnerJoinExecutor(ExecutorContext* context,
                                      left_executor_(left_executor), right_executor_(right_executor),
                                      condition_filters_(std::move(condition_filters)) {}
 
-RC InnerJoinExecutor::init() {
+RC InnerJoinExecutor::do_init() {
   RC rc = left_executor_->init();
   if (rc != RC::SUCCESS) {
     return rc;
@@ -23,11 +23,29 @@ RC InnerJoinExecutor::init() {
 
 
 
-RC InnerJoinExecutor::next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
+RC InnerJoinExecutor::do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
   TupleSet left_tuple_set;
   left_executor_->next(left_tuple_set);
 //  for (const auto & tuple : left_tuple_set.tuples()) {
 //
 //  }
-  return RC::SUCCESS;
-}
\ No newline at end of file
+  return RC::RECORD_EOF;
+}
+
+RC InnerJoinExecutor::rewind() {
+  RC rc = left_executor_->rewind();
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  return right_executor_->rewind();
+}
+void InnerJoinExecutor::describe(ExplainNode &node) {
+  node.name = "InnerJoin";
+  if (!condition_filters_.empty()) {
+    node.detail = "on " + filters_to_string(condition_filters_);
+  }
+}
+
+std::vector<Executor *> InnerJoinExecutor::children() {
+  return {left_executor_, right_executor_};
+}
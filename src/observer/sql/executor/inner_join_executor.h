@@ -17,9 +17,13 @@ public:
 
   virtual ~InnerJoinExecutor() = default;
 
-  RC init() override;
+  RC rewind() override;
 
-  RC next(TupleSet &tuple_set, std::vector<Filter*> *filters = nullptr) override;
+protected:
+  RC do_init() override;
+  RC do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) override;
+  void describe(ExplainNode &node) override;
+  std::vector<Executor *> children() override;
 
 private:
   TupleSchema  output_schema_;
@@ -0,0 +1,165 @@
+#include <algorithm>
+
+#include "late_materialize_executor.h"
+#include "storage/common/record_manager.h"
+#include "common/log/log.h"
+
+LateMaterializeExecutor::LateMaterializeExecutor(ExecutorContext *context, Executor *executor,
+                                                 std::vector<LateTable> &&tables)
+    : Executor(context, materialized_schema(executor->output_schema(), tables)),
+      executor_(executor), tables_(std::move(tables)) {}
+
+TupleSchema LateMaterializeExecutor::materialized_schema(const TupleSchema &child_schema,
+                                                         const std::vector<LateTable> &tables) {
+  TupleSchema schema;
+  for (const TupleField &field : child_schema.fields()) {
+    if (!TupleRecordConverter::is_rid_field(field.field_name())) {
+      schema.add(field.type(), field.table_name(), field.field_name(), field.order());
+    }
+  }
+  for (const LateTable &table : tables) {
+    schema.append(table.fields);
+  }
+  return schema;
+}
+
+RC LateMaterializeExecutor::do_init() {
+  return executor_->init();
+}
+
+RC LateMaterializeExecutor::bind(const TupleSchema &child_schema) {
+  rid_page_index_.clear();
+  rid_slot_index_.clear();
+  for (const LateTable &table : tables_) {
+    rid_page_index_.push_back(child_schema.index_of_field(table.table->name(), TupleRecordConverter::RID_PAGE_FIELD));
+    rid_slot_index_.push_back(child_schema.index_of_field(table.table->name(), TupleRecordConverter::RID_SLOT_FIELD));
+    if (rid_page_index_.back() < 0 || rid_slot_index_.back() < 0) {
+      LOG_ERROR("No rid of table %s in child schema", table.table->name());
+      return RC::INTERNAL;
+    }
+  }
+
+  source_table_.clear();
+  source_index_.clear();
+  for (const TupleField &field : output_schema_.fields()) {
+    int table = -1;
+    int index = -1;
+    for (size_t i = 0; i < tables_.size() && index < 0; i++) {
+      index = tables_[i].fields.index_of_field(field.table_name(), field.field_name());
+      table = i;
+    }
+    if (index < 0) {
+      table = -1;
+      index = child_schema.index_of_field(field.table_name(), field.field_name());
+    }
+    if (index < 0) {
+      LOG_ERROR("No such field %s.%s to materialize", field.table_name(), field.field_name());
+      return RC::SCHEMA_FIELD_MISSING;
+    }
+    source_table_.push_back(table);
+    source_index_.push_back(index);
+  }
+  fetched_.clear();
+  fetched_.resize(tables_.size());
+  fetched_index_.assign(tables_.size(), std::vector<int>());
+  bound_ = true;
+  return RC::SUCCESS;
+}
+
+static void fetch_record_reader(int index, const char *data, void *context) {
+  TupleRecordConverter *converter = (TupleRecordConverter *)context;
+  converter->add_record(data);
+}
+
+RC LateMaterializeExecutor::fetch(size_t table, const TupleSet &child_tuple_set) {
+  const int row_num = child_tuple_set.size();
+  std::vector<std::pair<RID, int>> rids(row_num);
+  for (int row = 0; row < row_num; row++) {
+    const Tuple &tuple = child_tuple_set.get(row);
+    rids[row].first.page_num = *(int *)tuple.get_pointer(rid_page_index_[table])->value_pointer();
+    rids[row].first.slot_num = *(int *)tuple.get_pointer(rid_slot_index_[table])->value_pointer();
+    rids[row].second = row;
+  }
+  std::sort(rids.begin(), rids.end(), [](const std::pair<RID, int> &lhs, const std::pair<RID, int> &rhs) {
+    if (lhs.first.page_num != rhs.first.page_num) {
+      return lhs.first.page_num < rhs.first.page_num;
+    }
+    return lhs.first.slot_num < rhs.first.slot_num;
+  });
+
+  // join之后同一条记录可能出现多次，只读一次
+  std::vector<RID> unique_rids;
+  std::vector<int> &fetched_index = fetched_index_[table];
+  fetched_index.assign(row_num, 0);
+  for (const auto &rid : rids) {
+    if (unique_rids.empty() || !(unique_rids.back() == rid.first)) {
+      unique_rids.push_back(rid.first);
+    }
+    fetched_index[rid.second] = unique_rids.size() - 1;
+  }
+
+  TupleSet &fetched = fetched_[table];
+  fetched.clear();
+  fetched.set_schema(tables_[table].fields);
+  TupleRecordConverter converter(tables_[table].table, fetched);
+  RC rc = tables_[table].table->get_records(unique_rids.data(), unique_rids.size(), &converter, fetch_record_reader);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to fetch records of table %s. rc=%d:%s", tables_[table].table->name(), rc, strrc(rc));
+  }
+  return rc;
+}
+
+RC LateMaterializeExecutor::do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
+  tuple_set.clear();
+  tuple_set.set_schema(output_schema_);
+  TupleSet child_tuple_set;
+  RC rc = executor_->next(child_tuple_set, filters);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  if (!bound_) {
+    rc = bind(child_tuple_set.get_schema());
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+  for (size_t table = 0; table < tables_.size(); table++) {
+    rc = fetch(table, child_tuple_set);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+
+  for (int row = 0; row < child_tuple_set.size(); row++) {
+    const Tuple &child_tuple = child_tuple_set.get(row);
+    Tuple tuple;
+    for (size_t i = 0; i < source_table_.size(); i++) {
+      int table = source_table_[i];
+      if (table < 0) {
+        tuple.add(child_tuple.get_pointer(source_index_[i]));
+      } else {
+        tuple.add(fetched_[table].get(fetched_index_[table][row]).get_pointer(source_index_[i]));
+      }
+    }
+    tuple_set.add(std::move(tuple));
+  }
+  return RC::SUCCESS;
+}
+
+RC LateMaterializeExecutor::rewind() {
+  return executor_->rewind();
+}
+
+void LateMaterializeExecutor::describe(ExplainNode &node) {
+  node.name = "LateMaterialize";
+  for (LateTable &table : tables_) {
+    if (!node.detail.empty()) {
+      node.detail += ", ";
+    }
+    node.detail += std::string(table.table->name()) + "(" + schema_to_string(table.fields) + ")";
+  }
+}
+
+std::vector<Executor *> LateMaterializeExecutor::children() {
+  return {executor_};
+}
@@ -0,0 +1,58 @@
+#ifndef MINIDB_LATE_MATERIALIZE_EXECUTOR_H
+#define MINIDB_LATE_MATERIALIZE_EXECUTOR_H
+
+#include <vector>
+
+#include "storage/common/table.h"
+#include "executor.h"
+
+/**
+ * 延迟物化：子节点中的表只读出过滤和join需要的字段以及记录的rid(TupleRecordConverter的rid字段)，
+ * 其余只用于输出的字段，在每一批结果通过了过滤和join之后，再按rid从记录所在的页面中读出。
+ * 同一批中一张表的rid按页号排序并去重之后读取，页面按顺序访问，每页只读一次
+ */
+class LateMaterializeExecutor : public Executor {
+public:
+  struct LateTable {
+    Table *table;
+    TupleSchema fields;  // 延迟读取的字段
+  };
+
+  LateMaterializeExecutor(ExecutorContext *context, Executor *executor, std::vector<LateTable> &&tables);
+
+  ~LateMaterializeExecutor() = default;
+
+  RC rewind() override;
+
+protected:
+  RC do_init() override;
+  RC do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) override;
+  void describe(ExplainNode &node) override;
+  std::vector<Executor *> children() override;
+
+private:
+  // 子节点的输出去掉rid字段，加上延迟读取的字段
+  static TupleSchema materialized_schema(const TupleSchema &child_schema, const std::vector<LateTable> &tables);
+  // 确定output_schema_中每个字段的来源
+  RC bind(const TupleSchema &child_schema);
+  // 读出child_tuple_set中第table张表的记录中延迟读取的字段
+  RC fetch(size_t table, const TupleSet &child_tuple_set);
+
+private:
+  Executor *executor_;
+  std::vector<LateTable> tables_;
+
+  bool bound_ = false;
+  // 每张表的rid字段在子节点输出中的下标
+  std::vector<int> rid_page_index_;
+  std::vector<int> rid_slot_index_;
+  // output_schema_中每个字段的来源：source_table_为-1时是子节点输出的第source_index_个字段，
+  // 否则是tables_[source_table_]延迟读取的第source_index_个字段
+  std::vector<int> source_table_;
+  std::vector<int> source_index_;
+
+  std::vector<TupleSet> fetched_;               // 每张表这一批读出的记录，按rid排序
+  std::vector<std::vector<int>> fetched_index_;  // 每张表中子节点的每一行对应fetched_中的下标
+};
+
+#endif //MINIDB_LATE_MATERIALIZE_EXECUTOR_H
@@ -0,0 +1,41 @@
+#include "limit_executor.h"
+
+LimitExecutor::LimitExecutor(ExecutorContext *context, Executor *executor, int limit)
+    : Executor(context, executor->output_schema()), executor_(executor), limit_(limit) {}
+
+RC LimitExecutor::do_init() {
+  returned_ = 0;
+  return executor_->init();
+}
+
+RC LimitExecutor::do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
+  tuple_set.clear();
+  tuple_set.set_schema(output_schema_);
+  if (returned_ >= limit_) {
+    return RC::RECORD_EOF;
+  }
+  RC rc = executor_->next(tuple_set, filters);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  std::vector<Tuple> &tuples = tuple_set.tuples();
+  if (returned_ + (int)tuples.size() > limit_) {
+    tuples.erase(tuples.begin() + (limit_ - returned_), tuples.end());
+  }
+  returned_ += tuples.size();
+  return RC::SUCCESS;
+}
+
+RC LimitExecutor::rewind() {
+  returned_ = 0;
+  return executor_->rewind();
+}
+
+void LimitExecutor::describe(ExplainNode &node) {
+  node.name = "Limit";
+  node.detail = std::to_string(limit_);
+}
+
+std::vector<Executor *> LimitExecutor::children() {
+  return {executor_};
+}
@@ -0,0 +1,30 @@
+#ifndef MINIDB_LIMIT_EXECUTOR_H
+#define MINIDB_LIMIT_EXECUTOR_H
+
+#include "executor.h"
+
+/**
+ * 没有order by时的limit：返回够limit条之后不再向子节点要数据，
+ * 扫描和join因此可以提前结束
+ */
+class LimitExecutor : public Executor {
+public:
+  LimitExecutor(ExecutorContext *context, Executor *executor, int limit);
+
+  ~LimitExecutor() = default;
+
+  RC rewind() override;
+
+protected:
+  RC do_init() override;
+  RC do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) override;
+  void describe(ExplainNode &node) override;
+  std::vector<Executor *> children() override;
+
+private:
+  Executor *executor_;
+  int limit_;
+  int returned_ = 0;  // 已经返回的记录数
+};
+
+#endif //MINIDB_LIMIT_EXECUTOR_H
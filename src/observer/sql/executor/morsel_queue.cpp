@@ -0,0 +1,115 @@
+#include <algorithm>
+
+#include "sql/executor/morsel_queue.h"
+
+MorselQueue::MorselQueue(int morsel_count, int dop, int record_size, size_t memory_limit)
+    : record_size_(record_size), memory_limit_(memory_limit), morsels_(morsel_count), staging_(dop) {
+}
+
+bool MorselQueue::push(int worker, int morsel, const char *data) {
+  if (cancelled_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  Staging &staging = staging_[worker];
+  if (staging.morsel != morsel && !staging.data.empty()) {
+    flush(worker, false);
+  }
+  staging.morsel = morsel;
+  staging.data.insert(staging.data.end(), data, data + record_size_);
+  if (staging.data.size() >= FLUSH_SIZE) {
+    flush(worker, false);
+  }
+  return !cancelled_.load(std::memory_order_relaxed);
+}
+
+void MorselQueue::finish_morsel(int worker, int morsel) {
+  Staging &staging = staging_[worker];
+  if (staging.morsel != morsel && !staging.data.empty()) {
+    flush(worker, false);
+  }
+  staging.morsel = morsel;
+  flush(worker, true);
+}
+
+void MorselQueue::flush(int worker, bool done) {
+  Staging &staging = staging_[worker];
+  std::unique_lock<std::mutex> lock(mutex_);
+  Morsel &morsel = morsels_[staging.morsel];
+  if (!staging.data.empty()) {
+    consumed_.wait(lock, [&]() {
+      if (cancelled_) {
+        return true;
+      }
+      if ((size_t)staging.morsel == head_) {
+        return morsel.data.size() - morsel.pos < memory_limit_;
+      }
+      return buffered_ < memory_limit_;
+    });
+    if (!cancelled_) {
+      morsel.data.insert(morsel.data.end(), staging.data.begin(), staging.data.end());
+      buffered_ += staging.data.size();
+    }
+    staging.data.clear();
+  }
+  morsel.done = morsel.done || done;
+  lock.unlock();
+  produced_.notify_one();
+}
+
+void MorselQueue::finish(RC rc) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    finished_ = true;
+    rc_ = rc;
+  }
+  produced_.notify_all();
+}
+
+RC MorselQueue::pop(int max_count, std::vector<char> &records, int &count) {
+  records.clear();
+  count = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (count < max_count && !cancelled_) {
+    if (finished_ && rc_ != RC::SUCCESS) {
+      return rc_;
+    }
+    if (head_ >= morsels_.size()) {
+      break;
+    }
+    Morsel &morsel = morsels_[head_];
+    size_t available = (morsel.data.size() - morsel.pos) / record_size_;
+    if (available > 0) {
+      size_t bytes = std::min(available, (size_t)(max_count - count)) * record_size_;
+      records.insert(records.end(), morsel.data.begin() + morsel.pos, morsel.data.begin() + morsel.pos + bytes);
+      morsel.pos += bytes;
+      buffered_ -= bytes;
+      count += bytes / record_size_;
+      if (morsel.pos == morsel.data.size()) {
+        morsel.data.clear();
+        morsel.pos = 0;
+      }
+      consumed_.notify_all();
+      continue;
+    }
+    if (morsel.done || finished_) {
+      std::vector<char>().swap(morsel.data);
+      head_++;
+      consumed_.notify_all();
+      continue;
+    }
+    if (count > 0) {
+      break;
+    }
+    produced_.wait(lock);
+  }
+  return count > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+}
+
+void MorselQueue::cancel() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    cancelled_ = true;
+  }
+  consumed_.notify_all();
+  produced_.notify_all();
+}
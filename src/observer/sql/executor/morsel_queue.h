@@ -0,0 +1,75 @@
+#ifndef __OBSERVER_SQL_EXECUTOR_MORSEL_QUEUE_H_
+#define __OBSERVER_SQL_EXECUTOR_MORSEL_QUEUE_H_
+
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "rc.h"
+
+/**
+ * 并行扫描的结果按morsel的顺序交给一个消费者，缓存的记录总量有上限。
+ * 扫描线程先把记录放在自己的缓冲中，攒够一批或者morsel结束时再加到所在morsel的队列里；
+ * 消费者从编号最小的还没有取完的morsel(head)中按顺序取记录。
+ * 缓存超过memory_limit时扫描其它morsel的线程等待，扫描head的线程只在head自己的记录超过上限时等待，
+ * 因为morsel按编号顺序领取，head总是已经有线程在扫描或者已经扫描完，不会互相等待
+ */
+class MorselQueue {
+public:
+  MorselQueue(int morsel_count, int dop, int record_size, size_t memory_limit);
+  ~MorselQueue() = default;
+
+  /**
+   * 在扫描线程中调用，worker为线程编号[0, dop)。返回false表示消费者已经取消，扫描应当停止
+   */
+  bool push(int worker, int morsel, const char *data);
+  // 第morsel个morsel扫描结束
+  void finish_morsel(int worker, int morsel);
+  // 所有morsel扫描结束，rc为扫描的结果
+  void finish(RC rc);
+
+  /**
+   * 按morsel的顺序取出最多max_count条记录，连续复制到records中，count返回取出的记录数。
+   * 没有可取的记录时等待；全部取完后返回RECORD_EOF，扫描失败时返回扫描的错误码
+   */
+  RC pop(int max_count, std::vector<char> &records, int &count);
+  // 消费者不再需要剩下的记录，等待中的扫描线程返回
+  void cancel();
+
+public:
+  // 扫描线程的缓冲攒够这么多字节再加入队列
+  static const size_t FLUSH_SIZE = 32 * 1024;
+
+private:
+  struct Morsel {
+    std::vector<char> data;
+    size_t pos = 0;     // 已经取出的字节数
+    bool done = false;
+  };
+  struct Staging {
+    int morsel = -1;
+    std::vector<char> data;
+  };
+
+  // 把worker的缓冲加到所在morsel的队列中，done为true时同时标记这个morsel扫描结束
+  void flush(int worker, bool done);
+
+private:
+  const int record_size_;
+  const size_t memory_limit_;
+
+  std::mutex mutex_;
+  std::condition_variable produced_;  // 消费者等待新的记录
+  std::condition_variable consumed_;  // 扫描线程等待缓存有空间
+  std::vector<Morsel> morsels_;
+  std::vector<Staging> staging_;      // 每个扫描线程一个，只由这个线程访问，不需要加锁
+  size_t head_ = 0;
+  size_t buffered_ = 0;               // 队列中还没有取出的字节数
+  bool finished_ = false;
+  RC rc_ = RC::SUCCESS;
+  std::atomic<bool> cancelled_{false};
+};
+
+#endif //__OBSERVER_SQL_EXECUTOR_MORSEL_QUEUE_H_
@@ -23,7 +23,7 @@ NestLoopJoinExecutor::NestLoopJoinExecutor(ExecutorContext* context, const Tuple
   }
 };
 
-RC NestLoopJoinExecutor::init() {
+RC NestLoopJoinExecutor::do_init() {
   RC rc;
   rc = left_executor_->init();
   if(rc != RC::SUCCESS) {
@@ -36,48 +36,113 @@ RC NestLoopJoinExecutor::init() {
   return RC::SUCCESS;
 }
 
-RC NestLoopJoinExecutor::next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
+RC NestLoopJoinExecutor::do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
+  tuple_set.clear();
   tuple_set.set_schema(output_schema_);
-  if (ban_all_) {
-    return RC::SUCCESS;
+  if (ban_all_ || left_eof_) {
+    return RC::RECORD_EOF;
   }
-  TupleSet left_tuple_set;
-  left_executor_->next(left_tuple_set);
-  TupleSet right_tuple_set;
-  right_executor_->next(right_tuple_set);
 
-  if (left_tuple_set.size() == 0 || right_tuple_set.size() == 0) {
-    return RC::SUCCESS;
-  }
-  
-  std::vector<int> left_tuple_index = output_schema_.index_in(left_tuple_set.get_schema());
-  std::vector<int> right_tuple_index = output_schema_.index_in(right_tuple_set.get_schema());
+  RC rc;
+  while (tuple_set.size() < BATCH_SIZE) {
+    if (need_left_) {
+      // 上一批左侧已经和右侧全部组合过，取下一批并重新扫描右侧
+      rc = left_executor_->next(left_batch_);
+      if (rc != RC::SUCCESS) {
+        if (rc == RC::RECORD_EOF) {
+          left_eof_ = true;
+          break;
+        }
+        return rc;
+      }
+      rc = right_executor_->rewind();
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      need_left_ = false;
+      need_right_ = true;
+    }
+    if (need_right_) {
+      rc = right_executor_->next(right_batch_);
+      if (rc != RC::SUCCESS) {
+        if (rc == RC::RECORD_EOF) {
+          need_left_ = true;
+          continue;
+        }
+        return rc;
+      }
+      left_pos_ = 0;
+      right_pos_ = 0;
+      need_right_ = false;
+    }
 
-  for (const auto & left_tuple : left_tuple_set.tuples()) {
-    for (auto & right_tuple: right_tuple_set.tuples()) {
-      bool valid = true;
-      if (filters != nullptr) {
-        for (auto & tmp_filter : *filters) {
-          if (!tmp_filter->filter(left_tuple, left_tuple_set.get_schema(), right_tuple, right_tuple_set.get_schema())) {
+    // 右侧只有一批时，输出顺序与逐行的nested loop相同
+    std::vector<int> left_tuple_index = output_schema_.index_in(left_batch_.get_schema());
+    std::vector<int> right_tuple_index = output_schema_.index_in(right_batch_.get_schema());
+    // 输出满一批时可能停在右侧批次的中间，下一次从(left_pos_, right_pos_)继续
+    while (left_pos_ < left_batch_.size() && tuple_set.size() < BATCH_SIZE) {
+      const Tuple &left_tuple = left_batch_.get(left_pos_);
+      for ( ; right_pos_ < right_batch_.size() && tuple_set.size() < BATCH_SIZE; right_pos_++) {
+        const Tuple &right_tuple = right_batch_.get(right_pos_);
+        bool valid = true;
+        if (filters != nullptr) {
+          for (auto & tmp_filter : *filters) {
+            if (!tmp_filter->filter(left_tuple, left_batch_.get_schema(), right_tuple, right_batch_.get_schema())) {
+              valid = false;
+              break;
+            }
+          }
+        }
+        if (!valid) { continue; }
+        for (auto & self_filter : condition_filters_) {
+          if (!self_filter->filter(left_tuple, left_batch_.get_schema(), right_tuple, right_batch_.get_schema())) {
             valid = false;
             break;
           }
         }
-      }
-      if (!valid) { continue; }
-      for (auto & self_filter : condition_filters_) {
-        if (!self_filter->filter(left_tuple, left_tuple_set.get_schema(), right_tuple, right_tuple_set.get_schema())) {
-          valid = false;
-          break;
+        if (valid) {
+          Tuple result_tuple;
+          result_tuple.add(left_tuple, left_tuple_index);
+          result_tuple.add(right_tuple, right_tuple_index);
+          tuple_set.add(std::move(result_tuple));
         }
       }
-      if (valid) {
-        Tuple result_tuple;
-        result_tuple.add(left_tuple, left_tuple_index);
-        result_tuple.add(right_tuple, right_tuple_index);
-        tuple_set.add(std::move(result_tuple));
+      if (right_pos_ >= right_batch_.size()) {
+        left_pos_++;
+        right_pos_ = 0;
       }
     }
+    if (left_pos_ >= left_batch_.size()) {
+      need_right_ = true;
+    }
   }
-  return RC::SUCCESS;
-}
\ No newline at end of file
+  return tuple_set.size() > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+}
+
+RC NestLoopJoinExecutor::rewind() {
+  left_batch_.clear();
+  right_batch_.clear();
+  left_pos_ = 0;
+  right_pos_ = 0;
+  need_left_ = true;
+  need_right_ = true;
+  left_eof_ = false;
+  RC rc = left_executor_->rewind();
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  return right_executor_->rewind();
+}
+
+void NestLoopJoinExecutor::describe(ExplainNode &node) {
+  node.name = "NestedLoopJoin";
+  if (ban_all_) {
+    node.detail = "on false";
+  } else if (!condition_filters_.empty()) {
+    node.detail = "on " + filters_to_string(condition_filters_);
+  }
+}
+
+std::vector<Executor *> NestLoopJoinExecutor::children() {
+  return {left_executor_, right_executor_};
+}
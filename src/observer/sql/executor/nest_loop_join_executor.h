@@ -7,6 +7,9 @@
 #include <vector>
 
 
+/**
+ * block nested loop：每次从左侧取一批，对这一批重新扫描一遍右侧
+ */
 class NestLoopJoinExecutor : public Executor {
 public:
   NestLoopJoinExecutor(ExecutorContext* context,
@@ -18,15 +21,28 @@ public:
 
   ~NestLoopJoinExecutor() = default;
 
-  RC init() override;
+  RC rewind() override;
 
-  RC next(TupleSet &tuple_set, std::vector<Filter*> *filters = nullptr) override;
+protected:
+  RC do_init() override;
+  RC do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) override;
+  void describe(ExplainNode &node) override;
+  std::vector<Executor *> children() override;
 
 private:
   Executor *left_executor_;
   Executor *right_executor_;
   std::vector<Filter *> condition_filters_;
   bool ban_all_ = false;
+
+  // 当前的左右两批以及两批中的位置，输出满一批时从这里继续
+  TupleSet left_batch_;
+  TupleSet right_batch_;
+  int left_pos_ = 0;
+  int right_pos_ = 0;
+  bool need_left_ = true;
+  bool need_right_ = true;
+  bool left_eof_ = false;
 };
 
 
@@ -1,4 +1,5 @@
 #include "scan_executor.h"
+#include "storage/common/record_manager.h"
 #include <vector>
 
 ScanExecutor::ScanExecutor(ExecutorContext* context,
@@ -9,9 +10,15 @@ ScanExecutor::ScanExecutor(ExecutorContext* context,
                            Executor(context, output_schema),
                            table_(table),
                            condition_filters_(std::move(condition_filters)),
-                           ban_all_(ban_all){}
+                           ban_all_(ban_all){
+  for (const TupleField &field : output_schema.fields()) {
+    if (TupleRecordConverter::is_rid_field(field.field_name())) {
+      with_rid_ = true;
+    }
+  }
+}
 
-RC ScanExecutor::init() {
+RC ScanExecutor::do_init() {
   RC rc;
   for (const auto &filter : condition_filters_) {
     rc = filter->bind_table(table_);
@@ -22,31 +29,207 @@ RC ScanExecutor::init() {
   return RC::SUCCESS;
 }
 
-void record_saver(const char *data, void *context) {
-  TupleRecordConverter *converter = (TupleRecordConverter *)context;
-  converter->add_record(data);
+ScanExecutor::~ScanExecutor() {
+  stop_parallel();
 }
 
-RC ScanExecutor::next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
-  tuple_set.clear();
-  tuple_set.set_schema(output_schema_);
-  if (ban_all_) {
-    return RC::SUCCESS;
-  }
-  std::vector<Filter *> all_filters;
+void ScanExecutor::bind_filters(std::vector<Filter*> *filters) {
+  all_filters_.clear();
   if (filters != nullptr) {
     for(const auto &filter : *filters) {
       filter->bind_table(table_);
-      all_filters.push_back(filter);
+      all_filters_.push_back(filter);
     }
   }
   for (const auto & filter_: condition_filters_) {
-    all_filters.push_back(filter_);
+    all_filters_.push_back(filter_);
+  }
+  condition_filter_.init((const ConditionFilter **)all_filters_.data(), all_filters_.size());
+}
+
+int ScanExecutor::parallel_morsel_count() {
+  // 并行扫描只保留了记录的内容，需要输出rid时顺序扫描
+  if (exe_ctx_->parallel_degree() <= 1 || with_rid_) {
+    return 0;
   }
+  int morsel_count = table_->scan_morsel_count(&condition_filter_);
+  return morsel_count > 1 ? morsel_count : 0;
+}
 
-  CompositeConditionFilter condition_filter;
-  condition_filter.init((const ConditionFilter **)all_filters.data(), all_filters.size());
+RC ScanExecutor::open_scanner(std::vector<Filter*> *filters) {
+  stop_parallel();
+  bind_filters(filters);
+  opened_ = true;
+  eof_ = false;
+  parallel_ = false;
+  int morsel_count = parallel_morsel_count();
+  if (morsel_count > 0) {
+    parallel_ = true;
+    return scan_parallel(morsel_count);
+  }
+  return scanner_.open(table_, exe_ctx_->get_trx(), &condition_filter_);
+}
+
+static RC morsel_queue_reader(int worker, int morsel, const char *data, void *context) {
+  MorselQueue *queue = (MorselQueue *)context;
+  // 消费者已经取消时停止这个morsel，剩下的morsel读到第一条记录就停止
+  return queue->push(worker, morsel, data) ? RC::SUCCESS : RC::RECORD_EOF;
+}
+
+static void morsel_queue_done(int worker, int morsel, void *context) {
+  MorselQueue *queue = (MorselQueue *)context;
+  queue->finish_morsel(worker, morsel);
+}
+
+RC ScanExecutor::scan_parallel(int morsel_count) {
+  int dop = exe_ctx_->parallel_degree();
+  morsel_queue_.reset(new MorselQueue(morsel_count, dop, table_->table_meta().record_size(),
+                                      PARALLEL_SCAN_BUFFER_SIZE));
+  MorselQueue *queue = morsel_queue_.get();
+  Trx *trx = exe_ctx_->get_trx();
+  scan_thread_ = std::thread([this, queue, trx, dop, morsel_count]() {
+    RC rc = table_->scan_record_parallel(trx, &condition_filter_, dop, morsel_count, queue,
+                                         morsel_queue_reader, morsel_queue_done);
+    queue->finish(rc);
+  });
+  return RC::SUCCESS;
+}
+
+void ScanExecutor::stop_parallel() {
+  if (morsel_queue_ != nullptr) {
+    morsel_queue_->cancel();
+  }
+  if (scan_thread_.joinable()) {
+    scan_thread_.join();
+  }
+  morsel_queue_.reset();
+  std::vector<char>().swap(records_);
+}
+
+RC ScanExecutor::aggregate_parallel(std::vector<Filter*> *filters, ParallelAggregator &aggregator,
+                                    const std::vector<int> &key_index, const std::vector<int> &value_index,
+                                    bool &fused) {
+  fused = false;
+  if (ban_all_) {
+    return RC::SUCCESS;
+  }
+  stop_parallel();
+  scanner_.close();
+  bind_filters(filters);
+  int morsel_count = parallel_morsel_count();
+  if (morsel_count == 0) {
+    opened_ = false;
+    return RC::SUCCESS;
+  }
+  OperatorTimer timer(stats());
+  int64_t rows = 0;
+  RC rc = aggregator.aggregate_scan(table_, exe_ctx_->get_trx(), &condition_filter_, morsel_count, output_schema_,
+                                    key_index, value_index, rows);
+  if (stats() != nullptr) {
+    stats()->rows += rows;
+  }
+  fused = true;
+  opened_ = true;
+  eof_ = true;
+  parallel_ = false;
+  return rc;
+}
 
+RC ScanExecutor::scan_batch(std::vector<Filter*> *filters, TupleRecordConverter &converter, int *count) {
+  *count = 0;
+  if (ban_all_) {
+    return RC::RECORD_EOF;
+  }
+  RC rc;
+  if (!opened_) {
+    rc = open_scanner(filters);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+  if (eof_) {
+    return RC::RECORD_EOF;
+  }
+
+  if (parallel_) {
+    int record_size = table_->table_meta().record_size();
+    rc = morsel_queue_->pop(BATCH_SIZE, records_, *count);
+    if (rc != RC::SUCCESS) {
+      eof_ = true;
+      stop_parallel();
+      return rc;
+    }
+    for (int i = 0; i < *count; i++) {
+      converter.add_record(records_.data() + (size_t)i * record_size);
+    }
+    return RC::SUCCESS;
+  }
+
+  Record record;
+  while (*count < BATCH_SIZE) {
+    rc = scanner_.next(&record);
+    if (rc != RC::SUCCESS) {
+      if (rc != RC::RECORD_EOF) {
+        return rc;
+      }
+      eof_ = true;
+      scanner_.close();
+      break;
+    }
+    converter.add_record(record.data, &record.rid);
+    (*count)++;
+  }
+  return *count > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+}
+
+RC ScanExecutor::do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
+  tuple_set.clear();
+  tuple_set.set_schema(output_schema_);
   TupleRecordConverter converter(table_, tuple_set);
-  return table_->scan_record(exe_ctx_->get_trx(), &condition_filter, -1, (void *)&converter, record_saver);
+  int count;
+  return scan_batch(filters, converter, &count);
+}
+
+RC ScanExecutor::do_next_batch(ColumnBatch &batch, std::vector<Filter*> *filters) {
+  batch.init(output_schema_);
+  TupleRecordConverter converter(table_, batch);
+  int count;
+  return scan_batch(filters, converter, &count);
+}
+
+RC ScanExecutor::rewind() {
+  scanner_.close();
+  opened_ = false;
+  eof_ = false;
+  parallel_ = false;
+  stop_parallel();
+  return RC::SUCCESS;
+}
+
+void ScanExecutor::describe(ExplainNode &node) {
+  node.name = "TableScan";
+  node.detail = table_->name();
+  CompositeConditionFilter condition_filter;
+  condition_filter.init((const ConditionFilter **)condition_filters_.data(), condition_filters_.size());
+  std::vector<std::string> index_names;
+  table_->scan_index_names(&condition_filter, nullptr, index_names);
+  if (!index_names.empty()) {
+    node.name = "IndexScan";
+    node.detail += " index=" + index_names[0];
+    for (size_t i = 1; i < index_names.size(); i++) {
+      node.detail += "&" + index_names[i];
+    }
+  } else if (exe_ctx_ != nullptr && exe_ctx_->parallel_degree() > 1 && !with_rid_ &&
+             table_->scan_morsel_count(&condition_filter) > 1) {
+    node.detail += " parallel=" + std::to_string(exe_ctx_->parallel_degree());
+  }
+  if (ban_all_) {
+    node.detail += " filter: false";
+  } else if (!condition_filters_.empty()) {
+    node.detail += " filter: " + filters_to_string(condition_filters_);
+  }
+}
+
+std::vector<Executor *> ScanExecutor::children() {
+  return {};
 }
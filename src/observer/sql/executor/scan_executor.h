@@ -3,23 +3,74 @@
 
 #include "storage/common/table.h"
 #include "sql/executor/executor.h"
+#include "sql/executor/aggregation_hash_table.h"
+#include "sql/executor/morsel_queue.h"
 #include "tuple.h"
+#include <memory>
+#include <thread>
 #include <vector>
 
 class ScanExecutor : public Executor {
 public:
   ScanExecutor(ExecutorContext* context, Table *table, const TupleSchema &output_schema, std::vector<Filter*> &&condition_filters, bool ban_all);
 
- ~ScanExecutor() = default;
+ ~ScanExecutor();
 
-  RC init() override;
+  RC rewind() override;
 
-  RC next(TupleSet &tuple_set, std::vector<Filter*> *filters = nullptr) override;
+  /**
+   * 扫描与局部聚合融合：可以并行扫描时，各扫描线程把记录直接聚合到aggregator中自己的局部hash表，
+   * 不经过next，之后的next返回RECORD_EOF。不能并行扫描时fused为false，由调用者通过next读取
+   */
+  RC aggregate_parallel(std::vector<Filter*> *filters, ParallelAggregator &aggregator,
+                        const std::vector<int> &key_index, const std::vector<int> &value_index, bool &fused);
+
+public:
+  // 并行扫描时缓存的、还没有被next取走的记录的上限
+  static const size_t PARALLEL_SCAN_BUFFER_SIZE = 4 * 1024 * 1024;
+
+  Table *table() { return table_; }
+  std::vector<Filter *> &condition_filters() { return condition_filters_; }
+  bool ban_all() const { return ban_all_; }
+
+protected:
+  RC do_init() override;
+  RC do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) override;
+  RC do_next_batch(ColumnBatch &batch, std::vector<Filter*> *filters) override;
+  void describe(ExplainNode &node) override;
+  std::vector<Executor *> children() override;
+
+private:
+  // 把父节点传入的filters和自己的条件合并到condition_filter_中
+  void bind_filters(std::vector<Filter*> *filters);
+  // 可以并行扫描时返回morsel个数，否则返回0
+  int parallel_morsel_count();
+  RC open_scanner(std::vector<Filter*> *filters);
+  // 从scanner中取出最多BATCH_SIZE条记录交给converter，count返回取到的记录数
+  RC scan_batch(std::vector<Filter*> *filters, TupleRecordConverter &converter, int *count);
+  // 并行度大于1并且表可以切分为多个morsel时，在后台线程中并行扫描，结果按morsel的顺序放入morsel_queue_
+  RC scan_parallel(int morsel_count);
+  // 停止后台的并行扫描并等待它结束
+  void stop_parallel();
 
 private:
   Table * table_;
   std::vector<Filter *> condition_filters_;
   bool ban_all_ = false;
+  bool with_rid_ = false;  // output_schema中有rid字段，延迟物化时使用
+
+  // 当前这一轮扫描的状态，rewind后在下一次next时重新打开
+  bool opened_ = false;
+  bool eof_ = false;
+  std::vector<Filter *> all_filters_;
+  CompositeConditionFilter condition_filter_;
+  TableScanner scanner_;
+
+  // 并行扫描：scan_thread_中调用Table::scan_record_parallel，缓存的记录有上限，按morsel的顺序分批返回
+  bool parallel_ = false;
+  std::unique_ptr<MorselQueue> morsel_queue_;
+  std::thread scan_thread_;
+  std::vector<char> records_;  // 从morsel_queue_中取出的一批记录
 };
 
 
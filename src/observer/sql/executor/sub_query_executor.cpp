@@ -1,5 +1,85 @@
 #include "sub_query_executor.h"
-#include <unordered_set>
+#include <algorithm>
+
+// 与FloatValue::compare中的精度一致
+static const float FLOAT_EPSILON = 1e-5;
+// 关联子查询缓存的结果中值的总数上限，超过之后清空缓存
+static const size_t CORRELATED_CACHE_VALUES = 1 << 20;
+
+void SubQueryValueSet::insert(const std::shared_ptr<TupleValue> &value) {
+  if (first_ == nullptr) {
+    first_ = value;
+  }
+  size_++;
+  switch (value->Type()) {
+    case UNDEFINED:
+      has_null_ = true;
+      break;
+    case INTS: {
+      int v = *(const int *)value->value_pointer();
+      ints_.insert(v);
+      numbers_.push_back((float)v);
+    } break;
+    case FLOATS:
+      has_float_ = true;
+      numbers_.push_back(*(const float *)value->value_pointer());
+      break;
+    default:
+      strings_.insert(*(const std::string *)value->value_pointer());
+      break;
+  }
+}
+
+void SubQueryValueSet::build() {
+  std::sort(numbers_.begin(), numbers_.end());
+}
+
+bool SubQueryValueSet::contains(const std::shared_ptr<TupleValue> &value) const {
+  float v;
+  switch (value->Type()) {
+    case UNDEFINED:
+      return false;
+    case INTS:
+      if (!has_float_) {
+        return ints_.count(*(const int *)value->value_pointer()) != 0;
+      }
+      v = (float)*(const int *)value->value_pointer();
+      break;
+    case FLOATS:
+      v = *(const float *)value->value_pointer();
+      break;
+    default:
+      return strings_.count(*(const std::string *)value->value_pointer()) != 0;
+  }
+  auto iter = std::lower_bound(numbers_.begin(), numbers_.end(), v - FLOAT_EPSILON);
+  return iter != numbers_.end() && *iter < v + FLOAT_EPSILON;
+}
+
+void SubQueryValueSet::clear() {
+  first_ = nullptr;
+  ints_.clear();
+  strings_.clear();
+  numbers_.clear();
+  has_float_ = false;
+  has_null_ = false;
+  size_ = 0;
+}
+
+// 关联子查询缓存的key：类型加上值的字节
+static void correlated_key(const std::shared_ptr<TupleValue> &value, std::string &key) {
+  key.assign(1, (char)value->Type());
+  switch (value->Type()) {
+    case UNDEFINED:
+      break;
+    case INTS:
+    case FLOATS:
+      key.append((const char *)value->value_pointer(), 4);
+      break;
+    default:
+      key.append(*(const std::string *)value->value_pointer());
+      break;
+  }
+}
 
 SubQueryExecutor::SubQueryExecutor(ExecutorContext* context,
                                    Executor *left_executor, RelAttr left_attr,
@@ -12,7 +92,7 @@ SubQueryExecutor::SubQueryExecutor(ExecutorContext* context,
                                    right_executor_(right_executor),
                                    multi_table_conditions_(std::move(multi_table_conditions)){}
 
-RC SubQueryExecutor::init() {
+RC SubQueryExecutor::do_init() {
   RC rc;
   rc = left_executor_->init();
   if(rc != RC::SUCCESS) {
@@ -25,90 +105,61 @@ RC SubQueryExecutor::init() {
   return RC::SUCCESS;
 }
 
-struct ValueEqual {
-  bool operator()(const std::shared_ptr<TupleValue> &lhs, const std::shared_ptr<TupleValue> &rhs) const
-  {
-    return lhs->compare(*rhs) == 0;
-  }
-};
-
-struct ValueHash {
-  size_t operator()(const std::shared_ptr<TupleValue> &v) const
-  {
-    if (v->Type() == CHARS || v->Type() == DATES) {
-      return std::hash<std::string>()((const char*)v->value_pointer());
-    } else if(v->Type() == INTS) {
-      return std::hash<int>()(*(const int*)v->value_pointer());
-    } else if (v->Type() == FLOATS) {
-      return std::hash<float>()(*(const float*)v->value_pointer());
-    } else {
-      return 0;
+void SubQueryExecutor::bind_correlated_fields(const TupleSchema &left_schema) {
+  correlated_index_.clear();
+  correlated_on_left_.clear();
+  for (const Condition &condition : multi_table_conditions_) {
+    int index = -1;
+    bool on_left = false;
+    if (condition.left_is_attr && condition.left_attr.relation_name != nullptr
+        && condition.right_is_attr && condition.right_attr.relation_name != nullptr) {
+      // left_attr op right_attr => left_value op right_attr
+      index = left_schema.index_of_field(condition.left_attr.relation_name, condition.left_attr.attribute_name);
+      on_left = index >= 0;
+      if (index < 0) {
+        // left_attr op right_attr => left_attr op right_value
+        index = left_schema.index_of_field(condition.right_attr.relation_name, condition.right_attr.attribute_name);
+      }
     }
+    correlated_index_.push_back(index);
+    correlated_on_left_.push_back(on_left);
   }
-};
-
+}
 
-RC SubQueryExecutor::add_multi_table_filter(const TupleField &field, TupleValue &value, std::vector<Filter*> *filters) {
-  const std::map<std::string, std::map<std::string, int>> field_index = left_executor_->output_schema().table_field_index();
+RC SubQueryExecutor::add_multi_table_filter(const Tuple &left_tuple, std::vector<Filter*> *filters) {
   Filter* filter;
-  for (auto multi_condition : multi_table_conditions_) {
-    Condition condition = multi_condition;
-    bool valid_condition = false;
-    // left_attr op right_attr => left_value op right_attr
-    if (condition.left_is_attr && condition.left_attr.relation_name != nullptr 
-        && field_index.count(condition.left_attr.relation_name) != 0
-        && condition.right_is_attr && condition.right_attr.relation_name != nullptr
-        && field_index.count(condition.right_attr.relation_name) == 0) {
+  for (size_t i = 0; i < multi_table_conditions_.size(); i++) {
+    if (correlated_index_[i] < 0) {
+      continue;
+    }
+    Condition condition = multi_table_conditions_[i];
+    const std::shared_ptr<TupleValue> &value = left_tuple.get_pointer(correlated_index_[i]);
+    Value &condition_value = correlated_on_left_[i] ? condition.left_value : condition.right_value;
+    if (correlated_on_left_[i]) {
       condition.left_is_attr = 0;
-      condition.left_value.data = value.value_pointer();
-      condition.left_value.type = value.Type();
-      valid_condition = true;
-    }
-    // left_attr op right_attr => left_attr op right_value
-    if (condition.right_is_attr && condition.right_attr.relation_name != nullptr 
-    && field_index.count(condition.right_attr.relation_name) != 0
-    && condition.left_is_attr && condition.left_attr.relation_name != nullptr
-    && field_index.count(condition.left_attr.relation_name) == 0) {
+    } else {
       condition.right_is_attr = 0;
-      condition.right_value.data = value.value_pointer();
-      condition.right_value.type = value.Type();
-      valid_condition = true;
-    }
-    if (valid_condition) {
-      bool ban_all = false;
-      filter = Filter::from_condition(condition, ban_all);
-      if (ban_all) {
-        filters->clear();
-        return RC::SUCCESS;
-      }
-      filters->push_back(filter);
     }
-  }
-  return RC::SUCCESS;
-}
-
-RC SubQueryExecutor::remove_multi_table_filter(std::vector<Filter*> *filters, size_t num) {
-  for (int i = 0; i < num; ++i) {
-    if (filters->empty()) {
-      return RC::SUCCESS;
+    condition_value.type = value->Type();
+    if (value->Type() == CHARS || value->Type() == DATES) {
+      condition_value.data = (void *)((std::string *)value->value_pointer())->c_str();
     } else {
-      filters->pop_back();
+      condition_value.data = value->value_pointer();
+    }
+    bool ban_all = false;
+    filter = Filter::from_condition(condition, ban_all);
+    if (ban_all) {
+      filters->clear();
+      return RC::SUCCESS;
+    }
+    if (filter != nullptr) {
+      filters->push_back(filter);
     }
   }
   return RC::SUCCESS;
 }
-// 1. get left_tuple_set and check attribute wheather in left_tuple_schema
-// 2. find left_tuple_schema indexs in output_schema
-// 3. if multi table condition is empty
-//    1. use right_tuple_set to build a hash table
-//    2. check left_value is in right_tuple_schema and put it to tmp_tuple_set
-// 4. if multi table condition is not empty
-//    1. use left_value to build multi table filters and filter right_tuple_set
-//    2. check left_value is in right_tuple_schema and put it to tmp_tuple_set
-// 5. check tmp_tuple_set by filters
-// 6. add it to tuple_set
-RC SubQueryExecutor::next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
-  // pre check
+
+RC SubQueryExecutor::check_right_schema() {
   if (op_ != IN_OP && op_ != NOT_IN_OP) {
     if (!right_executor_->output_schema().fields().empty()) {
       return RC::INTERNAL;
@@ -121,101 +172,169 @@ RC SubQueryExecutor::next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
       return RC::INTERNAL;
     }
   }
+  return RC::SUCCESS;
+}
 
-  tuple_set.set_schema(output_schema_);
-  TupleSet left_tuple_set;
-  RC rc = left_executor_->next(left_tuple_set, filters);
+// null与任何值比较的结果都是unknown，不满足条件；
+// NOT IN 的子查询结果中有null时，不在集合中的值也是unknown
+bool SubQueryExecutor::match(const std::shared_ptr<TupleValue> &left_value, const SubQueryValueSet &value_set) const {
+  if (op_ == IN_OP) {
+    return value_set.contains(left_value);
+  }
+  if (op_ == NOT_IN_OP) {
+    if (value_set.empty()) {
+      return true;
+    }
+    return left_value->Type() != UNDEFINED && !value_set.has_null() && !value_set.contains(left_value);
+  }
+  // [=,<,>,...] (select xxx)
+  if (value_set.empty() || left_value->Type() == UNDEFINED || value_set.first()->Type() == UNDEFINED) {
+    return false;
+  }
+  return compare_result(left_value->compare(*value_set.first()), op_);
+}
+
+RC SubQueryExecutor::evaluate(std::vector<Filter*> *filters, SubQueryValueSet &value_set) {
+  TupleSet right_tuple_set;
+  RC rc = right_executor_->next_all(right_tuple_set, filters);
   if (rc != RC::SUCCESS) {
     return rc;
   }
-  if (left_tuple_set.size() == 0) {
+  value_set.clear();
+  for (const auto & right_tuple : right_tuple_set.tuples()) {
+    value_set.insert(right_tuple.get_pointer(0));
+  }
+  value_set.build();
+  return RC::SUCCESS;
+}
+
+RC SubQueryExecutor::correlated_match(const Tuple &left_tuple, const std::shared_ptr<TupleValue> &left_value,
+                                      std::vector<Filter*> *filters, bool &matched) {
+  std::string key;
+  std::string value_key;
+  bool has_null = false;
+  for (int index : correlated_index_) {
+    if (index >= 0) {
+      const std::shared_ptr<TupleValue> &value = left_tuple.get_pointer(index);
+      has_null = has_null || value->Type() == UNDEFINED;
+      correlated_key(value, value_key);
+      key.append(value_key);
+    }
+  }
+  auto iter = correlated_cache_.find(key);
+  if (iter != correlated_cache_.end()) {
+    matched = match(left_value, iter->second);
     return RC::SUCCESS;
   }
 
-  std::map<std::string, std::map<std::string, int>> left_table_field_index = left_tuple_set.get_schema().table_field_index();
-  auto find_left_table = left_table_field_index.find(left_attr_.relation_name);
-  if (find_left_table == left_table_field_index.end()) {
-    return RC::INVALID_ARGUMENT;
+  SubQueryValueSet value_set;
+  if (!has_null) {  // 外层的值是null时关联条件不成立，子查询的结果是空的
+    std::vector<Filter*> multi_table_filters;
+    add_multi_table_filter(left_tuple, &multi_table_filters);
+    std::vector<Filter*> right_next_filters;
+    if (filters) {
+      right_next_filters = *filters;
+    }
+    right_next_filters.insert(right_next_filters.end(), multi_table_filters.begin(), multi_table_filters.end());
+    // 每组不同的外层值都要带上新的条件重新执行一次
+    RC rc = right_executor_->rewind();
+    if (rc == RC::SUCCESS) {
+      rc = evaluate(&right_next_filters, value_set);
+    }
+    if (rc != RC::SUCCESS) {
+      // 出错时可能还有没有读完的并行扫描在使用这些条件，先让它停下来再释放
+      right_executor_->rewind();
+    }
+    for (Filter *filter : multi_table_filters) {
+      delete filter;
+    }
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
   }
-  auto find_left_field = find_left_table->second.find(left_attr_.attribute_name);
-  if (find_left_field == find_left_table->second.end()) {
-    return RC::INVALID_ARGUMENT;
+  matched = match(left_value, value_set);
+  if (correlated_cache_values_ + value_set.size() > CORRELATED_CACHE_VALUES) {
+    correlated_cache_.clear();
+    correlated_cache_values_ = 0;
   }
-  int left_field_index = find_left_field->second;
-  int right_field_index = 0;
-  TupleSet tmp_tuple_set;
-// left tuple index in ouput_schema
-  std::vector<int> left_tuple_index = output_schema_.index_in(left_tuple_set.get_schema());
+  correlated_cache_values_ += value_set.size();
+  correlated_cache_.emplace(std::move(key), std::move(value_set));
+  return RC::SUCCESS;
+}
 
-  if (multi_table_conditions_.empty()) {
-    TupleSet right_tuple_set;
-    rc = right_executor_->next(right_tuple_set);
+// 每次从左侧取一批：
+// 1. check attribute wheather in left_tuple_schema
+// 2. find left_tuple_schema indexs in output_schema
+// 3. if multi table condition is empty
+//    1. use right_tuple_set to build a hash table (only once)
+//    2. check left_value is in right_tuple_schema and put it to tmp_tuple_set
+// 4. if multi table condition is not empty
+//    1. use left_value to build multi table filters and rerun right executor
+//    2. check left_value is in right_tuple_schema and put it to tmp_tuple_set
+// 5. check tmp_tuple_set by filters
+// 6. add it to tuple_set
+// 直到得到非空的一批或者左侧读完
+RC SubQueryExecutor::do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
+  RC rc = check_right_schema();
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  tuple_set.clear();
+  tuple_set.set_schema(output_schema_);
+  TupleSet left_tuple_set;
+  while (tuple_set.size() == 0) {
+    rc = left_executor_->next(left_tuple_set, filters);
     if (rc != RC::SUCCESS) {
       return rc;
     }
-    if (op_ != IN_OP && op_ != NOT_IN_OP && right_tuple_set.size() == 0) {
-      return RC::SUCCESS;
+    rc = filter_left_batch(left_tuple_set, tuple_set, filters);
+    if (rc != RC::SUCCESS) {
+      return rc;
     }
-    std::unordered_set<std::shared_ptr<TupleValue>, ValueHash, ValueEqual> tuple_value_set;
-    for (const auto & right_tuple : right_tuple_set.tuples()) {
-      tuple_value_set.insert(right_tuple.get_pointer(right_field_index));
+  }
+  return RC::SUCCESS;
+}
+
+RC SubQueryExecutor::filter_left_batch(TupleSet &left_tuple_set, TupleSet &tuple_set, std::vector<Filter*> *filters) {
+  RC rc;
+  if (left_field_index_ < 0) {
+    left_field_index_ = left_tuple_set.get_schema().index_of_field(left_attr_.relation_name, left_attr_.attribute_name);
+    if (left_field_index_ < 0) {
+      return RC::INVALID_ARGUMENT;
     }
-    std::shared_ptr<TupleValue> left_value;
-    for (auto & left_tuple : left_tuple_set.tuples()) {
-      left_value = left_tuple.get_pointer(left_field_index);
-      bool valid;
-      if (op_ == IN_OP || op_ == NOT_IN_OP) { // in (select xxx) or not in (select xxx)
-        int count = tuple_value_set.count(left_value);
-        valid = ((op_ == IN_OP && count != 0) || (op_ == NOT_IN_OP && count == 0));
-      } else { // [=,<,>,...] (select xxx)
-        valid = compare_result(left_value->compare(**tuple_value_set.begin()), op_);
+  }
+  int left_field_index = left_field_index_;
+  TupleSet tmp_tuple_set;
+// left tuple index in ouput_schema
+  std::vector<int> left_tuple_index = output_schema_.index_in(left_tuple_set.get_schema());
+
+  if (multi_table_conditions_.empty()) {
+    if (!right_loaded_) {
+      rc = evaluate(nullptr, right_value_set_);
+      if (rc != RC::SUCCESS) {
+        return rc;
       }
-      if (valid) {
+      right_loaded_ = true;
+    }
+    for (auto & left_tuple : left_tuple_set.tuples()) {
+      if (match(left_tuple.get_pointer(left_field_index), right_value_set_)) {
         tmp_tuple_set.add(std::move(left_tuple));
       }
     }
   } else {
-    TupleSet right_tuple_set;
-    std::shared_ptr<TupleValue> left_value;
-    std::unordered_set<std::shared_ptr<TupleValue>, ValueHash, ValueEqual> tuple_value_set;
-    std::vector<Filter*> multi_table_filters;
-    auto * right_next_filters = new std::vector<Filter*>;
-    if (filters) {
-      for (auto & filter : *filters) {
-        right_next_filters->push_back(filter);
-      }
+    if (correlated_index_.empty()) {
+      bind_correlated_fields(left_tuple_set.get_schema());
     }
     for (auto & left_tuple : left_tuple_set.tuples()) {
-      left_value = left_tuple.get_pointer(left_field_index);
-      multi_table_filters.clear();
-      add_multi_table_filter(left_tuple_set.get_schema().field(left_field_index), *left_value, &multi_table_filters);
-      for(auto & filter: multi_table_filters) {
-        right_next_filters->push_back(filter);
-      }
-      right_tuple_set.clear();
-      rc = right_executor_->next(right_tuple_set, right_next_filters);
+      bool matched = false;
+      rc = correlated_match(left_tuple, left_tuple.get_pointer(left_field_index), filters, matched);
       if (rc != RC::SUCCESS) {
         return rc;
       }
-      if (op_ != IN_OP && op_ != NOT_IN_OP && right_tuple_set.size() == 0) {
-        continue;
-      }
-      tuple_value_set.clear();
-      for (const auto & right_tuple : right_tuple_set.tuples()) {
-        tuple_value_set.insert(right_tuple.get_pointer(right_field_index));
-      }
-      bool valid;
-      if (op_ == IN_OP || op_ == NOT_IN_OP) { // in (select xxx) or not in (select xxx)
-        int count = tuple_value_set.count(left_value);
-        valid = ((op_ == IN_OP && count != 0) || (op_ == NOT_IN_OP && count == 0));
-      } else { // [=,<,>,...] (select xxx)
-        valid = compare_result(left_value->compare(**tuple_value_set.begin()), op_);
-      }
-      if (valid) {
+      if (matched) {
         tmp_tuple_set.add(std::move(left_tuple));
       }
-
-      remove_multi_table_filter(right_next_filters, multi_table_filters.size());
     }
   }
 
@@ -237,4 +356,31 @@ RC SubQueryExecutor::next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
     }
   }
   return RC::SUCCESS;
-}
\ No newline at end of file
+}
+
+RC SubQueryExecutor::rewind() {
+  // 非关联子查询的结果不会变化，rewind之后继续使用缓存的结果。
+  // 关联子查询的结果还取决于上层传下来的条件，上层在换一组条件之前总是先rewind，所以这里清空缓存
+  correlated_cache_.clear();
+  correlated_cache_values_ = 0;
+  RC rc = left_executor_->rewind();
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  return right_executor_->rewind();
+}
+
+void SubQueryExecutor::describe(ExplainNode &node) {
+  node.name = "SubQuery";
+  if (left_attr_.relation_name != nullptr) {
+    node.detail = std::string(left_attr_.relation_name) + ".";
+  }
+  node.detail += std::string(left_attr_.attribute_name) + " " + comp_op_to_string(op_) + " (subquery)";
+  if (!multi_table_conditions_.empty()) {
+    node.detail += " correlated";
+  }
+}
+
+std::vector<Executor *> SubQueryExecutor::children() {
+  return {left_executor_, right_executor_};
+}
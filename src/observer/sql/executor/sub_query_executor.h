@@ -4,8 +4,41 @@
 #include "storage/common/table.h"
 #include "sql/executor/executor.h"
 #include "tuple.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+/**
+ * 子查询结果的集合，按值的类型分开存放，IN / NOT IN 对左侧的每个值做一次哈希查找，
+ * 不需要对每个值做shared_ptr和虚函数的比较。
+ * 整数放在unordered_set<int>中，字符串和日期放在unordered_set<std::string>中；
+ * 与浮点数比较时，所有数值按float排序后二分查找，与TupleValue::compare一样把相差小于1e-5的值看作相等
+ */
+class SubQueryValueSet {
+public:
+  void insert(const std::shared_ptr<TupleValue> &value);
+  // 所有值insert之后调用
+  void build();
+  bool contains(const std::shared_ptr<TupleValue> &value) const;
+  void clear();
+
+  bool empty() const { return first_ == nullptr; }
+  size_t size() const { return size_; }
+  bool has_null() const { return has_null_; }
+  // 第一个值，比较运算(=,<,>...)的子查询只有一个值
+  const std::shared_ptr<TupleValue> &first() const { return first_; }
+
+private:
+  std::shared_ptr<TupleValue> first_;
+  std::unordered_set<int> ints_;
+  std::unordered_set<std::string> strings_;
+  std::vector<float> numbers_;  // 所有的整数和浮点数，build之后有序
+  bool has_float_ = false;
+  bool has_null_ = false;
+  size_t size_ = 0;
+};
+
 class SubQueryExecutor : public Executor {
 
 public:
@@ -18,13 +51,29 @@ public:
 
   ~SubQueryExecutor() = default;
 
-  RC init() override;
+  // 把关联条件中外层查询的字段替换成left_tuple中对应的值，生成子查询的过滤条件
+  RC add_multi_table_filter(const Tuple &left_tuple, std::vector<Filter*> *filters);
 
-  RC add_multi_table_filter(const TupleField &field, TupleValue &value, std::vector<Filter*> *filters);
+  RC rewind() override;
 
-  RC remove_multi_table_filter(std::vector<Filter*> *filters, size_t num);
+protected:
+  RC do_init() override;
+  RC do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) override;
+  void describe(ExplainNode &node) override;
+  std::vector<Executor *> children() override;
 
-  RC next(TupleSet &tuple_set, std::vector<Filter*> *filters = nullptr) override;
+private:
+  RC check_right_schema();
+  // 对左侧的一批做子查询条件判断，满足条件的加入tuple_set
+  RC filter_left_batch(TupleSet &left_tuple_set, TupleSet &tuple_set, std::vector<Filter*> *filters);
+  bool match(const std::shared_ptr<TupleValue> &left_value, const SubQueryValueSet &value_set) const;
+  // 执行一次子查询，结果放到value_set中
+  RC evaluate(std::vector<Filter*> *filters, SubQueryValueSet &value_set);
+  // 关联子查询：把外层字段的值代入关联条件后执行，结果按这组值缓存
+  RC correlated_match(const Tuple &left_tuple, const std::shared_ptr<TupleValue> &left_value,
+                      std::vector<Filter*> *filters, bool &matched);
+  // 找出关联条件中外层查询的字段在左侧schema中的下标
+  void bind_correlated_fields(const TupleSchema &left_schema);
 
 private:
   Executor *left_executor_;
@@ -32,6 +81,20 @@ private:
   CompOp op_;
   Executor *right_executor_;
   std::vector<Condition> multi_table_conditions_;
+
+  int left_field_index_ = -1;
+  // 与multi_table_conditions_一一对应：外层字段在左侧schema中的下标，以及它在条件的左边还是右边
+  std::vector<int> correlated_index_;
+  std::vector<bool> correlated_on_left_;
+
+  // 非关联子查询只执行一次，结果缓存下来供后续各批以及rewind之后使用
+  bool right_loaded_ = false;
+  SubQueryValueSet right_value_set_;
+
+  // 关联子查询的结果只取决于代入关联条件的外层字段的值和上层的条件，
+  // 两次rewind之间上层的条件不变，相同的一组值只执行一次子查询
+  std::unordered_map<std::string, SubQueryValueSet> correlated_cache_;
+  size_t correlated_cache_values_ = 0;
 };
 
 
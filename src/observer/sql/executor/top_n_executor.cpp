@@ -0,0 +1,125 @@
+#include "top_n_executor.h"
+#include "util.h"
+
+TopNExecutor::TopNExecutor(ExecutorContext *context, const TupleSchema &output_schema, Executor *executor,
+                           const TupleSchema &order_by_schema, int limit)
+    : Executor(context, output_schema), executor_(executor), order_by_schema_(order_by_schema), limit_(limit) {}
+
+RC TopNExecutor::do_init() {
+  return executor_->init();
+}
+
+RC TopNExecutor::build(std::vector<Filter*> *filters) {
+  TupleSet child_tuple_set;
+  RC rc = executor_->next(child_tuple_set, filters);
+  if (rc != RC::SUCCESS && rc != RC::RECORD_EOF) {
+    return rc;
+  }
+  TupleSchema child_schema = child_tuple_set.get_schema().empty() ? executor_->output_schema()
+                                                                    : child_tuple_set.get_schema();
+  output_index_ = output_schema_.index_in(child_schema);
+  std::vector<int> order_index = order_by_schema_.index_in(child_schema);
+  std::vector<int> orders;
+  for (const TupleField &field : order_by_schema_.fields()) {
+    orders.push_back(field.order());
+  }
+
+  if (limit_ < 0) {
+    sorter_.reset(new ExternalSorter(order_index, orders, exe_ctx_->sort_buffer_size()));
+    while (rc == RC::SUCCESS) {
+      for (Tuple &tuple : child_tuple_set.tuples()) {
+        rc = sorter_->add(std::move(tuple));
+        if (rc != RC::SUCCESS) {
+          return rc;
+        }
+      }
+      rc = executor_->next(child_tuple_set, filters);
+    }
+    if (rc != RC::RECORD_EOF) {
+      return rc;
+    }
+    return sorter_->finish();
+  }
+
+  TupleTopN top_n(limit_, [&order_index, &orders](const Tuple &lhs, const Tuple &rhs) {
+    for (size_t i = 0; i < order_index.size(); i++) {
+      int ret = TupleSortUtil::compare_value(lhs.get_pointer(order_index[i]), rhs.get_pointer(order_index[i]));
+      if (ret != 0) {
+        // 0:ASC 1:DESC
+        return orders[i] == 0 ? ret < 0 : ret > 0;
+      }
+    }
+    return false;
+  });
+  while (rc == RC::SUCCESS) {
+    for (Tuple &tuple : child_tuple_set.tuples()) {
+      top_n.add(std::move(tuple));
+    }
+    rc = executor_->next(child_tuple_set, filters);
+  }
+  if (rc != RC::RECORD_EOF) {
+    return rc;
+  }
+  top_n.finish(sorted_tuples_);
+  output_pos_ = 0;
+  return RC::SUCCESS;
+}
+
+RC TopNExecutor::do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) {
+  tuple_set.clear();
+  tuple_set.set_schema(output_schema_);
+
+  if (!built_) {
+    RC rc = build(filters);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    built_ = true;
+  }
+
+  if (sorter_ != nullptr) {
+    Tuple tuple;
+    RC rc = RC::SUCCESS;
+    while (tuple_set.size() < BATCH_SIZE && (rc = sorter_->next(tuple)) == RC::SUCCESS) {
+      Tuple output_tuple;
+      output_tuple.add(tuple, output_index_);
+      tuple_set.add(std::move(output_tuple));
+    }
+    if (rc != RC::SUCCESS && rc != RC::RECORD_EOF) {
+      return rc;
+    }
+    return tuple_set.size() > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+  }
+
+  while (output_pos_ < (int)sorted_tuples_.size() && tuple_set.size() < BATCH_SIZE) {
+    const Tuple &tuple = sorted_tuples_[output_pos_++];
+    Tuple output_tuple;
+    output_tuple.add(tuple, output_index_);
+    tuple_set.add(std::move(output_tuple));
+  }
+  return tuple_set.size() > 0 ? RC::SUCCESS : RC::RECORD_EOF;
+}
+
+RC TopNExecutor::rewind() {
+  built_ = false;
+  sorted_tuples_.clear();
+  sorter_.reset();
+  return executor_->rewind();
+}
+
+void TopNExecutor::describe(ExplainNode &node) {
+  node.name = limit_ >= 0 ? "TopN" : "Sort";
+  for (const TupleField &field : order_by_schema_.fields()) {
+    if (!node.detail.empty()) {
+      node.detail += ", ";
+    }
+    node.detail += std::string(field.table_name()) + "." + field.field_name() + (field.order() ? " desc" : "");
+  }
+  if (limit_ >= 0) {
+    node.detail += " limit=" + std::to_string(limit_);
+  }
+}
+
+std::vector<Executor *> TopNExecutor::children() {
+  return {executor_};
+}
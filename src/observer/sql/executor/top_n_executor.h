@@ -0,0 +1,47 @@
+#ifndef MINIDB_TOP_N_EXECUTOR_H
+#define MINIDB_TOP_N_EXECUTOR_H
+
+#include <memory>
+
+#include "executor.h"
+#include "external_sort.h"
+
+/**
+ * order by [limit]：子节点输出完整的字段，按order by的字段排序后再投影到output_schema。
+ * 有limit时用大小为limit的堆只保留前limit条，不需要把全部结果排序；
+ * 没有limit时使用ExternalSorter，超过sort_buffer_size的部分写到临时文件再归并
+ */
+class TopNExecutor : public Executor {
+public:
+  TopNExecutor(ExecutorContext *context, const TupleSchema &output_schema, Executor *executor,
+               const TupleSchema &order_by_schema, int limit);
+
+  ~TopNExecutor() = default;
+
+  RC rewind() override;
+
+protected:
+  RC do_init() override;
+  /**
+   * 第一次调用时取出子节点的全部结果并排序，之后按批输出
+   */
+  RC do_next(TupleSet &tuple_set, std::vector<Filter*> *filters) override;
+  void describe(ExplainNode &node) override;
+  std::vector<Executor *> children() override;
+
+private:
+  // 取出子节点的全部结果并排序
+  RC build(std::vector<Filter*> *filters);
+
+private:
+  Executor *executor_;
+  TupleSchema order_by_schema_;
+  int limit_;  // 小于0表示没有limit
+  bool built_ = false;
+  std::vector<Tuple> sorted_tuples_;       // 有limit时的结果
+  std::unique_ptr<ExternalSorter> sorter_;  // 没有limit时的结果
+  std::vector<int> output_index_;  // 输出字段在子节点输出中的下标
+  int output_pos_ = 0;
+};
+
+#endif //MINIDB_TOP_N_EXECUTOR_H
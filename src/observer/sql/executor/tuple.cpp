@@ -1,6 +1,7 @@
 #include <algorithm>
 
 #include "sql/executor/tuple.h"
+#include "sql/executor/column_batch.h"
 #include "sql/executor/util.h"
 #include "storage/common/table.h"
 #include "common/log/log.h"
@@ -281,7 +282,10 @@ void TupleSet::print(std::ostream &os, bool multi_table) const {
   }
 
   schema_.print(os, multi_table);
+  print_tuples(os);
+}
 
+void TupleSet::print_tuples(std::ostream &os) const {
   for (const Tuple &item : tuples_) {
     const std::vector<std::shared_ptr<TupleValue>> &values = item.values();
     for (std::vector<std::shared_ptr<TupleValue>>::const_iterator iter = values.begin(), end = --values.end();
@@ -330,18 +334,101 @@ RC tuple_add_text_field(Table *table, Tuple &tuple, const char *record, const Fi
 }
 
 TupleRecordConverter::TupleRecordConverter(Table *table, TupleSet &tuple_set) :
-      table_(table), tuple_set_(tuple_set) { }
+      table_(table), tuple_set_(&tuple_set) {
+  init_fields(tuple_set.schema());
+}
 
-void TupleRecordConverter::add_record(const char *record) {
-  const TupleSchema *schema = &tuple_set_.schema();
-  Tuple tuple;
+TupleRecordConverter::TupleRecordConverter(Table *table, ColumnBatch &batch) :
+      table_(table), batch_(&batch) {
+  init_fields(batch.schema());
+}
+
+const char *const TupleRecordConverter::RID_PAGE_FIELD = "__rid_page";
+const char *const TupleRecordConverter::RID_SLOT_FIELD = "__rid_slot";
+
+bool TupleRecordConverter::is_rid_field(const char *field_name) {
+  return 0 == strcmp(field_name, RID_PAGE_FIELD) || 0 == strcmp(field_name, RID_SLOT_FIELD);
+}
+
+int TupleRecordConverter::rid_value(const RID *rid, int field_index) {
+  assert(rid != nullptr);
+  return field_index == RID_PAGE_INDEX ? rid->page_num : rid->slot_num;
+}
+
+void TupleRecordConverter::init_fields(const TupleSchema &schema) {
   const TableMeta &table_meta = table_->table_meta();
-  common::Bitmap null_bitmap((char *)record, align8(table_meta.field_num()));
-  for (const TupleField &field : schema->fields()) {
+  for (const TupleField &field : schema.fields()) {
+    if (is_rid_field(field.field_name())) {
+      field_metas_.push_back(nullptr);
+      field_indexes_.push_back(0 == strcmp(field.field_name(), RID_PAGE_FIELD) ? RID_PAGE_INDEX : RID_SLOT_INDEX);
+      continue;
+    }
     const FieldMeta *field_meta = table_meta.field(field.field_name());
     assert(field_meta != nullptr);
-    int index = table_meta.field_index(field.field_name());
-    if (null_bitmap.get_bit(index)) {
+    field_metas_.push_back(field_meta);
+    field_indexes_.push_back(table_meta.field_index(field.field_name()));
+  }
+}
+
+void TupleRecordConverter::add_record(const char *record, const RID *rid) {
+  if (batch_ != nullptr) {
+    add_to_batch(record, rid);
+  } else {
+    add_to_tuple_set(record, rid);
+  }
+}
+
+void TupleRecordConverter::add_to_batch(const char *record, const RID *rid) {
+  common::Bitmap null_bitmap((char *)record, align8(table_->table_meta().field_num()));
+  for (size_t i = 0; i < field_metas_.size(); i++) {
+    const FieldMeta *field_meta = field_metas_[i];
+    ColumnVector &column = batch_->column(i);
+    if (field_meta == nullptr) {
+      column.append_int(rid_value(rid, field_indexes_[i]));
+      continue;
+    }
+    if (null_bitmap.get_bit(field_indexes_[i])) {
+      column.append_null();
+      continue;
+    }
+    const char *data = record + field_meta->offset();
+    switch (field_meta->type()) {
+      case INTS:
+        column.append_int(*(int *)data);
+        break;
+      case FLOATS:
+        column.append_float(*(float *)data);
+        break;
+      case CHARS:
+      case DATES:
+        column.append_string(data, strnlen(data, field_meta->len()));
+        break;
+      case TEXTS: {
+        char s[4097] = {0};
+        PageNum page_num = *((PageNum *)data);
+        memcpy(s, data + PAGENUMSIZE, TEXTPATCHSIZE);
+        table_->read_text_record(s + TEXTPATCHSIZE, page_num);
+        column.append_string(s, strlen(s));
+      }
+        break;
+      default: {
+        LOG_PANIC("Unsupported field type. type=%d", field_meta->type());
+      }
+    }
+  }
+  batch_->finish_row();
+}
+
+void TupleRecordConverter::add_to_tuple_set(const char *record, const RID *rid) {
+  Tuple tuple;
+  common::Bitmap null_bitmap((char *)record, align8(table_->table_meta().field_num()));
+  for (size_t i = 0; i < field_metas_.size(); i++) {
+    const FieldMeta *field_meta = field_metas_[i];
+    if (field_meta == nullptr) {
+      tuple.add(rid_value(rid, field_indexes_[i]));
+      continue;
+    }
+    if (null_bitmap.get_bit(field_indexes_[i])) {
       tuple.add_null();
       continue;
     }
@@ -357,13 +444,15 @@ void TupleRecordConverter::add_record(const char *record) {
       }
         break;
       case CHARS: {
-        const char *s = record + field_meta->offset();  // 现在当做Cstring来处理
-        tuple.add(s, strlen(s));
+        // 占满字段长度的字符串后面没有'\0'
+        const char *s = record + field_meta->offset();
+        tuple.add(s, strnlen(s, field_meta->len()));
       }
       break;
       case DATES: {
-        const char *s = record + field_meta->offset();  // 现在当做Cstring来处理
-        tuple.add(s, strlen(s));
+        // 占满字段长度的字符串后面没有'\0'
+        const char *s = record + field_meta->offset();
+        tuple.add(s, strnlen(s, field_meta->len()));
       }
       break;
       case TEXTS: {
@@ -376,5 +465,5 @@ void TupleRecordConverter::add_record(const char *record) {
       }
     }
   }
-  tuple_set_.add(std::move(tuple));
+  tuple_set_->add(std::move(tuple));
 }
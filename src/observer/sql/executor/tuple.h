@@ -10,6 +10,9 @@
 
 class Table;
 class TupleSchema;
+class FieldMeta;
+class ColumnBatch;
+struct RID;
 
 struct AggreDesc {
   AggreType aggre_type;
@@ -195,6 +198,8 @@ public:
   std::vector<Tuple> &tuples();
 
   void print(std::ostream &os, bool multi_table = false) const;
+  // 只输出记录，不输出表头，用于分批输出结果
+  void print_tuples(std::ostream &os) const;
 public:
   const TupleSchema &schema() const {
     return schema_;
@@ -206,75 +211,38 @@ private:
 };
 
 
-// 将不同的 tuple 实现笛卡尔积
-class TupleSetDescartesIterator {
+// 将 record 转换成 tuple，或者直接解码到列存批次的各列中。
+// schema中可以包含RID_PAGE_FIELD和RID_SLOT_FIELD两个INTS字段，这时输出记录的rid，用于延迟物化
+class TupleRecordConverter {
 public:
-  explicit TupleSetDescartesIterator(std::vector<TupleSet> *tuple_sets): tuple_sets_(tuple_sets) {
-    for (const auto & tuple_set : *tuple_sets) {
-      if (tuple_set.size() == 0) {
-        end = true;
-      }
-      sizes_.push_back(tuple_set.size());
-      indexes_.push_back(0);
-    }
-  }
+  TupleRecordConverter(Table *table, TupleSet &tuple_set);
+  TupleRecordConverter(Table *table, ColumnBatch &batch);
 
-  ~TupleSetDescartesIterator() {
-    std::vector<int> tmp;
-    sizes_.swap(tmp);
-    std::vector<int> tmp2;
-    sizes_.swap(tmp2);
-    // 迭代器并不拥有tuple_sets_
-  }
+  // schema中有rid字段时rid不能为nullptr
+  void add_record(const char *record, const RID *rid = nullptr);
 
-  std::unique_ptr<std::vector<Tuple>> operator *() {
-    auto tuple_result = std::make_unique<std::vector<Tuple>>();
-    int value_index;
-    for (int table_index = 0; table_index < indexes_.size(); ++table_index) {
-      value_index = indexes_[table_index];
-      if (value_index < sizes_[table_index]) {
-        TupleSet &tuple_set = (*tuple_sets_)[table_index];
-        tuple_result->push_back(tuple_set.get(value_index));
-      }
-    }
-    return tuple_result;
-  }
+  static bool is_rid_field(const char *field_name);
 
-  void operator ++() {
-    int i = indexes_.size() - 1;
-    while(i >= 0) {
-      if (indexes_[i] < sizes_[i] - 1) {
-        indexes_[i]++;
-        return;
-      } else {
-        indexes_[i] = 0;
-        i--;
-      }
-    }
-    end = true;
-  }
-
-  bool End() {
-    return end;
-  }
+public:
+  static const char *const RID_PAGE_FIELD;
+  static const char *const RID_SLOT_FIELD;
 
 private:
-  std::vector<int> sizes_;
-  std::vector<int> indexes_;
-  std::vector<TupleSet> *tuple_sets_;
-  bool end = false;
-};
-
-// 将 record 转换成 tuple
-class TupleRecordConverter {
-public:
-  TupleRecordConverter(Table *table, TupleSet &tuple_set);
+  void init_fields(const TupleSchema &schema);
+  void add_to_tuple_set(const char *record, const RID *rid);
+  void add_to_batch(const char *record, const RID *rid);
+  // rid字段在field_metas_中为nullptr，field_indexes_中分别为RID_PAGE_INDEX和RID_SLOT_INDEX
+  static int rid_value(const RID *rid, int field_index);
 
-  void add_record(const char *record);
+  enum { RID_PAGE_INDEX = -1, RID_SLOT_INDEX = -2 };
 
 private:
   Table *table_;
-  TupleSet &tuple_set_;
+  TupleSet *tuple_set_ = nullptr;
+  ColumnBatch *batch_ = nullptr;
+  // schema中每个字段对应的FieldMeta和在表中的下标，构造时解析一次
+  std::vector<const FieldMeta *> field_metas_;
+  std::vector<int> field_indexes_;
 };
 
 #endif //__OBSERVER_SQL_EXECUTOR_TUPLE_H_
@@ -1,9 +1,88 @@
 #include "sql/executor/util.h"
+#include <string.h>
 #include <sstream>
+#include <algorithm>
 
 const std::map<std::string, std::map<std::string, int>> *TupleSortUtil::field_index_ = nullptr;
 const TupleSchema *TupleSortUtil::order_by_schema_ = nullptr;
 
+uint32_t TupleSortUtil::float_order_bits(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+int TupleSortUtil::compare_value(const std::shared_ptr<TupleValue> &lhs, const std::shared_ptr<TupleValue> &rhs) {
+  const bool lhs_null = lhs->Type() == UNDEFINED;
+  const bool rhs_null = rhs->Type() == UNDEFINED;
+  if (lhs_null || rhs_null) {
+    return lhs_null == rhs_null ? 0 : (lhs_null ? -1 : 1);
+  }
+  if (lhs->Type() == INTS && rhs->Type() == INTS) {
+    int lhs_value = *(int *)lhs->value_pointer();
+    int rhs_value = *(int *)rhs->value_pointer();
+    return (lhs_value > rhs_value) - (lhs_value < rhs_value);
+  }
+  if ((lhs->Type() == INTS || lhs->Type() == FLOATS) && (rhs->Type() == INTS || rhs->Type() == FLOATS)) {
+    uint32_t lhs_bits = float_order_bits(lhs->value());
+    uint32_t rhs_bits = float_order_bits(rhs->value());
+    return (lhs_bits > rhs_bits) - (lhs_bits < rhs_bits);
+  }
+  return strcmp(((std::string *)lhs->value_pointer())->c_str(), ((std::string *)rhs->value_pointer())->c_str());
+}
+
+TupleTopN::TupleTopN(int limit, std::function<bool(const Tuple &, const Tuple &)> less)
+    : limit_(limit), less_(std::move(less)) {}
+
+bool TupleTopN::entry_less(const Entry &lhs, const Entry &rhs) const {
+  if (less_(lhs.tuple, rhs.tuple)) {
+    return true;
+  }
+  if (less_(rhs.tuple, lhs.tuple)) {
+    return false;
+  }
+  return lhs.seq < rhs.seq;
+}
+
+void TupleTopN::add(Tuple &&tuple) {
+  auto cmp = [this](const Entry &lhs, const Entry &rhs) { return entry_less(lhs, rhs); };
+  if (limit_ < 0) {
+    heap_.push_back(Entry{std::move(tuple), seq_++});
+    return;
+  }
+  if (limit_ == 0) {
+    return;
+  }
+  if ((int)heap_.size() < limit_) {
+    heap_.push_back(Entry{std::move(tuple), seq_++});
+    std::push_heap(heap_.begin(), heap_.end(), cmp);
+    return;
+  }
+  // 堆已满，只有比堆顶小的tuple才替换堆顶
+  if (!less_(tuple, heap_.front().tuple)) {
+    seq_++;
+    return;
+  }
+  std::pop_heap(heap_.begin(), heap_.end(), cmp);
+  heap_.back() = Entry{std::move(tuple), seq_++};
+  std::push_heap(heap_.begin(), heap_.end(), cmp);
+}
+
+void TupleTopN::finish(std::vector<Tuple> &tuples) {
+  auto cmp = [this](const Entry &lhs, const Entry &rhs) { return entry_less(lhs, rhs); };
+  if (limit_ < 0) {
+    std::sort(heap_.begin(), heap_.end(), cmp);
+  } else {
+    std::sort_heap(heap_.begin(), heap_.end(), cmp);
+  }
+  tuples.clear();
+  tuples.reserve(heap_.size());
+  for (Entry &entry : heap_) {
+    tuples.push_back(std::move(entry.tuple));
+  }
+  heap_.clear();
+}
+
 // tuple计算expression应该一定是正确的，condition计算expresion有可能错，此时相当于一条false条件
 RC AstUtil::Calculate(std::shared_ptr<TupleValue> &value, const Tuple &tuple, const std::map<std::string, std::map<std::string, int>> &field_index, ast *a) {
     if (a == nullptr) {
@@ -1,3 +1,5 @@
+#include <stdint.h>
+#include <functional>
 #include <map>
 #include <string>
 #include "sql/executor/tuple.h"
@@ -5,12 +7,20 @@
 
 class TupleSortUtil {
 public:
+  /**
+   * ORDER BY 中两个值的顺序，与ExternalSorter编码的key一致：null排在最前，
+   * 数值按大小比较且不带误差(否则不满足传递性)，字符串按strcmp比较
+   */
+  static int compare_value(const std::shared_ptr<TupleValue> &lhs, const std::shared_ptr<TupleValue> &rhs);
+  // 浮点数映射成按无符号整数比较时顺序不变的值：正数翻转符号位，负数所有位取反
+  static uint32_t float_order_bits(float value);
+
   static bool cmp(const Tuple &lhs, const Tuple &rhs) {
     int ret = 0;
     for (const TupleField &field : order_by_schema_->fields()) {
       // const map无法用下标取值
       int index = field_index_->at(field.table_name()).at(field.field_name());
-      ret = lhs.get_pointer(index)->compare(*(rhs.get_pointer(index)));
+      ret = compare_value(lhs.get_pointer(index), rhs.get_pointer(index));
       if (ret != 0) {
         if (field.order() == 0) {
           // ASC
@@ -34,6 +44,33 @@ private:
   static const TupleSchema *order_by_schema_;
 };
 
+/**
+ * ORDER BY ... LIMIT n：用大小为n的堆保留最小的n个tuple，不需要对全部输入排序。
+ * less相等的tuple按加入的顺序输出，结果与对全部输入做稳定排序后取前n个相同。
+ * limit小于0时保留全部tuple，finish时排序
+ */
+class TupleTopN {
+public:
+  TupleTopN(int limit, std::function<bool(const Tuple &, const Tuple &)> less);
+
+  void add(Tuple &&tuple);
+  // 按顺序取出结果
+  void finish(std::vector<Tuple> &tuples);
+
+private:
+  struct Entry {
+    Tuple tuple;
+    long seq;  // 加入的顺序
+  };
+  bool entry_less(const Entry &lhs, const Entry &rhs) const;
+
+private:
+  int limit_;
+  std::function<bool(const Tuple &, const Tuple &)> less_;
+  std::vector<Entry> heap_;  // 大顶堆，堆顶是目前保留的最大的tuple
+  long seq_ = 0;
+};
+
 class AstUtil {
 public:
 	/**
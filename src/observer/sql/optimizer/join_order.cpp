@@ -0,0 +1,272 @@
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+#include "sql/optimizer/join_order.h"
+#include "storage/common/db.h"
+#include "storage/common/table.h"
+#include "common/log/log.h"
+
+int JoinOrderOptimizer::add_table(double rows) {
+  rows_.push_back(rows);
+  return rows_.size() - 1;
+}
+
+void JoinOrderOptimizer::add_edge(int left, int right, double selectivity) {
+  if (left != right) {
+    edges_.push_back(Edge{left, right, selectivity});
+  }
+}
+
+double JoinOrderOptimizer::join_rows(double rows, const std::vector<bool> &joined, int table) const {
+  rows *= rows_[table];
+  for (const Edge &edge : edges_) {
+    if ((edge.left == table && joined[edge.right]) || (edge.right == table && joined[edge.left])) {
+      rows *= edge.selectivity;
+    }
+  }
+  return rows;
+}
+
+double JoinOrderOptimizer::estimate_rows(const std::vector<int> &order, int count) const {
+  std::vector<bool> joined(rows_.size(), false);
+  double rows = 1;
+  for (int i = 0; i < count; i++) {
+    rows = join_rows(rows, joined, order[i]);
+    joined[order[i]] = true;
+  }
+  return rows;
+}
+
+std::vector<int> JoinOrderOptimizer::optimize() const {
+  if (rows_.size() <= 1) {
+    return std::vector<int>(rows_.size(), 0);
+  }
+  if (rows_.size() <= MAX_DP_TABLES) {
+    return optimize_dp();
+  }
+  return optimize_greedy();
+}
+
+// rows[S]：集合S中的表连接之后的行数，与连接顺序无关
+// cost[S]：连接S中的表的最小代价，即最后一步之前各个中间结果的行数之和加上rows[S]
+std::vector<int> JoinOrderOptimizer::optimize_dp() const {
+  const int n = rows_.size();
+  const unsigned full = (1u << n) - 1;
+  std::vector<std::vector<double>> selectivity(n, std::vector<double>(n, 1));
+  for (const Edge &edge : edges_) {
+    selectivity[edge.left][edge.right] *= edge.selectivity;
+    selectivity[edge.right][edge.left] *= edge.selectivity;
+  }
+
+  std::vector<double> rows(full + 1, 1);
+  std::vector<double> cost(full + 1, 0);
+  std::vector<int> last(full + 1, -1);  // S的最优顺序中最后连接的表
+  for (unsigned set = 1; set <= full; set++) {
+    int table = __builtin_ctz(set);
+    unsigned rest = set & (set - 1);
+    double set_rows = rows[rest] * rows_[table];
+    for (int other = 0; other < n; other++) {
+      if (rest & (1u << other)) {
+        set_rows *= selectivity[table][other];
+      }
+    }
+    rows[set] = set_rows;
+    if (rest == 0) {
+      last[set] = table;
+      continue;
+    }
+
+    // 代价相同时取编号最大的表作为最后一张，保持加入的顺序
+    double best = -1;
+    for (int t = 0; t < n; t++) {
+      if ((set & (1u << t)) == 0) {
+        continue;
+      }
+      double sub_cost = cost[set & ~(1u << t)];
+      if (best < 0 || sub_cost <= best) {
+        best = sub_cost;
+        last[set] = t;
+      }
+    }
+    cost[set] = best + set_rows;
+  }
+
+  std::vector<int> order(n);
+  unsigned set = full;
+  for (int i = n - 1; i >= 0; i--) {
+    order[i] = last[set];
+    set &= ~(1u << order[i]);
+  }
+  return order;
+}
+
+std::vector<int> JoinOrderOptimizer::optimize_greedy() const {
+  const int n = rows_.size();
+  std::vector<bool> joined(n, false);
+  std::vector<int> order;
+  double rows = 1;
+  for (int i = 0; i < n; i++) {
+    int best_table = -1;
+    double best_rows = 0;
+    for (int t = 0; t < n; t++) {
+      if (joined[t]) {
+        continue;
+      }
+      double t_rows = join_rows(rows, joined, t);
+      if (best_table < 0 || t_rows < best_rows) {
+        best_table = t;
+        best_rows = t_rows;
+      }
+    }
+    order.push_back(best_table);
+    joined[best_table] = true;
+    rows = best_rows;
+  }
+  return order;
+}
+
+static const double EQUAL_SELECTIVITY = 0.1;
+static const double RANGE_SELECTIVITY = 0.33;
+
+// 交换比较的两侧之后的比较符，如 1 < t.a 等价于 t.a > 1
+static CompOp swap_comp_op(CompOp op) {
+  switch (op) {
+    case LESS_THAN:
+      return GREAT_THAN;
+    case LESS_EQUAL:
+      return GREAT_EQUAL;
+    case GREAT_THAN:
+      return LESS_THAN;
+    case GREAT_EQUAL:
+      return LESS_EQUAL;
+    default:
+      return op;
+  }
+}
+
+static const ColumnStats *column_stats(Table *table, const RelAttr &attr) {
+  const TableStats &stats = table->table_meta().stats();
+  return stats.analyzed ? stats.column(attr.attribute_name) : nullptr;
+}
+
+static bool simple_condition(const Condition &condition) {
+  return !condition.left_is_select && !condition.right_is_select &&
+         condition.left_ast == nullptr && condition.right_ast == nullptr;
+}
+
+void optimize_join_order(Db *db, Selects *selects) {
+  selects->join_order_num = 0;
+  for (size_t i = 0; i < selects->condition_num; i++) {
+    Condition &condition = selects->conditions[i];
+    if (condition.left_is_select) {
+      optimize_join_order(db, condition.left_selects);
+    }
+    if (condition.right_is_select) {
+      optimize_join_order(db, condition.right_selects);
+    }
+  }
+
+  const int table_num = selects->relation_num;
+  if (db == nullptr || table_num < 2) {
+    return;
+  }
+  // relations中的表与FROM中的顺序相反，优化器中的表按FROM中的顺序编号
+  auto relation_of = [table_num](int table) { return table_num - 1 - table; };
+  std::vector<Table *> tables;
+  std::vector<double> base_rows;
+  for (int i = 0; i < table_num; i++) {
+    Table *table = db->find_table(selects->relations[relation_of(i)]);
+    if (table == nullptr) {
+      return;
+    }
+    tables.push_back(table);
+    base_rows.push_back(std::max(1, table->estimate_record_count()));
+  }
+  // 属性所属的表，-1表示没有写表名
+  auto table_of = [&](const RelAttr &attr) {
+    if (attr.relation_name == nullptr) {
+      return -1;
+    }
+    for (int i = 0; i < table_num; i++) {
+      if (0 == strcmp(attr.relation_name, selects->relations[relation_of(i)])) {
+        return i;
+      }
+    }
+    return -2;
+  };
+
+  std::vector<double> rows = base_rows;
+  struct JoinEdge {
+    int left;
+    int right;
+    double selectivity;
+  };
+  std::vector<JoinEdge> edges;
+  for (size_t i = 0; i < selects->condition_num; i++) {
+    const Condition &condition = selects->conditions[i];
+    if (!simple_condition(condition) || (!condition.left_is_attr && !condition.right_is_attr)) {
+      continue;
+    }
+    int left = condition.left_is_attr ? table_of(condition.left_attr) : -1;
+    int right = condition.right_is_attr ? table_of(condition.right_attr) : -1;
+    if (left == -2 || right == -2) {
+      return;
+    }
+    double selectivity = condition.comp == EQUAL_TO ? EQUAL_SELECTIVITY : RANGE_SELECTIVITY;
+    if (condition.left_is_attr && condition.right_is_attr) {
+      if (left < 0 || right < 0) {
+        continue;
+      }
+      if (left != right) {
+        if (condition.comp == EQUAL_TO) {
+          // 有统计信息时按两侧不同值个数中较大的一个估计
+          const ColumnStats *left_stats = column_stats(tables[left], condition.left_attr);
+          const ColumnStats *right_stats = column_stats(tables[right], condition.right_attr);
+          if (left_stats != nullptr && right_stats != nullptr) {
+            selectivity = (1 - left_stats->null_fraction) * (1 - right_stats->null_fraction) /
+                          std::max(1.0, std::max(left_stats->ndv, right_stats->ndv));
+          } else {
+            selectivity = 1 / std::max(base_rows[left], base_rows[right]);
+          }
+        }
+        edges.push_back(JoinEdge{left, right, selectivity});
+        continue;
+      }
+    }
+    int table = condition.left_is_attr ? left : right;
+    if (table < 0) {
+      continue;
+    }
+    if (condition.left_is_attr != condition.right_is_attr) {
+      const RelAttr &attr = condition.left_is_attr ? condition.left_attr : condition.right_attr;
+      const Value &value = condition.left_is_attr ? condition.right_value : condition.left_value;
+      const CompOp op = condition.left_is_attr ? condition.comp : swap_comp_op(condition.comp);
+      const ColumnStats *stats = column_stats(tables[table], attr);
+      double key = 0;
+      if (stats != nullptr && stats_key(stats->type, value, key)) {
+        double stats_selectivity = stats->selectivity(op, key);
+        if (stats_selectivity >= 0) {
+          selectivity = stats_selectivity;
+        }
+      }
+    }
+    rows[table] *= selectivity;
+  }
+
+  JoinOrderOptimizer optimizer;
+  for (int i = 0; i < table_num; i++) {
+    optimizer.add_table(std::max(rows[i], 1.0));
+  }
+  for (const JoinEdge &edge : edges) {
+    optimizer.add_edge(edge.left, edge.right, edge.selectivity);
+  }
+  std::vector<int> order = optimizer.optimize();
+  std::string order_str;
+  for (int i = 0; i < table_num; i++) {
+    selects->join_order[i] = relation_of(order[i]);
+    order_str += std::string(i == 0 ? "" : ",") + selects->relations[relation_of(order[i])];
+  }
+  selects->join_order_num = table_num;
+  LOG_DEBUG("Join order: %s. estimated rows=%.0f", order_str.c_str(), optimizer.estimate_rows(order, table_num));
+}
@@ -0,0 +1,57 @@
+#ifndef __OBSERVER_SQL_OPTIMIZER_JOIN_ORDER_H__
+#define __OBSERVER_SQL_OPTIMIZER_JOIN_ORDER_H__
+
+#include <vector>
+
+#include "sql/parser/parse_defs.h"
+
+class Db;
+
+/**
+ * 多表连接的顺序。
+ * 表是连接图的顶点，两张表的属性之间的比较条件是边。
+ * 用动态规划在所有左深树中选出中间结果行数之和最小(C_out)的顺序，
+ * 没有连接条件的两张表只能做笛卡尔积，中间结果很大，自然会排在后面。
+ * 表太多时改为贪心：每次加入使中间结果最小的表
+ */
+class JoinOrderOptimizer {
+public:
+  enum { MAX_DP_TABLES = 12 };
+
+  // 加入一张表，rows为本表过滤之后估计的行数，返回表的编号
+  int add_table(double rows);
+  // 两张表之间的连接条件，selectivity为满足条件的组合占笛卡尔积的比例
+  void add_edge(int left, int right, double selectivity);
+
+  // 返回表的编号的连接顺序。代价相同时保持加入的顺序
+  std::vector<int> optimize() const;
+
+  // 估计连接了order中前count张表之后的行数
+  double estimate_rows(const std::vector<int> &order, int count) const;
+
+private:
+  std::vector<int> optimize_dp() const;
+  std::vector<int> optimize_greedy() const;
+  // 在rows个行的中间结果上再连接table之后的行数，joined[i]表示第i张表已经连接
+  double join_rows(double rows, const std::vector<bool> &joined, int table) const;
+
+private:
+  struct Edge {
+    int left;
+    int right;
+    double selectivity;
+  };
+  std::vector<double> rows_;
+  std::vector<Edge> edges_;
+};
+
+/**
+ * 为查询(以及where中的子查询)FROM中的多张表选出连接顺序，记录到selects->join_order。
+ * 表的行数按记录数和只涉及这张表的条件估计。表收集过统计信息(ANALYZE TABLE)时，
+ * 与常量比较的选择率按直方图估计，等值连接按两侧的不同值个数估计；
+ * 否则与常量等值比较的选择率按1/10，其它比较按1/3，等值连接假设连接属性在较大的一侧上是唯一的。
+ * 条件中有不存在的表或者无法确定所属表的属性时不做调整，由执行时报错
+ */
+void optimize_join_order(Db *db, Selects *selects);
+
+#endif  // __OBSERVER_SQL_OPTIMIZER_JOIN_ORDER_H__
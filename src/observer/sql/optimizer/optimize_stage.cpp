@@ -2,12 +2,18 @@
 #include <string>
 
 #include "optimize_stage.h"
+#include "join_order.h"
 
 #include "common/conf/ini.h"
 #include "common/io/io.h"
 #include "common/lang/string.h"
 #include "common/log/log.h"
 #include "common/seda/timer_stage.h"
+#include "event/execution_plan_event.h"
+#include "event/sql_event.h"
+#include "event/session_event.h"
+#include "session/session.h"
+#include "storage/default/default_handler.h"
 
 using namespace common;
 
@@ -62,7 +68,15 @@ void OptimizeStage::cleanup() {
 void OptimizeStage::handle_event(StageEvent *event) {
   LOG_TRACE("Enter\n");
 
-  // optimize sql plan, here just pass the event to the next stage
+  // 多表查询选出连接顺序，执行时按这个顺序连接
+  ExecutionPlanEvent *exe_event = static_cast<ExecutionPlanEvent *>(event);
+  Query *sql = exe_event->sqls();
+  if (sql->flag == SCF_SELECT) {
+    Session *session = exe_event->sql_event()->session_event()->get_client()->session;
+    Db *db = DefaultHandler::get_default().find_db(session->get_current_db().c_str());
+    optimize_join_order(db, &sql->sstr.selection);
+  }
+
   execute_stage->handle_event(event);
 
   LOG_TRACE("Exit\n");
@@ -350,8 +350,8 @@ static void yynoreturn yy_fatal_error ( const char* msg , yyscan_t yyscanner );
 	yyg->yy_hold_char = *yy_cp; \
 	*yy_cp = '\0'; \
 	yyg->yy_c_buf_p = yy_cp;
-#define YY_NUM_RULES 72
-#define YY_END_OF_BUFFER 73
+#define YY_NUM_RULES 77
+#define YY_END_OF_BUFFER 78
 /* This struct is not used in this scanner,
    but its presence is necessary. */
 struct yy_trans_info
@@ -359,31 +359,33 @@ struct yy_trans_info
 	flex_int32_t yy_verify;
 	flex_int32_t yy_nxt;
 	};
-static const flex_int16_t yy_accept[204] =
+static const flex_int16_t yy_accept[225] =
     {   0,
-        0,    0,    0,    0,   73,   71,    1,    2,   71,   58,
-       59,    7,   60,   63,   61,    6,   62,    3,    5,   67,
-       64,   69,   57,   57,   57,   57,   57,   57,   57,   57,
-       57,   57,   57,   57,   57,   57,   57,   57,   57,   57,
-       57,   57,   57,   72,    0,   70,    0,    3,   65,   66,
-       68,   57,   57,   57,   57,   57,   57,   54,   57,   57,
-       57,   57,   57,   57,   57,   57,   57,   57,   57,   25,
-       52,   57,   57,   57,   57,   57,   57,   17,   57,   57,
-       57,   57,   57,   57,   57,   57,   57,   57,   57,   57,
-        4,   26,   55,   46,   57,   57,   57,   57,   57,   57,
-
-       57,   57,   57,   57,   57,   57,   57,   57,   57,   57,
-       57,   57,   36,   57,   57,   44,   45,   49,   57,   57,
-       57,   57,   32,   57,   47,   57,   57,   57,   57,   57,
-       57,   57,   57,   37,   57,   57,   57,   42,   39,   57,
-       10,   12,    8,   57,   21,   57,    9,   57,   57,   57,
-       57,   28,   24,   41,   50,   57,   57,   57,   18,   19,
-       57,   40,   57,   57,   57,   57,   33,   57,   48,   57,
-       57,   38,   56,   16,   57,   23,   57,   57,   53,   57,
-       57,   13,   57,   57,   57,   22,   34,   11,   30,   43,
-       27,   57,   57,   20,   14,   15,   31,   29,   57,   57,
-
-       51,   35,    0
+        0,    0,    0,    0,   78,   76,    1,    2,   76,   63,
+       64,    7,   65,   68,   66,    6,   67,    3,    5,   72,
+       69,   74,   62,   62,   62,   62,   62,   62,   62,   62,
+       62,   62,   62,   62,   62,   62,   62,   62,   62,   62,
+       62,   62,   62,   77,    0,   75,    0,    3,   70,   71,
+       73,   62,   62,   62,   62,   62,   62,   54,   62,   62,
+       62,   62,   62,   62,   62,   62,   62,   62,   62,   62,
+       25,   52,   62,   62,   62,   62,   62,   62,   62,   17,
+       62,   62,   62,   62,   62,   62,   62,   62,   62,   62,
+       62,   62,   62,    4,   62,   26,   55,   46,   62,   62,
+
+       62,   62,   62,   62,   62,   62,   62,   62,   62,   62,
+       62,   62,   62,   62,   62,   62,   62,   62,   36,   62,
+       62,   62,   44,   45,   49,   62,   62,   62,   62,   32,
+       62,   47,   62,   62,   62,   62,   62,   62,   62,   62,
+       62,   62,   37,   62,   62,   62,   42,   39,   62,   10,
+       12,    8,   62,   62,   21,   62,   58,    9,   62,   62,
+       62,   62,   28,   24,   62,   41,   50,   62,   62,   62,
+       18,   19,   62,   40,   62,   62,   62,   62,   62,   62,
+       33,   62,   48,   62,   62,   62,   38,   56,   16,   62,
+       23,   62,   59,   62,   53,   62,   62,   13,   62,   62,
+
+       57,   62,   22,   62,   34,   11,   30,   62,   43,   27,
+       62,   62,   20,   14,   15,   31,   29,   60,   61,   62,
+       62,   51,   35,    0
     } ;
 
 static const YY_CHAR yy_ec[256] =
@@ -397,7 +399,7 @@ static const YY_CHAR yy_ec[256] =
        17,   18,    1,    1,   19,   20,   21,   22,   23,   24,
        25,   26,   27,   28,   29,   30,   31,   32,   33,   34,
        35,   36,   37,   38,   39,   40,   41,   42,   43,   44,
-        1,    1,    1,    1,   44,    1,   19,   20,   21,   22,
+        1,    1,    1,    1,   45,    1,   19,   20,   21,   22,
 
        23,   24,   25,   26,   27,   28,   29,   30,   31,   32,
        33,   34,   35,   36,   37,   38,   39,   40,   41,   42,
@@ -418,169 +420,175 @@ static const YY_CHAR yy_ec[256] =
         1,    1,    1,    1,    1
     } ;
 
-static const YY_CHAR yy_meta[45] =
+static const YY_CHAR yy_meta[46] =
     {   0,
-        1,    1,    1,    2,    2,    1,    1,    1,    1,    1,
-        2,    2,    2,    3,    1,    1,    1,    1,    3,    3,
-        3,    3,    3,    3,    3,    3,    3,    3,    3,    3,
-        3,    3,    3,    3,    3,    3,    3,    3,    3,    3,
-        3,    3,    3,    3
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1
     } ;
 
-static const flex_int16_t yy_base[208] =
+static const flex_int16_t yy_base[225] =
     {   0,
-        0,    0,    0,    0,  382,  383,  383,  383,  376,  383,
-      383,  383,  383,  383,  383,  383,  383,   33,  383,   31,
-      383,  363,   32,   36,   37,   38,   39,   41,   40,   42,
-       46,   52,  365,   53,   61,   54,   68,   70,   75,   76,
-       77,   78,   80,  383,  373,  372,  362,   93,  383,  383,
-      383,    0,  361,   88,   94,   98,   99,  360,  102,  103,
-      105,   82,  108,  111,  112,  113,  115,  116,  117,  119,
-      359,  123,  121,  118,  122,  138,  139,  358,  141,  144,
-      145,  147,  148,  150,  151,  152,  154,  156,  158,  163,
-      357,  356,  355,  354,  170,  153,  159,  171,  173,  177,
-
-      179,  184,  181,  185,  187,  190,  193,  194,  195,  197,
-      196,  199,  198,  202,  203,  353,  352,  351,  200,  206,
-      212,  213,  350,  219,  349,  223,  221,  224,  226,  227,
-      225,  229,  231,  348,  239,  233,  234,  347,  346,  235,
-      345,  344,  343,  236,  342,  241,  341,  238,  240,  242,
-      243,  340,  339,  338,  262,  253,  263,  270,  337,  336,
-      245,  335,  255,  244,  272,  273,  334,  271,  333,  274,
-      276,  332,  331,  330,  278,  329,  279,  284,  328,  286,
-      288,  292,  289,  293,  294,  327,  326,  325,  324,  323,
-      314,  297,  299,  311,  310,  309,  308,  307,  296,  301,
-
-      304,  300,  383,  331,  333,   59,   55
+        0,    0,   45,    0,   91,  394,  394,  394,   92,  394,
+      394,  394,  394,  394,  394,  394,  394,   95,  394,  138,
+      394,   93,  139,  162,  164,  170,  168,  110,   58,  169,
+      110,   66,   56,  116,  176,  112,  112,   68,  175,  185,
+      183,   83,  115,  394,    0,    0,  209,    0,  394,  394,
+      394,  205,    0,  135,  165,  171,  191,    0,  200,  220,
+      198,  184,  223,  219,  227,  222,  223,  224,  221,  232,
+      241,    0,  237,  235,  248,  226,  237,  232,  241,    0,
+      250,  244,  245,  243,  246,  248,  261,  240,  257,  263,
+      259,  257,  265,    0,  259,    0,    0,    0,  263,  255,
+
+      261,  261,  275,  276,  273,  276,  264,  262,  271,  283,
+      272,  265,  279,  272,  284,  281,  286,  287,  278,  280,
+      286,  292,    0,    0,    0,  285,  293,  287,  295,    0,
+      278,    0,  299,  291,  284,  288,  305,  293,  287,  291,
+      285,  297,    0,  303,  293,  294,    0,    0,  295,    0,
+        0,    0,  315,  297,    0,  302,    0,    0,  295,  308,
+      303,  304,    0,    0,  303,    0,  323,  307,  324,  324,
+        0,    0,  323,    0,  308,  310,  324,  327,  328,  308,
+        0,  315,    0,  331,  332,  329,    0,    0,    0,  334,
+        0,  320,    0,  339,    0,  341,  323,  325,  340,  341,
+
+        0,  328,    0,  343,    0,    0,    0,  335,    0,    0,
+      338,  348,    0,    0,    0,    0,    0,    0,    0,  347,
+      342,    0,    0,  394
     } ;
 
-static const flex_int16_t yy_def[208] =
+static const flex_int16_t yy_def[225] =
     {   0,
-      203,    1,  204,  204,  203,  203,  203,  203,  205,  203,
-      203,  203,  203,  203,  203,  203,  203,  203,  203,  203,
-      203,  203,  206,  206,  206,  206,  206,  206,  206,  206,
-      206,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-      206,  206,  206,  203,  205,  205,  203,  203,  203,  203,
-      203,  207,  206,  206,  206,  206,  206,  206,  206,  206,
-      206,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-      206,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-      206,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-      203,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-
-      206,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-      206,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-      206,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-      206,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-      206,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-      206,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-      206,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-      206,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-      206,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-      206,  206,  206,  206,  206,  206,  206,  206,  206,  206,
-
-      206,  206,    0,  203,  203,  203,  203
+      224,    1,    1,    3,  224,  224,  224,  224,  224,  224,
+      224,  224,  224,  224,  224,  224,  224,  224,  224,  224,
+      224,  224,  224,   23,   24,   24,   24,   27,   27,   24,
+       23,   27,   27,   32,   33,   32,   29,   32,   24,   30,
+       31,   33,   33,  224,    9,    9,  224,   18,  224,  224,
+      224,   23,   33,   33,   33,   33,   33,   33,   33,   33,
+       33,   33,   33,   32,   33,   32,   32,   32,   33,   33,
+       31,   33,   33,   33,   33,   27,   33,   33,   33,   33,
+       33,   33,   33,   32,   33,   33,   33,   27,   33,   33,
+       33,   33,   33,   47,   33,   33,   33,   33,   33,   29,
+
+       33,   33,   33,   30,   33,   33,   33,   33,   33,   33,
+       33,   33,   33,   33,   33,   33,   33,   33,   32,   33,
+       33,   33,   33,   33,   33,   33,   33,   33,   33,   33,
+       33,   33,   33,   33,   33,   33,   33,   33,   33,   29,
+       33,   33,   33,   33,   33,   33,   33,   33,   33,   33,
+       33,   33,   33,   33,   33,   33,   33,   33,   27,   33,
+       29,   29,   33,   33,   33,   33,   33,   29,   33,   33,
+       33,   33,   33,   33,   33,   33,   33,   33,   33,   33,
+       33,   33,   33,   33,   33,   33,   33,   33,   33,   33,
+       33,   33,   33,   33,   33,   33,   33,   33,   33,   33,
+
+       33,   33,   33,   33,   33,   33,   33,   33,   33,   33,
+       33,   33,   33,   33,   33,   33,   33,   33,   33,   33,
+       33,   33,   33,    0
     } ;
 
-static const flex_int16_t yy_nxt[428] =
+static const flex_int16_t yy_nxt[440] =
     {   0,
         6,    7,    8,    7,    9,   10,   11,   12,   13,   14,
        15,   16,   17,   18,   19,   20,   21,   22,   23,   24,
        25,   26,   27,   28,   29,   30,   31,   32,   33,   34,
        35,   36,   37,   33,   33,   38,   39,   40,   41,   42,
-       43,   33,   33,   33,   47,   52,   48,   49,   50,   52,
-       52,   52,   52,   52,   52,   52,   62,   52,   57,   52,
-       63,   53,   59,   54,   69,   52,   52,   52,   55,   60,
-       66,   56,   61,   64,   52,   68,   67,   70,   58,   74,
-       65,   52,   71,   52,   72,   73,   76,   75,   52,   52,
-       52,   52,   77,   52,   85,   52,   89,   81,   86,   78,
-
-       82,   52,   80,   79,   47,   90,   48,   52,   87,   92,
-       88,   52,   52,   83,   93,   52,   52,   84,   52,  100,
-       96,   52,   94,   95,   52,   52,   52,   99,   52,   52,
-       52,   52,   52,   97,   52,   52,   52,  101,  104,  115,
-      109,   98,  110,  103,  102,  105,  108,  106,  107,  114,
-      111,   52,   52,  117,   52,  112,  113,   52,   52,  116,
-       52,   52,  120,   52,   52,   52,   52,   52,  119,   52,
-      127,   52,   52,  121,  122,  118,   52,  130,  125,  124,
-      129,  126,  123,   52,   52,  132,   52,  131,  134,  135,
-       52,  137,   52,  128,   52,  138,  133,   52,   52,  139,
-
-       52,  140,  136,   52,  141,  144,   52,   52,   52,   52,
-       52,   52,   52,   52,  142,   52,   52,  148,  150,   52,
-      145,  151,  143,  149,  154,   52,   52,  147,  156,  155,
-      152,  146,   52,  153,   52,  158,   52,   52,   52,   52,
-       52,  157,   52,  160,   52,  164,   52,   52,   52,   52,
-      161,   52,   52,   52,   52,   52,   52,   52,   52,  159,
-      163,  162,  167,  165,  166,  168,   52,  182,   52,  175,
-      169,  170,  171,  172,  173,   52,   52,  176,  177,  174,
-      178,  184,  180,   52,   52,   52,   52,   52,  179,   52,
-      181,   52,   52,  183,  185,  186,  188,   52,  189,   52,
-
-      190,   52,   52,  192,  193,   52,   52,   52,  187,   52,
-       52,  196,   52,   52,   52,  197,  191,   52,  201,  200,
-       52,   52,   52,   52,   52,  194,  199,   52,  195,  202,
-      198,   44,   44,   44,   45,   45,   52,   52,   52,   52,
+       43,   33,   33,   33,   33,   44,   44,   44,   44,   44,
+       44,   44,   44,   44,   44,   44,   44,   44,   44,   44,
+       44,   44,   44,   44,   44,   44,   44,   44,   44,   44,
+       44,   44,   44,   44,   44,   44,   44,   44,   44,   44,
+       44,   44,   44,   44,   44,   44,   44,   44,   44,   44,
+      224,    5,    5,   68,    5,   45,   46,   53,   73,   53,
+
+       82,   92,   45,   45,   45,   45,   47,   53,   48,   51,
+       45,   45,   45,   45,   45,   45,   45,   45,   45,   45,
+       45,   45,   45,   45,   45,   45,   45,   45,   45,   45,
+       45,   45,   45,   45,   45,   45,   45,    5,    5,   66,
+       93,   71,   74,   80,   78,   67,   72,   81,   75,   53,
+       79,   53,   52,   95,   49,   50,   96,   53,   53,   53,
+       53,   53,   53,   53,   53,   53,   53,   53,   53,   53,
+       54,   53,   53,   53,   53,   55,   53,   53,   56,   53,
+       53,   53,   53,   53,   57,   97,   53,   69,   62,   59,
+       53,   70,   63,   53,   76,   98,   60,   83,   53,   61,
+
+       84,   53,   77,   87,   58,   64,   53,   88,    5,   65,
+       53,   53,   53,   85,   89,   99,   90,   86,  100,   91,
+      103,  104,   94,   52,   52,   52,   52,   52,   52,   52,
        52,   52,   52,   52,   52,   52,   52,   52,   52,   52,
        52,   52,   52,   52,   52,   52,   52,   52,   52,   52,
-       52,   52,   52,   52,   52,   52,   52,   52,   52,   52,
-       91,   52,   52,   52,   52,   91,   46,   46,   52,   51,
-       46,  203,    5,  203,  203,  203,  203,  203,  203,  203,
-      203,  203,  203,  203,  203,  203,  203,  203,  203,  203,
-
-      203,  203,  203,  203,  203,  203,  203,  203,  203,  203,
-      203,  203,  203,  203,  203,  203,  203,  203,  203,  203,
-      203,  203,  203,  203,  203,  203,  203
+      101,  107,  105,  108,  110,  111,  112,  113,  102,  106,
+      109,  114,  115,  120,  116,  121,  122,  123,  124,  125,
+      126,  127,  117,  128,  129,  131,  132,  118,  119,  133,
+      134,  135,  130,  136,  137,  138,  139,  140,  141,  142,
+      143,  144,  145,  146,  147,  149,  150,  151,  148,  152,
+
+      153,  154,  155,  156,  157,  158,  159,  160,  161,  162,
+      163,  164,  165,  166,  167,  168,  169,  170,  171,  172,
+      173,  174,  175,  176,  177,  178,  179,  180,  181,  182,
+      183,  184,  185,  186,  187,  188,  189,  190,  191,  192,
+      193,  194,  195,  196,  197,  198,  199,  200,  201,  202,
+      203,  204,  205,  206,  207,  208,  209,  210,  211,  212,
+      213,  214,  215,  216,  217,  218,  219,  220,  221,  222,
+      223,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,    0,    5,  224,  224,  224,  224,  224,  224,
+
+      224,  224,  224,  224,  224,  224,  224,  224,  224,  224,
+      224,  224,  224,  224,  224,  224,  224,  224,  224,  224,
+      224,  224,  224,  224,  224,  224,  224,  224,  224,  224,
+      224,  224,  224,  224,  224,  224,  224,  224,  224
     } ;
 
-static const flex_int16_t yy_chk[428] =
+static const flex_int16_t yy_chk[440] =
     {   0,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,   18,   23,   18,   20,   20,   24,
-       25,   26,   27,   29,   28,   30,   26,  207,   24,   31,
-       26,  206,   25,   23,   30,   32,   34,   36,   23,   25,
-       28,   23,   25,   26,   35,   29,   28,   31,   24,   35,
-       27,   37,   31,   38,   32,   34,   36,   35,   39,   40,
-       41,   42,   36,   43,   40,   62,   42,   39,   40,   37,
-
-       39,   54,   38,   37,   48,   43,   48,   55,   41,   54,
-       41,   56,   57,   39,   55,   59,   60,   39,   61,   62,
-       59,   63,   56,   57,   64,   65,   66,   61,   67,   68,
-       69,   74,   70,   60,   73,   75,   72,   63,   65,   73,
-       70,   60,   70,   64,   63,   66,   69,   67,   68,   72,
-       70,   76,   77,   75,   79,   70,   70,   80,   81,   74,
-       82,   83,   79,   84,   85,   86,   96,   87,   77,   88,
-       85,   89,   97,   80,   81,   76,   90,   88,   83,   82,
-       87,   84,   81,   95,   98,   90,   99,   89,   96,   97,
-      100,   99,  101,   86,  103,  100,   95,  102,  104,  100,
-
-      105,  101,   98,  106,  102,  105,  107,  108,  109,  111,
-      110,  113,  112,  119,  103,  114,  115,  109,  111,  120,
-      106,  112,  104,  110,  115,  121,  122,  108,  120,  119,
-      113,  107,  124,  114,  127,  122,  126,  128,  131,  129,
-      130,  121,  132,  126,  133,  130,  136,  137,  140,  144,
-      127,  148,  135,  149,  146,  150,  151,  164,  161,  124,
-      129,  128,  133,  131,  132,  135,  156,  161,  163,  149,
-      136,  137,  140,  144,  146,  155,  157,  150,  151,  148,
-      155,  164,  157,  158,  168,  165,  166,  170,  156,  171,
-      158,  175,  177,  163,  165,  166,  170,  178,  171,  180,
-
-      175,  181,  183,  178,  180,  182,  184,  185,  168,  199,
-      192,  183,  193,  202,  200,  184,  177,  201,  199,  193,
-      198,  197,  196,  195,  194,  181,  192,  191,  182,  200,
-      185,  204,  204,  204,  205,  205,  190,  189,  188,  187,
-      186,  179,  176,  174,  173,  172,  169,  167,  162,  160,
-      159,  154,  153,  152,  147,  145,  143,  142,  141,  139,
-      138,  134,  125,  123,  118,  117,  116,   94,   93,   92,
-       91,   78,   71,   58,   53,   47,   46,   45,   33,   22,
-        9,    5,  203,  203,  203,  203,  203,  203,  203,  203,
-      203,  203,  203,  203,  203,  203,  203,  203,  203,  203,
-
-      203,  203,  203,  203,  203,  203,  203,  203,  203,  203,
-      203,  203,  203,  203,  203,  203,  203,  203,  203,  203,
-      203,  203,  203,  203,  203,  203,  203
+        1,    1,    1,    1,    1,    3,    3,    3,    3,    3,
+        3,    3,    3,    3,    3,    3,    3,    3,    3,    3,
+        3,    3,    3,    3,    3,    3,    3,    3,    3,    3,
+        3,    3,    3,    3,    3,    3,    3,    3,    3,    3,
+        3,    3,    3,    3,    3,    3,    3,    3,    3,    3,
+        5,    9,   22,   29,   18,    9,    9,   33,   32,   29,
+
+       38,   42,    9,    9,    9,    9,   18,   32,   18,   22,
+        9,    9,    9,    9,    9,    9,    9,    9,    9,    9,
+        9,    9,    9,    9,    9,    9,    9,    9,    9,    9,
+        9,    9,    9,    9,    9,    9,    9,   20,   23,   28,
+       43,   31,   34,   37,   36,   28,   31,   37,   34,   31,
+       36,   28,   23,   54,   20,   20,   54,   23,   23,   23,
+       23,   23,   23,   23,   23,   23,   23,   23,   23,   23,
+       23,   23,   23,   23,   23,   23,   23,   23,   23,   23,
+       23,   23,   23,   23,   24,   55,   25,   30,   26,   25,
+       27,   30,   26,   24,   35,   56,   25,   39,   24,   25,
+
+       39,   24,   35,   40,   24,   26,   25,   40,   47,   27,
+       27,   30,   26,   39,   41,   57,   41,   39,   59,   41,
+       61,   62,   47,   52,   52,   52,   52,   52,   52,   52,
+       52,   52,   52,   52,   52,   52,   52,   52,   52,   52,
+       52,   52,   52,   52,   52,   52,   52,   52,   52,   52,
+       60,   64,   63,   65,   66,   67,   68,   69,   60,   63,
+       65,   70,   71,   73,   71,   74,   75,   76,   77,   78,
+       79,   81,   71,   82,   83,   84,   85,   71,   71,   86,
+       87,   88,   83,   89,   90,   91,   92,   93,   95,   99,
+      100,  101,  102,  103,  104,  105,  106,  107,  104,  108,
+
+      109,  110,  111,  112,  113,  114,  115,  116,  117,  118,
+      119,  120,  121,  122,  126,  127,  128,  129,  131,  133,
+      134,  135,  136,  137,  138,  139,  140,  141,  142,  144,
+      145,  146,  149,  153,  154,  156,  159,  160,  161,  162,
+      165,  167,  168,  169,  170,  173,  175,  176,  177,  178,
+      179,  180,  182,  184,  185,  186,  190,  192,  194,  196,
+      197,  198,  199,  200,  202,  204,  208,  211,  212,  220,
+      221,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,    0,  224,  224,  224,  224,  224,  224,  224,
+
+      224,  224,  224,  224,  224,  224,  224,  224,  224,  224,
+      224,  224,  224,  224,  224,  224,  224,  224,  224,  224,
+      224,  224,  224,  224,  224,  224,  224,  224,  224,  224,
+      224,  224,  224,  224,  224,  224,  224,  224,  224
     } ;
 
 /* The intent behind this definition is that it'll catch
@@ -608,10 +616,10 @@ extern double atof();
 #endif // YYDEBUG
 
 #define RETURN_TOKEN(token) debug_printf("%s\n",#token);return token
-#line 612 "lex.yy.c"
+#line 620 "lex.yy.c"
 /* Prevent the need for linking with -lfl */
 
-#line 615 "lex.yy.c"
+#line 623 "lex.yy.c"
 
 #define INITIAL 0
 #define STR 1
@@ -889,7 +897,7 @@ YY_DECL
 #line 33 "lex_sql.l"
 
 
-#line 893 "lex.yy.c"
+#line 901 "lex.yy.c"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -916,13 +924,13 @@ yy_match:
 			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 				{
 				yy_current_state = (int) yy_def[yy_current_state];
-				if ( yy_current_state >= 204 )
+				if ( yy_current_state >= 225 )
 					yy_c = yy_meta[yy_c];
 				}
 			yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
 			++yy_cp;
 			}
-		while ( yy_base[yy_current_state] != 383 );
+		while ( yy_base[yy_current_state] != 394 );
 
 yy_find_action:
 		yy_act = yy_accept[yy_current_state];
@@ -1229,85 +1237,110 @@ RETURN_TOKEN(GROUP);
 	YY_BREAK
 case 57:
 YY_RULE_SETUP
-#line 94 "lex_sql.l"
-yylval->string=strdup(yytext); RETURN_TOKEN(ID);
+#line 93 "lex_sql.l"
+RETURN_TOKEN(USING);
 	YY_BREAK
 case 58:
 YY_RULE_SETUP
-#line 95 "lex_sql.l"
-RETURN_TOKEN(LBRACE);
+#line 94 "lex_sql.l"
+RETURN_TOKEN(HASH);
 	YY_BREAK
 case 59:
 YY_RULE_SETUP
-#line 96 "lex_sql.l"
-RETURN_TOKEN(RBRACE);
+#line 95 "lex_sql.l"
+RETURN_TOKEN(LIMIT);
 	YY_BREAK
 case 60:
 YY_RULE_SETUP
-#line 98 "lex_sql.l"
-RETURN_TOKEN(ADD);
+#line 96 "lex_sql.l"
+RETURN_TOKEN(ANALYZE);
 	YY_BREAK
 case 61:
 YY_RULE_SETUP
-#line 99 "lex_sql.l"
-RETURN_TOKEN(SUB);
+#line 97 "lex_sql.l"
+RETURN_TOKEN(EXPLAIN);
 	YY_BREAK
 case 62:
 YY_RULE_SETUP
-#line 100 "lex_sql.l"
-RETURN_TOKEN(DIV);
+#line 99 "lex_sql.l"
+yylval->string=strdup(yytext); RETURN_TOKEN(ID);
 	YY_BREAK
 case 63:
 YY_RULE_SETUP
-#line 101 "lex_sql.l"
-RETURN_TOKEN(COMMA);
+#line 100 "lex_sql.l"
+RETURN_TOKEN(LBRACE);
 	YY_BREAK
 case 64:
 YY_RULE_SETUP
-#line 102 "lex_sql.l"
-RETURN_TOKEN(EQ);
+#line 101 "lex_sql.l"
+RETURN_TOKEN(RBRACE);
 	YY_BREAK
 case 65:
 YY_RULE_SETUP
 #line 103 "lex_sql.l"
-RETURN_TOKEN(LE);
+RETURN_TOKEN(ADD);
 	YY_BREAK
 case 66:
 YY_RULE_SETUP
 #line 104 "lex_sql.l"
-RETURN_TOKEN(NE);
+RETURN_TOKEN(SUB);
 	YY_BREAK
 case 67:
 YY_RULE_SETUP
 #line 105 "lex_sql.l"
-RETURN_TOKEN(LT);
+RETURN_TOKEN(DIV);
 	YY_BREAK
 case 68:
 YY_RULE_SETUP
 #line 106 "lex_sql.l"
-RETURN_TOKEN(GE);
+RETURN_TOKEN(COMMA);
 	YY_BREAK
 case 69:
 YY_RULE_SETUP
 #line 107 "lex_sql.l"
-RETURN_TOKEN(GT);
+RETURN_TOKEN(EQ);
 	YY_BREAK
 case 70:
 YY_RULE_SETUP
 #line 108 "lex_sql.l"
-yylval->string=strdup(yytext); RETURN_TOKEN(SSS);
+RETURN_TOKEN(LE);
 	YY_BREAK
 case 71:
 YY_RULE_SETUP
-#line 110 "lex_sql.l"
-printf("Unknown character [%c]\n",yytext[0]); return yytext[0];
+#line 109 "lex_sql.l"
+RETURN_TOKEN(NE);
 	YY_BREAK
 case 72:
 YY_RULE_SETUP
+#line 110 "lex_sql.l"
+RETURN_TOKEN(LT);
+	YY_BREAK
+case 73:
+YY_RULE_SETUP
 #line 111 "lex_sql.l"
+RETURN_TOKEN(GE);
+	YY_BREAK
+case 74:
+YY_RULE_SETUP
+#line 112 "lex_sql.l"
+RETURN_TOKEN(GT);
+	YY_BREAK
+case 75:
+YY_RULE_SETUP
+#line 113 "lex_sql.l"
+yylval->string=strdup(yytext); RETURN_TOKEN(SSS);
+	YY_BREAK
+case 76:
+YY_RULE_SETUP
+#line 115 "lex_sql.l"
+printf("Unknown character [%c]\n",yytext[0]); return yytext[0];
+	YY_BREAK
+case 77:
+YY_RULE_SETUP
+#line 116 "lex_sql.l"
 ECHO;
 	YY_BREAK
-#line 1311 "lex.yy.c"
+#line 1344 "lex.yy.c"
 case YY_STATE_EOF(INITIAL):
 case YY_STATE_EOF(STR):
 	yyterminate();
@@ -1607,7 +1640,7 @@ static int yy_get_next_buffer (yyscan_t yyscanner)
 		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 			{
 			yy_current_state = (int) yy_def[yy_current_state];
-			if ( yy_current_state >= 204 )
+			if ( yy_current_state >= 225 )
 				yy_c = yy_meta[yy_c];
 			}
 		yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
@@ -1636,11 +1669,11 @@ static int yy_get_next_buffer (yyscan_t yyscanner)
 	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 		{
 		yy_current_state = (int) yy_def[yy_current_state];
-		if ( yy_current_state >= 204 )
+		if ( yy_current_state >= 225 )
 			yy_c = yy_meta[yy_c];
 		}
 	yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
-	yy_is_jam = (yy_current_state == 203);
+	yy_is_jam = (yy_current_state == 224);
 
 	(void)yyg;
 	return yy_is_jam ? 0 : yy_current_state;
@@ -2489,7 +2522,7 @@ void yyfree (void * ptr , yyscan_t yyscanner)
 
 #define YYTABLES_NAME "yytables"
 
-#line 111 "lex_sql.l"
+#line 116 "lex_sql.l"
 
 
 void scan_string(const char *str, yyscan_t scanner) {
@@ -129,6 +129,8 @@ void clear_selects(Selects *selects) {
   selects->condition_num = 0;
   selects->order_num = 0;
   selects->group_num = 0;
+  selects->limit = -1;
+  selects->join_order_num = 0;
 }
 
 // 先判 select再判attr再判val，最后判定表达式(ast)
@@ -256,6 +258,10 @@ void selects_append_group(Selects *selects, RelAttr *rel_attr) {
   selects->group_bys[selects->group_num++] = *rel_attr;
 }
 
+void selects_set_limit(Selects *selects, int limit) {
+  selects->limit = limit;
+}
+
 void selects_destroy(Selects *selects) {
   for (size_t i = 0; i < selects->attr_num; i++) {
     relation_attr_destroy(&selects->attributes[i]);
@@ -420,8 +426,9 @@ void drop_table_destroy(DropTable *drop_table) {
 }
 
 void create_index_init(CreateIndex *create_index, int unique, const char *index_name, 
-                       const char *relation_name) {
+                       const char *relation_name, IndexType index_type) {
   create_index->unique = unique;
+  create_index->index_type = index_type;
   create_index->index_name = strdup(index_name);
   create_index->relation_name = strdup(relation_name);
 }
@@ -462,6 +469,15 @@ void desc_table_destroy(DescTable *desc_table) {
   desc_table->relation_name = nullptr;
 }
 
+void analyze_table_init(AnalyzeTable *analyze_table, const char *relation_name) {
+  analyze_table->relation_name = strdup(relation_name);
+}
+
+void analyze_table_destroy(AnalyzeTable *analyze_table) {
+  free((char *)analyze_table->relation_name);
+  analyze_table->relation_name = nullptr;
+}
+
 void load_data_init(LoadData *load_data, const char *relation_name, const char *file_name) {
   load_data->relation_name = strdup(relation_name);
 
@@ -483,8 +499,20 @@ void load_data_destroy(LoadData *load_data) {
   load_data->file_name = nullptr;
 }
 
+void set_variable_init(SetVariable *set_variable, const char *name, Value *value) {
+  set_variable->name = strdup(name);
+  set_variable->value = *value;
+}
+
+void set_variable_destroy(SetVariable *set_variable) {
+  free(set_variable->name);
+  set_variable->name = nullptr;
+  value_destroy(&set_variable->value);
+}
+
 void query_init(Query *query) {
   query->flag = SCF_ERROR;
+  query->explain = EXPLAIN_NONE;
   memset(&query->sstr, 0, sizeof(query->sstr));
 }
 
@@ -545,10 +573,19 @@ void query_reset(Query *query) {
     }
     break;
 
+    case SCF_ANALYZE_TABLE: {
+      analyze_table_destroy(&query->sstr.analyze_table);
+    }
+    break;
+
     case SCF_LOAD_DATA: {
       load_data_destroy(&query->sstr.load_data);
     }
     break;
+    case SCF_SET_VARIABLE: {
+      set_variable_destroy(&query->sstr.set_variable);
+    }
+    break;
     case SCF_BEGIN:
     case SCF_COMMIT:
     case SCF_ROLLBACK:
@@ -606,13 +643,202 @@ ast *newattrNode(RelAttr *attr) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-extern "C" int sql_parse(const char *st, Query  *sqls);
+extern "C" int sql_parse(const char *st, Query  *sqls, ParsedLiterals *literals);
 
-RC parse(const char *st, Query *sqln) {
-  sql_parse(st, sqln);
+RC parse(const char *st, Query *sqln, ParsedLiterals *literals) {
+  sql_parse(st, sqln, literals);
 
   if (sqln->flag == SCF_ERROR)
     return SQL_SYNTAX;
   else
     return SUCCESS;
-}
\ No newline at end of file
+}
+////////////////////////////////////////////////////////////////////////////////
+
+void value_copy(const Value *src, Value *dst) {
+  *dst = *src;
+  if (src->data == nullptr) {
+    return;
+  }
+  switch (src->type) {
+    case INTS:
+    case FLOATS: {
+      dst->data = malloc(sizeof(int));
+      memcpy(dst->data, src->data, sizeof(int));
+    } break;
+    default: {
+      // 与解析时一样至少分配DATESSIZE个字节，日期会在原地格式化成"xxxx-xx-xx"
+      size_t len = strlen((const char *)src->data) + 1;
+      dst->data = malloc(len < DATESSIZE ? DATESSIZE : len);
+      memcpy(dst->data, src->data, len);
+    } break;
+  }
+}
+
+namespace {
+
+class QueryCopier {
+public:
+  QueryCopier(ValueCopier copy_value, void *context) : copy_value_(copy_value), context_(context) {}
+
+  void copy(const Value &src, Value &dst) {
+    if (copy_value_ != nullptr) {
+      copy_value_(&src, &dst, context_);
+    } else {
+      value_copy(&src, &dst);
+    }
+  }
+
+  void copy(const RelAttr &src, RelAttr &dst) {
+    dst.relation_name = src.relation_name != nullptr ? strdup(src.relation_name) : nullptr;
+    dst.attribute_name = src.attribute_name != nullptr ? strdup(src.attribute_name) : nullptr;
+  }
+
+  ast *copy(const ast *src) {
+    if (src == nullptr) {
+      return nullptr;
+    }
+    switch (src->nodetype) {
+      case VALN: {
+        valnode *node = (valnode *)malloc(sizeof(valnode));
+        *node = *(const valnode *)src;
+        copy(((const valnode *)src)->value, node->value);
+        return (ast *)node;
+      }
+      case ATTRN: {
+        attrnode *node = (attrnode *)malloc(sizeof(attrnode));
+        *node = *(const attrnode *)src;
+        copy(((const attrnode *)src)->attr, node->attr);
+        return (ast *)node;
+      }
+      default: {
+        ast *node = (ast *)malloc(sizeof(ast));
+        *node = *src;
+        node->l = copy(src->l);
+        node->r = copy(src->r);
+        return node;
+      }
+    }
+  }
+
+  void copy(const Condition &src, Condition &dst) {
+    dst = src;
+    dst.left_ast = copy(src.left_ast);
+    dst.right_ast = copy(src.right_ast);
+    if (src.left_is_attr) {
+      copy(src.left_attr, dst.left_attr);
+    } else {
+      copy(src.left_value, dst.left_value);
+    }
+    if (src.right_is_attr) {
+      copy(src.right_attr, dst.right_attr);
+    } else {
+      copy(src.right_value, dst.right_value);
+    }
+    if (src.left_is_select) {
+      dst.left_selects = new Selects_();
+      copy(*src.left_selects, *dst.left_selects);
+    }
+    if (src.right_is_select) {
+      dst.right_selects = new Selects_();
+      copy(*src.right_selects, *dst.right_selects);
+    }
+  }
+
+  void copy(const Selects &src, Selects &dst) {
+    dst = src;
+    for (size_t i = 0; i < src.aggre_num; i++) {
+      if (src.aggregates[i].is_attr) {
+        copy(src.aggregates[i].attr, dst.aggregates[i].attr);
+      } else {
+        copy(src.aggregates[i].value, dst.aggregates[i].value);
+        dst.aggregates[i].attr.relation_name = nullptr;
+        dst.aggregates[i].attr.attribute_name = nullptr;
+      }
+    }
+    for (size_t i = 0; i < src.attr_num; i++) {
+      copy(src.attributes[i], dst.attributes[i]);
+    }
+    for (size_t i = 0; i < src.attr_exp_num; i++) {
+      dst.attributes_exp[i] = copy(src.attributes_exp[i]);
+    }
+    for (size_t i = 0; i < src.relation_num; i++) {
+      dst.relations[i] = strdup(src.relations[i]);
+    }
+    for (size_t i = 0; i < src.join_num; i++) {
+      dst.joins[i].table_name = strdup(src.joins[i].table_name);
+      for (size_t j = 0; j < src.joins[i].condition_num; j++) {
+        copy(src.joins[i].conditions[j], dst.joins[i].conditions[j]);
+      }
+    }
+    for (size_t i = 0; i < src.condition_num; i++) {
+      copy(src.conditions[i], dst.conditions[i]);
+    }
+    for (size_t i = 0; i < src.order_num; i++) {
+      copy(src.order_by[i].attribute, dst.order_by[i].attribute);
+    }
+    for (size_t i = 0; i < src.group_num; i++) {
+      copy(src.group_bys[i], dst.group_bys[i]);
+    }
+  }
+
+private:
+  ValueCopier copy_value_;
+  void *context_;
+};
+
+}  // namespace
+
+Query *query_copy(const Query *query, ValueCopier copy_value, void *context) {
+  if (query->flag != SCF_SELECT && query->flag != SCF_INSERT && query->flag != SCF_UPDATE &&
+      query->flag != SCF_DELETE) {
+    return nullptr;
+  }
+  Query *result = query_create();
+  if (nullptr == result) {
+    return nullptr;
+  }
+
+  QueryCopier copier(copy_value, context);
+  result->flag = query->flag;
+  result->explain = query->explain;
+  switch (query->flag) {
+    case SCF_SELECT: {
+      copier.copy(query->sstr.selection, result->sstr.selection);
+    } break;
+    case SCF_INSERT: {
+      const Inserts &src = query->sstr.insertion;
+      Inserts &dst = result->sstr.insertion;
+      dst = src;
+      dst.relation_name = strdup(src.relation_name);
+      for (size_t i = 0; i < src.pair_num; i++) {
+        for (size_t j = 0; j < src.pairs[i].value_num; j++) {
+          copier.copy(src.pairs[i].values[j], dst.pairs[i].values[j]);
+        }
+      }
+    } break;
+    case SCF_DELETE: {
+      const Deletes &src = query->sstr.deletion;
+      Deletes &dst = result->sstr.deletion;
+      dst = src;
+      dst.relation_name = strdup(src.relation_name);
+      for (size_t i = 0; i < src.condition_num; i++) {
+        copier.copy(src.conditions[i], dst.conditions[i]);
+      }
+    } break;
+    case SCF_UPDATE: {
+      const Updates &src = query->sstr.update;
+      Updates &dst = result->sstr.update;
+      dst = src;
+      dst.relation_name = strdup(src.relation_name);
+      dst.attribute_name = strdup(src.attribute_name);
+      copier.copy(src.value, dst.value);
+      for (size_t i = 0; i < src.condition_num; i++) {
+        copier.copy(src.conditions[i], dst.conditions[i]);
+      }
+    } break;
+    default:
+      break;
+  }
+  return result;
+}
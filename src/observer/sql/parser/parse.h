@@ -4,7 +4,27 @@
 #include "rc.h"
 #include "sql/parser/parse_defs.h"
 
-RC parse(const char *st, Query *sqln);
+/**
+ * 解析sql。literals不为空时按出现的顺序记录sql中的常量
+ */
+RC parse(const char *st, Query *sqln, ParsedLiterals *literals = nullptr);
+
+/**
+ * 复制一个常量，data另外分配
+ */
+void value_copy(const Value *src, Value *dst);
+
+/**
+ * 复制Value，context是query_copy的参数
+ */
+typedef void (*ValueCopier)(const Value *src, Value *dst, void *context);
+
+/**
+ * 复制一条已经解析好的select/insert/update/delete语句，得到的Query用query_destroy释放。
+ * 其中的每个常量都交给copy_value复制，copy_value为nullptr时原样复制常量
+ * @return 其它类型的语句返回nullptr
+ */
+Query *query_copy(const Query *query, ValueCopier copy_value, void *context);
 
 #endif //__OBSERVER_SQL_PARSER_PARSE_H__
 
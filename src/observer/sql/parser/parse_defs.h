@@ -46,6 +46,9 @@ typedef enum { UNDEFINEDAGG, MAXS, MINS, AVGS, SUMS, COUNTS } AggreType;
 //Join类型
 typedef enum { INNER_JOIN, OUTER_JOIN, LEFT_JOIN, RIGHT_JOIN } JoinType;
 
+//索引类型
+typedef enum { BPLUS_TREE_INDEX, HASH_INDEX } IndexType;
+
 // ast类型
 typedef enum { ADDN, SUBN, MULN, DIVN, VALN, ATTRN } NodeType;
 
@@ -129,6 +132,9 @@ typedef struct Selects_ {
   OrderBy   order_by[MAX_NUM];
   size_t    group_num;
   RelAttr   group_bys[MAX_NUM];
+  int       limit;                  // 最多返回的行数，-1表示没有limit
+  size_t    join_order_num;         // OptimizeStage选出的FROM中多张表的连接顺序，0表示按FROM中的顺序
+  int       join_order[MAX_NUM];    // 依次连接的表在relations中的下标
 } Selects;
 
 typedef struct {
@@ -183,6 +189,7 @@ typedef struct {
 typedef struct {
   char *index_name;      // Index name
   int  unique;           // 1: unique, 0:not unique
+  IndexType index_type;  // USING HASH 时为 HASH_INDEX
   char *relation_name;   // Relation name
   int attribute_num;
   char *attribute_names[MAX_NUM];  // Attribute name
@@ -197,11 +204,22 @@ typedef struct {
   const char *relation_name;
 } DescTable;
 
+// analyze table t，收集表的统计信息
+typedef struct {
+  const char *relation_name;
+} AnalyzeTable;
+
 typedef struct {
   const char *relation_name;
   const char *file_name;
 } LoadData;
 
+// struct of set, 如 set parallel_degree = 4
+typedef struct {
+  char *name;
+  Value value;
+} SetVariable;
+
 typedef struct valnode {
   NodeType nodetype;
   int l_brace;
@@ -226,7 +244,9 @@ union Queries {
   CreateIndex create_index;
   DropIndex drop_index;
   DescTable desc_table;
+  AnalyzeTable analyze_table;
   LoadData load_data;
+  SetVariable set_variable;
   char *errors;
 };
 
@@ -249,14 +269,29 @@ enum SqlCommandFlag {
   SCF_ROLLBACK,
   SCF_LOAD_DATA,
   SCF_HELP,
-  SCF_EXIT
+  SCF_EXIT,
+  SCF_SET_VARIABLE,
+  SCF_ANALYZE_TABLE
 };
+// EXPLAIN只输出执行计划，EXPLAIN ANALYZE执行查询并输出每个算子的统计
+typedef enum { EXPLAIN_NONE, EXPLAIN_PLAN, EXPLAIN_ANALYZE } ExplainType;
+
 // struct of flag and sql_struct
 typedef struct Query {
   enum SqlCommandFlag flag;
+  ExplainType explain;  // 只对select有效
   union Queries sstr;
 } Query;
 
+#define MAX_LITERAL_NUM (MAX_NUM * MAX_NUM)
+
+// 解析时按出现的顺序记录的常量(整数、浮点数、字符串)对应的Value::data，计划缓存用来替换常量
+// literal_num超过MAX_LITERAL_NUM时只记录前MAX_LITERAL_NUM个
+typedef struct {
+  size_t literal_num;
+  void *literals[MAX_LITERAL_NUM];
+} ParsedLiterals;
+
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
@@ -293,6 +328,7 @@ void selects_append_relation(Selects *selects, const char *relation_name);
 void selects_append_conditions(Selects *selects, Condition conditions[], size_t condition_num);
 void selects_append_order(Selects *selects, RelAttr *rel_attr, int order);
 void selects_append_group(Selects *selects, RelAttr *rel_attr);
+void selects_set_limit(Selects *selects, int limit);
 void selects_append_joins(Selects *selects, Join joins[], size_t join_num);
 void selects_destroy(Selects *selects);
 
@@ -318,7 +354,8 @@ void create_table_destroy(CreateTable *create_table);
 void drop_table_init(DropTable *drop_table, const char *relation_name);
 void drop_table_destroy(DropTable *drop_table);
 
-void create_index_init(CreateIndex *create_index, int unique, const char *index_name, const char *relation_name);
+void create_index_init(CreateIndex *create_index, int unique, const char *index_name, const char *relation_name,
+                       IndexType index_type);
 void create_index_append_attribute(CreateIndex *create_index, const char *attr_name);
 void create_index_destroy(CreateIndex *create_index);
 
@@ -328,9 +365,15 @@ void drop_index_destroy(DropIndex *drop_index);
 void desc_table_init(DescTable *desc_table, const char *relation_name);
 void desc_table_destroy(DescTable *desc_table);
 
+void analyze_table_init(AnalyzeTable *analyze_table, const char *relation_name);
+void analyze_table_destroy(AnalyzeTable *analyze_table);
+
 void load_data_init(LoadData *load_data, const char *relation_name, const char *file_name);
 void load_data_destroy(LoadData *load_data);
 
+void set_variable_init(SetVariable *set_variable, const char *name, Value *value);
+void set_variable_destroy(SetVariable *set_variable);
+
 void query_init(Query *query);
 Query *query_create();  // create and init
 void query_reset(Query *query);
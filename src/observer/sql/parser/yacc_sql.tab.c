@@ -1,8 +1,8 @@
-/* A Bison parser, made by GNU Bison 3.7.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2020 Free Software Foundation,
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
    Inc.
 
    This program is free software: you can redistribute it and/or modify
@@ -16,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -45,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.7"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -113,6 +113,7 @@ typedef struct ParserContext {
   CompOp comp[MAX_NUM];
   char id[MAX_NUM];
   int order; //0: asc, 1: desc
+  ParsedLiterals *literals;  // 可以为NULL
 } ParserContext;
 
 //获取子串
@@ -137,6 +138,7 @@ void yyerror(yyscan_t scanner, const char *str)
   ParserContext *context = (ParserContext *)(yyget_extra(scanner));
   query_reset(context->ssql);
   context->ssql->flag = SCF_ERROR;
+  context->ssql->explain = EXPLAIN_NONE;
   context->condition_length[0] = 0;
   context->from_length[0] = 0;
   context->select_length = 0;
@@ -153,8 +155,20 @@ ParserContext *get_context(yyscan_t scanner)
 
 #define CONTEXT get_context(scanner)
 
+void context_add_literal(ParserContext *context, void *data)
+{
+  ParsedLiterals *literals = context->literals;
+  if (literals == NULL) {
+    return;
+  }
+  if (literals->literal_num < MAX_LITERAL_NUM) {
+    literals->literals[literals->literal_num] = data;
+  }
+  literals->literal_num++;
+}
+
 
-#line 158 "yacc_sql.tab.c"
+#line 172 "yacc_sql.tab.c"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -248,71 +262,81 @@ enum yysymbol_kind_t
   YYSYMBOL_ADD = 63,                       /* ADD  */
   YYSYMBOL_SUB = 64,                       /* SUB  */
   YYSYMBOL_DIV = 65,                       /* DIV  */
-  YYSYMBOL_STAR = 66,                      /* STAR  */
-  YYSYMBOL_NUMBER = 67,                    /* NUMBER  */
-  YYSYMBOL_FLOAT = 68,                     /* FLOAT  */
-  YYSYMBOL_ID = 69,                        /* ID  */
-  YYSYMBOL_PATH = 70,                      /* PATH  */
-  YYSYMBOL_SSS = 71,                       /* SSS  */
-  YYSYMBOL_STRING_V = 72,                  /* STRING_V  */
-  YYSYMBOL_YYACCEPT = 73,                  /* $accept  */
-  YYSYMBOL_commands = 74,                  /* commands  */
-  YYSYMBOL_command = 75,                   /* command  */
-  YYSYMBOL_exit = 76,                      /* exit  */
-  YYSYMBOL_help = 77,                      /* help  */
-  YYSYMBOL_sync = 78,                      /* sync  */
-  YYSYMBOL_begin = 79,                     /* begin  */
-  YYSYMBOL_commit = 80,                    /* commit  */
-  YYSYMBOL_rollback = 81,                  /* rollback  */
-  YYSYMBOL_drop_table = 82,                /* drop_table  */
-  YYSYMBOL_show_tables = 83,               /* show_tables  */
-  YYSYMBOL_desc_table = 84,                /* desc_table  */
-  YYSYMBOL_create_index = 85,              /* create_index  */
-  YYSYMBOL_id_list = 86,                   /* id_list  */
-  YYSYMBOL_drop_index = 87,                /* drop_index  */
-  YYSYMBOL_create_table = 88,              /* create_table  */
-  YYSYMBOL_attr_def_list = 89,             /* attr_def_list  */
-  YYSYMBOL_attr_def = 90,                  /* attr_def  */
-  YYSYMBOL_number = 91,                    /* number  */
-  YYSYMBOL_type = 92,                      /* type  */
-  YYSYMBOL_ID_get = 93,                    /* ID_get  */
-  YYSYMBOL_insert = 94,                    /* insert  */
-  YYSYMBOL_insert_exp = 95,                /* insert_exp  */
-  YYSYMBOL_value_list = 96,                /* value_list  */
-  YYSYMBOL_insert_pair_list = 97,          /* insert_pair_list  */
-  YYSYMBOL_value = 98,                     /* value  */
-  YYSYMBOL_exp = 99,                       /* exp  */
-  YYSYMBOL_delete_begin = 100,             /* delete_begin  */
-  YYSYMBOL_delete = 101,                   /* delete  */
-  YYSYMBOL_update_begin = 102,             /* update_begin  */
-  YYSYMBOL_update = 103,                   /* update  */
-  YYSYMBOL_select_begin = 104,             /* select_begin  */
-  YYSYMBOL_select_end = 105,               /* select_end  */
-  YYSYMBOL_select_clause = 106,            /* select_clause  */
-  YYSYMBOL_select = 107,                   /* select  */
-  YYSYMBOL_select_attr = 108,              /* select_attr  */
-  YYSYMBOL_attr_list = 109,                /* attr_list  */
-  YYSYMBOL_aggre_func = 110,               /* aggre_func  */
-  YYSYMBOL_aggre_type = 111,               /* aggre_type  */
-  YYSYMBOL_rel_list = 112,                 /* rel_list  */
-  YYSYMBOL_inner_join = 113,               /* inner_join  */
-  YYSYMBOL_inner_join_list = 114,          /* inner_join_list  */
-  YYSYMBOL_join_condition_list = 115,      /* join_condition_list  */
-  YYSYMBOL_join_condition = 116,           /* join_condition  */
-  YYSYMBOL_where = 117,                    /* where  */
-  YYSYMBOL_condition_list = 118,           /* condition_list  */
-  YYSYMBOL_condition = 119,                /* condition  */
-  YYSYMBOL_left_sub_select = 120,          /* left_sub_select  */
-  YYSYMBOL_right_sub_select = 121,         /* right_sub_select  */
-  YYSYMBOL_comOp = 122,                    /* comOp  */
-  YYSYMBOL_order_by = 123,                 /* order_by  */
-  YYSYMBOL_order_item = 124,               /* order_item  */
-  YYSYMBOL_order = 125,                    /* order  */
-  YYSYMBOL_order_item_list = 126,          /* order_item_list  */
-  YYSYMBOL_group_by = 127,                 /* group_by  */
-  YYSYMBOL_group_item = 128,               /* group_item  */
-  YYSYMBOL_group_item_list = 129,          /* group_item_list  */
-  YYSYMBOL_load_data = 130                 /* load_data  */
+  YYSYMBOL_USING = 66,                     /* USING  */
+  YYSYMBOL_HASH = 67,                      /* HASH  */
+  YYSYMBOL_LIMIT = 68,                     /* LIMIT  */
+  YYSYMBOL_ANALYZE = 69,                   /* ANALYZE  */
+  YYSYMBOL_EXPLAIN = 70,                   /* EXPLAIN  */
+  YYSYMBOL_NUMBER = 71,                    /* NUMBER  */
+  YYSYMBOL_FLOAT = 72,                     /* FLOAT  */
+  YYSYMBOL_ID = 73,                        /* ID  */
+  YYSYMBOL_PATH = 74,                      /* PATH  */
+  YYSYMBOL_SSS = 75,                       /* SSS  */
+  YYSYMBOL_STAR = 76,                      /* STAR  */
+  YYSYMBOL_STRING_V = 77,                  /* STRING_V  */
+  YYSYMBOL_YYACCEPT = 78,                  /* $accept  */
+  YYSYMBOL_commands = 79,                  /* commands  */
+  YYSYMBOL_command = 80,                   /* command  */
+  YYSYMBOL_exit = 81,                      /* exit  */
+  YYSYMBOL_help = 82,                      /* help  */
+  YYSYMBOL_sync = 83,                      /* sync  */
+  YYSYMBOL_begin = 84,                     /* begin  */
+  YYSYMBOL_commit = 85,                    /* commit  */
+  YYSYMBOL_rollback = 86,                  /* rollback  */
+  YYSYMBOL_drop_table = 87,                /* drop_table  */
+  YYSYMBOL_show_tables = 88,               /* show_tables  */
+  YYSYMBOL_desc_table = 89,                /* desc_table  */
+  YYSYMBOL_analyze_table = 90,             /* analyze_table  */
+  YYSYMBOL_create_index = 91,              /* create_index  */
+  YYSYMBOL_index_using = 92,               /* index_using  */
+  YYSYMBOL_id_list = 93,                   /* id_list  */
+  YYSYMBOL_drop_index = 94,                /* drop_index  */
+  YYSYMBOL_create_table = 95,              /* create_table  */
+  YYSYMBOL_attr_def_list = 96,             /* attr_def_list  */
+  YYSYMBOL_attr_def = 97,                  /* attr_def  */
+  YYSYMBOL_number = 98,                    /* number  */
+  YYSYMBOL_type = 99,                      /* type  */
+  YYSYMBOL_ID_get = 100,                   /* ID_get  */
+  YYSYMBOL_insert = 101,                   /* insert  */
+  YYSYMBOL_insert_exp = 102,               /* insert_exp  */
+  YYSYMBOL_value_list = 103,               /* value_list  */
+  YYSYMBOL_insert_pair_list = 104,         /* insert_pair_list  */
+  YYSYMBOL_value = 105,                    /* value  */
+  YYSYMBOL_exp = 106,                      /* exp  */
+  YYSYMBOL_delete_begin = 107,             /* delete_begin  */
+  YYSYMBOL_delete = 108,                   /* delete  */
+  YYSYMBOL_update_begin = 109,             /* update_begin  */
+  YYSYMBOL_update = 110,                   /* update  */
+  YYSYMBOL_select_begin = 111,             /* select_begin  */
+  YYSYMBOL_select_end = 112,               /* select_end  */
+  YYSYMBOL_select_clause = 113,            /* select_clause  */
+  YYSYMBOL_explain = 114,                  /* explain  */
+  YYSYMBOL_select = 115,                   /* select  */
+  YYSYMBOL_select_attr = 116,              /* select_attr  */
+  YYSYMBOL_attr_list = 117,                /* attr_list  */
+  YYSYMBOL_aggre_func = 118,               /* aggre_func  */
+  YYSYMBOL_aggre_type = 119,               /* aggre_type  */
+  YYSYMBOL_rel_list = 120,                 /* rel_list  */
+  YYSYMBOL_inner_join = 121,               /* inner_join  */
+  YYSYMBOL_inner_join_list = 122,          /* inner_join_list  */
+  YYSYMBOL_join_condition_list = 123,      /* join_condition_list  */
+  YYSYMBOL_join_condition = 124,           /* join_condition  */
+  YYSYMBOL_where = 125,                    /* where  */
+  YYSYMBOL_condition_list = 126,           /* condition_list  */
+  YYSYMBOL_condition = 127,                /* condition  */
+  YYSYMBOL_left_sub_select = 128,          /* left_sub_select  */
+  YYSYMBOL_right_sub_select = 129,         /* right_sub_select  */
+  YYSYMBOL_comOp = 130,                    /* comOp  */
+  YYSYMBOL_order_by = 131,                 /* order_by  */
+  YYSYMBOL_order_item = 132,               /* order_item  */
+  YYSYMBOL_order = 133,                    /* order  */
+  YYSYMBOL_order_item_list = 134,          /* order_item_list  */
+  YYSYMBOL_limit = 135,                    /* limit  */
+  YYSYMBOL_group_by = 136,                 /* group_by  */
+  YYSYMBOL_group_item = 137,               /* group_item  */
+  YYSYMBOL_group_item_list = 138,          /* group_item_list  */
+  YYSYMBOL_load_data = 139,                /* load_data  */
+  YYSYMBOL_set_variable = 140              /* set_variable  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -356,6 +380,18 @@ typedef int_least16_t yytype_int16;
 typedef short yytype_int16;
 #endif
 
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
 #if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
 typedef __UINT_LEAST8_TYPE__ yytype_uint8;
 #elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
@@ -453,17 +489,23 @@ typedef int yy_state_fast_t;
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && ! defined __ICC && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                            \
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
     _Pragma ("GCC diagnostic push")                                     \
     _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
 # define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
@@ -622,19 +664,19 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  2
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   297
+#define YYLAST   320
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  73
+#define YYNTOKENS  78
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  58
+#define YYNNTS  63
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  136
+#define YYNRULES  147
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  269
+#define YYNSTATES  292
 
 /* YYMAXUTOK -- Last valid token kind.  */
-#define YYMAXUTOK   327
+#define YYMAXUTOK   332
 
 
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
@@ -680,27 +722,29 @@ static const yytype_int8 yytranslate[] =
       35,    36,    37,    38,    39,    40,    41,    42,    43,    44,
       45,    46,    47,    48,    49,    50,    51,    52,    53,    54,
       55,    56,    57,    58,    59,    60,    61,    62,    63,    64,
-      65,    66,    67,    68,    69,    70,    71,    72
+      65,    66,    67,    68,    69,    70,    71,    72,    73,    74,
+      75,    76,    77
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,   189,   189,   191,   195,   196,   197,   198,   199,   200,
-     201,   202,   203,   204,   205,   206,   207,   208,   209,   210,
-     211,   215,   220,   225,   231,   237,   243,   249,   255,   261,
-     268,   274,   282,   284,   290,   297,   306,   308,   312,   323,
-     335,   342,   352,   355,   356,   357,   358,   359,   362,   371,
-     389,   393,   398,   401,   403,   407,   411,   415,   420,   427,
-     428,   429,   430,   431,   432,   438,   439,   444,   449,   457,
-     463,   474,   480,   492,   498,   503,   509,   532,   537,   540,
-     543,   545,   548,   552,   557,   567,   568,   569,   570,   571,
-     574,   576,   582,   591,   593,   598,   600,   605,   610,   615,
-     620,   627,   629,   634,   636,   642,   647,   652,   657,   665,
-     671,   677,   678,   679,   680,   681,   682,   683,   684,   685,
-     686,   689,   691,   695,   700,   708,   711,   714,   719,   721,
-     724,   726,   730,   735,   742,   744,   749
+       0,   209,   209,   211,   215,   216,   217,   218,   219,   220,
+     221,   222,   223,   224,   225,   226,   227,   228,   229,   230,
+     231,   232,   233,   234,   238,   243,   248,   254,   260,   266,
+     272,   278,   284,   291,   298,   304,   313,   316,   321,   323,
+     329,   336,   345,   347,   351,   362,   374,   381,   391,   394,
+     395,   396,   397,   398,   401,   410,   428,   432,   437,   440,
+     442,   446,   451,   456,   462,   469,   470,   471,   472,   473,
+     474,   480,   481,   486,   491,   499,   505,   516,   522,   534,
+     540,   545,   551,   554,   560,   583,   588,   591,   594,   596,
+     599,   603,   608,   618,   619,   620,   621,   622,   625,   627,
+     633,   642,   644,   649,   651,   656,   661,   666,   671,   678,
+     680,   685,   687,   693,   698,   703,   708,   716,   722,   728,
+     729,   730,   731,   732,   733,   734,   735,   736,   737,   740,
+     742,   746,   751,   759,   762,   765,   770,   772,   775,   777,
+     782,   784,   788,   793,   800,   802,   807,   815
 };
 #endif
 
@@ -724,20 +768,21 @@ static const char *const yytname[] =
   "FROM", "WHERE", "INNER", "JOIN", "AND", "SET", "ON", "LOAD", "DATA",
   "INFILE", "MAX_T", "MIN_T", "AVG_T", "SUM_T", "COUNT_T", "EQ", "LT",
   "GT", "LE", "GE", "NE", "NOT_T", "NULL_T", "NULLABLE_T", "IS_T", "ORDER",
-  "BY", "ASC", "IN", "GROUP", "ADD", "SUB", "DIV", "STAR", "NUMBER",
-  "FLOAT", "ID", "PATH", "SSS", "STRING_V", "$accept", "commands",
-  "command", "exit", "help", "sync", "begin", "commit", "rollback",
-  "drop_table", "show_tables", "desc_table", "create_index", "id_list",
+  "BY", "ASC", "IN", "GROUP", "ADD", "SUB", "DIV", "USING", "HASH",
+  "LIMIT", "ANALYZE", "EXPLAIN", "NUMBER", "FLOAT", "ID", "PATH", "SSS",
+  "STAR", "STRING_V", "$accept", "commands", "command", "exit", "help",
+  "sync", "begin", "commit", "rollback", "drop_table", "show_tables",
+  "desc_table", "analyze_table", "create_index", "index_using", "id_list",
   "drop_index", "create_table", "attr_def_list", "attr_def", "number",
   "type", "ID_get", "insert", "insert_exp", "value_list",
   "insert_pair_list", "value", "exp", "delete_begin", "delete",
   "update_begin", "update", "select_begin", "select_end", "select_clause",
-  "select", "select_attr", "attr_list", "aggre_func", "aggre_type",
-  "rel_list", "inner_join", "inner_join_list", "join_condition_list",
-  "join_condition", "where", "condition_list", "condition",
-  "left_sub_select", "right_sub_select", "comOp", "order_by", "order_item",
-  "order", "order_item_list", "group_by", "group_item", "group_item_list",
-  "load_data", YY_NULLPTR
+  "explain", "select", "select_attr", "attr_list", "aggre_func",
+  "aggre_type", "rel_list", "inner_join", "inner_join_list",
+  "join_condition_list", "join_condition", "where", "condition_list",
+  "condition", "left_sub_select", "right_sub_select", "comOp", "order_by",
+  "order_item", "order", "order_item_list", "limit", "group_by",
+  "group_item", "group_item_list", "load_data", "set_variable", YY_NULLPTR
 };
 
 static const char *
@@ -747,23 +792,7 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_int16 yytoknum[] =
-{
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,   290,   291,   292,   293,   294,
-     295,   296,   297,   298,   299,   300,   301,   302,   303,   304,
-     305,   306,   307,   308,   309,   310,   311,   312,   313,   314,
-     315,   316,   317,   318,   319,   320,   321,   322,   323,   324,
-     325,   326,   327
-};
-#endif
-
-#define YYPACT_NINF (-214)
+#define YYPACT_NINF (-226)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
@@ -773,235 +802,254 @@ static const yytype_int16 yytoknum[] =
 #define yytable_value_is_error(Yyn) \
   0
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-    -214,   196,  -214,     3,    44,  -214,   -49,    36,    45,    53,
-    -214,  -214,    88,    96,   100,   102,   104,    57,  -214,  -214,
-    -214,  -214,  -214,  -214,  -214,  -214,  -214,  -214,  -214,  -214,
-    -214,  -214,    77,  -214,    39,  -214,    49,  -214,   108,  -214,
-      50,   105,    52,    55,    56,   119,   126,  -214,    62,  -214,
-    -214,  -214,  -214,  -214,    84,    73,   107,     4,  -214,  -214,
-    -214,  -214,  -214,  -214,     4,  -214,  -214,  -214,   121,  -214,
-    -214,   118,   122,   133,   137,  -214,   148,    98,   129,   166,
-     168,  -214,  -214,   140,   109,   142,   110,    23,   -41,   -37,
-      89,     4,     4,     4,     4,  -214,   124,  -214,    14,   125,
-     139,   128,  -214,  -214,   173,   160,    95,   192,   150,  -214,
-    -214,  -214,   118,   133,   -41,   -41,  -214,  -214,   180,   186,
-      83,  -214,   194,    -9,   145,   198,     4,   213,    -4,   178,
-     183,   -15,  -214,     4,  -214,  -214,   152,   187,  -214,  -214,
-     125,   205,  -214,  -214,  -214,  -214,  -214,    -7,   216,   165,
-     218,   123,   169,   222,  -214,  -214,  -214,  -214,  -214,  -214,
-     184,   193,  -214,   106,    95,  -214,   106,    75,   180,   210,
-     187,   142,   194,   245,   182,   195,  -214,   185,   232,     4,
-     234,   250,  -214,  -214,  -214,    -4,   123,  -214,   183,   123,
-    -214,   252,  -214,   188,  -214,   197,  -214,  -214,  -214,   238,
-    -214,   240,   191,   243,   218,   244,  -214,   246,  -214,  -214,
-     223,   206,   208,  -214,   264,   232,   265,  -214,   253,   266,
-    -214,    95,   202,   214,  -214,  -214,  -214,  -214,     4,  -214,
-     178,   235,   -15,   247,   255,   207,  -214,   218,   106,    95,
-    -214,   106,   209,   202,  -214,    -8,   256,   261,   123,  -214,
-     235,   123,  -214,  -214,   255,  -214,   211,  -214,  -214,   207,
-    -214,   244,  -214,  -214,    16,   256,  -214,  -214,  -214
+    -226,     4,  -226,   102,    22,  -226,   -66,    34,    10,     5,
+    -226,  -226,    49,    58,    76,    79,    97,    33,    73,   116,
+       1,  -226,  -226,  -226,  -226,  -226,  -226,  -226,  -226,  -226,
+    -226,  -226,  -226,  -226,  -226,  -226,   111,  -226,    80,  -226,
+      52,  -226,  -226,   149,  -226,  -226,    81,   153,    90,    92,
+      93,   167,   176,  -226,   110,  -226,  -226,  -226,  -226,  -226,
+     142,   152,   118,   183,  -226,   123,   157,    86,  -226,  -226,
+    -226,  -226,  -226,  -226,    86,  -226,  -226,   169,  -226,  -226,
+    -226,   -14,   168,   181,   185,  -226,   186,   131,   177,   203,
+     204,  -226,  -226,   201,   117,   140,   215,  -226,   200,   164,
+      29,   -36,    39,    74,    86,    86,    86,    86,  -226,   165,
+    -226,   -16,   170,   202,   171,  -226,  -226,   223,   239,   214,
+    -226,    96,   243,   199,  -226,  -226,  -226,   -14,   181,   -36,
+     -36,  -226,  -226,   229,   231,    72,  -226,   232,   151,   179,
+     233,    86,  -226,   247,    13,   160,   217,   178,  -226,    86,
+    -226,  -226,   182,   221,  -226,  -226,   170,   240,  -226,  -226,
+    -226,  -226,  -226,   -11,   242,   184,   241,    67,   188,   244,
+    -226,  -226,  -226,  -226,  -226,  -226,   205,   209,  -226,   109,
+      96,  -226,   109,   122,   229,   228,   221,   200,   232,   262,
+     196,   213,  -226,   197,   250,    86,   253,   269,  -226,  -226,
+    -226,    13,    67,  -226,   217,    67,  -226,   270,  -226,   206,
+    -226,   212,  -226,  -226,  -226,   257,  -226,   258,   207,   259,
+     241,   263,  -226,   260,  -226,  -226,   245,   222,   225,  -226,
+     219,   250,   219,  -226,   271,   283,  -226,    96,   216,   234,
+     224,   220,   287,  -226,   288,    86,  -226,   160,   261,   178,
+     264,   276,   226,   230,  -226,  -226,  -226,  -226,   241,   109,
+      96,  -226,   109,   227,   216,  -226,    16,   277,  -226,  -226,
+     279,    67,  -226,   261,    67,  -226,  -226,   276,  -226,   235,
+    -226,  -226,   226,  -226,   263,  -226,  -226,    27,   277,  -226,
+    -226,  -226
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
 static const yytype_uint8 yydefact[] =
 {
-       2,     0,     1,     0,     0,    73,     0,     0,     0,     0,
-      69,    71,     0,     0,     0,     0,     0,     0,     3,    20,
-      19,    14,    15,    16,    17,     9,    10,    11,    12,    13,
-       8,     5,     0,     7,     0,     6,     0,     4,     0,    18,
-       0,     0,     0,     0,     0,     0,     0,    23,     0,    24,
-      25,    26,    22,    21,     0,     0,     0,     0,    85,    86,
-      87,    88,    89,    58,     0,    77,    55,    56,    66,    57,
-      65,    80,     0,    80,     0,    75,     0,     0,     0,     0,
-       0,    29,    28,     0,     0,   101,     0,     0,    60,     0,
-       0,     0,     0,     0,     0,    78,     0,    79,     0,     0,
-       0,     0,    27,    34,     0,     0,     0,     0,     0,    64,
-      68,    67,    80,    80,    59,    61,    63,    62,    90,     0,
-       0,    48,    36,     0,     0,     0,     0,     0,     0,     0,
-     103,     0,    70,     0,    81,    82,     0,    93,    84,    83,
-       0,     0,    43,    44,    45,    46,    47,    39,     0,     0,
-      51,    50,     0,     0,   111,   112,   113,   114,   115,   116,
-       0,   117,   119,     0,     0,   102,     0,   101,    90,     0,
-      93,   101,    36,     0,     0,     0,    41,     0,    32,     0,
-       0,     0,   109,   120,   118,     0,   105,   106,   103,   107,
-     108,     0,    91,     0,    94,   130,    37,    35,    42,     0,
-      40,     0,     0,     0,    51,    53,   136,     0,   104,    72,
-       0,     0,   121,    38,     0,    32,     0,    52,     0,     0,
-     110,     0,     0,     0,    74,    31,    33,    30,     0,    49,
-       0,    95,     0,   132,   134,     0,    76,    51,     0,     0,
-      92,     0,     0,     0,   131,   125,   128,     0,    97,    98,
-      95,    99,   100,   133,   134,   127,     0,   126,   123,     0,
-     122,    53,    96,   135,   125,   128,    54,   124,   129
+       2,     0,     1,     0,     0,    79,     0,     0,     0,     0,
+      75,    77,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     3,    23,    22,    16,    17,    18,    19,    10,    11,
+      12,    13,    14,    15,     9,     6,     0,     8,     0,     7,
+       0,     4,     5,     0,    20,    21,     0,     0,     0,     0,
+       0,     0,     0,    26,     0,    27,    28,    29,    25,    24,
+       0,     0,     0,     0,    82,     0,     0,     0,    93,    94,
+      95,    96,    97,    64,     0,    61,    62,    72,    63,    85,
+      71,    88,     0,    88,     0,    81,     0,     0,     0,     0,
+       0,    32,    31,     0,     0,     0,     0,    83,   109,     0,
+       0,    66,     0,     0,     0,     0,     0,     0,    86,     0,
+      87,     0,     0,     0,     0,    30,    40,     0,     0,     0,
+      33,     0,     0,     0,    70,    73,    74,    88,    88,    65,
+      67,    69,    68,    98,     0,     0,    54,    42,     0,     0,
+       0,     0,   147,     0,     0,     0,   111,     0,    76,     0,
+      89,    90,     0,   101,    92,    91,     0,     0,    49,    50,
+      51,    52,    53,    45,     0,     0,    57,    56,     0,     0,
+     119,   120,   121,   122,   123,   124,     0,   125,   127,     0,
+       0,   110,     0,   109,    98,     0,   101,   109,    42,     0,
+       0,     0,    47,     0,    38,     0,     0,     0,   117,   128,
+     126,     0,   113,   114,   111,   115,   116,     0,    99,     0,
+     102,   140,    43,    41,    48,     0,    46,     0,     0,     0,
+      57,    59,   146,     0,   112,    78,     0,     0,   129,    44,
+      36,    38,    36,    58,     0,     0,   118,     0,     0,     0,
+     138,     0,     0,    39,     0,     0,    55,     0,   103,     0,
+     142,   144,     0,     0,    80,    37,    35,    34,    57,     0,
+       0,   100,     0,     0,     0,   141,   133,   136,   139,    84,
+       0,   105,   106,   103,   107,   108,   143,   144,   135,     0,
+     134,   131,     0,   130,    59,   104,   145,   133,   136,    60,
+     132,   137
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-    -214,  -214,  -214,  -214,  -214,  -214,  -214,  -214,  -214,  -214,
-    -214,  -214,  -214,    66,  -214,  -214,   111,   144,  -214,  -214,
-    -214,  -214,  -149,  -197,    21,  -214,   -36,  -214,  -214,  -214,
-    -214,  -214,  -214,  -214,  -124,  -214,   -68,   199,  -214,   117,
-    -214,   116,    37,    51,  -148,   103,   130,  -213,  -164,  -130,
-    -214,    29,    28,    30,  -214,    54,    42,  -214
+    -226,  -226,  -226,  -226,  -226,  -226,  -226,  -226,  -226,  -226,
+    -226,  -226,  -226,  -226,    70,    75,  -226,  -226,   115,   148,
+    -226,  -226,  -226,  -226,  -173,  -183,    21,   218,   -40,  -226,
+    -226,  -226,  -226,  -226,  -226,   -10,  -226,  -123,  -226,     6,
+     208,  -226,   125,  -226,   121,    37,    53,  -129,   112,   134,
+    -225,  -179,  -145,  -226,    35,    28,    30,  -226,  -226,    55,
+      43,  -226,  -226
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
+/* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int16 yydefgoto[] =
 {
-      -1,     1,    18,    19,    20,    21,    22,    23,    24,    25,
-      26,    27,    28,   203,    29,    30,   141,   122,   199,   147,
-     123,    31,   150,   180,   219,    70,    87,    32,    33,    34,
-      35,    36,   236,    37,    38,    72,    95,    73,    74,   137,
-     170,   171,   240,   231,   107,   165,   130,   131,   187,   163,
-     224,   246,   258,   260,   212,   234,   244,    39
+       0,     1,    21,    22,    23,    24,    25,    26,    27,    28,
+      29,    30,    31,    32,   242,   219,    33,    34,   157,   137,
+     215,   163,   138,    35,   166,   196,   235,    80,   100,    36,
+      37,    38,    39,    40,   269,    41,    42,    43,    82,   108,
+      83,    84,   153,   186,   187,   261,   248,   122,   181,   146,
+     147,   203,   179,   240,   267,   281,   283,   254,   228,   251,
+     265,    44,    45
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int16 yytable[] =
 {
-      71,   166,   190,   255,   153,    97,     5,   217,   232,    40,
-     174,    41,    42,    57,   142,   143,   144,   145,   146,   191,
-      45,    57,   256,   195,    93,    94,   232,   255,    88,   110,
-     204,    57,   111,   154,   155,   156,   157,   158,   159,   160,
-     247,   109,   161,    46,   134,   135,   162,   175,    47,   176,
-      43,    63,   257,    44,   112,   114,   115,   116,   117,    63,
-      64,   207,   120,    66,    67,    68,    57,    69,    64,    63,
-     129,    66,    67,    68,   249,    69,   257,   252,    64,   237,
-     119,    66,    67,    68,    48,    69,    91,    92,    93,    94,
-     151,    49,    58,    59,    60,    61,    62,   167,    54,    50,
-     238,   139,   241,    51,    63,    52,    57,    53,    56,   106,
-      55,    75,   128,    64,    77,    65,    66,    67,    68,    76,
-      69,    78,    81,   185,    79,    80,    84,   186,   129,    82,
-     189,    83,    58,    59,    60,    61,    62,    90,    91,    92,
-      93,    94,    85,   151,    63,    86,    91,    92,    93,    94,
-      63,    89,    90,    64,    98,    96,    66,    67,    68,    64,
-      69,    63,    66,    67,    68,    99,    69,   100,   101,   102,
-      64,   103,   104,    66,    67,    68,   106,    69,   124,   108,
-     105,    91,    92,    93,    94,   230,    91,    92,    93,    94,
-     126,   127,   151,   118,   121,   132,     2,   125,   133,   136,
-       3,     4,   248,   230,   138,   251,     5,     6,     7,     8,
-       9,    10,    11,   140,   148,   149,    12,    13,    14,   152,
-     164,   168,   169,   173,    15,    16,   154,   155,   156,   157,
-     158,   159,   160,   177,   178,   161,    17,   179,   181,   162,
-     182,    91,    92,    93,    94,   183,   193,   184,   197,   198,
-     200,   202,   205,   206,   201,   209,   213,   210,   214,   211,
-     215,   216,   221,   218,   220,   222,   223,   225,   227,   229,
-     228,   233,   239,   235,   243,   259,   245,   242,   253,   261,
-     264,   226,   266,   196,   172,   192,   194,   262,   265,   113,
-     250,   208,   267,     0,   188,   268,   263,   254
+      81,    67,   182,   206,     2,   103,   190,    51,     3,     4,
+      64,     5,   249,    53,     5,     6,     7,     8,     9,    10,
+      11,   169,   220,     5,    12,    13,    14,   278,    49,   106,
+      67,    50,    15,    16,   101,   249,    54,   233,   278,    73,
+     107,    52,    17,   191,    18,   192,   279,   124,    74,   104,
+     105,   106,    55,    97,   207,    75,    76,    77,   211,    78,
+     134,    56,   107,   127,   129,   130,   131,   132,    73,    67,
+      63,   135,   258,    19,    20,   270,   280,    74,   223,    57,
+     272,   145,    58,   275,    75,    76,    77,   280,    78,   110,
+     155,    67,   104,   105,   106,    68,    69,    70,    71,    72,
+      59,   167,   259,    67,   262,   107,    60,    73,    46,   183,
+      47,    48,   125,   144,    61,   126,    74,    68,    69,    70,
+      71,    72,    62,    75,    76,    77,   201,    78,    79,    73,
+     104,   105,   106,   150,   151,   104,   105,   106,    74,   202,
+     145,    73,   205,   107,    65,    75,    76,    77,   107,    78,
+      74,    73,    85,    66,    86,   167,   121,    75,    76,    77,
+      74,    78,    87,    88,    73,    89,    90,    75,    76,    77,
+      91,    78,    73,    74,   158,   159,   160,   161,   162,    92,
+      75,    76,    77,    93,    78,   104,   105,   106,    75,    76,
+      94,    96,    78,     5,    95,    99,    98,   247,   107,   102,
+     103,   109,   111,   112,   113,   167,   115,   116,   170,   171,
+     172,   173,   174,   175,   176,   119,   114,   177,   120,   271,
+     247,   178,   274,   104,   105,   106,   170,   171,   172,   173,
+     174,   175,   176,   117,   121,   177,   107,   123,   133,   178,
+     141,   139,   142,   136,   140,   143,   148,   149,   152,   154,
+     165,   156,   164,   168,   180,   184,   185,   194,   189,   193,
+     195,   197,   198,   200,   209,   213,   199,   214,   216,   218,
+     217,   221,   222,   225,   227,   229,   230,   232,   236,   226,
+     231,   238,   234,   239,   237,   241,   246,   255,   245,   250,
+     256,   257,   253,   252,   263,   264,   282,   284,   260,   266,
+     276,   268,   244,   212,   188,   289,   243,   210,   287,   208,
+     285,   128,   118,   273,   204,   290,   224,   288,   291,   277,
+     286
 };
 
 static const yytype_int16 yycheck[] =
 {
-      36,   131,   166,    11,   128,    73,    10,   204,   221,     6,
-      17,     8,     9,    17,    23,    24,    25,    26,    27,   167,
-      69,    17,    30,   171,    65,    66,   239,    11,    64,    66,
-     179,    17,    69,    48,    49,    50,    51,    52,    53,    54,
-     237,    18,    57,     7,   112,   113,    61,    54,     3,    56,
-       6,    55,    60,     9,    90,    91,    92,    93,    94,    55,
-      64,   185,    98,    67,    68,    69,    17,    71,    64,    55,
-     106,    67,    68,    69,   238,    71,    60,   241,    64,   228,
-      66,    67,    68,    69,    31,    71,    63,    64,    65,    66,
-     126,     3,    43,    44,    45,    46,    47,   133,    41,     3,
-     230,    18,   232,     3,    55,     3,    17,     3,    69,    34,
-      33,     3,    17,    64,     9,    66,    67,    68,    69,    69,
-      71,    69,     3,    17,    69,    69,    42,   163,   164,     3,
-     166,    69,    43,    44,    45,    46,    47,    19,    63,    64,
-      65,    66,    69,   179,    55,    38,    63,    64,    65,    66,
-      55,    30,    19,    64,    17,    33,    67,    68,    69,    64,
-      71,    55,    67,    68,    69,    17,    71,    69,    39,     3,
-      64,     3,    32,    67,    68,    69,    34,    71,    39,    69,
-      71,    63,    64,    65,    66,   221,    63,    64,    65,    66,
-      17,    31,   228,    69,    69,     3,     0,    69,    48,    19,
-       4,     5,   238,   239,    18,   241,    10,    11,    12,    13,
-      14,    15,    16,    19,    69,    17,    20,    21,    22,     6,
-      37,    69,    35,    18,    28,    29,    48,    49,    50,    51,
-      52,    53,    54,    17,    69,    57,    40,    19,    69,    61,
-      18,    63,    64,    65,    66,    61,    36,    54,     3,    67,
-      55,    19,    18,     3,    69,     3,    18,    69,    18,    62,
-      69,    18,    39,    19,    18,    59,    58,     3,     3,     3,
-      17,    69,    37,    59,    19,    19,    69,    30,    69,    18,
-      69,   215,   261,   172,   140,   168,   170,   250,   259,    90,
-     239,   188,   264,    -1,   164,   265,   254,   243
+      40,    17,   147,   182,     0,    19,    17,    73,     4,     5,
+      20,    10,   237,     3,    10,    11,    12,    13,    14,    15,
+      16,   144,   195,    10,    20,    21,    22,    11,     6,    65,
+      17,     9,    28,    29,    74,   260,    31,   220,    11,    55,
+      76,     7,    38,    54,    40,    56,    30,    18,    64,    63,
+      64,    65,     3,    63,   183,    71,    72,    73,   187,    75,
+      76,     3,    76,   103,   104,   105,   106,   107,    55,    17,
+      69,   111,   245,    69,    70,   258,    60,    64,   201,     3,
+     259,   121,     3,   262,    71,    72,    73,    60,    75,    83,
+      18,    17,    63,    64,    65,    43,    44,    45,    46,    47,
+       3,   141,   247,    17,   249,    76,    73,    55,     6,   149,
+       8,     9,    73,    17,    41,    76,    64,    43,    44,    45,
+      46,    47,     6,    71,    72,    73,    17,    75,    76,    55,
+      63,    64,    65,   127,   128,    63,    64,    65,    64,   179,
+     180,    55,   182,    76,    33,    71,    72,    73,    76,    75,
+      64,    55,     3,    73,    73,   195,    34,    71,    72,    73,
+      64,    75,     9,    73,    55,    73,    73,    71,    72,    73,
+       3,    75,    55,    64,    23,    24,    25,    26,    27,     3,
+      71,    72,    73,    73,    75,    63,    64,    65,    71,    72,
+      48,    73,    75,    10,    42,    38,    73,   237,    76,    30,
+      19,    33,    17,    17,    73,   245,     3,     3,    48,    49,
+      50,    51,    52,    53,    54,    75,    39,    57,     3,   259,
+     260,    61,   262,    63,    64,    65,    48,    49,    50,    51,
+      52,    53,    54,    32,    34,    57,    76,    73,    73,    61,
+      17,    39,     3,    73,    73,    31,     3,    48,    19,    18,
+      17,    19,    73,     6,    37,    73,    35,    73,    18,    17,
+      19,    73,    18,    54,    36,     3,    61,    71,    55,    19,
+      73,    18,     3,     3,    62,    18,    18,    18,    18,    73,
+      73,    59,    19,    58,    39,    66,     3,    67,    17,    73,
+       3,     3,    68,    59,    30,    19,    19,    18,    37,    73,
+      73,    71,   232,   188,   156,   284,   231,   186,    73,   184,
+     273,   103,    94,   260,   180,   287,   204,   282,   288,   264,
+     277
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
 static const yytype_uint8 yystos[] =
 {
-       0,    74,     0,     4,     5,    10,    11,    12,    13,    14,
-      15,    16,    20,    21,    22,    28,    29,    40,    75,    76,
-      77,    78,    79,    80,    81,    82,    83,    84,    85,    87,
-      88,    94,   100,   101,   102,   103,   104,   106,   107,   130,
-       6,     8,     9,     6,     9,    69,     7,     3,    31,     3,
-       3,     3,     3,     3,    41,    33,    69,    17,    43,    44,
-      45,    46,    47,    55,    64,    66,    67,    68,    69,    71,
-      98,    99,   108,   110,   111,     3,    69,     9,    69,    69,
-      69,     3,     3,    69,    42,    69,    38,    99,    99,    30,
-      19,    63,    64,    65,    66,   109,    33,   109,    17,    17,
-      69,    39,     3,     3,    32,    71,    34,   117,    69,    18,
-      66,    69,    99,   110,    99,    99,    99,    99,    69,    66,
-      99,    69,    90,    93,    39,    69,    17,    31,    17,    99,
-     119,   120,     3,    48,   109,   109,    19,   112,    18,    18,
-      19,    89,    23,    24,    25,    26,    27,    92,    69,    17,
-      95,    99,     6,   107,    48,    49,    50,    51,    52,    53,
-      54,    57,    61,   122,    37,   118,   122,    99,    69,    35,
-     113,   114,    90,    18,    17,    54,    56,    17,    69,    19,
-      96,    69,    18,    61,    54,    17,    99,   121,   119,    99,
-     121,   117,   112,    36,   114,   117,    89,     3,    67,    91,
-      55,    69,    19,    86,    95,    18,     3,   107,   118,     3,
-      69,    62,   127,    18,    18,    69,    18,    96,    19,    97,
-      18,    39,    59,    58,   123,     3,    86,     3,    17,     3,
-      99,   116,   120,    69,   128,    59,   105,    95,   122,    37,
-     115,   122,    30,    19,   129,    69,   124,    96,    99,   121,
-     116,    99,   121,    69,   128,    11,    30,    60,   125,    19,
-     126,    18,   115,   129,    69,   124,    97,   125,   126
+       0,    79,     0,     4,     5,    10,    11,    12,    13,    14,
+      15,    16,    20,    21,    22,    28,    29,    38,    40,    69,
+      70,    80,    81,    82,    83,    84,    85,    86,    87,    88,
+      89,    90,    91,    94,    95,   101,   107,   108,   109,   110,
+     111,   113,   114,   115,   139,   140,     6,     8,     9,     6,
+       9,    73,     7,     3,    31,     3,     3,     3,     3,     3,
+      73,    41,     6,    69,   113,    33,    73,    17,    43,    44,
+      45,    46,    47,    55,    64,    71,    72,    73,    75,    76,
+     105,   106,   116,   118,   119,     3,    73,     9,    73,    73,
+      73,     3,     3,    73,    48,    42,    73,   113,    73,    38,
+     106,   106,    30,    19,    63,    64,    65,    76,   117,    33,
+     117,    17,    17,    73,    39,     3,     3,    32,   105,    75,
+       3,    34,   125,    73,    18,    73,    76,   106,   118,   106,
+     106,   106,   106,    73,    76,   106,    73,    97,   100,    39,
+      73,    17,     3,    31,    17,   106,   127,   128,     3,    48,
+     117,   117,    19,   120,    18,    18,    19,    96,    23,    24,
+      25,    26,    27,    99,    73,    17,   102,   106,     6,   115,
+      48,    49,    50,    51,    52,    53,    54,    57,    61,   130,
+      37,   126,   130,   106,    73,    35,   121,   122,    97,    18,
+      17,    54,    56,    17,    73,    19,   103,    73,    18,    61,
+      54,    17,   106,   129,   127,   106,   129,   125,   120,    36,
+     122,   125,    96,     3,    71,    98,    55,    73,    19,    93,
+     102,    18,     3,   115,   126,     3,    73,    62,   136,    18,
+      18,    73,    18,   103,    19,   104,    18,    39,    59,    58,
+     131,    66,    92,    93,    92,    17,     3,   106,   124,   128,
+      73,   137,    59,    68,   135,    67,     3,     3,   102,   130,
+      37,   123,   130,    30,    19,   138,    73,   132,    71,   112,
+     103,   106,   129,   124,   106,   129,    73,   137,    11,    30,
+      60,   133,    19,   134,    18,   123,   138,    73,   132,   104,
+     133,   134
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_uint8 yyr1[] =
 {
-       0,    73,    74,    74,    75,    75,    75,    75,    75,    75,
-      75,    75,    75,    75,    75,    75,    75,    75,    75,    75,
-      75,    76,    77,    78,    79,    80,    81,    82,    83,    84,
-      85,    85,    86,    86,    87,    88,    89,    89,    90,    90,
-      90,    90,    91,    92,    92,    92,    92,    92,    93,    94,
-      95,    96,    96,    97,    97,    98,    98,    98,    98,    99,
-      99,    99,    99,    99,    99,    99,    99,    99,    99,   100,
-     101,   102,   103,   104,   105,   106,   107,   108,   108,   108,
-     109,   109,   109,   110,   110,   111,   111,   111,   111,   111,
-     112,   112,   113,   114,   114,   115,   115,   116,   116,   116,
-     116,   117,   117,   118,   118,   119,   119,   119,   119,   120,
-     121,   122,   122,   122,   122,   122,   122,   122,   122,   122,
-     122,   123,   123,   124,   124,   125,   125,   125,   126,   126,
-     127,   127,   128,   128,   129,   129,   130
+       0,    78,    79,    79,    80,    80,    80,    80,    80,    80,
+      80,    80,    80,    80,    80,    80,    80,    80,    80,    80,
+      80,    80,    80,    80,    81,    82,    83,    84,    85,    86,
+      87,    88,    89,    90,    91,    91,    92,    92,    93,    93,
+      94,    95,    96,    96,    97,    97,    97,    97,    98,    99,
+      99,    99,    99,    99,   100,   101,   102,   103,   103,   104,
+     104,   105,   105,   105,   105,   106,   106,   106,   106,   106,
+     106,   106,   106,   106,   106,   107,   108,   109,   110,   111,
+     112,   113,   114,   114,   115,   116,   116,   116,   117,   117,
+     117,   118,   118,   119,   119,   119,   119,   119,   120,   120,
+     121,   122,   122,   123,   123,   124,   124,   124,   124,   125,
+     125,   126,   126,   127,   127,   127,   127,   128,   129,   130,
+     130,   130,   130,   130,   130,   130,   130,   130,   130,   131,
+     131,   132,   132,   133,   133,   133,   134,   134,   135,   135,
+     136,   136,   137,   137,   138,   138,   139,   140
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
        0,     2,     0,     2,     1,     1,     1,     1,     1,     1,
        1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
-       1,     2,     2,     2,     2,     2,     2,     4,     3,     3,
-      10,    10,     0,     3,     4,     8,     0,     3,     5,     2,
-       4,     3,     1,     1,     1,     1,     1,     1,     1,    10,
-       1,     0,     3,     0,     6,     1,     1,     1,     1,     3,
-       2,     3,     3,     3,     3,     1,     1,     3,     3,     1,
-       5,     1,     8,     1,     0,     2,    10,     1,     2,     2,
-       0,     3,     3,     4,     4,     1,     1,     1,     1,     1,
-       0,     3,     6,     0,     2,     0,     3,     3,     3,     3,
-       3,     0,     3,     0,     3,     3,     3,     3,     3,     3,
-       3,     1,     1,     1,     1,     1,     1,     1,     2,     1,
-       2,     0,     4,     2,     4,     0,     1,     1,     0,     3,
-       0,     4,     1,     3,     0,     3,     8
+       1,     1,     1,     1,     2,     2,     2,     2,     2,     2,
+       4,     3,     3,     4,    11,    11,     0,     2,     0,     3,
+       4,     8,     0,     3,     5,     2,     4,     3,     1,     1,
+       1,     1,     1,     1,     1,    10,     1,     0,     3,     0,
+       6,     1,     1,     1,     1,     3,     2,     3,     3,     3,
+       3,     1,     1,     3,     3,     1,     5,     1,     8,     1,
+       0,     2,     2,     3,    11,     1,     2,     2,     0,     3,
+       3,     4,     4,     1,     1,     1,     1,     1,     0,     3,
+       6,     0,     2,     0,     3,     3,     3,     3,     3,     0,
+       3,     0,     3,     3,     3,     3,     3,     3,     3,     1,
+       1,     1,     1,     1,     1,     1,     2,     1,     2,     0,
+       4,     2,     4,     0,     1,     1,     0,     3,     0,     2,
+       0,     4,     1,     3,     0,     3,     8,     5
 };
 
 
@@ -1013,6 +1061,7 @@ enum { YYENOMEM = -2 };
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
@@ -1053,10 +1102,7 @@ do {                                            \
     YYFPRINTF Args;                             \
 } while (0)
 
-/* This macro is provided for backward compatibility. */
-# ifndef YY_LOCATION_PRINT
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
+
 
 
 # define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
@@ -1080,16 +1126,12 @@ yy_symbol_value_print (FILE *yyo,
                        yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, void *scanner)
 {
   FILE *yyoutput = yyo;
-  YYUSE (yyoutput);
-  YYUSE (scanner);
+  YY_USE (yyoutput);
+  YY_USE (scanner);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yykind < YYNTOKENS)
-    YYPRINT (yyo, yytoknum[yykind], *yyvaluep);
-# endif
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yykind);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
@@ -1203,14 +1245,14 @@ static void
 yydestruct (const char *yymsg,
             yysymbol_kind_t yykind, YYSTYPE *yyvaluep, void *scanner)
 {
-  YYUSE (yyvaluep);
-  YYUSE (scanner);
+  YY_USE (yyvaluep);
+  YY_USE (scanner);
   if (!yymsg)
     yymsg = "Deleting";
   YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yykind);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
@@ -1279,6 +1321,7 @@ YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
   YYDPRINTF ((stderr, "Starting parse\n"));
 
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   goto yysetstate;
 
 
@@ -1304,7 +1347,7 @@ yysetstate:
 
   if (yyss + yystacksize - 1 <= yyssp)
 #if !defined yyoverflow && !defined YYSTACK_RELOCATE
-    goto yyexhaustedlab;
+    YYNOMEM;
 #else
     {
       /* Get the current used size of the three stacks, in elements.  */
@@ -1332,7 +1375,7 @@ yysetstate:
 # else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
@@ -1343,7 +1386,7 @@ yysetstate:
           YY_CAST (union yyalloc *,
                    YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
@@ -1365,6 +1408,7 @@ yysetstate:
     }
 #endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
+
   if (yystate == YYFINAL)
     YYACCEPT;
 
@@ -1476,119 +1520,144 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-  case 21: /* exit: EXIT SEMICOLON  */
-#line 215 "yacc_sql.y"
+  case 24: /* exit: EXIT SEMICOLON  */
+#line 238 "yacc_sql.y"
                    {
         CONTEXT->ssql->flag=SCF_EXIT;//"exit";
     }
-#line 1485 "yacc_sql.tab.c"
+#line 1529 "yacc_sql.tab.c"
     break;
 
-  case 22: /* help: HELP SEMICOLON  */
-#line 220 "yacc_sql.y"
+  case 25: /* help: HELP SEMICOLON  */
+#line 243 "yacc_sql.y"
                    {
         CONTEXT->ssql->flag=SCF_HELP;//"help";
     }
-#line 1493 "yacc_sql.tab.c"
+#line 1537 "yacc_sql.tab.c"
     break;
 
-  case 23: /* sync: SYNC SEMICOLON  */
-#line 225 "yacc_sql.y"
+  case 26: /* sync: SYNC SEMICOLON  */
+#line 248 "yacc_sql.y"
                    {
       CONTEXT->ssql->flag = SCF_SYNC;
     }
-#line 1501 "yacc_sql.tab.c"
+#line 1545 "yacc_sql.tab.c"
     break;
 
-  case 24: /* begin: TRX_BEGIN SEMICOLON  */
-#line 231 "yacc_sql.y"
+  case 27: /* begin: TRX_BEGIN SEMICOLON  */
+#line 254 "yacc_sql.y"
                         {
       CONTEXT->ssql->flag = SCF_BEGIN;
     }
-#line 1509 "yacc_sql.tab.c"
+#line 1553 "yacc_sql.tab.c"
     break;
 
-  case 25: /* commit: TRX_COMMIT SEMICOLON  */
-#line 237 "yacc_sql.y"
+  case 28: /* commit: TRX_COMMIT SEMICOLON  */
+#line 260 "yacc_sql.y"
                          {
       CONTEXT->ssql->flag = SCF_COMMIT;
     }
-#line 1517 "yacc_sql.tab.c"
+#line 1561 "yacc_sql.tab.c"
     break;
 
-  case 26: /* rollback: TRX_ROLLBACK SEMICOLON  */
-#line 243 "yacc_sql.y"
+  case 29: /* rollback: TRX_ROLLBACK SEMICOLON  */
+#line 266 "yacc_sql.y"
                            {
       CONTEXT->ssql->flag = SCF_ROLLBACK;
     }
-#line 1525 "yacc_sql.tab.c"
+#line 1569 "yacc_sql.tab.c"
     break;
 
-  case 27: /* drop_table: DROP TABLE ID SEMICOLON  */
-#line 249 "yacc_sql.y"
+  case 30: /* drop_table: DROP TABLE ID SEMICOLON  */
+#line 272 "yacc_sql.y"
                             {
         CONTEXT->ssql->flag = SCF_DROP_TABLE;//"drop_table";
         drop_table_init(&CONTEXT->ssql->sstr.drop_table, (yyvsp[-1].string));
     }
-#line 1534 "yacc_sql.tab.c"
+#line 1578 "yacc_sql.tab.c"
     break;
 
-  case 28: /* show_tables: SHOW TABLES SEMICOLON  */
-#line 255 "yacc_sql.y"
+  case 31: /* show_tables: SHOW TABLES SEMICOLON  */
+#line 278 "yacc_sql.y"
                           {
       CONTEXT->ssql->flag = SCF_SHOW_TABLES;
     }
-#line 1542 "yacc_sql.tab.c"
+#line 1586 "yacc_sql.tab.c"
     break;
 
-  case 29: /* desc_table: DESC ID SEMICOLON  */
-#line 261 "yacc_sql.y"
+  case 32: /* desc_table: DESC ID SEMICOLON  */
+#line 284 "yacc_sql.y"
                       {
       CONTEXT->ssql->flag = SCF_DESC_TABLE;
       desc_table_init(&CONTEXT->ssql->sstr.desc_table, (yyvsp[-1].string));
     }
-#line 1551 "yacc_sql.tab.c"
+#line 1595 "yacc_sql.tab.c"
     break;
 
-  case 30: /* create_index: CREATE INDEX ID ON ID LBRACE ID id_list RBRACE SEMICOLON  */
-#line 269 "yacc_sql.y"
+  case 33: /* analyze_table: ANALYZE TABLE ID SEMICOLON  */
+#line 291 "yacc_sql.y"
+                               {
+      CONTEXT->ssql->flag = SCF_ANALYZE_TABLE;
+      analyze_table_init(&CONTEXT->ssql->sstr.analyze_table, (yyvsp[-1].string));
+    }
+#line 1604 "yacc_sql.tab.c"
+    break;
+
+  case 34: /* create_index: CREATE INDEX ID ON ID LBRACE ID id_list RBRACE index_using SEMICOLON  */
+#line 299 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag = SCF_CREATE_INDEX;//"create_index";
-			create_index_init(&CONTEXT->ssql->sstr.create_index, 0, (yyvsp[-7].string), (yyvsp[-5].string));
-			create_index_append_attribute(&CONTEXT->ssql->sstr.create_index, (yyvsp[-3].string));
+			create_index_init(&CONTEXT->ssql->sstr.create_index, 0, (yyvsp[-8].string), (yyvsp[-6].string), (yyvsp[-1].number));
+			create_index_append_attribute(&CONTEXT->ssql->sstr.create_index, (yyvsp[-4].string));
 		}
-#line 1561 "yacc_sql.tab.c"
+#line 1614 "yacc_sql.tab.c"
     break;
 
-  case 31: /* create_index: CREATE UNIQUE INDEX ID ON ID LBRACE ID RBRACE SEMICOLON  */
-#line 275 "yacc_sql.y"
+  case 35: /* create_index: CREATE UNIQUE INDEX ID ON ID LBRACE ID RBRACE index_using SEMICOLON  */
+#line 305 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag = SCF_CREATE_INDEX;//"create_index";(unique)
-			create_index_init(&CONTEXT->ssql->sstr.create_index, 1, (yyvsp[-6].string), (yyvsp[-4].string));
-			create_index_append_attribute(&CONTEXT->ssql->sstr.create_index, (yyvsp[-2].string));
+			create_index_init(&CONTEXT->ssql->sstr.create_index, 1, (yyvsp[-7].string), (yyvsp[-5].string), (yyvsp[-1].number));
+			create_index_append_attribute(&CONTEXT->ssql->sstr.create_index, (yyvsp[-3].string));
 		}
-#line 1571 "yacc_sql.tab.c"
+#line 1624 "yacc_sql.tab.c"
     break;
 
-  case 33: /* id_list: COMMA ID id_list  */
-#line 284 "yacc_sql.y"
+  case 36: /* index_using: %empty  */
+#line 313 "yacc_sql.y"
+                    {
+		(yyval.number) = BPLUS_TREE_INDEX;
+	}
+#line 1632 "yacc_sql.tab.c"
+    break;
+
+  case 37: /* index_using: USING HASH  */
+#line 316 "yacc_sql.y"
+                     {
+		(yyval.number) = HASH_INDEX;
+	}
+#line 1640 "yacc_sql.tab.c"
+    break;
+
+  case 39: /* id_list: COMMA ID id_list  */
+#line 323 "yacc_sql.y"
                            {
 		create_index_append_attribute(&CONTEXT->ssql->sstr.create_index, (yyvsp[-1].string));
 	}
-#line 1579 "yacc_sql.tab.c"
+#line 1648 "yacc_sql.tab.c"
     break;
 
-  case 34: /* drop_index: DROP INDEX ID SEMICOLON  */
-#line 291 "yacc_sql.y"
+  case 40: /* drop_index: DROP INDEX ID SEMICOLON  */
+#line 330 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag=SCF_DROP_INDEX;//"drop_index";
 			drop_index_init(&CONTEXT->ssql->sstr.drop_index, (yyvsp[-1].string));
 		}
-#line 1588 "yacc_sql.tab.c"
+#line 1657 "yacc_sql.tab.c"
     break;
 
-  case 35: /* create_table: CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE SEMICOLON  */
-#line 298 "yacc_sql.y"
+  case 41: /* create_table: CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE SEMICOLON  */
+#line 337 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag=SCF_CREATE_TABLE;//"create_table";
 			// CONTEXT->ssql->sstr.create_table.attribute_count = CONTEXT->value_length;
@@ -1596,17 +1665,17 @@ yyreduce:
 			//临时变量清零	
 			CONTEXT->value_length = 0;
 		}
-#line 1600 "yacc_sql.tab.c"
+#line 1669 "yacc_sql.tab.c"
     break;
 
-  case 37: /* attr_def_list: COMMA attr_def attr_def_list  */
-#line 308 "yacc_sql.y"
+  case 43: /* attr_def_list: COMMA attr_def attr_def_list  */
+#line 347 "yacc_sql.y"
                                    {    }
-#line 1606 "yacc_sql.tab.c"
+#line 1675 "yacc_sql.tab.c"
     break;
 
-  case 38: /* attr_def: ID_get type LBRACE number RBRACE  */
-#line 313 "yacc_sql.y"
+  case 44: /* attr_def: ID_get type LBRACE number RBRACE  */
+#line 352 "yacc_sql.y"
                 {
 			AttrInfo attribute;
 			attr_info_init(&attribute, CONTEXT->id, (yyvsp[-3].number), (yyvsp[-1].number), 0);
@@ -1617,11 +1686,11 @@ yyreduce:
 			// CONTEXT->ssql->sstr.create_table.attributes[CONTEXT->value_length].length = $4;
 			CONTEXT->value_length++;
 		}
-#line 1621 "yacc_sql.tab.c"
+#line 1690 "yacc_sql.tab.c"
     break;
 
-  case 39: /* attr_def: ID_get type  */
-#line 324 "yacc_sql.y"
+  case 45: /* attr_def: ID_get type  */
+#line 363 "yacc_sql.y"
                 {
 			// default: not null
 			AttrInfo attribute;
@@ -1633,78 +1702,78 @@ yyreduce:
 			// CONTEXT->ssql->sstr.create_table.attributes[CONTEXT->value_length].length=4; // default attribute length
 			CONTEXT->value_length++;
 		}
-#line 1637 "yacc_sql.tab.c"
+#line 1706 "yacc_sql.tab.c"
     break;
 
-  case 40: /* attr_def: ID_get type NOT_T NULL_T  */
-#line 336 "yacc_sql.y"
+  case 46: /* attr_def: ID_get type NOT_T NULL_T  */
+#line 375 "yacc_sql.y"
                 {
 			AttrInfo attribute;
 			attr_info_init(&attribute, CONTEXT->id, (yyvsp[-2].number), 4, 0);
 			create_table_append_attribute(&CONTEXT->ssql->sstr.create_table, &attribute);
 			CONTEXT->value_length++;
 		}
-#line 1648 "yacc_sql.tab.c"
+#line 1717 "yacc_sql.tab.c"
     break;
 
-  case 41: /* attr_def: ID_get type NULLABLE_T  */
-#line 343 "yacc_sql.y"
+  case 47: /* attr_def: ID_get type NULLABLE_T  */
+#line 382 "yacc_sql.y"
                 {
 			AttrInfo attribute;
 			attr_info_init(&attribute, CONTEXT->id, (yyvsp[-1].number), 4, 1);
 			create_table_append_attribute(&CONTEXT->ssql->sstr.create_table, &attribute);
 			CONTEXT->value_length++;
 		}
-#line 1659 "yacc_sql.tab.c"
+#line 1728 "yacc_sql.tab.c"
     break;
 
-  case 42: /* number: NUMBER  */
-#line 352 "yacc_sql.y"
+  case 48: /* number: NUMBER  */
+#line 391 "yacc_sql.y"
                        {(yyval.number) = (yyvsp[0].number);}
-#line 1665 "yacc_sql.tab.c"
+#line 1734 "yacc_sql.tab.c"
     break;
 
-  case 43: /* type: INT_T  */
-#line 355 "yacc_sql.y"
+  case 49: /* type: INT_T  */
+#line 394 "yacc_sql.y"
               { (yyval.number)=INTS; }
-#line 1671 "yacc_sql.tab.c"
+#line 1740 "yacc_sql.tab.c"
     break;
 
-  case 44: /* type: STRING_T  */
-#line 356 "yacc_sql.y"
+  case 50: /* type: STRING_T  */
+#line 395 "yacc_sql.y"
                   { (yyval.number)=CHARS; }
-#line 1677 "yacc_sql.tab.c"
+#line 1746 "yacc_sql.tab.c"
     break;
 
-  case 45: /* type: FLOAT_T  */
-#line 357 "yacc_sql.y"
+  case 51: /* type: FLOAT_T  */
+#line 396 "yacc_sql.y"
                  { (yyval.number)=FLOATS; }
-#line 1683 "yacc_sql.tab.c"
+#line 1752 "yacc_sql.tab.c"
     break;
 
-  case 46: /* type: DATE_T  */
-#line 358 "yacc_sql.y"
+  case 52: /* type: DATE_T  */
+#line 397 "yacc_sql.y"
                     { (yyval.number)=DATES; }
-#line 1689 "yacc_sql.tab.c"
+#line 1758 "yacc_sql.tab.c"
     break;
 
-  case 47: /* type: TEXT_T  */
-#line 359 "yacc_sql.y"
+  case 53: /* type: TEXT_T  */
+#line 398 "yacc_sql.y"
                     { (yyval.number)=TEXTS; }
-#line 1695 "yacc_sql.tab.c"
+#line 1764 "yacc_sql.tab.c"
     break;
 
-  case 48: /* ID_get: ID  */
-#line 363 "yacc_sql.y"
+  case 54: /* ID_get: ID  */
+#line 402 "yacc_sql.y"
         {
 		char *temp=(yyvsp[0].string); 
 		snprintf(CONTEXT->id, sizeof(CONTEXT->id), "%s", temp);
 	}
-#line 1704 "yacc_sql.tab.c"
+#line 1773 "yacc_sql.tab.c"
     break;
 
-  case 49: /* insert: INSERT INTO ID VALUES LBRACE insert_exp value_list RBRACE insert_pair_list SEMICOLON  */
-#line 372 "yacc_sql.y"
+  case 55: /* insert: INSERT INTO ID VALUES LBRACE insert_exp value_list RBRACE insert_pair_list SEMICOLON  */
+#line 411 "yacc_sql.y"
                 {
 			// CONTEXT->values[CONTEXT->value_length++] = *$6;
 
@@ -1720,149 +1789,152 @@ yyreduce:
 			CONTEXT->insert_pair_num=0;
 			CONTEXT->value_length=0;
     }
-#line 1724 "yacc_sql.tab.c"
+#line 1793 "yacc_sql.tab.c"
     break;
 
-  case 50: /* insert_exp: exp  */
-#line 389 "yacc_sql.y"
+  case 56: /* insert_exp: exp  */
+#line 428 "yacc_sql.y"
             { context_value_init((yyvsp[0].ast1), &(CONTEXT->values[CONTEXT->value_length - 1])); }
-#line 1730 "yacc_sql.tab.c"
+#line 1799 "yacc_sql.tab.c"
     break;
 
-  case 51: /* value_list: %empty  */
-#line 393 "yacc_sql.y"
+  case 57: /* value_list: %empty  */
+#line 432 "yacc_sql.y"
                 {
 		// 递增pair_num, 清零value_length
 		inserts_append_values(&CONTEXT->ssql->sstr.insertion, CONTEXT->insert_pair_num++, CONTEXT->values, CONTEXT->value_length);
 		CONTEXT->value_length=0;
 	}
-#line 1740 "yacc_sql.tab.c"
+#line 1809 "yacc_sql.tab.c"
     break;
 
-  case 55: /* value: NUMBER  */
-#line 407 "yacc_sql.y"
+  case 61: /* value: NUMBER  */
+#line 446 "yacc_sql.y"
           {	
   		value_init_integer(&CONTEXT->values[CONTEXT->value_length++], (yyvsp[0].number));
   		(yyval.value1) = &CONTEXT->values[CONTEXT->value_length - 1];
+  		context_add_literal(CONTEXT, (yyval.value1)->data);
 		}
-#line 1749 "yacc_sql.tab.c"
+#line 1819 "yacc_sql.tab.c"
     break;
 
-  case 56: /* value: FLOAT  */
-#line 411 "yacc_sql.y"
+  case 62: /* value: FLOAT  */
+#line 451 "yacc_sql.y"
           {
   		value_init_float(&CONTEXT->values[CONTEXT->value_length++], (yyvsp[0].floats));
   		(yyval.value1) = &CONTEXT->values[CONTEXT->value_length - 1];
+  		context_add_literal(CONTEXT, (yyval.value1)->data);
 		}
-#line 1758 "yacc_sql.tab.c"
+#line 1829 "yacc_sql.tab.c"
     break;
 
-  case 57: /* value: SSS  */
-#line 415 "yacc_sql.y"
+  case 63: /* value: SSS  */
+#line 456 "yacc_sql.y"
          {
   		(yyvsp[0].string) = substr((yyvsp[0].string),1,strlen((yyvsp[0].string))-2);
   		value_init_string(&CONTEXT->values[CONTEXT->value_length++], (yyvsp[0].string));
   		(yyval.value1) = &CONTEXT->values[CONTEXT->value_length - 1];
+  		context_add_literal(CONTEXT, (yyval.value1)->data);
 		}
-#line 1768 "yacc_sql.tab.c"
+#line 1840 "yacc_sql.tab.c"
     break;
 
-  case 58: /* value: NULL_T  */
-#line 420 "yacc_sql.y"
+  case 64: /* value: NULL_T  */
+#line 462 "yacc_sql.y"
                 {
 		value_init_null(&CONTEXT->values[CONTEXT->value_length++]);
   		(yyval.value1) = &CONTEXT->values[CONTEXT->value_length - 1];
 		}
-#line 1777 "yacc_sql.tab.c"
+#line 1849 "yacc_sql.tab.c"
     break;
 
-  case 59: /* exp: exp ADD exp  */
-#line 427 "yacc_sql.y"
+  case 65: /* exp: exp ADD exp  */
+#line 469 "yacc_sql.y"
                     { (yyval.ast1) = newast(ADDN, (yyvsp[-2].ast1), (yyvsp[0].ast1)); }
-#line 1783 "yacc_sql.tab.c"
+#line 1855 "yacc_sql.tab.c"
     break;
 
-  case 60: /* exp: SUB exp  */
-#line 428 "yacc_sql.y"
+  case 66: /* exp: SUB exp  */
+#line 470 "yacc_sql.y"
                   { (yyval.ast1) = newast(SUBN, NULL, (yyvsp[0].ast1)); }
-#line 1789 "yacc_sql.tab.c"
+#line 1861 "yacc_sql.tab.c"
     break;
 
-  case 61: /* exp: exp SUB exp  */
-#line 429 "yacc_sql.y"
+  case 67: /* exp: exp SUB exp  */
+#line 471 "yacc_sql.y"
                       { (yyval.ast1) = newast(SUBN, (yyvsp[-2].ast1), (yyvsp[0].ast1)); }
-#line 1795 "yacc_sql.tab.c"
+#line 1867 "yacc_sql.tab.c"
     break;
 
-  case 62: /* exp: exp STAR exp  */
-#line 430 "yacc_sql.y"
+  case 68: /* exp: exp STAR exp  */
+#line 472 "yacc_sql.y"
                        { (yyval.ast1) = newast(MULN, (yyvsp[-2].ast1), (yyvsp[0].ast1)); }
-#line 1801 "yacc_sql.tab.c"
+#line 1873 "yacc_sql.tab.c"
     break;
 
-  case 63: /* exp: exp DIV exp  */
-#line 431 "yacc_sql.y"
+  case 69: /* exp: exp DIV exp  */
+#line 473 "yacc_sql.y"
                       { (yyval.ast1) = newast(DIVN, (yyvsp[-2].ast1), (yyvsp[0].ast1)); }
-#line 1807 "yacc_sql.tab.c"
+#line 1879 "yacc_sql.tab.c"
     break;
 
-  case 64: /* exp: LBRACE exp RBRACE  */
-#line 432 "yacc_sql.y"
+  case 70: /* exp: LBRACE exp RBRACE  */
+#line 474 "yacc_sql.y"
                             {
 		ast *a = (ast *)(yyvsp[-1].ast1);
 		a->l_brace++;
 		a->r_brace++;
 		(yyval.ast1) = (yyvsp[-1].ast1);
 	}
-#line 1818 "yacc_sql.tab.c"
+#line 1890 "yacc_sql.tab.c"
     break;
 
-  case 65: /* exp: value  */
-#line 438 "yacc_sql.y"
+  case 71: /* exp: value  */
+#line 480 "yacc_sql.y"
                 { (yyval.ast1) = newvalNode((yyvsp[0].value1)); }
-#line 1824 "yacc_sql.tab.c"
+#line 1896 "yacc_sql.tab.c"
     break;
 
-  case 66: /* exp: ID  */
-#line 439 "yacc_sql.y"
+  case 72: /* exp: ID  */
+#line 481 "yacc_sql.y"
              {
 		RelAttr attr;
 		relation_attr_init(&attr, NULL, (yyvsp[0].string));
 		(yyval.ast1) = newattrNode(&attr);
 	}
-#line 1834 "yacc_sql.tab.c"
+#line 1906 "yacc_sql.tab.c"
     break;
 
-  case 67: /* exp: ID DOT ID  */
-#line 444 "yacc_sql.y"
+  case 73: /* exp: ID DOT ID  */
+#line 486 "yacc_sql.y"
                     {
 		RelAttr attr;
 		relation_attr_init(&attr, (yyvsp[-2].string), (yyvsp[0].string));
 		(yyval.ast1) = newattrNode(&attr);
 	}
-#line 1844 "yacc_sql.tab.c"
+#line 1916 "yacc_sql.tab.c"
     break;
 
-  case 68: /* exp: ID DOT STAR  */
-#line 449 "yacc_sql.y"
+  case 74: /* exp: ID DOT STAR  */
+#line 491 "yacc_sql.y"
                       {
 		RelAttr attr;
 		relation_attr_init(&attr, (yyvsp[-2].string), "*");
 		(yyval.ast1) = newattrNode(&attr);
 	}
-#line 1854 "yacc_sql.tab.c"
+#line 1926 "yacc_sql.tab.c"
     break;
 
-  case 69: /* delete_begin: DELETE  */
-#line 457 "yacc_sql.y"
+  case 75: /* delete_begin: DELETE  */
+#line 499 "yacc_sql.y"
            {
     	CONTEXT->select_length++;
     }
-#line 1862 "yacc_sql.tab.c"
+#line 1934 "yacc_sql.tab.c"
     break;
 
-  case 70: /* delete: delete_begin FROM ID where SEMICOLON  */
-#line 464 "yacc_sql.y"
+  case 76: /* delete: delete_begin FROM ID where SEMICOLON  */
+#line 506 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag = SCF_DELETE;//"delete";
 			deletes_init_relation(&CONTEXT->ssql->sstr.deletion, (yyvsp[-2].string));
@@ -1870,19 +1942,19 @@ yyreduce:
 					CONTEXT->conditions[0], CONTEXT->condition_length[0]);
 			CONTEXT->condition_length[0] = 0;
     }
-#line 1874 "yacc_sql.tab.c"
+#line 1946 "yacc_sql.tab.c"
     break;
 
-  case 71: /* update_begin: UPDATE  */
-#line 474 "yacc_sql.y"
+  case 77: /* update_begin: UPDATE  */
+#line 516 "yacc_sql.y"
           {
    	CONTEXT->select_length++;
    }
-#line 1882 "yacc_sql.tab.c"
+#line 1954 "yacc_sql.tab.c"
     break;
 
-  case 72: /* update: update_begin ID SET ID EQ exp where SEMICOLON  */
-#line 481 "yacc_sql.y"
+  case 78: /* update: update_begin ID SET ID EQ exp where SEMICOLON  */
+#line 523 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag = SCF_UPDATE;//"update";
 			context_value_init((yyvsp[-2].ast1), &CONTEXT->values[0]);
@@ -1891,31 +1963,47 @@ yyreduce:
 					CONTEXT->conditions[0], CONTEXT->condition_length[0]);
 			CONTEXT->condition_length[0] = 0;
 		}
-#line 1895 "yacc_sql.tab.c"
+#line 1967 "yacc_sql.tab.c"
     break;
 
-  case 73: /* select_begin: SELECT  */
-#line 492 "yacc_sql.y"
+  case 79: /* select_begin: SELECT  */
+#line 534 "yacc_sql.y"
            {
     	CONTEXT->select_length++;
     	clear_selects(&CONTEXT->selects[CONTEXT->select_length-1]);
     }
-#line 1904 "yacc_sql.tab.c"
+#line 1976 "yacc_sql.tab.c"
     break;
 
-  case 75: /* select_clause: select SEMICOLON  */
-#line 503 "yacc_sql.y"
+  case 81: /* select_clause: select SEMICOLON  */
+#line 545 "yacc_sql.y"
                          {
 		// 解决 shift/reduce冲突
 	}
-#line 1912 "yacc_sql.tab.c"
+#line 1984 "yacc_sql.tab.c"
+    break;
+
+  case 82: /* explain: EXPLAIN select_clause  */
+#line 551 "yacc_sql.y"
+                              {
+		CONTEXT->ssql->explain = EXPLAIN_PLAN;
+	}
+#line 1992 "yacc_sql.tab.c"
+    break;
+
+  case 83: /* explain: EXPLAIN ANALYZE select_clause  */
+#line 554 "yacc_sql.y"
+                                        {
+		CONTEXT->ssql->explain = EXPLAIN_ANALYZE;
+	}
+#line 2000 "yacc_sql.tab.c"
     break;
 
-  case 76: /* select: select_begin select_attr FROM ID rel_list inner_join_list where group_by order_by select_end  */
-#line 510 "yacc_sql.y"
+  case 84: /* select: select_begin select_attr FROM ID rel_list inner_join_list where group_by order_by limit select_end  */
+#line 561 "yacc_sql.y"
                 {
 			// CONTEXT->ssql->sstr.selection.relations[CONTEXT->from_length++]=$4;
-			selects_append_relation(&CONTEXT->selects[CONTEXT->select_length-1], (yyvsp[-6].string));
+			selects_append_relation(&CONTEXT->selects[CONTEXT->select_length-1], (yyvsp[-7].string));
 
 			selects_append_conditions(&CONTEXT->selects[CONTEXT->select_length-1], CONTEXT->conditions[CONTEXT->select_length-1], CONTEXT->condition_length[CONTEXT->select_length-1]);
 
@@ -1932,47 +2020,47 @@ yyreduce:
     			show_selects(CONTEXT->selects, CONTEXT->select_length-1);
     			CONTEXT->select_length--;
 	}
-#line 1936 "yacc_sql.tab.c"
+#line 2024 "yacc_sql.tab.c"
     break;
 
-  case 77: /* select_attr: STAR  */
-#line 532 "yacc_sql.y"
+  case 85: /* select_attr: STAR  */
+#line 583 "yacc_sql.y"
          {  
 			RelAttr attr;
 			relation_attr_init(&attr, NULL, "*");
 			selects_append_attribute(&CONTEXT->selects[CONTEXT->select_length-1], &attr);
 		}
-#line 1946 "yacc_sql.tab.c"
+#line 2034 "yacc_sql.tab.c"
     break;
 
-  case 78: /* select_attr: exp attr_list  */
-#line 537 "yacc_sql.y"
+  case 86: /* select_attr: exp attr_list  */
+#line 588 "yacc_sql.y"
                         {
 		selects_append_attribute_expression(&CONTEXT->selects[CONTEXT->select_length-1], (yyvsp[-1].ast1));
 	}
-#line 1954 "yacc_sql.tab.c"
+#line 2042 "yacc_sql.tab.c"
     break;
 
-  case 81: /* attr_list: COMMA exp attr_list  */
-#line 545 "yacc_sql.y"
+  case 89: /* attr_list: COMMA exp attr_list  */
+#line 596 "yacc_sql.y"
                           {
 		selects_append_attribute_expression(&CONTEXT->selects[CONTEXT->select_length-1], (yyvsp[-1].ast1));
     }
-#line 1962 "yacc_sql.tab.c"
+#line 2050 "yacc_sql.tab.c"
     break;
 
-  case 83: /* aggre_func: aggre_type LBRACE exp RBRACE  */
-#line 552 "yacc_sql.y"
+  case 91: /* aggre_func: aggre_type LBRACE exp RBRACE  */
+#line 603 "yacc_sql.y"
                                      {
 		Aggregate aggre;
 		relation_aggre_init_with_exp(&aggre, CONTEXT->aggreType[CONTEXT->select_length-1], (yyvsp[-1].ast1));
 		selects_append_aggregate(&CONTEXT->selects[CONTEXT->select_length-1], &aggre);
 	  }
-#line 1972 "yacc_sql.tab.c"
+#line 2060 "yacc_sql.tab.c"
     break;
 
-  case 84: /* aggre_func: aggre_type LBRACE STAR RBRACE  */
-#line 557 "yacc_sql.y"
+  case 92: /* aggre_func: aggre_type LBRACE STAR RBRACE  */
+#line 608 "yacc_sql.y"
                                         {
 		// TODO(wq):仅需要支持 select COUNT(*)，不需要支持select other_aggre(*) 以及select aggre_func(table_name.*);
 		// 由于如果在语法解析里处理该问题的话，代码写的比较冗余丑陋，所以这里不检查sum(*)等这种不合法情况，丢给parse之后的stage去检验
@@ -1980,49 +2068,49 @@ yyreduce:
 		relation_aggre_init(&aggre, CONTEXT->aggreType[CONTEXT->select_length-1], 1, NULL, "*", NULL);
 		selects_append_aggregate(&CONTEXT->selects[CONTEXT->select_length-1], &aggre);
 	}
-#line 1984 "yacc_sql.tab.c"
+#line 2072 "yacc_sql.tab.c"
     break;
 
-  case 85: /* aggre_type: MAX_T  */
-#line 567 "yacc_sql.y"
+  case 93: /* aggre_type: MAX_T  */
+#line 618 "yacc_sql.y"
                 { CONTEXT->aggreType[CONTEXT->select_length-1] = MAXS; }
-#line 1990 "yacc_sql.tab.c"
+#line 2078 "yacc_sql.tab.c"
     break;
 
-  case 86: /* aggre_type: MIN_T  */
-#line 568 "yacc_sql.y"
+  case 94: /* aggre_type: MIN_T  */
+#line 619 "yacc_sql.y"
                 { CONTEXT->aggreType[CONTEXT->select_length-1] = MINS; }
-#line 1996 "yacc_sql.tab.c"
+#line 2084 "yacc_sql.tab.c"
     break;
 
-  case 87: /* aggre_type: AVG_T  */
-#line 569 "yacc_sql.y"
+  case 95: /* aggre_type: AVG_T  */
+#line 620 "yacc_sql.y"
                 { CONTEXT->aggreType[CONTEXT->select_length-1] = AVGS; }
-#line 2002 "yacc_sql.tab.c"
+#line 2090 "yacc_sql.tab.c"
     break;
 
-  case 88: /* aggre_type: SUM_T  */
-#line 570 "yacc_sql.y"
+  case 96: /* aggre_type: SUM_T  */
+#line 621 "yacc_sql.y"
                 { CONTEXT->aggreType[CONTEXT->select_length-1] = SUMS; }
-#line 2008 "yacc_sql.tab.c"
+#line 2096 "yacc_sql.tab.c"
     break;
 
-  case 89: /* aggre_type: COUNT_T  */
-#line 571 "yacc_sql.y"
+  case 97: /* aggre_type: COUNT_T  */
+#line 622 "yacc_sql.y"
                   { CONTEXT->aggreType[CONTEXT->select_length-1] = COUNTS; }
-#line 2014 "yacc_sql.tab.c"
+#line 2102 "yacc_sql.tab.c"
     break;
 
-  case 91: /* rel_list: COMMA ID rel_list  */
-#line 576 "yacc_sql.y"
+  case 99: /* rel_list: COMMA ID rel_list  */
+#line 627 "yacc_sql.y"
                         {	
 				selects_append_relation(&CONTEXT->selects[CONTEXT->select_length-1], (yyvsp[-1].string));
 		  }
-#line 2022 "yacc_sql.tab.c"
+#line 2110 "yacc_sql.tab.c"
     break;
 
-  case 92: /* inner_join: INNER JOIN ID ON join_condition join_condition_list  */
-#line 582 "yacc_sql.y"
+  case 100: /* inner_join: INNER JOIN ID ON join_condition join_condition_list  */
+#line 633 "yacc_sql.y"
                                                         {
     	Join join;
     	join_init(&join, INNER_JOIN, (yyvsp[-3].string), CONTEXT->join_conditions[CONTEXT->select_length-1], CONTEXT->join_condition_length[CONTEXT->select_length-1]);
@@ -2030,272 +2118,289 @@ yyreduce:
     	// 清空变量
     	CONTEXT->join_condition_length[CONTEXT->select_length-1] = 0;
     }
-#line 2034 "yacc_sql.tab.c"
+#line 2122 "yacc_sql.tab.c"
     break;
 
-  case 94: /* inner_join_list: inner_join inner_join_list  */
-#line 593 "yacc_sql.y"
+  case 102: /* inner_join_list: inner_join inner_join_list  */
+#line 644 "yacc_sql.y"
                                   {
 
     }
-#line 2042 "yacc_sql.tab.c"
+#line 2130 "yacc_sql.tab.c"
     break;
 
-  case 96: /* join_condition_list: AND join_condition join_condition_list  */
-#line 600 "yacc_sql.y"
+  case 104: /* join_condition_list: AND join_condition join_condition_list  */
+#line 651 "yacc_sql.y"
                                               {
 
      }
-#line 2050 "yacc_sql.tab.c"
+#line 2138 "yacc_sql.tab.c"
     break;
 
-  case 97: /* join_condition: exp comOp exp  */
-#line 605 "yacc_sql.y"
+  case 105: /* join_condition: exp comOp exp  */
+#line 656 "yacc_sql.y"
                   {
 		Condition condition;
 		condition_init(&condition, CONTEXT->comp[CONTEXT->select_length-1], (yyvsp[-2].ast1), (yyvsp[0].ast1), NULL, NULL);
 		CONTEXT->join_conditions[CONTEXT->select_length-1][CONTEXT->join_condition_length[CONTEXT->select_length-1]++] = condition;
     }
-#line 2060 "yacc_sql.tab.c"
+#line 2148 "yacc_sql.tab.c"
     break;
 
-  case 98: /* join_condition: exp comOp right_sub_select  */
-#line 610 "yacc_sql.y"
+  case 106: /* join_condition: exp comOp right_sub_select  */
+#line 661 "yacc_sql.y"
                                  {
 		Condition condition;
 		condition_init(&condition, CONTEXT->comp[CONTEXT->select_length-1], (yyvsp[-2].ast1), NULL, NULL, &CONTEXT->right_sub_select);
     	CONTEXT->join_conditions[CONTEXT->select_length-1][CONTEXT->condition_length[CONTEXT->select_length-1]++] = condition;
     	}
-#line 2070 "yacc_sql.tab.c"
+#line 2158 "yacc_sql.tab.c"
     break;
 
-  case 99: /* join_condition: left_sub_select comOp exp  */
-#line 615 "yacc_sql.y"
+  case 107: /* join_condition: left_sub_select comOp exp  */
+#line 666 "yacc_sql.y"
                                 {
 		Condition condition;
 		condition_init(&condition, CONTEXT->comp[CONTEXT->select_length-1], NULL, (yyvsp[0].ast1), &CONTEXT->left_sub_select, NULL);
     	CONTEXT->join_conditions[CONTEXT->select_length-1][CONTEXT->condition_length[CONTEXT->select_length-1]++] = condition;
         }
-#line 2080 "yacc_sql.tab.c"
+#line 2168 "yacc_sql.tab.c"
     break;
 
-  case 100: /* join_condition: left_sub_select comOp right_sub_select  */
-#line 620 "yacc_sql.y"
+  case 108: /* join_condition: left_sub_select comOp right_sub_select  */
+#line 671 "yacc_sql.y"
                                               {
 		Condition condition;
 		condition_init(&condition, CONTEXT->comp[CONTEXT->select_length-1], NULL, NULL,  &CONTEXT->left_sub_select, &CONTEXT->right_sub_select);
     	CONTEXT->join_conditions[CONTEXT->select_length-1][CONTEXT->condition_length[CONTEXT->select_length-1]++] = condition;
     }
-#line 2090 "yacc_sql.tab.c"
+#line 2178 "yacc_sql.tab.c"
     break;
 
-  case 102: /* where: WHERE condition condition_list  */
-#line 629 "yacc_sql.y"
+  case 110: /* where: WHERE condition condition_list  */
+#line 680 "yacc_sql.y"
                                      {	
 				// CONTEXT->conditions[CONTEXT->condition_length++]=*$2;
 			}
-#line 2098 "yacc_sql.tab.c"
+#line 2186 "yacc_sql.tab.c"
     break;
 
-  case 104: /* condition_list: AND condition condition_list  */
-#line 636 "yacc_sql.y"
+  case 112: /* condition_list: AND condition condition_list  */
+#line 687 "yacc_sql.y"
                                    {
 				// CONTEXT->conditions[CONTEXT->condition_length++]=*$2;
 			}
-#line 2106 "yacc_sql.tab.c"
+#line 2194 "yacc_sql.tab.c"
     break;
 
-  case 105: /* condition: exp comOp exp  */
-#line 642 "yacc_sql.y"
+  case 113: /* condition: exp comOp exp  */
+#line 693 "yacc_sql.y"
                   {
 		Condition condition;
 		condition_init(&condition, CONTEXT->comp[CONTEXT->select_length-1], (yyvsp[-2].ast1), (yyvsp[0].ast1), NULL, NULL);
 		CONTEXT->conditions[CONTEXT->select_length-1][CONTEXT->condition_length[CONTEXT->select_length-1]++] = condition;
 	}
-#line 2116 "yacc_sql.tab.c"
+#line 2204 "yacc_sql.tab.c"
     break;
 
-  case 106: /* condition: exp comOp right_sub_select  */
-#line 647 "yacc_sql.y"
+  case 114: /* condition: exp comOp right_sub_select  */
+#line 698 "yacc_sql.y"
                                  {
 		Condition condition;
 		condition_init(&condition, CONTEXT->comp[CONTEXT->select_length-1], (yyvsp[-2].ast1), NULL, NULL, &CONTEXT->right_sub_select);
 		CONTEXT->conditions[CONTEXT->select_length-1][CONTEXT->condition_length[CONTEXT->select_length-1]++] = condition;
     }
-#line 2126 "yacc_sql.tab.c"
+#line 2214 "yacc_sql.tab.c"
     break;
 
-  case 107: /* condition: left_sub_select comOp exp  */
-#line 652 "yacc_sql.y"
+  case 115: /* condition: left_sub_select comOp exp  */
+#line 703 "yacc_sql.y"
                                 {
 		Condition condition;
 		condition_init(&condition, CONTEXT->comp[CONTEXT->select_length-1], NULL, (yyvsp[0].ast1), &CONTEXT->left_sub_select, NULL);
 		CONTEXT->conditions[CONTEXT->select_length-1][CONTEXT->condition_length[CONTEXT->select_length-1]++] = condition;
     }
-#line 2136 "yacc_sql.tab.c"
+#line 2224 "yacc_sql.tab.c"
     break;
 
-  case 108: /* condition: left_sub_select comOp right_sub_select  */
-#line 657 "yacc_sql.y"
+  case 116: /* condition: left_sub_select comOp right_sub_select  */
+#line 708 "yacc_sql.y"
                                              {
 		Condition condition;
 		condition_init(&condition, CONTEXT->comp[CONTEXT->select_length-1], NULL, NULL, &CONTEXT->left_sub_select, &CONTEXT->right_sub_select);
 		CONTEXT->conditions[CONTEXT->select_length-1][CONTEXT->condition_length[CONTEXT->select_length-1]++] = condition;
     }
-#line 2146 "yacc_sql.tab.c"
+#line 2234 "yacc_sql.tab.c"
     break;
 
-  case 109: /* left_sub_select: LBRACE select RBRACE  */
-#line 665 "yacc_sql.y"
+  case 117: /* left_sub_select: LBRACE select RBRACE  */
+#line 716 "yacc_sql.y"
                          {
     	CONTEXT->left_sub_select = CONTEXT->selects[CONTEXT->select_length];
     }
-#line 2154 "yacc_sql.tab.c"
+#line 2242 "yacc_sql.tab.c"
     break;
 
-  case 110: /* right_sub_select: LBRACE select RBRACE  */
-#line 671 "yacc_sql.y"
+  case 118: /* right_sub_select: LBRACE select RBRACE  */
+#line 722 "yacc_sql.y"
                          {
     	CONTEXT->right_sub_select = CONTEXT->selects[CONTEXT->select_length];
     }
-#line 2162 "yacc_sql.tab.c"
+#line 2250 "yacc_sql.tab.c"
     break;
 
-  case 111: /* comOp: EQ  */
-#line 677 "yacc_sql.y"
+  case 119: /* comOp: EQ  */
+#line 728 "yacc_sql.y"
              { CONTEXT->comp[CONTEXT->select_length-1] = EQUAL_TO; }
-#line 2168 "yacc_sql.tab.c"
+#line 2256 "yacc_sql.tab.c"
     break;
 
-  case 112: /* comOp: LT  */
-#line 678 "yacc_sql.y"
+  case 120: /* comOp: LT  */
+#line 729 "yacc_sql.y"
          { CONTEXT->comp[CONTEXT->select_length-1] = LESS_THAN; }
-#line 2174 "yacc_sql.tab.c"
+#line 2262 "yacc_sql.tab.c"
     break;
 
-  case 113: /* comOp: GT  */
-#line 679 "yacc_sql.y"
+  case 121: /* comOp: GT  */
+#line 730 "yacc_sql.y"
          { CONTEXT->comp[CONTEXT->select_length-1] = GREAT_THAN; }
-#line 2180 "yacc_sql.tab.c"
+#line 2268 "yacc_sql.tab.c"
     break;
 
-  case 114: /* comOp: LE  */
-#line 680 "yacc_sql.y"
+  case 122: /* comOp: LE  */
+#line 731 "yacc_sql.y"
          { CONTEXT->comp[CONTEXT->select_length-1] = LESS_EQUAL; }
-#line 2186 "yacc_sql.tab.c"
+#line 2274 "yacc_sql.tab.c"
     break;
 
-  case 115: /* comOp: GE  */
-#line 681 "yacc_sql.y"
+  case 123: /* comOp: GE  */
+#line 732 "yacc_sql.y"
          { CONTEXT->comp[CONTEXT->select_length-1] = GREAT_EQUAL; }
-#line 2192 "yacc_sql.tab.c"
+#line 2280 "yacc_sql.tab.c"
     break;
 
-  case 116: /* comOp: NE  */
-#line 682 "yacc_sql.y"
+  case 124: /* comOp: NE  */
+#line 733 "yacc_sql.y"
          { CONTEXT->comp[CONTEXT->select_length-1] = NOT_EQUAL; }
-#line 2198 "yacc_sql.tab.c"
+#line 2286 "yacc_sql.tab.c"
     break;
 
-  case 117: /* comOp: IS_T  */
-#line 683 "yacc_sql.y"
+  case 125: /* comOp: IS_T  */
+#line 734 "yacc_sql.y"
                { CONTEXT->comp[CONTEXT->select_length-1] = IS; }
-#line 2204 "yacc_sql.tab.c"
+#line 2292 "yacc_sql.tab.c"
     break;
 
-  case 118: /* comOp: IS_T NOT_T  */
-#line 684 "yacc_sql.y"
+  case 126: /* comOp: IS_T NOT_T  */
+#line 735 "yacc_sql.y"
                      { CONTEXT->comp[CONTEXT->select_length-1] = IS_NOT; }
-#line 2210 "yacc_sql.tab.c"
+#line 2298 "yacc_sql.tab.c"
     break;
 
-  case 119: /* comOp: IN  */
-#line 685 "yacc_sql.y"
+  case 127: /* comOp: IN  */
+#line 736 "yacc_sql.y"
         { CONTEXT->comp[CONTEXT->select_length-1] = IN_OP; }
-#line 2216 "yacc_sql.tab.c"
+#line 2304 "yacc_sql.tab.c"
     break;
 
-  case 120: /* comOp: NOT_T IN  */
-#line 686 "yacc_sql.y"
+  case 128: /* comOp: NOT_T IN  */
+#line 737 "yacc_sql.y"
               { CONTEXT->comp[CONTEXT->select_length-1] = NOT_IN_OP; }
-#line 2222 "yacc_sql.tab.c"
+#line 2310 "yacc_sql.tab.c"
     break;
 
-  case 123: /* order_item: ID order  */
-#line 695 "yacc_sql.y"
+  case 131: /* order_item: ID order  */
+#line 746 "yacc_sql.y"
                  {
 		RelAttr attr;
 		relation_attr_init(&attr, NULL, (yyvsp[-1].string));
 		selects_append_order(&CONTEXT->selects[CONTEXT->select_length-1], &attr, CONTEXT->order);
 	}
-#line 2232 "yacc_sql.tab.c"
+#line 2320 "yacc_sql.tab.c"
     break;
 
-  case 124: /* order_item: ID DOT ID order  */
-#line 700 "yacc_sql.y"
+  case 132: /* order_item: ID DOT ID order  */
+#line 751 "yacc_sql.y"
                           {
 		RelAttr attr;
 		relation_attr_init(&attr, (yyvsp[-3].string), (yyvsp[-1].string));
 		selects_append_order(&CONTEXT->selects[CONTEXT->select_length-1], &attr, CONTEXT->order);
 	}
-#line 2242 "yacc_sql.tab.c"
+#line 2330 "yacc_sql.tab.c"
     break;
 
-  case 125: /* order: %empty  */
-#line 708 "yacc_sql.y"
+  case 133: /* order: %empty  */
+#line 759 "yacc_sql.y"
                     {
 		CONTEXT->order = 0;
 	}
-#line 2250 "yacc_sql.tab.c"
+#line 2338 "yacc_sql.tab.c"
     break;
 
-  case 126: /* order: ASC  */
-#line 711 "yacc_sql.y"
+  case 134: /* order: ASC  */
+#line 762 "yacc_sql.y"
               {
 		CONTEXT->order = 0;
 	}
-#line 2258 "yacc_sql.tab.c"
+#line 2346 "yacc_sql.tab.c"
     break;
 
-  case 127: /* order: DESC  */
-#line 714 "yacc_sql.y"
+  case 135: /* order: DESC  */
+#line 765 "yacc_sql.y"
                {
 		CONTEXT->order = 1;
 	}
-#line 2266 "yacc_sql.tab.c"
+#line 2354 "yacc_sql.tab.c"
     break;
 
-  case 132: /* group_item: ID  */
-#line 730 "yacc_sql.y"
+  case 139: /* limit: LIMIT NUMBER  */
+#line 777 "yacc_sql.y"
+                       {
+		selects_set_limit(&CONTEXT->selects[CONTEXT->select_length-1], (yyvsp[0].number));
+	}
+#line 2362 "yacc_sql.tab.c"
+    break;
+
+  case 142: /* group_item: ID  */
+#line 788 "yacc_sql.y"
            {
 		RelAttr attr;
 		relation_attr_init(&attr, NULL, (yyvsp[0].string));
 		selects_append_group(&CONTEXT->selects[CONTEXT->select_length-1], &attr);
 	}
-#line 2276 "yacc_sql.tab.c"
+#line 2372 "yacc_sql.tab.c"
     break;
 
-  case 133: /* group_item: ID DOT ID  */
-#line 735 "yacc_sql.y"
+  case 143: /* group_item: ID DOT ID  */
+#line 793 "yacc_sql.y"
                     {
 		RelAttr attr;
 		relation_attr_init(&attr, (yyvsp[-2].string), (yyvsp[0].string));
 		selects_append_group(&CONTEXT->selects[CONTEXT->select_length-1], &attr);
 	}
-#line 2286 "yacc_sql.tab.c"
+#line 2382 "yacc_sql.tab.c"
     break;
 
-  case 136: /* load_data: LOAD DATA INFILE SSS INTO TABLE ID SEMICOLON  */
-#line 750 "yacc_sql.y"
+  case 146: /* load_data: LOAD DATA INFILE SSS INTO TABLE ID SEMICOLON  */
+#line 808 "yacc_sql.y"
                 {
 		  CONTEXT->ssql->flag = SCF_LOAD_DATA;
 			load_data_init(&CONTEXT->ssql->sstr.load_data, (yyvsp[-1].string), (yyvsp[-4].string));
 		}
-#line 2295 "yacc_sql.tab.c"
+#line 2391 "yacc_sql.tab.c"
+    break;
+
+  case 147: /* set_variable: SET ID EQ value SEMICOLON  */
+#line 816 "yacc_sql.y"
+                {
+			CONTEXT->ssql->flag = SCF_SET_VARIABLE;
+			set_variable_init(&CONTEXT->ssql->sstr.set_variable, (yyvsp[-3].string), (yyvsp[-1].value1));
+		}
+#line 2400 "yacc_sql.tab.c"
     break;
 
 
-#line 2299 "yacc_sql.tab.c"
+#line 2404 "yacc_sql.tab.c"
 
       default: break;
     }
@@ -2377,6 +2482,7 @@ yyerrorlab:
      label yyerrorlab therefore never appears in user code.  */
   if (0)
     YYERROR;
+  ++yynerrs;
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
@@ -2437,7 +2543,7 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
 /*-----------------------------------.
@@ -2445,24 +2551,22 @@ yyacceptlab:
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
-#if !defined yyoverflow
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (scanner, YY_("memory exhausted"));
   yyresult = 2;
-  goto yyreturn;
-#endif
+  goto yyreturnlab;
 
 
-/*-------------------------------------------------------.
-| yyreturn -- parsing is finished, clean up and return.  |
-`-------------------------------------------------------*/
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -2489,18 +2593,22 @@ yyreturn:
   return yyresult;
 }
 
-#line 755 "yacc_sql.y"
+#line 821 "yacc_sql.y"
 
 //_____________________________________________________________________
 extern void scan_string(const char *str, yyscan_t scanner);
 
-int sql_parse(const char *s, Query *sqls){
+int sql_parse(const char *s, Query *sqls, ParsedLiterals *literals){
 	ParserContext context;
 	memset(&context, 0, sizeof(context));
 
 	yyscan_t scanner;
 	yylex_init_extra(&context, &scanner);
 	context.ssql = sqls;
+	context.literals = literals;
+	if (literals != NULL) {
+		literals->literal_num = 0;
+	}
 	scan_string(s, scanner);
 	int result = yyparse(scanner);
 	yylex_destroy(scanner);
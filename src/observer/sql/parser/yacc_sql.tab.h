@@ -1,8 +1,8 @@
-/* A Bison parser, made by GNU Bison 3.7.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2020 Free Software Foundation,
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
    Inc.
 
    This program is free software: you can redistribute it and/or modify
@@ -16,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -117,13 +117,18 @@ extern int yydebug;
     ADD = 318,                     /* ADD  */
     SUB = 319,                     /* SUB  */
     DIV = 320,                     /* DIV  */
-    STAR = 321,                    /* STAR  */
-    NUMBER = 322,                  /* NUMBER  */
-    FLOAT = 323,                   /* FLOAT  */
-    ID = 324,                      /* ID  */
-    PATH = 325,                    /* PATH  */
-    SSS = 326,                     /* SSS  */
-    STRING_V = 327                 /* STRING_V  */
+    USING = 321,                   /* USING  */
+    HASH = 322,                    /* HASH  */
+    LIMIT = 323,                   /* LIMIT  */
+    ANALYZE = 324,                 /* ANALYZE  */
+    EXPLAIN = 325,                 /* EXPLAIN  */
+    NUMBER = 326,                  /* NUMBER  */
+    FLOAT = 327,                   /* FLOAT  */
+    ID = 328,                      /* ID  */
+    PATH = 329,                    /* PATH  */
+    SSS = 330,                     /* SSS  */
+    STAR = 331,                    /* STAR  */
+    STRING_V = 332                 /* STRING_V  */
   };
   typedef enum yytokentype yytoken_kind_t;
 #endif
@@ -132,7 +137,7 @@ extern int yydebug;
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 158 "yacc_sql.y"
+#line 177 "yacc_sql.y"
 
   struct _Attr *attr;
   struct _Condition *condition1;
@@ -143,7 +148,7 @@ union YYSTYPE
   char *position;
   struct ast *ast1;
 
-#line 147 "yacc_sql.tab.h"
+#line 152 "yacc_sql.tab.h"
 
 };
 typedef union YYSTYPE YYSTYPE;
@@ -153,6 +158,8 @@ typedef union YYSTYPE YYSTYPE;
 
 
 
+
 int yyparse (void *scanner);
 
+
 #endif /* !YY_YY_YACC_SQL_TAB_H_INCLUDED  */
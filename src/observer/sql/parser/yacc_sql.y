@@ -44,6 +44,7 @@ typedef struct ParserContext {
   CompOp comp[MAX_NUM];
   char id[MAX_NUM];
   int order; //0: asc, 1: desc
+  ParsedLiterals *literals;  // 可以为NULL
 } ParserContext;
 
 //获取子串
@@ -68,6 +69,7 @@ void yyerror(yyscan_t scanner, const char *str)
   ParserContext *context = (ParserContext *)(yyget_extra(scanner));
   query_reset(context->ssql);
   context->ssql->flag = SCF_ERROR;
+  context->ssql->explain = EXPLAIN_NONE;
   context->condition_length[0] = 0;
   context->from_length[0] = 0;
   context->select_length = 0;
@@ -84,6 +86,18 @@ ParserContext *get_context(yyscan_t scanner)
 
 #define CONTEXT get_context(scanner)
 
+void context_add_literal(ParserContext *context, void *data)
+{
+  ParsedLiterals *literals = context->literals;
+  if (literals == NULL) {
+    return;
+  }
+  if (literals->literal_num < MAX_LITERAL_NUM) {
+    literals->literals[literals->literal_num] = data;
+  }
+  literals->literal_num++;
+}
+
 %}
 
 %define api.pure full
@@ -154,6 +168,11 @@ ParserContext *get_context(yyscan_t scanner)
 		ADD
 		SUB
 		DIV
+		USING
+		HASH
+		LIMIT
+		ANALYZE
+		EXPLAIN
 
 %union {
   struct _Attr *attr;
@@ -183,6 +202,7 @@ ParserContext *get_context(yyscan_t scanner)
 %type <value1> value;
 %type <number> number;
 %type <ast1> exp
+%type <number> index_using;
 
 %%
 
@@ -193,6 +213,7 @@ commands:		//commands or sqls. parser starts here.
 
 command:
 	  select_clause
+	| explain
 	| insert
 	| update
 	| delete
@@ -200,6 +221,7 @@ command:
 	| drop_table
 	| show_tables
 	| desc_table
+	| analyze_table
 	| create_index	
 	| drop_index
 	| sync
@@ -207,6 +229,7 @@ command:
 	| commit
 	| rollback
 	| load_data
+	| set_variable
 	| help
 	| exit
     ;
@@ -264,21 +287,37 @@ desc_table:
     }
     ;
 
+analyze_table:
+    ANALYZE TABLE ID SEMICOLON {
+      CONTEXT->ssql->flag = SCF_ANALYZE_TABLE;
+      analyze_table_init(&CONTEXT->ssql->sstr.analyze_table, $3);
+    }
+    ;
+
 create_index:		/*create index 语句的语法解析树*/
-    CREATE INDEX ID ON ID LBRACE ID id_list RBRACE SEMICOLON
+    CREATE INDEX ID ON ID LBRACE ID id_list RBRACE index_using SEMICOLON
 		{
 			CONTEXT->ssql->flag = SCF_CREATE_INDEX;//"create_index";
-			create_index_init(&CONTEXT->ssql->sstr.create_index, 0, $3, $5);
+			create_index_init(&CONTEXT->ssql->sstr.create_index, 0, $3, $5, $10);
 			create_index_append_attribute(&CONTEXT->ssql->sstr.create_index, $7);
 		}
-	| CREATE UNIQUE INDEX ID ON ID LBRACE ID RBRACE SEMICOLON 
+	| CREATE UNIQUE INDEX ID ON ID LBRACE ID RBRACE index_using SEMICOLON 
 		{
 			CONTEXT->ssql->flag = SCF_CREATE_INDEX;//"create_index";(unique)
-			create_index_init(&CONTEXT->ssql->sstr.create_index, 1, $4, $6);
+			create_index_init(&CONTEXT->ssql->sstr.create_index, 1, $4, $6, $10);
 			create_index_append_attribute(&CONTEXT->ssql->sstr.create_index, $8);
 		}
     ;
 
+index_using:
+	/* empty */ {
+		$$ = BPLUS_TREE_INDEX;
+	}
+	| USING HASH {
+		$$ = HASH_INDEX;
+	}
+	;
+
 id_list:
 	/* empty */
 	| COMMA ID id_list {
@@ -407,15 +446,18 @@ value:
     NUMBER{	
   		value_init_integer(&CONTEXT->values[CONTEXT->value_length++], $1);
   		$$ = &CONTEXT->values[CONTEXT->value_length - 1];
+  		context_add_literal(CONTEXT, $$->data);
 		}
     |FLOAT{
   		value_init_float(&CONTEXT->values[CONTEXT->value_length++], $1);
   		$$ = &CONTEXT->values[CONTEXT->value_length - 1];
+  		context_add_literal(CONTEXT, $$->data);
 		}
     |SSS {
   		$1 = substr($1,1,strlen($1)-2);
   		value_init_string(&CONTEXT->values[CONTEXT->value_length++], $1);
   		$$ = &CONTEXT->values[CONTEXT->value_length - 1];
+  		context_add_literal(CONTEXT, $$->data);
 		}
 	|NULL_T {
 		value_init_null(&CONTEXT->values[CONTEXT->value_length++]);
@@ -505,8 +547,17 @@ select_clause:
 	}
 	;
 
+explain:
+	EXPLAIN select_clause {
+		CONTEXT->ssql->explain = EXPLAIN_PLAN;
+	}
+	| EXPLAIN ANALYZE select_clause {
+		CONTEXT->ssql->explain = EXPLAIN_ANALYZE;
+	}
+	;
+
 select:				/*  select 语句的语法解析树*/
-    select_begin select_attr FROM ID rel_list inner_join_list where group_by order_by select_end
+    select_begin select_attr FROM ID rel_list inner_join_list where group_by order_by limit select_end
 		{
 			// CONTEXT->ssql->sstr.selection.relations[CONTEXT->from_length++]=$4;
 			selects_append_relation(&CONTEXT->selects[CONTEXT->select_length-1], $4);
@@ -721,6 +772,13 @@ order_item_list:
 	| COMMA order_item order_item_list
 	;
 
+limit:
+	/* empty */
+	| LIMIT NUMBER {
+		selects_set_limit(&CONTEXT->selects[CONTEXT->select_length-1], $2);
+	}
+	;
+
 group_by:
 	/* empty */
 	| GROUP BY group_item group_item_list
@@ -752,17 +810,29 @@ load_data:
 			load_data_init(&CONTEXT->ssql->sstr.load_data, $7, $4);
 		}
 		;
+
+set_variable:
+    SET ID EQ value SEMICOLON
+		{
+			CONTEXT->ssql->flag = SCF_SET_VARIABLE;
+			set_variable_init(&CONTEXT->ssql->sstr.set_variable, $2, $4);
+		}
+		;
 %%
 //_____________________________________________________________________
 extern void scan_string(const char *str, yyscan_t scanner);
 
-int sql_parse(const char *s, Query *sqls){
+int sql_parse(const char *s, Query *sqls, ParsedLiterals *literals){
 	ParserContext context;
 	memset(&context, 0, sizeof(context));
 
 	yyscan_t scanner;
 	yylex_init_extra(&context, &scanner);
 	context.ssql = sqls;
+	context.literals = literals;
+	if (literals != NULL) {
+		literals->literal_num = 0;
+	}
 	scan_string(s, scanner);
 	int result = yyparse(scanner);
 	yylex_destroy(scanner);
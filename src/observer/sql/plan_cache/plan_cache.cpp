@@ -0,0 +1,323 @@
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include <algorithm>
+
+#include "sql/plan_cache/plan_cache.h"
+#include "common/log/log.h"
+#include "storage/common/db.h"
+#include "storage/common/table.h"
+
+static bool is_id_start(char c) {
+  return isalpha((unsigned char)c) || c == '_';
+}
+
+static bool is_id_char(char c) {
+  return isalnum((unsigned char)c) || c == '_';
+}
+
+// 与lex_sql.l中的字符串 {QUOTE}[\40\42\47A-Za-z0-9_/\.\-]*{QUOTE} 相同
+static bool is_string_char(char c) {
+  return c == ' ' || c == '"' || c == '\'' || isalnum((unsigned char)c) || c == '_' || c == '/' || c == '.' ||
+         c == '-';
+}
+
+static bool is_quote(char c) {
+  return c == '\'' || c == '"';
+}
+
+bool normalize_sql(const char *sql, NormalizedSql &normalized, std::vector<size_t> *params) {
+  normalized.text.clear();
+  normalized.literals.clear();
+  if (params != nullptr) {
+    params->clear();
+  }
+
+  std::string last_token;
+  const char *p = sql;
+  while (*p != '\0') {
+    if (*p == ' ' || *p == '\t' || *p == '\b' || *p == '\f' || *p == '\n') {
+      p++;
+      continue;
+    }
+
+    std::string token;
+    if (isdigit((unsigned char)*p)) {
+      const char *begin = p;
+      while (isdigit((unsigned char)*p)) {
+        p++;
+      }
+      NormalizedSql::LiteralType type = NormalizedSql::INT_LITERAL;
+      if (*p == '.' && isdigit((unsigned char)p[1])) {
+        type = NormalizedSql::FLOAT_LITERAL;
+        p++;
+        while (isdigit((unsigned char)*p)) {
+          p++;
+        }
+      }
+      if (type == NormalizedSql::INT_LITERAL && 0 == strcasecmp(last_token.c_str(), "limit")) {
+        token.assign(begin, p - begin);
+      } else {
+        normalized.literals.push_back(NormalizedSql::Literal{type, std::string(begin, p - begin), last_token == "-"});
+        token = type == NormalizedSql::INT_LITERAL ? "?" : "?f";
+      }
+    } else if (is_id_start(*p)) {
+      const char *begin = p;
+      while (is_id_char(*p)) {
+        p++;
+      }
+      token.assign(begin, p - begin);
+    } else if (is_quote(*p)) {
+      // 词法分析取最长的匹配，字符串到允许的字符之内的最后一个引号为止
+      const char *end = nullptr;
+      for (const char *q = p + 1; is_string_char(*q); q++) {
+        if (is_quote(*q)) {
+          end = q;
+        }
+      }
+      if (end == nullptr) {
+        return false;
+      }
+      normalized.literals.push_back(NormalizedSql::Literal{NormalizedSql::STRING_LITERAL, std::string(p + 1, end - p - 1)});
+      token = "'?'";
+      p = end + 1;
+    } else if ((p[0] == '<' && (p[1] == '=' || p[1] == '>')) || (p[0] == '>' && p[1] == '=')) {
+      token.assign(p, 2);
+      p += 2;
+    } else if (*p == '?') {
+      // 与占位符相同，只有预处理语句中可以出现，表示参数
+      if (params == nullptr) {
+        return false;
+      }
+      params->push_back(normalized.literals.size());
+      normalized.literals.push_back(NormalizedSql::Literal{NormalizedSql::INT_LITERAL, std::string()});
+      token = "?p";
+      p++;
+    } else {
+      token.assign(p, 1);
+      p++;
+    }
+
+    if (normalized.text.empty()) {
+      if (0 != strcasecmp(token.c_str(), "select") && 0 != strcasecmp(token.c_str(), "insert") &&
+          0 != strcasecmp(token.c_str(), "update") && 0 != strcasecmp(token.c_str(), "delete")) {
+        return false;
+      }
+    } else {
+      normalized.text += ' ';
+    }
+    normalized.text += token;
+    last_token = std::move(token);
+  }
+  return !normalized.text.empty() && normalized.literals.size() <= MAX_LITERAL_NUM;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// same: 解析得到的值等于常量，negated: 等于常量取反
+static int sign_of(const NormalizedSql::Literal &literal, bool same, bool negated) {
+  if (same && negated) {
+    // 0取反之后还是0，看不出前面的负号是否已经作用在值上，不缓存
+    return literal.after_sub ? 0 : 1;
+  }
+  if (same) {
+    return 1;
+  }
+  return negated && literal.after_sub ? -1 : 0;
+}
+
+// 返回常量前面的符号：1或者-1，解析得到的值与常量不符或者无法确定符号时返回0
+static int literal_sign(const NormalizedSql::Literal &literal, const void *data) {
+  switch (literal.type) {
+    case NormalizedSql::INT_LITERAL: {
+      int value = atoi(literal.text.c_str());
+      int parsed = *(const int *)data;
+      return sign_of(literal, parsed == value, parsed == -value);
+    }
+    case NormalizedSql::FLOAT_LITERAL: {
+      float value = (float)atof(literal.text.c_str());
+      float parsed = *(const float *)data;
+      return sign_of(literal, parsed == value, parsed == -value);
+    }
+    case NormalizedSql::STRING_LITERAL: {
+      return 0 == strcmp(literal.text.c_str(), (const char *)data) ? 1 : 0;
+    }
+  }
+  return 0;
+}
+
+namespace {
+struct RecordContext {
+  std::unordered_map<const void *, int> parsed;  // 解析出的常量的data -> 第几个常量
+  std::unordered_map<const void *, int> *slots;
+  std::vector<bool> found;
+};
+
+struct ReplaceContext {
+  const std::unordered_map<const void *, int> *slots;
+  const std::vector<int> *signs;
+  const std::vector<NormalizedSql::Literal> *literals;
+};
+}  // namespace
+
+CachedPlan::~CachedPlan() {
+  if (template_ != nullptr) {
+    query_destroy(template_);
+    template_ = nullptr;
+  }
+}
+
+void CachedPlan::record_literal(const Value *src, Value *dst, void *context) {
+  RecordContext *record_context = (RecordContext *)context;
+  value_copy(src, dst);
+  auto iter = record_context->parsed.find(src->data);
+  if (src->data != nullptr && iter != record_context->parsed.end()) {
+    (*record_context->slots)[dst->data] = iter->second;
+    record_context->found[iter->second] = true;
+  }
+}
+
+void CachedPlan::replace_literal(const Value *src, Value *dst, void *context) {
+  ReplaceContext *replace_context = (ReplaceContext *)context;
+  auto iter = src->data != nullptr ? replace_context->slots->find(src->data) : replace_context->slots->end();
+  if (iter == replace_context->slots->end()) {
+    value_copy(src, dst);
+    return;
+  }
+
+  const NormalizedSql::Literal &literal = (*replace_context->literals)[iter->second];
+  const int sign = (*replace_context->signs)[iter->second];
+  switch (literal.type) {
+    case NormalizedSql::INT_LITERAL: {
+      value_init_integer(dst, sign * atoi(literal.text.c_str()));
+    } break;
+    case NormalizedSql::FLOAT_LITERAL: {
+      value_init_float(dst, sign * (float)atof(literal.text.c_str()));
+    } break;
+    case NormalizedSql::STRING_LITERAL: {
+      Value value;
+      value.type = CHARS;
+      value.isnull = 0;
+      value.data = (void *)literal.text.c_str();
+      value_copy(&value, dst);
+    } break;
+  }
+}
+
+std::shared_ptr<CachedPlan> CachedPlan::create(const Query *query, const ParsedLiterals &parsed,
+                                               const NormalizedSql &normalized) {
+  const size_t literal_num = normalized.literals.size();
+  if (parsed.literal_num != literal_num) {
+    return nullptr;
+  }
+
+  std::shared_ptr<CachedPlan> plan(new CachedPlan());
+  RecordContext context;
+  context.slots = &plan->slots_;
+  context.found.resize(literal_num, false);
+  for (size_t i = 0; i < literal_num; i++) {
+    int sign = literal_sign(normalized.literals[i], parsed.literals[i]);
+    if (sign == 0) {
+      return nullptr;
+    }
+    plan->signs_.push_back(sign);
+    context.parsed[parsed.literals[i]] = i;
+  }
+
+  plan->template_ = query_copy(query, record_literal, &context);
+  if (plan->template_ == nullptr) {
+    return nullptr;
+  }
+  // 每个常量都要能在语句中找到，否则替换之后的语句与sql不一致
+  for (size_t i = 0; i < literal_num; i++) {
+    if (!context.found[i]) {
+      return nullptr;
+    }
+  }
+
+  const std::string &text = normalized.text;
+  for (size_t begin = 0; begin < text.size();) {
+    size_t end = text.find(' ', begin);
+    if (end == std::string::npos) {
+      end = text.size();
+    }
+    std::string token = text.substr(begin, end - begin);
+    begin = end + 1;
+    if (!token.empty() && is_id_start(token[0]) &&
+        std::find(plan->identifiers_.begin(), plan->identifiers_.end(), token) == plan->identifiers_.end()) {
+      plan->identifiers_.push_back(std::move(token));
+    }
+  }
+  return plan;
+}
+
+CachedPlan::SchemaVersions CachedPlan::schema_versions(Db *db) const {
+  SchemaVersions versions;
+  versions.db_version = db->schema_version();
+  for (const std::string &identifier : identifiers_) {
+    Table *table = db->find_table(identifier.c_str());
+    if (table != nullptr) {
+      versions.tables.emplace_back(identifier, table->schema_version());
+    }
+  }
+  return versions;
+}
+
+bool CachedPlan::checked(const SchemaVersions &versions) const {
+  std::lock_guard<std::mutex> lock_guard(checked_lock_);
+  return checked_ && checked_versions_ == versions;
+}
+
+void CachedPlan::set_checked(const SchemaVersions &versions) {
+  std::lock_guard<std::mutex> lock_guard(checked_lock_);
+  checked_ = true;
+  checked_versions_ = versions;
+}
+
+Query *CachedPlan::instantiate(const std::vector<NormalizedSql::Literal> &literals) const {
+  if (literals.size() != signs_.size()) {
+    return nullptr;
+  }
+  ReplaceContext context{&slots_, &signs_, &literals};
+  return query_copy(template_, replace_literal, &context);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<CachedPlan> PlanCache::get(const std::string &key) {
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  auto iter = entries_.find(key);
+  if (iter == entries_.end()) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  lru_.splice(lru_.begin(), lru_, iter->second);
+  return iter->second->second;
+}
+
+void PlanCache::put(const std::string &key, const std::shared_ptr<CachedPlan> &plan) {
+  if (capacity_ == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  auto iter = entries_.find(key);
+  if (iter != entries_.end()) {
+    iter->second->second = plan;
+    lru_.splice(lru_.begin(), lru_, iter->second);
+    return;
+  }
+  lru_.emplace_front(key, plan);
+  entries_[key] = lru_.begin();
+  while (entries_.size() > capacity_) {
+    entries_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+}
+
+size_t PlanCache::size() {
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  return entries_.size();
+}
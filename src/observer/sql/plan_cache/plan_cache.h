@@ -0,0 +1,125 @@
+#ifndef __OBSERVER_SQL_PLAN_CACHE_PLAN_CACHE_H__
+#define __OBSERVER_SQL_PLAN_CACHE_PLAN_CACHE_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sql/parser/parse.h"
+
+class Db;
+
+/**
+ * 规范化之后的sql：按词法分析的规则切分，去掉多余的空白，
+ * 整数、浮点数、字符串常量分别换成 ?、?f、'?'，常量按出现的顺序放在literals中。
+ * LIMIT后面的数字不是常量，保持原样
+ */
+struct NormalizedSql {
+  enum LiteralType { INT_LITERAL, FLOAT_LITERAL, STRING_LITERAL };
+  struct Literal {
+    LiteralType type;
+    std::string text;        // 字符串不带引号
+    bool after_sub = false;  // 前一个词是负号，解析时可能已经把值取反
+  };
+
+  std::string text;
+  std::vector<Literal> literals;
+};
+
+/**
+ * 只规范化select/insert/update/delete语句
+ * @param params 不为空时sql中可以有参数 ?，当作常量放在literals中，记录每个参数是第几个常量
+ * @return 其它语句或者词法分析会出错的sql返回false
+ */
+bool normalize_sql(const char *sql, NormalizedSql &normalized, std::vector<size_t> *params = nullptr);
+
+/**
+ * 缓存的计划：解析得到的语句作为模板，记住其中每个常量对应sql中的第几个常量。
+ * 执行时复制一份模板，把常量换成新sql中的值，因为执行过程中会修改Query(如格式化日期)。
+ * 另外记录通过了检查(表和字段是否存在)时db以及语句中每张表的schema version，版本都不变时可以不再检查
+ */
+class CachedPlan {
+public:
+  struct SchemaVersions {
+    uint64_t db_version = 0;
+    std::vector<std::pair<std::string, uint64_t>> tables;  // 表名, 表的schema version
+
+    bool operator==(const SchemaVersions &other) const {
+      return db_version == other.db_version && tables == other.tables;
+    }
+  };
+
+public:
+  ~CachedPlan();
+
+  /**
+   * 用刚解析出的语句创建计划，必须在执行之前调用
+   * @return 常量与规范化的结果对不上时返回nullptr，这样的语句不缓存
+   */
+  static std::shared_ptr<CachedPlan> create(const Query *query, const ParsedLiterals &parsed,
+                                            const NormalizedSql &normalized);
+
+  /**
+   * 用规范化之后相同的sql中的常量生成一条可以执行的语句，用query_destroy释放
+   */
+  Query *instantiate(const std::vector<NormalizedSql::Literal> &literals) const;
+
+  /**
+   * db以及sql中出现的每张表当前的schema version。应该在检查之前取，检查过程中发生的变化留到下次发现
+   */
+  SchemaVersions schema_versions(Db *db) const;
+  bool checked(const SchemaVersions &versions) const;
+  void set_checked(const SchemaVersions &versions);
+
+private:
+  CachedPlan() = default;
+
+  static void record_literal(const Value *src, Value *dst, void *context);
+  static void replace_literal(const Value *src, Value *dst, void *context);
+
+private:
+  Query *template_ = nullptr;
+  std::unordered_map<const void *, int> slots_;  // 模板中常量的data -> 第几个常量
+  std::vector<int> signs_;                       // 常量前面有负号时，解析时已经把值取反
+  std::vector<std::string> identifiers_;         // sql中的标识符，其中与表同名的当作语句用到的表
+
+  mutable std::mutex checked_lock_;
+  bool checked_ = false;
+  SchemaVersions checked_versions_;
+};
+
+/**
+ * 按规范化的sql缓存计划，超过容量时淘汰最久没有使用的
+ */
+class PlanCache {
+public:
+  explicit PlanCache(size_t capacity) : capacity_(capacity) {}
+
+  std::shared_ptr<CachedPlan> get(const std::string &key);
+  void put(const std::string &key, const std::shared_ptr<CachedPlan> &plan);
+
+  size_t size();
+  uint64_t hits() const {
+    return hits_;
+  }
+  uint64_t misses() const {
+    return misses_;
+  }
+
+private:
+  typedef std::list<std::pair<std::string, std::shared_ptr<CachedPlan>>> LruList;
+
+  size_t capacity_;
+  std::mutex lock_;
+  LruList lru_;  // 最近使用的在前面
+  std::unordered_map<std::string, LruList::iterator> entries_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
+
+#endif  // __OBSERVER_SQL_PLAN_CACHE_PLAN_CACHE_H__
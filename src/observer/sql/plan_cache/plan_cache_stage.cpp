@@ -8,9 +8,18 @@
 #include "common/lang/string.h"
 #include "common/log/log.h"
 #include "common/seda/timer_stage.h"
+#include "event/execution_plan_event.h"
+#include "event/session_event.h"
+#include "event/sql_event.h"
+#include "session/session.h"
+#include "sql/plan_cache/prepared_statement.h"
 
 using namespace common;
 
+// 最多缓存的计划数，为0时不使用计划缓存
+const char *CONF_PLAN_CACHE_SIZE = "PlanCacheSize";
+static const size_t DEFAULT_PLAN_CACHE_SIZE = 1024;
+
 //! Constructor
 PlanCacheStage::PlanCacheStage(const char *tag) : Stage(tag) {}
 
@@ -30,14 +39,18 @@ Stage *PlanCacheStage::make_stage(const std::string &tag) {
 
 //! Set properties for this object set in stage specific properties
 bool PlanCacheStage::set_properties() {
-  //  std::string stageNameStr(stage_name_);
-  //  std::map<std::string, std::string> section = g_properties()->get(
-  //    stageNameStr);
-  //
-  //  std::map<std::string, std::string>::iterator it;
-  //
-  //  std::string key;
+  std::string stageNameStr(stage_name_);
+  std::map<std::string, std::string> section = get_properties()->get(stageNameStr);
 
+  size_t capacity = DEFAULT_PLAN_CACHE_SIZE;
+  std::map<std::string, std::string>::iterator it = section.find(CONF_PLAN_CACHE_SIZE);
+  if (it != section.end()) {
+    str_to_val(it->second, capacity);
+  }
+  if (capacity > 0) {
+    plan_cache_.reset(new PlanCache(capacity));
+  }
+  LOG_INFO("Plan cache size: %lu", capacity);
   return true;
 }
 
@@ -48,6 +61,12 @@ bool PlanCacheStage::initialize() {
   std::list<Stage *>::iterator stgp = next_stage_list_.begin();
   execute_stage = *(stgp++);
   parse_stage = *(stgp++);
+  // 没有配置OptimizeStage时不能绕过ParseStage，不使用计划缓存
+  if (stgp != next_stage_list_.end()) {
+    optimize_stage = *(stgp++);
+  } else {
+    plan_cache_.reset();
+  }
 
   LOG_TRACE("Exit");
   return true;
@@ -57,25 +76,48 @@ bool PlanCacheStage::initialize() {
 void PlanCacheStage::cleanup() {
   LOG_TRACE("Enter");
 
+  if (plan_cache_ != nullptr) {
+    LOG_INFO("Plan cache: size=%lu, hits=%lu, misses=%lu",
+        plan_cache_->size(), plan_cache_->hits(), plan_cache_->misses());
+  }
+
   LOG_TRACE("Exit");
 }
 
 void PlanCacheStage::handle_event(StageEvent *event) {
   LOG_TRACE("Enter\n");
 
-  // Add callback to update plan cache
-  /*
+  SQLStageEvent *sql_event = static_cast<SQLStageEvent *>(event);
+  StageEvent *new_event = nullptr;
+  PreparedCommand command;
+  if (optimize_stage != nullptr &&
+      parse_prepared_command(sql_event->get_sql().c_str(), command) != PreparedCommand::NONE) {
+    new_event = handle_prepared_command(sql_event, command);
+    if (new_event == nullptr) {
+      callback_event(event, nullptr);
+      event->done_immediate();
+      LOG_TRACE("Exit\n");
+      return;
+    }
+  } else if (plan_cache_ != nullptr) {
+    new_event = handle_request(sql_event);
+  }
+  if (new_event == nullptr) {
+    parse_stage->handle_event(event);
+    LOG_TRACE("Exit\n");
+    return;
+  }
+
   CompletionCallback *cb = new (std::nothrow) CompletionCallback(this, nullptr);
   if (cb == nullptr) {
     LOG_ERROR("Failed to new callback for SQLStageEvent");
+    delete new_event;
+    callback_event(event, nullptr);
     event->done_immediate();
     return;
   }
-
   event->push_callback(cb);
-   */
-  // do nothing here, pass the event to the next stage
-  parse_stage->handle_event(event);
+  optimize_stage->handle_event(new_event);
 
   LOG_TRACE("Exit\n");
   return;
@@ -84,10 +126,93 @@ void PlanCacheStage::handle_event(StageEvent *event) {
 void PlanCacheStage::callback_event(StageEvent *event,
                                    CallbackContext *context) {
   LOG_TRACE("Enter\n");
-
-  // update execute plan here
-  // event->done_immediate();
-
+  SQLStageEvent *sql_event = static_cast<SQLStageEvent *>(event);
+  sql_event->session_event()->done_immediate();
   LOG_TRACE("Exit\n");
   return;
 }
+
+// 规范化之后的sql相同时复用解析的结果，只替换其中的常量
+StageEvent *PlanCacheStage::handle_request(SQLStageEvent *sql_event) {
+  const std::string &sql = sql_event->get_sql();
+  NormalizedSql normalized;
+  if (!normalize_sql(sql.c_str(), normalized)) {
+    return nullptr;
+  }
+
+  Session *session = sql_event->session_event()->get_client()->session;
+  const std::string key = session->get_current_db() + ":" + normalized.text;
+  std::shared_ptr<CachedPlan> plan = plan_cache_->get(key);
+  Query *query = nullptr;
+  if (plan != nullptr) {
+    query = plan->instantiate(normalized.literals);
+    LOG_DEBUG("Plan cache hit: %s", normalized.text.c_str());
+  } else {
+    query = query_create();
+    if (nullptr == query) {
+      LOG_ERROR("Failed to create query.");
+      return nullptr;
+    }
+    ParsedLiterals literals;
+    RC rc = parse(sql.c_str(), query, &literals);
+    if (rc != RC::SUCCESS) {
+      // 由ParseStage返回解析错误
+      query_destroy(query);
+      return nullptr;
+    }
+    plan = CachedPlan::create(query, literals, normalized);
+    if (plan != nullptr) {
+      plan_cache_->put(key, plan);
+    }
+  }
+  if (nullptr == query) {
+    return nullptr;
+  }
+
+  ExecutionPlanEvent *plan_event = new ExecutionPlanEvent(sql_event, query);
+  plan_event->set_cached_plan(plan);
+  return plan_event;
+}
+
+// PREPARE、DEALLOCATE直接返回结果，EXECUTE代入参数之后返回ExecutionPlanEvent
+StageEvent *PlanCacheStage::handle_prepared_command(SQLStageEvent *sql_event, const PreparedCommand &command) {
+  SessionEvent *session_event = sql_event->session_event();
+  Session *session = session_event->get_client()->session;
+  switch (command.type) {
+    case PreparedCommand::PREPARE: {
+      std::shared_ptr<PreparedStatement> statement = PreparedStatement::create(command.sql);
+      if (statement != nullptr) {
+        session->set_prepared_statement(command.name, statement);
+      }
+      session_event->set_response(statement != nullptr ? "SUCCESS\n" : "FAILURE\n");
+    } break;
+    case PreparedCommand::DEALLOCATE: {
+      bool removed = session->remove_prepared_statement(command.name);
+      session_event->set_response(removed ? "SUCCESS\n" : "FAILURE\n");
+    } break;
+    case PreparedCommand::EXECUTE: {
+      std::shared_ptr<PreparedStatement> statement = session->find_prepared_statement(command.name);
+      if (statement == nullptr) {
+        LOG_INFO("No such prepared statement: %s", command.name.c_str());
+        session_event->set_response("FAILURE\n");
+        break;
+      }
+      std::shared_ptr<CachedPlan> plan;
+      Query *query = statement->bind(command.params, plan);
+      if (query == nullptr) {
+        LOG_INFO("Failed to bind %lu parameters to prepared statement %s, which needs %lu literal parameters",
+            command.params.size(), command.name.c_str(), statement->param_num());
+        session_event->set_response("FAILURE\n");
+        break;
+      }
+      ExecutionPlanEvent *plan_event = new ExecutionPlanEvent(sql_event, query);
+      plan_event->set_cached_plan(plan);
+      return plan_event;
+    }
+    default: {
+      LOG_INFO("Invalid prepared statement command: %s", sql_event->get_sql().c_str());
+      session_event->set_response("FAILURE\n");
+    } break;
+  }
+  return nullptr;
+}
@@ -1,7 +1,13 @@
 #ifndef __OBSERVER_SQL_PLAN_CACHE_STAGE_H__
 #define __OBSERVER_SQL_PLAN_CACHE_STAGE_H__
 
+#include <memory>
+
 #include "common/seda/stage.h"
+#include "sql/plan_cache/plan_cache.h"
+
+class SQLStageEvent;
+struct PreparedCommand;
 
 class PlanCacheStage : public common::Stage {
 public:
@@ -20,9 +26,16 @@ protected:
                      common::CallbackContext *context);
 
 protected:
+  // 命中缓存或者解析成功时返回ExecutionPlanEvent，否则交给ParseStage处理
+  common::StageEvent *handle_request(SQLStageEvent *sql_event);
+  // 预处理语句的命令，EXECUTE返回ExecutionPlanEvent，其它命令以及出错时设置好返回结果之后返回nullptr
+  common::StageEvent *handle_prepared_command(SQLStageEvent *sql_event, const PreparedCommand &command);
+
 private:
   Stage *parse_stage = nullptr;
   Stage *execute_stage = nullptr;
+  Stage *optimize_stage = nullptr;
+  std::unique_ptr<PlanCache> plan_cache_;
 };
 
 #endif //__OBSERVER_SQL_PLAN_CACHE_STAGE_H__
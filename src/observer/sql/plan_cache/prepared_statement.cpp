@@ -0,0 +1,342 @@
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+
+#include "sql/plan_cache/prepared_statement.h"
+#include "common/log/log.h"
+
+static const char *skip_blank(const char *p) {
+  while (*p == ' ' || *p == '\t' || *p == '\b' || *p == '\f' || *p == '\n' || *p == '\r') {
+    p++;
+  }
+  return p;
+}
+
+static const char *read_word(const char *p, std::string &word) {
+  p = skip_blank(p);
+  word.clear();
+  while (isalnum((unsigned char)*p) || *p == '_') {
+    word += (char)tolower((unsigned char)*p);
+    p++;
+  }
+  return p;
+}
+
+// 命令最后可以有分号，之后不能再有其它内容
+static bool is_end(const char *p) {
+  p = skip_blank(p);
+  if (*p == ';') {
+    p = skip_blank(p + 1);
+  }
+  return *p == '\0';
+}
+
+static bool is_number(const std::string &text, bool is_float) {
+  size_t i = (!text.empty() && text[0] == '-') ? 1 : 0;
+  size_t digits = 0;
+  for (; i < text.size() && isdigit((unsigned char)text[i]); i++) {
+    digits++;
+  }
+  if (digits == 0) {
+    return false;
+  }
+  if (!is_float) {
+    return i == text.size();
+  }
+  if (i == text.size() || text[i] != '.') {
+    return false;
+  }
+  return i + 1 < text.size() && is_number(text.substr(i + 1), false) && text[i + 1] != '-';
+}
+
+// 读取EXECUTE USING后面的一个常量：整数、浮点数(前面可以有负号)或者字符串
+static const char *read_value(const char *p, NormalizedSql::Literal &literal) {
+  p = skip_blank(p);
+  if (*p == '\'' || *p == '"') {
+    const char *end = strchr(p + 1, *p);
+    if (end == nullptr) {
+      return nullptr;
+    }
+    literal.type = NormalizedSql::STRING_LITERAL;
+    literal.text.assign(p + 1, end - p - 1);
+    return end + 1;
+  }
+
+  literal.text.clear();
+  if (*p == '-') {
+    literal.text += '-';
+    p = skip_blank(p + 1);
+  }
+  while (isdigit((unsigned char)*p) || *p == '.') {
+    literal.text += *p;
+    p++;
+  }
+  if (is_number(literal.text, false)) {
+    literal.type = NormalizedSql::INT_LITERAL;
+  } else if (is_number(literal.text, true)) {
+    literal.type = NormalizedSql::FLOAT_LITERAL;
+  } else {
+    return nullptr;
+  }
+  return p;
+}
+
+static PreparedCommand::Type parse_prepare(const char *p, PreparedCommand &command) {
+  std::string word;
+  p = read_word(p, command.name);
+  p = read_word(p, word);
+  if (command.name.empty() || word != "from") {
+    return PreparedCommand::INVALID;
+  }
+  p = skip_blank(p);
+  if (*p != '\'' && *p != '"') {
+    return PreparedCommand::INVALID;
+  }
+  // 语句中的字符串常量要用另一种引号，语句到最后一个相同的引号为止
+  const char *end = strrchr(p + 1, *p);
+  if (end == nullptr || !is_end(end + 1)) {
+    return PreparedCommand::INVALID;
+  }
+  command.sql.assign(p + 1, end - p - 1);
+  return PreparedCommand::PREPARE;
+}
+
+static PreparedCommand::Type parse_execute(const char *p, PreparedCommand &command) {
+  std::string word;
+  p = read_word(p, command.name);
+  if (command.name.empty()) {
+    return PreparedCommand::INVALID;
+  }
+  if (is_end(p)) {
+    return PreparedCommand::EXECUTE;
+  }
+  p = read_word(p, word);
+  if (word != "using") {
+    return PreparedCommand::INVALID;
+  }
+  while (true) {
+    NormalizedSql::Literal literal;
+    p = read_value(p, literal);
+    if (p == nullptr) {
+      return PreparedCommand::INVALID;
+    }
+    command.params.push_back(std::move(literal));
+    p = skip_blank(p);
+    if (*p != ',') {
+      break;
+    }
+    p++;
+  }
+  return is_end(p) ? PreparedCommand::EXECUTE : PreparedCommand::INVALID;
+}
+
+static PreparedCommand::Type parse_deallocate(const char *p, PreparedCommand &command) {
+  std::string word;
+  p = read_word(p, word);
+  p = read_word(p, command.name);
+  if (word != "prepare" || command.name.empty() || !is_end(p)) {
+    return PreparedCommand::INVALID;
+  }
+  return PreparedCommand::DEALLOCATE;
+}
+
+static PreparedCommand::Type parse_execute_message(const char *p, PreparedCommand &command) {
+  const char *end = strchr(p, PREPARED_PARAM_SEPARATOR);
+  if (end == nullptr) {
+    end = p + strlen(p);
+  }
+  for (const char *q = p; q < end; q++) {
+    command.name += (char)tolower((unsigned char)*q);
+  }
+  if (command.name.empty()) {
+    return PreparedCommand::INVALID;
+  }
+
+  while (*end == PREPARED_PARAM_SEPARATOR) {
+    const char *begin = end + 1;
+    end = strchr(begin, PREPARED_PARAM_SEPARATOR);
+    if (end == nullptr) {
+      end = begin + strlen(begin);
+    }
+    if (begin == end) {
+      return PreparedCommand::INVALID;
+    }
+
+    NormalizedSql::Literal literal;
+    literal.text.assign(begin + 1, end - begin - 1);
+    switch (*begin) {
+      case 'i': {
+        literal.type = NormalizedSql::INT_LITERAL;
+      } break;
+      case 'f': {
+        literal.type = NormalizedSql::FLOAT_LITERAL;
+      } break;
+      case 's': {
+        literal.type = NormalizedSql::STRING_LITERAL;
+      } break;
+      default: {
+        return PreparedCommand::INVALID;
+      }
+    }
+    if (literal.type != NormalizedSql::STRING_LITERAL &&
+        !is_number(literal.text, literal.type == NormalizedSql::FLOAT_LITERAL)) {
+      return PreparedCommand::INVALID;
+    }
+    command.params.push_back(std::move(literal));
+  }
+  return PreparedCommand::EXECUTE;
+}
+
+PreparedCommand::Type parse_prepared_command(const char *sql, PreparedCommand &command) {
+  command = PreparedCommand();
+  if (sql[0] == PREPARED_EXECUTE_MESSAGE) {
+    command.type = parse_execute_message(sql + 1, command);
+    return command.type;
+  }
+
+  std::string word;
+  const char *p = read_word(sql, word);
+  if (word == "prepare") {
+    command.type = parse_prepare(p, command);
+  } else if (word == "execute") {
+    command.type = parse_execute(p, command);
+  } else if (word == "deallocate") {
+    command.type = parse_deallocate(p, command);
+  }
+  return command.type;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// 参数位置上用于解析模板的常量，只由参数的类型决定，不含用户输入的内容
+static NormalizedSql::Literal placeholder_literal(NormalizedSql::LiteralType type) {
+  switch (type) {
+    case NormalizedSql::INT_LITERAL: {
+      return NormalizedSql::Literal{type, "1"};
+    }
+    case NormalizedSql::FLOAT_LITERAL: {
+      return NormalizedSql::Literal{type, "1.0"};
+    }
+    default: {
+      return NormalizedSql::Literal{type, "p"};
+    }
+  }
+}
+
+static bool same_literals(const std::vector<NormalizedSql::Literal> &left,
+                          const std::vector<NormalizedSql::Literal> &right) {
+  if (left.size() != right.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < left.size(); i++) {
+    if (left[i].type != right[i].type || left[i].text != right[i].text) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::shared_ptr<PreparedStatement> PreparedStatement::create(const std::string &sql) {
+  std::shared_ptr<PreparedStatement> statement(new PreparedStatement());
+  statement->sql_ = sql;
+  std::string &text = statement->sql_;
+  while (!text.empty() && (isspace((unsigned char)text.back()) || text.back() == ';')) {
+    text.pop_back();
+  }
+  if (!normalize_sql(text.c_str(), statement->normalized_, &statement->params_)) {
+    LOG_INFO("Unsupported prepared statement: %s", sql.c_str());
+    return nullptr;
+  }
+
+  std::vector<NormalizedSql::Literal> params(statement->params_.size(),
+      placeholder_literal(NormalizedSql::INT_LITERAL));
+  std::shared_ptr<CachedPlan> plan;
+  Query *query = statement->bind(params, plan);
+  if (query == nullptr) {
+    LOG_INFO("Failed to parse prepared statement: %s", sql.c_str());
+    return nullptr;
+  }
+  query_destroy(query);
+  return statement;
+}
+
+std::string PreparedStatement::substitute(const std::vector<NormalizedSql::Literal> &placeholders) const {
+  // ? 不能出现在字符串常量中，sql中的 ? 都是参数
+  std::string sql;
+  size_t index = 0;
+  for (char c : sql_) {
+    if (c != '?') {
+      sql += c;
+      continue;
+    }
+    const NormalizedSql::Literal &placeholder = placeholders[index++];
+    if (placeholder.type == NormalizedSql::STRING_LITERAL) {
+      sql += '\'';
+      sql += placeholder.text;
+      sql += '\'';
+    } else {
+      sql += placeholder.text;
+    }
+  }
+  sql += ';';
+  return sql;
+}
+
+std::shared_ptr<CachedPlan> PreparedStatement::create_plan(const std::vector<NormalizedSql::Literal> &params) {
+  // 参数的值不参与词法分析：先用占位的常量解析出模板，执行时再把参数的值代入模板中的常量
+  std::vector<NormalizedSql::Literal> placeholders;
+  std::vector<NormalizedSql::Literal> literals = normalized_.literals;
+  for (size_t i = 0; i < params.size(); i++) {
+    placeholders.push_back(placeholder_literal(params[i].type));
+    literals[params_[i]] = placeholders.back();
+  }
+  const std::string sql = substitute(placeholders);
+  Query *query = query_create();
+  if (nullptr == query) {
+    LOG_ERROR("Failed to create query.");
+    return nullptr;
+  }
+  ParsedLiterals parsed;
+  RC rc = parse(sql.c_str(), query, &parsed);
+  if (rc != RC::SUCCESS) {
+    query_destroy(query);
+    return nullptr;
+  }
+
+  // 参数要能对应到模板中的常量，LIMIT后面的参数等不是常量，不能代入
+  std::shared_ptr<CachedPlan> plan;
+  NormalizedSql normalized;
+  if (normalize_sql(sql.c_str(), normalized) && same_literals(normalized.literals, literals)) {
+    plan = CachedPlan::create(query, parsed, normalized);
+  }
+  query_destroy(query);
+  if (plan == nullptr) {
+    LOG_INFO("Parameters of prepared statement can not be bound as literals: %s", sql_.c_str());
+  }
+  return plan;
+}
+
+Query *PreparedStatement::bind(const std::vector<NormalizedSql::Literal> &params, std::shared_ptr<CachedPlan> &plan) {
+  plan = nullptr;
+  if (params.size() != params_.size()) {
+    return nullptr;
+  }
+
+  std::vector<NormalizedSql::Literal> literals = normalized_.literals;
+  std::string types;
+  for (size_t i = 0; i < params.size(); i++) {
+    literals[params_[i]] = params[i];
+    types += params[i].type == NormalizedSql::INT_LITERAL ? 'i'
+           : (params[i].type == NormalizedSql::FLOAT_LITERAL ? 'f' : 's');
+  }
+  auto iter = plans_.find(types);
+  if (iter == plans_.end()) {
+    // 第一次使用这组参数类型，解析一次模板
+    iter = plans_.emplace(types, create_plan(params)).first;
+  }
+  plan = iter->second;
+  if (plan == nullptr) {
+    return nullptr;
+  }
+  return plan->instantiate(literals);
+}
@@ -0,0 +1,80 @@
+#ifndef __OBSERVER_SQL_PLAN_CACHE_PREPARED_STATEMENT_H__
+#define __OBSERVER_SQL_PLAN_CACHE_PREPARED_STATEMENT_H__
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sql/plan_cache/plan_cache.h"
+
+/**
+ * 二进制的执行消息，不需要词法分析：
+ *   PREPARED_EXECUTE_MESSAGE 名字 {PREPARED_PARAM_SEPARATOR 类型 值}*
+ * 类型为 i(整数)、f(浮点数)、s(字符串)，值是不带引号的文本。
+ * 消息与sql一样以'\0'结尾，所以值不能直接用二进制表示
+ */
+static const char PREPARED_EXECUTE_MESSAGE = '\x01';
+static const char PREPARED_PARAM_SEPARATOR = '\x1f';
+
+/**
+ * 预处理语句的命令，不经过sql的词法分析与语法分析：
+ *   PREPARE name FROM 'sql'
+ *   EXECUTE name [USING value [, value]...]
+ *   DEALLOCATE PREPARE name
+ */
+struct PreparedCommand {
+  enum Type { NONE, PREPARE, EXECUTE, DEALLOCATE, INVALID };
+
+  Type type = NONE;
+  std::string name;                            // 名字不区分大小写，统一转成小写
+  std::string sql;                             // PREPARE的语句
+  std::vector<NormalizedSql::Literal> params;  // EXECUTE的参数
+};
+
+/**
+ * @return 不是预处理语句的命令时返回NONE，格式不对时返回INVALID
+ */
+PreparedCommand::Type parse_prepared_command(const char *sql, PreparedCommand &command);
+
+/**
+ * PREPARE创建的预处理语句，由创建它的会话保存。
+ * sql中的 ? 是参数，按参数的类型分别保存计划：参数位置换成占位的常量解析一次得到模板，
+ * 执行时只把参数的值代入模板中的常量，参数的值不会经过词法分析。
+ * 同一个会话的请求是一个一个处理的，不需要加锁
+ */
+class PreparedStatement {
+public:
+  /**
+   * 参数都当作整数1解析一次，检查语句是否正确
+   * @return 不是select/insert/update/delete或者不能解析时返回nullptr
+   */
+  static std::shared_ptr<PreparedStatement> create(const std::string &sql);
+
+  size_t param_num() const {
+    return params_.size();
+  }
+
+  /**
+   * 代入参数得到可以执行的语句，用query_destroy释放
+   * @param plan 这组参数类型对应的计划
+   * @return 参数个数不对，或者参数不能代入模板中的常量时(如LIMIT后面的参数)返回nullptr
+   */
+  Query *bind(const std::vector<NormalizedSql::Literal> &params, std::shared_ptr<CachedPlan> &plan);
+
+private:
+  PreparedStatement() = default;
+
+  // 把sql中的参数换成占位的常量
+  std::string substitute(const std::vector<NormalizedSql::Literal> &placeholders) const;
+  // 按这组参数的类型解析模板，参数不能代入时返回nullptr
+  std::shared_ptr<CachedPlan> create_plan(const std::vector<NormalizedSql::Literal> &params);
+
+private:
+  std::string sql_;             // 去掉了结尾的分号
+  NormalizedSql normalized_;    // 参数的位置是空的常量
+  std::vector<size_t> params_;  // 每个参数是normalized_中的第几个常量
+  std::unordered_map<std::string, std::shared_ptr<CachedPlan>> plans_;  // 参数的类型 -> 计划，不能代入时为nullptr
+};
+
+#endif  // __OBSERVER_SQL_PLAN_CACHE_PREPARED_STATEMENT_H__
@@ -0,0 +1,93 @@
+#include <stdio.h>
+
+#include "sql/query_cache/query_cache.h"
+#include "common/metrics/snapshot.h"
+#include "storage/common/db.h"
+#include "storage/common/table.h"
+
+bool QueryCache::valid(const Entry &entry, Db *db) {
+  if (db->schema_version() != entry.schema_version) {
+    return false;
+  }
+  for (const TableVersion &table_version : entry.tables) {
+    Table *table = db->find_table(table_version.table_name.c_str());
+    if (table == nullptr || table->data_version() != table_version.data_version) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void QueryCache::erase(std::unordered_map<std::string, LruList::iterator>::iterator iter) {
+  LruList::iterator node = iter->second;
+  size_ -= node->first.size() + node->second.response.size();
+  entries_.erase(iter);
+  lru_.erase(node);
+}
+
+bool QueryCache::get(const std::string &key, Db *db, std::string &response) {
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  auto iter = entries_.find(key);
+  if (iter == entries_.end()) {
+    misses_++;
+    return false;
+  }
+  if (!valid(iter->second->second, db)) {
+    erase(iter);
+    misses_++;
+    return false;
+  }
+  hits_++;
+  lru_.splice(lru_.begin(), lru_, iter->second);
+  response = iter->second->second.response;
+  return true;
+}
+
+void QueryCache::put(const std::string &key, Entry &&entry) {
+  const size_t entry_size = key.size() + entry.response.size();
+  if (entry.response.size() > max_result_size_ || entry_size > capacity_) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  auto iter = entries_.find(key);
+  if (iter != entries_.end()) {
+    erase(iter);
+  }
+  lru_.emplace_front(key, std::move(entry));
+  entries_[key] = lru_.begin();
+  size_ += entry_size;
+  while (size_ > capacity_) {
+    erase(entries_.find(lru_.back().first));
+  }
+}
+
+size_t QueryCache::size() {
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  return size_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+QueryCacheMetric::QueryCacheMetric(const QueryCache &query_cache) : query_cache_(query_cache) {
+  snapshot_value_ = new common::SnapshotBasic<std::string>();
+}
+
+QueryCacheMetric::~QueryCacheMetric() {
+  delete snapshot_value_;
+  snapshot_value_ = nullptr;
+}
+
+void QueryCacheMetric::snapshot() {
+  uint64_t hits = query_cache_.hits();
+  uint64_t misses = query_cache_.misses();
+  uint64_t delta_hits = hits - last_hits_;
+  uint64_t delta_misses = misses - last_misses_;
+  last_hits_ = hits;
+  last_misses_ = misses;
+
+  double hit_rate = delta_hits + delta_misses == 0 ? 0 : (double)delta_hits / (delta_hits + delta_misses);
+  char buf[128];
+  snprintf(buf, sizeof(buf), "hits:%lu,misses:%lu,hit_rate:%.4f", delta_hits, delta_misses, hit_rate);
+  std::string value(buf);
+  ((common::SnapshotBasic<std::string> *)snapshot_value_)->setValue(value);
+}
@@ -0,0 +1,91 @@
+#ifndef __OBSERVER_SQL_QUERY_CACHE_QUERY_CACHE_H__
+#define __OBSERVER_SQL_QUERY_CACHE_QUERY_CACHE_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/metrics/metric.h"
+
+class Db;
+
+/**
+ * 查询结果缓存，保存select返回给客户端的结果。
+ * 每个结果记录执行前db的schema version以及用到的每张表的data version，
+ * 取出时任何一个版本变了就说明结果过期，直接删掉。
+ * 按结果的总字节数限制大小，超过时淘汰最久没有使用的结果
+ */
+class QueryCache {
+public:
+  struct TableVersion {
+    std::string table_name;
+    uint64_t data_version;
+  };
+
+  struct Entry {
+    uint64_t schema_version = 0;
+    std::vector<TableVersion> tables;
+    std::string response;
+  };
+
+  /**
+   * @param capacity 所有结果的总字节数
+   * @param max_result_size 超过这个大小的结果不缓存
+   */
+  QueryCache(size_t capacity, size_t max_result_size) : capacity_(capacity), max_result_size_(max_result_size) {}
+
+  /**
+   * 取出仍然有效的结果
+   */
+  bool get(const std::string &key, Db *db, std::string &response);
+  void put(const std::string &key, Entry &&entry);
+
+  size_t max_result_size() const {
+    return max_result_size_;
+  }
+  size_t size();
+  uint64_t hits() const {
+    return hits_;
+  }
+  uint64_t misses() const {
+    return misses_;
+  }
+
+private:
+  typedef std::list<std::pair<std::string, Entry>> LruList;
+
+  static bool valid(const Entry &entry, Db *db);
+  void erase(std::unordered_map<std::string, LruList::iterator>::iterator iter);
+
+private:
+  size_t capacity_;
+  size_t max_result_size_;
+  size_t size_ = 0;  // 缓存的键和结果的字节数
+  std::mutex lock_;
+  LruList lru_;  // 最近使用的在前面
+  std::unordered_map<std::string, LruList::iterator> entries_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
+
+/**
+ * 两次snapshot之间的命中率，由MetricsStage定期输出
+ */
+class QueryCacheMetric : public common::Metric {
+public:
+  explicit QueryCacheMetric(const QueryCache &query_cache);
+  ~QueryCacheMetric();
+
+  void snapshot() override;
+
+private:
+  const QueryCache &query_cache_;
+  uint64_t last_hits_ = 0;
+  uint64_t last_misses_ = 0;
+};
+
+#endif  // __OBSERVER_SQL_QUERY_CACHE_QUERY_CACHE_H__
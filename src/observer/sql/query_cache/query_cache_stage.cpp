@@ -8,9 +8,33 @@
 #include "common/lang/string.h"
 #include "common/log/log.h"
 #include "common/seda/timer_stage.h"
+#include "common/metrics/metrics_registry.h"
+#include "event/session_event.h"
+#include "event/sql_event.h"
+#include "session/session.h"
+#include "sql/plan_cache/plan_cache.h"
+#include "storage/common/db.h"
+#include "storage/common/table.h"
+#include "storage/default/default_handler.h"
 
 using namespace common;
 
+// 缓存的查询结果的总字节数，为0时不使用查询结果缓存
+const char *CONF_QUERY_CACHE_SIZE = "QueryCacheSize";
+// 超过这个字节数的结果不缓存
+const char *CONF_QUERY_CACHE_MAX_RESULT_SIZE = "QueryCacheMaxResultSize";
+static const size_t DEFAULT_QUERY_CACHE_MAX_RESULT_SIZE = 1 << 20;
+static const std::string QUERY_CACHE_METRIC_TAG = "QueryCacheStage.hit_rate";
+
+namespace {
+// 未命中时记录执行之前的版本，执行完之后连同结果一起放到缓存中
+class QueryCacheContext : public CallbackContext {
+public:
+  std::string key;
+  QueryCache::Entry entry;
+};
+}  // namespace
+
 //! Constructor
 QueryCacheStage::QueryCacheStage(const char *tag) : Stage(tag) {}
 
@@ -30,14 +54,23 @@ Stage *QueryCacheStage::make_stage(const std::string &tag) {
 
 //! Set properties for this object set in stage specific properties
 bool QueryCacheStage::set_properties() {
-  //  std::string stageNameStr(stage_name_);
-  //  std::map<std::string, std::string> section = g_properties()->get(
-  //    stageNameStr);
-  //
-  //  std::map<std::string, std::string>::iterator it;
-  //
-  //  std::string key;
-
+  std::string stageNameStr(stage_name_);
+  std::map<std::string, std::string> section = get_properties()->get(stageNameStr);
+
+  size_t capacity = 0;
+  size_t max_result_size = DEFAULT_QUERY_CACHE_MAX_RESULT_SIZE;
+  std::map<std::string, std::string>::iterator it = section.find(CONF_QUERY_CACHE_SIZE);
+  if (it != section.end()) {
+    str_to_val(it->second, capacity);
+  }
+  it = section.find(CONF_QUERY_CACHE_MAX_RESULT_SIZE);
+  if (it != section.end()) {
+    str_to_val(it->second, max_result_size);
+  }
+  if (capacity > 0) {
+    query_cache_.reset(new QueryCache(capacity, max_result_size));
+    LOG_INFO("Query cache size: %lu, max result size: %lu", capacity, max_result_size);
+  }
   return true;
 }
 
@@ -48,6 +81,11 @@ bool QueryCacheStage::initialize() {
   std::list<Stage *>::iterator stgp = next_stage_list_.begin();
   plan_cache_stage = *(stgp++);
 
+  if (query_cache_ != nullptr) {
+    query_cache_metric_.reset(new QueryCacheMetric(*query_cache_));
+    get_metrics_registry().register_metric(QUERY_CACHE_METRIC_TAG, query_cache_metric_.get());
+  }
+
   LOG_TRACE("Exit");
   return true;
 }
@@ -56,24 +94,24 @@ bool QueryCacheStage::initialize() {
 void QueryCacheStage::cleanup() {
   LOG_TRACE("Enter");
 
+  if (query_cache_ != nullptr) {
+    LOG_INFO("Query cache: size=%lu, hits=%lu, misses=%lu",
+        query_cache_->size(), query_cache_->hits(), query_cache_->misses());
+  }
+  if (query_cache_metric_ != nullptr) {
+    get_metrics_registry().unregister(QUERY_CACHE_METRIC_TAG);
+  }
+
   LOG_TRACE("Exit");
 }
 
 void QueryCacheStage::handle_event(StageEvent *event) {
   LOG_TRACE("Enter\n");
 
-  // Add callback to update query cache
-  /*
-  CompletionCallback *cb = new (std::nothrow) CompletionCallback(this, nullptr);
-  if (cb == nullptr) {
-    LOG_ERROR("Failed to new callback for SQLStageEvent");
-    event->done_immediate();
+  if (query_cache_ != nullptr && handle_request(static_cast<SQLStageEvent *>(event))) {
+    LOG_TRACE("Exit\n");
     return;
   }
-
-  event->push_callback(cb);
-   */
-  // do nothing here, pass the event to the next stage
   plan_cache_stage->handle_event(event);
 
   LOG_TRACE("Exit\n");
@@ -84,9 +122,97 @@ void QueryCacheStage::callback_event(StageEvent *event,
                                     CallbackContext *context) {
   LOG_TRACE("Enter\n");
 
-  // update data to query cache here
-  // event->done_immediate();
+  SessionEvent *session_event = static_cast<SessionEvent *>(event);
+  QueryCacheContext *query_context = static_cast<QueryCacheContext *>(context);
+  const char *response = session_event->get_response();
+  const int len = session_event->get_response_len();
+  if (len > 0 && 0 != strcmp(response, "FAILURE\n")) {
+    query_context->entry.response.assign(response, len);
+    query_cache_->put(query_context->key, std::move(query_context->entry));
+  }
+  // 继续执行SessionStage的回调，返回结果
+  session_event->done_immediate();
 
   LOG_TRACE("Exit\n");
   return;
 }
+
+bool QueryCacheStage::handle_request(SQLStageEvent *sql_event) {
+  SessionEvent *session_event = sql_event->session_event();
+  Session *session = session_event->get_client()->session;
+  // 事务中能看到自己未提交的修改，不能使用缓存
+  if (session->is_trx_multi_operation_mode()) {
+    return false;
+  }
+  NormalizedSql normalized;
+  if (!normalize_sql(sql_event->get_sql().c_str(), normalized) ||
+      0 != strncasecmp(normalized.text.c_str(), "select ", 7)) {
+    return false;
+  }
+  Db *db = DefaultHandler::get_default().find_db(session->get_current_db().c_str());
+  if (db == nullptr) {
+    return false;
+  }
+
+  std::string key = session->get_current_db() + ":" + normalized.text;
+  for (const NormalizedSql::Literal &literal : normalized.literals) {
+    key += '\0';
+    key += literal.type == NormalizedSql::STRING_LITERAL ? literal.text : std::string("#") + literal.text;
+  }
+  std::string response;
+  if (query_cache_->get(key, db, response)) {
+    LOG_DEBUG("Query cache hit: %s", sql_event->get_sql().c_str());
+    session_event->set_response(std::move(response));
+    session_event->done_immediate();
+    sql_event->done_immediate();
+    return true;
+  }
+
+  // sql中与表同名的标识符都当作查询用到的表，多出来的表只会让结果更早失效
+  QueryCacheContext *context = new (std::nothrow) QueryCacheContext();
+  if (context == nullptr) {
+    return false;
+  }
+  context->key = std::move(key);
+  context->entry.schema_version = db->schema_version();
+  const std::string &text = normalized.text;
+  for (size_t begin = 0; begin < text.size();) {
+    size_t end = text.find(' ', begin);
+    if (end == std::string::npos) {
+      end = text.size();
+    }
+    std::string token = text.substr(begin, end - begin);
+    begin = end + 1;
+
+    Table *table = db->find_table(token.c_str());
+    if (table == nullptr) {
+      continue;
+    }
+    bool found = false;
+    for (const QueryCache::TableVersion &table_version : context->entry.tables) {
+      found = found || table_version.table_name == token;
+    }
+    if (found) {
+      continue;
+    }
+    // 有其它事务未提交的修改时结果可能在回滚之后失效
+    if (table->pending_operations() > 0) {
+      delete context;
+      return false;
+    }
+    context->entry.tables.push_back(QueryCache::TableVersion{token, table->data_version()});
+  }
+  if (context->entry.tables.empty()) {
+    delete context;
+    return false;
+  }
+
+  CompletionCallback *cb = new (std::nothrow) CompletionCallback(this, context);
+  if (cb == nullptr) {
+    LOG_ERROR("Failed to new callback for SessionEvent");
+    delete context;
+    return false;
+  }
+  session_event->push_callback(cb);
+  return false;
+}
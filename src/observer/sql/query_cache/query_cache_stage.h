@@ -1,7 +1,12 @@
 #ifndef __OBSERVER_SQL_QUERY_CACHE_STAGE_H__
 #define __OBSERVER_SQL_QUERY_CACHE_STAGE_H__
 
+#include <memory>
+
 #include "common/seda/stage.h"
+#include "sql/query_cache/query_cache.h"
+
+class SQLStageEvent;
 
 class QueryCacheStage : public common::Stage {
 public:
@@ -20,8 +25,13 @@ protected:
                      common::CallbackContext *context);
 
 protected:
+  // 命中缓存时直接返回结果，否则在会话事件上注册回调，执行完之后缓存结果
+  bool handle_request(SQLStageEvent *sql_event);
+
 private:
   Stage *plan_cache_stage = nullptr;
+  std::unique_ptr<QueryCache> query_cache_;
+  std::unique_ptr<QueryCacheMetric> query_cache_metric_;
 };
 
 #endif //__OBSERVER_SQL_QUERY_CACHE_STAGE_H__
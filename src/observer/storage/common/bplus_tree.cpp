@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "storage/common/bplus_tree.h"
 #include "storage/default/disk_buffer_pool.h"
 #include "rc.h"
@@ -12,18 +14,346 @@ int float_compare(float f1, float f2) {
   return result > 0 ? 1: -1;
 }
 
-IndexNode * BplusTreeHandler::get_index_node(char *page_data) const {
-  IndexNode *node = (IndexNode  *)(page_data + sizeof(IndexFileHeader));
-  node->keys = (char *)node + sizeof(IndexNode);
-  node->rids = (RID *)(node->keys + file_header_.order * file_header_.key_length);
+// 倒排格式下所有key使用同一个RID，保证每个属性值在树中只有一项
+static const RID POSTING_KEY_RID = {-1, -1};
+
+static const int NODE_SPACE = (int)(BP_PAGE_DATA_SIZE - sizeof(IndexFileHeader));
+
+static int key_strlen(const char *key, int attr_length) {
+  return (int)strnlen(key, attr_length);
+}
+
+// 两个key属性部分的公共前缀长度，不超过任一字符串的长度
+static int common_prefix(const char *key1, const char *key2, int attr_length) {
+  int i = 0;
+  while (i < attr_length && key1[i] == key2[i] && key1[i] != 0) {
+    i++;
+  }
+  return i;
+}
+
+IndexNode *BplusTreeHandler::load_node(char *page_data, std::vector<char> &buffer) const {
+  if (!file_header_.key_compress) {
+    return get_index_node(page_data);
+  }
+  const int key_length = file_header_.key_length;
+  const int attr_length = file_header_.attr_length;
+  buffer.assign(sizeof(IndexNode) + file_header_.order * (key_length + sizeof(RID)), 0);
+  IndexNode *node = (IndexNode *)buffer.data();
+  node->rid_offset = file_header_.order * key_length;
+
+  const CompressedIndexNode *header = (const CompressedIndexNode *)(page_data + sizeof(IndexFileHeader));
+  node->is_leaf = header->is_leaf;
+  node->key_num = header->key_num;
+  node->parent = header->parent;
+
+  const char *prefix = (const char *)(header + 1);
+  const char *entry = prefix + header->prefix_len;
+  const int entry_length = header->suffix_len + sizeof(RID);
+  for (int i = 0; i < header->key_num; i++, entry += entry_length) {
+    char *key = node->keys() + i * key_length;
+    memcpy(key, prefix, header->prefix_len);
+    memcpy(key + header->prefix_len, entry, header->suffix_len);
+    memcpy(key + attr_length, entry + header->suffix_len, sizeof(RID));
+  }
+  memcpy(node->rids(), entry, (header->key_num + 1) * sizeof(RID));
+  if (node->is_leaf) {
+    node->rids()[file_header_.order - 1].page_num = header->next_leaf;
+    node->rids()[file_header_.order - 1].slot_num = -1;
+  }
+  return node;
+}
+
+IndexNode *BplusTreeHandler::init_node(char *page_data, std::vector<char> &buffer, bool is_leaf) const {
+  IndexNode *node;
+  if (!file_header_.key_compress) {
+    node = get_index_node(page_data);
+    node->rid_offset = file_header_.order * file_header_.key_length;
+  } else {
+    CompressedIndexNode *header = (CompressedIndexNode *)(page_data + sizeof(IndexFileHeader));
+    memset(header, 0, sizeof(CompressedIndexNode));
+    header->next_leaf = -1;
+    node = load_node(page_data, buffer);
+  }
+  node->is_leaf = is_leaf;
+  node->key_num = 0;
+  node->parent = -1;
   return node;
 }
 
+int BplusTreeHandler::encoded_size(const IndexNode *node) const {
+  if (!file_header_.key_compress) {
+    return node->key_num < file_header_.order ? 0 : NODE_SPACE + 1;
+  }
+  const int attr_length = file_header_.attr_length;
+  int prefix_len = 0;
+  int max_len = 0;
+  if (node->key_num > 0) {
+    prefix_len = key_strlen(node->keys(), attr_length);
+  }
+  for (int i = 0; i < node->key_num; i++) {
+    const char *key = node->keys() + i * file_header_.key_length;
+    prefix_len = std::min(prefix_len, common_prefix(node->keys(), key, attr_length));
+    max_len = std::max(max_len, key_strlen(key, attr_length));
+  }
+  if (node->key_num + 1 > file_header_.order) {
+    return NODE_SPACE + 1;
+  }
+  int suffix_len = max_len - prefix_len;
+  return sizeof(CompressedIndexNode) + prefix_len + node->key_num * (suffix_len + sizeof(RID)) +
+         (node->key_num + 1) * sizeof(RID);
+}
+
+bool BplusTreeHandler::store_node(char *page_data, const IndexNode *node) const {
+  if (!file_header_.key_compress) {
+    return true;
+  }
+  if (encoded_size(node) > NODE_SPACE) {
+    LOG_ERROR("Index node is too large to store. key num=%d", node->key_num);
+    return false;
+  }
+  const int key_length = file_header_.key_length;
+  const int attr_length = file_header_.attr_length;
+  int prefix_len = 0;
+  int max_len = 0;
+  if (node->key_num > 0) {
+    prefix_len = key_strlen(node->keys(), attr_length);
+  }
+  for (int i = 0; i < node->key_num; i++) {
+    const char *key = node->keys() + i * key_length;
+    prefix_len = std::min(prefix_len, common_prefix(node->keys(), key, attr_length));
+    max_len = std::max(max_len, key_strlen(key, attr_length));
+  }
+
+  CompressedIndexNode *header = (CompressedIndexNode *)(page_data + sizeof(IndexFileHeader));
+  header->is_leaf = node->is_leaf;
+  header->key_num = node->key_num;
+  header->parent = node->parent;
+  header->next_leaf = node->is_leaf ? node->rids()[file_header_.order - 1].page_num : -1;
+  header->prefix_len = prefix_len;
+  header->suffix_len = max_len - prefix_len;
+
+  char *prefix = (char *)(header + 1);
+  memcpy(prefix, node->keys(), prefix_len);
+  char *entry = prefix + prefix_len;
+  for (int i = 0; i < node->key_num; i++, entry += header->suffix_len + sizeof(RID)) {
+    const char *key = node->keys() + i * key_length;
+    int len = key_strlen(key, attr_length) - prefix_len;
+    memcpy(entry, key + prefix_len, len);
+    memset(entry + len, 0, header->suffix_len - len);
+    memcpy(entry + header->suffix_len, key + attr_length, sizeof(RID));
+  }
+  memcpy(entry, node->rids(), (node->key_num + 1) * sizeof(RID));
+  return true;
+}
+
+// 按页头中的前缀/后缀长度估算插入一个key之后的大小，不需要解码整个节点
+static bool compressed_has_room(const IndexFileHeader &file_header, char *page_data, const char *pkey) {
+  const CompressedIndexNode *header = (const CompressedIndexNode *)(page_data + sizeof(IndexFileHeader));
+  const int attr_length = file_header.attr_length;
+  int key_num = header->key_num + 1;
+  if (key_num + 1 > file_header.order) {
+    return false;
+  }
+  int key_len = key_strlen(pkey, attr_length);
+  int prefix_len = key_len;
+  int max_len = key_len;
+  if (header->key_num > 0) {
+    const char *prefix = (const char *)(header + 1);
+    prefix_len = 0;
+    while (prefix_len < header->prefix_len && prefix_len < key_len && prefix[prefix_len] == pkey[prefix_len]) {
+      prefix_len++;
+    }
+    max_len = std::max(max_len, header->prefix_len + header->suffix_len);
+  }
+  int size = sizeof(CompressedIndexNode) + prefix_len + key_num * (max_len - prefix_len + sizeof(RID)) +
+             (key_num + 1) * sizeof(RID);
+  return size <= NODE_SPACE;
+}
+
+bool BplusTreeHandler::leaf_has_room(char *page_data, const char *pkey) const {
+  if (!file_header_.key_compress) {
+    return get_index_node(page_data)->key_num < file_header_.order - 1;
+  }
+  return compressed_has_room(file_header_, page_data, pkey);
+}
+
+bool BplusTreeHandler::intern_has_room(char *page_data, const char *pkey) const {
+  if (!file_header_.key_compress) {
+    return ((IndexNode *)(page_data + sizeof(IndexFileHeader)))->key_num < file_header_.order - 1;
+  }
+  return compressed_has_room(file_header_, page_data, pkey);
+}
+
+// 能否再放下任意一个key。压缩格式按没有公共前缀、长度为attr_length的key估算，
+// 这样的key放得下时其他key也一定放得下
+bool BplusTreeHandler::intern_has_room_for_any(char *page_data) const {
+  if (!file_header_.key_compress) {
+    return get_index_node(page_data)->key_num < file_header_.order - 1;
+  }
+  const CompressedIndexNode *header = (const CompressedIndexNode *)(page_data + sizeof(IndexFileHeader));
+  int key_num = header->key_num + 1;
+  if (key_num + 1 > file_header_.order) {
+    return false;
+  }
+  int size = sizeof(CompressedIndexNode) + key_num * (file_header_.attr_length + sizeof(RID)) +
+             (key_num + 1) * sizeof(RID);
+  return size <= NODE_SPACE;
+}
+
+// 删除一个key之后节点不会下溢，也不会引起根节点的变化
+bool BplusTreeHandler::delete_is_safe(char *page_data) const {
+  const IndexNode *node = get_index_node(page_data);  // 两种格式的节点头前三个字段相同
+  if (node->parent == -1) {
+    return node->is_leaf || node->key_num > 1;
+  }
+  return node->key_num - 1 >= min_keys(node->is_leaf);
+}
+
+int BplusTreeHandler::min_keys(bool is_leaf) const {
+  if (is_leaf) {
+    return file_header_.fill_order / 2;
+  }
+  return (file_header_.fill_order + 1) / 2 - 1;
+}
+
+// 分隔key只需要满足 left_key < separator <= right_key。压缩索引取right_key的最短前缀，
+// 内部节点里的key更短，扇出更大
+void BplusTreeHandler::make_separator(const char *left_key, const char *right_key, char *separator) const {
+  memcpy(separator, right_key, file_header_.key_length);
+  if (!file_header_.key_compress) {
+    return;
+  }
+  const int attr_length = file_header_.attr_length;
+  int i = common_prefix(left_key, right_key, attr_length);
+  if (i < attr_length && left_key[i] != right_key[i]) {
+    memset(separator + i + 1, 0, attr_length - i - 1);
+  }
+}
+
+const char *BplusTreeHandler::node_key(char *page_data, int index, char *buffer) const {
+  if (!file_header_.key_compress) {
+    return get_index_node(page_data)->keys() + index * file_header_.key_length;
+  }
+  const CompressedIndexNode *header = (const CompressedIndexNode *)(page_data + sizeof(IndexFileHeader));
+  const int attr_length = file_header_.attr_length;
+  const char *prefix = (const char *)(header + 1);
+  const char *entry = prefix + header->prefix_len + index * (header->suffix_len + sizeof(RID));
+  memcpy(buffer, prefix, header->prefix_len);
+  memcpy(buffer + header->prefix_len, entry, header->suffix_len);
+  memset(buffer + header->prefix_len + header->suffix_len, 0, attr_length - header->prefix_len - header->suffix_len);
+  memcpy(buffer + attr_length, entry + header->suffix_len, sizeof(RID));
+  return buffer;
+}
+
+RID BplusTreeHandler::node_rid(char *page_data, int index) const {
+  if (!file_header_.key_compress) {
+    return get_index_node(page_data)->rids()[index];
+  }
+  const CompressedIndexNode *header = (const CompressedIndexNode *)(page_data + sizeof(IndexFileHeader));
+  const char *rids = (const char *)(header + 1) + header->prefix_len +
+                     header->key_num * (header->suffix_len + sizeof(RID));
+  RID rid;
+  memcpy(&rid, rids + index * sizeof(RID), sizeof(RID));
+  return rid;
+}
+
+PageNum BplusTreeHandler::leaf_next_page(char *page_data) const {
+  if (!file_header_.key_compress) {
+    return get_index_node(page_data)->rids()[file_header_.order - 1].page_num;
+  }
+  return ((const CompressedIndexNode *)(page_data + sizeof(IndexFileHeader)))->next_leaf;
+}
+
+BplusTreeHandler::~BplusTreeHandler() {
+  for (std::atomic<std::shared_mutex *> &segment : node_latches_) {
+    delete[] segment.load();
+  }
+}
+
+// 节点锁按需分段分配，页号只增不减，不同页的锁互不影响
+std::shared_mutex &BplusTreeHandler::node_latch(PageNum page_num) {
+  std::atomic<std::shared_mutex *> &segment = node_latches_[page_num / NODE_LATCH_SEGMENT];
+  std::shared_mutex *latches = segment.load(std::memory_order_acquire);
+  if (latches == nullptr) {
+    std::shared_mutex *created = new std::shared_mutex[NODE_LATCH_SEGMENT];
+    if (segment.compare_exchange_strong(latches, created, std::memory_order_acq_rel)) {
+      latches = created;
+    } else {
+      delete[] created;
+    }
+  }
+  return latches[page_num % NODE_LATCH_SEGMENT];
+}
+
+bool BplusTreeHandler::NodeLatches::lock(PageNum page_num) {
+  if (std::find(pages_.begin(), pages_.end(), page_num) != pages_.end()) {
+    return false;
+  }
+  handler_.node_latch(page_num).lock();
+  pages_.push_back(page_num);
+  return true;
+}
+
+void BplusTreeHandler::NodeLatches::unlock(PageNum page_num) {
+  auto iter = std::find(pages_.begin(), pages_.end(), page_num);
+  if (iter != pages_.end()) {
+    handler_.node_latch(page_num).unlock();
+    pages_.erase(iter);
+  }
+}
+
+void BplusTreeHandler::NodeLatches::release_ancestors() {
+  if (root_guard_.owns_lock()) {
+    root_guard_.unlock();
+  }
+  if (pages_.size() > 1) {
+    for (size_t i = 0; i + 1 < pages_.size(); i++) {
+      handler_.node_latch(pages_[i]).unlock();
+    }
+    pages_.erase(pages_.begin(), pages_.end() - 1);
+  }
+}
+
+void BplusTreeHandler::NodeLatches::release_all() {
+  for (PageNum page_num : pages_) {
+    handler_.node_latch(page_num).unlock();
+  }
+  pages_.clear();
+  if (root_guard_.owns_lock()) {
+    root_guard_.unlock();
+  }
+  for (PageNum page_num : disposed_) {
+    RC rc = handler_.disk_buffer_pool_->dispose_page(handler_.file_id_, page_num);
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to dispose index page %d. rc=%d:%s", page_num, rc, strrc(rc));
+    }
+  }
+  disposed_.clear();
+}
+
 RC BplusTreeHandler::sync() {
+  std::unique_lock<std::shared_mutex> root_guard(root_latch_);
+  if (header_dirty_) {
+    // 根节点变化后文件头只改了内存中的副本，需要写回第1页
+    BPPageHandle page_handle;
+    char *pdata;
+    RC rc = disk_buffer_pool_->get_this_page(file_id_, 1, &page_handle);
+    if (rc != SUCCESS) {
+      LOG_ERROR("Failed to get index file header page. rc=%d:%s", rc, strrc(rc));
+      return rc;
+    }
+    disk_buffer_pool_->get_data(&page_handle, &pdata);
+    memcpy(pdata, &file_header_, sizeof(IndexFileHeader));
+    disk_buffer_pool_->mark_dirty(&page_handle);
+    disk_buffer_pool_->unpin_page(&page_handle);
+    header_dirty_ = false;
+  }
   return disk_buffer_pool_->flush_all_pages(file_id_);
 }
 
-RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_length)
+RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_length, bool posting_list,
+                            bool key_compress)
 {
   BPPageHandle page_handle;
   IndexNode *root;
@@ -59,19 +389,39 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_
     return rc;
   }
   IndexFileHeader *file_header =(IndexFileHeader *)pdata;
+  file_header->magic = INDEX_FILE_MAGIC;
+  file_header->version = INDEX_FILE_VERSION;
   file_header->attr_length = attr_length;
   file_header->key_length = attr_length + sizeof(RID);
   file_header->attr_type = attr_type;
   file_header->node_num = 1;
   file_header->order=((int)BP_PAGE_DATA_SIZE-sizeof(IndexFileHeader)-sizeof(IndexNode))/(attr_length+2*sizeof(RID));
+  file_header->fill_order = file_header->order;
   file_header->root_page = page_num;
-
-  root = get_index_node(pdata);
-  root->is_leaf = 1;
-  root->key_num = 0;
-  root->parent = -1;
-  root->keys = nullptr;
-  root->rids = nullptr;
+  file_header->posting_list = posting_list ? 1 : 0;
+  file_header->key_compress = key_compress && attr_type == CHARS ? 1 : 0;
+  if (file_header->key_compress) {
+    // 压缩后节点能放下的key数取决于数据，order只作为解码缓冲区的上限(后缀长度为0时的容量)
+    int space = NODE_SPACE - sizeof(CompressedIndexNode) - sizeof(RID);
+    file_header->fill_order = space / (attr_length + 2 * sizeof(RID));
+    file_header->order = space / (2 * sizeof(RID));
+  }
+
+  if (file_header->key_compress) {
+    CompressedIndexNode *header = (CompressedIndexNode *)(pdata + sizeof(IndexFileHeader));
+    header->is_leaf = 1;
+    header->key_num = 0;
+    header->parent = -1;
+    header->next_leaf = -1;
+    header->prefix_len = 0;
+    header->suffix_len = 0;
+  } else {
+    root = get_index_node(pdata);
+    root->is_leaf = 1;
+    root->key_num = 0;
+    root->parent = -1;
+    root->rid_offset = file_header->order * file_header->key_length;
+  }
 
   rc = disk_buffer_pool->mark_dirty(&page_handle);
   if(rc!=SUCCESS){
@@ -88,6 +438,7 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_
 
   memcpy(&file_header_, pdata, sizeof(file_header_));
   header_dirty_ = false;
+  tree_height_ = 1;
 
   return SUCCESS;
 }
@@ -115,6 +466,13 @@ RC BplusTreeHandler::open(const char *file_name) {
     return rc;
   }
   memcpy(&file_header_,pdata,sizeof(IndexFileHeader));
+  if(file_header_.magic != INDEX_FILE_MAGIC || file_header_.version != INDEX_FILE_VERSION){
+    LOG_ERROR("Unsupported index file format. file name=%s, magic=%x, version=%d, expect version=%d",
+              file_name, file_header_.magic, file_header_.version, INDEX_FILE_VERSION);
+    disk_buffer_pool->unpin_page(&page_handle);
+    disk_buffer_pool->close_file(file_id);
+    return RC::FORMAT;
+  }
   header_dirty_ = false;
   disk_buffer_pool_ = disk_buffer_pool;
   file_id_ = file_id;
@@ -123,6 +481,26 @@ RC BplusTreeHandler::open(const char *file_name) {
   if(rc!=SUCCESS){
     return rc;
   }
+
+  // 沿最左边的路径数出树高
+  tree_height_ = 1;
+  std::vector<char> node_buffer;
+  PageNum page_num = file_header_.root_page;
+  while (true) {
+    rc = disk_buffer_pool->get_this_page(file_id, page_num, &page_handle);
+    if (rc != SUCCESS) {
+      return rc;
+    }
+    disk_buffer_pool->get_data(&page_handle, &pdata);
+    IndexNode *node = load_node(pdata, node_buffer);
+    bool is_leaf = node->is_leaf;
+    page_num = node->rids()[0].page_num;
+    disk_buffer_pool->unpin_page(&page_handle);
+    if (is_leaf) {
+      break;
+    }
+    tree_height_++;
+  }
   return SUCCESS;
 }
 
@@ -196,50 +574,54 @@ int CmpKey(AttrType attr_type, int attr_length, const char *pdata, const char *p
   return CmpRid(rid1, rid2);
 }
 
-RC BplusTreeHandler::find_leaf(const char *pkey,PageNum *leaf_page) {
+RC BplusTreeHandler::find_leaf(const char *pkey, PageNum *leaf_page, bool exclusive) {
   RC rc;
   BPPageHandle page_handle;
-  IndexNode *node;
   char *pdata;
-  int i,tmp;
-  rc = disk_buffer_pool_->get_this_page(file_id_, file_header_.root_page, &page_handle);
-  if(rc!=SUCCESS){
-    return rc;
-  }
+  std::vector<char> key_buffer(file_header_.key_length);
 
-  rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
-  if(rc!=SUCCESS){
-    return rc;
+  // 按树高判断下一层是不是叶子，不需要先读孩子的页面就能决定加哪种锁
+  std::shared_lock<std::shared_mutex> root_guard(root_latch_);
+  PageNum page_num = file_header_.root_page;
+  int level = tree_height_;
+  bool leaf_exclusive = exclusive && level == 1;
+  if (leaf_exclusive) {
+    node_latch(page_num).lock();
+  } else {
+    node_latch(page_num).lock_shared();
   }
-  node = get_index_node(pdata);
-  while(0 == node->is_leaf){
-    for(i = 0; i < node->key_num; i++){
-      tmp = CmpKey(file_header_.attr_type, file_header_.attr_length,pkey,node->keys + i * file_header_.key_length);
-      if(tmp < 0)
-        break;
-    }
-    rc = disk_buffer_pool_->unpin_page(&page_handle);
-    if(rc!=SUCCESS){
+  root_guard.unlock();
+
+  while (level > 1) {
+    rc = disk_buffer_pool_->get_this_page(file_id_, page_num, &page_handle);
+    if (rc != SUCCESS) {
+      node_latch(page_num).unlock_shared();
       return rc;
     }
-    rc = disk_buffer_pool_->get_this_page(file_id_, node->rids[i].page_num, &page_handle);
-    if(rc!=SUCCESS){
-      return rc;
+    disk_buffer_pool_->get_data(&page_handle, &pdata);
+    IndexNode *node = get_index_node(pdata);
+    int i = 0;
+    if (pkey != nullptr) {
+      for (; i < node->key_num; i++) {
+        if (CmpKey(file_header_.attr_type, file_header_.attr_length, pkey, node_key(pdata, i, key_buffer.data())) < 0) {
+          break;
+        }
+      }
     }
-    rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
-    if(rc!=SUCCESS){
-      return rc;
+    PageNum child = node_rid(pdata, i).page_num;
+    disk_buffer_pool_->unpin_page(&page_handle);
+
+    level--;
+    leaf_exclusive = exclusive && level == 1;
+    if (leaf_exclusive) {
+      node_latch(child).lock();
+    } else {
+      node_latch(child).lock_shared();
     }
-    node = get_index_node(pdata);
-  }
-  rc = disk_buffer_pool_->get_page_num(&page_handle, leaf_page);
-  if(rc!=SUCCESS){
-    return rc;
-  }
-  rc = disk_buffer_pool_->unpin_page(&page_handle);
-  if(rc!=SUCCESS){
-    return rc;
+    node_latch(page_num).unlock_shared();
+    page_num = child;
   }
+  *leaf_page = page_num;
   return SUCCESS;
 }
 
@@ -260,25 +642,31 @@ RC BplusTreeHandler::insert_into_leaf(PageNum leaf_page, const char *pkey, const
   if(rc != SUCCESS){
     return rc;
   }
-  node = get_index_node(pdata);
+  std::vector<char> node_buffer;
+  node = load_node(pdata, node_buffer);
 
   for(insert_pos = 0; insert_pos < node->key_num; insert_pos++){
-    tmp = CmpKey(file_header_.attr_type, file_header_.attr_length, pkey, node->keys + insert_pos * file_header_.key_length);
+    tmp = CmpKey(file_header_.attr_type, file_header_.attr_length, pkey, node->keys() + insert_pos * file_header_.key_length);
     if (tmp == 0) {
+      disk_buffer_pool_->unpin_page(&page_handle);
       return RC::RECORD_DUPLICATE_KEY;
     }
     if(tmp < 0)
       break;
   }
   for(i = node->key_num; i > insert_pos; i--){
-    from = node->keys+(i-1)*file_header_.key_length;
-    to = node->keys+i*file_header_.key_length;
+    from = node->keys()+(i-1)*file_header_.key_length;
+    to = node->keys()+i*file_header_.key_length;
     memcpy(to, from, file_header_.key_length);
-    memcpy(node->rids + i, node->rids + i-1, sizeof(RID));
+    memcpy(node->rids() + i, node->rids() + i-1, sizeof(RID));
   }
-  memcpy(node->keys + insert_pos * file_header_.key_length, pkey, file_header_.key_length);
-  memcpy(node->rids + insert_pos, rid, sizeof(RID));
+  memcpy(node->keys() + insert_pos * file_header_.key_length, pkey, file_header_.key_length);
+  memcpy(node->rids() + insert_pos, rid, sizeof(RID));
   node->key_num++; //叶子结点增加一条记录
+  if(!store_node(pdata, node)){
+    disk_buffer_pool_->unpin_page(&page_handle);
+    return RC::NOMEM;
+  }
   rc = disk_buffer_pool_->mark_dirty(&page_handle);
   if(rc != SUCCESS){
     return rc;
@@ -292,6 +680,7 @@ RC BplusTreeHandler::insert_into_leaf(PageNum leaf_page, const char *pkey, const
 
 RC BplusTreeHandler::print() {
   IndexNode *node;
+  std::vector<char> node_buffer;
   RC rc;
   BPPageHandle page_handle;
   int i,j;
@@ -312,10 +701,10 @@ RC BplusTreeHandler::print() {
     if(rc!=SUCCESS){
       return rc;
     }
-    node = get_index_node(pdata);
+    node = load_node(pdata, node_buffer);
     printf("page_num :%d %d\n",i,node->is_leaf);
     for(j=0;j<node->key_num&&j<6;j++){
-      printf("keynum :%d rids:page_num :%d,slotnum :%d\n", node->key_num, node->rids[j].page_num, node->rids[j].slot_num);
+      printf("keynum :%d rids:page_num :%d,slotnum :%d\n", node->key_num, node->rids()[j].page_num, node->rids()[j].slot_num);
     }
     printf("\n");
     rc = disk_buffer_pool_->unpin_page(&page_handle);
@@ -326,7 +715,8 @@ RC BplusTreeHandler::print() {
   return rc;
 }
 
-RC BplusTreeHandler::insert_into_leaf_after_split(PageNum leaf_page, const char *pkey, const RID *rid) {
+RC BplusTreeHandler::insert_into_leaf_after_split(PageNum leaf_page, const char *pkey, const RID *rid,
+                                                  NodeLatches &latches) {
   RC rc;
   BPPageHandle  page_handle1,page_handle2;
   IndexNode *leaf,*new_node;
@@ -360,10 +750,12 @@ RC BplusTreeHandler::insert_into_leaf_after_split(PageNum leaf_page, const char
   if(rc!=SUCCESS){
     return rc;
   }
+  latches.lock(new_page);
   new_node = get_index_node(pdata);
   new_node->key_num = 0;
   new_node->is_leaf = 1;
   new_node->parent = leaf->parent;
+  new_node->rid_offset = file_header_.order * file_header_.key_length;
 
   parent_page = leaf->parent;
 
@@ -383,15 +775,15 @@ RC BplusTreeHandler::insert_into_leaf_after_split(PageNum leaf_page, const char
   }
 
   for(insert_pos=0;insert_pos<leaf->key_num;insert_pos++){
-    tmp=CmpKey(file_header_.attr_type, file_header_.attr_length, pkey, leaf->keys+insert_pos*file_header_.key_length);
+    tmp=CmpKey(file_header_.attr_type, file_header_.attr_length, pkey, leaf->keys()+insert_pos*file_header_.key_length);
     if(tmp<0)
       break;
   }
   for(i=0,j=0;i<leaf->key_num;i++,j++){
     if(j==insert_pos)
       j++;
-    memcpy(temp_keys+j*file_header_.key_length,leaf->keys+i*file_header_.key_length,file_header_.key_length);
-    memcpy(temp_pointers+j,leaf->rids+i,sizeof(RID));
+    memcpy(temp_keys+j*file_header_.key_length,leaf->keys()+i*file_header_.key_length,file_header_.key_length);
+    memcpy(temp_pointers+j,leaf->rids()+i,sizeof(RID));
   }
   memcpy(temp_keys+insert_pos*file_header_.key_length,pkey,file_header_.key_length);
   memcpy(temp_pointers+insert_pos,rid,sizeof(RID));
@@ -399,31 +791,31 @@ RC BplusTreeHandler::insert_into_leaf_after_split(PageNum leaf_page, const char
   split=file_header_.order/2;
 
   for(i=0;i<split;i++){
-    memcpy(leaf->keys+i*file_header_.key_length,temp_keys+i*file_header_.key_length,file_header_.key_length);
-    memcpy(leaf->rids+i,temp_pointers+i,sizeof(RID));
+    memcpy(leaf->keys()+i*file_header_.key_length,temp_keys+i*file_header_.key_length,file_header_.key_length);
+    memcpy(leaf->rids()+i,temp_pointers+i,sizeof(RID));
   }
   leaf->key_num=split;
 
   for(i=split,j=0;i<file_header_.order;i++,j++){
-    memcpy(new_node->keys+j*file_header_.key_length,temp_keys+i*file_header_.key_length,file_header_.key_length);
-    memcpy(new_node->rids+j,temp_pointers+i,sizeof(RID));
+    memcpy(new_node->keys()+j*file_header_.key_length,temp_keys+i*file_header_.key_length,file_header_.key_length);
+    memcpy(new_node->rids()+j,temp_pointers+i,sizeof(RID));
     new_node->key_num++;
   }
 
   free(temp_pointers);
   free(temp_keys);
 
-  memcpy(new_node->rids+file_header_.order-1,leaf->rids+file_header_.order-1,sizeof(RID));
+  memcpy(new_node->rids()+file_header_.order-1,leaf->rids()+file_header_.order-1,sizeof(RID));
   tmprid.page_num = new_page;
   tmprid.slot_num = -1;
-  memcpy(leaf->rids+file_header_.order-1,&tmprid,sizeof(RID));
+  memcpy(leaf->rids()+file_header_.order-1,&tmprid,sizeof(RID));
 
   new_key=(char *)malloc(file_header_.key_length);
   if(new_key == nullptr){
     LOG_ERROR("Failed to alloc memory for new key. size=%d", file_header_.key_length);
     return RC::NOMEM;
   }
-  memcpy(new_key,new_node->keys,file_header_.key_length);
+  memcpy(new_key,new_node->keys(),file_header_.key_length);
 
   rc = disk_buffer_pool_->mark_dirty(&page_handle1);
   if(rc!=SUCCESS){
@@ -448,7 +840,7 @@ RC BplusTreeHandler::insert_into_leaf_after_split(PageNum leaf_page, const char
     return rc;
   }
 
-  rc=insert_into_parent(parent_page,leaf_page,new_key,new_page); // 插入失败，应该回滚之前的叶子节点
+  rc=insert_into_parent(parent_page,leaf_page,new_key,new_page,latches); // 插入失败，应该回滚之前的叶子节点
   if(rc!=SUCCESS){
     free(new_key);
     return rc;
@@ -474,20 +866,25 @@ RC BplusTreeHandler::insert_intern_node(PageNum parent_page,PageNum left_page,Pa
     return rc;
   }
 
-  node = get_index_node(pdata);
+  std::vector<char> node_buffer;
+  node = load_node(pdata, node_buffer);
 
   insert_pos=0;
-  while((insert_pos<=node->key_num)&&(node->rids[insert_pos].page_num != left_page))
+  while((insert_pos<=node->key_num)&&(node->rids()[insert_pos].page_num != left_page))
     insert_pos++;
   for(i=node->key_num;i>insert_pos;i--){
-    memcpy(node->rids+i+1,node->rids+i,sizeof(RID));
-    memcpy(node->keys+i*file_header_.key_length,node->keys+(i-1)*file_header_.key_length,file_header_.key_length);
+    memcpy(node->rids()+i+1,node->rids()+i,sizeof(RID));
+    memcpy(node->keys()+i*file_header_.key_length,node->keys()+(i-1)*file_header_.key_length,file_header_.key_length);
   }
   rid.page_num = right_page;
   rid.slot_num = BP_INVALID_PAGE_NUM; // change to invalid page num
-  memcpy(node->rids+insert_pos+1,&rid,sizeof(RID));
-  memcpy(node->keys+insert_pos*file_header_.key_length,pkey,file_header_.key_length);
+  memcpy(node->rids()+insert_pos+1,&rid,sizeof(RID));
+  memcpy(node->keys()+insert_pos*file_header_.key_length,pkey,file_header_.key_length);
   node->key_num++;
+  if(!store_node(pdata, node)){
+    disk_buffer_pool_->unpin_page(&page_handle);
+    return RC::NOMEM;
+  }
   rc = disk_buffer_pool_->mark_dirty(&page_handle);
   if(rc!=SUCCESS){
     return rc;
@@ -499,7 +896,8 @@ RC BplusTreeHandler::insert_intern_node(PageNum parent_page,PageNum left_page,Pa
   return SUCCESS;
 }
 
-RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,PageNum left_page,PageNum right_page,const char *pkey) {
+RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,PageNum left_page,PageNum right_page,const char *pkey,
+                                                    NodeLatches &latches) {
   RC rc;
   BPPageHandle page_handle1,page_handle2,child_page_handle;
   IndexNode *inter_node,*new_node,*child_node;
@@ -533,10 +931,12 @@ RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,PageNum l
     return rc;
   }
 
+  latches.lock(new_page);
   new_node = get_index_node(pdata);
   new_node->key_num=0;
   new_node->is_leaf=false;
   new_node->parent=inter_node->parent;
+  new_node->rid_offset = file_header_.order * file_header_.key_length;
 
   parent_page=inter_node->parent;
 
@@ -566,17 +966,17 @@ RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,PageNum l
   }
 
   insert_pos=0;
-  while((insert_pos<=inter_node->key_num)&&(inter_node->rids[insert_pos].page_num != left_page))
+  while((insert_pos<=inter_node->key_num)&&(inter_node->rids()[insert_pos].page_num != left_page))
     insert_pos++;
   for(i=0,j=0;i<inter_node->key_num+1;i++,j++){
     if(j==insert_pos+1)
       j++;
-    memcpy(temp_pointers+j,inter_node->rids+i,sizeof(RID));
+    memcpy(temp_pointers+j,inter_node->rids()+i,sizeof(RID));
   }
   for(i=0,j=0;i<inter_node->key_num;i++,j++){
     if(j==insert_pos)
       j++;
-    memcpy(temp_keys+j*file_header_.key_length,inter_node->keys+i*file_header_.key_length,file_header_.key_length);
+    memcpy(temp_keys+j*file_header_.key_length,inter_node->keys()+i*file_header_.key_length,file_header_.key_length);
   }
   tmprid.page_num = right_page;
   tmprid.slot_num = -1;
@@ -586,25 +986,26 @@ RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,PageNum l
   split=(file_header_.order+1)/2;
 
   for(i=0;i<split-1;i++){
-    memcpy(inter_node->keys+i*file_header_.key_length,temp_keys+i*file_header_.key_length,file_header_.key_length);
-    memcpy(inter_node->rids+i,temp_pointers+i,sizeof(RID));
+    memcpy(inter_node->keys()+i*file_header_.key_length,temp_keys+i*file_header_.key_length,file_header_.key_length);
+    memcpy(inter_node->rids()+i,temp_pointers+i,sizeof(RID));
   }
   inter_node->key_num=split-1;
-  memcpy(inter_node->rids+i,temp_pointers+i,sizeof(RID));
+  memcpy(inter_node->rids()+i,temp_pointers+i,sizeof(RID));
   memcpy(new_key,temp_keys+i*file_header_.key_length,file_header_.key_length);
 
   for(++i,j=0;i<file_header_.order;i++,j++){
-    memcpy(new_node->keys+j*file_header_.key_length,temp_keys+i*file_header_.key_length,file_header_.key_length);
-    memcpy(new_node->rids+j,temp_pointers+i,sizeof(RID));
+    memcpy(new_node->keys()+j*file_header_.key_length,temp_keys+i*file_header_.key_length,file_header_.key_length);
+    memcpy(new_node->rids()+j,temp_pointers+i,sizeof(RID));
     new_node->key_num++;
   }
-  memcpy(new_node->rids+j,temp_pointers+i,sizeof(RID));
+  memcpy(new_node->rids()+j,temp_pointers+i,sizeof(RID));
 
   free(temp_keys);
   free(temp_pointers);
 
   for(i=0;i<=new_node->key_num;i++){
-    child_page=new_node->rids[i].page_num;
+    child_page=new_node->rids()[i].page_num;
+    bool child_locked = latches.lock(child_page);
     rc = disk_buffer_pool_->get_this_page(file_id_, child_page, &child_page_handle);
     if(rc!=SUCCESS){
       free(new_key);
@@ -617,6 +1018,9 @@ RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,PageNum l
     }
     child_node=(IndexNode *)(pdata+sizeof(IndexFileHeader));
     child_node->parent=new_page;
+    if(child_locked){
+      latches.unlock(child_page);
+    }
     rc = disk_buffer_pool_->mark_dirty(&child_page_handle);
     if(rc!=SUCCESS){
       free(new_key);
@@ -651,7 +1055,7 @@ RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,PageNum l
   }
   // print();
 
-  rc=insert_into_parent(parent_page,inter_page,new_key,new_page);
+  rc=insert_into_parent(parent_page,inter_page,new_key,new_page,latches);
 
   // print();
   if(rc!=SUCCESS){
@@ -662,13 +1066,17 @@ RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,PageNum l
   return SUCCESS;
 }
 
-RC BplusTreeHandler::insert_into_parent(PageNum parent_page, PageNum left_page, const char *pkey,PageNum right_page) {
+RC BplusTreeHandler::insert_into_parent(PageNum parent_page, PageNum left_page, const char *pkey,PageNum right_page,
+                                        NodeLatches &latches) {
   RC rc;
   BPPageHandle page_handle;
   IndexNode *node;
   char *pdata;
   if(parent_page==-1){
-    return insert_into_new_root(left_page,pkey,right_page);
+    return insert_into_new_root(left_page,pkey,right_page,latches);
+  }
+  if(file_header_.key_compress){
+    return insert_into_parent_compressed(parent_page,left_page,pkey,right_page,latches);
   }
 
   rc = disk_buffer_pool_->get_this_page(file_id_, parent_page, &page_handle);
@@ -692,11 +1100,144 @@ RC BplusTreeHandler::insert_into_parent(PageNum parent_page, PageNum left_page,
     if(rc!=SUCCESS){
       return rc;
     }
-    return insert_intern_node_after_split(parent_page,left_page,right_page,pkey);
+    return insert_intern_node_after_split(parent_page,left_page,right_page,pkey,latches);
+  }
+}
+
+RC BplusTreeHandler::insert_into_parent_compressed(PageNum parent_page, PageNum left_page, const char *pkey, PageNum right_page,
+                                                   NodeLatches &latches) {
+  RC rc;
+  BPPageHandle page_handle;
+  char *pdata;
+  while(true){
+    rc = disk_buffer_pool_->get_this_page(file_id_, parent_page, &page_handle);
+    if(rc!=SUCCESS){
+      return rc;
+    }
+    disk_buffer_pool_->get_data(&page_handle, &pdata);
+    bool has_room = intern_has_room(pdata, pkey);
+    disk_buffer_pool_->unpin_page(&page_handle);
+    if(has_room){
+      break;
+    }
+
+    // 父节点分裂后left_page可能被移到新的节点上，重新读取它的父节点
+    rc = split_node(parent_page, latches);
+    if(rc!=SUCCESS){
+      return rc;
+    }
+    rc = disk_buffer_pool_->get_this_page(file_id_, left_page, &page_handle);
+    if(rc!=SUCCESS){
+      return rc;
+    }
+    disk_buffer_pool_->get_data(&page_handle, &pdata);
+    parent_page = ((IndexNode *)(pdata + sizeof(IndexFileHeader)))->parent;
+    disk_buffer_pool_->unpin_page(&page_handle);
+  }
+
+  rc = insert_intern_node(parent_page,left_page,right_page,pkey);
+  if(rc!=SUCCESS){
+    return rc;
+  }
+  rc = disk_buffer_pool_->get_this_page(file_id_, right_page, &page_handle);
+  if(rc!=SUCCESS){
+    return rc;
+  }
+  disk_buffer_pool_->get_data(&page_handle, &pdata);
+  ((IndexNode *)(pdata + sizeof(IndexFileHeader)))->parent = parent_page;
+  disk_buffer_pool_->mark_dirty(&page_handle);
+  return disk_buffer_pool_->unpin_page(&page_handle);
+}
+
+RC BplusTreeHandler::split_node(PageNum page_num, NodeLatches &latches) {
+  RC rc;
+  BPPageHandle page_handle,new_handle,child_handle;
+  char *pdata,*new_data,*child_data;
+  std::vector<char> node_buffer,new_buffer;
+  PageNum new_page;
+
+  rc = disk_buffer_pool_->get_this_page(file_id_, page_num, &page_handle);
+  if(rc!=SUCCESS){
+    return rc;
+  }
+  disk_buffer_pool_->get_data(&page_handle, &pdata);
+  IndexNode *node = load_node(pdata, node_buffer);
+  if(node->key_num < 2){
+    LOG_ERROR("Failed to split index node %d, key num=%d", page_num, node->key_num);
+    disk_buffer_pool_->unpin_page(&page_handle);
+    return RC::NOMEM;
+  }
+
+  rc = disk_buffer_pool_->allocate_page(file_id_, &new_handle);
+  if(rc!=SUCCESS){
+    disk_buffer_pool_->unpin_page(&page_handle);
+    return rc;
+  }
+  disk_buffer_pool_->get_data(&new_handle, &new_data);
+  disk_buffer_pool_->get_page_num(&new_handle, &new_page);
+  latches.lock(new_page);
+  IndexNode *new_node = init_node(new_data, new_buffer, node->is_leaf);
+  new_node->parent = node->parent;
+
+  const int key_length = file_header_.key_length;
+  std::vector<char> up_key(key_length);
+  int split = node->key_num / 2;
+  if(node->is_leaf){
+    new_node->key_num = node->key_num - split;
+    memcpy(new_node->keys(), node->keys() + split * key_length, new_node->key_num * key_length);
+    memcpy(new_node->rids(), node->rids() + split, new_node->key_num * sizeof(RID));
+    new_node->rids()[file_header_.order - 1] = node->rids()[file_header_.order - 1];
+    node->rids()[file_header_.order - 1].page_num = new_page;
+    node->rids()[file_header_.order - 1].slot_num = -1;
+    node->key_num = split;
+    make_separator(node->keys() + (split - 1) * key_length, new_node->keys(), up_key.data());
+  } else {
+    // keys[split]上移到父节点，右边拿走它之后的key和孩子
+    memcpy(up_key.data(), node->keys() + split * key_length, key_length);
+    new_node->key_num = node->key_num - split - 1;
+    memcpy(new_node->keys(), node->keys() + (split + 1) * key_length, new_node->key_num * key_length);
+    memcpy(new_node->rids(), node->rids() + split + 1, (new_node->key_num + 1) * sizeof(RID));
+    node->key_num = split;
+  }
+  store_node(pdata, node);
+  store_node(new_data, new_node);
+  PageNum parent_page = node->parent;
+
+  // 两个页面在改完孩子的父指针之后再释放，未压缩格式下node/new_node直接指向页面
+  if(!new_node->is_leaf){
+    for(int i = 0; i <= new_node->key_num; i++){
+      PageNum child_page = new_node->rids()[i].page_num;
+      bool child_locked = latches.lock(child_page);
+      rc = disk_buffer_pool_->get_this_page(file_id_, child_page, &child_handle);
+      if(rc!=SUCCESS){
+        if(child_locked){
+          latches.unlock(child_page);
+        }
+        break;
+      }
+      disk_buffer_pool_->get_data(&child_handle, &child_data);
+      ((IndexNode *)(child_data + sizeof(IndexFileHeader)))->parent = new_page;
+      disk_buffer_pool_->mark_dirty(&child_handle);
+      disk_buffer_pool_->unpin_page(&child_handle);
+      if(child_locked){
+        latches.unlock(child_page);
+      }
+    }
+  }
+  disk_buffer_pool_->mark_dirty(&page_handle);
+  disk_buffer_pool_->unpin_page(&page_handle);
+  disk_buffer_pool_->mark_dirty(&new_handle);
+  disk_buffer_pool_->unpin_page(&new_handle);
+  if(rc!=SUCCESS){
+    return rc;
   }
+
+  return insert_into_parent(parent_page, page_num, up_key.data(), new_page, latches);
 }
 
-RC BplusTreeHandler::insert_into_new_root(PageNum left_page, const char *pkey, PageNum right_page) {
+// 调用方持有root_latch_的排他锁
+RC BplusTreeHandler::insert_into_new_root(PageNum left_page, const char *pkey, PageNum right_page,
+                                          NodeLatches &latches) {
   RC rc;
   BPPageHandle page_handle;
   IndexNode *root,*left,*right;
@@ -715,18 +1256,19 @@ RC BplusTreeHandler::insert_into_new_root(PageNum left_page, const char *pkey, P
   if(rc!=SUCCESS){
     return rc;
   }
+  latches.lock(root_page);
 
-  root = get_index_node(pdata);
-  root->is_leaf=false;
+  std::vector<char> root_buffer;
+  root = init_node(pdata, root_buffer, false);
   root->key_num=1;
-  root->parent=-1;
-  memcpy(root->keys,pkey,file_header_.key_length);
+  memcpy(root->keys(),pkey,file_header_.key_length);
   rid.page_num = left_page;
   rid.slot_num = -1;
-  memcpy(root->rids,&rid,sizeof(RID));
+  memcpy(root->rids(),&rid,sizeof(RID));
   rid.page_num = right_page;
   rid.slot_num = -1;
-  memcpy(root->rids+1,&rid,sizeof(RID));
+  memcpy(root->rids()+1,&rid,sizeof(RID));
+  store_node(pdata, root);
 
   rc = disk_buffer_pool_->mark_dirty(&page_handle);
   if(rc!=SUCCESS){
@@ -777,16 +1319,14 @@ RC BplusTreeHandler::insert_into_new_root(PageNum left_page, const char *pkey, P
     return rc;
   }
   file_header_.root_page=root_page;
+  tree_height_++;
   header_dirty_ = true;
   return SUCCESS;
 }
 
 RC BplusTreeHandler::insert_entry(const char *pkey, const RID *rid) {
   RC rc;
-  PageNum leaf_page;
-  BPPageHandle page_handle;
-  char *pdata,*key;
-  IndexNode *leaf;
+  char *key;
   if(nullptr == disk_buffer_pool_){
     return RC::RECORD_CLOSED;
   }
@@ -796,62 +1336,143 @@ RC BplusTreeHandler::insert_entry(const char *pkey, const RID *rid) {
     return RC::NOMEM;
   }
   memcpy(key,pkey,file_header_.attr_length);
+  if(file_header_.posting_list){
+    rc = insert_posting_entry(key, rid);
+    free(key);
+    return rc;
+  }
   memcpy(key + file_header_.attr_length, rid, sizeof(*rid));
-  rc= find_leaf(key, &leaf_page);
+
+  rc = insert_into_tree(key, rid);
+  free(key);
+  return rc;
+}
+
+RC BplusTreeHandler::insert_into_tree(const char *key, const RID *rid) {
+  bool done = false;
+  RC rc = insert_entry_optimistic(key, rid, &done);
+  if(rc == SUCCESS && !done){
+    // 叶子已满，需要分裂
+    rc = insert_entry_pessimistic(key, rid);
+  }
+  return rc;
+}
+
+RC BplusTreeHandler::insert_entry_optimistic(const char *key, const RID *rid, bool *done) {
+  RC rc;
+  PageNum leaf_page;
+  BPPageHandle page_handle;
+  char *pdata;
+
+  *done = true;
+  rc = find_leaf(key, &leaf_page, true);
   if(rc!=SUCCESS){
-    free(key);
     return rc;
   }
 
+  std::unique_lock<std::shared_mutex> leaf_guard(node_latch(leaf_page), std::adopt_lock);
   rc = disk_buffer_pool_->get_this_page(file_id_, leaf_page, &page_handle);
   if(rc!=SUCCESS){
-    free(key);
     return rc;
   }
-
   rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
   if(rc!=SUCCESS){
-    free(key);
+    disk_buffer_pool_->unpin_page(&page_handle);
+    return rc;
+  }
+  bool safe = leaf_has_room(pdata, key);
+  rc = disk_buffer_pool_->unpin_page(&page_handle);
+  if(rc!=SUCCESS){
     return rc;
   }
-  leaf=(IndexNode *)(pdata+sizeof(IndexFileHeader));
+  if(!safe){
+    *done = false;
+    return SUCCESS;
+  }
+  return insert_into_leaf(leaf_page, key, rid);
+}
 
-  if(leaf->key_num<file_header_.order-1){
-    rc = disk_buffer_pool_->unpin_page(&page_handle);
+RC BplusTreeHandler::lock_path(const char *key, bool insert, NodeLatches &latches) {
+  RC rc;
+  BPPageHandle page_handle;
+  char *pdata;
+  std::vector<char> key_buffer(file_header_.key_length);
+
+  latches.lock_root();
+  PageNum page_num = file_header_.root_page;
+  while(true){
+    latches.lock(page_num);
+    rc = disk_buffer_pool_->get_this_page(file_id_, page_num, &page_handle);
     if(rc!=SUCCESS){
-      free(key);
       return rc;
     }
-    rc=insert_into_leaf(leaf_page,key,rid);
-    if(rc!=SUCCESS){
-      free(key);
-      return rc;
+    disk_buffer_pool_->get_data(&page_handle, &pdata);
+    IndexNode *node = get_index_node(pdata);
+    bool safe;
+    if(insert){
+      safe = node->is_leaf ? leaf_has_room(pdata, key) : intern_has_room_for_any(pdata);
+    } else {
+      safe = delete_is_safe(pdata);
     }
-    free(key);
-    return SUCCESS;
+    if(safe){
+      latches.release_ancestors();
+    }
+    if(node->is_leaf){
+      disk_buffer_pool_->unpin_page(&page_handle);
+      return SUCCESS;
+    }
+    int i;
+    for(i = 0; i < node->key_num; i++){
+      if(CmpKey(file_header_.attr_type, file_header_.attr_length, key, node_key(pdata, i, key_buffer.data())) < 0){
+        break;
+      }
+    }
+    PageNum child = node_rid(pdata, i).page_num;
+    disk_buffer_pool_->unpin_page(&page_handle);
+    page_num = child;
   }
-  else{
-    rc = disk_buffer_pool_->unpin_page(&page_handle);
+}
+
+RC BplusTreeHandler::insert_entry_pessimistic(const char *key, const RID *rid) {
+  RC rc;
+  while(true){
+    NodeLatches latches(*this);
+    rc = lock_path(key, true, latches);
     if(rc!=SUCCESS){
-      free(key);
       return rc;
     }
 
-    // print();
+    // 持有根锁时根节点不安全，否则路径上第一个节点是安全的，后面的节点都不安全
+    const std::vector<PageNum> &path = latches.pages();
+    size_t unsafe = latches.holds_root() ? 0 : 1;
+    if(unsafe >= path.size()){
+      return insert_into_leaf(path.back(), key, rid);
+    }
 
-    rc=insert_into_leaf_after_split(leaf_page,key,rid);
-    free(key);
-    return SUCCESS;
+    // 只分裂最高的不安全节点，它的父节点放得下分隔key，不会继续向上分裂
+    PageNum page_num = path[unsafe];
+    bool is_leaf = unsafe == path.size() - 1;
+    while(path.size() > unsafe + 1){
+      latches.unlock(path.back());
+    }
+    if(is_leaf && !file_header_.key_compress){
+      rc = insert_into_leaf_after_split(page_num, key, rid, latches);
+      structure_version_++;
+      return rc;
+    }
+    // 压缩节点能放多少个key与内容有关，带着新key分裂不能保证两半都放得下，
+    // 所以先把原节点分裂成两半，再重新定位叶子插入
+    rc = split_node(page_num, latches);
+    structure_version_++;
+    if(rc!=SUCCESS){
+      return rc;
+    }
   }
 }
 
 RC BplusTreeHandler::get_entry(const char *pkey,RID *rid) {
   RC rc;
-  PageNum leaf_page;
-  BPPageHandle page_handle;
-  int i;
-  char *pdata,*key;
-  IndexNode *leaf;
+  char *key;
 
   key=(char *)malloc(file_header_.key_length);
   if(key == nullptr){
@@ -859,37 +1480,80 @@ RC BplusTreeHandler::get_entry(const char *pkey,RID *rid) {
     return RC::NOMEM;
   }
   memcpy(key,pkey,file_header_.attr_length);
-  memcpy(key+file_header_.attr_length,rid,sizeof(RID));
 
-  rc=find_leaf(key,&leaf_page);
-  if(rc!=SUCCESS){
+  if(!file_header_.posting_list){
+    memcpy(key+file_header_.attr_length,rid,sizeof(RID));
+    rc = find_entry(key, rid);
     free(key);
     return rc;
   }
 
-  rc = disk_buffer_pool_->get_this_page(file_id_, leaf_page, &page_handle);
-  if(rc!=SUCCESS){
+  std::shared_lock<std::shared_mutex> spill_guard(spill_latch_);
+  // RID少的值和普通索引一样逐条存放在叶子中，多的存放在倒排链中
+  memcpy(key+file_header_.attr_length,&POSTING_KEY_RID,sizeof(RID));
+  RID head;
+  rc = find_entry(key, &head);
+  if(rc==RC::RECORD_INVALID_KEY){
+    memcpy(key+file_header_.attr_length,rid,sizeof(RID));
+    rc = find_entry(key, &head);
     free(key);
     return rc;
   }
-  rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
+  free(key);
   if(rc!=SUCCESS){
-    free(key);
     return rc;
   }
-
-  leaf = get_index_node(pdata);
-  for(i=0;i<leaf->key_num;i++){
-    if(CmpKey(file_header_.attr_type, file_header_.attr_length,key,leaf->keys+(i*file_header_.key_length))==0){
-      memcpy(rid,leaf->rids+i,sizeof(RID));
-      free(key);
-      return SUCCESS;
+  std::vector<RID> rids;
+  rc = read_posting_list(head.page_num, rids);
+  if(rc!=SUCCESS){
+    return rc;
+  }
+  for(const RID &posting_rid : rids){
+    if(CmpRid(&posting_rid, rid) == 0){
+      return SUCCESS;
     }
   }
-  free(key);
   return RC::RECORD_INVALID_KEY;
 }
 
+RC BplusTreeHandler::find_entry(const char *key, RID *rid) {
+  RC rc;
+  PageNum leaf_page;
+  BPPageHandle page_handle;
+  int i;
+  char *pdata;
+  IndexNode *leaf;
+
+  rc=find_leaf(key,&leaf_page);
+  if(rc!=SUCCESS){
+    return rc;
+  }
+
+  std::shared_lock<std::shared_mutex> leaf_guard(node_latch(leaf_page), std::adopt_lock);
+  rc = disk_buffer_pool_->get_this_page(file_id_, leaf_page, &page_handle);
+  if(rc!=SUCCESS){
+    return rc;
+  }
+  rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
+  if(rc!=SUCCESS){
+    disk_buffer_pool_->unpin_page(&page_handle);
+    return rc;
+  }
+
+  rc = RC::RECORD_INVALID_KEY;
+  std::vector<char> key_buffer(file_header_.key_length);
+  leaf = (IndexNode *)(pdata + sizeof(IndexFileHeader));
+  for(i=0;i<leaf->key_num;i++){
+    if(CmpKey(file_header_.attr_type, file_header_.attr_length,key,node_key(pdata, i, key_buffer.data()))==0){
+      *rid = node_rid(pdata, i);
+      rc = SUCCESS;
+      break;
+    }
+  }
+  disk_buffer_pool_->unpin_page(&page_handle);
+  return rc;
+}
+
 RC BplusTreeHandler::delete_entry_from_node(PageNum node_page,const char *pkey) {
   BPPageHandle page_handle;
   IndexNode *node;
@@ -907,29 +1571,32 @@ RC BplusTreeHandler::delete_entry_from_node(PageNum node_page,const char *pkey)
     return rc;
   }
 
-  node = get_index_node(pdata);
+  std::vector<char> node_buffer;
+  node = load_node(pdata, node_buffer);
 
   for(delete_index=0;delete_index<node->key_num;delete_index++){
-    tmp=CmpKey(file_header_.attr_type, file_header_.attr_length, pkey, node->keys+delete_index*file_header_.key_length);
+    tmp=CmpKey(file_header_.attr_type, file_header_.attr_length, pkey, node->keys()+delete_index*file_header_.key_length);
     if(tmp==0)
       break;
   }
   if(delete_index>=node->key_num){
+    disk_buffer_pool_->unpin_page(&page_handle);
     return RC::RECORD_INVALID_KEY;
   }
   i=delete_index;
   while(i<(node->key_num-1)){
-    memcpy(node->keys+i*file_header_.key_length,node->keys+(i+1)*file_header_.key_length,file_header_.key_length);
+    memcpy(node->keys()+i*file_header_.key_length,node->keys()+(i+1)*file_header_.key_length,file_header_.key_length);
     i++;
   }
 
   if(node->is_leaf)
     for(i=delete_index;i<(node->key_num-1);i++)
-      memcpy(node->rids+i,node->rids+i+1,sizeof(RID));
+      memcpy(node->rids()+i,node->rids()+i+1,sizeof(RID));
   else
     for(i=delete_index+1;i<node->key_num;i++)
-      memcpy(node->rids+i,node->rids+i+1,sizeof(RID));
+      memcpy(node->rids()+i,node->rids()+i+1,sizeof(RID));
   node->key_num--;
+  store_node(pdata, node);
 
   rc = disk_buffer_pool_->mark_dirty(&page_handle);
   if(rc!=SUCCESS){
@@ -943,11 +1610,13 @@ RC BplusTreeHandler::delete_entry_from_node(PageNum node_page,const char *pkey)
   return SUCCESS;
 }
 
-RC BplusTreeHandler::coalesce_node(PageNum leaf_page,PageNum right_page)
+// 调用方持有两个节点和父节点的排他锁
+RC BplusTreeHandler::coalesce_node(PageNum leaf_page,PageNum right_page,NodeLatches &latches)
 {
   BPPageHandle left_handle,right_handle,parent_handle,tmphandle;
   IndexNode *left,*right,*parent,*node;
-  char *pdata,*tmp_key;
+  char *pdata,*left_data,*tmp_key;
+  std::vector<char> left_buffer,right_buffer,parent_buffer;
   PageNum parent_page;
   RC rc;
   int i,j,k,start;
@@ -956,12 +1625,12 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page,PageNum right_page)
   if(rc!=SUCCESS){
     return rc;
   }
-  rc = disk_buffer_pool_->get_data(&left_handle, &pdata);
+  rc = disk_buffer_pool_->get_data(&left_handle, &left_data);
   if(rc!=SUCCESS){
     return rc;
   }
 
-  left = get_index_node(pdata);
+  left = load_node(left_data, left_buffer);
 
   rc = disk_buffer_pool_->get_this_page(file_id_, right_page, &right_handle);
   if(rc!=SUCCESS){
@@ -973,7 +1642,7 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page,PageNum right_page)
     return rc;
   }
 
-  right = get_index_node(pdata);
+  right = load_node(pdata, right_buffer);
 
   parent_page=left->parent;
   rc = disk_buffer_pool_->get_this_page(file_id_, parent_page, &parent_handle);
@@ -986,31 +1655,42 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page,PageNum right_page)
     return rc;
   }
 
-  parent = get_index_node(pdata);
+  parent = load_node(pdata, parent_buffer);
 
   for(k=0;k<parent->key_num;k++)
-    if((parent->rids[k].page_num) == leaf_page)
+    if((parent->rids()[k].page_num) == leaf_page)
       break;
 
   start=left->key_num;
   if(left->is_leaf==false){
-    memcpy(left->keys+start*file_header_.key_length,parent->keys+k*file_header_.key_length,file_header_.key_length);
+    memcpy(left->keys()+start*file_header_.key_length,parent->keys()+k*file_header_.key_length,file_header_.key_length);
     start++;
     left->key_num++;
   }
   for(i=start,j=0;j<right->key_num;i++,j++){
-    memcpy(left->keys+i*file_header_.key_length,right->keys+j*file_header_.key_length,file_header_.key_length);
-    memcpy(left->rids+i,right->rids+j,sizeof(RID));
+    memcpy(left->keys()+i*file_header_.key_length,right->keys()+j*file_header_.key_length,file_header_.key_length);
+    memcpy(left->rids()+i,right->rids()+j,sizeof(RID));
     left->key_num++;
   }
 
   if(left->is_leaf)
-    memcpy(left->rids+file_header_.order-1,right->rids+file_header_.order-1,sizeof(RID));
-  else{
-    memcpy(left->rids+i,right->rids+j,sizeof(RID));
+    memcpy(left->rids()+file_header_.order-1,right->rids()+file_header_.order-1,sizeof(RID));
+  else
+    memcpy(left->rids()+i,right->rids()+j,sizeof(RID));
+
+  if(file_header_.key_compress && encoded_size(left) > NODE_SPACE){
+    // 按fill_order合并的节点一定放得下，这里只是防御：放不下就保留两个不满的节点
+    disk_buffer_pool_->unpin_page(&left_handle);
+    disk_buffer_pool_->unpin_page(&right_handle);
+    disk_buffer_pool_->unpin_page(&parent_handle);
+    return SUCCESS;
+  }
 
+  if(!left->is_leaf){
     for(i=start;i<=left->key_num;i++){
-      rc = disk_buffer_pool_->get_this_page(file_id_, left->rids[i].page_num, &tmphandle);
+      PageNum child_page = left->rids()[i].page_num;
+      bool child_locked = latches.lock(child_page);
+      rc = disk_buffer_pool_->get_this_page(file_id_, child_page, &tmphandle);
       if(rc!=SUCCESS){
         return rc;
       }
@@ -1020,6 +1700,9 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page,PageNum right_page)
       }
       node=(IndexNode *)(pdata+sizeof(IndexFileHeader));
       node->parent=leaf_page;
+      if(child_locked){
+        latches.unlock(child_page);
+      }
 
       rc = disk_buffer_pool_->mark_dirty(&tmphandle);
       if(rc!=SUCCESS){
@@ -1037,8 +1720,9 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page,PageNum right_page)
     LOG_ERROR("Failed to alloc memory for key. size=%d", file_header_.key_length);
     return RC::NOMEM;
   }
-  memcpy(tmp_key,parent->keys+k*file_header_.key_length,file_header_.key_length);
+  memcpy(tmp_key,parent->keys()+k*file_header_.key_length,file_header_.key_length);
 
+  store_node(left_data, left);
   rc = disk_buffer_pool_->mark_dirty(&left_handle);
   if(rc!=SUCCESS){
     free(tmp_key);
@@ -1054,11 +1738,7 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page,PageNum right_page)
     free(tmp_key);
     return rc;
   }
-  rc = disk_buffer_pool_->dispose_page(file_id_, right_page);
-  if(rc!=SUCCESS){
-    free(tmp_key);
-    return rc;
-  }
+  latches.dispose(right_page);
 
   rc = disk_buffer_pool_->unpin_page(&parent_handle);
   if(rc!=SUCCESS){
@@ -1066,7 +1746,7 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page,PageNum right_page)
     return rc;
   }
 
-  rc= delete_entry_internal(parent_page,tmp_key);
+  rc= delete_entry_internal(parent_page,tmp_key,latches);
   if(rc!=SUCCESS){
     free(tmp_key);
     return rc;
@@ -1075,12 +1755,15 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page,PageNum right_page)
   return SUCCESS;
 }
 
-RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page,PageNum right_page)
+// 调用方持有两个节点和父节点的排他锁
+RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page,PageNum right_page,NodeLatches &latches)
 {
   BPPageHandle left_handle,right_handle,parent_handle,tmphandle;
   IndexNode *left,*right,*parent,*node;
-  char *pdata;
+  char *pdata,*left_data,*right_data,*parent_data;
+  std::vector<char> left_buffer,right_buffer,parent_buffer;
   PageNum parent_page;
+  PageNum moved_child = -1, moved_to = -1;
   RC rc;
   int min_key,i,k;
 
@@ -1088,130 +1771,140 @@ RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page,PageNum right_page)
   if(rc!=SUCCESS){
     return rc;
   }
-  rc = disk_buffer_pool_->get_data(&left_handle, &pdata);
+  rc = disk_buffer_pool_->get_data(&left_handle, &left_data);
   if(rc!=SUCCESS){
     return rc;
   }
 
-  left = get_index_node(pdata);
+  left = load_node(left_data, left_buffer);
 
   rc = disk_buffer_pool_->get_this_page(file_id_, right_page, &right_handle);
   if(rc!=SUCCESS){
     return rc;
   }
-  rc = disk_buffer_pool_->get_data(&right_handle, &pdata);
+  rc = disk_buffer_pool_->get_data(&right_handle, &right_data);
   if(rc!=SUCCESS){
     return rc;
   }
 
-  right = get_index_node(pdata);
+  right = load_node(right_data, right_buffer);
 
   parent_page=left->parent;
   rc = disk_buffer_pool_->get_this_page(file_id_, parent_page, &parent_handle);
   if(rc!=SUCCESS){
     return rc;
   }
-  rc = disk_buffer_pool_->get_data(&parent_handle, &pdata);
+  rc = disk_buffer_pool_->get_data(&parent_handle, &parent_data);
   if(rc!=SUCCESS){
     return rc;
   }
 
-  parent = get_index_node(pdata);
+  parent = load_node(parent_data, parent_buffer);
 
   for(k=0;k<parent->key_num;k++)
-    if(parent->rids[k].page_num == leaf_page)
+    if(parent->rids()[k].page_num == leaf_page)
       break;
   if(left->is_leaf){
-    min_key=file_header_.order/2;
+    min_key=min_keys(true);
     if(left->key_num<min_key){
-      memcpy(left->keys+left->key_num*file_header_.key_length,right->keys,file_header_.key_length);
-      memcpy(left->rids+left->key_num,right->rids,sizeof(RID));
+      memcpy(left->keys()+left->key_num*file_header_.key_length,right->keys(),file_header_.key_length);
+      memcpy(left->rids()+left->key_num,right->rids(),sizeof(RID));
       left->key_num++;
 
       for(i=0;i<right->key_num-1;i++){
-        memcpy(right->keys+i*file_header_.key_length,right->keys+(i+1)*file_header_.key_length,file_header_.key_length);
-        memcpy(right->rids+i,right->rids+i+1,sizeof(RID));
+        memcpy(right->keys()+i*file_header_.key_length,right->keys()+(i+1)*file_header_.key_length,file_header_.key_length);
+        memcpy(right->rids()+i,right->rids()+i+1,sizeof(RID));
       }
       right->key_num--;
-      memcpy(parent->keys+k*file_header_.key_length,right->keys,file_header_.key_length);
     }
     else{
       for(i=right->key_num;i>0;i--){
-        memcpy(right->keys+i*file_header_.key_length,right->keys+(i-1)*file_header_.key_length,file_header_.key_length);
-        memcpy(right->rids+i,right->rids+i-1,sizeof(RID));
+        memcpy(right->keys()+i*file_header_.key_length,right->keys()+(i-1)*file_header_.key_length,file_header_.key_length);
+        memcpy(right->rids()+i,right->rids()+i-1,sizeof(RID));
       }
-      memcpy(right->keys,left->keys+(left->key_num-1)*file_header_.key_length,file_header_.key_length);
+      memcpy(right->keys(),left->keys()+(left->key_num-1)*file_header_.key_length,file_header_.key_length);
+      memcpy(right->rids(),left->rids()+(left->key_num-1),sizeof(RID));
 
       left->key_num--;
       right->key_num++;
-      memcpy(parent->keys+k*file_header_.key_length,right->keys,file_header_.key_length);
     }
+    make_separator(left->keys()+(left->key_num-1)*file_header_.key_length,right->keys(),
+                   parent->keys()+k*file_header_.key_length);
   }
   else{
-    min_key=(file_header_.order+1)/2-1;
+    min_key=min_keys(false);
     if(left->key_num<min_key){
-      memcpy(left->keys+left->key_num*file_header_.key_length,parent->keys+k*file_header_.key_length,file_header_.key_length);
-      memcpy(left->rids+left->key_num+1,right->rids,sizeof(RID));
+      memcpy(left->keys()+left->key_num*file_header_.key_length,parent->keys()+k*file_header_.key_length,file_header_.key_length);
+      memcpy(left->rids()+left->key_num+1,right->rids(),sizeof(RID));
       left->key_num++;
 
-      memcpy(parent->keys+k*file_header_.key_length,right->keys,file_header_.key_length);
+      memcpy(parent->keys()+k*file_header_.key_length,right->keys(),file_header_.key_length);
+      // 内部节点有key_num+1个孩子，最后一个孩子也要跟着左移
       for(i=0;i<right->key_num-1;i++){
-        memcpy(right->keys+i*file_header_.key_length,right->keys+(i+1)*file_header_.key_length,file_header_.key_length);
-        memcpy(right->rids+i,right->rids+i+1,sizeof(RID));
+        memcpy(right->keys()+i*file_header_.key_length,right->keys()+(i+1)*file_header_.key_length,file_header_.key_length);
+      }
+      for(i=0;i<right->key_num;i++){
+        memcpy(right->rids()+i,right->rids()+i+1,sizeof(RID));
       }
       right->key_num--;
 
-      rc = disk_buffer_pool_->get_this_page(file_id_, left->rids[left->key_num].page_num,&tmphandle);
-      if(rc!=SUCCESS){
-        return rc;
-      }
-      rc = disk_buffer_pool_->get_data(&tmphandle, &pdata);
-      if(rc!=SUCCESS){
-        return rc;
-      }
-      node=(IndexNode *)(pdata+sizeof(IndexFileHeader));
-      node->parent=leaf_page;
-      rc = disk_buffer_pool_->mark_dirty(&tmphandle);
-      if(rc!=SUCCESS){
-        return rc;
-      }
-      rc = disk_buffer_pool_->unpin_page(&tmphandle);
-      if(rc!=SUCCESS){
-        return rc;
-      }
+      moved_child = left->rids()[left->key_num].page_num;
+      moved_to = leaf_page;
     }
     else{
       for(i=right->key_num;i>0;i--){
-        memcpy(right->keys+i*file_header_.key_length,right->keys+(i-1)*file_header_.key_length,file_header_.key_length);
-        memcpy(right->rids+i,right->rids+i-1,sizeof(RID));
+        memcpy(right->keys()+i*file_header_.key_length,right->keys()+(i-1)*file_header_.key_length,file_header_.key_length);
       }
-      memcpy(right->keys,parent->keys+k*file_header_.key_length,file_header_.key_length);
-      memcpy(right->rids,left->rids+left->key_num,sizeof(RID));
+      for(i=right->key_num+1;i>0;i--){
+        memcpy(right->rids()+i,right->rids()+i-1,sizeof(RID));
+      }
+      memcpy(right->keys(),parent->keys()+k*file_header_.key_length,file_header_.key_length);
+      memcpy(right->rids(),left->rids()+left->key_num,sizeof(RID));
 
       right->key_num++;
-      memcpy(parent->keys+k*file_header_.key_length,left->keys+(left->key_num-1)*file_header_.key_length,file_header_.key_length);
+      memcpy(parent->keys()+k*file_header_.key_length,left->keys()+(left->key_num-1)*file_header_.key_length,file_header_.key_length);
       left->key_num--;
 
-      rc = disk_buffer_pool_->get_this_page(file_id_, right->rids[0].page_num, &tmphandle);
-      if(rc!=SUCCESS){
-        return rc;
-      }
-      rc = disk_buffer_pool_->get_data(&tmphandle, &pdata);
-      if(rc!=SUCCESS){
-        return rc;
-      }
-      node = get_index_node(pdata);
-      node->parent=right_page;
-      rc = disk_buffer_pool_->mark_dirty(&tmphandle);
-      if(rc!=SUCCESS){
-        return rc;
-      }
-      rc = disk_buffer_pool_->unpin_page(&tmphandle);
-      if(rc!=SUCCESS){
-        return rc;
-      }
+      moved_child = right->rids()[0].page_num;
+      moved_to = right_page;
+    }
+  }
+
+  if(file_header_.key_compress &&
+     (encoded_size(left) > NODE_SPACE || encoded_size(right) > NODE_SPACE || encoded_size(parent) > NODE_SPACE)){
+    // 新的分隔key可能让父节点放不下，这时放弃重分布，保留一个不满的节点
+    disk_buffer_pool_->unpin_page(&left_handle);
+    disk_buffer_pool_->unpin_page(&right_handle);
+    disk_buffer_pool_->unpin_page(&parent_handle);
+    return SUCCESS;
+  }
+
+  if(moved_child != -1){
+    bool child_locked = latches.lock(moved_child);
+    rc = disk_buffer_pool_->get_this_page(file_id_, moved_child, &tmphandle);
+    if(rc!=SUCCESS){
+      return rc;
+    }
+    rc = disk_buffer_pool_->get_data(&tmphandle, &pdata);
+    if(rc!=SUCCESS){
+      return rc;
+    }
+    node=(IndexNode *)(pdata+sizeof(IndexFileHeader));
+    node->parent=moved_to;
+    if(child_locked){
+      latches.unlock(moved_child);
+    }
+    rc = disk_buffer_pool_->mark_dirty(&tmphandle);
+    if(rc!=SUCCESS){
+      return rc;
+    }
+    rc = disk_buffer_pool_->unpin_page(&tmphandle);
+    if(rc!=SUCCESS){
+      return rc;
     }
   }
+
+  store_node(left_data, left);
   rc = disk_buffer_pool_->mark_dirty(&left_handle);
   if(rc!=SUCCESS){
     return rc;
@@ -1221,6 +1914,7 @@ RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page,PageNum right_page)
     return rc;
   }
 
+  store_node(right_data, right);
   rc = disk_buffer_pool_->mark_dirty(&right_handle);
   if(rc!=SUCCESS){
     return rc;
@@ -1231,6 +1925,7 @@ RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page,PageNum right_page)
     return rc;
   }
 
+  store_node(parent_data, parent);
   rc = disk_buffer_pool_->mark_dirty(&parent_handle);
   if(rc!=SUCCESS){
     return rc;
@@ -1242,11 +1937,14 @@ RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page,PageNum right_page)
   return SUCCESS;
 }
 
-RC BplusTreeHandler::delete_entry_internal(PageNum page_num,const char *pkey) {
+// 调用方持有page_num的排他锁，page_num不安全时还持有它的父节点(根节点时是root_latch_)的排他锁，
+// 兄弟节点和移动的孩子在这里加锁
+RC BplusTreeHandler::delete_entry_internal(PageNum page_num,const char *pkey,NodeLatches &latches) {
   BPPageHandle parent_handle,page_handle,left_handle,right_handle,tmphandle;
   IndexNode *node,*parent,*left,*right,*tmpnode;
   PageNum leaf_page,right_page;
   char *pdata;
+  std::vector<char> node_buffer,parent_buffer;
   RC rc;
   int delete_index,min_key;
 
@@ -1263,11 +1961,12 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num,const char *pkey) {
   if(rc!=SUCCESS){
     return rc;
   }
-  node = get_index_node(pdata);
+  node = load_node(pdata, node_buffer);
 
   if(node->parent==-1){
     if(node->key_num==0&&node->is_leaf==false){
-      rc = disk_buffer_pool_->get_this_page(file_id_, node->rids[0].page_num, &tmphandle);
+      latches.lock(node->rids()[0].page_num);
+      rc = disk_buffer_pool_->get_this_page(file_id_, node->rids()[0].page_num, &tmphandle);
       if(rc!=SUCCESS){
         return rc;
       }
@@ -1286,17 +1985,15 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num,const char *pkey) {
         return rc;
       }
 
-      file_header_.root_page=node->rids[0].page_num;
+      file_header_.root_page=node->rids()[0].page_num;
+      tree_height_--;
       header_dirty_ = true;
 
       rc = disk_buffer_pool_->unpin_page(&page_handle);
       if(rc!=SUCCESS){
         return rc;
       }
-      rc = disk_buffer_pool_->dispose_page(file_id_, page_num);
-      if(rc!=SUCCESS){
-        return rc;
-      }
+      latches.dispose(page_num);
       return SUCCESS;
     }
 
@@ -1307,10 +2004,7 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num,const char *pkey) {
     return SUCCESS;
   }
 
-  if(node->is_leaf)
-    min_key=file_header_.order/2;
-  else
-    min_key=(file_header_.order+1)/2-1;
+  min_key=min_keys(node->is_leaf);
 
   if(node->key_num>=min_key){
     rc = disk_buffer_pool_->unpin_page(&page_handle);
@@ -1329,18 +2023,19 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num,const char *pkey) {
     return rc;
   }
 
-  parent = get_index_node(pdata);
+  parent = load_node(pdata, parent_buffer);
 
   delete_index=0;
   while(delete_index<=parent->key_num){
-    if((parent->rids[delete_index].page_num) == page_num)
+    if((parent->rids()[delete_index].page_num) == page_num)
       break;
     delete_index++;
   }
 
   if(delete_index==0){
     leaf_page=page_num;
-    right_page=parent->rids[delete_index+1].page_num;
+    right_page=parent->rids()[delete_index+1].page_num;
+    latches.lock(right_page);
     rc = disk_buffer_pool_->get_this_page(file_id_, right_page, &right_handle);
     if(rc!=SUCCESS){
       return rc;
@@ -1364,7 +2059,7 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num,const char *pkey) {
       if(rc!=SUCCESS){
         return rc;
       }
-      return redistribute_nodes(page_num,right_page);
+      return redistribute_nodes(page_num,right_page,latches);
     }
     else{
       rc = disk_buffer_pool_->unpin_page(&page_handle);
@@ -1379,11 +2074,12 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num,const char *pkey) {
       if(rc!=SUCCESS){
         return rc;
       }
-      return coalesce_node(page_num,right_page);
+      return coalesce_node(page_num,right_page,latches);
     }
   }
   else{
-    leaf_page=parent->rids[delete_index-1].page_num;
+    leaf_page=parent->rids()[delete_index-1].page_num;
+    latches.lock(leaf_page);
     rc = disk_buffer_pool_->get_this_page(file_id_, leaf_page, &left_handle);
     if(rc!=SUCCESS){
       return rc;
@@ -1407,7 +2103,7 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num,const char *pkey) {
       if(rc!=SUCCESS){
         return rc;
       }
-      return redistribute_nodes(leaf_page,page_num);
+      return redistribute_nodes(leaf_page,page_num,latches);
     }
     else{
       rc = disk_buffer_pool_->unpin_page(&page_handle);
@@ -1422,14 +2118,13 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num,const char *pkey) {
       if(rc!=SUCCESS){
         return rc;
       }
-      return coalesce_node(leaf_page,page_num);
+      return coalesce_node(leaf_page,page_num,latches);
     }
   }
 }
 
 RC BplusTreeHandler::delete_entry(const char *data, const RID *rid) {
   RC rc;
-  PageNum leaf_page;
   char *pkey;
   pkey=(char *)malloc(file_header_.key_length);
   if(nullptr == pkey){
@@ -1437,26 +2132,585 @@ RC BplusTreeHandler::delete_entry(const char *data, const RID *rid) {
     return RC::NOMEM;
   }
   memcpy(pkey,data,file_header_.attr_length);
+  if(file_header_.posting_list){
+    rc = delete_posting_entry(pkey, rid);
+    free(pkey);
+    return rc;
+  }
   memcpy(pkey + file_header_.attr_length, rid ,sizeof(*rid));
 
-  rc=find_leaf(pkey,&leaf_page);
+  rc = delete_from_tree(pkey);
+  free(pkey);
+  return rc;
+}
+
+RC BplusTreeHandler::delete_from_tree(const char *key) {
+  bool done = false;
+  RC rc = delete_entry_optimistic(key, &done);
+  if(rc == SUCCESS && !done){
+    // 删除后叶子会下溢，可能触发合并或重分布
+    rc = delete_entry_pessimistic(key);
+  }
+  return rc;
+}
+
+RC BplusTreeHandler::delete_entry_pessimistic(const char *key) {
+  NodeLatches latches(*this);
+  RC rc = lock_path(key, false, latches);
   if(rc!=SUCCESS){
-    free(pkey);
     return rc;
   }
-  rc=delete_entry_internal(leaf_page,pkey);
+  rc = delete_entry_internal(latches.pages().back(), key, latches);
+  structure_version_++;
+  return rc;
+}
+
+RC BplusTreeHandler::delete_entry_optimistic(const char *key, bool *done) {
+  RC rc;
+  PageNum leaf_page;
+  BPPageHandle page_handle;
+  char *pdata;
+
+  *done = true;
+  rc = find_leaf(key, &leaf_page, true);
   if(rc!=SUCCESS){
-    free(pkey);
     return rc;
   }
-  free(pkey);
+
+  std::unique_lock<std::shared_mutex> leaf_guard(node_latch(leaf_page), std::adopt_lock);
+  rc = disk_buffer_pool_->get_this_page(file_id_, leaf_page, &page_handle);
+  if(rc!=SUCCESS){
+    return rc;
+  }
+  rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
+  if(rc!=SUCCESS){
+    disk_buffer_pool_->unpin_page(&page_handle);
+    return rc;
+  }
+  // 根叶子没有下溢的问题，其他叶子删除后至少保留 order/2 个key 才不需要调整结构
+  bool safe = delete_is_safe(pdata);
+  rc = disk_buffer_pool_->unpin_page(&page_handle);
+  if(rc!=SUCCESS){
+    return rc;
+  }
+  if(!safe){
+    *done = false;
+    return SUCCESS;
+  }
+  return delete_entry_from_node(leaf_page, key);
+}
+
+
+static const int POSTING_PAGE_CAPACITY = (int)(BP_PAGE_DATA_SIZE - sizeof(PostingPageHeader));
+
+static inline uint64_t rid_to_uint(const RID &rid) {
+  return ((uint64_t)(uint32_t)rid.page_num << 32) | (uint32_t)rid.slot_num;
+}
+
+static inline RID uint_to_rid(uint64_t value) {
+  RID rid;
+  rid.page_num = (PageNum)(value >> 32);
+  rid.slot_num = (SlotNum)(value & 0xffffffff);
+  return rid;
+}
+
+static bool rid_less(const RID &rid1, const RID &rid2) {
+  return CmpRid(&rid1, &rid2) < 0;
+}
+
+// rids[begin, end) 中第一个RID存放在页头，其余按差值做varint编码
+static void encode_posting(const std::vector<RID> &rids, size_t begin, size_t end, std::vector<char> &out) {
+  out.clear();
+  for (size_t i = begin + 1; i < end; i++) {
+    uint64_t delta = rid_to_uint(rids[i]) - rid_to_uint(rids[i - 1]);
+    while (delta >= 0x80) {
+      out.push_back((char)((delta & 0x7f) | 0x80));
+      delta >>= 7;
+    }
+    out.push_back((char)delta);
+  }
+}
+
+static void decode_posting(const PostingPageHeader &header, const char *data, std::vector<RID> &rids) {
+  if (header.rid_num == 0) {
+    return;
+  }
+  uint64_t value = rid_to_uint(header.first);
+  rids.push_back(header.first);
+  const unsigned char *p = (const unsigned char *)data;
+  for (int i = 1; i < header.rid_num; i++) {
+    uint64_t delta = 0;
+    int shift = 0;
+    while (*p & 0x80) {
+      delta |= (uint64_t)(*p & 0x7f) << shift;
+      shift += 7;
+      p++;
+    }
+    delta |= (uint64_t)(*p) << shift;
+    p++;
+    value += delta;
+    rids.push_back(uint_to_rid(value));
+  }
+}
+
+RC BplusTreeHandler::allocate_posting_page(PageNum *page_num) {
+  BPPageHandle page_handle;
+  RC rc = disk_buffer_pool_->allocate_page(file_id_, &page_handle);
+  if (rc != SUCCESS) {
+    LOG_ERROR("Failed to allocate posting page. rc=%d:%s", rc, strrc(rc));
+    return rc;
+  }
+  disk_buffer_pool_->get_page_num(&page_handle, page_num);
+  return disk_buffer_pool_->unpin_page(&page_handle);
+}
+
+RC BplusTreeHandler::read_posting_page(PageNum page_num, PostingPageHeader *header, std::vector<RID> *rids) {
+  BPPageHandle page_handle;
+  char *pdata;
+  RC rc = disk_buffer_pool_->get_this_page(file_id_, page_num, &page_handle);
+  if (rc != SUCCESS) {
+    LOG_ERROR("Failed to get posting page. page num=%d, rc=%d:%s", page_num, rc, strrc(rc));
+    return rc;
+  }
+  disk_buffer_pool_->get_data(&page_handle, &pdata);
+  memcpy(header, pdata, sizeof(PostingPageHeader));
+  if (rids != nullptr) {
+    decode_posting(*header, pdata + sizeof(PostingPageHeader), *rids);
+  }
+  return disk_buffer_pool_->unpin_page(&page_handle);
+}
+
+// 用rids重写一个倒排页，header中只有next_page和tail_page会被保留
+RC BplusTreeHandler::write_posting_page(PageNum page_num, const PostingPageHeader &header, const std::vector<RID> &rids) {
+  std::vector<char> data;
+  encode_posting(rids, 0, rids.size(), data);
+  if ((int)data.size() > POSTING_PAGE_CAPACITY) {
+    return RC::NOMEM;
+  }
+
+  BPPageHandle page_handle;
+  char *pdata;
+  RC rc = disk_buffer_pool_->get_this_page(file_id_, page_num, &page_handle);
+  if (rc != SUCCESS) {
+    LOG_ERROR("Failed to get posting page. page num=%d, rc=%d:%s", page_num, rc, strrc(rc));
+    return rc;
+  }
+  disk_buffer_pool_->get_data(&page_handle, &pdata);
+  PostingPageHeader *page_header = (PostingPageHeader *)pdata;
+  *page_header = header;
+  page_header->rid_num = (int)rids.size();
+  page_header->data_len = (int)data.size();
+  if (!rids.empty()) {
+    page_header->first = rids.front();
+    page_header->last = rids.back();
+  }
+  memcpy(pdata + sizeof(PostingPageHeader), data.data(), data.size());
+  disk_buffer_pool_->mark_dirty(&page_handle);
+  return disk_buffer_pool_->unpin_page(&page_handle);
+}
+
+RC BplusTreeHandler::read_posting_list(PageNum head_page, std::vector<RID> &rids) {
+  std::shared_lock<std::shared_mutex> posting_guard(posting_latch(head_page));
+  PostingPageHeader header;
+  for (PageNum page_num = head_page; page_num != -1; page_num = header.next_page) {
+    RC rc = read_posting_page(page_num, &header, &rids);
+    if (rc != SUCCESS) {
+      return rc;
+    }
+  }
+  return SUCCESS;
+}
+
+// 调用方持有spill_latch_。rids按顺序写成一条新的倒排链，返回链头
+RC BplusTreeHandler::create_posting_list(const std::vector<RID> &rids, PageNum *head_page) {
+  // 先按页的容量把rids分段，再为每段分配一个页
+  std::vector<size_t> bounds(1, 0);
+  int used = 0;
+  for (size_t i = 1; i < rids.size(); i++) {
+    uint64_t delta = rid_to_uint(rids[i]) - rid_to_uint(rids[i - 1]);
+    int size = 1;
+    while (delta >= 0x80) {
+      delta >>= 7;
+      size++;
+    }
+    if (used + size > POSTING_PAGE_CAPACITY) {
+      bounds.push_back(i);
+      used = 0;
+    } else {
+      used += size;
+    }
+  }
+  bounds.push_back(rids.size());
+
+  std::vector<PageNum> pages(bounds.size() - 1);
+  for (PageNum &page_num : pages) {
+    RC rc = allocate_posting_page(&page_num);
+    if (rc != SUCCESS) {
+      return rc;
+    }
+  }
+  for (size_t i = 0; i < pages.size(); i++) {
+    PostingPageHeader header;
+    header.next_page = i + 1 < pages.size() ? pages[i + 1] : -1;
+    header.tail_page = i == 0 ? pages.back() : -1;
+    RC rc = write_posting_page(pages[i], header,
+        std::vector<RID>(rids.begin() + bounds[i], rids.begin() + bounds[i + 1]));
+    if (rc != SUCCESS) {
+      return rc;
+    }
+  }
+  *head_page = pages.front();
   return SUCCESS;
 }
 
+// 调用方持有spill_latch_，函数内持有倒排链的写锁
+RC BplusTreeHandler::add_posting_rid(PageNum head_page, const RID *rid) {
+  std::unique_lock<std::shared_mutex> posting_guard(posting_latch(head_page));
+
+  // 找到rid应该落在的页：比链尾最后一个RID大时直接追加到链尾，否则从头找第一个last >= rid的页
+  PostingPageHeader head_header;
+  RC rc = read_posting_page(head_page, &head_header, nullptr);
+  if (rc != SUCCESS) {
+    return rc;
+  }
+  PageNum page_num = head_page;
+  PostingPageHeader header = head_header;
+  if (head_header.tail_page != head_page) {
+    PostingPageHeader tail_header;
+    rc = read_posting_page(head_header.tail_page, &tail_header, nullptr);
+    if (rc != SUCCESS) {
+      return rc;
+    }
+    if (rid_less(tail_header.last, *rid)) {
+      page_num = head_header.tail_page;
+      header = tail_header;
+    }
+  }
+  while (header.next_page != -1 && rid_less(header.last, *rid)) {
+    page_num = header.next_page;
+    rc = read_posting_page(page_num, &header, nullptr);
+    if (rc != SUCCESS) {
+      return rc;
+    }
+  }
+
+  std::vector<RID> rids;
+  rc = read_posting_page(page_num, &header, &rids);
+  if (rc != SUCCESS) {
+    return rc;
+  }
+  auto iter = std::lower_bound(rids.begin(), rids.end(), *rid, rid_less);
+  if (iter != rids.end() && CmpRid(&*iter, rid) == 0) {
+    return RC::RECORD_DUPLICATE_KEY;
+  }
+  rids.insert(iter, *rid);
+  rc = write_posting_page(page_num, header, rids);
+  if (rc != RC::NOMEM) {
+    return rc;
+  }
+
+  // 页放不下了，后一半挪到新页上
+  PageNum new_page;
+  rc = allocate_posting_page(&new_page);
+  if (rc != SUCCESS) {
+    return rc;
+  }
+  size_t half = rids.size() / 2;
+  PostingPageHeader new_header;
+  new_header.next_page = header.next_page;
+  new_header.tail_page = -1;
+  rc = write_posting_page(new_page, new_header, std::vector<RID>(rids.begin() + half, rids.end()));
+  if (rc != SUCCESS) {
+    return rc;
+  }
+  bool was_tail = header.next_page == -1;
+  header.next_page = new_page;
+  if (was_tail && page_num == head_page) {
+    header.tail_page = new_page;
+  }
+  rc = write_posting_page(page_num, header, std::vector<RID>(rids.begin(), rids.begin() + half));
+  if (rc != SUCCESS || !was_tail || page_num == head_page) {
+    return rc;
+  }
+  std::vector<RID> head_rids;
+  rc = read_posting_page(head_page, &head_header, &head_rids);
+  if (rc != SUCCESS) {
+    return rc;
+  }
+  head_header.tail_page = new_page;
+  return write_posting_page(head_page, head_header, head_rids);
+}
+
+// 调用方持有spill_latch_，函数内持有倒排链的写锁。
+// 链头不会被释放，整条链都空了时留下一个rid_num为0的链头，由调用方在排他锁下从树中删除
+RC BplusTreeHandler::remove_posting_rid(PageNum head_page, const RID *rid, bool *empty) {
+  std::unique_lock<std::shared_mutex> posting_guard(posting_latch(head_page));
+  *empty = false;
+
+  PageNum prev_page = -1;
+  PageNum page_num = head_page;
+  PostingPageHeader header;
+  while (true) {
+    RC rc = read_posting_page(page_num, &header, nullptr);
+    if (rc != SUCCESS) {
+      return rc;
+    }
+    if (header.rid_num > 0 && !rid_less(header.last, *rid)) {
+      break;
+    }
+    if (header.next_page == -1) {
+      return RC::RECORD_INVALID_KEY;
+    }
+    prev_page = page_num;
+    page_num = header.next_page;
+  }
+
+  std::vector<RID> rids;
+  RC rc = read_posting_page(page_num, &header, &rids);
+  if (rc != SUCCESS) {
+    return rc;
+  }
+  auto iter = std::lower_bound(rids.begin(), rids.end(), *rid, rid_less);
+  if (iter == rids.end() || CmpRid(&*iter, rid) != 0) {
+    return RC::RECORD_INVALID_KEY;
+  }
+  rids.erase(iter);
+  if (!rids.empty()) {
+    return write_posting_page(page_num, header, rids);
+  }
+
+  if (page_num != head_page) {
+    // 从链上摘掉这个空页
+    std::vector<RID> prev_rids;
+    PostingPageHeader prev_header;
+    rc = read_posting_page(prev_page, &prev_header, &prev_rids);
+    if (rc != SUCCESS) {
+      return rc;
+    }
+    prev_header.next_page = header.next_page;
+    if (prev_page == head_page && header.next_page == -1) {
+      prev_header.tail_page = prev_page;
+    }
+    rc = write_posting_page(prev_page, prev_header, prev_rids);
+    if (rc == SUCCESS && prev_page != head_page && header.next_page == -1) {
+      std::vector<RID> head_rids;
+      PostingPageHeader head_header;
+      rc = read_posting_page(head_page, &head_header, &head_rids);
+      if (rc == SUCCESS) {
+        head_header.tail_page = prev_page;
+        rc = write_posting_page(head_page, head_header, head_rids);
+      }
+    }
+    if (rc != SUCCESS) {
+      return rc;
+    }
+    return disk_buffer_pool_->dispose_page(file_id_, page_num);
+  }
+
+  if (header.next_page != -1) {
+    // 链头空了，把第二个页的内容搬到链头，树中的rid不需要修改
+    PageNum next_page = header.next_page;
+    std::vector<RID> next_rids;
+    PostingPageHeader next_header;
+    rc = read_posting_page(next_page, &next_header, &next_rids);
+    if (rc != SUCCESS) {
+      return rc;
+    }
+    header.next_page = next_header.next_page;
+    if (header.tail_page == next_page) {
+      header.tail_page = head_page;
+    }
+    rc = write_posting_page(head_page, header, next_rids);
+    if (rc != SUCCESS) {
+      return rc;
+    }
+    return disk_buffer_pool_->dispose_page(file_id_, next_page);
+  }
+
+  *empty = true;
+  return write_posting_page(head_page, header, rids);
+}
+
+// 调用方持有spill_latch_的共享锁，只数key所在叶子中的RID，作为是否需要转成倒排链的提示
+int BplusTreeHandler::count_inline_rids(const char *key) {
+  PageNum leaf_page;
+  if (find_leaf(key, &leaf_page) != SUCCESS) {
+    return 0;
+  }
+  std::shared_lock<std::shared_mutex> leaf_guard(node_latch(leaf_page), std::adopt_lock);
+  BPPageHandle page_handle;
+  char *pdata;
+  if (disk_buffer_pool_->get_this_page(file_id_, leaf_page, &page_handle) != SUCCESS) {
+    return 0;
+  }
+  disk_buffer_pool_->get_data(&page_handle, &pdata);
+  std::vector<char> key_buffer(file_header_.key_length);
+  int key_num = ((IndexNode *)(pdata + sizeof(IndexFileHeader)))->key_num;
+  int count = 0;
+  for (int i = 0; i < key_num; i++) {
+    if (CompareKey(node_key(pdata, i, key_buffer.data()), key, file_header_.attr_type, file_header_.attr_length) == 0) {
+      count++;
+    }
+  }
+  disk_buffer_pool_->unpin_page(&page_handle);
+  return count;
+}
+
+// 调用方持有spill_latch_的排他锁。key为 属性值 + POSTING_KEY_RID，
+// 这个值在叶子中的RID达到posting_threshold()个时，全部移到一条新的倒排链中
+RC BplusTreeHandler::spill_posting_list(char *key) {
+  int attr_length = file_header_.attr_length;
+  RID head_rid;
+  RC rc = find_entry(key, &head_rid);
+  if (rc != RC::RECORD_INVALID_KEY) {
+    return rc;
+  }
+
+  // POSTING_KEY_RID比所有的RID都小，从它所在的叶子开始就能找到这个值的全部RID
+  std::vector<RID> rids;
+  PageNum leaf_page;
+  rc = find_leaf(key, &leaf_page);
+  if (rc != SUCCESS) {
+    return rc;
+  }
+  std::vector<char> key_buffer(file_header_.key_length);
+  bool finished = false;
+  while (leaf_page > 0 && !finished) {
+    // 其他写者都持有spill_latch_的共享锁，这里只是和调用find_leaf时一样逐个锁住叶子
+    std::shared_lock<std::shared_mutex> leaf_guard(node_latch(leaf_page), std::adopt_lock);
+    BPPageHandle page_handle;
+    char *pdata;
+    rc = disk_buffer_pool_->get_this_page(file_id_, leaf_page, &page_handle);
+    if (rc != SUCCESS) {
+      return rc;
+    }
+    disk_buffer_pool_->get_data(&page_handle, &pdata);
+    int key_num = ((IndexNode *)(pdata + sizeof(IndexFileHeader)))->key_num;
+    for (int i = 0; i < key_num; i++) {
+      int cmp = CompareKey(node_key(pdata, i, key_buffer.data()), key, file_header_.attr_type, attr_length);
+      if (cmp > 0) {
+        finished = true;
+        break;
+      }
+      if (cmp == 0) {
+        rids.push_back(node_rid(pdata, i));
+      }
+    }
+    leaf_page = leaf_next_page(pdata);
+    disk_buffer_pool_->unpin_page(&page_handle);
+    leaf_guard.unlock();
+    if (leaf_page > 0 && !finished) {
+      node_latch(leaf_page).lock_shared();
+    }
+  }
+  if ((int)rids.size() < posting_threshold()) {
+    return SUCCESS;
+  }
+
+  PageNum head_page;
+  rc = create_posting_list(rids, &head_page);
+  if (rc != SUCCESS) {
+    return rc;
+  }
+  structure_version_++;
+  for (const RID &rid : rids) {
+    memcpy(key + attr_length, &rid, sizeof(RID));
+    rc = delete_from_tree(key);
+    if (rc != SUCCESS) {
+      LOG_ERROR("Failed to move rid to posting list. rid=%d.%d, rc=%d:%s", rid.page_num, rid.slot_num, rc, strrc(rc));
+      return rc;
+    }
+  }
+  memcpy(key + attr_length, &POSTING_KEY_RID, sizeof(RID));
+  head_rid.page_num = head_page;
+  head_rid.slot_num = 0;
+  return insert_into_tree(key, &head_rid);
+}
+
+RC BplusTreeHandler::insert_posting_entry(char *key, const RID *rid) {
+  int attr_length = file_header_.attr_length;
+  RID head_rid;
+  RC rc;
+  {
+    // 已经有倒排链时只锁住这条链，否则和普通索引一样在叶子中插入
+    std::shared_lock<std::shared_mutex> spill_guard(spill_latch_);
+    memcpy(key + attr_length, &POSTING_KEY_RID, sizeof(RID));
+    rc = find_entry(key, &head_rid);
+    if (rc == SUCCESS) {
+      return add_posting_rid(head_rid.page_num, rid);
+    }
+    if (rc != RC::RECORD_INVALID_KEY) {
+      return rc;
+    }
+    memcpy(key + attr_length, rid, sizeof(RID));
+    rc = insert_into_tree(key, rid);
+    if (rc != SUCCESS) {
+      return rc;
+    }
+    if (count_inline_rids(key) < posting_threshold()) {
+      return SUCCESS;
+    }
+  }
+
+  // 释放共享锁期间其他线程可能已经建好了倒排链，spill_posting_list会重新检查
+  std::unique_lock<std::shared_mutex> spill_guard(spill_latch_);
+  memcpy(key + attr_length, &POSTING_KEY_RID, sizeof(RID));
+  return spill_posting_list(key);
+}
+
+RC BplusTreeHandler::delete_posting_entry(char *key, const RID *rid) {
+  int attr_length = file_header_.attr_length;
+  RID head_rid;
+  RC rc;
+  {
+    std::shared_lock<std::shared_mutex> spill_guard(spill_latch_);
+    memcpy(key + attr_length, &POSTING_KEY_RID, sizeof(RID));
+    rc = find_entry(key, &head_rid);
+    if (rc == RC::RECORD_INVALID_KEY) {
+      memcpy(key + attr_length, rid, sizeof(RID));
+      return delete_from_tree(key);
+    }
+    if (rc != SUCCESS) {
+      return rc;
+    }
+    bool empty = false;
+    rc = remove_posting_rid(head_rid.page_num, rid, &empty);
+    if (rc != SUCCESS || !empty) {
+      return rc;
+    }
+  }
+
+  // 倒排链已经空了，需要从树中删除
+  std::unique_lock<std::shared_mutex> spill_guard(spill_latch_);
+  memcpy(key + attr_length, &POSTING_KEY_RID, sizeof(RID));
+  rc = find_entry(key, &head_rid);
+  if (rc == RC::RECORD_INVALID_KEY) {
+    // 其他线程已经删除了这条空链
+    return SUCCESS;
+  }
+  if (rc != SUCCESS) {
+    return rc;
+  }
+  PostingPageHeader head_header;
+  rc = read_posting_page(head_rid.page_num, &head_header, nullptr);
+  if (rc != SUCCESS || head_header.rid_num > 0) {
+    // 释放共享锁期间又有新的RID插入，链不再为空
+    return rc;
+  }
+
+  // 这个值已经没有任何RID了，从树中删除
+  rc = delete_from_tree(key);
+  structure_version_++;
+  if (rc != SUCCESS) {
+    return rc;
+  }
+  return disk_buffer_pool_->dispose_page(file_id_, head_rid.page_num);
+}
 
 RC BplusTreeHandler::print_tree() {
   BPPageHandle page_handle;
   IndexNode *node;
+  std::vector<char> node_buffer;
   PageNum page_num;
   char *pdata,*pkey;
   int i;
@@ -1471,10 +2725,10 @@ RC BplusTreeHandler::print_tree() {
     return rc;
   }
 
-  node = get_index_node(pdata);
+  node = load_node(pdata, node_buffer);
 
   while(!node->is_leaf){
-    page_num=node->rids[0].page_num;
+    page_num=node->rids()[0].page_num;
     rc = disk_buffer_pool_->unpin_page(&page_handle);
     if(rc!=SUCCESS){
       return rc;
@@ -1487,22 +2741,20 @@ RC BplusTreeHandler::print_tree() {
     if(rc!=SUCCESS){
       return rc;
     }
-    node=(IndexNode *)(pdata+sizeof(IndexFileHeader));
-    node->keys=(char *)node+sizeof(IndexNode);
-    node->rids=(RID *)(node->keys+file_header_.order*file_header_.key_length);
+    node = load_node(pdata, node_buffer);
   }
   page_num=1;
   while(page_num!=0){
     for(i=0;i<node->key_num;i++){
-      pkey=node->keys+i*file_header_.key_length;
-      printf("key : %d,rids (page_num:%d slotnum %d)\n",*(int *)pkey,node->rids[i].page_num,node->rids[i].slot_num);
+      pkey=node->keys()+i*file_header_.key_length;
+      printf("key : %d,rids (page_num:%d slotnum %d)\n",*(int *)pkey,node->rids()[i].page_num,node->rids()[i].slot_num);
     }
     printf("next node:%d\n",page_num);
     rc = disk_buffer_pool_->unpin_page(&page_handle);
     if(rc!=SUCCESS){
       return rc;
     }
-    page_num=node->rids[file_header_.order-1].page_num;
+    page_num=node->rids()[file_header_.order-1].page_num;
     if(page_num==0)
       break;
     rc = disk_buffer_pool_->get_this_page(file_id_, page_num, &page_handle);
@@ -1514,7 +2766,7 @@ RC BplusTreeHandler::print_tree() {
       return rc;
     }
 
-    node = get_index_node(pdata);
+    node = load_node(pdata, node_buffer);
   }
   rc = disk_buffer_pool_->unpin_page(&page_handle);
   if(rc!=SUCCESS){
@@ -1526,13 +2778,13 @@ RC BplusTreeHandler::print_tree() {
 RC BplusTreeHandler::find_first_index_satisfied(CompOp compop, const char *key, PageNum *page_num, int *rididx) {
   BPPageHandle page_handle;
   IndexNode *node;
-  PageNum leaf_page,next;
+  PageNum next;
   char *pdata,*pkey;
   RC rc;
   int i,tmp;
   RID rid;
-  if(compop == LESS_THAN || compop == LESS_EQUAL || compop == NOT_EQUAL){
-    rc = get_first_leaf_page(page_num);
+  if(compop == NO_OP || compop == LESS_THAN || compop == LESS_EQUAL || compop == NOT_EQUAL){
+    rc = find_leaf(nullptr, page_num);
     if(rc != SUCCESS){
       return rc;
     }
@@ -1549,119 +2801,57 @@ RC BplusTreeHandler::find_first_index_satisfied(CompOp compop, const char *key,
   memcpy(pkey, key, file_header_.attr_length);
   memcpy(pkey + file_header_.attr_length, &rid, sizeof(RID));
 
-  rc = find_leaf(pkey, &leaf_page);
-  if(rc != SUCCESS){
-    free(pkey);
-    return rc;
-  }
-  free(pkey);
-
-  next=leaf_page;
-
-  while(next > 0){
+  std::vector<char> key_buffer(file_header_.key_length);
+  rc = find_leaf(pkey, &next);
+  while(rc == SUCCESS){
+    // 持有next的共享锁
     rc = disk_buffer_pool_->get_this_page(file_id_, next, &page_handle);
     if(rc!=SUCCESS){
-      return rc;
-    }
-    rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
-    if(rc!=SUCCESS){
-      return rc;
+      node_latch(next).unlock_shared();
+      break;
     }
+    disk_buffer_pool_->get_data(&page_handle, &pdata);
 
-    node = get_index_node(pdata);
+    node = (IndexNode *)(pdata + sizeof(IndexFileHeader));
     for(i = 0; i < node->key_num; i++){
-      tmp=CompareKey(node->keys+i*file_header_.key_length,key,file_header_.attr_type,file_header_.attr_length);
-      if(compop == EQUAL_TO ||compop == GREAT_EQUAL){
-        if(tmp>=0){
-          rc = disk_buffer_pool_->get_page_num(&page_handle, page_num);
-          if(rc != SUCCESS){
-            return rc;
-          }
-          *rididx=i;
-          rc = disk_buffer_pool_->unpin_page(&page_handle);
-          if(rc != SUCCESS){
-            return rc;
-          }
-          return SUCCESS;
-        }
-      }
-      if(compop == GREAT_THAN){
-        if(tmp > 0){
-          rc = disk_buffer_pool_->get_page_num(&page_handle, page_num);
-          if(rc!=SUCCESS){
-            return rc;
-          }
-          *rididx=i;
-          rc = disk_buffer_pool_->unpin_page(&page_handle);
-          if(rc!=SUCCESS){
-            return rc;
-          }
-          return SUCCESS;
-        }
+      tmp=CompareKey(node_key(pdata, i, key_buffer.data()),key,file_header_.attr_type,file_header_.attr_length);
+      if(((compop == EQUAL_TO || compop == GREAT_EQUAL) && tmp >= 0) || (compop == GREAT_THAN && tmp > 0)){
+        break;
       }
-
     }
-    next=node->rids[file_header_.order-1].page_num;
-  }
-  rc = disk_buffer_pool_->unpin_page(&page_handle);
-  if(rc != SUCCESS){
-    return rc;
-  }
-  return RC::RECORD_EOF;
-}
-
-RC BplusTreeHandler::get_first_leaf_page(PageNum *leaf_page) {
-  RC rc;
-  BPPageHandle page_handle;
-  PageNum page_num;
-  IndexNode *node;
-  char *pdata;
-
-  rc = disk_buffer_pool_->get_this_page(file_id_, file_header_.root_page, &page_handle);
-  if(rc!=SUCCESS){
-    return rc;
-  }
-  rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
-  if(rc!=SUCCESS){
-    return rc;
-  }
-
-  node = get_index_node(pdata);
-
-  while(node->is_leaf==false){
-    page_num=node->rids[0].page_num;
-    rc = disk_buffer_pool_->unpin_page(&page_handle);
-    if(rc!=SUCCESS){
-      return rc;
+    if(i < node->key_num){
+      disk_buffer_pool_->unpin_page(&page_handle);
+      *page_num = next;
+      *rididx = i;
+      free(pkey);
+      return SUCCESS;
     }
 
-    rc = disk_buffer_pool_->get_this_page(file_id_, page_num, &page_handle);
-    if(rc!=SUCCESS){
-      return rc;
+    // 横向移到右兄弟时不同时持有两个叶子的锁，加锁后树的结构变过就从根重新查找
+    PageNum following = leaf_next_page(pdata);
+    uint64_t version = structure_version_;
+    disk_buffer_pool_->unpin_page(&page_handle);
+    node_latch(next).unlock_shared();
+    if(following <= 0){
+      rc = RC::RECORD_EOF;
+      break;
     }
-    rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
-    if(rc!=SUCCESS){
-      return rc;
+    node_latch(following).lock_shared();
+    if(version == structure_version_){
+      next = following;
+      continue;
     }
-
-    node = get_index_node(pdata);
-  }
-  rc = disk_buffer_pool_->get_page_num(&page_handle, leaf_page);
-  if(rc!=SUCCESS){
-    return rc;
-  }
-  rc = disk_buffer_pool_->unpin_page(&page_handle);
-  if(rc!=SUCCESS){
-    return rc;
+    node_latch(following).unlock_shared();
+    rc = find_leaf(pkey, &next);
   }
-  return SUCCESS;
+  free(pkey);
+  return rc;
 }
 
 BplusTreeScanner::BplusTreeScanner(BplusTreeHandler &index_handler) : index_handler_(index_handler){
 }
 
 RC BplusTreeScanner::open(CompOp comp_op,const char *value) {
-  RC rc;
   if(opened_){
     return RC::RECORD_OPENNED;
   }
@@ -1675,18 +2865,15 @@ RC BplusTreeScanner::open(CompOp comp_op,const char *value) {
   }
   memcpy(value_copy, value, index_handler_.file_header_.attr_length);
   value_ = value_copy; // free value_
-  rc = index_handler_.find_first_index_satisfied(comp_op, value, &next_page_num_, &index_in_node_);
-  if(rc != SUCCESS){
-    if(rc == RC::RECORD_EOF){
-      next_page_num_ = -1;
-      index_in_node_ = -1;
-    }
-    else
-      return rc;
-  }
-  num_fixed_pages_ = 1;
-  next_index_of_page_handle_=0;
-  pinned_page_count_ = 0;
+  // 第一次next_entry时再定位，定位和读取在同一次加锁中完成
+  positioned_ = false;
+  leaf_page_ = -1;
+  index_in_node_ = 0;
+  has_last_key_ = false;
+  last_key_.resize(index_handler_.file_header_.key_length);
+  key_buffer_.resize(index_handler_.file_header_.key_length);
+  posting_rids_.clear();
+  posting_index_ = 0;
   opened_ = true;
   return SUCCESS;
 }
@@ -1702,96 +2889,187 @@ RC BplusTreeScanner::close() {
 }
 
 RC BplusTreeScanner::next_entry(RID *rid) {
+  return next_entry(rid, nullptr);
+}
+
+RC BplusTreeScanner::next_entry(RID *rid, char *key) {
   RC rc;
   if(!opened_){
     return RC::RECORD_CLOSED;
   }
-  rc = get_next_idx_in_memory(rid);//和RM中一样，有可能有错误，一次只查当前页和当前页的下一页，有待确定
-  if(rc == RC::RECORD_NO_MORE_IDX_IN_MEM){
-    rc = find_idx_pages();
+  if(!index_handler_.file_header_.posting_list){
+    rc = next_tree_entry(rid);
+    if(rc == SUCCESS && key != nullptr){
+      memcpy(key, last_key_.data(), index_handler_.file_header_.attr_length);
+    }
+    return rc;
+  }
+
+  std::shared_lock<std::shared_mutex> spill_guard(index_handler_.spill_latch_);
+  // 倒排格式：指向倒排链的一项展开成整条RID列表，叶子中逐条存放的RID直接返回
+  int attr_length = index_handler_.file_header_.attr_length;
+  if(posting_index_ >= posting_rids_.size()){
+    rc = resume_spilled_value();
     if(rc != SUCCESS){
       return rc;
     }
-    return get_next_idx_in_memory(rid);
   }
-  else{
+  while(posting_index_ >= posting_rids_.size()){
+    RID value_rid;
+    rc = next_tree_entry(&value_rid);
+    if(rc != SUCCESS){
+      return rc;
+    }
+    posting_rids_.clear();
+    posting_index_ = 0;
+    if(CmpRid((const RID *)(last_key_.data() + attr_length), &POSTING_KEY_RID) != 0){
+      posting_rids_.push_back(value_rid);
+      continue;
+    }
+    rc = index_handler_.read_posting_list(value_rid.page_num, posting_rids_);
     if(rc != SUCCESS){
       return rc;
     }
   }
+  *rid = posting_rids_[posting_index_++];
+  if(key != nullptr){
+    memcpy(key, last_key_.data(), attr_length);
+  }
   return SUCCESS;
 }
 
-RC BplusTreeScanner::find_idx_pages() {
-  RC rc;
-  if(!opened_){
-    return RC::RECORD_CLOSED;
+// 调用方持有spill_latch_的共享锁。上一次返回的是叶子中逐条存放的RID，之后这个值被转成了倒排链时，
+// 剩下的RID都在链中，而指向链的一项排在已经返回的位置之前，从链中接着取大于上一个RID的部分
+RC BplusTreeScanner::resume_spilled_value() {
+  BplusTreeHandler &handler = index_handler_;
+  int attr_length = handler.file_header_.attr_length;
+  if(!has_last_key_ || structure_version_ == handler.structure_version_){
+    return SUCCESS;
   }
-  if(pinned_page_count_ > 0){
-    for(int i = 0; i < pinned_page_count_; i++){
-      rc = index_handler_.disk_buffer_pool_->unpin_page(page_handles_ + i);
-      if(rc != SUCCESS){
-        return rc;
-      }
+  RID last_rid = *(const RID *)(last_key_.data() + attr_length);
+  if(CmpRid(&last_rid, &POSTING_KEY_RID) == 0){
+    return SUCCESS;
+  }
+  memcpy(last_key_.data() + attr_length, &POSTING_KEY_RID, sizeof(RID));
+  RID head;
+  RC rc = handler.find_entry(last_key_.data(), &head);
+  if(rc == RC::RECORD_INVALID_KEY){
+    memcpy(last_key_.data() + attr_length, &last_rid, sizeof(RID));
+    return SUCCESS;
+  }
+  if(rc != SUCCESS){
+    return rc;
+  }
+  std::vector<RID> rids;
+  rc = handler.read_posting_list(head.page_num, rids);
+  if(rc != SUCCESS){
+    return rc;
+  }
+  posting_rids_.clear();
+  posting_index_ = 0;
+  for(const RID &rid : rids){
+    if(CmpRid(&rid, &last_rid) > 0){
+      posting_rids_.push_back(rid);
     }
   }
-  next_index_of_page_handle_ = 0;
-  pinned_page_count_ = 0;
+  // last_key_停在指向链的一项上，next_tree_entry从它之后继续
+  return SUCCESS;
+}
 
-  for(int i = 0; i < num_fixed_pages_; i++){
-    if(next_page_num_ <= 0)
-      break;
-    rc = index_handler_.disk_buffer_pool_->get_this_page(index_handler_.file_id_, next_page_num_, page_handles_ + i);
-    if(rc != SUCCESS){
-      return rc;
+// 锁住leaf_page_(共享锁)。从根查找得到的叶子一定有效；记下的叶子(上一次扫描到的、或者横向移到的右兄弟)
+// 在没有持有锁的期间可能已经分裂或者被合并释放，树的结构版本变化后从根重新查找
+RC BplusTreeScanner::lock_leaf() {
+  RC rc;
+  BplusTreeHandler &handler = index_handler_;
+  if(positioned_){
+    if(leaf_page_ == -1){
+      return RC::RECORD_EOF;
     }
-    char *pdata;
-    rc = index_handler_.disk_buffer_pool_->get_data(page_handles_ + i, &pdata);
-    if(rc != SUCCESS){
+    handler.node_latch(leaf_page_).lock_shared();
+    if(structure_version_ == handler.structure_version_){
+      return SUCCESS;
+    }
+    handler.node_latch(leaf_page_).unlock_shared();
+    index_in_node_ = 0;
+    if(has_last_key_){
+      rc = handler.find_leaf(last_key_.data(), &leaf_page_);
+      if(rc == SUCCESS){
+        structure_version_ = handler.structure_version_;
+      }
       return rc;
     }
+    positioned_ = false;
+  }
 
-    IndexNode *node = index_handler_.get_index_node(pdata);
-    pinned_page_count_++;
-    next_page_num_ = node->rids[index_handler_.file_header_.order-1].page_num;
+  rc = handler.find_first_index_satisfied(comp_op_, value_, &leaf_page_, &index_in_node_);
+  // 得到位置之后叶子可能又有插入，从叶子的开头找，前面的key都不满足条件
+  index_in_node_ = 0;
+  if(rc != SUCCESS){
+    positioned_ = rc == RC::RECORD_EOF;
+    leaf_page_ = -1;
+    return rc;
   }
-  if(pinned_page_count_ > 0)
-    return SUCCESS;
-  return RC::RECORD_EOF;
+  positioned_ = true;
+  structure_version_ = handler.structure_version_;
+  return SUCCESS;
 }
 
-RC BplusTreeScanner::get_next_idx_in_memory(RID *rid) {
-  char *pdata;
-  IndexNode *node;
+RC BplusTreeScanner::next_tree_entry(RID *rid) {
   RC rc;
-  if(next_index_of_page_handle_ >= pinned_page_count_) {
-    return RC::RECORD_NO_MORE_IDX_IN_MEM;
-  }
-
-  if(next_page_num_ == -1 && index_in_node_ == -1) {
-    return RC::RECORD_EOF;
-  }
+  BplusTreeHandler &handler = index_handler_;
+  const IndexFileHeader &file_header = handler.file_header_;
 
-  for( ; next_index_of_page_handle_ < pinned_page_count_; next_index_of_page_handle_++){
-    rc = index_handler_.disk_buffer_pool_->get_data(page_handles_ + next_index_of_page_handle_, &pdata);
+  while(true){
+    rc = lock_leaf();
     if(rc != SUCCESS){
-      LOG_ERROR("Failed to get data from disk buffer pool. rc=%s", strrc);
       return rc;
     }
-
-    node = index_handler_.get_index_node(pdata);
-    for( ; index_in_node_ < node->key_num; index_in_node_++){
-      if(satisfy_condition(node->keys + index_in_node_ * index_handler_.file_header_.key_length)){
-        memcpy(rid,node->rids+index_in_node_,sizeof(RID));
-        index_in_node_++;
-        return SUCCESS;
+    std::shared_lock<std::shared_mutex> leaf_guard(handler.node_latch(leaf_page_), std::adopt_lock);
+    BPPageHandle page_handle;
+    char *pdata;
+    rc = handler.disk_buffer_pool_->get_this_page(handler.file_id_, leaf_page_, &page_handle);
+    if(rc != SUCCESS){
+      return rc;
+    }
+    handler.disk_buffer_pool_->get_data(&page_handle, &pdata);
+
+    int key_num = ((IndexNode *)(pdata + sizeof(IndexFileHeader)))->key_num;
+    int i = index_in_node_;
+    if(has_last_key_){
+      // 上次返回的key还在原来的位置上时，说明这之前没有插入或删除，直接继续
+      bool unchanged = i > 0 && i <= key_num &&
+          CmpKey(file_header.attr_type, file_header.attr_length, last_key_.data(),
+                 handler.node_key(pdata, i - 1, key_buffer_.data())) == 0;
+      if(!unchanged){
+        for(i = 0; i < key_num; i++){
+          if(CmpKey(file_header.attr_type, file_header.attr_length,
+                    handler.node_key(pdata, i, key_buffer_.data()), last_key_.data()) > 0){
+            break;
+          }
+        }
       }
     }
-
+    for( ; i < key_num; i++){
+      const char *node_key = handler.node_key(pdata, i, key_buffer_.data());
+      if(satisfy_condition(node_key)){
+        *rid = handler.node_rid(pdata, i);
+        memcpy(last_key_.data(), node_key, file_header.key_length);
+        has_last_key_ = true;
+        index_in_node_ = i + 1;
+        return handler.disk_buffer_pool_->unpin_page(&page_handle);
+      }
+    }
+    // 右兄弟在下一轮lock_leaf中加锁并检查版本
+    PageNum next_page = handler.leaf_next_page(pdata);
+    rc = handler.disk_buffer_pool_->unpin_page(&page_handle);
+    if(rc != SUCCESS){
+      return rc;
+    }
+    leaf_page_ = next_page > 0 ? next_page : -1;
     index_in_node_ = 0;
   }
-  return RC::RECORD_NO_MORE_IDX_IN_MEM;
 }
+
 bool BplusTreeScanner::satisfy_condition(const char *pkey) {
   int i1=0,i2=0;
   float f1=0,f2=0;
@@ -1,25 +1,76 @@
 #ifndef __OBSERVER_STORAGE_COMMON_INDEX_MANAGER_H_
 #define __OBSERVER_STORAGE_COMMON_INDEX_MANAGER_H_
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
 #include "record_manager.h"
 #include "storage/default/disk_buffer_pool.h"
 #include "sql/parser/parse_defs.h"
 
+// 索引文件第1页开头的标识和格式版本。文件格式变化时增加版本号，打开版本不同的文件会返回RC::FORMAT
+static const int INDEX_FILE_MAGIC = 0x58444e49;  // "INDX"
+static const int INDEX_FILE_VERSION = 3;         // 2: 增加倒排链、前缀压缩以及fill_order; 3: 节点头不再保存指针
+
 struct IndexFileHeader {
+  int magic;
+  int version;
   int attr_length;
   int key_length;
   AttrType attr_type;
   PageNum root_page; // 初始时，root_page一定是1
   int node_num;
   int order;
+  int posting_list;  // 非唯一索引：重复较多的key在树中只出现一次，RID列表压缩存放在倒排页中
+  int key_compress;  // CHARS索引：节点内的key做前缀压缩，内部节点保存截断后的分隔key
+  int fill_order;    // 不压缩时节点的order，下溢/合并按它判断，保证合并后的节点一定放得下；不压缩的索引等于order
+};
+
+// 前缀压缩格式的节点头，前三个字段与IndexNode相同。
+// 后面依次是prefix_len字节的公共前缀、key_num个(suffix_len字节的后缀 + key中的RID)、key_num+1个RID。
+// key按字符串处理，'\0'之后的内容不保存，解码时补零
+struct CompressedIndexNode {
+  int is_leaf;
+  int key_num;
+  PageNum parent;
+  PageNum next_leaf;  // 叶子节点的右兄弟
+  int prefix_len;
+  int suffix_len;
 };
 
+// 倒排页的页头，后面是按(page_num, slot_num)递增排序的RID，
+// 第一个RID存在页头中，其余为与前一个RID之差的varint编码
+struct PostingPageHeader {
+  PageNum next_page;  // -1 表示没有后继
+  PageNum tail_page;  // 只有链头的值有意义，指向链上最后一个页
+  int rid_num;
+  int data_len;
+  RID first;
+  RID last;
+};
+
+// 节点头后面依次是order个key和order个RID。页内不保存指针，只读访问不需要写页面
 struct IndexNode {
   int is_leaf;
   int key_num;
   PageNum parent;
-  char *keys;
-  RID *rids;
+  int rid_offset;  // rids相对keys的字节偏移(order * key_length)，创建节点时写入
+
+  char *keys() {
+    return (char *)(this + 1);
+  }
+  RID *rids() {
+    return (RID *)(keys() + rid_offset);
+  }
+  const char *keys() const {
+    return (const char *)(this + 1);
+  }
+  const RID *rids() const {
+    return (const RID *)(keys() + rid_offset);
+  }
 };
 
 struct TreeNode {
@@ -39,16 +90,21 @@ struct Tree {
 
 class BplusTreeHandler {
 public:
+  ~BplusTreeHandler();
+
   /**
    * 此函数创建一个名为fileName的索引。
-   * attrType描述被索引属性的类型，attrLength描述被索引属性的长度
+   * attrType描述被索引属性的类型，attrLength描述被索引属性的长度。
+   * key_compress只对CHARS索引有效，创建之后不能再改变
    */
-  RC create(const char *file_name, AttrType attr_type, int attr_length);
+  RC create(const char *file_name, AttrType attr_type, int attr_length, bool posting_list = false,
+            bool key_compress = false);
 
   /**
    * 打开名为fileName的索引文件。
    * 如果方法调用成功，则indexHandle为指向被打开的索引句柄的指针。
-   * 索引句柄用于在索引中插入或删除索引项，也可用于索引的扫描
+   * 索引句柄用于在索引中插入或删除索引项，也可用于索引的扫描。
+   * 不是索引文件或者格式版本不同时返回RC::FORMAT
    */
   RC open(const char *file_name);
 
@@ -81,24 +137,112 @@ public:
   RC print();
   RC print_tree();
 protected:
-  RC find_leaf(const char *pkey, PageNum *leaf_page);
+  class NodeLatches;
+
+  /**
+   * 从根查找key所在的叶子(pkey为nullptr时找最左边的叶子)，一路上拿到孩子的锁之后释放父节点的锁。
+   * 返回时持有叶子的锁，exclusive为true时是排他锁，调用方负责释放
+   */
+  RC find_leaf(const char *pkey, PageNum *leaf_page, bool exclusive = false);
   RC insert_into_leaf(PageNum leaf_page, const char *pkey, const RID *rid);
-  RC insert_into_leaf_after_split(PageNum leaf_page, const char *pkey, const RID *rid);
-  RC insert_into_parent(PageNum parent_page, PageNum leaf_page, const char *pkey, PageNum right_page);
-  RC insert_into_new_root(PageNum leaf_page, const char *pkey, PageNum right_page);
+  RC insert_into_leaf_after_split(PageNum leaf_page, const char *pkey, const RID *rid, NodeLatches &latches);
+  RC insert_into_parent(PageNum parent_page, PageNum leaf_page, const char *pkey, PageNum right_page,
+                        NodeLatches &latches);
+  RC insert_into_new_root(PageNum leaf_page, const char *pkey, PageNum right_page, NodeLatches &latches);
   RC insert_intern_node(PageNum parent_page, PageNum leaf_page, PageNum right_page, const char *pkey);
-  RC insert_intern_node_after_split(PageNum intern_page, PageNum leaf_page, PageNum right_page, const char *pkey);
+  RC insert_intern_node_after_split(PageNum intern_page, PageNum leaf_page, PageNum right_page, const char *pkey,
+                                    NodeLatches &latches);
 
   RC delete_entry_from_node(PageNum node_page, const char *pkey);
-  RC delete_entry_internal(PageNum page_num, const char *pkey);
-  RC coalesce_node(PageNum leaf_page, PageNum right_page);
-  RC redistribute_nodes(PageNum left_page, PageNum right_page);
+  RC delete_entry_internal(PageNum page_num, const char *pkey, NodeLatches &latches);
+  RC coalesce_node(PageNum leaf_page, PageNum right_page, NodeLatches &latches);
+  RC redistribute_nodes(PageNum left_page, PageNum right_page, NodeLatches &latches);
 
+  /**
+   * 返回第一个可能满足条件的叶子，返回SUCCESS时持有它的共享锁
+   */
   RC find_first_index_satisfied(CompOp comp_op, const char *pkey, PageNum *page_num, int *rididx);
-  RC get_first_leaf_page(PageNum *leaf_page);
+
+  /**
+   * 乐观路径：沿路径加共享锁，只对叶子加排他锁。如果叶子修改后仍然"安全"(不分裂/不下溢)就直接完成,
+   * 否则置*done=false，由调用方走悲观路径
+   */
+  RC insert_entry_optimistic(const char *key, const RID *rid, bool *done);
+  RC delete_entry_optimistic(const char *key, bool *done);
+
+  /**
+   * 悲观路径：lock_path沿路径加排他锁，遇到安全的节点就释放它的祖先，只锁住要修改的子树。
+   * 插入时每一轮只分裂最高的一个不安全节点(它的父节点一定放得下新的分隔key)，分裂后重新从根开始，
+   * 直到叶子放得下新key；删除时下溢自底向上传递，最多传到最低的安全节点
+   */
+  RC insert_entry_pessimistic(const char *key, const RID *rid);
+  RC delete_entry_pessimistic(const char *key);
+  RC lock_path(const char *key, bool insert, NodeLatches &latches);
+  RC insert_into_tree(const char *key, const RID *rid);
+  RC delete_from_tree(const char *key);
+
+  /**
+   * 倒排格式下的插入/删除，key的前attr_length字节为属性值，后面的RID部分由函数填写。
+   * 一个值的RID不多时和普通索引一样逐条存放在叶子中(属性值 + RID)；
+   * 叶子中同一个值的RID达到posting_threshold()个后，在spill_latch_的排他锁下转成一条倒排链，
+   * 树中只保留一项 属性值 + POSTING_KEY_RID，对应的rid指向链头。同一个值不会同时有两种存放方式。
+   * 其他操作持有spill_latch_的共享锁，倒排链的读写只持有这条链的posting_latch，
+   * 只有建链和删除空链时才需要排他锁
+   */
+  RC insert_posting_entry(char *key, const RID *rid);
+  RC delete_posting_entry(char *key, const RID *rid);
+  RC add_posting_rid(PageNum head_page, const RID *rid);
+  RC remove_posting_rid(PageNum head_page, const RID *rid, bool *empty);
+  RC create_posting_list(const std::vector<RID> &rids, PageNum *head_page);
+  RC spill_posting_list(char *key);
+  int count_inline_rids(const char *key);
+  int posting_threshold() const {
+    return std::max(2, file_header_.fill_order / 4);
+  }
+  RC find_entry(const char *key, RID *rid);
+  RC read_posting_list(PageNum head_page, std::vector<RID> &rids);
+  RC read_posting_page(PageNum page_num, PostingPageHeader *header, std::vector<RID> *rids);
+  RC write_posting_page(PageNum page_num, const PostingPageHeader &header, const std::vector<RID> &rids);
+  RC allocate_posting_page(PageNum *page_num);
+
+  /**
+   * 把节点对半分裂(不带新key)，分隔key插入父节点。前缀压缩格式下节点放不下新key时先分裂再重新定位插入，
+   * 悲观插入也用它分裂路径上最高的不安全内部节点
+   */
+  RC split_node(PageNum page_num, NodeLatches &latches);
+  RC insert_into_parent_compressed(PageNum parent_page, PageNum left_page, const char *pkey, PageNum right_page,
+                                   NodeLatches &latches);
 
 private:
-  IndexNode *get_index_node(char *page_data) const;
+  IndexNode *get_index_node(char *page_data) const {
+    return (IndexNode *)(page_data + sizeof(IndexFileHeader));
+  }
+
+  /**
+   * 结构修改时使用的节点访问接口。未压缩的节点直接指向页内数据；
+   * 压缩的节点解码到buffer中，修改后调用store_node编码回页面
+   */
+  IndexNode *load_node(char *page_data, std::vector<char> &buffer) const;
+  IndexNode *init_node(char *page_data, std::vector<char> &buffer, bool is_leaf) const;
+  bool store_node(char *page_data, const IndexNode *node) const;
+  int encoded_size(const IndexNode *node) const;
+  bool leaf_has_room(char *page_data, const char *pkey) const;
+  bool intern_has_room(char *page_data, const char *pkey) const;
+  bool intern_has_room_for_any(char *page_data) const;
+  bool delete_is_safe(char *page_data) const;
+  int min_keys(bool is_leaf) const;
+  void make_separator(const char *left_key, const char *right_key, char *separator) const;
+
+  /**
+   * 只读访问，不需要解码整个节点。未压缩时返回页内地址，否则把key解码到buffer(key_length字节)
+   */
+  const char *node_key(char *page_data, int index, char *buffer) const;
+  RID node_rid(char *page_data, int index) const;
+  PageNum leaf_next_page(char *page_data) const;
+  std::shared_mutex &node_latch(PageNum page_num);
+  std::shared_mutex &posting_latch(PageNum head_page) {
+    return posting_latches_[head_page % POSTING_LATCH_NUM];
+  }
 
 private:
   DiskBufferPool  * disk_buffer_pool_ = nullptr;
@@ -106,10 +250,71 @@ private:
   bool              header_dirty_ = false;
   IndexFileHeader   file_header_;
 
+  // 并发控制:
+  // 每个节点页一个读写锁，总是自顶向下加锁；兄弟节点只在持有父节点排他锁时才一起加锁，
+  // 扫描横向移到右兄弟前先释放当前叶子的锁，所以不会死锁。
+  // root_latch_ 保护根页号和树高，可能改变根的写者持有它的排他锁，直到路径上出现安全的节点
+  static const int  NODE_LATCH_SEGMENT = 512;
+  static const int  NODE_LATCH_SEGMENT_NUM =
+      (int)((BP_PAGE_DATA_SIZE - BP_FILE_SUB_HDR_SIZE) * 8 / NODE_LATCH_SEGMENT) + 1;
+  std::atomic<std::shared_mutex *> node_latches_[NODE_LATCH_SEGMENT_NUM] = {};
+  std::shared_mutex root_latch_;
+  int               tree_height_ = 1;  // 叶子为第1层，find_leaf据此在到达叶子前决定加哪种锁
+  // 倒排格式下建链和删除空链持有排他锁，其他操作持有共享锁；普通索引不使用
+  std::shared_mutex spill_latch_;
+  // 倒排链按链头页号分片加锁，链头在链的生命周期内不变
+  static const int  POSTING_LATCH_NUM = 64;
+  std::shared_mutex posting_latches_[POSTING_LATCH_NUM];
+  // 每次分裂/合并/重分布/建链之后、释放节点锁之前递增。扫描记下的叶子和横向移到的右兄弟
+  // 在没有持有锁的期间可能被修改或者释放，加锁后版本没变才能继续使用
+  std::atomic<uint64_t> structure_version_{0};
+
 private:
   friend class BplusTreeScanner;
 };
 
+// 一次写操作按加锁顺序持有的节点排他锁，析构时全部释放
+class BplusTreeHandler::NodeLatches {
+public:
+  explicit NodeLatches(BplusTreeHandler &handler) : handler_(handler) {}
+  ~NodeLatches() {
+    release_all();
+  }
+
+  void lock_root() {
+    root_guard_ = std::unique_lock<std::shared_mutex>(handler_.root_latch_);
+  }
+  bool holds_root() const {
+    return root_guard_.owns_lock();
+  }
+  /**
+   * 对节点加排他锁，已经持有时返回false
+   */
+  bool lock(PageNum page_num);
+  void unlock(PageNum page_num);
+  /**
+   * 最后加锁的节点是安全的，释放根锁和它之前的所有锁
+   */
+  void release_ancestors();
+  void release_all();
+  const std::vector<PageNum> &pages() const {
+    return pages_;
+  }
+  /**
+   * 合并后不再使用的页面在释放所有锁之后才归还给缓冲池。否则别的写者分配到这个页号时，
+   * 会在持有自己路径上节点的锁时等待这里的锁
+   */
+  void dispose(PageNum page_num) {
+    disposed_.push_back(page_num);
+  }
+
+private:
+  BplusTreeHandler &handler_;
+  std::unique_lock<std::shared_mutex> root_guard_;
+  std::vector<PageNum> pages_;
+  std::vector<PageNum> disposed_;
+};
+
 class BplusTreeScanner {
 public:
   BplusTreeScanner(BplusTreeHandler &index_handler);
@@ -126,6 +331,11 @@ public:
    * 并返回该索引项对应的记录的ID
    */
   RC next_entry(RID *rid);
+  /**
+   * 同next_entry，并把索引项的key拷贝到key中（attr_length字节），
+   * 覆盖索引扫描时不需要再回表取记录
+   */
+  RC next_entry(RID *rid, char *key);
 
   /**
    * 关闭一个索引扫描，释放相应的资源
@@ -139,8 +349,9 @@ public:
   // RC getIndexTree(char *fileName, Tree *index);
 
 private:
-  RC get_next_idx_in_memory(RID *rid);
-  RC find_idx_pages();
+  RC lock_leaf();
+  RC next_tree_entry(RID *rid);
+  RC resume_spilled_value();
   bool satisfy_condition(const char *key);
 
 private:
@@ -148,12 +359,19 @@ private:
   bool opened_ = false;
   CompOp comp_op_ = NO_OP;                      // 用于比较的操作符
   const char *value_ = nullptr;		              // 与属性行比较的值
-  int num_fixed_pages_ = -1;                    // 固定在缓冲区中的页，与指定的页面固定策略有关
-  int pinned_page_count_ = 0;                   // 实际固定在缓冲区的页面数
-  BPPageHandle page_handles_[BP_BUFFER_SIZE];   // 固定在缓冲区页面所对应的页面操作列表
-  int next_index_of_page_handle_ = -1;          // 当前被扫描页面的操作索引
-  int index_in_node_ = -1;                      // 当前B+ Tree页面上的key index
-  PageNum next_page_num_ = -1;                  // 下一个将要被读入的页面号
+
+  // 两次调用之间不固定页面也不持有锁，每次按上一次返回的key(带RID，在树中唯一)重新定位:
+  // 叶子内有插入/删除时从头找第一个大于last_key_的位置，树的结构变化后从根重新查找。
+  // 记下的叶子没有被持有锁，加锁后再比较structure_version_
+  bool positioned_ = false;                     // 是否已经定位到第一个满足条件的叶子
+  PageNum leaf_page_ = -1;                      // 当前扫描的叶子，-1表示扫描结束
+  int index_in_node_ = 0;                       // 下一个要检查的key在叶子中的位置，只作为提示
+  uint64_t structure_version_ = 0;              // 定位leaf_page_时树的结构版本
+  std::vector<char> last_key_;                  // 上一次返回的key，key_length字节
+  bool has_last_key_ = false;
+  std::vector<RID> posting_rids_;               // 倒排格式下当前值还没有返回的RID
+  size_t posting_index_ = 0;
+  std::vector<char> key_buffer_;                // 压缩格式下解码key用的缓冲区
 };
 
 #endif //__OBSERVER_STORAGE_COMMON_INDEX_MANAGER_H_
\ No newline at end of file
@@ -15,7 +15,7 @@ RC BplusTreeIndex::create(const char *file_name, const IndexMeta &index_meta, co
     return rc;
   }
 
-  rc = index_handler_.create(file_name, field_meta.type(), field_meta.len());
+  rc = index_handler_.create(file_name, field_meta.type(), field_meta.len(), unique_ == 0, key_compress_);
   if (RC::SUCCESS == rc) {
     inited_ = true;
   }
@@ -98,6 +98,10 @@ RC BplusTreeIndexScanner::next_entry(RID *rid) {
   return tree_scanner_->next_entry(rid);
 }
 
+RC BplusTreeIndexScanner::next_entry(RID *rid, char *key) {
+  return tree_scanner_->next_entry(rid, key);
+}
+
 RC BplusTreeIndexScanner::destroy() {
   delete this;
   return RC::SUCCESS;
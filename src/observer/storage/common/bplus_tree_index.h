@@ -6,12 +6,12 @@
 
 class BplusTreeIndex : public Index {
 public:
-  BplusTreeIndex(int unique = 0) : unique_(unique) {}
+  BplusTreeIndex(int unique = 0, bool key_compress = false) : unique_(unique), key_compress_(key_compress) {}
   virtual ~BplusTreeIndex() noexcept;
 
   RC create(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta);
   RC open(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta);
-  RC close();
+  RC close() override;
 
   RC insert_entry(const char *record, const RID *rid) override;
   RC delete_entry(const char *record, const RID *rid) override;
@@ -24,6 +24,7 @@ private:
   bool inited_ = false;
   BplusTreeHandler index_handler_;
   int unique_; // unique index
+  bool key_compress_;  // 创建CHARS索引时是否使用前缀压缩，打开已有的索引时以文件头为准
 };
 
 class BplusTreeIndexScanner : public IndexScanner {
@@ -32,6 +33,7 @@ public:
   ~BplusTreeIndexScanner() noexcept override;
 
   RC next_entry(RID *rid) override;
+  RC next_entry(RID *rid, char *key) override;
   RC destroy() override;
 private:
   BplusTreeScanner * tree_scanner_;
@@ -1,14 +1,18 @@
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include "condition_filter.h"
 #include "record_manager.h"
 #include "common/log/log.h"
 #include "storage/common/table.h"
 #include "common/lang/bitmap.h"
+#include <algorithm>
 #include <vector>
 #include <map>
 #include "sql/executor/executor_builder.h"
 #include "sql/executor/exp_execution_node.h"
 #include "sql/executor/util.h"
+#include "util/filter_kernel.h"
 
 using namespace common;
 
@@ -47,9 +51,84 @@ RC DefaultConditionFilter::init(Table *table, const ConDesc &left, const ConDesc
   right_ = right;
   attr_type_ = attr_type;
   comp_op_ = comp_op;
+  init_batch();
   return RC::SUCCESS;
 }
 
+// 格式化之后的日期 YYYY-MM-DD
+static bool is_formatted_date(const char *s) {
+  for (int i = 0; i < 10; i++) {
+    if (i == 4 || i == 7 ? s[i] != '-' : (s[i] < '0' || s[i] > '9')) {
+      return false;
+    }
+  }
+  return s[10] == '\0';
+}
+
+// 格式化之后的日期按字符串比较与按yyyymmdd整数比较的结果相同
+static int date_key(const char *s) {
+  int year = (s[0] - '0') * 1000 + (s[1] - '0') * 100 + (s[2] - '0') * 10 + (s[3] - '0');
+  int month = (s[5] - '0') * 10 + (s[6] - '0');
+  int day = (s[8] - '0') * 10 + (s[9] - '0');
+  return (year * 100 + month) * 100 + day;
+}
+
+// 占满字段长度的字符串后面没有'\0'，比较时不能超出字段的长度
+static int compare_string(const char *left, size_t left_max, const char *right, size_t right_max) {
+  size_t left_len = strnlen(left, left_max);
+  size_t right_len = strnlen(right, right_max);
+  int cmp_result = memcmp(left, right, std::min(left_len, right_len));
+  if (cmp_result != 0) {
+    return cmp_result;
+  }
+  return left_len < right_len ? -1 : (left_len > right_len ? 1 : 0);
+}
+
+void DefaultConditionFilter::init_batch() {
+  batch_ = false;
+  if (left_.is_attr == right_.is_attr || comp_op_ < EQUAL_TO || comp_op_ > GREAT_THAN) {
+    return;
+  }
+  const ConDesc &attr = left_.is_attr ? left_ : right_;
+  const ConDesc &value = left_.is_attr ? right_ : left_;
+  if (value.is_null || value.value == nullptr) {
+    return;
+  }
+  batch_op_ = comp_op_;
+  if (!left_.is_attr) {
+    // 常量在左边，交换两边
+    switch (comp_op_) {
+      case LESS_THAN:   batch_op_ = GREAT_THAN;  break;
+      case LESS_EQUAL:  batch_op_ = GREAT_EQUAL; break;
+      case GREAT_THAN:  batch_op_ = LESS_THAN;   break;
+      case GREAT_EQUAL: batch_op_ = LESS_EQUAL;  break;
+      default: break;
+    }
+  }
+  switch (attr_type_) {
+    case INTS:
+      batch_int_ = *(int *)value.value;
+      batch_ = true;
+      break;
+    case FLOATS:
+      batch_ = true;
+      break;
+    case DATES:
+      if (attr.attr_length > 10 && is_formatted_date((const char *)value.value)) {
+        batch_int_ = date_key((const char *)value.value);
+        batch_ = true;
+      }
+      break;
+    case CHARS:
+      // 常量比属性短时，strcmp的结果只取决于常量连同结尾'\0'的这几个字节
+      batch_chars_len_ = strlen((const char *)value.value) + 1;
+      batch_ = (comp_op_ == EQUAL_TO || comp_op_ == NOT_EQUAL) && batch_chars_len_ <= attr.attr_length;
+      break;
+    default:
+      break;
+  }
+}
+
 // TODO(wq): 这个函数后续需要更多的检验和转换
 RC DefaultConditionFilter::init(Table &table, const Condition &condition)
 {
@@ -207,7 +286,8 @@ bool DefaultConditionFilter::filter(const Record &rec) const
   switch (attr_type_) {
     case CHARS: {  // 字符串都是定长的，直接比较
       // 按照C字符串风格来定
-      cmp_result = strcmp(left_value, right_value);
+      cmp_result = compare_string(left_value, left_.is_attr ? left_.attr_length : SIZE_MAX,
+                                  right_value, right_.is_attr ? right_.attr_length : SIZE_MAX);
     } break;
     case INTS: {
       // 没有考虑大小端问题
@@ -229,7 +309,8 @@ bool DefaultConditionFilter::filter(const Record &rec) const
     } break;
     case DATES: {  // 字符串日期已经被格式化了，可以直接比较
       // 按照C字符串风格来定
-      cmp_result = strcmp(left_value, right_value);
+      cmp_result = compare_string(left_value, left_.is_attr ? left_.attr_length : SIZE_MAX,
+                                  right_value, right_.is_attr ? right_.attr_length : SIZE_MAX);
     } break;
     default: {
     }
@@ -238,6 +319,61 @@ bool DefaultConditionFilter::filter(const Record &rec) const
  return compare_result(cmp_result, comp_op_);
 }
 
+bool DefaultConditionFilter::filter_batch(const char *records, int record_size, int n, uint8_t *bitmap) const
+{
+  if (!batch_) {
+    return false;
+  }
+  const ConDesc &attr = left_.is_attr ? left_ : right_;
+  const int null_byte = attr.attr_index / 8;
+  const char null_mask = (char)(1 << (attr.attr_index % 8));
+  const char *value = (const char *)(left_.is_attr ? right_.value : left_.value);
+
+  // 先把各条记录中的字段值收集到连续的数组中，null的记录直接过滤掉
+  auto gather = [&](auto &&copy) {
+    for (int i = 0; i < n; i++) {
+      if (((bitmap[i / 8] >> (i % 8)) & 1) == 0) {
+        continue;
+      }
+      const char *record = records + (long)i * record_size;
+      if (record[null_byte] & null_mask) {
+        bitmap[i / 8] &= (uint8_t)~(1 << (i % 8));
+        continue;
+      }
+      copy(i, record + attr.attr_offset);
+    }
+  };
+
+  switch (attr_type_) {
+    case INTS: {
+      std::vector<int> values(n);
+      gather([&](int i, const char *data) { memcpy(&values[i], data, sizeof(int)); });
+      filter_int_kernel(values.data(), n, batch_op_, batch_int_, bitmap);
+    } break;
+    case DATES: {
+      std::vector<int> values(n);
+      gather([&](int i, const char *data) { values[i] = date_key(data); });
+      filter_int_kernel(values.data(), n, batch_op_, batch_int_, bitmap);
+    } break;
+    case FLOATS: {
+      std::vector<float> values(n);
+      gather([&](int i, const char *data) { memcpy(&values[i], data, sizeof(float)); });
+      filter_float_kernel(values.data(), n, batch_op_, *(const float *)value, bitmap);
+    } break;
+    case CHARS: {
+      // 按16/32字节对齐存放，kernel可以一次比较一个值
+      const int len = batch_chars_len_;
+      const int width = len <= 16 ? 16 : (len <= 32 ? 32 : len);
+      std::vector<char> values((size_t)n * width, 0);
+      gather([&](int i, const char *data) { memcpy(values.data() + (size_t)i * width, data, len); });
+      filter_chars_kernel(values.data(), width, n, batch_op_, value, len, bitmap);
+    } break;
+    default:
+      return false;
+  }
+  return true;
+}
+
 CompositeConditionFilter::~CompositeConditionFilter()
 {
   if (memory_owner_) {
@@ -297,6 +433,17 @@ bool CompositeConditionFilter::filter(const Record &rec) const
   return true;
 }
 
+bool CompositeConditionFilter::filter_batch(const char *records, int record_size, int n, uint8_t *bitmap) const
+{
+  bool all_batched = true;
+  for (int i = 0; i < filter_num_; i++) {
+    if (!filters_[i]->filter_batch(records, record_size, n, bitmap)) {
+      all_batched = false;
+    }
+  }
+  return all_batched;
+}
+
 RC DefaultCartesianFilter::init(const CartesianConDesc &left, const CartesianConDesc &right, CompOp comp_op)
 {
   if (comp_op < EQUAL_TO || comp_op >= NO_OP) {
@@ -312,12 +459,14 @@ RC DefaultCartesianFilter::init(const CartesianConDesc &left, const CartesianCon
 
 
 bool DefaultCartesianFilter::filter(const Tuple &tuple) const {
-  std::shared_ptr<TupleValue> left_value = tuple.get_pointer(left_.value_index);
-  std::shared_ptr<TupleValue> right_value = tuple.get_pointer(right_.value_index);
-  if (left_value->Type() == AttrType::UNDEFINED || right_value->Type() == AttrType::UNDEFINED) {
+  return filter(*tuple.get_pointer(left_.value_index), *tuple.get_pointer(right_.value_index));
+}
+
+bool DefaultCartesianFilter::filter(const TupleValue &left_value, const TupleValue &right_value) const {
+  if (left_value.Type() == AttrType::UNDEFINED || right_value.Type() == AttrType::UNDEFINED) {
     return false;
   }
-  int cmp_result = left_value->compare(*right_value);
+  int cmp_result = left_value.compare((TupleValue &)right_value);
   return compare_result(cmp_result, comp_op_);
 }
 
@@ -350,55 +499,56 @@ RC DefaultExpressionFilter::init(const CartesianConDesc &left, const CartesianCo
     return RC::INVALID_ARGUMENT;
   }
 
-  left_ = left;
-  right_ = right;
+  for (int i = 0; i < 2; i++) {
+    const CartesianConDesc &desc = i == 0 ? left : right;
+    CompiledExpression &exp = i == 0 ? left_ : right_;
+    RC rc;
+    if (desc.exp_ast != nullptr) {
+      rc = exp.compile(desc.exp_ast, field_index);
+    } else if (desc.is_attr) {
+      exp.compile_attr(desc.value_index);
+      rc = RC::SUCCESS;
+    } else {
+      rc = exp.compile_value(desc.value);
+    }
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("Failed to compile expression condition. rc=%d:%s", rc, strrc(rc));
+      return rc;
+    }
+  }
   comp_op_ = comp_op;
-  field_index_ = &field_index;
   return RC::SUCCESS;
 }
 
-// get left_value and right_value, then compare
-// return result of the compare(left_value, right_value)
+// 与FloatValue::compare相同，相差小于1e-5看作相等
+static inline int compare_float(float left, float right) {
+  float result = left - right;
+  if (-1e-5 < result && result < 1e-5) {
+    return 0;
+  }
+  return result > 0 ? 1 : -1;
+}
+
+// 两侧求值后比较，任意一侧为null或者计算出错(例如除0)时条件不成立
 bool DefaultExpressionFilter::filter(const Tuple &tuple) const {
-  std::shared_ptr<TupleValue> left_value, right_value;
-  if (left_.exp_ast != nullptr) {
-    RC rc = AstUtil::Calculate(left_value, tuple, *field_index_, left_.exp_ast);
-    if (rc != RC::SUCCESS) {
-      return false;
-    }
-  } else if (left_.is_attr) {
-    left_value = tuple.get_pointer(left_.value_index);
-  } else {
-    if (left_.value.type == AttrType::INTS) {
-      left_value = std::shared_ptr<TupleValue>(new FloatValue(*((int *)(left_.value.data))));  
-    } else if (left_.value.type == AttrType::FLOATS) {
-      left_value = std::shared_ptr<TupleValue>(new FloatValue(*((float *)(left_.value.data))));  
-    } else {
-      assert(false);
-    }
+  float left_value, right_value;
+  if (!left_.evaluate(tuple, left_value) || !right_.evaluate(tuple, right_value)) {
+    return false;
   }
-  if (right_.exp_ast != nullptr) {
-    RC rc = AstUtil::Calculate(right_value, tuple, *field_index_, right_.exp_ast);
-    if (rc != RC::SUCCESS) {
-      return false;
-    }
-  } else if (right_.is_attr) {
-    right_value = tuple.get_pointer(right_.value_index);
-  } else {
-    if (right_.value.type == AttrType::INTS) {
-      right_value = std::shared_ptr<TupleValue>(new FloatValue(*((int *)(right_.value.data))));  
-    } else if (right_.value.type == AttrType::FLOATS) {
-      right_value = std::shared_ptr<TupleValue>(new FloatValue(*((float *)(right_.value.data))));  
-    } else {
-      assert(false);
+  return compare_result(compare_float(left_value, right_value), comp_op_);
+}
+
+void DefaultExpressionFilter::filter_batch(const std::vector<const Tuple *> &tuples, std::vector<char> &selected) const {
+  std::vector<float> left_values, right_values;
+  std::vector<char> left_valid, right_valid;
+  left_.evaluate(tuples, left_values, left_valid);
+  right_.evaluate(tuples, right_values, right_valid);
+  for (size_t i = 0; i < tuples.size(); i++) {
+    if (selected[i] && (!left_valid[i] || !right_valid[i] ||
+                        !compare_result(compare_float(left_values[i], right_values[i]), comp_op_))) {
+      selected[i] = 0;
     }
   }
-  assert(left_value->Type() == AttrType::FLOATS && right_value->Type() == AttrType::FLOATS);
-  if (left_value->Type() == AttrType::UNDEFINED || right_value->Type() == AttrType::UNDEFINED) {
-    return false;
-  }
-  int cmp_result = left_value->compare(*right_value);
-  return compare_result(cmp_result, comp_op_);
 }
 
 CompositeExpressionFilter::~CompositeExpressionFilter() {
@@ -424,6 +574,12 @@ bool CompositeExpressionFilter::filter(const Tuple &tuple) const {
   return true;
 }
 
+void CompositeExpressionFilter::filter_batch(const std::vector<const Tuple *> &tuples, std::vector<char> &selected) const {
+  for (const auto & filter : filters_) {
+    filter->filter_batch(tuples, selected);
+  }
+}
+
 
 // value to shared_ptr<value_type> value
 std::shared_ptr<TupleValue> construct_tuple_value_from_value(const Value &value) {
@@ -460,6 +616,7 @@ std::shared_ptr<TupleValue> construct_tuple_value_from_selects(Db *db, Selects *
   Executor *executor = builder->build(selects);
   executor->init();
   TupleSet tuple_set;
+  // 只需要第一行，取到第一批就不再继续执行
   executor->next(tuple_set);
   return tuple_set.get(0).get_pointer(0);
 }
@@ -591,7 +748,8 @@ bool Filter::filter(const Record &rec) const {
   switch (left_.value.type) {
     case CHARS: {  // 字符串都是定长的，直接比较
       // 按照C字符串风格来定
-      cmp_result = strcmp(left_value, right_value);
+      cmp_result = compare_string(left_value, left_.is_attr ? left_.attr_length : SIZE_MAX,
+                                  right_value, right_.is_attr ? right_.attr_length : SIZE_MAX);
     } break;
     case INTS: {
       // 没有考虑大小端问题
@@ -613,7 +771,8 @@ bool Filter::filter(const Record &rec) const {
     } break;
     case DATES: {  // 字符串日期已经被格式化了，可以直接比较
       // 按照C字符串风格来定
-      cmp_result = strcmp(left_value, right_value);
+      cmp_result = compare_string(left_value, left_.is_attr ? left_.attr_length : SIZE_MAX,
+                                  right_value, right_.is_attr ? right_.attr_length : SIZE_MAX);
     } break;
     default: {
     }
@@ -3,6 +3,8 @@
 
 #include <sql/executor/value.h>
 #include <sql/executor/tuple.h>
+#include <sql/executor/expression.h>
+#include <stdint.h>
 #include <map>
 #include <utility>
 #include "rc.h"
@@ -33,6 +35,14 @@ public:
    * @return true means match condition, false means failed to match.
    */
   virtual bool filter(const Record &rec) const = 0;
+
+  /**
+   * 对连续存放的n条记录(每条record_size字节)批量求值，把不满足条件的记录在bitmap中对应的位清0。
+   * 返回false表示没有对所有条件批量求值，调用方还要对bitmap中剩下的记录逐条调用filter
+   */
+  virtual bool filter_batch(const char *records, int record_size, int n, uint8_t *bitmap) const {
+    return false;
+  }
 };
 
 class DefaultConditionFilter : public ConditionFilter {
@@ -44,6 +54,8 @@ public:
   RC init(Table &table, const Condition &condition);
 
   virtual bool filter(const Record &rec) const;
+  // 属性与常量比较(INTS/FLOATS/DATES比较，CHARS等值)时使用SIMD kernel批量求值
+  virtual bool filter_batch(const char *records, int record_size, int n, uint8_t *bitmap) const;
 
 public:
   const ConDesc &left() const {
@@ -58,12 +70,24 @@ public:
     return comp_op_;
   }
 
+  AttrType attr_type() const {
+    return attr_type_;
+  }
+
+private:
+  void init_batch();
+
 private:
   Table *  table_;
   ConDesc  left_;
   ConDesc  right_;
   AttrType attr_type_ = UNDEFINED;
   CompOp   comp_op_ = NO_OP;
+
+  bool     batch_ = false;      // 能否批量求值
+  CompOp   batch_op_ = NO_OP;   // 属性放在左边时的比较符
+  int      batch_int_ = 0;      // INTS的常量，DATES转换为yyyymmdd
+  int      batch_chars_len_ = 0; // CHARS常量的长度，包含结尾的'\0'
 };
 
 class CompositeConditionFilter : public ConditionFilter {
@@ -74,6 +98,7 @@ public:
   RC init(const ConditionFilter *filters[], int filter_num);
   RC init(Table &table, const Condition *conditions, int condition_num);
   virtual bool filter(const Record &rec) const;
+  virtual bool filter_batch(const char *records, int record_size, int n, uint8_t *bitmap) const;
 
 public:
   int filter_num() const {
@@ -119,9 +144,15 @@ public:
   // tuples中的每个Tuple对应一个table的Tuple，CartesianConDesc.table_index是tuples的下标
   // 每个Tuple中的vector<TupleValue>表示table中的一行数据，CartesianConDesc.value_index是vector<TupleValue>的下标
   virtual bool filter(const Tuple &tuple) const override;
+  // 比较条件两侧的值，任意一侧为null时不满足
+  bool filter(const TupleValue &left_value, const TupleValue &right_value) const;
 
   RC init(const CartesianConDesc &left, const CartesianConDesc &right, CompOp comp_op);
 
+  const CartesianConDesc &left() const { return left_; }
+  const CartesianConDesc &right() const { return right_; }
+  CompOp comp_op() const { return comp_op_; }
+
 private:
   CartesianConDesc  left_;
   CartesianConDesc  right_;
@@ -136,23 +167,27 @@ public:
   RC init(std::vector<DefaultCartesianFilter *> &&filters, bool own_memory=false);
   virtual bool filter(const Tuple &tuple) const override;
 
+  const std::vector<DefaultCartesianFilter *> &filters() const { return filters_; }
+
 private:
   std::vector<DefaultCartesianFilter *> filters_;
   bool memory_owner_ = false; // filters_的内存是否由自己来控制
 };
 
 // 由于表达式的条件也涉及多表，因此继承CartesianFilter的接口
+// 两侧在init时编译成CompiledExpression，求值时不再遍历ast
 class DefaultExpressionFilter : public CartesianFilter  {
 public:
   DefaultExpressionFilter() = default;
   virtual ~DefaultExpressionFilter() = default;
   virtual bool filter(const Tuple &tuple) const override;
+  // 对一批tuple过滤，不满足条件的selected[i]置为0
+  virtual void filter_batch(const std::vector<const Tuple *> &tuples, std::vector<char> &selected) const;
   RC init(const CartesianConDesc &left, const CartesianConDesc &right, CompOp comp_op, const std::map<std::string, std::map<std::string, int>> &field_index);
 private:
-  CartesianConDesc  left_;
-  CartesianConDesc  right_;
+  CompiledExpression left_;
+  CompiledExpression right_;
   CompOp comp_op_ = NO_OP;
-  const std::map<std::string, std::map<std::string, int>> *field_index_;
 };
 
 class CompositeExpressionFilter : public DefaultExpressionFilter {
@@ -162,6 +197,7 @@ public:
 
   RC init(std::vector<DefaultExpressionFilter *> &&filters, bool own_memory=false);
   virtual bool filter(const Tuple &tuple) const override;
+  virtual void filter_batch(const std::vector<const Tuple *> &tuples, std::vector<char> &selected) const override;
 
 private:
   std::vector<DefaultExpressionFilter *> filters_;
@@ -201,6 +237,7 @@ public:
 
   FilterDesc &left() { return left_; }
   FilterDesc &right() { return right_; }
+  CompOp comp_op() const { return comp_op_; }
 private:
   FilterDesc  left_;
   FilterDesc  right_;
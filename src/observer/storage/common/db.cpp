@@ -53,6 +53,7 @@ RC Db::create_table(const char *table_name, int attribute_count, const AttrInfo
   }
 
   opened_tables_[table_name] = table;
+  schema_version_++;
   LOG_INFO("Create table success. table name=%s", table_name);
   return RC::SUCCESS;
 }
@@ -73,6 +74,7 @@ RC Db::drop_table(const char *table_name) {
   }
   
   opened_tables_.erase(table_name);
+  schema_version_++;
   LOG_INFO("Drop table success. table name=%s", table_name);
   return RC::SUCCESS;
 }
@@ -1,6 +1,7 @@
 #ifndef __OBSERVER_STORAGE_COMMON_DB_H__
 #define __OBSERVER_STORAGE_COMMON_DB_H__
 
+#include <atomic>
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -27,6 +28,11 @@ public:
 
   void all_tables(std::vector<std::string> &table_names) const;
 
+  // 建表、删表之后递增。表建好之后字段不会再变，索引的变化记在每张表的schema version中
+  uint64_t schema_version() const {
+    return schema_version_;
+  }
+
   RC sync();
 private:
   RC open_all_tables();
@@ -35,6 +41,7 @@ private:
   std::string   name_;
   std::string   path_;
   std::unordered_map<std::string, Table *>  opened_tables_;
+  std::atomic<uint64_t> schema_version_{0};
 };
 
 #endif // __OBSERVER_STORAGE_COMMON_DB_H__
\ No newline at end of file
@@ -0,0 +1,596 @@
+#include <string.h>
+
+#include "storage/common/hash_index.h"
+#include "common/log/log.h"
+
+void HashKeyOperator::init(AttrType attr_type, int attr_length) {
+  attr_type_ = attr_type;
+  attr_length_ = attr_length;
+}
+
+// 按字节精确比较，与hash一致。浮点数按误差比较相等，Table::create_index不允许在FLOATS上建hash索引
+int HashKeyOperator::compare(const void *data1, const void *data2) const {
+  switch (attr_type_) {
+    case INTS: {
+      int i1 = *(const int *)data1;
+      int i2 = *(const int *)data2;
+      return i1 < i2 ? -1 : (i1 > i2 ? 1 : 0);
+    }
+    case FLOATS: {
+      float f1 = *(const float *)data1;
+      float f2 = *(const float *)data2;
+      return f1 < f2 ? -1 : (f1 > f2 ? 1 : 0);
+    }
+    case CHARS:
+    case DATES: {
+      return strncmp((const char *)data1, (const char *)data2, attr_length_);
+    }
+    default: {
+      LOG_PANIC("Unknown attr type: %d", attr_type_);
+    }
+  }
+  return -2;
+}
+
+// FNV-1a，结果会持久化到目录中，不能使用与实现相关的std::hash
+size_t HashKeyOperator::hash(const void *data) const {
+  const unsigned char *bytes = (const unsigned char *)data;
+  size_t length = 0;
+  float normalized;
+  switch (attr_type_) {
+    case INTS: {
+      length = sizeof(int);
+    }
+    break;
+    case FLOATS: {
+      normalized = *(const float *)data;
+      if (normalized == 0) {
+        normalized = 0; // -0.0 和 0.0 相等
+      }
+      bytes = (const unsigned char *)&normalized;
+      length = sizeof(float);
+    }
+    break;
+    case CHARS:
+    case DATES: {
+      length = strnlen((const char *)data, attr_length_);
+    }
+    break;
+    default: {
+      LOG_PANIC("Unknown attr type: %d", attr_type_);
+    }
+  }
+
+  unsigned int h = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    h ^= bytes[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+RC HashIndexHandler::create(const char *file_name, AttrType attr_type, int attr_length) {
+  DiskBufferPool *disk_buffer_pool = theGlobalDiskBufferPool();
+  RC rc = disk_buffer_pool->create_file(file_name);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  int file_id;
+  rc = disk_buffer_pool->open_file(file_name, &file_id);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to open file. file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
+    return rc;
+  }
+  disk_buffer_pool_ = disk_buffer_pool;
+  file_id_ = file_id;
+
+  // 第一个页是文件头，打开时从1号页读取
+  BPPageHandle page_handle;
+  rc = disk_buffer_pool->allocate_page(file_id, &page_handle);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to allocate header page. file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
+    return rc;
+  }
+  disk_buffer_pool->unpin_page(&page_handle);
+
+  memset(&file_header_, 0, sizeof(file_header_));
+  file_header_.attr_type = attr_type;
+  file_header_.attr_length = attr_length;
+  file_header_.entry_length = attr_length + sizeof(RID);
+  file_header_.bucket_capacity = (BP_PAGE_DATA_SIZE - sizeof(HashBucketHeader)) / file_header_.entry_length;
+  file_header_.global_depth = 0;
+  file_header_.dir_page_num = 1;
+  key_operator_.init(attr_type, attr_length);
+
+  rc = disk_buffer_pool->allocate_page(file_id, &page_handle);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to allocate directory page. file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
+    return rc;
+  }
+  disk_buffer_pool->get_page_num(&page_handle, &file_header_.dir_pages[0]);
+  disk_buffer_pool->unpin_page(&page_handle);
+
+  PageNum bucket_page;
+  rc = allocate_bucket(0, &bucket_page);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  rc = set_dir_entry(0, bucket_page);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  return write_header();
+}
+
+RC HashIndexHandler::open(const char *file_name) {
+  if (disk_buffer_pool_ != nullptr) {
+    return RC::RECORD_OPENNED;
+  }
+
+  DiskBufferPool *disk_buffer_pool = theGlobalDiskBufferPool();
+  int file_id;
+  RC rc = disk_buffer_pool->open_file(file_name, &file_id);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  BPPageHandle page_handle;
+  rc = disk_buffer_pool->get_this_page(file_id, 1, &page_handle);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  char *pdata;
+  disk_buffer_pool->get_data(&page_handle, &pdata);
+  memcpy(&file_header_, pdata, sizeof(file_header_));
+  disk_buffer_pool->unpin_page(&page_handle);
+
+  disk_buffer_pool_ = disk_buffer_pool;
+  file_id_ = file_id;
+  key_operator_.init(file_header_.attr_type, file_header_.attr_length);
+  return RC::SUCCESS;
+}
+
+RC HashIndexHandler::close() {
+  if (disk_buffer_pool_ != nullptr) {
+    sync();
+    disk_buffer_pool_->close_file(file_id_);
+  }
+  file_id_ = -1;
+  disk_buffer_pool_ = nullptr;
+  return RC::SUCCESS;
+}
+
+RC HashIndexHandler::sync() {
+  std::unique_lock<std::shared_mutex> guard(latch_);
+  return disk_buffer_pool_->flush_all_pages(file_id_);
+}
+
+RC HashIndexHandler::get_page(PageNum page_num, BPPageHandle *page_handle, char **data) {
+  RC rc = disk_buffer_pool_->get_this_page(file_id_, page_num, page_handle);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to get page of hash index. page num=%d, rc=%d:%s", page_num, rc, strrc(rc));
+    return rc;
+  }
+  return disk_buffer_pool_->get_data(page_handle, data);
+}
+
+RC HashIndexHandler::write_header() {
+  BPPageHandle page_handle;
+  char *pdata;
+  RC rc = get_page(1, &page_handle, &pdata);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  memcpy(pdata, &file_header_, sizeof(file_header_));
+  disk_buffer_pool_->mark_dirty(&page_handle);
+  return disk_buffer_pool_->unpin_page(&page_handle);
+}
+
+RC HashIndexHandler::allocate_bucket(int local_depth, PageNum *page_num) {
+  BPPageHandle page_handle;
+  RC rc = disk_buffer_pool_->allocate_page(file_id_, &page_handle);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to allocate bucket page. rc=%d:%s", rc, strrc(rc));
+    return rc;
+  }
+  char *pdata;
+  disk_buffer_pool_->get_data(&page_handle, &pdata);
+  disk_buffer_pool_->get_page_num(&page_handle, page_num);
+
+  HashBucketHeader *bucket = (HashBucketHeader *)pdata;
+  bucket->local_depth = local_depth;
+  bucket->key_num = 0;
+  bucket->next_page = -1;
+  disk_buffer_pool_->mark_dirty(&page_handle);
+  return disk_buffer_pool_->unpin_page(&page_handle);
+}
+
+RC HashIndexHandler::dir_entry(int index, PageNum *bucket_page) {
+  BPPageHandle page_handle;
+  char *pdata;
+  RC rc = get_page(file_header_.dir_pages[index / HASH_INDEX_DIR_ENTRIES_PER_PAGE], &page_handle, &pdata);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  *bucket_page = ((PageNum *)pdata)[index % HASH_INDEX_DIR_ENTRIES_PER_PAGE];
+  return disk_buffer_pool_->unpin_page(&page_handle);
+}
+
+RC HashIndexHandler::set_dir_entry(int index, PageNum bucket_page) {
+  BPPageHandle page_handle;
+  char *pdata;
+  RC rc = get_page(file_header_.dir_pages[index / HASH_INDEX_DIR_ENTRIES_PER_PAGE], &page_handle, &pdata);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  ((PageNum *)pdata)[index % HASH_INDEX_DIR_ENTRIES_PER_PAGE] = bucket_page;
+  disk_buffer_pool_->mark_dirty(&page_handle);
+  return disk_buffer_pool_->unpin_page(&page_handle);
+}
+
+RC HashIndexHandler::double_directory() {
+  if (file_header_.global_depth >= HASH_INDEX_MAX_GLOBAL_DEPTH) {
+    return RC::NOMEM;
+  }
+
+  int old_size = 1 << file_header_.global_depth;
+  int new_size = old_size * 2;
+  int need_pages = (new_size + HASH_INDEX_DIR_ENTRIES_PER_PAGE - 1) / HASH_INDEX_DIR_ENTRIES_PER_PAGE;
+  RC rc = RC::SUCCESS;
+  while (file_header_.dir_page_num < need_pages) {
+    BPPageHandle page_handle;
+    rc = disk_buffer_pool_->allocate_page(file_id_, &page_handle);
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to allocate directory page. rc=%d:%s", rc, strrc(rc));
+      return rc;
+    }
+    disk_buffer_pool_->get_page_num(&page_handle, &file_header_.dir_pages[file_header_.dir_page_num++]);
+    disk_buffer_pool_->unpin_page(&page_handle);
+  }
+
+  // 新的一半目录项与旧的一半指向相同的桶
+  for (int i = 0; i < old_size; i++) {
+    PageNum bucket_page;
+    rc = dir_entry(i, &bucket_page);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    rc = set_dir_entry(i + old_size, bucket_page);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+  file_header_.global_depth++;
+  return write_header();
+}
+
+RC HashIndexHandler::append_to_chain(PageNum bucket_page, const char *entry) {
+  PageNum page_num = bucket_page;
+  while (true) {
+    BPPageHandle page_handle;
+    char *pdata;
+    RC rc = get_page(page_num, &page_handle, &pdata);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    HashBucketHeader *bucket = (HashBucketHeader *)pdata;
+    if (bucket->key_num < file_header_.bucket_capacity) {
+      memcpy(entry_at(pdata, bucket->key_num), entry, file_header_.entry_length);
+      bucket->key_num++;
+      disk_buffer_pool_->mark_dirty(&page_handle);
+      return disk_buffer_pool_->unpin_page(&page_handle);
+    }
+
+    if (bucket->next_page == -1) {
+      PageNum overflow_page;
+      rc = allocate_bucket(bucket->local_depth, &overflow_page);
+      if (rc != RC::SUCCESS) {
+        disk_buffer_pool_->unpin_page(&page_handle);
+        return rc;
+      }
+      bucket->next_page = overflow_page;
+      disk_buffer_pool_->mark_dirty(&page_handle);
+    }
+    page_num = bucket->next_page;
+    disk_buffer_pool_->unpin_page(&page_handle);
+  }
+}
+
+RC HashIndexHandler::split_bucket(int dir_index, PageNum bucket_page, int local_depth) {
+  RC rc = RC::SUCCESS;
+  if (local_depth == file_header_.global_depth) {
+    rc = double_directory();
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+
+  // 取出整条桶链上的entry，并清空这些页（溢出页留在链上复用）
+  std::vector<char> entries;
+  for (PageNum page_num = bucket_page; page_num != -1; ) {
+    BPPageHandle page_handle;
+    char *pdata;
+    rc = get_page(page_num, &page_handle, &pdata);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    HashBucketHeader *bucket = (HashBucketHeader *)pdata;
+    entries.insert(entries.end(), entry_at(pdata, 0), entry_at(pdata, bucket->key_num));
+    bucket->key_num = 0;
+    if (page_num == bucket_page) {
+      bucket->local_depth = local_depth + 1;
+    }
+    page_num = bucket->next_page;
+    disk_buffer_pool_->mark_dirty(&page_handle);
+    disk_buffer_pool_->unpin_page(&page_handle);
+  }
+
+  PageNum new_bucket_page;
+  rc = allocate_bucket(local_depth + 1, &new_bucket_page);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  // 第local_depth位为1的目录项指向新桶
+  int pattern = dir_index & ((1 << local_depth) - 1);
+  for (int i = pattern | (1 << local_depth); i < (1 << file_header_.global_depth); i += 1 << (local_depth + 1)) {
+    rc = set_dir_entry(i, new_bucket_page);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+
+  for (size_t offset = 0; offset < entries.size(); offset += file_header_.entry_length) {
+    const char *entry = entries.data() + offset;
+    PageNum target = ((hash_of(entry) >> local_depth) & 1) ? new_bucket_page : bucket_page;
+    rc = append_to_chain(target, entry);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+bool HashIndexHandler::same_entry(const char *entry, const char *key, const RID *rid) const {
+  const RID *entry_rid = (const RID *)(entry + file_header_.attr_length);
+  return entry_rid->page_num == rid->page_num && entry_rid->slot_num == rid->slot_num &&
+         key_operator_.compare(entry, key) == 0;
+}
+
+RC HashIndexHandler::insert_entry(const char *key, const RID *rid, bool unique) {
+  std::unique_lock<std::shared_mutex> guard(latch_);
+  if (disk_buffer_pool_ == nullptr) {
+    return RC::RECORD_CLOSED;
+  }
+
+  unsigned int hash = hash_of(key);
+  while (true) {
+    int dir_index = hash & ((1u << file_header_.global_depth) - 1);
+    PageNum bucket_page;
+    RC rc = dir_entry(dir_index, &bucket_page);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+
+    // 遍历桶链：检查重复(唯一索引比较key，否则比较key + RID)，找空位，并判断桶中的key是否都有相同的hash
+    int local_depth = 0;
+    PageNum free_page = -1;
+    PageNum last_page = -1;
+    bool same_hash = true;
+    for (PageNum page_num = bucket_page; page_num != -1; ) {
+      BPPageHandle page_handle;
+      char *pdata;
+      rc = get_page(page_num, &page_handle, &pdata);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      HashBucketHeader *bucket = (HashBucketHeader *)pdata;
+      if (page_num == bucket_page) {
+        local_depth = bucket->local_depth;
+      }
+      for (int i = 0; i < bucket->key_num; i++) {
+        const char *entry = entry_at(pdata, i);
+        if (unique ? key_operator_.compare(entry, key) == 0 : same_entry(entry, key, rid)) {
+          disk_buffer_pool_->unpin_page(&page_handle);
+          return RC::RECORD_DUPLICATE_KEY;
+        }
+        if (same_hash && hash_of(entry) != hash) {
+          same_hash = false;
+        }
+      }
+      if (free_page == -1 && bucket->key_num < file_header_.bucket_capacity) {
+        free_page = page_num;
+      }
+      last_page = page_num;
+      page_num = bucket->next_page;
+      disk_buffer_pool_->unpin_page(&page_handle);
+    }
+
+    bool can_split = !same_hash &&
+        (local_depth < file_header_.global_depth || file_header_.global_depth < HASH_INDEX_MAX_GLOBAL_DEPTH);
+    if (free_page != -1 || !can_split) {
+      std::vector<char> entry(file_header_.entry_length);
+      memcpy(entry.data(), key, file_header_.attr_length);
+      memcpy(entry.data() + file_header_.attr_length, rid, sizeof(RID));
+      return append_to_chain(free_page != -1 ? free_page : last_page, entry.data());
+    }
+
+    rc = split_bucket(dir_index, bucket_page, local_depth);
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to split hash bucket. page num=%d, rc=%d:%s", bucket_page, rc, strrc(rc));
+      return rc;
+    }
+  }
+}
+
+RC HashIndexHandler::delete_entry(const char *key, const RID *rid) {
+  std::unique_lock<std::shared_mutex> guard(latch_);
+  if (disk_buffer_pool_ == nullptr) {
+    return RC::RECORD_CLOSED;
+  }
+
+  int dir_index = hash_of(key) & ((1u << file_header_.global_depth) - 1);
+  PageNum bucket_page;
+  RC rc = dir_entry(dir_index, &bucket_page);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  // 桶变空后不做合并，目录也不收缩
+  for (PageNum page_num = bucket_page; page_num != -1; ) {
+    BPPageHandle page_handle;
+    char *pdata;
+    rc = get_page(page_num, &page_handle, &pdata);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    HashBucketHeader *bucket = (HashBucketHeader *)pdata;
+    for (int i = 0; i < bucket->key_num; i++) {
+      if (same_entry(entry_at(pdata, i), key, rid)) {
+        bucket->key_num--;
+        if (i != bucket->key_num) {
+          memcpy(entry_at(pdata, i), entry_at(pdata, bucket->key_num), file_header_.entry_length);
+        }
+        disk_buffer_pool_->mark_dirty(&page_handle);
+        return disk_buffer_pool_->unpin_page(&page_handle);
+      }
+    }
+    page_num = bucket->next_page;
+    disk_buffer_pool_->unpin_page(&page_handle);
+  }
+  return RC::RECORD_INVALID_KEY;
+}
+
+RC HashIndexHandler::get_entries(const char *key, std::vector<char> &entries) {
+  std::shared_lock<std::shared_mutex> guard(latch_);
+  if (disk_buffer_pool_ == nullptr) {
+    return RC::RECORD_CLOSED;
+  }
+
+  int dir_index = hash_of(key) & ((1u << file_header_.global_depth) - 1);
+  PageNum bucket_page;
+  RC rc = dir_entry(dir_index, &bucket_page);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  for (PageNum page_num = bucket_page; page_num != -1; ) {
+    BPPageHandle page_handle;
+    char *pdata;
+    rc = get_page(page_num, &page_handle, &pdata);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    HashBucketHeader *bucket = (HashBucketHeader *)pdata;
+    for (int i = 0; i < bucket->key_num; i++) {
+      const char *entry = entry_at(pdata, i);
+      if (key_operator_.compare(entry, key) == 0) {
+        entries.insert(entries.end(), entry, entry + file_header_.entry_length);
+      }
+    }
+    page_num = bucket->next_page;
+    disk_buffer_pool_->unpin_page(&page_handle);
+  }
+  return RC::SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+HashIndex::~HashIndex() noexcept {
+  close();
+}
+
+RC HashIndex::create(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta) {
+  if (inited_) {
+    return RC::RECORD_OPENNED;
+  }
+
+  RC rc = Index::init(index_meta, field_meta);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  rc = index_handler_.create(file_name, field_meta.type(), field_meta.len());
+  if (RC::SUCCESS == rc) {
+    inited_ = true;
+  }
+  return rc;
+}
+
+RC HashIndex::open(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta) {
+  if (inited_) {
+    return RC::RECORD_OPENNED;
+  }
+  RC rc = Index::init(index_meta, field_meta);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  rc = index_handler_.open(file_name);
+  if (RC::SUCCESS == rc) {
+    inited_ = true;
+  }
+  return rc;
+}
+
+RC HashIndex::close() {
+  if (inited_) {
+    index_handler_.close();
+    inited_ = false;
+  }
+  return RC::SUCCESS;
+}
+
+RC HashIndex::insert_entry(const char *record, const RID *rid) {
+  return index_handler_.insert_entry(record + field_meta_.offset(), rid, unique_ == 1);
+}
+
+RC HashIndex::delete_entry(const char *record, const RID *rid) {
+  return index_handler_.delete_entry(record + field_meta_.offset(), rid);
+}
+
+IndexScanner *HashIndex::create_scanner(CompOp comp_op, const char *value) {
+  if (comp_op != EQUAL_TO) {
+    return nullptr;
+  }
+
+  std::vector<char> entries;
+  RC rc = index_handler_.get_entries(value, entries);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to open hash index scanner. rc=%d:%s", rc, strrc(rc));
+    return nullptr;
+  }
+  return new HashIndexScanner(std::move(entries), index_handler_.entry_length(), field_meta_.len());
+}
+
+RC HashIndex::sync() {
+  return index_handler_.sync();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+HashIndexScanner::HashIndexScanner(std::vector<char> &&entries, int entry_length, int attr_length) :
+    entries_(std::move(entries)), entry_length_(entry_length), attr_length_(attr_length) {
+}
+
+RC HashIndexScanner::next_entry(RID *rid) {
+  return next_entry(rid, nullptr);
+}
+
+RC HashIndexScanner::next_entry(RID *rid, char *key) {
+  if (offset_ >= entries_.size()) {
+    return RC::RECORD_EOF;
+  }
+  const char *entry = entries_.data() + offset_;
+  memcpy(rid, entry + attr_length_, sizeof(RID));
+  if (key != nullptr) {
+    memcpy(key, entry, attr_length_);
+  }
+  offset_ += entry_length_;
+  return RC::SUCCESS;
+}
+
+RC HashIndexScanner::destroy() {
+  delete this;
+  return RC::SUCCESS;
+}
@@ -0,0 +1,137 @@
+#ifndef __OBSERVER_STORAGE_COMMON_HASH_INDEX_H_
+#define __OBSERVER_STORAGE_COMMON_HASH_INDEX_H_
+
+#include <shared_mutex>
+#include <vector>
+
+#include "storage/common/index.h"
+#include "storage/default/disk_buffer_pool.h"
+#include "sql/parser/parse_defs.h"
+
+// 可扩展哈希(extendible hashing)，目录按hash值的低global_depth位定位桶
+#define HASH_INDEX_DIR_ENTRIES_PER_PAGE ((int)(BP_PAGE_DATA_SIZE / sizeof(PageNum)))
+#define HASH_INDEX_MAX_GLOBAL_DEPTH 19
+#define HASH_INDEX_MAX_DIR_PAGES \
+  (((1 << HASH_INDEX_MAX_GLOBAL_DEPTH) + HASH_INDEX_DIR_ENTRIES_PER_PAGE - 1) / HASH_INDEX_DIR_ENTRIES_PER_PAGE)
+
+struct HashIndexFileHeader {
+  AttrType attr_type;
+  int attr_length;
+  int entry_length;       // attr_length + sizeof(RID)
+  int bucket_capacity;    // 每个桶页最多存放的entry数
+  int global_depth;
+  int dir_page_num;
+  PageNum dir_pages[HASH_INDEX_MAX_DIR_PAGES];
+};
+
+// 桶页的页头，后面紧跟bucket_capacity个 key + RID
+struct HashBucketHeader {
+  int local_depth;        // 只有桶链上的第一个页有意义
+  int key_num;
+  PageNum next_page;      // 溢出页，-1表示没有
+};
+
+class HashKeyOperator : public IndexDataOperator {
+public:
+  void init(AttrType attr_type, int attr_length);
+
+  int compare(const void *data1, const void *data2) const override;
+  size_t hash(const void *data) const override;
+
+private:
+  AttrType attr_type_ = UNDEFINED;
+  int attr_length_ = 0;
+};
+
+class HashIndexHandler {
+public:
+  /**
+   * 创建一个hash索引文件，初始时只有一个桶，global_depth为0
+   */
+  RC create(const char *file_name, AttrType attr_type, int attr_length);
+  RC open(const char *file_name);
+  RC close();
+
+  /**
+   * 插入一个索引项。桶满时优先分裂桶（必要时目录翻倍），
+   * 桶中所有key的hash都相同时分裂没有意义，改为挂溢出页。
+   * unique为true时已经有相同的key就返回RECORD_DUPLICATE_KEY，检查和插入在同一次加锁中完成
+   */
+  RC insert_entry(const char *key, const RID *rid, bool unique = false);
+  RC delete_entry(const char *key, const RID *rid);
+
+  /**
+   * 取出所有与key相等的索引项，entries中每项为 key + RID，长度为entry_length()
+   */
+  RC get_entries(const char *key, std::vector<char> &entries);
+
+  RC sync();
+
+  int entry_length() const { return file_header_.entry_length; }
+
+private:
+  RC get_page(PageNum page_num, BPPageHandle *page_handle, char **data);
+  RC write_header();
+  RC allocate_bucket(int local_depth, PageNum *page_num);
+  RC dir_entry(int index, PageNum *bucket_page);
+  RC set_dir_entry(int index, PageNum bucket_page);
+  RC double_directory();
+  RC split_bucket(int dir_index, PageNum bucket_page, int local_depth);
+  RC append_to_chain(PageNum bucket_page, const char *entry);
+
+  char *entry_at(char *bucket_data, int index) const {
+    return bucket_data + sizeof(HashBucketHeader) + index * file_header_.entry_length;
+  }
+  unsigned int hash_of(const char *key) const { return (unsigned int)key_operator_.hash(key); }
+  bool same_entry(const char *entry, const char *key, const RID *rid) const;
+
+private:
+  DiskBufferPool *disk_buffer_pool_ = nullptr;
+  int file_id_ = -1;
+  HashIndexFileHeader file_header_;
+  HashKeyOperator key_operator_;
+  std::shared_mutex latch_;
+};
+
+class HashIndex : public Index {
+public:
+  HashIndex(int unique = 0) : unique_(unique) {}
+  virtual ~HashIndex() noexcept;
+
+  RC create(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta);
+  RC open(const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta);
+  RC close() override;
+
+  RC insert_entry(const char *record, const RID *rid) override;
+  RC delete_entry(const char *record, const RID *rid) override;
+
+  /**
+   * 只支持等值查询，其它比较符返回nullptr，由调用方换用别的索引或全表扫描
+   */
+  IndexScanner *create_scanner(CompOp comp_op, const char *value) override;
+
+  RC sync() override;
+
+private:
+  bool inited_ = false;
+  HashIndexHandler index_handler_;
+  int unique_; // unique index
+};
+
+class HashIndexScanner : public IndexScanner {
+public:
+  HashIndexScanner(std::vector<char> &&entries, int entry_length, int attr_length);
+  ~HashIndexScanner() noexcept override = default;
+
+  RC next_entry(RID *rid) override;
+  RC next_entry(RID *rid, char *key) override;
+  RC destroy() override;
+
+private:
+  std::vector<char> entries_;
+  int entry_length_;
+  int attr_length_;
+  size_t offset_ = 0;
+};
+
+#endif //__OBSERVER_STORAGE_COMMON_HASH_INDEX_H_
@@ -4,4 +4,21 @@ RC Index::init(const IndexMeta &index_meta, const FieldMeta &field_meta) {
   index_meta_ = index_meta;
   field_meta_ = field_meta;
   return RC::SUCCESS;
-}
\ No newline at end of file
+}
+
+RC RidListIndexScanner::next_entry(RID *rid) {
+  if (position_ >= rids_.size()) {
+    return RC::RECORD_EOF;
+  }
+  *rid = rids_[position_++];
+  return RC::SUCCESS;
+}
+
+RC RidListIndexScanner::next_entry(RID *rid, char *key) {
+  return RC::MISUSE;
+}
+
+RC RidListIndexScanner::destroy() {
+  delete this;
+  return RC::SUCCESS;
+}
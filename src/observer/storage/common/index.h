@@ -34,6 +34,7 @@ public:
   virtual IndexScanner *create_scanner(CompOp comp_op, const char *value) = 0;
 
   virtual RC sync() = 0;
+  virtual RC close() = 0;
 
 protected:
   RC init(const IndexMeta &index_meta, const FieldMeta &field_meta);
@@ -49,7 +50,29 @@ public:
   virtual ~IndexScanner() = default;
 
   virtual RC next_entry(RID *rid) = 0;
+  /**
+   * 同时返回索引项中的key，只向key拷贝字段长度(attr_length)个字节，不包括key中附带的RID。
+   * 用于只读索引的覆盖扫描，key可以直接指向记录中这个字段的位置
+   */
+  virtual RC next_entry(RID *rid, char *key) = 0;
   virtual RC destroy() = 0;
 };
 
+/**
+ * 按给定的RID列表返回索引项，用于多个索引的RID求交集之后回表。
+ * RID已经按页号排序，回表时每个页面只读一次。只有RID，不能用于覆盖扫描
+ */
+class RidListIndexScanner : public IndexScanner {
+public:
+  explicit RidListIndexScanner(std::vector<RID> &&rids) : rids_(std::move(rids)) {}
+
+  RC next_entry(RID *rid) override;
+  RC next_entry(RID *rid, char *key) override;
+  RC destroy() override;
+
+private:
+  std::vector<RID> rids_;
+  size_t position_ = 0;
+};
+
 #endif  // __OBSERVER_STORAGE_COMMON_INDEX_H_
\ No newline at end of file
@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include "storage/common/index_meta.h"
 #include "storage/common/field_meta.h"
 #include "storage/common/table_meta.h"
@@ -9,13 +11,17 @@
 const static Json::StaticString INDEX_NAME("index_name");
 const static Json::StaticString INDEX_FIELD_NAMES("index_field_names");
 const static Json::StaticString FIELD_NAME("field_name");
+const static Json::StaticString INDEX_TYPE("index_type");
+const static char *INDEX_TYPE_HASH = "hash";
+const static char *INDEX_TYPE_BPLUS_TREE = "bplus_tree";
 
-RC IndexMeta::init(const char *name, std::vector<const FieldMeta *> fields) {
+RC IndexMeta::init(const char *name, std::vector<const FieldMeta *> fields, IndexType type) {
   if (nullptr == name || common::is_blank(name)) {
     return RC::INVALID_ARGUMENT;
   }
 
   name_ = name;
+  type_ = type;
   field_.clear();
   for (const FieldMeta *field : fields) {
     field_.push_back(field->name());
@@ -32,6 +38,7 @@ void IndexMeta::to_json(Json::Value &json_value) const {
     fields_value.append(std::move(field_value));
   }
   json_value[INDEX_FIELD_NAMES] = std::move(fields_value);
+  json_value[INDEX_TYPE] = (type_ == HASH_INDEX) ? INDEX_TYPE_HASH : INDEX_TYPE_BPLUS_TREE;
 }
 
 RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, IndexMeta &index) {
@@ -61,13 +68,23 @@ RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, I
     }
     fields[i] = field;
   }
-  return index.init(name_value.asCString(), fields);
+  // 老版本的元数据中没有index_type，都是B+树
+  IndexType type = BPLUS_TREE_INDEX;
+  const Json::Value &type_value = json_value[INDEX_TYPE];
+  if (type_value.isString() && 0 == strcmp(type_value.asCString(), INDEX_TYPE_HASH)) {
+    type = HASH_INDEX;
+  }
+  return index.init(name_value.asCString(), fields, type);
 }
 
 const char *IndexMeta::name() const {
   return name_.c_str();
 }
 
+IndexType IndexMeta::type() const {
+  return type_;
+}
+
 const char *IndexMeta::field() const {
   return field_[0].c_str();
 }
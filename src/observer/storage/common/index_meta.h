@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include "rc.h"
+#include "sql/parser/parse_defs.h"
 
 class TableMeta;
 class FieldMeta;
@@ -16,10 +17,11 @@ class IndexMeta {
 public:
   IndexMeta() = default;
 
-  RC init(const char *name, std::vector<const FieldMeta *> fields);
+  RC init(const char *name, std::vector<const FieldMeta *> fields, IndexType type = BPLUS_TREE_INDEX);
 
 public:
   const char *name() const;
+  IndexType type() const;
   const char *field() const;
   const std::vector<std::string> &fields() const;
 
@@ -31,5 +33,6 @@ public:
 private:
   std::string              name_;
   std::vector<std::string> field_;
+  IndexType                type_ = BPLUS_TREE_INDEX;
 };
 #endif // __OBSERVER_STORAGE_COMMON_INDEX_META_H__
\ No newline at end of file
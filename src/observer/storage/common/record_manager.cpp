@@ -303,6 +303,18 @@ bool RecordPageHandler::is_full() const {
   return page_header_->record_num >= page_header_->record_capacity;
 }
 
+const char *RecordPageHandler::first_record() const {
+  return page_handle_.frame->page.data + page_header_->first_record_offset;
+}
+
+int RecordPageHandler::record_size() const {
+  return page_header_->record_size;
+}
+
+int RecordPageHandler::record_capacity() const {
+  return page_header_->record_capacity;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 RecordFileHandler::RecordFileHandler() :
@@ -447,6 +459,29 @@ RC RecordFileHandler::get_record(const RID *rid, Record *rec) {
   return page_handler.get_record(rid, rec);
 }
 
+RC RecordFileHandler::get_records(const RID *rids, int count, void *context,
+                                  void (*record_reader)(int index, const char *data, void *context)) {
+  RC ret = RC::SUCCESS;
+  RecordPageHandler page_handler;
+  PageNum current_page = -1;
+  Record record;
+  for (int i = 0; i < count; i++) {
+    if (rids[i].page_num != current_page) {
+      page_handler.deinit();
+      if ((ret = page_handler.init(*disk_buffer_pool_, file_id_, rids[i].page_num)) != RC::SUCCESS) {
+        LOG_ERROR("Failed to init record page handler.page number=%d, file_id:%d", rids[i].page_num, file_id_);
+        return ret;
+      }
+      current_page = rids[i].page_num;
+    }
+    if ((ret = page_handler.get_record(&rids[i], &record)) != RC::SUCCESS) {
+      return ret;
+    }
+    record_reader(i, record.data, context);
+  }
+  return RC::SUCCESS;
+}
+
 RC RecordFileHandler::insert_text_data(const char *data, PageNum *page_num) {
   RC ret = RC::SUCCESS;
   // 分配一个新的空页面
@@ -532,13 +567,25 @@ RC RecordFileScanner::open_scan(DiskBufferPool & buffer_pool, int file_id, Condi
   file_id_ = file_id;
 
   condition_filter_ = condition_filter;
+  begin_page_ = 1;
+  end_page_ = -1;
   return RC::SUCCESS;
 }
 
+RC RecordFileScanner::open_scan(DiskBufferPool & buffer_pool, int file_id, ConditionFilter *condition_filter,
+                                PageNum begin_page, PageNum end_page)
+{
+  RC rc = open_scan(buffer_pool, file_id, condition_filter);
+  begin_page_ = begin_page;
+  end_page_ = end_page;
+  return rc;
+}
+
 RC RecordFileScanner::close_scan() {
   if (disk_buffer_pool_ != nullptr) {
     disk_buffer_pool_ = nullptr;
   }
+  batch_page_num_ = -1;
 
   if (condition_filter_ != nullptr) {
     condition_filter_ = nullptr;
@@ -547,8 +594,22 @@ RC RecordFileScanner::close_scan() {
   return RC::SUCCESS;
 }
 
+void RecordFileScanner::filter_page() {
+  batch_page_num_ = record_page_handler_.get_page_num();
+  int capacity = record_page_handler_.record_capacity();
+  int bytes = (capacity + 7) / 8;
+  const uint8_t *slot_bitmap = (const uint8_t *)record_page_handler_.slot_bitmap();
+  batch_valid_.assign(slot_bitmap, slot_bitmap + bytes);
+  if (capacity % 8 != 0) {
+    batch_valid_.back() &= (uint8_t)((1 << (capacity % 8)) - 1);
+  }
+  batch_selected_ = batch_valid_;
+  batch_all_ = condition_filter_->filter_batch(record_page_handler_.first_record(),
+      record_page_handler_.record_size(), capacity, batch_selected_.data());
+}
+
 RC RecordFileScanner::get_first_record(Record *rec) {
-  rec->rid.page_num = 1; // from 1 参考DiskBufferPool
+  rec->rid.page_num = begin_page_; // from 1 参考DiskBufferPool
   rec->rid.slot_num = -1;
   // rec->valid = false;
   return get_next_record(rec);
@@ -572,6 +633,9 @@ RC RecordFileScanner::get_next_record(Record *rec) {
   if (1 == page_count) {
     return RC::RECORD_EOF;
   }
+  if (end_page_ >= 0 && end_page_ < page_count) {
+    page_count = end_page_;
+  }
 
   while (current_record.rid.page_num < page_count) {
 
@@ -590,9 +654,26 @@ RC RecordFileScanner::get_next_record(Record *rec) {
       }
     }
     
+    if (condition_filter_ != nullptr && batch_page_num_ != current_record.rid.page_num) {
+      filter_page();
+    }
+
     ret = record_page_handler_.get_next_record(&current_record);
     if (RC::SUCCESS == ret) {
-      if (condition_filter_ == nullptr || condition_filter_->filter(current_record)) {
+      if (condition_filter_ == nullptr) {
+        break; // got one
+      }
+      // 批量过滤之后才插入的记录不在batch_valid_中，需要逐条过滤
+      int slot = current_record.rid.slot_num;
+      if (slot < (int)batch_valid_.size() * 8 && ((batch_valid_[slot / 8] >> (slot % 8)) & 1)) {
+        if (((batch_selected_[slot / 8] >> (slot % 8)) & 1) == 0) {
+          continue;
+        }
+        if (batch_all_) {
+          break;
+        }
+      }
+      if (condition_filter_->filter(current_record)) {
         break; // got one
       }
     } else if (RC::RECORD_EOF == ret) {
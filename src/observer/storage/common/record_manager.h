@@ -1,12 +1,17 @@
 #ifndef __OBSERVER_STORAGE_COMMON_RECORD_MANAGER_H_
 #define __OBSERVER_STORAGE_COMMON_RECORD_MANAGER_H_
 
+#include <stdint.h>
+#include <vector>
+
 #include "storage/default/disk_buffer_pool.h"
 
 typedef int SlotNum;
 struct PageHeader;
 class ConditionFilter;
 int align8(int size);
+// 一个页面最多可以存放的记录数，record_size为对齐之后的大小
+int page_record_capacity(int page_size, int record_size);
 
 struct RID 
 {
@@ -17,6 +22,10 @@ struct RID
   bool operator== (const RID &other) const {
     return page_num == other.page_num && slot_num == other.slot_num;
   }
+  // 按页号排序，同一页中按槽号
+  bool operator< (const RID &other) const {
+    return page_num != other.page_num ? page_num < other.page_num : slot_num < other.slot_num;
+  }
 };
 
 class RidDigest {
@@ -69,6 +78,16 @@ public:
 
   bool is_full() const;
 
+  /**
+   * 批量过滤时使用：页内的记录连续存放，slot_bitmap中为1的slot上有记录
+   */
+  const char *first_record() const;
+  int record_size() const;
+  int record_capacity() const;
+  const char *slot_bitmap() const {
+    return bitmap_;
+  }
+
 private:
   DiskBufferPool * disk_buffer_pool_;
   int              file_id_;
@@ -107,6 +126,13 @@ public:
    */
   RC get_record(const RID *rid, Record *rec);
 
+  /**
+   * 批量读取记录，rids需要按页号排序，同一页上的记录只读取一次页面。
+   * 页面被pin住时把第i条记录交给record_reader(i, data, context)
+   */
+  RC get_records(const RID *rids, int count, void *context,
+                 void (*record_reader)(int index, const char *data, void *context));
+
   template<class RecordUpdater> 
   RC update_record_in_place(const RID *rid, RecordUpdater updater) {
 
@@ -154,6 +180,12 @@ public:
    * 如果条件不为空，则要对每条记录进行条件比较，只有满足所有条件的记录才被返回
    */
   RC open_scan(DiskBufferPool & buffer_pool, int file_id, ConditionFilter *condition_filter);
+  /**
+   * 只扫描[begin_page, end_page)中的记录，end_page为-1时一直扫描到文件末尾。
+   * 并行扫描时每个线程用一个scanner扫描自己领取的页面范围
+   */
+  RC open_scan(DiskBufferPool & buffer_pool, int file_id, ConditionFilter *condition_filter,
+               PageNum begin_page, PageNum end_page);
 
   /**
    * 关闭一个文件扫描，释放相应的资源
@@ -172,12 +204,24 @@ public:
    */
   RC get_next_record(Record *rec);
 
+private:
+  // 对当前页上的所有记录批量求值
+  void filter_page();
+
 private:
   DiskBufferPool  *   disk_buffer_pool_;
   int                 file_id_;                    // 参考DiskBufferPool中的fileId
 
   ConditionFilter *   condition_filter_;
   RecordPageHandler   record_page_handler_;
+  PageNum             begin_page_ = 1;
+  PageNum             end_page_ = -1;
+
+  // 当前页上批量过滤的结果
+  PageNum              batch_page_num_ = -1;
+  std::vector<uint8_t> batch_valid_;     // 批量过滤时有记录的slot
+  std::vector<uint8_t> batch_selected_;  // 满足条件的slot
+  bool                 batch_all_ = false; // 所有条件都已经批量求值，不需要再逐条过滤
 };
 
 
@@ -1,6 +1,7 @@
 #include <limits.h>
 #include <string.h>
 #include <algorithm>
+#include <iterator>
 
 #include "storage/common/table.h"
 #include "storage/common/table_meta.h"
@@ -12,8 +13,10 @@
 #include "storage/common/meta_util.h"
 #include "storage/common/index.h"
 #include "storage/common/bplus_tree_index.h"
+#include "storage/common/hash_index.h"
 #include "storage/trx/trx.h"
 #include "common/lang/bitmap.h"
+#include "util/worker_pool.h"
 
 Table::Table() : 
     data_buffer_pool_(nullptr),
@@ -124,8 +127,7 @@ RC Table::drop(const char *path, const char *name, const char *base_dir) {
   // 2. drop index data file
   for (int i = 0; i < indexes_.size(); i++) {
     std::string index_file = index_data_file(base_dir_.c_str(), name, indexes_[i]->index_meta().name());
-    // 也许 dynamic_cast 更好
-    rc = reinterpret_cast<BplusTreeIndex *>(indexes_[i])->close();
+    rc = indexes_[i]->close();
     if (rc != RC::SUCCESS) {
       LOG_ERROR("Failed to close disk buffer pool of index file. file name=%s", index_file.c_str());
       return rc;
@@ -175,9 +177,25 @@ RC Table::open(const char *meta_file, const char *base_dir) {
       return RC::GENERIC_ERROR;
     }
 
-    BplusTreeIndex *index = new BplusTreeIndex();
     std::string index_file = index_data_file(base_dir, name(), index_meta->name());
-    rc = index->open(index_file.c_str(), *index_meta, *field_meta);
+    Index *index = nullptr;
+    if (index_meta->type() == HASH_INDEX) {
+      HashIndex *hash_index = new HashIndex();
+      rc = hash_index->open(index_file.c_str(), *index_meta, *field_meta);
+      index = hash_index;
+    } else {
+      BplusTreeIndex *bplus_tree_index = new BplusTreeIndex();
+      rc = bplus_tree_index->open(index_file.c_str(), *index_meta, *field_meta);
+      index = bplus_tree_index;
+      if (rc == RC::FORMAT) {
+        // 旧版本的索引文件，按当前的格式从数据重建
+        LOG_WARN("Rebuild index of an old format. table=%s, index=%s, file=%s",
+                 name(), index_meta->name(), index_file.c_str());
+        delete index;
+        index = nullptr;
+        rc = rebuild_index(index_file.c_str(), *index_meta, *field_meta, index);
+      }
+    }
     if (rc != RC::SUCCESS) {
       delete index;
       LOG_ERROR("Failed to open index. table=%s, index=%s, file=%s, rc=%d:%s",
@@ -190,13 +208,10 @@ RC Table::open(const char *meta_file, const char *base_dir) {
 }
 
 RC Table::commit_insert(Trx *trx, const RID &rid) {
-  Record record;
-  RC rc = record_handler_->get_record(&rid, &record);
-  if (rc != RC::SUCCESS) {
-    return rc;
-  }
-
-  return trx->commit_insert(this, record);
+  // 修改事务号之后页面要标记为脏页，否则页面被换出时修改会丢失，记录一直不可见
+  return record_handler_->update_record_in_place(&rid, [this, trx](Record &record) {
+    return trx->commit_insert(this, record);
+  });
 }
 
 RC Table::rollback_insert(Trx *trx, const RID &rid) {
@@ -272,6 +287,9 @@ RC Table::insert_record(Trx *trx, Record *record) {
       return rc;
     }
   }
+  if (trx == nullptr) {
+    increase_data_version();
+  }
   return rc;
 }
 
@@ -357,6 +375,10 @@ RC Table::make_record(int value_num, const Value *values, char * &record_out) {
     const Value &value = values[i];
     if (value.isnull) {
       null_bitmap.set_bit(i + normal_field_start_index);
+    } else if (field->type() == CHARS) {
+      // 字符串的值可能比字段短，只复制到'\0'为止，剩下的部分补0，不读取值之后的内存
+      null_bitmap.clear_bit(i + normal_field_start_index);
+      strncpy(record + field->offset(), (const char *)value.data, field->len());
     } else {
       null_bitmap.clear_bit(i + normal_field_start_index);
       memcpy(record + field->offset(), value.data, field->len());
@@ -468,6 +490,103 @@ RC Table::scan_record(Trx *trx, ConditionFilter *filter, int limit, void *contex
   return rc;
 }
 
+int Table::scan_morsel_count(const ConditionFilter *filter) {
+  // 只需要知道能否走索引，不用创建scanner(求交集时会读出全部RID)
+  std::vector<IndexCandidate> chosen;
+  choose_scan_indexes(filter, nullptr, chosen);
+  if (!chosen.empty()) {
+    return 1;
+  }
+  int page_count = 0;
+  if (data_buffer_pool_->get_page_count(file_id_, &page_count) != RC::SUCCESS || page_count <= 1) {
+    return 1;
+  }
+  // 第0页是文件头
+  return (page_count - 1 + SCAN_MORSEL_PAGES - 1) / SCAN_MORSEL_PAGES;
+}
+
+int Table::estimate_record_count() {
+  int page_count = 0;
+  if (data_buffer_pool_->get_page_count(file_id_, &page_count) != RC::SUCCESS || page_count <= 1) {
+    return 0;
+  }
+  // 收集过统计信息时按当时每页的记录数折算，表在ANALYZE之后增长了也能估计
+  const TableStats &stats = table_meta_.stats();
+  if (stats.analyzed && stats.page_count > 0) {
+    return (int)std::min<double>(INT_MAX, (double)stats.row_count / stats.page_count * (page_count - 1));
+  }
+  // 第0页是文件头，其余的页面按装满估计
+  return (page_count - 1) * page_record_capacity(BP_PAGE_DATA_SIZE, align8(table_meta_.record_size()));
+}
+
+RC Table::scan_morsel(Trx *trx, ConditionFilter *filter, int morsel, int morsel_count, void *context,
+                      RC (*record_reader)(Record *record, void *context)) {
+  PageNum begin_page = 1 + morsel * SCAN_MORSEL_PAGES;
+  // 最后一个morsel扫描到文件末尾，包括scan_morsel_count之后新分配的页面
+  PageNum end_page = morsel == morsel_count - 1 ? -1 : begin_page + SCAN_MORSEL_PAGES;
+  RecordFileScanner scanner;
+  RC rc = scanner.open_scan(*data_buffer_pool_, file_id_, filter, begin_page, end_page);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("failed to open scanner. file id=%d. rc=%d:%s", file_id_, rc, strrc(rc));
+    return rc;
+  }
+
+  Record record;
+  rc = scanner.get_first_record(&record);
+  for ( ; RC::SUCCESS == rc; rc = scanner.get_next_record(&record)) {
+    if (trx == nullptr || trx->is_visible(this, &record)) {
+      rc = record_reader(&record, context);
+      if (rc != RC::SUCCESS) {
+        break;
+      }
+    }
+  }
+  scanner.close_scan();
+  if (RC::RECORD_EOF == rc) {
+    return RC::SUCCESS;
+  }
+  LOG_ERROR("failed to scan morsel %d. file id=%d, rc=%d:%s", morsel, file_id_, rc, strrc(rc));
+  return rc;
+}
+
+/**
+ * 并行扫描时带上线程编号和morsel编号
+ */
+struct MorselReaderContext {
+  int worker;
+  int morsel;
+  void *context;
+  RC (*record_reader)(int worker, int morsel, const char *data, void *context);
+};
+static RC morsel_reader_adapter(Record *record, void *context) {
+  MorselReaderContext *reader = (MorselReaderContext *)context;
+  return reader->record_reader(reader->worker, reader->morsel, record->data, reader->context);
+}
+
+RC Table::scan_record_parallel(Trx *trx, ConditionFilter *filter, int dop, int morsel_count, void *context,
+                               RC (*record_reader)(int worker, int morsel, const char *data, void *context),
+                               void (*morsel_done)(int worker, int morsel, void *context)) {
+  if (dop <= 1 || morsel_count <= 1) {
+    MorselReaderContext reader{0, 0, context, record_reader};
+    RC rc = scan_record(trx, filter, -1, &reader, morsel_reader_adapter);
+    if (rc == RC::RECORD_EOF) {
+      rc = RC::SUCCESS;
+    }
+    if (rc == RC::SUCCESS && morsel_done != nullptr) {
+      morsel_done(0, 0, context);
+    }
+    return rc;
+  }
+  return WorkerPool::instance().run(dop, morsel_count, [&](int worker, int morsel) {
+    MorselReaderContext reader{worker, morsel, context, record_reader};
+    RC rc = scan_morsel(trx, filter, morsel, morsel_count, &reader, morsel_reader_adapter);
+    if (rc == RC::SUCCESS && morsel_done != nullptr) {
+      morsel_done(worker, morsel, context);
+    }
+    return rc;
+  });
+}
+
 RC Table::scan_record_by_index(Trx *trx, IndexScanner *scanner, ConditionFilter *filter, int limit, void *context,
                                RC (*record_reader)(Record *, void *)) {
   RC rc = RC::SUCCESS;
@@ -509,6 +628,160 @@ RC Table::scan_record_by_index(Trx *trx, IndexScanner *scanner, ConditionFilter
   return rc;
 }
 
+TableScanner::~TableScanner() {
+  close();
+}
+
+RC TableScanner::open(Table *table, Trx *trx, ConditionFilter *filter) {
+  close();
+  table_ = table;
+  trx_ = trx;
+  filter_ = filter;
+  index_scanner_ = table->find_index_for_scan(filter);
+  if (index_scanner_ != nullptr) {
+    return RC::SUCCESS;
+  }
+
+  record_scanner_ = new RecordFileScanner();
+  RC rc = record_scanner_->open_scan(*table->data_buffer_pool_, table->file_id_, filter);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("failed to open scanner. file id=%d. rc=%d:%s", table->file_id_, rc, strrc(rc));
+    delete record_scanner_;
+    record_scanner_ = nullptr;
+    return rc;
+  }
+  current_ = new Record();
+  current_->rid.page_num = 1; // 与RecordFileScanner::get_first_record相同，从第1页开始
+  current_->rid.slot_num = -1;
+  return RC::SUCCESS;
+}
+
+RC TableScanner::next(Record *record) {
+  RC rc = RC::SUCCESS;
+  if (index_scanner_ != nullptr) {
+    RID rid;
+    while (true) {
+      rc = index_scanner_->next_entry(&rid);
+      if (rc == RC::RECORD_NO_MORE_IDX_IN_MEM) {
+        continue;
+      }
+      if (rc != RC::SUCCESS) {
+        if (rc != RC::RECORD_EOF) {
+          LOG_ERROR("Failed to scan table by index. rc=%d:%s", rc, strrc(rc));
+        }
+        return rc;
+      }
+      rc = table_->record_handler_->get_record(&rid, record);
+      if (rc != RC::SUCCESS) {
+        LOG_ERROR("Failed to fetch record of rid=%d:%d, rc=%d:%s", rid.page_num, rid.slot_num, rc, strrc(rc));
+        return rc;
+      }
+      if ((trx_ == nullptr || trx_->is_visible(table_, record)) && (filter_ == nullptr || filter_->filter(*record))) {
+        return RC::SUCCESS;
+      }
+    }
+  }
+
+  if (record_scanner_ == nullptr) {
+    return RC::RECORD_CLOSED;
+  }
+  while (true) {
+    rc = record_scanner_->get_next_record(current_);
+    if (rc != RC::SUCCESS) {
+      if (rc != RC::RECORD_EOF) {
+        LOG_ERROR("failed to scan record. file id=%d, rc=%d:%s", table_->file_id_, rc, strrc(rc));
+      }
+      return rc;
+    }
+    if (trx_ == nullptr || trx_->is_visible(table_, current_)) {
+      *record = *current_;
+      return RC::SUCCESS;
+    }
+  }
+}
+
+RC TableScanner::close() {
+  if (index_scanner_ != nullptr) {
+    index_scanner_->destroy();
+    index_scanner_ = nullptr;
+  }
+  if (record_scanner_ != nullptr) {
+    record_scanner_->close_scan();
+    delete record_scanner_;
+    record_scanner_ = nullptr;
+  }
+  delete current_;
+  current_ = nullptr;
+  return RC::SUCCESS;
+}
+
+RC Table::scan_record_index_only(Trx *trx, ConditionFilter *filter, const char *field_name, int limit, void *context,
+                                 void (*record_reader)(const char *data, void *context)) {
+  if (nullptr == record_reader || nullptr == field_name) {
+    return RC::INVALID_ARGUMENT;
+  }
+  // 有未提交的插入或删除时，索引中的key不一定对当前事务可见，直接走普通的扫描
+  if (pending_operations_ > 0) {
+    return RC::SCHEMA_INDEX_NOT_EXIST;
+  }
+  const FieldMeta *field_meta = table_meta_.field(field_name);
+  if (nullptr == field_meta || field_meta->type() == TEXTS) {
+    return RC::SCHEMA_INDEX_NOT_EXIST;
+  }
+  IndexScanner *scanner = find_index_for_scan(filter, field_name);
+  if (nullptr == scanner) {
+    return RC::SCHEMA_INDEX_NOT_EXIST;
+  }
+  if (limit < 0) {
+    limit = INT_MAX;
+  }
+
+  // 构造一条只有索引字段有值的记录，其它字段都是null，这样上层的converter和filter都不需要改动
+  std::vector<char> data(table_meta_.record_size(), 0);
+  common::Bitmap null_bitmap(data.data(), align8(table_meta_.field_num()));
+  for (int i = 0; i < table_meta_.field_num(); i++) {
+    null_bitmap.set_bit(i);
+  }
+  null_bitmap.clear_bit(table_meta_.field_index(field_name));
+
+  Record record;
+  record.data = data.data();
+  char *key = data.data() + field_meta->offset();
+  RC rc = RC::SUCCESS;
+  int record_count = 0;
+  while (record_count < limit) {
+    rc = scanner->next_entry(&record.rid, key);
+    if (rc == RC::RECORD_NO_MORE_IDX_IN_MEM) {
+      continue;
+    }
+    if (rc != RC::SUCCESS) {
+      if (RC::RECORD_EOF == rc) {
+        rc = RC::SUCCESS;
+        break;
+      }
+      LOG_ERROR("Failed to scan index only. table=%s, rc=%d:%s", name(), rc, strrc(rc));
+      break;
+    }
+
+    // 扫描过程中其它事务可能开始修改这张表(计数在写索引之前增加)，之后的每个key都回表判断可见性
+    if (trx != nullptr && pending_operations_ > 0) {
+      Record visible_record;
+      if (record_handler_->get_record(&record.rid, &visible_record) != RC::SUCCESS ||
+          !trx->is_visible(this, &visible_record)) {
+        continue;
+      }
+    }
+
+    if (filter == nullptr || filter->filter(record)) {
+      record_reader(record.data, context);
+      record_count++;
+    }
+  }
+
+  scanner->destroy();
+  return rc;
+}
+
 class IndexInserter {
 public:
   explicit IndexInserter(Table *table, Index *index) : table_(table), index_(index) {
@@ -533,7 +806,26 @@ static RC insert_index_record_reader_adapter(Record *record, void *context) {
   return inserter.insert_index(record);
 }
 
-RC Table::create_index(Trx *trx, const char *index_name, const int attribute_num, char * const attribute_names[], int unique) {
+// 删除旧的索引文件，用表中的数据重新创建
+RC Table::rebuild_index(const char *index_file, const IndexMeta &index_meta, const FieldMeta &field_meta,
+                        Index *&index) {
+  RC rc = theGlobalDiskBufferPool()->drop_file(index_file);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to drop index file. file name=%s, rc=%d:%s", index_file, rc, strrc(rc));
+    return rc;
+  }
+  BplusTreeIndex *bplus_tree_index = new BplusTreeIndex();
+  index = bplus_tree_index;
+  rc = bplus_tree_index->create(index_file, index_meta, field_meta);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  IndexInserter index_inserter(this, index);
+  return scan_record(nullptr, nullptr, -1, &index_inserter, insert_index_record_reader_adapter);
+}
+
+RC Table::create_index(Trx *trx, const char *index_name, const int attribute_num, char * const attribute_names[], int unique,
+                       IndexType index_type, bool key_compress) {
   if (index_name == nullptr || common::is_blank(index_name)) {
     return RC::INVALID_ARGUMENT;
   }
@@ -542,7 +834,7 @@ RC Table::create_index(Trx *trx, const char *index_name, const int attribute_num
       return RC::INVALID_ARGUMENT;
     }
   }
-  if (table_meta_.index(index_name) != nullptr || table_meta_.find_index_by_fields(attribute_num, attribute_names)) {
+  if (table_meta_.index(index_name) != nullptr || table_meta_.find_index_by_fields(attribute_num, attribute_names, index_type)) {
     return RC::SCHEMA_INDEX_EXIST;
   }
 
@@ -555,19 +847,32 @@ RC Table::create_index(Trx *trx, const char *index_name, const int attribute_num
     fields_metas.push_back(field_meta);
   } 
 
+  // hash索引只支持定长且按字节判断相等的类型。浮点数比较时相差小于1e-5就相等，不能按值的hash查找
+  if (index_type == HASH_INDEX && (fields_metas[0]->type() == TEXTS || fields_metas[0]->type() == FLOATS)) {
+    return RC::SCHEMA_FIELD_TYPE_MISMATCH;
+  }
+
   IndexMeta new_index_meta;
-  RC rc = new_index_meta.init(index_name, fields_metas);
+  RC rc = new_index_meta.init(index_name, fields_metas, index_type);
   if (rc != RC::SUCCESS) {
     return rc;
   }
 
   // 创建索引相关数据
-  BplusTreeIndex *index = new BplusTreeIndex(unique);
   std::string index_file = index_data_file(base_dir_.c_str(), name(), index_name);
-  rc = index->create(index_file.c_str(), new_index_meta, *(fields_metas[0])); // fake
+  Index *index = nullptr;
+  if (index_type == HASH_INDEX) {
+    HashIndex *hash_index = new HashIndex(unique);
+    rc = hash_index->create(index_file.c_str(), new_index_meta, *(fields_metas[0])); // fake
+    index = hash_index;
+  } else {
+    BplusTreeIndex *bplus_tree_index = new BplusTreeIndex(unique, key_compress);
+    rc = bplus_tree_index->create(index_file.c_str(), new_index_meta, *(fields_metas[0])); // fake
+    index = bplus_tree_index;
+  }
   if (rc != RC::SUCCESS) {
     delete index;
-    LOG_ERROR("Failed to create bplus tree index. file name=%s, rc=%d:%s", index_file.c_str(), rc, strrc(rc));
+    LOG_ERROR("Failed to create index. file name=%s, rc=%d:%s", index_file.c_str(), rc, strrc(rc));
     return rc;
   }
 
@@ -594,13 +899,27 @@ RC Table::create_index(Trx *trx, const char *index_name, const int attribute_num
     LOG_ERROR("Failed to add index (%s) on table (%s). error=%d:%s", index_name, name(), rc, strrc(rc));
     return rc;
   }
+  rc = write_meta(new_table_meta);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to write table meta while creating index (%s) on table (%s)", index_name, name());
+    return rc; // 创建索引中途出错，要做还原操作
+  }
+
+  schema_version_++;
+  LOG_INFO("add a new index (%s) on the table (%s)", index_name, name());
+
+  return rc;
+}
+
+// 用new_table_meta覆盖元数据文件，成功后替换内存中的元数据
+RC Table::write_meta(TableMeta &new_table_meta) {
   // 创建元数据临时文件
   std::string tmp_file = table_meta_file(base_dir_.c_str(), name()) + ".tmp";
   std::fstream fs;
   fs.open(tmp_file, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
   if (!fs.is_open()) {
     LOG_ERROR("Failed to open file for write. file name=%s, errmsg=%s", tmp_file.c_str(), strerror(errno));
-    return RC::IOERR; // 创建索引中途出错，要做还原操作
+    return RC::IOERR;
   }
   if (new_table_meta.serialize(fs) < 0) {
     LOG_ERROR("Failed to dump new table meta to file: %s. sys err=%d:%s", tmp_file.c_str(), errno, strerror(errno));
@@ -612,16 +931,47 @@ RC Table::create_index(Trx *trx, const char *index_name, const int attribute_num
   std::string meta_file = table_meta_file(base_dir_.c_str(), name());
   int ret = rename(tmp_file.c_str(), meta_file.c_str());
   if (ret != 0) {
-    LOG_ERROR("Failed to rename tmp meta file (%s) to normal meta file (%s) while creating index (%s) on table (%s). " \
-              "system error=%d:%s", tmp_file.c_str(), meta_file.c_str(), index_name, name(), errno, strerror(errno));
+    LOG_ERROR("Failed to rename tmp meta file (%s) to normal meta file (%s) of table (%s). " \
+              "system error=%d:%s", tmp_file.c_str(), meta_file.c_str(), name(), errno, strerror(errno));
     return RC::IOERR;
   }
 
   table_meta_.swap(new_table_meta);
+  return RC::SUCCESS;
+}
 
-  LOG_INFO("add a new index (%s) on the table (%s)", index_name, name());
+static RC stats_record_reader_adapter(Record *record, void *context) {
+  TableStatsCollector &collector = *(TableStatsCollector *)context;
+  collector.add_record(record->data);
+  return RC::SUCCESS;
+}
 
-  return rc;
+RC Table::analyze(Trx *trx) {
+  TableStatsCollector collector(table_meta_);
+  RC rc = scan_record(trx, nullptr, -1, &collector, stats_record_reader_adapter);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to scan table %s for statistics. rc=%d:%s", name(), rc, strrc(rc));
+    return rc;
+  }
+
+  int page_count = 0;
+  rc = data_buffer_pool_->get_page_count(file_id_, &page_count);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to get page count of table %s. rc=%d:%s", name(), rc, strrc(rc));
+    return rc;
+  }
+
+  TableStats stats;
+  collector.finish(std::max(page_count - 1, 0), stats);  // 第0页是文件头
+  const int64_t row_count = stats.row_count;
+  TableMeta new_table_meta(table_meta_);
+  new_table_meta.set_stats(std::move(stats));
+  rc = write_meta(new_table_meta);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  LOG_INFO("analyzed table %s. rows=%lld, pages=%d", name(), (long long)row_count, std::max(page_count - 1, 0));
+  return RC::SUCCESS;
 }
 
 // just for one field change
@@ -687,6 +1037,10 @@ RC Table::update_record(Trx *trx, const char *attribute_name, const Value *value
   RecordUpdater updater(*this, trx, fieldMeta, value);
   rc = scan_record(trx, filter, -1, &updater, record_reader_update_adapter);
   *updated_count = updater.updated_count();
+  // update直接修改记录，不经过事务
+  if (updater.updated_count() > 0) {
+    increase_data_version();
+  }
   return RC::SUCCESS;
 }
 
@@ -788,6 +1142,9 @@ RC Table::delete_record(Trx *trx, ConditionFilter *filter, int *deleted_count) {
   if (deleted_count != nullptr) {
     *deleted_count = deleter.deleted_count();
   }
+  if (trx == nullptr && deleter.deleted_count() > 0) {
+    increase_data_version();
+  }
   return rc;
 }
 
@@ -870,14 +1227,9 @@ RC Table::commit_delete(Trx *trx, const RID &rid) {
 }
 
 RC Table::rollback_delete(Trx *trx, const RID &rid) {
-  RC rc = RC::SUCCESS;
-  Record record;
-  rc = record_handler_->get_record(&rid, &record);
-  if (rc != RC::SUCCESS) {
-    return rc;
-  }
-
-  return trx->rollback_delete(this, record); // update record in place
+  return record_handler_->update_record_in_place(&rid, [this, trx](Record &record) {
+    return trx->rollback_delete(this, record);
+  });
 }
 
 RC Table::insert_entry_of_indexes(const char *record, const RID &rid) {
@@ -925,7 +1277,8 @@ Index *Table::find_index(const char *index_name) const {
   return nullptr;
 }
 
-IndexScanner *Table::find_index_for_scan(const DefaultConditionFilter &filter) {
+Index *Table::find_index_for_filter(const DefaultConditionFilter &filter, const char *field_name,
+                                    const FieldMeta **field, const char **value) const {
   const ConDesc *field_cond_desc = nullptr;
   const ConDesc *value_cond_desc = nullptr;
   if (filter.left().is_attr && !filter.right().is_attr) {
@@ -952,41 +1305,190 @@ IndexScanner *Table::find_index_for_scan(const DefaultConditionFilter &filter) {
     return nullptr;
   }
 
-  const IndexMeta *index_meta = table_meta_.find_index_by_field(field_meta->name());
-  if (nullptr == index_meta) {
+  // 指定了field_name时，只使用这个字段上的索引
+  if (field_name != nullptr && 0 != strcmp(field_name, field_meta->name())) {
     return nullptr;
   }
 
-  Index *index = find_index(index_meta->name());
-  if (nullptr == index) {
-    return nullptr;
+  // 同一个字段上可能同时有B+树和hash索引，等值查询优先用hash索引，hash索引不支持范围查询
+  Index *index = nullptr;
+  for (Index *candidate : indexes_) {
+    const IndexMeta &index_meta = candidate->index_meta();
+    if (0 != strcmp(index_meta.field(), field_meta->name())) {
+      continue;
+    }
+    if (index_meta.type() == HASH_INDEX && filter.comp_op() != EQUAL_TO) {
+      continue;
+    }
+    if (index == nullptr || index_meta.type() == HASH_INDEX) {
+      index = candidate;
+    }
   }
-
-  return index->create_scanner(filter.comp_op(), (const char *)value_cond_desc->value);
+  if (index != nullptr) {
+    *field = field_meta;
+    *value = (const char *)value_cond_desc->value;
+  }
+  return index;
 }
 
-IndexScanner *Table::find_index_for_scan(const ConditionFilter *filter) {
-  if (nullptr == filter) {
-    return nullptr;
+// 从索引中读一个RID相对于回表读一条记录的代价
+static const double INDEX_ENTRY_COST = 0.1;
+
+// 没有统计信息时与连接顺序的估计相同：等值比较按1/10，范围比较按1/3
+static double default_selectivity(CompOp op) {
+  switch (op) {
+    case EQUAL_TO:
+      return 0.1;
+    case NOT_EQUAL:
+      return 0.9;
+    default:
+      return 0.33;
   }
+}
 
-  // remove dynamic_cast
+void Table::collect_index_candidates(const ConditionFilter *filter, const char *field_name,
+                                     std::vector<IndexCandidate> &candidates) const {
   const DefaultConditionFilter *default_condition_filter = dynamic_cast<const DefaultConditionFilter *>(filter);
   if (default_condition_filter != nullptr) {
-    return find_index_for_scan(*default_condition_filter);
+    IndexCandidate candidate;
+    const FieldMeta *field = nullptr;
+    candidate.filter = default_condition_filter;
+    candidate.index = find_index_for_filter(*default_condition_filter, field_name, &field, &candidate.value);
+    if (candidate.index == nullptr) {
+      return;
+    }
+    candidate.selectivity = -1;
+    const TableStats &stats = table_meta_.stats();
+    const ColumnStats *column = stats.analyzed ? stats.column(field->name()) : nullptr;
+    if (column != nullptr) {
+      candidate.selectivity = column->selectivity(default_condition_filter->comp_op(), candidate.value);
+    }
+    if (candidate.selectivity < 0) {
+      candidate.selectivity = default_selectivity(default_condition_filter->comp_op());
+    }
+    candidates.push_back(candidate);
+    return;
   }
 
   const CompositeConditionFilter *composite_condition_filter = dynamic_cast<const CompositeConditionFilter *>(filter);
   if (composite_condition_filter != nullptr) {
-    int filter_num = composite_condition_filter->filter_num();
-    for (int i = 0; i < filter_num; i++) {
-      IndexScanner *scanner= find_index_for_scan(&composite_condition_filter->filter(i));
-      if (scanner != nullptr) {
-        return scanner; // 可以找到一个最优的，比如比较符号是=
+    for (int i = 0; i < composite_condition_filter->filter_num(); i++) {
+      collect_index_candidates(&composite_condition_filter->filter(i), field_name, candidates);
+    }
+  }
+}
+
+void Table::choose_scan_indexes(const ConditionFilter *filter, const char *field_name,
+                                std::vector<IndexCandidate> &chosen) const {
+  chosen.clear();
+  if (nullptr == filter) {
+    return;
+  }
+
+  // 条件之间都是AND的关系，每个能走索引的条件都是候选，按估计的选择率排序，相同时保持条件的顺序
+  std::vector<IndexCandidate> candidates;
+  collect_index_candidates(filter, field_name, candidates);
+  if (candidates.empty()) {
+    return;
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+      [](const IndexCandidate &c1, const IndexCandidate &c2) { return c1.selectivity < c2.selectivity; });
+
+  // 求交集：再加一个索引要多读 selectivity * 行数 个索引项，换来的是少回表的记录。
+  // 只在有统计信息时使用，否则选择率估计得不准，可能读完一个很大的范围却没有减少多少记录
+  chosen.push_back(candidates[0]);
+  if (field_name == nullptr && table_meta_.stats().analyzed) {
+    double selectivity = candidates[0].selectivity;
+    for (size_t i = 1; i < candidates.size() && chosen.size() < MAX_INTERSECT_INDEXES; i++) {
+      const double candidate_selectivity = candidates[i].selectivity;
+      if (candidate_selectivity * INDEX_ENTRY_COST < selectivity * (1 - candidate_selectivity)) {
+        chosen.push_back(candidates[i]);
+        selectivity *= candidate_selectivity;
       }
     }
   }
-  return nullptr;
+}
+
+IndexScanner *Table::find_index_for_scan(const ConditionFilter *filter, const char *field_name) {
+  std::vector<IndexCandidate> chosen;
+  choose_scan_indexes(filter, field_name, chosen);
+  if (chosen.empty()) {
+    return nullptr;
+  }
+  if (chosen.size() > 1) {
+    IndexScanner *scanner = create_intersection_scanner(chosen);
+    if (scanner != nullptr) {
+      return scanner;
+    }
+  }
+
+  const IndexCandidate &best = chosen[0];
+  return best.index->create_scanner(best.filter->comp_op(), best.value);
+}
+
+void Table::scan_index_names(const ConditionFilter *filter, const char *field_name,
+                             std::vector<std::string> &index_names) const {
+  std::vector<IndexCandidate> chosen;
+  choose_scan_indexes(filter, field_name, chosen);
+  index_names.clear();
+  for (const IndexCandidate &candidate : chosen) {
+    index_names.push_back(candidate.index->index_meta().name());
+  }
+}
+
+// 读出一个索引扫描的所有RID，按页号排序
+static RC read_sorted_rids(IndexScanner *scanner, std::vector<RID> &rids) {
+  RC rc = RC::SUCCESS;
+  RID rid;
+  while (true) {
+    rc = scanner->next_entry(&rid);
+    if (rc == RC::RECORD_NO_MORE_IDX_IN_MEM) {
+      continue;
+    }
+    if (rc != RC::SUCCESS) {
+      break;
+    }
+    rids.push_back(rid);
+  }
+  scanner->destroy();
+  if (rc != RC::RECORD_EOF) {
+    return rc;
+  }
+  std::sort(rids.begin(), rids.end());
+  return RC::SUCCESS;
+}
+
+IndexScanner *Table::create_intersection_scanner(const std::vector<IndexCandidate> &candidates) {
+  std::vector<RID> rids;
+  std::vector<RID> current;
+  std::vector<RID> result;
+  for (size_t i = 0; i < candidates.size(); i++) {
+    const IndexCandidate &candidate = candidates[i];
+    IndexScanner *scanner = candidate.index->create_scanner(candidate.filter->comp_op(), candidate.value);
+    if (scanner == nullptr) {
+      LOG_WARN("Failed to create scanner of index %s. table=%s", candidate.index->index_meta().name(), name());
+      return nullptr;
+    }
+    current.clear();
+    RC rc = read_sorted_rids(scanner, current);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("Failed to read rids from index %s. table=%s, rc=%d:%s",
+               candidate.index->index_meta().name(), name(), rc, strrc(rc));
+      return nullptr;
+    }
+    if (i == 0) {
+      rids.swap(current);
+    } else {
+      result.clear();
+      std::set_intersection(rids.begin(), rids.end(), current.begin(), current.end(), std::back_inserter(result));
+      rids.swap(result);
+    }
+    if (rids.empty()) {
+      break;
+    }
+  }
+  LOG_DEBUG("Intersect %d indexes of table %s, rids=%d", (int)candidates.size(), name(), (int)rids.size());
+  return new RidListIndexScanner(std::move(rids));
 }
 
 RC Table::sync() {
@@ -1063,6 +1565,11 @@ RC Table::make_and_insert_text_record(Trx *trx, int value_num, const Value *valu
   return rc;
 }
 
+RC Table::get_records(const RID *rids, int count, void *context,
+                      void (*record_reader)(int index, const char *data, void *context)) {
+  return record_handler_->get_records(rids, count, context, record_reader);
+}
+
 RC Table::read_text_record(char *data, PageNum page_num) {
   RC rc = RC::SUCCESS;
   rc = record_handler_->read_text_data(data, page_num);
@@ -1,6 +1,8 @@
 #ifndef __OBSERVER_STORAGE_COMMON_TABLE_H__
 #define __OBSERVER_STORAGE_COMMON_TABLE_H__
 
+#include <atomic>
+
 #include "storage/common/table_meta.h"
 #include "storage/config.h"
 
@@ -8,6 +10,7 @@ class DiskBufferPool;
 class RecordFileHandler;
 class ConditionFilter;
 class DefaultConditionFilter;
+class RecordFileScanner;
 struct Record;
 struct RID;
 class Index;
@@ -16,6 +19,11 @@ class RecordDeleter;
 class Trx;
 
 class Table {
+public:
+  static const int SCAN_MORSEL_PAGES = 16;
+  // 一次扫描最多对几个索引的结果求交集
+  static const int MAX_INTERSECT_INDEXES = 4;
+
 public:
   Table();
   ~Table();
@@ -44,7 +52,54 @@ public:
 
   RC scan_record(Trx *trx, ConditionFilter *filter, int limit, void *context, void (*record_reader)(const char *data, void *context));
 
-  RC create_index(Trx *trx, const char *index_name, const int attribute_num, char * const attribute_names[], int unique);
+  /**
+   * 并行扫描时数据文件按SCAN_MORSEL_PAGES页切分为morsel。
+   * 返回按filter扫描时的morsel个数，条件可以走索引时返回1，即不并行
+   */
+  int scan_morsel_count(const ConditionFilter *filter);
+  /**
+   * 按rid读取记录，用于延迟物化。rids需要按页号排序，使页面按顺序读取，同一页只读一次
+   */
+  RC get_records(const RID *rids, int count, void *context,
+                 void (*record_reader)(int index, const char *data, void *context));
+  /**
+   * 按数据文件的页数估计表中的记录数，不读取页面的内容，用于选择join的算法。
+   * 收集过统计信息时按统计时每页的平均记录数估计
+   */
+  int estimate_record_count();
+  /**
+   * 并行扫描：morsel_count个morsel由WorkerPool中最多dop个线程领取后扫描，morsel_count由scan_morsel_count得到。
+   * record_reader在各个线程中被调用，worker为线程编号[0, dop)，morsel为morsel编号。
+   * 一个morsel的记录在同一个线程中按顺序读出，按morsel编号拼接后与scan_record的结果相同。
+   * record_reader返回RC::RECORD_EOF时这个morsel停止扫描，返回其它错误时整个扫描失败。
+   * morsel_done不为空时在每个morsel扫描结束后在同一个线程中调用。
+   * dop或morsel_count不大于1时在调用线程中调用scan_record，所有记录都属于morsel 0
+   */
+  RC scan_record_parallel(Trx *trx, ConditionFilter *filter, int dop, int morsel_count, void *context,
+                          RC (*record_reader)(int worker, int morsel, const char *data, void *context),
+                          void (*morsel_done)(int worker, int morsel, void *context) = nullptr);
+  /**
+   * 覆盖索引扫描：只读field_name上索引的叶子节点，不回表取记录。
+   * 传给record_reader的记录只有field_name字段有值，其它字段都标记为null，
+   * 因此filter也只能引用这个字段。
+   * 没有可用的索引或者还有未提交的事务操作时返回 SCHEMA_INDEX_NOT_EXIST，由调用方退回普通扫描
+   */
+  RC scan_record_index_only(Trx *trx, ConditionFilter *filter, const char *field_name, int limit, void *context,
+                            void (*record_reader)(const char *data, void *context));
+  /**
+   * 按filter扫描(指定field_name时为覆盖索引扫描)会使用的索引的名字，用于EXPLAIN。
+   * 多个索引表示求RID的交集，不能走索引时为空
+   */
+  void scan_index_names(const ConditionFilter *filter, const char *field_name,
+                        std::vector<std::string> &index_names) const;
+
+  /**
+   * ANALYZE TABLE：扫描trx可见的记录，收集行数、页数和各列的统计信息，写入表的元数据文件
+   */
+  RC analyze(Trx *trx);
+
+  RC create_index(Trx *trx, const char *index_name, const int attribute_num, char * const attribute_names[], int unique,
+                  IndexType index_type, bool key_compress = false);
 
   /**
    * 为了text而设计
@@ -64,6 +119,25 @@ public:
   RC sync();
 
 public:
+  /**
+   * 记录本表上还未提交/回滚的事务操作数。不为0时索引中可能存在未提交的数据，
+   * 不能只读索引，需要回表判断可见性
+   */
+  void add_pending_operations(int count) { pending_operations_ += count; }
+  int pending_operations() const { return pending_operations_.load(); }
+
+  /**
+   * 其它会话能看到的数据每次变化(事务提交或回滚、update、不在事务中的插入删除)之后递增，
+   * 查询结果缓存据此判断缓存的结果是否过期
+   */
+  void increase_data_version() { data_version_++; }
+  uint64_t data_version() const { return data_version_.load(); }
+
+  /**
+   * 表上的索引变化之后递增，缓存的计划据此判断之前的检查是否仍然有效
+   */
+  uint64_t schema_version() const { return schema_version_.load(); }
+
   RC commit_insert(Trx *trx, const RID &rid);
   RC commit_delete(Trx *trx, const RID &rid);
   RC rollback_insert(Trx *trx, const RID &rid);
@@ -72,8 +146,28 @@ public:
 private:
   RC scan_record(Trx *trx, ConditionFilter *filter, int limit, void *context, RC (*record_reader)(Record *record, void *context));
   RC scan_record_by_index(Trx *trx, IndexScanner *scanner, ConditionFilter *filter, int limit, void *context, RC (*record_reader)(Record *record, void *context));
-  IndexScanner *find_index_for_scan(const ConditionFilter *filter);
-  IndexScanner *find_index_for_scan(const DefaultConditionFilter &filter);
+  // 扫描第morsel个morsel，可以在多个线程中同时调用
+  RC scan_morsel(Trx *trx, ConditionFilter *filter, int morsel, int morsel_count, void *context,
+                 RC (*record_reader)(Record *record, void *context));
+  IndexScanner *find_index_for_scan(const ConditionFilter *filter, const char *field_name = nullptr);
+  // filter可以使用的索引，同时返回条件中的字段和记录格式的常量
+  Index *find_index_for_filter(const DefaultConditionFilter &filter, const char *field_name, const FieldMeta **field,
+                               const char **value) const;
+
+  // 一个可以走索引的条件，selectivity为估计的满足条件的记录比例
+  struct IndexCandidate {
+    const DefaultConditionFilter *filter;
+    Index *index;
+    const char *value;
+    double selectivity;
+  };
+  void collect_index_candidates(const ConditionFilter *filter, const char *field_name,
+                                std::vector<IndexCandidate> &candidates) const;
+  // 按filter扫描时使用的索引，多于一个时求交集，不能走索引时为空
+  void choose_scan_indexes(const ConditionFilter *filter, const char *field_name,
+                           std::vector<IndexCandidate> &chosen) const;
+  // 读出各个索引的RID求交集，按页号排序后逐个回表
+  IndexScanner *create_intersection_scanner(const std::vector<IndexCandidate> &candidates);
 
   RC insert_record(Trx *trx, Record *record);
   RC delete_record(Trx *trx, Record *record);
@@ -87,11 +181,14 @@ private:
 private:
   friend class RecordUpdater;
   friend class RecordDeleter;
+  friend class TableScanner;
 
   RC insert_entry_of_indexes(const char *record, const RID &rid);
   RC delete_entry_of_indexes(const char *record, const RID &rid, bool error_on_not_exists);
 private:
   RC init_record_handler(const char *base_dir);
+  RC rebuild_index(const char *index_file, const IndexMeta &index_meta, const FieldMeta &field_meta, Index *&index);
+  RC write_meta(TableMeta &new_table_meta);
   RC make_record(int value_num, const Value *values, char * &record_out);
 
 private:
@@ -104,6 +201,36 @@ private:
   int                     file_id_;
   RecordFileHandler *     record_handler_;   /// 记录操作
   std::vector<Index *>    indexes_;
+  std::atomic<int>        pending_operations_{0};
+  std::atomic<uint64_t>   data_version_{0};
+  std::atomic<uint64_t>   schema_version_{0};
+};
+
+/**
+ * 拉取方式的表扫描，调用方每次取一条满足条件且对trx可见的记录，可以随时停止。
+ * 条件能走索引时按索引扫描，否则顺序扫描数据文件。
+ * next返回的record只在下一次调用next或close之前有效
+ */
+class TableScanner {
+public:
+  TableScanner() = default;
+  ~TableScanner();
+
+  RC open(Table *table, Trx *trx, ConditionFilter *filter);
+
+  /**
+   * @return RECORD_EOF 没有更多的记录
+   */
+  RC next(Record *record);
+  RC close();
+
+private:
+  Table *             table_ = nullptr;
+  Trx *               trx_ = nullptr;
+  ConditionFilter *   filter_ = nullptr;
+  IndexScanner *      index_scanner_ = nullptr;
+  RecordFileScanner * record_scanner_ = nullptr;
+  Record *            current_ = nullptr;      // 顺序扫描的位置
 };
 
 #endif // __OBSERVER_STORAGE_COMMON_TABLE_H__
\ No newline at end of file
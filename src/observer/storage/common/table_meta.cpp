@@ -9,6 +9,7 @@
 static const Json::StaticString FIELD_TABLE_NAME("table_name");
 static const Json::StaticString FIELD_FIELDS("fields");
 static const Json::StaticString FIELD_INDEXES("indexes");
+static const Json::StaticString FIELD_STATISTICS("statistics");
 
 std::vector<FieldMeta> TableMeta::sys_fields_;
 
@@ -16,6 +17,7 @@ TableMeta::TableMeta(const TableMeta &other) :
         name_(other.name_),
         fields_(other.fields_),
         indexes_(other.indexes_),
+        stats_(other.stats_),
         record_size_(other.record_size_){
 }
 
@@ -23,6 +25,7 @@ void TableMeta::swap(TableMeta &other) noexcept{
   name_.swap(other.name_);
   fields_.swap(other.fields_);
   indexes_.swap(other.indexes_);
+  std::swap(stats_, other.stats_);
   std::swap(record_size_, other.record_size_);
 }
 
@@ -167,10 +170,10 @@ const IndexMeta * TableMeta::find_index_by_field(const char *field) const {
   return nullptr;
 }
 
-const IndexMeta * TableMeta::find_index_by_fields(const int attribute_num, char * const attribute_names[]) const {
+const IndexMeta * TableMeta::find_index_by_fields(const int attribute_num, char * const attribute_names[], IndexType type) const {
   for (const IndexMeta &index : indexes_) {
     const std::vector<std::string> &fields = index.fields();
-    if (fields.size() != attribute_num) {
+    if (index.type() != type || fields.size() != (size_t)attribute_num) {
       continue;
     }
     bool is_same = true;
@@ -199,6 +202,14 @@ int TableMeta::record_size() const {
   return record_size_;
 }
 
+void TableMeta::set_stats(TableStats &&stats) {
+  stats_ = std::move(stats);
+}
+
+const TableStats &TableMeta::stats() const {
+  return stats_;
+}
+
 // 将表的元数据序列化为 JSON，并写入到给定的输出流中
 int TableMeta::serialize(std::ostream &ss) const {
 
@@ -222,6 +233,12 @@ int TableMeta::serialize(std::ostream &ss) const {
   }
   table_value[FIELD_INDEXES] = std::move(indexes_value);
 
+  if (stats_.analyzed) {
+    Json::Value stats_value;
+    stats_.to_json(stats_value);
+    table_value[FIELD_STATISTICS] = std::move(stats_value);
+  }
+
   Json::StreamWriterBuilder builder;
   Json::StreamWriter *writer = builder.newStreamWriter();
 
@@ -305,6 +322,26 @@ int TableMeta::deserialize(std::istream &is) {
     indexes_.swap(indexes);
   }
 
+  // 统计信息只影响执行计划，不完整时忽略，不影响表的打开
+  const Json::Value &stats_value = table_value[FIELD_STATISTICS];
+  if (!stats_value.isNull()) {
+    TableStats stats;
+    if (TableStats::from_json(stats_value, stats) == RC::SUCCESS) {
+      std::vector<ColumnStats> columns;
+      for (ColumnStats &column : stats.columns) {
+        const FieldMeta *field_meta = field(column.name.c_str());
+        if (field_meta != nullptr) {
+          column.type = field_meta->type();
+          columns.push_back(std::move(column));
+        }
+      }
+      stats.columns.swap(columns);
+      stats_ = std::move(stats);
+    } else {
+      LOG_WARN("Ignore invalid statistics of table %s", name_.c_str());
+    }
+  }
+
   return (int)(is.tellg() - old_pos);
 }
 
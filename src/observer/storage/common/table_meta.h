@@ -7,6 +7,7 @@
 #include "rc.h"
 #include "storage/common/field_meta.h"
 #include "storage/common/index_meta.h"
+#include "storage/common/table_stats.h"
 #include "common/lang/serializable.h"
 
 class TableMeta : public common::Serializable {
@@ -21,6 +22,7 @@ public:
   RC init(const char *name, int field_num, const AttrInfo attributes[]);
 
   RC add_index(const IndexMeta &index);
+  void set_stats(TableStats &&stats);
 
 public:
   const char * name() const;
@@ -34,12 +36,15 @@ public:
 
   const IndexMeta * index(const char *name) const;
   const IndexMeta * find_index_by_field(const char *field) const;
-  const IndexMeta * find_index_by_fields(const int attribute_num, char * const attribute_names[]) const;
+  const IndexMeta * find_index_by_fields(const int attribute_num, char * const attribute_names[], IndexType type) const;
   const IndexMeta * index(int i) const;
   int index_num() const;
 
   int record_size() const;
 
+  // ANALYZE TABLE之后的统计信息，没有收集过时stats().analyzed为false
+  const TableStats &stats() const;
+
 public:
   int  serialize(std::ostream &os) const override;
   int  deserialize(std::istream &is) override;
@@ -53,6 +58,7 @@ private:
   std::string   name_;
   std::vector<FieldMeta>  fields_; // 包含sys_fields
   std::vector<IndexMeta>  indexes_;
+  TableStats              stats_;
 
   int  record_size_ = 0;
 
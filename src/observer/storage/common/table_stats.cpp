@@ -0,0 +1,443 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#include "storage/common/table_stats.h"
+#include "storage/common/table_meta.h"
+#include "storage/common/field_meta.h"
+#include "common/lang/bitmap.h"
+#include "common/log/log.h"
+#include "json/json.h"
+
+static const Json::StaticString FIELD_ROW_COUNT("row_count");
+static const Json::StaticString FIELD_PAGE_COUNT("page_count");
+static const Json::StaticString FIELD_COLUMNS("columns");
+static const Json::StaticString FIELD_NAME("name");
+static const Json::StaticString FIELD_NULL_FRACTION("null_fraction");
+static const Json::StaticString FIELD_MIN("min");
+static const Json::StaticString FIELD_MAX("max");
+static const Json::StaticString FIELD_NDV("ndv");
+static const Json::StaticString FIELD_SKETCH("sketch");
+static const Json::StaticString FIELD_HISTOGRAM("histogram");
+
+// FNV-1a再经过murmur3的finalizer打散，保证结果在不同进程间一致
+static uint64_t hash_bytes(const char *data, int len) {
+  uint64_t h = 14695981039346656037ULL;
+  for (int i = 0; i < len; i++) {
+    h ^= (unsigned char)data[i];
+    h *= 1099511628211ULL;
+  }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+HyperLogLog::HyperLogLog() : registers_(REGISTER_NUM, 0) {
+}
+
+void HyperLogLog::add(uint64_t hash) {
+  const int index = hash >> (64 - PRECISION);
+  // 低位补1，保证前导0的个数不超过64 - PRECISION
+  const uint64_t rest = (hash << PRECISION) | (1ULL << (PRECISION - 1));
+  const uint8_t rank = __builtin_clzll(rest) + 1;
+  registers_[index] = std::max(registers_[index], rank);
+}
+
+void HyperLogLog::merge(const HyperLogLog &other) {
+  for (int i = 0; i < REGISTER_NUM; i++) {
+    registers_[i] = std::max(registers_[i], other.registers_[i]);
+  }
+}
+
+double HyperLogLog::estimate() const {
+  const double m = REGISTER_NUM;
+  double sum = 0;
+  int zeros = 0;
+  for (uint8_t r : registers_) {
+    sum += ldexp(1.0, -r);
+    zeros += r == 0 ? 1 : 0;
+  }
+  const double alpha = 0.7213 / (1 + 1.079 / m);
+  double estimate = alpha * m * m / sum;
+  // 基数较小时按空寄存器的个数做线性计数更准确
+  if (estimate <= 2.5 * m && zeros > 0) {
+    estimate = m * log(m / zeros);
+  }
+  return estimate;
+}
+
+std::string HyperLogLog::to_string() const {
+  static const char digits[] = "0123456789abcdef";
+  std::string s;
+  s.reserve(REGISTER_NUM * 2);
+  for (uint8_t r : registers_) {
+    s.push_back(digits[r >> 4]);
+    s.push_back(digits[r & 0xf]);
+  }
+  return s;
+}
+
+static int hex_digit(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+bool HyperLogLog::from_string(const std::string &s) {
+  if (s.size() != REGISTER_NUM * 2) {
+    return false;
+  }
+  std::vector<uint8_t> registers(REGISTER_NUM);
+  for (int i = 0; i < REGISTER_NUM; i++) {
+    int high = hex_digit(s[i * 2]);
+    int low = hex_digit(s[i * 2 + 1]);
+    if (high < 0 || low < 0) {
+      return false;
+    }
+    registers[i] = (high << 4) | low;
+  }
+  registers_.swap(registers);
+  return true;
+}
+
+static double string_key(const char *data, int len) {
+  double key = 0;
+  for (int i = 0; i < 6; i++) {
+    // 结尾的'\0'之后都按0处理
+    unsigned char c = i < len ? (unsigned char)data[i] : 0;
+    if (c == 0) {
+      len = i;
+    }
+    key = key * 256 + c;
+  }
+  return key;
+}
+
+static bool date_key(const char *data, double &key) {
+  int year = 0, month = 0, day = 0;
+  if (sscanf(data, "%d-%d-%d", &year, &month, &day) != 3) {
+    return false;
+  }
+  key = (year * 100 + month) * 100 + day;
+  return true;
+}
+
+double stats_key(AttrType type, const char *data, int len) {
+  switch (type) {
+    case INTS:
+      return *(const int *)data;
+    case FLOATS:
+      return *(const float *)data;
+    case DATES: {
+      double key = 0;
+      date_key(data, key);
+      return key;
+    }
+    default:
+      return string_key(data, len);
+  }
+}
+
+bool stats_key(AttrType type, const Value &value, double &key) {
+  if (value.isnull || value.data == nullptr) {
+    return false;
+  }
+  switch (type) {
+    case INTS:
+    case FLOATS:
+      if (value.type == INTS) {
+        key = *(const int *)value.data;
+        return true;
+      }
+      if (value.type == FLOATS) {
+        key = *(const float *)value.data;
+        return true;
+      }
+      return false;
+    case DATES:
+      return (value.type == DATES || value.type == CHARS) && date_key((const char *)value.data, key);
+    case CHARS:
+      if (value.type != CHARS) {
+        return false;
+      }
+      key = string_key((const char *)value.data, strlen((const char *)value.data) + 1);
+      return true;
+    default:
+      return false;
+  }
+}
+
+double ColumnStats::equal_fraction(double key) const {
+  if (!has_value || key < min || key > max) {
+    return 0;
+  }
+  double fraction = 1 / std::max(ndv, 1.0);
+  // 等深直方图中一个值占了多个边界时，它至少占了这些边界之间的桶
+  if (histogram.size() >= 2) {
+    auto range = std::equal_range(histogram.begin(), histogram.end(), key);
+    int bounds = range.second - range.first;
+    if (bounds >= 2) {
+      fraction = std::max(fraction, (double)(bounds - 1) / (histogram.size() - 1));
+    }
+  }
+  return std::min(fraction, 1.0);
+}
+
+double ColumnStats::less_fraction(double key) const {
+  if (!has_value || key <= min) {
+    return 0;
+  }
+  if (key > max) {
+    return 1;
+  }
+  if (histogram.size() < 2) {
+    return max > min ? (key - min) / (max - min) : 0;
+  }
+  // 桶内按均匀分布插值
+  const int buckets = histogram.size() - 1;
+  const int i = std::lower_bound(histogram.begin(), histogram.end(), key) - histogram.begin();
+  if (i == 0) {
+    return 0;
+  }
+  if (i > buckets) {
+    return 1;
+  }
+  const double low = histogram[i - 1];
+  const double high = histogram[i];
+  return (i - 1 + (key - low) / (high - low)) / buckets;
+}
+
+double ColumnStats::selectivity(CompOp op, double key) const {
+  const double equal = equal_fraction(key);
+  const double less = less_fraction(key);
+  double fraction = 0;
+  switch (op) {
+    case EQUAL_TO:
+      fraction = equal;
+      break;
+    case NOT_EQUAL:
+      fraction = 1 - equal;
+      break;
+    case LESS_THAN:
+      fraction = less;
+      break;
+    case LESS_EQUAL:
+      fraction = less + equal;
+      break;
+    case GREAT_THAN:
+      fraction = 1 - less - equal;
+      break;
+    case GREAT_EQUAL:
+      fraction = 1 - less;
+      break;
+    default:
+      return -1;
+  }
+  return std::max(0.0, std::min(fraction, 1.0)) * (1 - null_fraction);
+}
+
+double ColumnStats::selectivity(CompOp op, const char *value) const {
+  if (value == nullptr || type == TEXTS || type == UNDEFINED) {
+    return -1;
+  }
+  const int len = type == CHARS ? strlen(value) + 1 : 0;
+  return selectivity(op, stats_key(type, value, len));
+}
+
+void ColumnStats::to_json(Json::Value &json_value) const {
+  json_value[FIELD_NAME] = name;
+  json_value[FIELD_NULL_FRACTION] = null_fraction;
+  if (has_value) {
+    json_value[FIELD_MIN] = min;
+    json_value[FIELD_MAX] = max;
+  }
+  json_value[FIELD_NDV] = ndv;
+  json_value[FIELD_SKETCH] = sketch.to_string();
+  Json::Value histogram_value(Json::arrayValue);
+  for (double bound : histogram) {
+    histogram_value.append(bound);
+  }
+  json_value[FIELD_HISTOGRAM] = std::move(histogram_value);
+}
+
+RC ColumnStats::from_json(const Json::Value &json_value, ColumnStats &stats) {
+  const Json::Value &name_value = json_value[FIELD_NAME];
+  const Json::Value &null_fraction_value = json_value[FIELD_NULL_FRACTION];
+  const Json::Value &ndv_value = json_value[FIELD_NDV];
+  const Json::Value &sketch_value = json_value[FIELD_SKETCH];
+  const Json::Value &histogram_value = json_value[FIELD_HISTOGRAM];
+  if (!name_value.isString() || !null_fraction_value.isNumeric() || !ndv_value.isNumeric() ||
+      !sketch_value.isString() || !histogram_value.isArray()) {
+    LOG_ERROR("Invalid column statistics. json value=%s", json_value.toStyledString().c_str());
+    return RC::GENERIC_ERROR;
+  }
+
+  stats.name = name_value.asString();
+  stats.null_fraction = null_fraction_value.asDouble();
+  stats.ndv = ndv_value.asDouble();
+  stats.has_value = json_value.isMember(FIELD_MIN) && json_value.isMember(FIELD_MAX);
+  if (stats.has_value) {
+    stats.min = json_value[FIELD_MIN].asDouble();
+    stats.max = json_value[FIELD_MAX].asDouble();
+  }
+  if (!stats.sketch.from_string(sketch_value.asString())) {
+    LOG_ERROR("Invalid HyperLogLog sketch of column %s", stats.name.c_str());
+    return RC::GENERIC_ERROR;
+  }
+  stats.histogram.clear();
+  for (const Json::Value &bound : histogram_value) {
+    stats.histogram.push_back(bound.asDouble());
+  }
+  return RC::SUCCESS;
+}
+
+const ColumnStats *TableStats::column(const char *name) const {
+  for (const ColumnStats &stats : columns) {
+    if (stats.name == name) {
+      return &stats;
+    }
+  }
+  return nullptr;
+}
+
+void TableStats::to_json(Json::Value &json_value) const {
+  json_value[FIELD_ROW_COUNT] = (Json::Int64)row_count;
+  json_value[FIELD_PAGE_COUNT] = page_count;
+  Json::Value columns_value(Json::arrayValue);
+  for (const ColumnStats &stats : columns) {
+    Json::Value column_value;
+    stats.to_json(column_value);
+    columns_value.append(std::move(column_value));
+  }
+  json_value[FIELD_COLUMNS] = std::move(columns_value);
+}
+
+RC TableStats::from_json(const Json::Value &json_value, TableStats &stats) {
+  const Json::Value &row_count_value = json_value[FIELD_ROW_COUNT];
+  const Json::Value &page_count_value = json_value[FIELD_PAGE_COUNT];
+  const Json::Value &columns_value = json_value[FIELD_COLUMNS];
+  if (!row_count_value.isIntegral() || !page_count_value.isInt() || !columns_value.isArray()) {
+    LOG_ERROR("Invalid table statistics. json value=%s", json_value.toStyledString().c_str());
+    return RC::GENERIC_ERROR;
+  }
+
+  std::vector<ColumnStats> columns(columns_value.size());
+  for (Json::ArrayIndex i = 0; i < columns_value.size(); i++) {
+    RC rc = ColumnStats::from_json(columns_value[i], columns[i]);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+  stats.analyzed = true;
+  stats.row_count = row_count_value.asInt64();
+  stats.page_count = page_count_value.asInt();
+  stats.columns.swap(columns);
+  return RC::SUCCESS;
+}
+
+TableStatsCollector::TableStatsCollector(const TableMeta &table_meta)
+    : field_num_(table_meta.field_num()), random_(0) {
+  for (int i = table_meta.sys_field_num(); i < table_meta.field_num(); i++) {
+    const FieldMeta *field = table_meta.field(i);
+    Column column;
+    column.field = field;
+    column.field_index = i;
+    columns_.push_back(std::move(column));
+
+    ColumnStats stats;
+    stats.name = field->name();
+    stats.type = field->type();
+    stats_.push_back(std::move(stats));
+  }
+}
+
+void TableStatsCollector::add_record(const char *data) {
+  common::Bitmap null_bitmap((char *)data, field_num_);
+  row_count_++;
+
+  // 蓄水池采样：第n行以SAMPLE_SIZE/n的概率替换样本中随机的一行
+  int64_t slot = row_count_ - 1;
+  if (row_count_ > SAMPLE_SIZE) {
+    slot = random_() % row_count_;
+    if (slot >= SAMPLE_SIZE) {
+      slot = -1;
+    }
+  }
+
+  for (size_t i = 0; i < columns_.size(); i++) {
+    Column &column = columns_[i];
+    ColumnStats &stats = stats_[i];
+    const FieldMeta *field = column.field;
+    double key = NAN;
+    if (null_bitmap.get_bit(column.field_index)) {
+      column.null_count++;
+    } else if (field->type() != TEXTS) {
+      const char *value = data + field->offset();
+      int len = field->len();
+      if (field->type() == CHARS || field->type() == DATES) {
+        len = strnlen(value, len);
+      }
+      stats.sketch.add(hash_bytes(value, len));
+      key = stats_key(field->type(), value, len);
+      if (!stats.has_value) {
+        stats.min = stats.max = key;
+        stats.has_value = true;
+      } else {
+        stats.min = std::min(stats.min, key);
+        stats.max = std::max(stats.max, key);
+      }
+    }
+
+    if (slot < 0) {
+      continue;
+    }
+    if (slot < (int64_t)column.sample.size()) {
+      column.sample[slot] = key;
+    } else {
+      column.sample.push_back(key);
+    }
+  }
+}
+
+void TableStatsCollector::finish(int page_count, TableStats &stats) {
+  for (size_t i = 0; i < columns_.size(); i++) {
+    Column &column = columns_[i];
+    ColumnStats &column_stats = stats_[i];
+    const int64_t value_count = row_count_ - column.null_count;
+    column_stats.null_fraction = row_count_ > 0 ? (double)column.null_count / row_count_ : 0;
+    column_stats.ndv = std::min((double)value_count, round(column_stats.sketch.estimate()));
+    column_stats.histogram.clear();
+
+    std::vector<double> sample;
+    for (double key : column.sample) {
+      if (!isnan(key)) {
+        sample.push_back(key);
+      }
+    }
+    if (sample.empty()) {
+      continue;
+    }
+    std::sort(sample.begin(), sample.end());
+    const int sample_size = sample.size();
+    const int buckets = std::min((int)HISTOGRAM_BUCKETS, sample_size);
+    for (int b = 0; b <= buckets; b++) {
+      column_stats.histogram.push_back(sample[std::min(sample_size - 1, b * sample_size / buckets)]);
+    }
+    // 两端用全表的最小值和最大值
+    column_stats.histogram.front() = column_stats.min;
+    column_stats.histogram.back() = column_stats.max;
+  }
+
+  stats.analyzed = true;
+  stats.row_count = row_count_;
+  stats.page_count = page_count;
+  stats.columns.swap(stats_);
+}
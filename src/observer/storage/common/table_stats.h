@@ -0,0 +1,124 @@
+#ifndef __OBSERVER_STORAGE_COMMON_TABLE_STATS_H__
+#define __OBSERVER_STORAGE_COMMON_TABLE_STATS_H__
+
+#include <stdint.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "rc.h"
+#include "sql/parser/parse_defs.h"
+
+class TableMeta;
+class FieldMeta;
+
+namespace Json {
+class Value;
+} // namespace Json
+
+/**
+ * HyperLogLog基数估计。2^PRECISION个寄存器，标准误差约1.04/sqrt(2^PRECISION)，即3%左右
+ */
+class HyperLogLog {
+public:
+  enum { PRECISION = 10, REGISTER_NUM = 1 << PRECISION };
+
+  HyperLogLog();
+
+  void add(uint64_t hash);
+  void merge(const HyperLogLog &other);
+  double estimate() const;
+
+  // 寄存器按十六进制编码，用于保存到元数据文件
+  std::string to_string() const;
+  bool from_string(const std::string &s);
+
+private:
+  std::vector<uint8_t> registers_;
+};
+
+/**
+ * 一列的统计信息。
+ * 值统一映射成double的排序键再比较：整数和浮点数就是值本身，日期是yyyymmdd，
+ * 字符串取前6个字节按大端拼成整数，因此只有前缀不同的字符串才能区分开
+ */
+struct ColumnStats {
+  std::string name;
+  AttrType type = UNDEFINED;
+  double null_fraction = 0;
+  bool has_value = false;      // 有非null的值时min/max才有意义
+  double min = 0;
+  double max = 0;
+  double ndv = 0;              // 非null值的不同值个数
+  HyperLogLog sketch;
+  std::vector<double> histogram;  // 等深直方图的桶边界，n个桶有n+1个边界，每个桶内的行数相同
+
+  /**
+   * 满足 "列 op 值" 的行占全表的比例，value是与记录中的格式相同的数据
+   * @return 无法估计时返回负数
+   */
+  double selectivity(CompOp op, const char *value) const;
+  double selectivity(CompOp op, double key) const;
+
+  void to_json(Json::Value &json_value) const;
+  static RC from_json(const Json::Value &json_value, ColumnStats &stats);
+
+private:
+  double equal_fraction(double key) const;
+  double less_fraction(double key) const;  // 非null值中小于key的比例
+};
+
+/**
+ * ANALYZE TABLE收集的表统计信息，随表的元数据一起保存
+ */
+struct TableStats {
+  bool analyzed = false;
+  int64_t row_count = 0;
+  int page_count = 0;          // 数据页数，不包括文件头
+  std::vector<ColumnStats> columns;
+
+  const ColumnStats *column(const char *name) const;
+
+  void to_json(Json::Value &json_value) const;
+  static RC from_json(const Json::Value &json_value, TableStats &stats);
+};
+
+/**
+ * 逐条记录收集统计信息。
+ * 行数、null比例、min/max、HyperLogLog对所有记录统计；
+ * 直方图由蓄水池采样的最多SAMPLE_SIZE条记录构建
+ */
+class TableStatsCollector {
+public:
+  enum { SAMPLE_SIZE = 10000, HISTOGRAM_BUCKETS = 32 };
+
+  explicit TableStatsCollector(const TableMeta &table_meta);
+
+  void add_record(const char *data);
+  void finish(int page_count, TableStats &stats);
+
+private:
+  struct Column {
+    const FieldMeta *field;
+    int field_index;
+    int64_t null_count = 0;
+    std::vector<double> sample;  // 采样的行中这一列的排序键，null为NaN
+  };
+
+  std::vector<Column> columns_;
+  int field_num_;
+  int64_t row_count_ = 0;
+  std::vector<ColumnStats> stats_;
+  std::mt19937_64 random_;
+};
+
+/**
+ * 记录格式的数据对应的排序键
+ */
+double stats_key(AttrType type, const char *data, int len);
+/**
+ * 查询中的常量按列的类型换算成排序键，类型不能比较时返回false
+ */
+bool stats_key(AttrType type, const Value &value, double &key);
+
+#endif // __OBSERVER_STORAGE_COMMON_TABLE_STATS_H__
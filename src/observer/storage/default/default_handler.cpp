@@ -120,7 +120,8 @@ RC DefaultHandler::drop_table(const char *dbname, const char *relation_name) {
   return db->drop_table(relation_name);
 }
 
-RC DefaultHandler::create_index(Trx *trx, const char *dbname, const char *relation_name, const char *index_name, const int attribute_num, char * const attribute_names[], int unique) {
+RC DefaultHandler::create_index(Trx *trx, const char *dbname, const char *relation_name, const char *index_name, const int attribute_num, char * const attribute_names[], int unique, IndexType index_type,
+                                bool key_compress) {
   Table *table = find_table(dbname, relation_name);
   if (attribute_num == 0) {
     return RC::GENERIC_ERROR;
@@ -128,7 +129,15 @@ RC DefaultHandler::create_index(Trx *trx, const char *dbname, const char *relati
   if (nullptr == table) {
     return RC::SCHEMA_TABLE_NOT_EXIST;
   }
-  return table->create_index(trx, index_name, attribute_num, attribute_names, unique);
+  return table->create_index(trx, index_name, attribute_num, attribute_names, unique, index_type, key_compress);
+}
+
+RC DefaultHandler::analyze_table(Trx *trx, const char *dbname, const char *relation_name) {
+  Table *table = find_table(dbname, relation_name);
+  if (nullptr == table) {
+    return RC::SCHEMA_TABLE_NOT_EXIST;
+  }
+  return table->analyze(trx);
 }
 
 RC DefaultHandler::drop_index(Trx *trx, const char *dbname, const char *relation_name, const char *index_name) {
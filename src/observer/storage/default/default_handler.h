@@ -88,9 +88,17 @@ public:
    * @param relName
    * @param attribute_num 可能是多列索引
    * @param attributes_name 涉及到的列
+   * @param index_type B+树或hash索引
+   * @param key_compress CHARS类型的B+树索引是否做前缀压缩
    * @return
    */
-  RC create_index(Trx *trx, const char *dbname, const char *relation_name, const char *index_name, const int attribute_num, char * const attribute_names[], int unique);
+  RC create_index(Trx *trx, const char *dbname, const char *relation_name, const char *index_name, const int attribute_num, char * const attribute_names[], int unique, IndexType index_type,
+                  bool key_compress = false);
+
+  /**
+   * 收集relation_name表的统计信息并保存到表的元数据中，供优化器使用
+   */
+  RC analyze_table(Trx *trx, const char *dbname, const char *relation_name);
 
   /**
    * 该函数用来删除名为indexName的索引。
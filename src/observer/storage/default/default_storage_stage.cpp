@@ -194,7 +194,8 @@ void DefaultStorageStage::handle_event(StageEvent *event) {
       const CreateIndex &create_index = sql->sstr.create_index;
       rc = handler_->create_index(current_trx, current_db, create_index.relation_name,
                                   create_index.index_name, create_index.attribute_num,
-                                  create_index.attribute_names, create_index.unique);
+                                  create_index.attribute_names, create_index.unique, create_index.index_type,
+                                  session->index_key_compress());
       snprintf(response, sizeof(response), "%s\n", rc == RC::SUCCESS ? "SUCCESS" : "FAILURE");
     }
     break;
@@ -231,6 +232,13 @@ void DefaultStorageStage::handle_event(StageEvent *event) {
     }
     break;
 
+  case SCF_ANALYZE_TABLE: {
+      const char *table_name = sql->sstr.analyze_table.relation_name;
+      rc = handler_->analyze_table(current_trx, current_db, table_name);
+      snprintf(response, sizeof(response), "%s\n", rc == RC::SUCCESS ? "SUCCESS" : "FAILURE");
+    }
+    break;
+
   case SCF_LOAD_DATA: {
       /*
         从文件导入数据，如果做性能测试，需要保持这些代码可以正常工作
@@ -38,6 +38,8 @@ void BPManager::deleteFrame(FileDesc fd, PageNum pn, FrameId frame_id) {
   //这里pin一次，是为了防止被最后一次unpin之后delete，导致该frame既在lru中，又在free_list
   replacer_->Pin(frame_id);
   DeletePageTable(fd, pn);
+  // 释放的页(比如dispose掉的页)不需要再刷盘，否则frame被复用时会把旧内容写到可能已经重新分配的页上
+  frames_[frame_id].dirty = false;
   free_list_.push_back(frame_id);
 }
 
@@ -120,6 +122,7 @@ RC DiskBufferPool::drop_file(const char *file_name) {
 
 RC DiskBufferPool::open_file(const char *file_name, int *file_id)
 {
+  std::lock_guard<std::mutex> guard(lock_);
   if (file_name == nullptr) {
     return RC::BUFFERPOOL_FILEERR;
   }
@@ -190,6 +193,7 @@ RC DiskBufferPool::open_file(const char *file_name, int *file_id)
 
 RC DiskBufferPool::close_file(int file_id)
 {
+  std::lock_guard<std::mutex> guard(lock_);
   RC tmp;
   if ((tmp = check_file_id(file_id)) != RC::SUCCESS) {
     LOG_ERROR("Failed to close file, due to invalid fileId %d", file_id);
@@ -216,7 +220,27 @@ RC DiskBufferPool::close_file(int file_id)
   return RC::SUCCESS;
 }
 
+static thread_local uint64_t thread_pages_hit_ = 0;
+static thread_local uint64_t thread_pages_read_ = 0;
+
+uint64_t DiskBufferPool::thread_pages_hit()
+{
+  return thread_pages_hit_;
+}
+
+uint64_t DiskBufferPool::thread_pages_read()
+{
+  return thread_pages_read_;
+}
+
 RC DiskBufferPool::get_this_page(int file_id, PageNum page_num, BPPageHandle *page_handle)
+{
+  std::unique_lock<std::mutex> guard(lock_);
+  return get_this_page(file_id, page_num, page_handle, guard);
+}
+
+RC DiskBufferPool::get_this_page(int file_id, PageNum page_num, BPPageHandle *page_handle,
+                                 std::unique_lock<std::mutex> &guard)
 {
   RC tmp;
   if ((tmp = check_file_id(file_id)) != RC::SUCCESS) {
@@ -231,36 +255,67 @@ RC DiskBufferPool::get_this_page(int file_id, PageNum page_num, BPPageHandle *pa
   }
 
   // This page has been loaded.
-  if (bp_manager_.get(file_handle->file_desc, page_num) != nullptr) {
-    page_handle->frame = bp_manager_.get(file_handle->file_desc, page_num);
-    page_handle->frame->pin_count++;
-    bp_manager_.replacer_->Pin(bp_manager_.GetFrameID(page_handle->frame));
+  Frame *frame = bp_manager_.get(file_handle->file_desc, page_num);
+  if (frame != nullptr) {
+    frame->pin_count++;
+    bp_manager_.replacer_->Pin(bp_manager_.GetFrameID(frame));
+    if (frame->loading) {
+      // 其他线程正在读这个页，pin住frame之后等它读完
+      loaded_.wait(guard, [frame]() { return !frame->loading; });
+      if (frame->page.page_num == BP_INVALID_PAGE_NUM) {
+        release_failed_frame(frame);
+        return RC::IOERR_READ;
+      }
+    }
+    page_handle->frame = frame;
     page_handle->open = true;
+    thread_pages_hit_++;
     return RC::SUCCESS;
   }
 
   // Allocate one page and load the data into this page
-  if ((tmp = allocate_block(&(page_handle->frame))) != RC::SUCCESS) {
+  if ((tmp = allocate_block(&frame)) != RC::SUCCESS) {
     LOG_ERROR("Failed to load page %s:%d, due to failed to alloc page.", file_handle->file_name, page_num);
     return tmp;
   }
-  page_handle->frame->dirty = false;
-  page_handle->frame->file_desc = file_handle->file_desc;
-  page_handle->frame->pin_count = 1;
-  if ((tmp = load_page(page_num, file_handle, page_handle->frame)) != RC::SUCCESS) {
+  frame->dirty = false;
+  frame->loading = true;
+  frame->file_desc = file_handle->file_desc;
+  frame->pin_count = 1;
+  bp_manager_.AddPageTable(file_handle->file_desc, page_num, bp_manager_.GetFrameID(frame));
+
+  guard.unlock();
+  tmp = load_page(page_num, file_handle, frame);
+  guard.lock();
+  frame->loading = false;
+  loaded_.notify_all();
+  if (tmp != RC::SUCCESS) {
     LOG_ERROR("Failed to load page %s:%d", file_handle->file_name, page_num);
-    page_handle->frame->pin_count = 0;
-    dispose_block(page_handle->frame);
+    bp_manager_.DeletePageTable(file_handle->file_desc, page_num);
+    frame->page.page_num = BP_INVALID_PAGE_NUM;
+    release_failed_frame(frame);
     return tmp;
   }
-  bp_manager_.AddPageTable(file_handle->file_desc, page_num, bp_manager_.GetFrameID(page_handle->frame));
 
+  page_handle->frame = frame;
   page_handle->open = true;
+  thread_pages_read_++;
   return RC::SUCCESS;
 }
 
+// 读盘失败的frame已经不在页表中，最后一个pin住它的线程把它放回空闲链表
+void DiskBufferPool::release_failed_frame(Frame *frame)
+{
+  frame->pin_count--;
+  if (frame->pin_count == 0) {
+    frame->dirty = false;
+    bp_manager_.free_list_.push_back(bp_manager_.GetFrameID(frame));
+  }
+}
+
 RC DiskBufferPool::allocate_page(int file_id, BPPageHandle *page_handle)
 {
+  std::unique_lock<std::mutex> guard(lock_);
   RC tmp;
   if ((tmp = check_file_id(file_id)) != RC::SUCCESS) {
     LOG_ERROR("Failed to alloc page, due to invalid fileId %d", file_id);
@@ -278,7 +333,7 @@ RC DiskBufferPool::allocate_page(int file_id, BPPageHandle *page_handle)
       if (((file_handle->bitmap[byte]) & (1 << bit)) == 0) {
         (file_handle->file_sub_header->allocated_pages)++;
         file_handle->bitmap[byte] |= (1 << bit);
-        return get_this_page(file_id, i, page_handle);
+        return get_this_page(file_id, i, page_handle, guard);
       }
     }
   }
@@ -334,12 +389,14 @@ RC DiskBufferPool::get_data(BPPageHandle *page_handle, char **data)
 
 RC DiskBufferPool::mark_dirty(BPPageHandle *page_handle)
 {
+  std::lock_guard<std::mutex> guard(lock_);
   page_handle->frame->dirty = true;
   return RC::SUCCESS;
 }
 
 RC DiskBufferPool::unpin_page(BPPageHandle *page_handle)
 {
+  std::lock_guard<std::mutex> guard(lock_);
   page_handle->open = false;
   page_handle->frame->pin_count--;
   if (page_handle->frame->pin_count == 0) {
@@ -358,6 +415,7 @@ RC DiskBufferPool::unpin_page(BPPageHandle *page_handle)
  */
 RC DiskBufferPool::dispose_page(int file_id, PageNum page_num)
 {
+  std::lock_guard<std::mutex> guard(lock_);
   RC rc;
   if ((rc = check_file_id(file_id)) != RC::SUCCESS) {
     LOG_ERROR("Failed to alloc page, due to invalid fileId %d", file_id);
@@ -369,15 +427,14 @@ RC DiskBufferPool::dispose_page(int file_id, PageNum page_num)
     LOG_ERROR("Failed to dispose page %s:%d, due to invalid pageNum", file_handle->file_name, page_num);
     return rc;
   }
+  // 页面不在缓冲区中时只需要清除位图
   Frame *frame = bp_manager_.get(file_handle->file_desc, page_num);
-  if (frame == nullptr) {
-    return RC::BUFFERPOOL_PAGE_PINNED;
-  }
-  if (frame->pin_count != 0) {
-    return RC::BUFFERPOOL_PAGE_PINNED;
+  if (frame != nullptr) {
+    if (frame->pin_count != 0) {
+      return RC::BUFFERPOOL_PAGE_PINNED;
+    }
+    bp_manager_.deleteFrame(file_handle->file_desc, page_num, bp_manager_.GetFrameID(frame));
   }
-
-  bp_manager_.deleteFrame(file_handle->file_desc, page_num, bp_manager_.GetFrameID(frame));
   
   file_handle->hdr_frame->dirty = true;
   file_handle->file_sub_header->allocated_pages--;
@@ -390,6 +447,7 @@ RC DiskBufferPool::dispose_page(int file_id, PageNum page_num)
 
 RC DiskBufferPool::force_page(int file_id, PageNum page_num)
 {
+  std::lock_guard<std::mutex> guard(lock_);
   RC rc;
   if ((rc = check_file_id(file_id)) != RC::SUCCESS) {
     LOG_ERROR("Failed to alloc page, due to invalid fileId %d", file_id);
@@ -457,6 +515,7 @@ RC DiskBufferPool::force_page(BPFileHandle *file_handle, PageNum page_num)
 
 RC DiskBufferPool::flush_all_pages(int file_id)
 {
+  std::lock_guard<std::mutex> guard(lock_);
   RC rc = check_file_id(file_id);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to flush pages due to invalid file_id %d", file_id);
@@ -470,19 +529,23 @@ RC DiskBufferPool::flush_all_pages(int file_id)
 
 RC DiskBufferPool::force_all_pages(BPFileHandle *file_handle)
 {
-  std::vector<std::pair<int, int>> deleted_pages;
+  // 干净页也要从页表中清除，否则文件关闭后fd被复用时会读到旧文件的页；
+  // 仍被pin住的页(其他线程正在使用)只刷盘不淘汰
+  std::vector<std::pair<PageNum, FrameId>> deleted_pages;
   for (auto &it : bp_manager_.page_table_[file_handle->file_desc]) {
-    if (bp_manager_.frames_[it.second].dirty) {
-      deleted_pages.push_back({it.second, it.second});
-      RC rc = flush_block(&bp_manager_.frames_[it.second]);
+    Frame *frame = &bp_manager_.frames_[it.second];
+    if (frame->dirty) {
+      RC rc = flush_block(frame);
       if (rc != RC::SUCCESS) {
         LOG_ERROR("Failed to flush all pages' of %s.", file_handle->file_name);
         return rc;
       }
     }
+    if (frame->pin_count == 0) {
+      deleted_pages.push_back({it.first, it.second});
+    }
   }
   for (auto &it : deleted_pages) {
-    RC rc = flush_block(&bp_manager_.frames_[it.second]);
     bp_manager_.deleteFrame(file_handle->file_desc, it.first, it.second);
   }
   return RC::SUCCESS;
@@ -493,13 +556,9 @@ RC DiskBufferPool::flush_block(Frame *frame)
   // The better way is use mmap the block into memory,
   // so it is easier to flush data to file.
 
+  // 读盘不持有lock_，和刷盘可能同时使用同一个fd，不能依赖fd上的文件偏移
   s64_t offset = ((s64_t)frame->page.page_num) * sizeof(Page);
-  if (lseek(frame->file_desc, offset, SEEK_SET) == offset - 1) {
-    LOG_ERROR("Failed to flush page %lld of %d due to failed to seek %s.", offset, frame->file_desc, strerror(errno));
-    return RC::IOERR_SEEK;
-  }
-
-  if (write(frame->file_desc, &(frame->page), sizeof(Page)) != sizeof(Page)) {
+  if (pwrite(frame->file_desc, &(frame->page), sizeof(Page), offset) != sizeof(Page)) {
     LOG_ERROR("Failed to flush page %lld of %d due to %s.", offset, frame->file_desc, strerror(errno));
     return RC::IOERR_WRITE;
   }
@@ -566,6 +625,7 @@ RC DiskBufferPool::check_file_id(int file_id)
 // needn't modify
 RC DiskBufferPool::get_page_count(int file_id, int *page_count)
 {
+  std::lock_guard<std::mutex> guard(lock_);
   RC rc = RC::SUCCESS;
   if ((rc = check_file_id(file_id)) != RC::SUCCESS) {
     return rc;
@@ -591,13 +651,7 @@ RC DiskBufferPool::check_page_num(PageNum page_num, BPFileHandle *file_handle)
 RC DiskBufferPool::load_page(PageNum page_num, BPFileHandle *file_handle, Frame *frame)
 {
   s64_t offset = ((s64_t)page_num) * sizeof(Page);
-  if (lseek(file_handle->file_desc, offset, SEEK_SET) == -1) {
-    LOG_ERROR(
-        "Failed to load page %s:%d, due to failed to lseek:%s.", file_handle->file_name, page_num, strerror(errno));
-
-    return RC::IOERR_SEEK;
-  }
-  if (read(file_handle->file_desc, &(frame->page), sizeof(Page)) != sizeof(Page)) {
+  if (pread(file_handle->file_desc, &(frame->page), sizeof(Page), offset) != sizeof(Page)) {
     LOG_ERROR(
         "Failed to load page %s:%d, due to failed to read data:%s.", file_handle->file_name, page_num, strerror(errno));
     return RC::IOERR_READ;
@@ -3,6 +3,7 @@
 
 #include <fcntl.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <sys/types.h>
 
 #include <string.h>
@@ -13,6 +14,8 @@
 #include <map>
 #include <list>
 #include <string>
+#include <mutex>
+#include <condition_variable>
 
 #include "storage/config.h"
 #include "storage/default/lru_replacer.h"
@@ -31,6 +34,7 @@ typedef struct {
 
 typedef struct {
   bool dirty;
+  bool loading;  // 正在从磁盘读入。读盘时不持有缓冲池的锁，其他线程pin住之后等它读完再使用
   unsigned int pin_count;
   unsigned long acc_time;
   int file_desc;
@@ -68,6 +72,8 @@ public:
     replacer_ = new LRUReplacer(static_cast<size_t>(size));
     for (int i = 0; i < size; i++) {
       frames_[i].pin_count = 0;
+      frames_[i].dirty = false;
+      frames_[i].loading = false;
       free_list_.emplace_back(i);
     }
   }
@@ -207,6 +213,13 @@ public:
 
   RC flush_all_pages(int file_id);
 
+  /**
+   * 当前线程调用get_this_page时在缓冲区中命中的页数和从磁盘读入的页数，只增不减。
+   * EXPLAIN ANALYZE用执行前后的差值得到一个算子访问的页数
+   */
+  static uint64_t thread_pages_hit();
+  static uint64_t thread_pages_read();
+
 protected:
   /**
    * 调用完allocate_block之后一定记得bpm.addPageTable()更新页表
@@ -225,12 +238,22 @@ protected:
    * 即该文件的所有相关页都将不在内存中
    */
   RC force_all_pages(BPFileHandle *file_handle);
+  /**
+   * 调用方持有lock_(guard)。页面不在缓冲区时先把frame登记到页表并标记为loading，
+   * 解锁读盘，读完再加锁，其间其他线程对这个页的请求等待loaded_
+   */
+  RC get_this_page(int file_id, PageNum page_num, BPPageHandle *page_handle, std::unique_lock<std::mutex> &guard);
+  void release_failed_frame(Frame *frame);
   RC check_file_id(int file_id);
   RC check_page_num(PageNum page_num, BPFileHandle *file_handle);
   RC load_page(PageNum page_num, BPFileHandle *file_handle, Frame *frame);
   RC flush_block(Frame *frame);
 
 private:
+  // 缓冲池被多个线程(会话、索引并发读写)共享，页表/LRU/文件头等元数据由该锁保护。
+  // 页面的读盘不持有该锁，不同页面的读盘可以并行；页面内容由使用方(比如B+树的节点锁)保护
+  std::mutex lock_;
+  std::condition_variable loaded_;
   BPManager bp_manager_;
   // BPFileHandle *open_list_[MAX_OPEN_FILE] = {nullptr};
   std::list<int> free_file_ids_{};
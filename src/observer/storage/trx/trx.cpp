@@ -103,7 +103,9 @@ Operation *Trx::find_operation(Table *table, const RID &rid) {
 
 void Trx::insert_operation(Table *table, Operation::Type type, const RID &rid) {
   OperationSet & table_operations = operations_[table];
-  table_operations.emplace(type, rid);
+  if (table_operations.emplace(type, rid).second) {
+    table->add_pending_operations(1);
+  }
 }
 
 void Trx::delete_operation(Table *table, const RID &rid) {
@@ -114,7 +116,9 @@ void Trx::delete_operation(Table *table, const RID &rid) {
   }
 
   Operation tmp(Operation::Type::UNDEFINED, rid);
-  table_operations_iter->second.erase(tmp);
+  if (table_operations_iter->second.erase(tmp) > 0) {
+    table->add_pending_operations(-1);
+  }
 }
 
 RC Trx::commit() {
@@ -155,6 +159,10 @@ RC Trx::commit() {
     }
   }
 
+  for (const auto &table_operations: operations_) {
+    table_operations.first->increase_data_version();
+    table_operations.first->add_pending_operations(-(int)table_operations.second.size());
+  }
   operations_.clear();
   trx_id_ = 0;
   return rc;
@@ -198,6 +206,10 @@ RC Trx::rollback() {
     }
   }
 
+  for (const auto &table_operations: operations_) {
+    table_operations.first->increase_data_version();
+    table_operations.first->add_pending_operations(-(int)table_operations.second.size());
+  }
   operations_.clear();
   trx_id_ = 0;
   return rc;
@@ -227,6 +239,8 @@ bool Trx::is_visible(Table *table, const Record *record) {
 }
 
 void Trx::init_trx_info(Table *table, Record &record) {
+  // 事务的第一条插入也要写入事务号，否则记录看起来像是已经提交的
+  start_if_not_started();
   set_record_trx_id(table, record, trx_id_, false);
 }
 
@@ -0,0 +1,379 @@
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FILTER_KERNEL_X86
+#endif
+
+#include "util/filter_kernel.h"
+
+namespace {
+
+// 与 sub < 1e-6 && sub > -1e-6 (double比较)等价的float阈值：不小于1e-6的最小float
+float float_epsilon() {
+  float epsilon = (float)1e-6;
+  if ((double)epsilon < 1e-6) {
+    epsilon = nextafterf(epsilon, 1.0f);
+  }
+  return epsilon;
+}
+
+const float FLOAT_EPSILON = float_epsilon();
+
+inline void clear_bit(uint8_t *bitmap, int index) {
+  bitmap[index >> 3] &= (uint8_t)~(1 << (index & 7));
+}
+
+inline bool bit_set(const uint8_t *bitmap, int index) {
+  return (bitmap[index >> 3] >> (index & 7)) & 1;
+}
+
+inline bool int_match(int value, CompOp op, int constant) {
+  switch (op) {
+    case EQUAL_TO:    return value == constant;
+    case NOT_EQUAL:   return value != constant;
+    case LESS_THAN:   return value < constant;
+    case LESS_EQUAL:  return value <= constant;
+    case GREAT_THAN:  return value > constant;
+    case GREAT_EQUAL: return value >= constant;
+    default:          return false;
+  }
+}
+
+inline bool float_match(float value, CompOp op, float constant) {
+  float sub = value - constant;
+  switch (op) {
+    case EQUAL_TO:    return sub < FLOAT_EPSILON && sub > -FLOAT_EPSILON;
+    case NOT_EQUAL:   return !(sub < FLOAT_EPSILON && sub > -FLOAT_EPSILON);
+    case LESS_THAN:   return sub <= -FLOAT_EPSILON;
+    case LESS_EQUAL:  return sub < FLOAT_EPSILON;
+    case GREAT_THAN:  return sub >= FLOAT_EPSILON;
+    case GREAT_EQUAL: return sub > -FLOAT_EPSILON;
+    default:          return false;
+  }
+}
+
+inline bool chars_match(const char *value, CompOp op, const char *constant, int len) {
+  bool equal = memcmp(value, constant, len) == 0;
+  return op == EQUAL_TO ? equal : !equal;
+}
+
+void filter_int_scalar(const int *values, int begin, int n, CompOp op, int constant, uint8_t *bitmap) {
+  for (int i = begin; i < n; i++) {
+    if (bit_set(bitmap, i) && !int_match(values[i], op, constant)) {
+      clear_bit(bitmap, i);
+    }
+  }
+}
+
+void filter_float_scalar(const float *values, int begin, int n, CompOp op, float constant, uint8_t *bitmap) {
+  for (int i = begin; i < n; i++) {
+    if (bit_set(bitmap, i) && !float_match(values[i], op, constant)) {
+      clear_bit(bitmap, i);
+    }
+  }
+}
+
+void filter_chars_scalar(const char *values, int width, int begin, int n, CompOp op, const char *constant, int len,
+                         uint8_t *bitmap) {
+  for (int i = begin; i < n; i++) {
+    if (bit_set(bitmap, i) && !chars_match(values + (long)i * width, op, constant, len)) {
+      clear_bit(bitmap, i);
+    }
+  }
+}
+
+/**
+ * 整数比较统一成 eq(v, c) 或 gt(a, b) 两种，再按需要取反
+ */
+struct IntCompare {
+  bool equal;   // 用 == 比较
+  bool swap;    // gt(c, v)
+  bool negate;  // 结果取反
+};
+
+IntCompare int_compare_of(CompOp op) {
+  switch (op) {
+    case EQUAL_TO:    return {true, false, false};
+    case NOT_EQUAL:   return {true, false, true};
+    case GREAT_THAN:  return {false, false, false};
+    case LESS_EQUAL:  return {false, false, true};
+    case LESS_THAN:   return {false, true, false};
+    case GREAT_EQUAL: return {false, true, true};
+    default:          return {true, false, false};
+  }
+}
+
+#ifdef FILTER_KERNEL_X86
+
+void filter_int_sse2(const int *values, int n, CompOp op, int constant, uint8_t *bitmap) {
+  const IntCompare compare = int_compare_of(op);
+  const __m128i c = _mm_set1_epi32(constant);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    if (bitmap[i >> 3] == 0) {
+      continue;
+    }
+    __m128i lo = _mm_loadu_si128((const __m128i *)(values + i));
+    __m128i hi = _mm_loadu_si128((const __m128i *)(values + i + 4));
+    __m128i mlo, mhi;
+    if (compare.equal) {
+      mlo = _mm_cmpeq_epi32(lo, c);
+      mhi = _mm_cmpeq_epi32(hi, c);
+    } else if (compare.swap) {
+      mlo = _mm_cmpgt_epi32(c, lo);
+      mhi = _mm_cmpgt_epi32(c, hi);
+    } else {
+      mlo = _mm_cmpgt_epi32(lo, c);
+      mhi = _mm_cmpgt_epi32(hi, c);
+    }
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(mlo)) | (_mm_movemask_ps(_mm_castsi128_ps(mhi)) << 4);
+    if (compare.negate) {
+      mask = ~mask;
+    }
+    bitmap[i >> 3] &= (uint8_t)mask;
+  }
+  filter_int_scalar(values, i, n, op, constant, bitmap);
+}
+
+__attribute__((target("avx2")))
+void filter_int_avx2(const int *values, int n, CompOp op, int constant, uint8_t *bitmap) {
+  const IntCompare compare = int_compare_of(op);
+  const __m256i c = _mm256_set1_epi32(constant);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    if (bitmap[i >> 3] == 0) {
+      continue;
+    }
+    __m256i v = _mm256_loadu_si256((const __m256i *)(values + i));
+    __m256i m;
+    if (compare.equal) {
+      m = _mm256_cmpeq_epi32(v, c);
+    } else if (compare.swap) {
+      m = _mm256_cmpgt_epi32(c, v);
+    } else {
+      m = _mm256_cmpgt_epi32(v, c);
+    }
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+    if (compare.negate) {
+      mask = ~mask;
+    }
+    bitmap[i >> 3] &= (uint8_t)mask;
+  }
+  filter_int_scalar(values, i, n, op, constant, bitmap);
+}
+
+inline int float_mask_sse(__m128 sub, CompOp op, __m128 epsilon, __m128 neg_epsilon) {
+  switch (op) {
+    case EQUAL_TO:
+      return _mm_movemask_ps(_mm_and_ps(_mm_cmplt_ps(sub, epsilon), _mm_cmpgt_ps(sub, neg_epsilon)));
+    case NOT_EQUAL:
+      return ~_mm_movemask_ps(_mm_and_ps(_mm_cmplt_ps(sub, epsilon), _mm_cmpgt_ps(sub, neg_epsilon))) & 0xF;
+    case LESS_THAN:   return _mm_movemask_ps(_mm_cmple_ps(sub, neg_epsilon));
+    case LESS_EQUAL:  return _mm_movemask_ps(_mm_cmplt_ps(sub, epsilon));
+    case GREAT_THAN:  return _mm_movemask_ps(_mm_cmpge_ps(sub, epsilon));
+    case GREAT_EQUAL: return _mm_movemask_ps(_mm_cmpgt_ps(sub, neg_epsilon));
+    default:          return 0;
+  }
+}
+
+void filter_float_sse2(const float *values, int n, CompOp op, float constant, uint8_t *bitmap) {
+  const __m128 c = _mm_set1_ps(constant);
+  const __m128 epsilon = _mm_set1_ps(FLOAT_EPSILON);
+  const __m128 neg_epsilon = _mm_set1_ps(-FLOAT_EPSILON);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    if (bitmap[i >> 3] == 0) {
+      continue;
+    }
+    __m128 lo = _mm_sub_ps(_mm_loadu_ps(values + i), c);
+    __m128 hi = _mm_sub_ps(_mm_loadu_ps(values + i + 4), c);
+    int mask = float_mask_sse(lo, op, epsilon, neg_epsilon) | (float_mask_sse(hi, op, epsilon, neg_epsilon) << 4);
+    bitmap[i >> 3] &= (uint8_t)mask;
+  }
+  filter_float_scalar(values, i, n, op, constant, bitmap);
+}
+
+__attribute__((target("avx2")))
+inline int float_mask_avx(__m256 sub, CompOp op, __m256 epsilon, __m256 neg_epsilon) {
+  switch (op) {
+    case EQUAL_TO:
+      return _mm256_movemask_ps(
+          _mm256_and_ps(_mm256_cmp_ps(sub, epsilon, _CMP_LT_OQ), _mm256_cmp_ps(sub, neg_epsilon, _CMP_GT_OQ)));
+    case NOT_EQUAL:
+      return ~_mm256_movemask_ps(
+          _mm256_and_ps(_mm256_cmp_ps(sub, epsilon, _CMP_LT_OQ), _mm256_cmp_ps(sub, neg_epsilon, _CMP_GT_OQ)));
+    case LESS_THAN:   return _mm256_movemask_ps(_mm256_cmp_ps(sub, neg_epsilon, _CMP_LE_OQ));
+    case LESS_EQUAL:  return _mm256_movemask_ps(_mm256_cmp_ps(sub, epsilon, _CMP_LT_OQ));
+    case GREAT_THAN:  return _mm256_movemask_ps(_mm256_cmp_ps(sub, epsilon, _CMP_GE_OQ));
+    case GREAT_EQUAL: return _mm256_movemask_ps(_mm256_cmp_ps(sub, neg_epsilon, _CMP_GT_OQ));
+    default:          return 0;
+  }
+}
+
+__attribute__((target("avx2")))
+void filter_float_avx2(const float *values, int n, CompOp op, float constant, uint8_t *bitmap) {
+  const __m256 c = _mm256_set1_ps(constant);
+  const __m256 epsilon = _mm256_set1_ps(FLOAT_EPSILON);
+  const __m256 neg_epsilon = _mm256_set1_ps(-FLOAT_EPSILON);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    if (bitmap[i >> 3] == 0) {
+      continue;
+    }
+    __m256 sub = _mm256_sub_ps(_mm256_loadu_ps(values + i), c);
+    bitmap[i >> 3] &= (uint8_t)float_mask_avx(sub, op, epsilon, neg_epsilon);
+  }
+  filter_float_scalar(values, i, n, op, constant, bitmap);
+}
+
+// 16字节定长值：一次比较一个值
+void filter_chars_sse2(const char *values, int width, int n, CompOp op, const char *constant, int len,
+                       uint8_t *bitmap) {
+  if (width != 16) {
+    filter_chars_scalar(values, width, 0, n, op, constant, len, bitmap);
+    return;
+  }
+  char padded[16] = {0};
+  memcpy(padded, constant, len);
+  const __m128i c = _mm_loadu_si128((const __m128i *)padded);
+  const int len_mask = len >= 16 ? 0xFFFF : (1 << len) - 1;
+  for (int i = 0; i < n; i++) {
+    if (!bit_set(bitmap, i)) {
+      continue;
+    }
+    __m128i v = _mm_loadu_si128((const __m128i *)(values + i * 16));
+    bool equal = (_mm_movemask_epi8(_mm_cmpeq_epi8(v, c)) & len_mask) == len_mask;
+    if (equal != (op == EQUAL_TO)) {
+      clear_bit(bitmap, i);
+    }
+  }
+}
+
+// 32字节定长值用AVX2，16字节的仍然用SSE2
+__attribute__((target("avx2")))
+void filter_chars_avx2(const char *values, int width, int n, CompOp op, const char *constant, int len,
+                       uint8_t *bitmap) {
+  if (width != 32) {
+    filter_chars_sse2(values, width, n, op, constant, len, bitmap);
+    return;
+  }
+  char padded[32] = {0};
+  memcpy(padded, constant, len);
+  const __m256i c = _mm256_loadu_si256((const __m256i *)padded);
+  const uint32_t len_mask = len >= 32 ? 0xFFFFFFFFu : (1u << len) - 1;
+  for (int i = 0; i < n; i++) {
+    if (!bit_set(bitmap, i)) {
+      continue;
+    }
+    __m256i v = _mm256_loadu_si256((const __m256i *)(values + i * 32));
+    uint32_t eq = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, c));
+    bool equal = (eq & len_mask) == len_mask;
+    if (equal != (op == EQUAL_TO)) {
+      clear_bit(bitmap, i);
+    }
+  }
+}
+
+#endif  // FILTER_KERNEL_X86
+
+bool isa_supported(FilterKernelIsa isa) {
+  switch (isa) {
+    case KERNEL_SCALAR:
+      return true;
+#ifdef FILTER_KERNEL_X86
+    case KERNEL_SSE2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("sse2");
+    case KERNEL_AVX2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+FilterKernelIsa detect_isa() {
+  if (isa_supported(KERNEL_AVX2)) {
+    return KERNEL_AVX2;
+  }
+  if (isa_supported(KERNEL_SSE2)) {
+    return KERNEL_SSE2;
+  }
+  return KERNEL_SCALAR;
+}
+
+FilterKernelIsa current_isa = detect_isa();
+
+}  // namespace
+
+void filter_int_kernel(const int *values, int n, CompOp op, int constant, uint8_t *bitmap) {
+  switch (current_isa) {
+#ifdef FILTER_KERNEL_X86
+    case KERNEL_AVX2:
+      filter_int_avx2(values, n, op, constant, bitmap);
+      return;
+    case KERNEL_SSE2:
+      filter_int_sse2(values, n, op, constant, bitmap);
+      return;
+#endif
+    default:
+      filter_int_scalar(values, 0, n, op, constant, bitmap);
+      return;
+  }
+}
+
+void filter_float_kernel(const float *values, int n, CompOp op, float constant, uint8_t *bitmap) {
+  switch (current_isa) {
+#ifdef FILTER_KERNEL_X86
+    case KERNEL_AVX2:
+      filter_float_avx2(values, n, op, constant, bitmap);
+      return;
+    case KERNEL_SSE2:
+      filter_float_sse2(values, n, op, constant, bitmap);
+      return;
+#endif
+    default:
+      filter_float_scalar(values, 0, n, op, constant, bitmap);
+      return;
+  }
+}
+
+void filter_chars_kernel(const char *values, int width, int n, CompOp op, const char *constant, int len,
+                         uint8_t *bitmap) {
+  switch (current_isa) {
+#ifdef FILTER_KERNEL_X86
+    case KERNEL_AVX2:
+      filter_chars_avx2(values, width, n, op, constant, len, bitmap);
+      return;
+    case KERNEL_SSE2:
+      filter_chars_sse2(values, width, n, op, constant, len, bitmap);
+      return;
+#endif
+    default:
+      filter_chars_scalar(values, width, 0, n, op, constant, len, bitmap);
+      return;
+  }
+}
+
+FilterKernelIsa filter_kernel_isa() {
+  return current_isa;
+}
+
+const char *filter_kernel_isa_name(FilterKernelIsa isa) {
+  switch (isa) {
+    case KERNEL_AVX2: return "avx2";
+    case KERNEL_SSE2: return "sse2";
+    default:          return "scalar";
+  }
+}
+
+bool set_filter_kernel_isa(FilterKernelIsa isa) {
+  if (!isa_supported(isa)) {
+    return false;
+  }
+  current_isa = isa;
+  return true;
+}
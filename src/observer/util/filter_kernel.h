@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "sql/parser/parse_defs.h"
+
+/**
+ * 批量比较的过滤kernel，把n个值与常量比较。
+ * bitmap为选择位图，第i位对应第i个值(低位在前，与common::Bitmap相同)，
+ * kernel只会把不满足条件的位清0，已经为0的位保持不变，所以多个条件可以依次作用在同一个位图上。
+ * op只能是 EQUAL_TO ~ GREAT_THAN，语义与DefaultConditionFilter逐条比较的结果相同。
+ * 运行时通过CPUID选择AVX2/SSE2实现，其它平台使用标量实现
+ */
+void filter_int_kernel(const int *values, int n, CompOp op, int constant, uint8_t *bitmap);
+// 浮点数按照1e-6的误差比较
+void filter_float_kernel(const float *values, int n, CompOp op, float constant, uint8_t *bitmap);
+/**
+ * values为n个连续存放、每个width字节的定长值，比较前len个字节是否与constant相同。
+ * op只能是EQUAL_TO或NOT_EQUAL。len包含constant结尾的'\0'时，结果与strcmp相同
+ */
+void filter_chars_kernel(const char *values, int width, int n, CompOp op, const char *constant, int len,
+                         uint8_t *bitmap);
+
+enum FilterKernelIsa {
+  KERNEL_SCALAR,
+  KERNEL_SSE2,
+  KERNEL_AVX2,
+};
+
+FilterKernelIsa filter_kernel_isa();
+const char *filter_kernel_isa_name(FilterKernelIsa isa);
+/**
+ * 指定使用的实现，CPU不支持时返回false。用于测试和性能对比
+ */
+bool set_filter_kernel_isa(FilterKernelIsa isa);
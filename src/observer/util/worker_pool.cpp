@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <atomic>
+
+#include "util/worker_pool.h"
+#include "common/log/log.h"
+#include "common/os/os.h"
+
+struct WorkerPool::Job {
+  int task_num;
+  const std::function<RC(int, int)> *task;
+  std::atomic<int> next_task{0};
+  std::atomic<int> next_worker{1};  // 0是调用线程
+  std::atomic<bool> failed{false};
+  RC rc = RC::SUCCESS;              // 第一个失败任务的错误码，只由把failed置为true的线程写入
+  int running = 0;                  // 正在执行的工作线程数，由mutex_保护
+  std::condition_variable done;
+};
+
+WorkerPool &WorkerPool::instance() {
+  static WorkerPool pool(std::max(1, (int)common::getCpuNum() - 1));
+  return pool;
+}
+
+WorkerPool::WorkerPool(int thread_num) {
+  for (int i = 0; i < thread_num; i++) {
+    threads_.emplace_back(&WorkerPool::thread_main, this);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  cond_.notify_all();
+  for (std::thread &thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerPool::work(Job &job, int worker) {
+  while (!job.failed.load(std::memory_order_relaxed)) {
+    int task = job.next_task.fetch_add(1);
+    if (task >= job.task_num) {
+      break;
+    }
+    RC rc = (*job.task)(worker, task);
+    if (rc != RC::SUCCESS && !job.failed.exchange(true)) {
+      job.rc = rc;
+    }
+  }
+}
+
+void WorkerPool::thread_main() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cond_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+    if (stop_) {
+      return;
+    }
+    std::shared_ptr<Job> job = queue_.front();
+    queue_.pop_front();
+    job->running++;
+    lock.unlock();
+
+    work(*job, job->next_worker.fetch_add(1));
+
+    lock.lock();
+    if (--job->running == 0) {
+      job->done.notify_all();
+    }
+  }
+}
+
+RC WorkerPool::run(int dop, int task_num, const std::function<RC(int worker, int task)> &task) {
+  dop = std::min(std::min(dop, max_dop()), task_num);
+  if (dop <= 1) {
+    for (int i = 0; i < task_num; i++) {
+      RC rc = task(0, i);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+    }
+    return RC::SUCCESS;
+  }
+
+  std::shared_ptr<Job> job = std::make_shared<Job>();
+  job->task_num = task_num;
+  job->task = &task;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (int i = 1; i < dop; i++) {
+      queue_.push_back(job);
+    }
+  }
+  cond_.notify_all();
+
+  work(*job, 0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  // 线程池忙于其它查询时，还没有被领取的部分不再需要，由调用线程完成即可
+  queue_.erase(std::remove(queue_.begin(), queue_.end(), job), queue_.end());
+  job->done.wait(lock, [&job]() { return job->running == 0; });
+  if (job->failed) {
+    LOG_WARN("Parallel job failed. rc=%d:%s", job->rc, strrc(job->rc));
+  }
+  return job->rc;
+}
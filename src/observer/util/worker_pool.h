@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rc.h"
+
+/**
+ * 查询内并行使用的线程池，与seda的SQLThreads相互独立。
+ * run把一组任务(morsel)交给调用线程和dop-1个工作线程执行，
+ * 各线程从同一个计数器中领取下一个任务编号，直到任务全部领完，先完成的线程自然多做一些
+ */
+class WorkerPool {
+public:
+  static WorkerPool &instance();
+
+  explicit WorkerPool(int thread_num);
+  ~WorkerPool();
+
+  /**
+   * 并行执行task_num个任务，所有任务结束后返回。
+   * task的参数为线程编号[0, dop)和任务编号[0, task_num)，调用线程的编号为0。
+   * 某个任务失败后不再领取新任务，返回第一个失败的错误码
+   */
+  RC run(int dop, int task_num, const std::function<RC(int worker, int task)> &task);
+
+  /**
+   * 允许的最大并行度：工作线程数 + 调用线程
+   */
+  int max_dop() const { return (int)threads_.size() + 1; }
+
+private:
+  struct Job;
+  void thread_main();
+  static void work(Job &job, int worker);
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<std::shared_ptr<Job>> queue_;  // 每个元素让一个工作线程加入对应的job
+  bool stop_ = false;
+  std::vector<std::thread> threads_;
+};
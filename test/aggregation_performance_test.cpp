@@ -0,0 +1,191 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// group by的吞吐：count(*)、sum、min、max按一个int列分组，分别在1K和1M个分组下测试。
+// dop大于1时用ParallelAggregator并行聚合。
+// 另外用原来的std::map + TupleValue::compare实现跑一遍作为对比的基线
+// usage: aggregation_performance_test [row_num] [dop]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "sql/executor/aggregation_hash_table.h"
+#include "util/worker_pool.h"
+#include "perf_util.h"
+
+static const int BATCH = 64 * 1024;
+
+static std::shared_ptr<AggreDesc> make_desc(AggreType type, bool is_attr)
+{
+  std::shared_ptr<AggreDesc> desc(new AggreDesc());
+  desc->aggre_type = type;
+  desc->is_attr = is_attr;
+  desc->relation_name = nullptr;
+  desc->attr_name = nullptr;
+  desc->is_star = !is_attr;
+  desc->value = 1;
+  return desc;
+}
+
+/**
+ * 每行为(key, value)，key = i % group_num，value = i % 100。
+ * 数据按批生成，只统计聚合的时间
+ */
+static bool bench(long row_num, int group_num, int dop)
+{
+  std::vector<std::shared_ptr<AggreDesc>> descs = {
+      make_desc(COUNTS, false), make_desc(SUMS, true), make_desc(MINS, true), make_desc(MAXS, true)};
+  std::vector<int> key_index = {0};
+  std::vector<int> value_index = {-1, 1, 1, 1};
+
+  AggregationHashTable table;
+  table.init(descs);
+  ParallelAggregator aggregator(table, dop);
+
+  std::vector<Tuple> tuples;
+  double seconds = 0;
+  for (long begin = 0; begin < row_num; begin += BATCH) {
+    int n = (int)std::min<long>(BATCH, row_num - begin);
+    tuples.resize(n);
+    for (int i = 0; i < n; i++) {
+      long row = begin + i;
+      tuples[i] = Tuple();
+      tuples[i].add((int)(row % group_num));
+      tuples[i].add((int)(row % 100));
+    }
+    seconds += timing([&]() {
+      if (dop > 1) {
+        aggregator.aggregate(tuples, key_index, value_index);
+        return;
+      }
+      for (int i = 0; i < n; i++) {
+        table.insert_combine(tuples[i], key_index, value_index);
+      }
+    });
+  }
+  seconds += timing([&]() { aggregator.finish(); });
+  double sort_seconds = timing([&]() { table.sort_groups(); });
+
+  // 检查分组数以及count、sum的总和
+  double total_count = 0;
+  double total_sum = 0;
+  for (int i = 0; i < table.group_count(); i++) {
+    Tuple tuple;
+    table.output(i, tuple);
+    total_count += *(float *)tuple.get_pointer(1)->value_pointer();
+    total_sum += *(float *)tuple.get_pointer(2)->value_pointer();
+  }
+  double expect_sum = 0;
+  for (long row = 0; row < row_num; row++) {
+    expect_sum += row % 100;
+  }
+  int expect_groups = (int)std::min<long>(group_num, row_num);
+  // sum的结果是float，按相对误差比较
+  bool ok = table.group_count() == expect_groups && (long)total_count == row_num &&
+            (total_sum - expect_sum) <= expect_sum * 1e-4 && (expect_sum - total_sum) <= expect_sum * 1e-4;
+  printf("groups=%-8d rows=%ld  aggregate: %7.3fs %7.2fM rows/s  sort: %6.3fs%s\n", table.group_count(), row_num,
+      seconds, row_num / seconds / 1e6, sort_seconds, ok ? "" : "  MISMATCH");
+  return ok;
+}
+
+struct MapKey {
+  std::vector<std::shared_ptr<TupleValue>> group_bys;
+
+  bool operator<(const MapKey &other) const
+  {
+    for (size_t i = 0; i < group_bys.size(); i++) {
+      int ret = group_bys[i]->compare(*other.group_bys[i]);
+      if (ret != 0) {
+        return ret < 0;
+      }
+    }
+    return false;
+  }
+};
+
+/**
+ * 原来的聚合实现：key与聚合值都是TupleValue，用std::map保存分组。
+ * 只实现bench中用到的count(*)、sum、min、max
+ */
+static bool map_baseline(long row_num, int group_num)
+{
+  std::map<MapKey, std::vector<std::shared_ptr<TupleValue>>> groups;
+
+  std::vector<Tuple> tuples;
+  double seconds = 0;
+  for (long begin = 0; begin < row_num; begin += BATCH) {
+    int n = (int)std::min<long>(BATCH, row_num - begin);
+    tuples.resize(n);
+    for (int i = 0; i < n; i++) {
+      long row = begin + i;
+      tuples[i] = Tuple();
+      tuples[i].add((int)(row % group_num));
+      tuples[i].add((int)(row % 100));
+    }
+    seconds += timing([&]() {
+      for (int i = 0; i < n; i++) {
+        MapKey key;
+        key.group_bys.push_back(tuples[i].get_pointer(0));
+        auto iter = groups.find(key);
+        if (iter == groups.end()) {
+          std::vector<std::shared_ptr<TupleValue>> init = {std::make_shared<FloatValue>(0),
+              std::make_shared<FloatValue>(0), std::make_shared<NullValue>(), std::make_shared<NullValue>()};
+          iter = groups.emplace(std::move(key), std::move(init)).first;
+        }
+        std::vector<std::shared_ptr<TupleValue>> &aggregates = iter->second;
+        const std::shared_ptr<TupleValue> &value = tuples[i].get_pointer(1);
+        aggregates[0]->plus(1);
+        aggregates[1]->plus(value->value());
+        if (aggregates[2]->Type() == UNDEFINED || value->compare(*aggregates[2]) < 0) {
+          aggregates[2] = value;
+        }
+        if (aggregates[3]->Type() == UNDEFINED || value->compare(*aggregates[3]) > 0) {
+          aggregates[3] = value;
+        }
+      }
+    });
+  }
+
+  double total_count = 0;
+  for (auto &pair : groups) {
+    total_count += pair.second[0]->value();
+  }
+  int expect_groups = (int)std::min<long>(group_num, row_num);
+  bool ok = (int)groups.size() == expect_groups && (long)total_count == row_num;
+  printf("groups=%-8d rows=%ld  std::map: %7.3fs %7.2fM rows/s%s\n", (int)groups.size(), row_num, seconds,
+      row_num / seconds / 1e6, ok ? "" : "  MISMATCH");
+  return ok;
+}
+
+int main(int argc, char *argv[])
+{
+  long row_num = 10 * 1000 * 1000;
+  int dop = 1;
+  if (argc >= 2) {
+    row_num = atol(argv[1]);
+  }
+  if (argc >= 3) {
+    dop = std::min(atoi(argv[2]), WorkerPool::instance().max_dop());
+  }
+  printf("dop=%d\n", dop);
+
+  bool ok = bench(row_num, 1000, dop);
+  ok = map_baseline(row_num, 1000) && ok;
+  ok = bench(row_num, 1000 * 1000, dop) && ok;
+  ok = map_baseline(row_num, 1000 * 1000) && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// B+树多线程插入/点查性能测试
+// usage: bplus_tree_performance_test [key_num] [max_threads]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/common/bplus_tree.h"
+#include "perf_util.h"
+
+static int key_num = 100000;
+
+static double run_threads(int thread_num, const std::function<void(int)> &func)
+{
+  return timing([&]() {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_num; i++) {
+      threads.emplace_back(func, i);
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  });
+}
+
+static bool bench(int thread_num)
+{
+  std::string file_name = "/tmp/bplus_tree_performance_test." + std::to_string(getpid()) + ".index";
+  ::unlink(file_name.c_str());
+
+  BplusTreeHandler handler;
+  RC rc = handler.create(file_name.c_str(), INTS, sizeof(int));
+  if (rc != RC::SUCCESS) {
+    printf("failed to create index file %s. rc=%d\n", file_name.c_str(), rc);
+    return false;
+  }
+
+  // 每个线程负责一段互不重叠的key，打乱顺序后插入，避免所有线程都挤在最右边的叶子上
+  std::vector<std::vector<int>> thread_keys(thread_num);
+  for (int i = 0; i < key_num; i++) {
+    thread_keys[i % thread_num].push_back(i);
+  }
+  std::mt19937 random(0);
+  for (auto &keys : thread_keys) {
+    std::shuffle(keys.begin(), keys.end(), random);
+  }
+
+  std::atomic<int> failed(0);
+  double insert_seconds = run_threads(thread_num, [&](int idx) {
+    for (int key : thread_keys[idx]) {
+      RID rid;
+      rid.page_num = key / 100 + 1;
+      rid.slot_num = key % 100;
+      if (handler.insert_entry((const char *)&key, &rid) != RC::SUCCESS) {
+        failed++;
+      }
+    }
+  });
+
+  double lookup_seconds = run_threads(thread_num, [&](int idx) {
+    for (int key : thread_keys[idx]) {
+      BplusTreeScanner scanner(handler);
+      RID rid;
+      if (scanner.open(EQUAL_TO, (const char *)&key) != RC::SUCCESS ||
+          scanner.next_entry(&rid) != RC::SUCCESS ||
+          rid.page_num != key / 100 + 1 || rid.slot_num != key % 100) {
+        failed++;
+      }
+      scanner.close();
+    }
+  });
+
+  printf("threads=%-2d insert: %8.3fs %10.0f ops/s    lookup: %8.3fs %10.0f ops/s    failed=%d\n",
+      thread_num, insert_seconds, key_num / insert_seconds, lookup_seconds, key_num / lookup_seconds, failed.load());
+
+  handler.close();
+  theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+  return failed.load() == 0;
+}
+
+int main(int argc, char *argv[])
+{
+  int max_threads = 8;
+  if (argc >= 2) {
+    key_num = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    max_threads = atoi(argv[2]);
+  }
+
+  bool ok = true;
+  for (int thread_num = 1; thread_num <= max_threads; thread_num *= 2) {
+    ok = bench(thread_num) && ok;
+  }
+  return ok ? 0 : 1;
+}
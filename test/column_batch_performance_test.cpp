@@ -0,0 +1,194 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// 扫描+过滤+投影：行格式TupleSet与列存ColumnBatch的性能对比
+// select id, name from t where v < row_num / 2
+// usage: column_batch_performance_test [row_num] [rounds]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "common/os/path.h"
+#include "storage/common/table.h"
+#include "storage/common/meta_util.h"
+#include "sql/executor/column_batch.h"
+#include "sql/executor/executor.h"
+#include "perf_util.h"
+
+static const int BATCH_SIZE = Executor::BATCH_SIZE;
+
+static void record_reader(const char *data, void *context)
+{
+  TupleRecordConverter *converter = (TupleRecordConverter *)context;
+  converter->add_record(data);
+}
+
+// 旧的执行路径：整表读成TupleSet，再逐个Tuple比较、投影
+static long row_path(Table *table, int threshold)
+{
+  TupleSchema schema;
+  TupleSchema::from_table(table, schema);
+  TupleSet tuple_set;
+  tuple_set.set_schema(schema);
+  TupleRecordConverter converter(table, tuple_set);
+  table->scan_record(nullptr, nullptr, -1, &converter, record_reader);
+
+  std::vector<int> project = {0, 2};
+  TupleSet output;
+  long checksum = 0;
+  for (const Tuple &tuple : tuple_set.tuples()) {
+    void *v = tuple.get_pointer(1)->value_pointer();
+    if (v == nullptr || *(int *)v >= threshold) {
+      continue;
+    }
+    Tuple result;
+    result.add(tuple, project);
+    checksum += *(int *)result.get_pointer(0)->value_pointer();
+    output.add(std::move(result));
+  }
+  return checksum + output.size();
+}
+
+// 列存路径：按批次把记录直接解码到各列，过滤只修改selection，投影只复制选中的行
+static long column_path(Table *table, int threshold)
+{
+  TupleSchema schema;
+  TupleSchema::from_table(table, schema);
+  TupleSchema output_schema;
+  output_schema.add(schema.field(0).type(), schema.field(0).table_name(), schema.field(0).field_name());
+  output_schema.add(schema.field(2).type(), schema.field(2).table_name(), schema.field(2).field_name());
+
+  TableScanner scanner;
+  if (scanner.open(table, nullptr, nullptr) != RC::SUCCESS) {
+    return -1;
+  }
+  ColumnBatch batch;
+  ColumnBatch output;
+  output.init(output_schema);
+  long checksum = 0;
+  long rows = 0;
+  Record record;
+  bool eof = false;
+  while (!eof) {
+    batch.init(schema);
+    TupleRecordConverter converter(table, batch);
+    while (batch.row_count() < BATCH_SIZE) {
+      if (scanner.next(&record) != RC::SUCCESS) {
+        eof = true;
+        break;
+      }
+      converter.add_record(record.data);
+    }
+
+    const ColumnVector &v = batch.column(1);
+    const int *values = v.int_data();
+    std::vector<int> &selection = batch.selection();
+    selection.clear();
+    for (int row = 0; row < batch.row_count(); row++) {
+      if (values[row] < threshold && !v.is_null(row)) {
+        selection.push_back(row);
+      }
+    }
+
+    output.clear();
+    for (int row : selection) {
+      output.column(0).append_from(batch.column(0), row);
+      output.column(1).append_from(batch.column(2), row);
+      output.finish_row();
+    }
+    const int *ids = output.column(0).int_data();
+    for (int i = 0; i < output.row_count(); i++) {
+      checksum += ids[i];
+    }
+    rows += output.row_count();
+  }
+  scanner.close();
+  return checksum + rows;
+}
+
+int main(int argc, char *argv[])
+{
+  int row_num = 200000;
+  int rounds = 5;
+  if (argc >= 2) {
+    row_num = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    rounds = atoi(argv[2]);
+  }
+
+  std::string base_dir = "/tmp/column_batch_performance_test." + std::to_string(getpid());
+  common::check_directory(base_dir);
+  const char *table_name = "t";
+  std::string meta_file = table_meta_file(base_dir.c_str(), table_name);
+  AttrInfo attributes[3] = {
+      {(char *)"id", INTS, sizeof(int), 0},
+      {(char *)"v", INTS, sizeof(int), 0},
+      {(char *)"name", CHARS, 16, 0},
+  };
+  Table table;
+  RC rc = table.create(meta_file.c_str(), table_name, base_dir.c_str(), 3, attributes);
+  if (rc != RC::SUCCESS) {
+    printf("failed to create table in %s. rc=%d\n", base_dir.c_str(), rc);
+    return 1;
+  }
+
+  for (int i = 0; i < row_num; i++) {
+    Value values[3];
+    value_init_integer(&values[0], i);
+    value_init_integer(&values[1], (int)((i * 2654435761u) % row_num));
+    std::string name = "name" + std::to_string(i % 1000);
+    value_init_string(&values[2], name.c_str());
+    rc = table.insert_record(nullptr, 3, values);
+    for (Value &value : values) {
+      value_destroy(&value);
+    }
+    if (rc != RC::SUCCESS) {
+      printf("failed to insert record. rc=%d\n", rc);
+      return 1;
+    }
+  }
+
+  int threshold = row_num / 2;
+  long row_result = 0;
+  long column_result = 0;
+  double row_seconds = timing([&]() {
+    for (int i = 0; i < rounds; i++) {
+      row_result = row_path(&table, threshold);
+    }
+  });
+  double column_seconds = timing([&]() {
+    for (int i = 0; i < rounds; i++) {
+      column_result = column_path(&table, threshold);
+    }
+  });
+
+  printf("rows=%d rounds=%d\n", row_num, rounds);
+  printf("tuple set   : %8.3fs %12.0f rows/s\n", row_seconds, (double)row_num * rounds / row_seconds);
+  printf("column batch: %8.3fs %12.0f rows/s    speedup=%.2f\n",
+      column_seconds, (double)row_num * rounds / column_seconds, row_seconds / column_seconds);
+
+  bool ok = row_result == column_result;
+  if (!ok) {
+    printf("result mismatch: tuple set=%ld column batch=%ld\n", row_result, column_result);
+  }
+  table.sync();
+  std::string rm = "rm -rf " + base_dir;
+  if (system(rm.c_str()) != 0) {
+    printf("failed to remove %s\n", base_dir.c_str());
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// 表达式 (k+1)*(f-1)/(2*4) + id*3 - k/f 用AstUtil::Calculate逐行解释执行，
+// 与CompiledExpression逐行求值、按批求值的性能对比，同时检查结果是否一致
+// usage: expression_performance_test [row_num]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <random>
+#include <vector>
+
+#include "sql/executor/expression.h"
+#include "sql/executor/util.h"
+#include "perf_util.h"
+
+static ast *attr(const char *name)
+{
+  RelAttr rel_attr;
+  relation_attr_init(&rel_attr, "t", name);
+  return newattrNode(&rel_attr);
+}
+
+static ast *int_value(int v)
+{
+  Value value;
+  value_init_integer(&value, v);
+  return newvalNode(&value);
+}
+
+static ast *build_ast()
+{
+  ast *left = newast(MULN, newast(ADDN, attr("k"), int_value(1)), newast(SUBN, attr("f"), int_value(1)));
+  left = newast(DIVN, left, newast(MULN, int_value(2), int_value(4)));
+  ast *middle = newast(MULN, attr("id"), int_value(3));
+  return newast(SUBN, newast(ADDN, left, middle), newast(DIVN, attr("k"), attr("f")));
+}
+
+// 表(id int, k int, f float)，f不为0
+static void generate(int row_num, std::vector<Tuple> &tuples)
+{
+  std::mt19937 random(0);
+  tuples.clear();
+  for (int i = 0; i < row_num; i++) {
+    Tuple tuple;
+    tuple.add(i);
+    tuple.add((int)(random() % 1000));
+    tuple.add((float)(random() % 400 + 1) / 8.0f);
+    tuples.push_back(std::move(tuple));
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  int row_num = 1000000;
+  if (argc >= 2) {
+    row_num = atoi(argv[1]);
+  }
+  printf("rows=%d\n", row_num);
+
+  std::vector<Tuple> tuples;
+  generate(row_num, tuples);
+  std::map<std::string, std::map<std::string, int>> field_index;
+  field_index["t"]["id"] = 0;
+  field_index["t"]["k"] = 1;
+  field_index["t"]["f"] = 2;
+  ast *a = build_ast();
+
+  std::vector<float> expect(row_num);
+  double seconds = timing([&]() {
+    for (int i = 0; i < row_num; i++) {
+      std::shared_ptr<TupleValue> value;
+      AstUtil::Calculate(value, tuples[i], field_index, a);
+      expect[i] = value->value();
+    }
+  });
+  printf("AstUtil::Calculate:          %7.3fs %8.2fM rows/s\n", seconds, row_num / seconds / 1e6);
+
+  CompiledExpression exp;
+  RC rc = exp.compile(a, field_index);
+  if (rc != RC::SUCCESS) {
+    printf("failed to compile expression. rc=%d:%s\n", rc, strrc(rc));
+    return 1;
+  }
+
+  bool ok = true;
+  std::vector<float> results(row_num);
+  seconds = timing([&]() {
+    for (int i = 0; i < row_num; i++) {
+      exp.evaluate(tuples[i], results[i]);
+    }
+  });
+  printf("CompiledExpression per row:  %7.3fs %8.2fM rows/s\n", seconds, row_num / seconds / 1e6);
+  if (results != expect) {
+    printf("  MISMATCH\n");
+    ok = false;
+  }
+
+  const int batch_size = 1024;
+  std::vector<const Tuple *> batch;
+  std::vector<float> batch_results;
+  std::vector<char> valid;
+  results.clear();
+  seconds = timing([&]() {
+    for (int begin = 0; begin < row_num; begin += batch_size) {
+      batch.clear();
+      for (int i = begin; i < row_num && i < begin + batch_size; i++) {
+        batch.push_back(&tuples[i]);
+      }
+      exp.evaluate(batch, batch_results, valid);
+      results.insert(results.end(), batch_results.begin(), batch_results.end());
+    }
+  });
+  printf("CompiledExpression by batch: %7.3fs %8.2fM rows/s\n", seconds, row_num / seconds / 1e6);
+  if (results != expect) {
+    printf("  MISMATCH\n");
+    ok = false;
+  }
+  return ok ? 0 : 1;
+}
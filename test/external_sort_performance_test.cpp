@@ -0,0 +1,144 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// ExternalSorter完全在内存中排序和写临时文件归并时的性能，与按TupleValue::compare做std::stable_sort对比，
+// 同时检查三种方式的结果是否一致
+// usage: external_sort_performance_test [row_num] [sort_buffer_size]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sql/executor/external_sort.h"
+#include "perf_util.h"
+
+// 表(id int, name char, score float)，按 score desc, name asc 排序
+static const std::vector<int> KEY_INDEX = {2, 1};
+static const std::vector<int> ORDERS = {1, 0};
+
+static void generate(int row_num, std::vector<Tuple> &tuples)
+{
+  std::mt19937 random(0);
+  tuples.clear();
+  for (int i = 0; i < row_num; i++) {
+    Tuple tuple;
+    tuple.add(i);
+    std::string name = "name" + std::to_string(random() % 1000);
+    tuple.add(name.c_str(), name.size());
+    if (i % 100 == 0) {
+      tuple.add_null();
+    } else {
+      // 分数只有几百种，有大量相同的排序key
+      tuple.add((float)((int)(random() % 500) - 250) / 4.0f);
+    }
+    tuples.push_back(std::move(tuple));
+  }
+}
+
+static bool tuple_less(const Tuple &lhs, const Tuple &rhs)
+{
+  for (size_t i = 0; i < KEY_INDEX.size(); i++) {
+    const std::shared_ptr<TupleValue> &left = lhs.get_pointer(KEY_INDEX[i]);
+    const std::shared_ptr<TupleValue> &right = rhs.get_pointer(KEY_INDEX[i]);
+    // null排在最前面
+    bool left_null = left->Type() == UNDEFINED;
+    bool right_null = right->Type() == UNDEFINED;
+    int ret = (left_null || right_null) ? (int)right_null - (int)left_null : left->compare(*right);
+    if (ret != 0) {
+      return ORDERS[i] == 0 ? ret < 0 : ret > 0;
+    }
+  }
+  return false;
+}
+
+static std::string to_string(const std::vector<Tuple> &tuples)
+{
+  std::stringstream ss;
+  for (const Tuple &tuple : tuples) {
+    for (int i = 0; i < tuple.size(); i++) {
+      tuple.get_pointer(i)->to_string(ss);
+      ss << '|';
+    }
+    ss << '\n';
+  }
+  return ss.str();
+}
+
+static bool external_sort(int row_num, size_t sort_buffer_size, std::string &result)
+{
+  std::vector<Tuple> tuples;
+  generate(row_num, tuples);
+  std::vector<Tuple> sorted;
+  int run_count = 0;
+  RC rc = RC::SUCCESS;
+  double seconds = timing([&]() {
+    ExternalSorter sorter(KEY_INDEX, ORDERS, sort_buffer_size);
+    for (Tuple &tuple : tuples) {
+      if (rc == RC::SUCCESS) {
+        rc = sorter.add(std::move(tuple));
+      }
+    }
+    if (rc == RC::SUCCESS) {
+      rc = sorter.finish();
+    }
+    Tuple tuple;
+    while (rc == RC::SUCCESS && (rc = sorter.next(tuple)) == RC::SUCCESS) {
+      sorted.push_back(std::move(tuple));
+    }
+    run_count = sorter.run_count();
+  });
+  if (rc != RC::RECORD_EOF) {
+    printf("external sort failed. rc=%d:%s\n", rc, strrc(rc));
+    return false;
+  }
+  printf("external sort buffer=%10zu runs=%4d: %7.3fs %8.2fM rows/s\n", sort_buffer_size, run_count, seconds,
+         row_num / seconds / 1e6);
+  result = to_string(sorted);
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  int row_num = 1000000;
+  size_t sort_buffer_size = 8 * 1024 * 1024;
+  if (argc >= 2) {
+    row_num = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    sort_buffer_size = atol(argv[2]);
+  }
+  printf("rows=%d\n", row_num);
+
+  std::vector<Tuple> tuples;
+  generate(row_num, tuples);
+  double seconds = timing([&]() { std::stable_sort(tuples.begin(), tuples.end(), tuple_less); });
+  printf("std::stable_sort by compare:           %7.3fs %8.2fM rows/s\n", seconds, row_num / seconds / 1e6);
+  std::string expect = to_string(tuples);
+  tuples.clear();
+
+  bool ok = true;
+  std::string result;
+  for (size_t buffer_size : {(size_t)1 << 40, sort_buffer_size}) {
+    if (!external_sort(row_num, buffer_size, result)) {
+      ok = false;
+    } else if (result != expect) {
+      printf("  MISMATCH\n");
+      ok = false;
+    }
+  }
+  return ok ? 0 : 1;
+}
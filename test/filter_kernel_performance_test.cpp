@@ -0,0 +1,122 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// 过滤kernel在标量/SSE2/AVX2实现下的性能，同时检查各实现的结果是否一致
+// usage: filter_kernel_performance_test [value_num] [rounds]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "util/filter_kernel.h"
+#include "perf_util.h"
+
+static const FilterKernelIsa ISAS[] = {KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2};
+static const CompOp OPS[] = {EQUAL_TO, NOT_EQUAL, LESS_THAN, LESS_EQUAL, GREAT_THAN, GREAT_EQUAL};
+
+static int count_bits(const std::vector<uint8_t> &bitmap)
+{
+  int count = 0;
+  for (uint8_t byte : bitmap) {
+    count += __builtin_popcount(byte);
+  }
+  return count;
+}
+
+/**
+ * 用每种实现跑同一个kernel，输出耗时并与标量实现的结果比较
+ */
+static bool bench(const char *name, int value_num, int rounds,
+    const std::function<void(std::vector<uint8_t> &bitmap)> &kernel)
+{
+  std::vector<uint8_t> expect;
+  bool ok = true;
+  printf("%-10s", name);
+  for (FilterKernelIsa isa : ISAS) {
+    if (!set_filter_kernel_isa(isa)) {
+      continue;
+    }
+    std::vector<uint8_t> bitmap;
+    double seconds = timing([&]() {
+      for (int i = 0; i < rounds; i++) {
+        bitmap.assign((value_num + 7) / 8, 0xFF);
+        kernel(bitmap);
+      }
+    });
+    if (isa == KERNEL_SCALAR) {
+      expect = bitmap;
+    } else if (bitmap != expect) {
+      ok = false;
+    }
+    printf("  %s: %7.3fs %8.0fM/s", filter_kernel_isa_name(isa), seconds, (double)value_num * rounds / seconds / 1e6);
+  }
+  printf("  selected=%d%s\n", count_bits(expect), ok ? "" : "  MISMATCH");
+  return ok;
+}
+
+int main(int argc, char *argv[])
+{
+  int value_num = 1 << 20;
+  int rounds = 20;
+  if (argc >= 2) {
+    value_num = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    rounds = atoi(argv[2]);
+  }
+  FilterKernelIsa default_isa = filter_kernel_isa();
+  printf("values=%d rounds=%d cpu=%s\n", value_num, rounds, filter_kernel_isa_name(default_isa));
+
+  std::mt19937 random(0);
+  std::vector<int> ints(value_num);
+  std::vector<float> floats(value_num);
+  for (int i = 0; i < value_num; i++) {
+    ints[i] = (int)(random() % 1000) - 500;
+    // 一部分值与常量只差不到1e-6，检查误差比较的边界
+    floats[i] = (i % 16 == 0) ? 1.5f + (float)(random() % 3) * 4e-7f : (float)(random() % 1000) / 100.0f;
+  }
+  const char *words[] = {"hello", "hello world", "hellp", "abc", "", "hello\0xx"};
+  const int width = 16;
+  std::vector<char> chars((size_t)value_num * width, 0);
+  for (int i = 0; i < value_num; i++) {
+    const char *word = words[random() % 6];
+    memcpy(chars.data() + (size_t)i * width, word, strlen(word));
+  }
+
+  bool ok = true;
+  for (CompOp op : OPS) {
+    std::string name = "int" + std::to_string(op);
+    ok = bench(name.c_str(), value_num, rounds, [&](std::vector<uint8_t> &bitmap) {
+      filter_int_kernel(ints.data(), value_num, op, 17, bitmap.data());
+    }) && ok;
+  }
+  for (CompOp op : OPS) {
+    std::string name = "float" + std::to_string(op);
+    ok = bench(name.c_str(), value_num, rounds, [&](std::vector<uint8_t> &bitmap) {
+      filter_float_kernel(floats.data(), value_num, op, 1.5f, bitmap.data());
+    }) && ok;
+  }
+  for (CompOp op : {EQUAL_TO, NOT_EQUAL}) {
+    std::string name = "chars" + std::to_string(op);
+    ok = bench(name.c_str(), value_num, rounds, [&](std::vector<uint8_t> &bitmap) {
+      filter_chars_kernel(chars.data(), width, value_num, op, "hello", 6, bitmap.data());
+    }) && ok;
+  }
+
+  set_filter_kernel_isa(default_isa);
+  return ok ? 0 : 1;
+}
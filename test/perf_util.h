@@ -0,0 +1,30 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// 各个性能测试共用的工具
+//
+
+#ifndef __TEST_PERF_UTIL_H_
+#define __TEST_PERF_UTIL_H_
+
+#include <chrono>
+#include <functional>
+
+// 执行func，返回用时(秒)
+inline double timing(const std::function<void()> &func)
+{
+  auto begin = std::chrono::steady_clock::now();
+  func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - begin).count();
+}
+
+#endif //__TEST_PERF_UTIL_H_
@@ -0,0 +1,135 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// 常量不同的同一条sql，每次都解析与规范化之后从计划缓存中取出再替换常量的性能对比，
+// 同时检查替换常量之后的语句与解析的结果是否一致
+// usage: plan_cache_performance_test [query_num]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "sql/parser/parse.h"
+#include "sql/plan_cache/plan_cache.h"
+#include "perf_util.h"
+
+static std::string make_sql(int i)
+{
+  char sql[256];
+  snprintf(sql, sizeof(sql),
+      "select id, name, score * 2 from student where id > %d and score < %d.5 and name <> 'n%d' and age = -%d;",
+      i, i % 100, i, i % 30);
+  return sql;
+}
+
+static bool same_value(const Value &left, const Value &right)
+{
+  if (left.type != right.type) {
+    return false;
+  }
+  if (left.type == CHARS) {
+    return 0 == strcmp((const char *)left.data, (const char *)right.data);
+  }
+  return 0 == memcmp(left.data, right.data, sizeof(int));
+}
+
+// 条件右边的常量，负数是 SUBN(null, 常量) 的表达式
+static const Value *right_value(const Condition &condition)
+{
+  if (condition.right_ast == nullptr) {
+    return &condition.right_value;
+  }
+  return &((const valnode *)condition.right_ast->r)->value;
+}
+
+static bool same_query(const Query *left, const Query *right)
+{
+  const Selects &l = left->sstr.selection;
+  const Selects &r = right->sstr.selection;
+  if (left->flag != right->flag || l.condition_num != r.condition_num) {
+    return false;
+  }
+  for (size_t i = 0; i < l.condition_num; i++) {
+    const Condition &lc = l.conditions[i];
+    const Condition &rc = r.conditions[i];
+    if (lc.comp != rc.comp || lc.right_is_attr != rc.right_is_attr) {
+      return false;
+    }
+    if (!lc.right_is_attr && !same_value(*right_value(lc), *right_value(rc))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  int query_num = 100000;
+  if (argc >= 2) {
+    query_num = atoi(argv[1]);
+  }
+  printf("queries=%d\n", query_num);
+
+  std::vector<std::string> sqls;
+  for (int i = 0; i < query_num; i++) {
+    sqls.push_back(make_sql(i));
+  }
+
+  double seconds = timing([&]() {
+    for (const std::string &sql : sqls) {
+      Query *query = query_create();
+      parse(sql.c_str(), query);
+      query_destroy(query);
+    }
+  });
+  printf("parse:              %7.3fs %8.2fK queries/s\n", seconds, query_num / seconds / 1e3);
+
+  PlanCache plan_cache(16);
+  NormalizedSql normalized;
+  seconds = timing([&]() {
+    for (const std::string &sql : sqls) {
+      normalize_sql(sql.c_str(), normalized);
+      std::shared_ptr<CachedPlan> plan = plan_cache.get(normalized.text);
+      if (plan == nullptr) {
+        Query *query = query_create();
+        ParsedLiterals literals;
+        parse(sql.c_str(), query, &literals);
+        plan = CachedPlan::create(query, literals, normalized);
+        plan_cache.put(normalized.text, plan);
+        query_destroy(query);
+      }
+      query_destroy(plan->instantiate(normalized.literals));
+    }
+  });
+  printf("plan cache:         %7.3fs %8.2fK queries/s, hits=%lu\n",
+      seconds, query_num / seconds / 1e3, plan_cache.hits());
+
+  bool ok = plan_cache.hits() == (uint64_t)query_num - 1;
+  for (int i = 0; i < query_num && ok; i += query_num / 100 + 1) {
+    Query *expect = query_create();
+    parse(sqls[i].c_str(), expect);
+    normalize_sql(sqls[i].c_str(), normalized);
+    Query *result = plan_cache.get(normalized.text)->instantiate(normalized.literals);
+    if (result == nullptr || !same_query(expect, result)) {
+      printf("  MISMATCH: %s\n", sqls[i].c_str());
+      ok = false;
+    }
+    query_destroy(expect);
+    if (result != nullptr) {
+      query_destroy(result);
+    }
+  }
+  return ok ? 0 : 1;
+}
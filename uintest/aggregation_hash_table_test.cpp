@@ -0,0 +1,193 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include <stdlib.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "sql/executor/aggregation_hash_table.h"
+#include "gtest/gtest.h"
+
+static std::shared_ptr<AggreDesc> make_desc(AggreType type, bool is_attr) {
+  std::shared_ptr<AggreDesc> desc(new AggreDesc());
+  desc->aggre_type = type;
+  desc->is_attr = is_attr;
+  desc->relation_name = nullptr;
+  desc->attr_name = nullptr;
+  desc->is_star = !is_attr;
+  desc->value = 1;
+  return desc;
+}
+
+static float float_at(const Tuple &tuple, int index) {
+  return *(float *)tuple.get_pointer(index)->value_pointer();
+}
+
+static int int_at(const Tuple &tuple, int index) {
+  return *(int *)tuple.get_pointer(index)->value_pointer();
+}
+
+// count(*)、count(v)、sum(v)、min(v)、max(v)，v可能是null
+static std::vector<std::shared_ptr<AggreDesc>> all_descs() {
+  return {make_desc(COUNTS, false), make_desc(COUNTS, true), make_desc(SUMS, true), make_desc(MINS, true),
+          make_desc(MAXS, true)};
+}
+
+struct Expected {
+  int count_star = 0;
+  int count = 0;
+  long sum = 0;
+  int min = 0;
+  int max = 0;
+};
+
+TEST(test_aggregation_hash_table, same_as_reference) {
+  srand(20211103);
+  std::vector<Tuple> tuples;
+  std::map<int, Expected> expected;
+  for (int i = 0; i < 50000; i++) {
+    Tuple tuple;
+    int key = rand() % 3000;
+    tuple.add(key);
+    Expected &e = expected[key];
+    e.count_star++;
+    if (rand() % 10 == 0) {
+      tuple.add_null();
+    } else {
+      int v = rand() % 2000 - 1000;
+      tuple.add(v);
+      e.min = e.count == 0 ? v : std::min(e.min, v);
+      e.max = e.count == 0 ? v : std::max(e.max, v);
+      e.count++;
+      e.sum += v;
+    }
+    tuples.push_back(std::move(tuple));
+  }
+
+  AggregationHashTable table;
+  table.init(all_descs());
+  for (const Tuple &tuple : tuples) {
+    table.insert_combine(tuple, {0}, {-1, 1, 1, 1, 1});
+  }
+  table.sort_groups();
+  ASSERT_EQ(expected.size(), table.group_count());
+
+  // 输出按key排序
+  int index = 0;
+  for (const auto &pair : expected) {
+    Tuple tuple;
+    table.output(index++, tuple);
+    ASSERT_EQ(pair.first, int_at(tuple, 0));
+    const Expected &e = pair.second;
+    ASSERT_EQ(e.count_star, (int)float_at(tuple, 1));
+    ASSERT_EQ(e.count, (int)float_at(tuple, 2));
+    if (e.count == 0) {
+      ASSERT_EQ(UNDEFINED, tuple.get_pointer(3)->Type());
+      ASSERT_EQ(UNDEFINED, tuple.get_pointer(4)->Type());
+      ASSERT_EQ(UNDEFINED, tuple.get_pointer(5)->Type());
+      continue;
+    }
+    ASSERT_EQ((float)e.sum, float_at(tuple, 3));
+    ASSERT_EQ(e.min, int_at(tuple, 4));
+    ASSERT_EQ(e.max, int_at(tuple, 5));
+  }
+}
+
+TEST(test_aggregation_hash_table, null_keys_form_one_group) {
+  AggregationHashTable table;
+  table.init({make_desc(COUNTS, false)});
+  for (int i = 0; i < 10; i++) {
+    Tuple tuple;
+    if (i % 2 == 0) {
+      tuple.add_null();
+    } else {
+      tuple.add(7);
+    }
+    table.insert_combine(tuple, {0}, {-1});
+  }
+  table.sort_groups();
+  ASSERT_EQ(2, table.group_count());
+  // null排在最前
+  Tuple tuple;
+  table.output(0, tuple);
+  ASSERT_EQ(UNDEFINED, tuple.get_pointer(0)->Type());
+  ASSERT_EQ(5, (int)float_at(tuple, 1));
+}
+
+// 浮点数按值精确分组：1.0与1.000001是不同的分组(TupleValue::compare认为它们相等)，-0.0与0.0是同一个分组
+TEST(test_aggregation_hash_table, float_keys_are_exact) {
+  AggregationHashTable table;
+  table.init({make_desc(COUNTS, false)});
+  const float keys[] = {1.0f, 1.000001f, 1.0f, -0.0f, 0.0f, 1.000001f, 2.5f};
+  for (float key : keys) {
+    Tuple tuple;
+    tuple.add(key);
+    table.insert_combine(tuple, {0}, {-1});
+  }
+  table.sort_groups();
+  ASSERT_EQ(4, table.group_count());
+
+  const float expected_keys[] = {0.0f, 1.0f, 1.000001f, 2.5f};
+  const int expected_counts[] = {2, 2, 2, 1};
+  for (int i = 0; i < 4; i++) {
+    Tuple tuple;
+    table.output(i, tuple);
+    ASSERT_EQ(expected_keys[i], float_at(tuple, 0));
+    ASSERT_EQ(expected_counts[i], (int)float_at(tuple, 1));
+  }
+}
+
+// 分成几个局部hash表聚合后合并，结果与在一个表中聚合相同
+TEST(test_aggregation_hash_table, merge) {
+  srand(20211104);
+  AggregationHashTable whole;
+  whole.init(all_descs());
+  std::vector<std::unique_ptr<AggregationHashTable>> partials;
+  for (int i = 0; i < 4; i++) {
+    partials.emplace_back(new AggregationHashTable());
+    partials.back()->init(all_descs());
+  }
+  for (int i = 0; i < 20000; i++) {
+    Tuple tuple;
+    tuple.add(rand() % 500);
+    tuple.add(rand() % 100);
+    whole.insert_combine(tuple, {0}, {-1, 1, 1, 1, 1});
+    partials[i % 4]->insert_combine(tuple, {0}, {-1, 1, 1, 1, 1});
+  }
+  AggregationHashTable merged;
+  merged.init(all_descs());
+  for (auto &partial : partials) {
+    merged.merge(*partial);
+  }
+  whole.sort_groups();
+  merged.sort_groups();
+  ASSERT_EQ(whole.group_count(), merged.group_count());
+  for (int i = 0; i < whole.group_count(); i++) {
+    Tuple expected;
+    Tuple tuple;
+    whole.output(i, expected);
+    merged.output(i, tuple);
+    ASSERT_EQ(int_at(expected, 0), int_at(tuple, 0));
+    for (int j = 1; j <= 3; j++) {
+      ASSERT_EQ(float_at(expected, j), float_at(tuple, j));
+    }
+    ASSERT_EQ(int_at(expected, 4), int_at(tuple, 4));
+    ASSERT_EQ(int_at(expected, 5), int_at(tuple, 5));
+  }
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
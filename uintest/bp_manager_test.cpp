@@ -12,6 +12,14 @@ See the Mulan PSL v2 for more details. */
 // Created by wangyunlai.wyl on 2021
 //
 
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "storage/default/disk_buffer_pool.h"
 #include "gtest/gtest.h"
 
@@ -55,6 +63,59 @@ TEST(test_bp_manager, test_bp_manager_simple_lru) {
   ASSERT_NE(frame4, nullptr);
 }
 
+// 页数远多于缓冲区的frame数，多个线程同时读，读盘在锁外进行时同一个页只能读入一次，内容不能错
+TEST(test_disk_buffer_pool, concurrent_get_this_page) {
+  std::string file_name = "/tmp/bp_manager_test." + std::to_string(getpid()) + ".data";
+  ::unlink(file_name.c_str());
+  DiskBufferPool buffer_pool;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(file_name.c_str()));
+  int file_id;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(file_name.c_str(), &file_id));
+
+  const int page_num = BP_BUFFER_SIZE * 4;
+  for (int i = 0; i < page_num; i++) {
+    BPPageHandle page_handle;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(file_id, &page_handle));
+    char *data;
+    buffer_pool.get_data(&page_handle, &data);
+    PageNum page;
+    buffer_pool.get_page_num(&page_handle, &page);
+    memset(data, page % 251, BP_PAGE_DATA_SIZE);
+    buffer_pool.mark_dirty(&page_handle);
+    buffer_pool.unpin_page(&page_handle);
+  }
+
+  std::atomic<int> failed(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; t++) {
+    threads.emplace_back([&, t]() {
+      unsigned int seed = t;
+      for (int i = 0; i < 5000; i++) {
+        PageNum page = 1 + rand_r(&seed) % page_num;
+        BPPageHandle page_handle;
+        if (buffer_pool.get_this_page(file_id, page, &page_handle) != RC::SUCCESS) {
+          failed++;
+          continue;
+        }
+        char *data;
+        buffer_pool.get_data(&page_handle, &data);
+        if (page_handle.frame->page.page_num != page || data[0] != (char)(page % 251) ||
+            data[BP_PAGE_DATA_SIZE - 1] != (char)(page % 251)) {
+          failed++;
+        }
+        buffer_pool.unpin_page(&page_handle);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, failed.load());
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  buffer_pool.drop_file(file_name.c_str());
+}
+
 int main(int argc, char **argv) {
 
 
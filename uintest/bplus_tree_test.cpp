@@ -0,0 +1,791 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/common/bplus_tree.h"
+#include "gtest/gtest.h"
+
+static std::string index_file_name(const char *name) {
+  return std::string("/tmp/bplus_tree_test.") + name + "." + std::to_string(getpid()) + ".index";
+}
+
+static RID make_rid(int key) {
+  RID rid;
+  rid.page_num = key / 100 + 1;
+  rid.slot_num = key % 100;
+  return rid;
+}
+
+// 扫描整个索引，返回按顺序读到的key
+static RC scan_int_keys(BplusTreeHandler &handler, CompOp comp_op, int value, std::vector<int> &keys) {
+  BplusTreeScanner scanner(handler);
+  RC rc = scanner.open(comp_op, (const char *)&value);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  RID rid;
+  int key;
+  while ((rc = scanner.next_entry(&rid, (char *)&key)) == RC::SUCCESS) {
+    keys.push_back(key);
+  }
+  scanner.close();
+  return rc == RC::RECORD_EOF ? RC::SUCCESS : rc;
+}
+
+// 等值扫描，返回按顺序读到的RID
+static RC scan_rids(BplusTreeHandler &handler, int value, std::vector<RID> &rids) {
+  BplusTreeScanner scanner(handler);
+  RC rc = scanner.open(EQUAL_TO, (const char *)&value);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  RID rid;
+  while ((rc = scanner.next_entry(&rid)) == RC::SUCCESS) {
+    rids.push_back(rid);
+  }
+  scanner.close();
+  return rc == RC::RECORD_EOF ? RC::SUCCESS : rc;
+}
+
+static bool rid_less(const RID &rid1, const RID &rid2) {
+  return rid1.page_num < rid2.page_num || (rid1.page_num == rid2.page_num && rid1.slot_num < rid2.slot_num);
+}
+
+static bool same_rids(std::vector<RID> expected, const std::vector<RID> &actual) {
+  std::sort(expected.begin(), expected.end(), rid_less);
+  if (expected.size() != actual.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < expected.size(); i++) {
+    if (expected[i].page_num != actual[i].page_num || expected[i].slot_num != actual[i].slot_num) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST(test_bplus_tree, scan_after_insert_and_delete) {
+  std::string file_name = index_file_name("scan");
+  ::unlink(file_name.c_str());
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), INTS, sizeof(int)));
+
+  const int key_num = 5000;
+  for (int i = 0; i < key_num; i++) {
+    int key = (i * 7919) % key_num;
+    RID rid = make_rid(key);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&key, &rid));
+  }
+  // 删除偶数，触发合并和重分布
+  for (int key = 0; key < key_num; key += 2) {
+    RID rid = make_rid(key);
+    ASSERT_EQ(RC::SUCCESS, handler.delete_entry((const char *)&key, &rid));
+  }
+
+  std::vector<int> keys;
+  ASSERT_EQ(RC::SUCCESS, scan_int_keys(handler, NO_OP, 0, keys));
+  ASSERT_EQ(key_num / 2, (int)keys.size());
+  for (int i = 0; i < (int)keys.size(); i++) {
+    ASSERT_EQ(i * 2 + 1, keys[i]);
+  }
+
+  keys.clear();
+  int value = 4001;
+  ASSERT_EQ(RC::SUCCESS, scan_int_keys(handler, GREAT_EQUAL, value, keys));
+  ASSERT_EQ((key_num - value + 1) / 2, (int)keys.size());
+  ASSERT_EQ(value, keys.front());
+
+  keys.clear();
+  ASSERT_EQ(RC::SUCCESS, scan_int_keys(handler, EQUAL_TO, 2, keys));
+  ASSERT_TRUE(keys.empty());
+
+  handler.close();
+  theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+}
+
+// 覆盖索引扫描把key直接写到记录中字段的位置，字段是记录的最后一列时多写一个字节就会越界
+TEST(test_bplus_tree, next_entry_copies_attr_length_only) {
+  const int attr_length = 12;
+  for (int format = 0; format < 4; format++) {
+    const bool posting_list = (format & 1) != 0;
+    const bool key_compress = (format & 2) != 0;
+    std::string file_name = index_file_name("key_copy");
+    ::unlink(file_name.c_str());
+    BplusTreeHandler handler;
+    ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), CHARS, attr_length, posting_list, key_compress));
+    char value[attr_length] = "abc";
+    RID rid = make_rid(1);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(value, &rid));
+
+    std::vector<char> buffer(attr_length + sizeof(RID), '#');
+    BplusTreeScanner scanner(handler);
+    ASSERT_EQ(RC::SUCCESS, scanner.open(EQUAL_TO, value));
+    RID result;
+    ASSERT_EQ(RC::SUCCESS, scanner.next_entry(&result, buffer.data()));
+    scanner.close();
+    ASSERT_EQ(0, memcmp(value, buffer.data(), attr_length));
+    for (size_t i = attr_length; i < buffer.size(); i++) {
+      ASSERT_EQ('#', buffer[i]);
+    }
+
+    handler.close();
+    theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+  }
+}
+
+// 扫描的同时有其他线程插入/删除(包括分裂、合并)，一直存在的key必须恰好返回一次，且结果有序
+TEST(test_bplus_tree, scan_with_concurrent_modifications) {
+  std::string file_name = index_file_name("concurrent");
+  ::unlink(file_name.c_str());
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), INTS, sizeof(int)));
+
+  // 3的倍数一直存在，其他key由写线程反复插入删除
+  const int key_num = 6000;
+  for (int key = 0; key < key_num; key += 3) {
+    RID rid = make_rid(key);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&key, &rid));
+  }
+
+  const int writer_num = 4;
+  const int reader_num = 4;
+  std::atomic<int> failed(0);
+  std::vector<std::thread> threads;
+  for (int w = 0; w < writer_num; w++) {
+    threads.emplace_back([&, w]() {
+      for (int round = 0; round < 3; round++) {
+        for (int key = w; key < key_num; key += writer_num) {
+          if (key % 3 == 0) {
+            continue;
+          }
+          RID rid = make_rid(key);
+          if (handler.insert_entry((const char *)&key, &rid) != RC::SUCCESS) {
+            failed++;
+          }
+        }
+        for (int key = w; key < key_num; key += writer_num) {
+          if (key % 3 == 0) {
+            continue;
+          }
+          RID rid = make_rid(key);
+          if (handler.delete_entry((const char *)&key, &rid) != RC::SUCCESS) {
+            failed++;
+          }
+        }
+      }
+    });
+  }
+  for (int r = 0; r < reader_num; r++) {
+    threads.emplace_back([&]() {
+      for (int scan = 0; scan < 50; scan++) {
+        std::vector<int> keys;
+        if (scan_int_keys(handler, NO_OP, 0, keys) != RC::SUCCESS) {
+          failed++;
+          return;
+        }
+        int stable = 0;
+        for (size_t i = 0; i < keys.size(); i++) {
+          if (i > 0 && keys[i] <= keys[i - 1]) {
+            failed++;
+            return;
+          }
+          if (keys[i] % 3 == 0) {
+            if (keys[i] != stable * 3) {
+              failed++;
+              return;
+            }
+            stable++;
+          }
+        }
+        if (stable != (key_num + 2) / 3) {
+          failed++;
+          return;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, failed.load());
+
+  std::vector<int> keys;
+  ASSERT_EQ(RC::SUCCESS, scan_int_keys(handler, NO_OP, 0, keys));
+  ASSERT_EQ((key_num + 2) / 3, (int)keys.size());
+
+  handler.close();
+  theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+}
+
+// 非唯一索引：重复少的值留在叶子中，重复多的值转成倒排链，可能跨多个倒排页
+TEST(test_bplus_tree, posting_list_duplicates) {
+  std::string file_name = index_file_name("posting");
+  ::unlink(file_name.c_str());
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), INTS, sizeof(int), true));
+
+  // 值v有dup_counts[v % 6]个RID，按RID倒序、不同值交错插入
+  const int dup_counts[] = {1, 3, 40, 60, 300, 5000};
+  const int value_num = 24;
+  std::vector<std::vector<RID>> expected(value_num);
+  for (int round = 5000 - 1; round >= 0; round--) {
+    for (int value = 0; value < value_num; value++) {
+      if (round >= dup_counts[value % 6]) {
+        continue;
+      }
+      RID rid = make_rid(round * value_num + value);
+      ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&value, &rid));
+      expected[value].push_back(rid);
+    }
+  }
+  int value = 5;
+  RID rid = expected[value][0];
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, handler.insert_entry((const char *)&value, &rid));
+
+  for (value = 0; value < value_num; value++) {
+    std::vector<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, scan_rids(handler, value, rids));
+    ASSERT_TRUE(same_rids(expected[value], rids)) << "value " << value;
+    rid = expected[value].back();
+    ASSERT_EQ(RC::SUCCESS, handler.get_entry((const char *)&value, &rid));
+  }
+
+  // 删除每个值的一半RID，以及值4、5的全部RID
+  for (value = 0; value < value_num; value++) {
+    std::vector<RID> left;
+    for (size_t i = 0; i < expected[value].size(); i++) {
+      bool remove = i % 2 == 0 || value % 6 == 4 || value % 6 == 5;
+      if (remove) {
+        ASSERT_EQ(RC::SUCCESS, handler.delete_entry((const char *)&value, &expected[value][i]));
+      } else {
+        left.push_back(expected[value][i]);
+      }
+    }
+    rid = expected[value][0];
+    ASSERT_EQ(RC::RECORD_INVALID_KEY, handler.delete_entry((const char *)&value, &rid));
+    expected[value].swap(left);
+  }
+
+  // 关闭后重新打开，内容不变
+  ASSERT_EQ(RC::SUCCESS, handler.close());
+  ASSERT_EQ(RC::SUCCESS, handler.open(file_name.c_str()));
+  std::vector<int> keys;
+  ASSERT_EQ(RC::SUCCESS, scan_int_keys(handler, NO_OP, 0, keys));
+  size_t total = 0;
+  for (value = 0; value < value_num; value++) {
+    std::vector<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, scan_rids(handler, value, rids));
+    ASSERT_TRUE(same_rids(expected[value], rids)) << "value " << value;
+    total += rids.size();
+  }
+  ASSERT_EQ(total, keys.size());
+  ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+
+  handler.close();
+  theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+}
+
+// 每个值只有两三个RID时不分配倒排页，索引文件的大小和唯一索引相当
+TEST(test_bplus_tree, posting_list_few_duplicates_stay_inline) {
+  std::string file_name = index_file_name("inline");
+  ::unlink(file_name.c_str());
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), INTS, sizeof(int), true));
+  const int value_num = 5000;
+  for (int value = 0; value < value_num; value++) {
+    for (int dup = 0; dup < 2; dup++) {
+      RID rid = make_rid(value * 2 + dup);
+      ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&value, &rid));
+    }
+  }
+  std::vector<int> keys;
+  ASSERT_EQ(RC::SUCCESS, scan_int_keys(handler, NO_OP, 0, keys));
+  ASSERT_EQ(value_num * 2, (int)keys.size());
+  handler.close();
+
+  struct stat st;
+  ASSERT_EQ(0, stat(file_name.c_str(), &st));
+  ASSERT_LT(st.st_size / BP_PAGE_SIZE, value_num / 10);
+  theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+}
+
+// 多个线程同时给少数几个值插入/删除RID(过程中转成倒排链)，扫描看到的RID有序且不重复，
+// 一直存在的RID恰好出现一次
+TEST(test_bplus_tree, posting_list_concurrent_writers) {
+  std::string file_name = index_file_name("posting_concurrent");
+  ::unlink(file_name.c_str());
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), INTS, sizeof(int), true));
+
+  const int value_num = 4;
+  const int stable_num = 20;
+  for (int value = 0; value < value_num; value++) {
+    for (int i = 0; i < stable_num; i++) {
+      RID rid = make_rid(i * 1000 + value);
+      ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&value, &rid));
+    }
+  }
+
+  const int writer_num = 4;
+  const int reader_num = 4;
+  std::atomic<int> failed(0);
+  std::vector<std::thread> threads;
+  for (int w = 0; w < writer_num; w++) {
+    threads.emplace_back([&, w]() {
+      for (int round = 0; round < 3; round++) {
+        for (int op = 0; op < 2; op++) {
+          for (int i = 0; i < 400; i++) {
+            int value = i % value_num;
+            RID rid;
+            rid.page_num = 1000 + w;
+            rid.slot_num = i;
+            RC rc = op == 0 ? handler.insert_entry((const char *)&value, &rid)
+                            : handler.delete_entry((const char *)&value, &rid);
+            if (rc != RC::SUCCESS) {
+              failed++;
+            }
+          }
+        }
+      }
+    });
+  }
+  for (int r = 0; r < reader_num; r++) {
+    threads.emplace_back([&, r]() {
+      for (int scan = 0; scan < 50; scan++) {
+        int value = (scan + r) % value_num;
+        std::vector<RID> rids;
+        if (scan_rids(handler, value, rids) != RC::SUCCESS) {
+          failed++;
+          return;
+        }
+        int stable = 0;
+        for (size_t i = 0; i < rids.size(); i++) {
+          if (i > 0 && !rid_less(rids[i - 1], rids[i])) {
+            failed++;
+            return;
+          }
+          if (rids[i].page_num < 1000) {
+            stable++;
+          }
+        }
+        if (stable != stable_num) {
+          failed++;
+          return;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, failed.load());
+
+  for (int value = 0; value < value_num; value++) {
+    std::vector<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, scan_rids(handler, value, rids));
+    ASSERT_EQ(stable_num, (int)rids.size());
+  }
+
+  handler.close();
+  theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+}
+
+// CHARS索引按前缀压缩存放节点。key有很长的公共前缀、长度各不相同(包括写满attr_length没有结尾'\0'的key)，
+// 插入时叶子和内部节点都会分裂，分隔key只保留能区分左右两边的前缀
+static const int COMPRESS_ATTR_LENGTH = 100;
+
+static std::string compress_key(int i) {
+  std::string key(80, 'p');
+  key += std::to_string(i);
+  if (i % 7 == 0) {
+    key.resize(COMPRESS_ATTR_LENGTH, (char)('a' + i % 26));
+  }
+  return key;
+}
+
+static std::vector<char> compress_value(const std::string &key) {
+  std::vector<char> value(COMPRESS_ATTR_LENGTH, 0);
+  memcpy(value.data(), key.data(), std::min(key.size(), value.size()));
+  return value;
+}
+
+static RC scan_string_keys(BplusTreeHandler &handler, CompOp comp_op, const std::string &value,
+                           std::vector<std::string> &keys) {
+  std::vector<char> buffer = compress_value(value);
+  BplusTreeScanner scanner(handler);
+  RC rc = scanner.open(comp_op, buffer.data());
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  RID rid;
+  std::vector<char> key(COMPRESS_ATTR_LENGTH);
+  while ((rc = scanner.next_entry(&rid, key.data())) == RC::SUCCESS) {
+    keys.push_back(std::string(key.data(), strnlen(key.data(), key.size())));
+  }
+  scanner.close();
+  return rc == RC::RECORD_EOF ? RC::SUCCESS : rc;
+}
+
+static void check_string_keys(BplusTreeHandler &handler, const std::vector<int> &present) {
+  std::vector<std::string> expected;
+  for (int i : present) {
+    expected.push_back(compress_key(i));
+  }
+  std::sort(expected.begin(), expected.end());
+  std::vector<std::string> keys;
+  ASSERT_EQ(RC::SUCCESS, scan_string_keys(handler, NO_OP, "", keys));
+  ASSERT_EQ(expected, keys);
+
+  for (size_t i = 0; i < expected.size(); i += 97) {
+    keys.clear();
+    ASSERT_EQ(RC::SUCCESS, scan_string_keys(handler, GREAT_EQUAL, expected[i], keys));
+    ASSERT_EQ(expected.size() - i, keys.size());
+    ASSERT_EQ(expected[i], keys.front());
+    keys.clear();
+    ASSERT_EQ(RC::SUCCESS, scan_string_keys(handler, EQUAL_TO, expected[i], keys));
+    ASSERT_EQ(1u, keys.size());
+  }
+  for (int i : present) {
+    std::vector<char> value = compress_value(compress_key(i));
+    RID rid = make_rid(i);
+    ASSERT_EQ(RC::SUCCESS, handler.get_entry(value.data(), &rid)) << compress_key(i);
+  }
+}
+
+TEST(test_bplus_tree, compressed_keys_with_long_prefix) {
+  std::string file_name = index_file_name("compress");
+  ::unlink(file_name.c_str());
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), CHARS, COMPRESS_ATTR_LENGTH, false, true));
+
+  const int key_num = 20000;
+  std::vector<int> present;
+  for (int n = 0; n < key_num; n++) {
+    int i = (int)((n * 7919L) % key_num);
+    std::vector<char> value = compress_value(compress_key(i));
+    RID rid = make_rid(i);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(value.data(), &rid));
+    present.push_back(i);
+  }
+  check_string_keys(handler, present);
+
+  // 删掉前一半的大部分key让节点合并，后一半每隔三个删一个让节点重分布
+  std::vector<int> left;
+  for (int i : present) {
+    bool remove = i < key_num / 2 ? i % 10 != 0 : i % 3 == 0;
+    if (remove) {
+      std::vector<char> value = compress_value(compress_key(i));
+      RID rid = make_rid(i);
+      ASSERT_EQ(RC::SUCCESS, handler.delete_entry(value.data(), &rid)) << compress_key(i);
+    } else {
+      left.push_back(i);
+    }
+  }
+  check_string_keys(handler, left);
+
+  // 再插回来，关闭后重新打开
+  for (int i = 0; i < key_num; i += 2) {
+    if (i < key_num / 2 ? i % 10 != 0 : i % 3 == 0) {
+      std::vector<char> value = compress_value(compress_key(i));
+      RID rid = make_rid(i);
+      ASSERT_EQ(RC::SUCCESS, handler.insert_entry(value.data(), &rid));
+      left.push_back(i);
+    }
+  }
+  ASSERT_EQ(RC::SUCCESS, handler.close());
+  ASSERT_EQ(RC::SUCCESS, handler.open(file_name.c_str()));
+  check_string_keys(handler, left);
+  handler.close();
+
+  // 不压缩时一个节点只能放 (页大小 / (100 + 2 * sizeof(RID))) 个key，压缩后至少多一倍
+  struct stat st;
+  ASSERT_EQ(0, stat(file_name.c_str(), &st));
+  ASSERT_LT(st.st_size / BP_PAGE_SIZE, key_num / (BP_PAGE_SIZE / (COMPRESS_ATTR_LENGTH + 2 * (int)sizeof(RID))) / 2);
+  theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+}
+
+// 只在最后一个字节不同的key，分隔key不能截短
+TEST(test_bplus_tree, compressed_keys_differ_in_last_byte) {
+  std::string file_name = index_file_name("compress_last_byte");
+  ::unlink(file_name.c_str());
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), CHARS, COMPRESS_ATTR_LENGTH, false, true));
+
+  std::vector<std::string> expected;
+  for (int i = 0; i < 3000; i++) {
+    std::string key(COMPRESS_ATTR_LENGTH - 2, 'q');
+    key += (char)('A' + i / 60);
+    key += (char)('A' + i % 60);
+    std::vector<char> value = compress_value(key);
+    RID rid = make_rid(i);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(value.data(), &rid));
+    expected.push_back(key);
+  }
+  std::sort(expected.begin(), expected.end());
+  std::vector<std::string> keys;
+  ASSERT_EQ(RC::SUCCESS, scan_string_keys(handler, NO_OP, "", keys));
+  ASSERT_EQ(expected, keys);
+  for (size_t i = 0; i < expected.size(); i += 37) {
+    keys.clear();
+    ASSERT_EQ(RC::SUCCESS, scan_string_keys(handler, GREAT_THAN, expected[i], keys));
+    ASSERT_EQ(expected.size() - i - 1, keys.size());
+  }
+
+  handler.close();
+  theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+}
+
+// 压缩索引上多个线程同时插入/删除，分裂和合并沿路径只锁住要修改的节点，
+// 扫描和点查在这期间看到的key有序，一直存在的key恰好出现一次
+TEST(test_bplus_tree, compressed_keys_concurrent_writers) {
+  std::string file_name = index_file_name("compress_concurrent");
+  ::unlink(file_name.c_str());
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), CHARS, COMPRESS_ATTR_LENGTH, false, true));
+
+  // 5的倍数一直存在，其他key由写线程反复插入删除
+  const int key_num = 8000;
+  std::vector<int> stable;
+  for (int i = 0; i < key_num; i += 5) {
+    std::vector<char> value = compress_value(compress_key(i));
+    RID rid = make_rid(i);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(value.data(), &rid));
+    stable.push_back(i);
+  }
+  std::vector<std::string> expected;
+  for (int i : stable) {
+    expected.push_back(compress_key(i));
+  }
+  std::sort(expected.begin(), expected.end());
+
+  const int writer_num = 4;
+  const int reader_num = 3;
+  std::atomic<int> failed(0);
+  std::vector<std::thread> threads;
+  for (int w = 0; w < writer_num; w++) {
+    threads.emplace_back([&, w]() {
+      for (int round = 0; round < 2; round++) {
+        for (int op = 0; op < 2; op++) {
+          for (int i = w; i < key_num; i += writer_num) {
+            if (i % 5 == 0) {
+              continue;
+            }
+            std::vector<char> value = compress_value(compress_key(i));
+            RID rid = make_rid(i);
+            RC rc = op == 0 ? handler.insert_entry(value.data(), &rid) : handler.delete_entry(value.data(), &rid);
+            if (rc != RC::SUCCESS) {
+              failed++;
+            }
+          }
+        }
+      }
+    });
+  }
+  for (int r = 0; r < reader_num; r++) {
+    threads.emplace_back([&, r]() {
+      for (int scan = 0; scan < 20; scan++) {
+        std::vector<std::string> keys;
+        if (scan_string_keys(handler, NO_OP, "", keys) != RC::SUCCESS) {
+          failed++;
+          return;
+        }
+        size_t next = 0;
+        for (size_t i = 0; i < keys.size(); i++) {
+          if (i > 0 && keys[i] <= keys[i - 1]) {
+            failed++;
+            return;
+          }
+          if (next < expected.size() && keys[i] == expected[next]) {
+            next++;
+          }
+        }
+        if (next != expected.size()) {
+          failed++;
+          return;
+        }
+        int i = stable[(scan * reader_num + r) * 7 % stable.size()];
+        std::vector<char> value = compress_value(compress_key(i));
+        RID rid = make_rid(i);
+        if (handler.get_entry(value.data(), &rid) != RC::SUCCESS) {
+          failed++;
+          return;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, failed.load());
+  check_string_keys(handler, stable);
+
+  handler.close();
+  theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+}
+
+// 点查和扫描不修改页面：从磁盘读入的页面在读操作之后和文件中的内容相同
+TEST(test_bplus_tree, reads_leave_pages_untouched) {
+  std::string file_name = index_file_name("read_only");
+  ::unlink(file_name.c_str());
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), INTS, sizeof(int)));
+  // 页面数要小于缓冲池的大小，读完之后都还在内存中
+  const int key_num = 3000;
+  for (int key = 0; key < key_num; key++) {
+    RID rid = make_rid(key);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&key, &rid));
+  }
+  ASSERT_EQ(RC::SUCCESS, handler.close());
+
+  FILE *file = fopen(file_name.c_str(), "rb");
+  ASSERT_NE(nullptr, file);
+  std::vector<char> content;
+  char buffer[BP_PAGE_SIZE];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    content.insert(content.end(), buffer, buffer + size);
+  }
+  fclose(file);
+  const int page_count = (int)(content.size() / BP_PAGE_SIZE);
+  ASSERT_LT(page_count, BP_BUFFER_SIZE);
+
+  ASSERT_EQ(RC::SUCCESS, handler.open(file_name.c_str()));
+  for (int key = 0; key < key_num; key += 7) {
+    RID rid = make_rid(key);
+    ASSERT_EQ(RC::SUCCESS, handler.get_entry((const char *)&key, &rid));
+  }
+  std::vector<int> keys;
+  ASSERT_EQ(RC::SUCCESS, scan_int_keys(handler, NO_OP, 0, keys));
+  ASSERT_EQ(key_num, (int)keys.size());
+  keys.clear();
+  ASSERT_EQ(RC::SUCCESS, scan_int_keys(handler, GREAT_THAN, key_num / 2, keys));
+  ASSERT_EQ(key_num - key_num / 2 - 1, (int)keys.size());
+
+  DiskBufferPool *disk_buffer_pool = theGlobalDiskBufferPool();
+  int file_id;
+  ASSERT_EQ(RC::SUCCESS, disk_buffer_pool->open_file(file_name.c_str(), &file_id));
+  for (int page_num = 1; page_num < page_count; page_num++) {
+    BPPageHandle page_handle;
+    char *data;
+    ASSERT_EQ(RC::SUCCESS, disk_buffer_pool->get_this_page(file_id, page_num, &page_handle));
+    disk_buffer_pool->get_data(&page_handle, &data);
+    const char *on_disk = content.data() + page_num * BP_PAGE_SIZE + offsetof(Page, data);
+    EXPECT_EQ(0, memcmp(on_disk, data, BP_PAGE_DATA_SIZE)) << "page " << page_num;
+    disk_buffer_pool->unpin_page(&page_handle);
+  }
+
+  handler.close();
+  theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+}
+
+static bool read_file_header(const std::string &file_name, IndexFileHeader &header) {
+  FILE *file = fopen(file_name.c_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  // 文件头在第1页的数据区开头
+  bool ok = fseek(file, BP_PAGE_SIZE + offsetof(Page, data), SEEK_SET) == 0 &&
+            fread(&header, sizeof(header), 1, file) == 1;
+  fclose(file);
+  return ok;
+}
+
+static bool write_file_header(const std::string &file_name, const IndexFileHeader &header) {
+  FILE *file = fopen(file_name.c_str(), "r+b");
+  if (file == nullptr) {
+    return false;
+  }
+  bool ok = fseek(file, BP_PAGE_SIZE + offsetof(Page, data), SEEK_SET) == 0 &&
+            fwrite(&header, sizeof(header), 1, file) == 1;
+  fclose(file);
+  return ok;
+}
+
+// 前缀压缩在创建索引时选择，之后打开以文件头为准
+TEST(test_bplus_tree, key_compress_chosen_at_create) {
+  const struct {
+    AttrType type;
+    bool key_compress;
+    int expected;
+  } cases[] = {{CHARS, false, 0}, {CHARS, true, 1}, {INTS, true, 0}};
+  for (const auto &c : cases) {
+    std::string file_name = index_file_name("choose_compress");
+    ::unlink(file_name.c_str());
+    BplusTreeHandler handler;
+    const int attr_length = c.type == CHARS ? COMPRESS_ATTR_LENGTH : (int)sizeof(int);
+    ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), c.type, attr_length, false, c.key_compress));
+    handler.close();
+
+    IndexFileHeader header;
+    ASSERT_TRUE(read_file_header(file_name, header));
+    ASSERT_EQ(INDEX_FILE_MAGIC, header.magic);
+    ASSERT_EQ(INDEX_FILE_VERSION, header.version);
+    ASSERT_EQ(c.expected, header.key_compress);
+
+    if (c.type == CHARS) {
+      BplusTreeHandler reopened;
+      ASSERT_EQ(RC::SUCCESS, reopened.open(file_name.c_str()));
+      std::vector<int> present;
+      for (int i = 0; i < 2000; i++) {
+        std::vector<char> value = compress_value(compress_key(i));
+        RID rid = make_rid(i);
+        ASSERT_EQ(RC::SUCCESS, reopened.insert_entry(value.data(), &rid));
+        present.push_back(i);
+      }
+      check_string_keys(reopened, present);
+      reopened.close();
+    }
+    theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+  }
+}
+
+// 不是当前版本的索引文件不能打开
+TEST(test_bplus_tree, reject_other_format) {
+  std::string file_name = index_file_name("format");
+  ::unlink(file_name.c_str());
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), INTS, sizeof(int)));
+  handler.close();
+
+  IndexFileHeader header;
+  ASSERT_TRUE(read_file_header(file_name, header));
+  IndexFileHeader old_version = header;
+  old_version.version = INDEX_FILE_VERSION - 1;
+  ASSERT_TRUE(write_file_header(file_name, old_version));
+  BplusTreeHandler old_handler;
+  ASSERT_EQ(RC::FORMAT, old_handler.open(file_name.c_str()));
+
+  // 没有magic的文件，比如增加版本号之前的格式，开头是attr_length
+  IndexFileHeader no_magic = header;
+  no_magic.magic = sizeof(int);
+  ASSERT_TRUE(write_file_header(file_name, no_magic));
+  ASSERT_EQ(RC::FORMAT, old_handler.open(file_name.c_str()));
+
+  ASSERT_TRUE(write_file_header(file_name, header));
+  ASSERT_EQ(RC::SUCCESS, old_handler.open(file_name.c_str()));
+  old_handler.close();
+  theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
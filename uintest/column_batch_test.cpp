@@ -0,0 +1,218 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "sql/executor/column_batch.h"
+#include "sql/executor/scan_executor.h"
+#include "sql_test_util.h"
+
+static std::string value_string(const ColumnVector &column, int row) {
+  std::stringstream ss;
+  column.value(row)->to_string(ss);
+  return ss.str();
+}
+
+// 三列(INTS, FLOATS, CHARS)的schema
+static TupleSchema test_schema() {
+  TupleSchema schema;
+  schema.add(INTS, "t", "a");
+  schema.add(FLOATS, "t", "f");
+  schema.add(CHARS, "t", "s");
+  return schema;
+}
+
+// 第i行为(i, i + 0.5, "s<i>")，i是7的倍数时三列都是null
+static void fill_batch(ColumnBatch &batch, int rows) {
+  batch.init(test_schema());
+  for (int i = 0; i < rows; i++) {
+    if (i % 7 == 0) {
+      batch.column(0).append_null();
+      batch.column(1).append_null();
+      batch.column(2).append_null();
+    } else {
+      std::string s = "s" + std::to_string(i);
+      batch.column(0).append_int(i);
+      batch.column(1).append_float(i + 0.5f);
+      batch.column(2).append_string(s.c_str(), s.size());
+    }
+    batch.finish_row();
+  }
+}
+
+static std::string expected_row(int i) {
+  if (i % 7 == 0) {
+    return "null | null | null";
+  }
+  std::stringstream ss;
+  FloatValue(i + 0.5f).to_string(ss);
+  return std::to_string(i) + " | " + ss.str() + " | s" + std::to_string(i);
+}
+
+TEST(test_column_batch, column_vector_values) {
+  ColumnVector ints(INTS);
+  ColumnVector strings(CHARS);
+  for (int i = 0; i < 20; i++) {
+    if (i % 3 == 0) {
+      ints.append_null();
+      strings.append_null();
+    } else {
+      ints.append_int(-i);
+      std::string s(i % 5, 'x');  // 包括空串
+      strings.append_string(s.c_str(), s.size());
+    }
+  }
+  ASSERT_EQ(20, ints.size());
+  ASSERT_TRUE(ints.has_null());
+  for (int i = 0; i < 20; i++) {
+    // null位跨越多个字节
+    ASSERT_EQ(i % 3 == 0, ints.is_null(i)) << i;
+    ASSERT_EQ(i % 3 == 0, strings.is_null(i)) << i;
+    if (i % 3 == 0) {
+      ASSERT_EQ("null", value_string(ints, i));
+      continue;
+    }
+    ASSERT_EQ(-i, ints.get_int(i));
+    ASSERT_EQ(i % 5, strings.string_length(i));
+    ASSERT_EQ(std::string(i % 5, 'x'), strings.get_string(i));
+    ASSERT_EQ(std::string(i % 5, 'x'), value_string(strings, i));
+  }
+
+  // 从另一列追加，null保持为null
+  ColumnVector copy(CHARS);
+  for (int i = 0; i < strings.size(); i++) {
+    copy.append_from(strings, i);
+  }
+  for (int i = 0; i < copy.size(); i++) {
+    ASSERT_EQ(strings.is_null(i), copy.is_null(i));
+    ASSERT_STREQ(strings.get_string(i), copy.get_string(i));
+  }
+
+  // clear之后可以重新使用
+  ints.clear();
+  ASSERT_EQ(0, ints.size());
+  ASSERT_FALSE(ints.has_null());
+  ints.append_int(42);
+  ASSERT_FALSE(ints.is_null(0));
+  ASSERT_EQ(42, ints.int_data()[0]);
+}
+
+// 过滤只修改selection，转换为行格式时只输出选中的行
+TEST(test_column_batch, selection) {
+  ColumnBatch batch;
+  fill_batch(batch, 100);
+  ASSERT_EQ(100, batch.row_count());
+  ASSERT_EQ(100, batch.size());
+
+  std::vector<int> &selection = batch.selection();
+  selection.erase(std::remove_if(selection.begin(), selection.end(), [](int row) { return row % 2 != 0; }),
+                  selection.end());
+  ASSERT_EQ(100, batch.row_count());
+  ASSERT_EQ(50, batch.size());
+
+  TupleSet tuple_set;
+  batch.to_tuple_set(tuple_set);
+  ASSERT_EQ(50, tuple_set.size());
+  for (int i = 0; i < tuple_set.size(); i++) {
+    ASSERT_EQ(expected_row(i * 2), SqlTestDb::tuple_to_string(tuple_set.get(i)));
+  }
+
+  // 只取一部分列
+  Tuple tuple;
+  batch.add_to_tuple(batch.selected(1), {2, 0}, tuple);
+  ASSERT_EQ("s2 | 2", SqlTestDb::tuple_to_string(tuple));
+
+  // 追加选中的行到另一个批次
+  ColumnBatch compacted;
+  compacted.init(batch.schema());
+  for (int i = 0; i < batch.size(); i++) {
+    compacted.append_row(batch, batch.selected(i));
+  }
+  ASSERT_EQ(50, compacted.row_count());
+  for (int i = 0; i < compacted.row_count(); i++) {
+    Tuple row;
+    compacted.to_tuple(i, row);
+    ASSERT_EQ(expected_row(i * 2), SqlTestDb::tuple_to_string(row));
+  }
+}
+
+TEST(test_column_batch, tuple_set_round_trip) {
+  ColumnBatch batch;
+  fill_batch(batch, 3000);
+  TupleSet tuple_set;
+  batch.to_tuple_set(tuple_set);
+
+  ColumnBatch converted;
+  converted.from_tuple_set(tuple_set);
+  ASSERT_EQ(3000, converted.size());
+  ASSERT_EQ(3, converted.column_num());
+  for (int i = 0; i < converted.size(); i++) {
+    Tuple tuple;
+    converted.to_tuple(converted.selected(i), tuple);
+    ASSERT_EQ(expected_row(i), SqlTestDb::tuple_to_string(tuple));
+  }
+  for (int c = 0; c < 3; c++) {
+    ASSERT_TRUE(converted.column(c).has_null());
+  }
+  ASSERT_EQ(13.5f, converted.column(1).float_data()[13]);
+}
+
+// ScanExecutor直接解码到列中，结果与行格式相同
+TEST(test_column_batch, scan_next_batch) {
+  SqlTestDb db;
+  ASSERT_EQ(RC::SUCCESS, db.execute("create table t(a int nullable, f float nullable, s char(6), d date);"));
+  for (int i = 0; i < 2100; i++) {
+    std::string a = i % 5 == 0 ? "null" : std::to_string(i);
+    std::string f = i % 9 == 0 ? "null" : std::to_string(i) + ".25";
+    std::string sql = "insert into t values(" + a + ", " + f + ", 'r" + std::to_string(i % 100) +
+                      "', '2021-10-" + std::to_string(10 + i % 20) + "');";
+    ASSERT_EQ(RC::SUCCESS, db.execute(sql.c_str())) << sql;
+  }
+  TupleSchema schema;
+  TupleSchema::from_table(db.table("t"), schema);
+  ExecutorContext context;
+  ScanExecutor row_scan(&context, db.table("t"), schema, {}, false);
+  ScanExecutor column_scan(&context, db.table("t"), schema, {}, false);
+  ASSERT_EQ(RC::SUCCESS, row_scan.init());
+  ASSERT_EQ(RC::SUCCESS, column_scan.init());
+
+  std::vector<std::string> row_result;
+  TupleSet tuple_set;
+  while (row_scan.next(tuple_set) == RC::SUCCESS) {
+    for (const Tuple &tuple : tuple_set.tuples()) {
+      row_result.push_back(SqlTestDb::tuple_to_string(tuple));
+    }
+  }
+  std::vector<std::string> column_result;
+  ColumnBatch batch;
+  RC rc;
+  while ((rc = column_scan.next_batch(batch)) == RC::SUCCESS) {
+    ASSERT_GE((int)Executor::BATCH_SIZE, batch.size());
+    ASSERT_EQ(4, batch.column_num());
+    for (int i = 0; i < batch.size(); i++) {
+      Tuple tuple;
+      batch.to_tuple(batch.selected(i), tuple);
+      column_result.push_back(SqlTestDb::tuple_to_string(tuple));
+    }
+  }
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  ASSERT_EQ(0, batch.size());
+  ASSERT_EQ(2100, (int)row_result.size());
+  ASSERT_EQ(row_result, column_result);
+  ASSERT_EQ("null | null | r0 | 2021-10-10", column_result[0]);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
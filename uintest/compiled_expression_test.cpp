@@ -0,0 +1,164 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "sql/executor/expression.h"
+#include "sql/parser/parse.h"
+#include "gtest/gtest.h"
+
+// t(a int, b float, c int nullable, s char)
+static const std::map<std::string, std::map<std::string, int>> FIELD_INDEX = {
+    {"t", {{"a", 0}, {"b", 1}, {"c", 2}, {"s", 3}}}};
+
+// 解析 select <expression> from t，编译select列中的表达式
+static RC compile(const char *expression, CompiledExpression &compiled,
+                  const std::map<std::string, std::map<std::string, int>> &field_index = FIELD_INDEX) {
+  std::string sql = std::string("select ") + expression + " from t;";
+  Query *query = query_create();
+  RC rc = parse(sql.c_str(), query);
+  EXPECT_EQ(RC::SUCCESS, rc) << sql;
+  EXPECT_EQ(1u, query->sstr.selection.attr_exp_num) << sql;
+  if (rc == RC::SUCCESS) {
+    rc = compiled.compile(query->sstr.selection.attributes_exp[0], field_index);
+  }
+  query_destroy(query);
+  return rc;
+}
+
+static Tuple make_tuple(int a, float b, int c, bool c_null) {
+  Tuple tuple;
+  tuple.add(a);
+  tuple.add(b);
+  if (c_null) {
+    tuple.add_null();
+  } else {
+    tuple.add(c);
+  }
+  tuple.add("str", 3);
+  return tuple;
+}
+
+TEST(test_compiled_expression, arithmetic) {
+  Tuple tuple = make_tuple(7, 2.5f, 4, false);
+  struct {
+    const char *expression;
+    float result;
+  } cases[] = {
+      {"a + b * 2", 12},
+      {"(a + b) * 2", 19},
+      {"a - c - 1", 2},
+      {"a / c", 1.75f},
+      {"t.a * t.c - b", 25.5f},
+      {"-a + 10", 3},
+      {"a * (c - (b + 0.5) * 2)", -14},
+  };
+  for (const auto &c : cases) {
+    CompiledExpression expression;
+    ASSERT_EQ(RC::SUCCESS, compile(c.expression, expression)) << c.expression;
+    float result = 0;
+    ASSERT_TRUE(expression.evaluate(tuple, result)) << c.expression;
+    ASSERT_FLOAT_EQ(c.result, result) << c.expression;
+  }
+}
+
+// 只包含常量的子表达式在编译时折叠成一个常量，除数为0的不折叠
+TEST(test_compiled_expression, constant_folding) {
+  CompiledExpression expression;
+  ASSERT_EQ(RC::SUCCESS, compile("1 + 2 * 3 - 8 / 4", expression));
+  ASSERT_EQ(1u, expression.instruction_count());
+  float result = 0;
+  ASSERT_TRUE(expression.evaluate(Tuple(), result));
+  ASSERT_FLOAT_EQ(5, result);
+
+  // a + 6
+  ASSERT_EQ(RC::SUCCESS, compile("a + 2 * 3", expression));
+  ASSERT_EQ(3u, expression.instruction_count());
+  ASSERT_TRUE(expression.evaluate(make_tuple(1, 0, 0, false), result));
+  ASSERT_FLOAT_EQ(7, result);
+
+  expression.compile_attr(2);
+  ASSERT_EQ(2, expression.attr_index());
+  ASSERT_EQ(RC::SUCCESS, compile("c * 1", expression));
+  ASSERT_EQ(-1, expression.attr_index());
+
+  ASSERT_EQ(RC::SUCCESS, compile("1 / 0 + 1", expression));
+  ASSERT_LT(1u, expression.instruction_count());
+  ASSERT_FALSE(expression.evaluate(Tuple(), result));
+}
+
+// null参与计算时结果是null，除0和非数值字段是错误，两种情况evaluate都返回false
+TEST(test_compiled_expression, null_and_errors) {
+  float result = 0;
+  CompiledExpression expression;
+  ASSERT_EQ(RC::SUCCESS, compile("a + c", expression));
+  ASSERT_FALSE(expression.evaluate(make_tuple(1, 1, 0, true), result));
+  ASSERT_TRUE(expression.evaluate(make_tuple(1, 1, 2, false), result));
+  ASSERT_FLOAT_EQ(3, result);
+
+  ASSERT_EQ(RC::SUCCESS, compile("a + null", expression));
+  ASSERT_EQ(1u, expression.instruction_count());
+  ASSERT_FALSE(expression.evaluate(make_tuple(1, 1, 2, false), result));
+
+  ASSERT_EQ(RC::SUCCESS, compile("a / (c - 2)", expression));
+  ASSERT_FALSE(expression.evaluate(make_tuple(1, 1, 2, false), result));
+  ASSERT_TRUE(expression.evaluate(make_tuple(1, 1, 4, false), result));
+  ASSERT_FLOAT_EQ(0.5f, result);
+
+  ASSERT_EQ(RC::SUCCESS, compile("s + 1", expression));
+  ASSERT_FALSE(expression.evaluate(make_tuple(1, 1, 2, false), result));
+}
+
+TEST(test_compiled_expression, compile_errors) {
+  CompiledExpression expression;
+  ASSERT_NE(RC::SUCCESS, compile("x + 1", expression));
+  ASSERT_NE(RC::SUCCESS, compile("t2.a + 1", expression, {{"t", {{"a", 0}}}, {"t2", {{"b", 1}}}}));
+  // 多张表时必须写表名
+  ASSERT_NE(RC::SUCCESS, compile("a + 1", expression, {{"t", {{"a", 0}}}, {"t2", {{"b", 1}}}}));
+  ASSERT_EQ(RC::SUCCESS, compile("t2.b + t.a", expression, {{"t", {{"a", 0}}}, {"t2", {{"b", 1}}}}));
+  float result = 0;
+  ASSERT_TRUE(expression.evaluate(make_tuple(3, 1.5f, 0, false), result));
+  ASSERT_FLOAT_EQ(4.5f, result);
+}
+
+// 按批求值与逐个求值的结果相同
+TEST(test_compiled_expression, evaluate_batch) {
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 100; i++) {
+    tuples.push_back(make_tuple(i, i * 0.5f, i % 5, i % 7 == 0));
+  }
+  std::vector<const Tuple *> pointers;
+  for (const Tuple &tuple : tuples) {
+    pointers.push_back(&tuple);
+  }
+  for (const char *text : {"a * 2 + b", "a / c", "(a - c) * (b + 1) / 2", "c + 1 - 1", "3 * 4", "a + null"}) {
+    CompiledExpression expression;
+    ASSERT_EQ(RC::SUCCESS, compile(text, expression)) << text;
+    std::vector<float> results;
+    std::vector<char> valid;
+    expression.evaluate(pointers, results, valid);
+    ASSERT_EQ(tuples.size(), valid.size()) << text;
+    for (size_t i = 0; i < tuples.size(); i++) {
+      float result = 0;
+      bool ok = expression.evaluate(tuples[i], result);
+      ASSERT_EQ(ok, valid[i] != 0) << text << " " << i;
+      if (ok) {
+        ASSERT_FLOAT_EQ(result, results[i]) << text << " " << i;
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,152 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "sql/executor/nest_loop_join_executor.h"
+#include "sql/executor/scan_executor.h"
+#include "sql_test_util.h"
+
+static const int T1_ROWS = 2500;
+static const int T2_ROWS = 3;
+
+class test_executor_batch : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t1(a int, b char(8));"));
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t2(c int);"));
+    for (int i = 0; i < T1_ROWS; i++) {
+      std::string sql = "insert into t1 values(" + std::to_string(i) + ", 'b" + std::to_string(i % 10) + "');";
+      ASSERT_EQ(RC::SUCCESS, db_.execute(sql.c_str()));
+    }
+    for (int i = 0; i < T2_ROWS; i++) {
+      std::string sql = "insert into t2 values(" + std::to_string(i) + ");";
+      ASSERT_EQ(RC::SUCCESS, db_.execute(sql.c_str()));
+    }
+    TupleSchema::from_table(db_.table("t1"), t1_schema_);
+    TupleSchema::from_table(db_.table("t2"), t2_schema_);
+  }
+
+  // 反复调用next直到RECORD_EOF，每一批都不能超过BATCH_SIZE
+  static RC drain(Executor &executor, std::vector<std::string> &rows, int &batches,
+                  std::vector<Filter *> *filters = nullptr) {
+    batches = 0;
+    rows.clear();
+    TupleSet tuple_set;
+    RC rc;
+    while ((rc = executor.next(tuple_set, filters)) == RC::SUCCESS) {
+      EXPECT_LT(0, tuple_set.size());
+      EXPECT_GE((int)Executor::BATCH_SIZE, tuple_set.size());
+      for (const Tuple &tuple : tuple_set.tuples()) {
+        rows.push_back(SqlTestDb::tuple_to_string(tuple));
+      }
+      batches++;
+    }
+    // 结束之后的next仍然是RECORD_EOF
+    EXPECT_EQ(RC::RECORD_EOF, executor.next(tuple_set, filters));
+    EXPECT_TRUE(tuple_set.is_empty());
+    return rc == RC::RECORD_EOF ? RC::SUCCESS : rc;
+  }
+
+  static std::string t1_row(int i) {
+    return std::to_string(i) + " | b" + std::to_string(i % 10);
+  }
+
+protected:
+  SqlTestDb db_;
+  TupleSchema t1_schema_;
+  TupleSchema t2_schema_;
+  ExecutorContext context_;
+};
+
+TEST_F(test_executor_batch, scan_in_batches) {
+  ScanExecutor scan(&context_, db_.table("t1"), t1_schema_, {}, false);
+  ASSERT_EQ(RC::SUCCESS, scan.init());
+  std::vector<std::string> rows;
+  int batches;
+  ASSERT_EQ(RC::SUCCESS, drain(scan, rows, batches));
+  ASSERT_EQ((T1_ROWS + Executor::BATCH_SIZE - 1) / Executor::BATCH_SIZE, batches);
+  ASSERT_EQ(T1_ROWS, (int)rows.size());
+  for (int i = 0; i < T1_ROWS; i++) {
+    ASSERT_EQ(t1_row(i), rows[i]);
+  }
+}
+
+// rewind之后从头开始，可以在读完之前rewind，也可以换一组filters
+TEST_F(test_executor_batch, scan_rewind_with_filters) {
+  ScanExecutor scan(&context_, db_.table("t1"), t1_schema_, {}, false);
+  ASSERT_EQ(RC::SUCCESS, scan.init());
+  TupleSet tuple_set;
+  ASSERT_EQ(RC::SUCCESS, scan.next(tuple_set));
+  ASSERT_EQ(RC::SUCCESS, scan.rewind());
+
+  Value value;
+  value_init_integer(&value, 2000);
+  FilterDesc left = {true, "t1", "a", Value{}};
+  FilterDesc right = {false, "", "", value};
+  Filter filter(left, right, GREAT_EQUAL);
+  std::vector<Filter *> filters = {&filter};
+  std::vector<std::string> rows;
+  int batches;
+  ASSERT_EQ(RC::SUCCESS, drain(scan, rows, batches, &filters));
+  ASSERT_EQ(T1_ROWS - 2000, (int)rows.size());
+  ASSERT_EQ(t1_row(2000), rows.front());
+  ASSERT_EQ(t1_row(T1_ROWS - 1), rows.back());
+
+  ASSERT_EQ(RC::SUCCESS, scan.rewind());
+  ASSERT_EQ(RC::SUCCESS, drain(scan, rows, batches));
+  ASSERT_EQ(T1_ROWS, (int)rows.size());
+  value_destroy(&value);
+}
+
+// join的结果超过一批时分多次返回，每次从上一次停下的位置继续
+TEST_F(test_executor_batch, nest_loop_join_streams) {
+  TupleSchema output_schema;
+  output_schema.append(t1_schema_);
+  output_schema.append(t2_schema_);
+  ScanExecutor left(&context_, db_.table("t1"), t1_schema_, {}, false);
+  ScanExecutor right(&context_, db_.table("t2"), t2_schema_, {}, false);
+  NestLoopJoinExecutor join(&context_, output_schema, &left, &right, {});
+  ASSERT_EQ(RC::SUCCESS, join.init());
+
+  std::vector<std::string> rows;
+  int batches;
+  ASSERT_EQ(RC::SUCCESS, drain(join, rows, batches));
+  ASSERT_EQ(T1_ROWS * T2_ROWS, (int)rows.size());
+  ASSERT_LT(2, batches);
+  for (int i = 0; i < T1_ROWS; i++) {
+    for (int j = 0; j < T2_ROWS; j++) {
+      ASSERT_EQ(t1_row(i) + " | " + std::to_string(j), rows[i * T2_ROWS + j]);
+    }
+  }
+
+  // 读了一部分之后rewind，重新得到完整的结果
+  TupleSet tuple_set;
+  ASSERT_EQ(RC::SUCCESS, join.rewind());
+  ASSERT_EQ(RC::SUCCESS, join.next(tuple_set));
+  ASSERT_EQ(RC::SUCCESS, join.rewind());
+  std::vector<std::string> rewound_rows;
+  ASSERT_EQ(RC::SUCCESS, drain(join, rewound_rows, batches));
+  ASSERT_EQ(rows, rewound_rows);
+}
+
+// 条件把大部分组合过滤掉时，仍然返回全部满足条件的结果
+TEST_F(test_executor_batch, sparse_join_result) {
+  ASSERT_EQ(std::vector<std::string>({"0 | b0 | 0", "1 | b1 | 1", "2 | b2 | 2"}),
+            db_.select_sorted("select * from t1, t2 where t1.a = t2.c;"));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
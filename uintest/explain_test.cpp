@@ -0,0 +1,230 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "sql/executor/execution_node.h"
+#include "sql/executor/explain.h"
+#include "sql_test_util.h"
+
+class test_explain : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t1(id int, a int, s char(8));"));
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t2(id int, b float);"));
+    for (int i = 0; i < 100; i++) {
+      std::string sql = "insert into t1 values(" + std::to_string(i) + ", " + std::to_string(i % 10) + ", 's" +
+                        std::to_string(i) + "');";
+      ASSERT_EQ(RC::SUCCESS, db_.execute(sql.c_str())) << sql;
+      if (i % 2 == 0) {
+        sql = "insert into t2 values(" + std::to_string(i) + ", " + std::to_string(i) + ".5);";
+        ASSERT_EQ(RC::SUCCESS, db_.execute(sql.c_str())) << sql;
+      }
+    }
+  }
+
+  // 生成执行器的执行计划，analyze时先执行完查询，rows为结果的行数
+  ExplainNode plan(const char *sql, bool analyze, int *rows = nullptr) {
+    Query *query = query_create();
+    EXPECT_EQ(RC::SUCCESS, parse(sql, query)) << sql;
+    ExecutorBuilder builder(db_.db());
+    std::unique_ptr<Executor> executor(builder.build(&query->sstr.selection));
+    if (analyze) {
+      executor->enable_stats();
+    }
+    EXPECT_EQ(RC::SUCCESS, executor->init()) << sql;
+    if (analyze) {
+      TupleSet result;
+      EXPECT_EQ(RC::SUCCESS, executor->next_all(result)) << sql;
+      if (rows != nullptr) {
+        *rows = result.size();
+      }
+    }
+    ExplainNode node;
+    executor->explain(node);
+    executor->rewind();
+    query_destroy(query);
+    return node;
+  }
+
+  std::string plan_string(const char *sql) {
+    std::stringstream ss;
+    print_explain(plan(sql, false), false, ss);
+    return ss.str();
+  }
+
+protected:
+  SqlTestDb db_;
+};
+
+// EXPLAIN和EXPLAIN ANALYZE只在select之前
+TEST(test_explain_parse, explain_type) {
+  struct {
+    const char *sql;
+    SqlCommandFlag flag;
+    ExplainType explain;
+  } cases[] = {
+      {"select * from t1;", SCF_SELECT, EXPLAIN_NONE},
+      {"explain select * from t1;", SCF_SELECT, EXPLAIN_PLAN},
+      {"explain analyze select t1.id from t1, t2 where t1.id = t2.id;", SCF_SELECT, EXPLAIN_ANALYZE},
+  };
+  for (const auto &c : cases) {
+    Query *query = query_create();
+    ASSERT_EQ(RC::SUCCESS, parse(c.sql, query)) << c.sql;
+    ASSERT_EQ(c.flag, query->flag) << c.sql;
+    ASSERT_EQ(c.explain, query->explain) << c.sql;
+    Query *copy = query_copy(query, nullptr, nullptr);
+    ASSERT_EQ(c.explain, copy->explain) << c.sql;
+    query_destroy(copy);
+    query_destroy(query);
+  }
+  Query *query = query_create();
+  ASSERT_NE(RC::SUCCESS, parse("explain analyze;", query));
+  ASSERT_EQ(EXPLAIN_NONE, query->explain);
+  query_destroy(query);
+}
+
+TEST(test_explain_print, format) {
+  ExplainNode root{"Project", "t1.id", {}, {}};
+  ExplainNode join{"HashJoin", "on t1.id = t2.id", {}, {}};
+  join.children.push_back({"TableScan", "t1", {}, {}});
+  join.children.push_back({"TableScan", "t2", {}, {}});
+  root.children.push_back(join);
+  root.children.push_back({"Limit", "", {}, {}});
+
+  std::stringstream ss;
+  print_explain(root, false, ss);
+  ASSERT_EQ("Project t1.id\n"
+            "-> HashJoin on t1.id = t2.id\n"
+            "  -> TableScan t1\n"
+            "  -> TableScan t2\n"
+            "-> Limit\n",
+            ss.str());
+
+  root.children.clear();
+  root.stats.rows = 12;
+  root.stats.seconds = 0.0015;
+  root.stats.pages_hit = 3;
+  root.stats.pages_read = 1;
+  ss.str("");
+  print_explain(root, true, ss);
+  ASSERT_EQ("Project t1.id  (rows=12 time=1.500ms pages_hit=3 pages_read=1)\n", ss.str());
+
+  ASSERT_STREQ("<>", comp_op_to_string(NOT_EQUAL));
+  ASSERT_STREQ("not in", comp_op_to_string(NOT_IN_OP));
+  int i = -3;
+  ASSERT_EQ("-3", value_to_string(INTS, &i));
+  ASSERT_EQ("'abc'", value_to_string(CHARS, "abc"));
+  ASSERT_EQ("null", value_to_string(INTS, nullptr));
+}
+
+TEST_F(test_explain, plan) {
+  ASSERT_EQ("TableScan t1 filter: t1.a < 3\n", plan_string("select * from t1 where a < 3;"));
+  ASSERT_EQ("LateMaterialize t1(t1.s), t2(t2.b)\n"
+            "-> HashJoin on t1.id = t2.id\n"
+            "  -> TableScan t1 filter: t1.a < 3\n"
+            "  -> TableScan t2\n",
+            plan_string("select t1.s, t2.b from t1, t2 where t1.id = t2.id and t1.a < 3;"));
+  ASSERT_EQ("HashAggregate t1.a | count(t1.id)\n"
+            "-> TableScan t1\n",
+            plan_string("select a, count(id) from t1 group by a;"));
+  ASSERT_EQ("TopN t1.a limit=3\n"
+            "-> TableScan t1\n",
+            plan_string("select * from t1 order by a limit 3;"));
+  ASSERT_EQ("SubQuery t1.id in (subquery)\n"
+            "-> TableScan t1\n"
+            "-> TableScan t2 filter: t2.b > 50\n",
+            plan_string("select t1.id from t1 where t1.id in (select t2.id from t2 where t2.b > 50.0);"));
+}
+
+// 单表查询由SelectExeNode扫描，EXPLAIN列出它使用的索引，多个索引表示求交集
+TEST_F(test_explain, select_node) {
+  ASSERT_EQ(RC::SUCCESS, db_.execute("create index i_a on t1(a);"));
+  ASSERT_EQ(RC::SUCCESS, db_.execute("create index i_id on t1(id);"));
+  Table *table = db_.table("t1");
+  auto explain = [this, table](const char *sql, const char *index_only_field) {
+    Query *query = query_create();
+    EXPECT_EQ(RC::SUCCESS, parse(sql, query)) << sql;
+    const Selects &selects = query->sstr.selection;
+    std::vector<DefaultConditionFilter *> filters;
+    for (size_t i = 0; i < selects.condition_num; i++) {
+      DefaultConditionFilter *filter = new DefaultConditionFilter();
+      EXPECT_EQ(RC::SUCCESS, filter->init(*table, selects.conditions[i])) << sql;
+      filters.push_back(filter);
+    }
+    TupleSchema schema;
+    TupleSchema::from_table(table, schema);
+    SelectExeNode node;
+    node.init(nullptr, table, std::move(schema), std::move(filters));
+    if (index_only_field != nullptr) {
+      node.set_index_only_field(index_only_field);
+    }
+    ExplainNode plan;
+    node.explain(plan);
+    query_destroy(query);
+    return plan.name + " " + plan.detail;
+  };
+
+  ASSERT_EQ("TableScan t1", explain("select * from t1;", nullptr));
+  ASSERT_EQ("TableScan t1 filter: t1.s = 's3'", explain("select * from t1 where s = 's3';", nullptr));
+  ASSERT_EQ("IndexScan t1 index=i_a filter: t1.a = 3", explain("select * from t1 where a = 3;", nullptr));
+  ASSERT_EQ("IndexOnlyScan t1 index=i_a filter: t1.a < 3", explain("select a from t1 where a < 3;", "a"));
+  // 没有统计信息时只用一个索引；ANALYZE之后求交集，选择率小的id < 5在前
+  const char *sql = "select * from t1 where a = 3 and id < 5;";
+  ASSERT_EQ("IndexScan t1 index=i_a filter: t1.a = 3 and t1.id < 5", explain(sql, nullptr));
+  Trx trx;
+  ASSERT_EQ(RC::SUCCESS, table->analyze(&trx));
+  ASSERT_EQ("IndexScan t1 index=i_id&i_a filter: t1.a = 3 and t1.id < 5", explain(sql, nullptr));
+}
+
+// 每个算子的行数是它输出的行数，时间和页数包括子节点
+TEST_F(test_explain, analyze) {
+  const char *sql = "select t1.s, t2.b from t1, t2 where t1.id = t2.id and t1.a < 3;";
+  int rows = 0;
+  ExplainNode root = plan(sql, true, &rows);
+  ASSERT_EQ(20, rows);
+  ASSERT_EQ("LateMaterialize", root.name);
+  ASSERT_EQ(20u, root.stats.rows);
+  ASSERT_EQ(1u, root.children.size());
+  const ExplainNode &join = root.children[0];
+  ASSERT_EQ("HashJoin", join.name);
+  ASSERT_EQ("on t1.id = t2.id build=left", join.detail);
+  ASSERT_EQ(20u, join.stats.rows);
+  ASSERT_EQ(2u, join.children.size());
+  ASSERT_EQ(30u, join.children[0].stats.rows);
+  ASSERT_EQ(50u, join.children[1].stats.rows);
+
+  ASSERT_GE(root.stats.seconds, join.stats.seconds);
+  ASSERT_GE(join.stats.seconds, join.children[0].stats.seconds + join.children[1].stats.seconds);
+  ASSERT_GE(root.stats.pages_hit + root.stats.pages_read, join.stats.pages_hit + join.stats.pages_read);
+  for (const ExplainNode &scan : join.children) {
+    ASSERT_EQ("TableScan", scan.name);
+    ASSERT_LT(0u, scan.stats.pages_hit + scan.stats.pages_read);
+  }
+
+  // 只EXPLAIN时不统计
+  ExplainNode plan_only = plan(sql, false);
+  ASSERT_EQ(0u, plan_only.stats.rows);
+  ASSERT_EQ(0u, plan_only.children[0].children[0].stats.rows);
+  ASSERT_DOUBLE_EQ(0, plan_only.children[0].stats.seconds);
+
+  // TopN读完下层满足条件的所有行，只输出limit行
+  root = plan("select * from t1 where a < 5 order by a limit 3;", true, &rows);
+  ASSERT_EQ(3, rows);
+  ASSERT_EQ(3u, root.stats.rows);
+  ASSERT_EQ(50u, root.children[0].stats.rows);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
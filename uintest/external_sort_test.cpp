@@ -0,0 +1,110 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "sql/executor/external_sort.h"
+#include "sql/executor/util.h"
+#include "gtest/gtest.h"
+
+// 每个tuple是(整数或null, 浮点数或null, 字符串, 加入的顺序)
+static std::vector<Tuple> make_tuples(int count) {
+  srand(20211103);
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < count; i++) {
+    Tuple tuple;
+    if (rand() % 8 == 0) {
+      tuple.add_null();
+    } else {
+      tuple.add(rand() % 20 - 10);
+    }
+    if (rand() % 8 == 0) {
+      tuple.add_null();
+    } else {
+      tuple.add((float)(rand() % 2000 - 1000) / 8);
+    }
+    std::string s = "s" + std::to_string(rand() % 30);
+    tuple.add(s.c_str(), s.size());
+    tuple.add(i);
+    tuples.push_back(std::move(tuple));
+  }
+  return tuples;
+}
+
+static int seq_of(const Tuple &tuple) {
+  return *(int *)tuple.get_pointer(3)->value_pointer();
+}
+
+// 用compare_value做稳定排序，结果应当与ExternalSorter完全相同
+static void check_sort(int count, const std::vector<int> &key_index, const std::vector<int> &orders,
+                       size_t memory_limit, bool spill) {
+  std::vector<Tuple> input = make_tuples(count);
+  std::vector<Tuple> expected(input);
+  std::stable_sort(expected.begin(), expected.end(), [&](const Tuple &lhs, const Tuple &rhs) {
+    for (size_t i = 0; i < key_index.size(); i++) {
+      int ret = TupleSortUtil::compare_value(lhs.get_pointer(key_index[i]), rhs.get_pointer(key_index[i]));
+      if (ret != 0) {
+        return orders[i] == 0 ? ret < 0 : ret > 0;
+      }
+    }
+    return false;
+  });
+
+  ExternalSorter sorter(key_index, orders, memory_limit);
+  for (Tuple &tuple : input) {
+    ASSERT_EQ(RC::SUCCESS, sorter.add(std::move(tuple)));
+  }
+  ASSERT_EQ(RC::SUCCESS, sorter.finish());
+  if (spill) {
+    ASSERT_GT(sorter.run_count(), 1);
+  } else {
+    ASSERT_EQ(0, sorter.run_count());
+  }
+
+  Tuple tuple;
+  for (size_t i = 0; i < expected.size(); i++) {
+    ASSERT_EQ(RC::SUCCESS, sorter.next(tuple)) << "position " << i;
+    ASSERT_EQ(seq_of(expected[i]), seq_of(tuple)) << "position " << i;
+    ASSERT_EQ(expected[i].size(), tuple.size());
+    for (int j = 0; j < tuple.size(); j++) {
+      ASSERT_EQ(0, TupleSortUtil::compare_value(expected[i].get_pointer(j), tuple.get_pointer(j)));
+    }
+  }
+  ASSERT_EQ(RC::RECORD_EOF, sorter.next(tuple));
+}
+
+TEST(test_external_sort, in_memory) {
+  check_sort(3000, {0}, {0}, 64 * 1024 * 1024, false);
+  check_sort(3000, {1, 2}, {1, 0}, 64 * 1024 * 1024, false);
+}
+
+TEST(test_external_sort, spill_to_runs) {
+  check_sort(20000, {0}, {0}, 64 * 1024, true);
+  check_sort(20000, {1}, {1}, 64 * 1024, true);
+  check_sort(20000, {2, 0, 1}, {0, 1, 0}, 64 * 1024, true);
+}
+
+TEST(test_external_sort, empty_input) {
+  ExternalSorter sorter({0}, {0}, 1024);
+  ASSERT_EQ(RC::SUCCESS, sorter.finish());
+  Tuple tuple;
+  ASSERT_EQ(RC::RECORD_EOF, sorter.next(tuple));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
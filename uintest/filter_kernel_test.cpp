@@ -0,0 +1,195 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "util/filter_kernel.h"
+#include "gtest/gtest.h"
+
+// 不是向量宽度(4/8)整数倍的长度覆盖尾部的标量处理
+static const int LENGTHS[] = {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 100, 257};
+static const CompOp OPS[] = {EQUAL_TO, NOT_EQUAL, LESS_THAN, LESS_EQUAL, GREAT_THAN, GREAT_EQUAL};
+static const FilterKernelIsa ISAS[] = {KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2};
+
+// 与DefaultConditionFilter逐条比较的语义相同
+static bool int_reference(int value, CompOp op, int constant) {
+  int cmp = value - constant;
+  switch (op) {
+    case EQUAL_TO:    return cmp == 0;
+    case NOT_EQUAL:   return cmp != 0;
+    case LESS_THAN:   return cmp < 0;
+    case LESS_EQUAL:  return cmp <= 0;
+    case GREAT_THAN:  return cmp > 0;
+    case GREAT_EQUAL: return cmp >= 0;
+    default:          return false;
+  }
+}
+
+static bool float_reference(float value, CompOp op, float constant) {
+  float sub = value - constant;
+  int cmp = (sub < 1e-6 && sub > -1e-6) ? 0 : (sub > 0 ? 1 : -1);
+  return int_reference(cmp, op, 0);
+}
+
+static std::vector<uint8_t> random_bitmap(int n) {
+  std::vector<uint8_t> bitmap((n + 7) / 8 + 1);
+  for (uint8_t &byte : bitmap) {
+    byte = (uint8_t)rand();
+  }
+  return bitmap;
+}
+
+static bool bit_of(const std::vector<uint8_t> &bitmap, int index) {
+  return (bitmap[index >> 3] >> (index & 7)) & 1;
+}
+
+// 检查前n位的结果，以及n之后的位没有被改动
+static void check_bitmap(const std::vector<uint8_t> &before, const std::vector<uint8_t> &after, int n,
+                         const std::vector<bool> &expected) {
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(bit_of(before, i) && expected[i], bit_of(after, i)) << "index " << i;
+  }
+  for (int i = n; i < (int)before.size() * 8; i++) {
+    ASSERT_EQ(bit_of(before, i), bit_of(after, i)) << "index " << i;
+  }
+}
+
+class test_filter_kernel : public ::testing::Test {
+protected:
+  void SetUp() override {
+    srand(20211101);
+    isa_ = filter_kernel_isa();
+  }
+  void TearDown() override {
+    set_filter_kernel_isa(isa_);
+  }
+
+private:
+  FilterKernelIsa isa_;
+};
+
+TEST_F(test_filter_kernel, int_same_as_reference) {
+  for (FilterKernelIsa isa : ISAS) {
+    if (!set_filter_kernel_isa(isa)) {
+      continue;
+    }
+    for (int n : LENGTHS) {
+      std::vector<int> values(n);
+      for (int &value : values) {
+        value = rand() % 21 - 10;
+      }
+      for (CompOp op : OPS) {
+        for (int constant : {-10, -3, 0, 4, 10}) {
+          std::vector<uint8_t> before = random_bitmap(n);
+          std::vector<uint8_t> after = before;
+          filter_int_kernel(values.data(), n, op, constant, after.data());
+          std::vector<bool> expected(n);
+          for (int i = 0; i < n; i++) {
+            expected[i] = int_reference(values[i], op, constant);
+          }
+          SCOPED_TRACE(std::string(filter_kernel_isa_name(isa)) + " n=" + std::to_string(n) +
+                       " op=" + std::to_string(op) + " constant=" + std::to_string(constant));
+          check_bitmap(before, after, n, expected);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(test_filter_kernel, float_same_as_reference) {
+  const float constants[] = {-2.5f, 0.0f, 1.0f, 1e-7f, -1e-7f};
+  for (FilterKernelIsa isa : ISAS) {
+    if (!set_filter_kernel_isa(isa)) {
+      continue;
+    }
+    for (int n : LENGTHS) {
+      for (CompOp op : OPS) {
+        for (float constant : constants) {
+          // 一部分值落在常量附近1e-6之内或正好在边界上
+          std::vector<float> values(n);
+          for (float &value : values) {
+            switch (rand() % 4) {
+              case 0: value = constant; break;
+              case 1: value = constant + (rand() % 2 ? 1e-6f : -1e-6f); break;
+              case 2: value = constant + (rand() % 5 - 2) * 5e-7f; break;
+              default: value = (rand() % 2001 - 1000) / 100.0f; break;
+            }
+          }
+          std::vector<uint8_t> before = random_bitmap(n);
+          std::vector<uint8_t> after = before;
+          filter_float_kernel(values.data(), n, op, constant, after.data());
+          std::vector<bool> expected(n);
+          for (int i = 0; i < n; i++) {
+            expected[i] = float_reference(values[i], op, constant);
+          }
+          SCOPED_TRACE(std::string(filter_kernel_isa_name(isa)) + " n=" + std::to_string(n) +
+                       " op=" + std::to_string(op) + " constant=" + std::to_string(constant));
+          check_bitmap(before, after, n, expected);
+        }
+      }
+    }
+  }
+}
+
+// 16、32字节宽度会走SSE2/AVX2的实现，其它宽度走标量实现
+TEST_F(test_filter_kernel, chars_same_as_strcmp) {
+  const char *words[] = {"", "a", "ab", "abc", "abd", "abcdefghijklmno", "abcdefghijklmnop"};
+  const int word_num = sizeof(words) / sizeof(words[0]);
+  for (FilterKernelIsa isa : ISAS) {
+    if (!set_filter_kernel_isa(isa)) {
+      continue;
+    }
+    for (int width : {4, 16, 17, 32}) {
+      for (int n : LENGTHS) {
+        // 定长字段中字符串后面的字节不一定是0
+        std::vector<char> values((size_t)n * width);
+        for (char &c : values) {
+          c = (char)('a' + rand() % 3);
+        }
+        for (int i = 0; i < n; i++) {
+          const char *word = words[rand() % word_num];
+          size_t len = std::min(strlen(word), (size_t)width - 1);
+          memcpy(&values[(size_t)i * width], word, len);
+          values[(size_t)i * width + len] = '\0';
+        }
+        for (CompOp op : {EQUAL_TO, NOT_EQUAL}) {
+          for (int w = 0; w < word_num; w++) {
+            if ((int)strlen(words[w]) >= width) {
+              continue;
+            }
+            std::vector<uint8_t> before = random_bitmap(n);
+            std::vector<uint8_t> after = before;
+            int len = strlen(words[w]) + 1;
+            filter_chars_kernel(values.data(), width, n, op, words[w], len, after.data());
+            std::vector<bool> expected(n);
+            for (int i = 0; i < n; i++) {
+              bool equal = strcmp(&values[(size_t)i * width], words[w]) == 0;
+              expected[i] = op == EQUAL_TO ? equal : !equal;
+            }
+            SCOPED_TRACE(std::string(filter_kernel_isa_name(isa)) + " width=" + std::to_string(width) +
+                         " n=" + std::to_string(n) + " op=" + std::to_string(op) + " constant=" + words[w]);
+            check_bitmap(before, after, n, expected);
+          }
+        }
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,181 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/common/hash_index.h"
+#include "storage/common/db.h"
+#include "storage/common/table.h"
+#include "gtest/gtest.h"
+
+static std::string index_file_name(const char *name) {
+  return std::string("/tmp/hash_index_test.") + name + "." + std::to_string(getpid()) + ".index";
+}
+
+static RID make_rid(int value) {
+  RID rid;
+  rid.page_num = value / 100 + 1;
+  rid.slot_num = value % 100;
+  return rid;
+}
+
+static int count_entries(HashIndexHandler &handler, int key) {
+  std::vector<char> entries;
+  if (handler.get_entries((const char *)&key, entries) != RC::SUCCESS) {
+    return -1;
+  }
+  return (int)(entries.size() / handler.entry_length());
+}
+
+TEST(test_hash_index, insert_get_delete) {
+  std::string file_name = index_file_name("basic");
+  ::unlink(file_name.c_str());
+  HashIndexHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), INTS, sizeof(int)));
+
+  // 足够多的key，桶会分裂、目录会翻倍
+  const int key_num = 20000;
+  for (int key = 0; key < key_num; key++) {
+    RID rid = make_rid(key);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&key, &rid));
+  }
+  int key = 7;
+  RID rid = make_rid(key);
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, handler.insert_entry((const char *)&key, &rid));
+  for (key = 0; key < key_num; key++) {
+    std::vector<char> entries;
+    ASSERT_EQ(RC::SUCCESS, handler.get_entries((const char *)&key, entries));
+    ASSERT_EQ((size_t)handler.entry_length(), entries.size());
+    RID found;
+    memcpy(&found, entries.data() + sizeof(int), sizeof(RID));
+    ASSERT_EQ(key / 100 + 1, found.page_num);
+    ASSERT_EQ(key % 100, found.slot_num);
+  }
+
+  for (key = 0; key < key_num; key += 2) {
+    rid = make_rid(key);
+    ASSERT_EQ(RC::SUCCESS, handler.delete_entry((const char *)&key, &rid));
+  }
+  key = 0;
+  rid = make_rid(key);
+  ASSERT_EQ(RC::RECORD_INVALID_KEY, handler.delete_entry((const char *)&key, &rid));
+  for (key = 0; key < key_num; key++) {
+    ASSERT_EQ(key % 2, count_entries(handler, key));
+  }
+
+  handler.close();
+  theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+}
+
+// 同一个key的大量重复值放不进一个桶，只能挂溢出页
+TEST(test_hash_index, duplicate_keys_use_overflow_pages) {
+  std::string file_name = index_file_name("overflow");
+  ::unlink(file_name.c_str());
+  HashIndexHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), INTS, sizeof(int)));
+
+  const int dup_num = 3000;
+  int key = 42;
+  for (int i = 0; i < dup_num; i++) {
+    RID rid = make_rid(i);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&key, &rid));
+  }
+  int other = 43;
+  RID rid = make_rid(0);
+  ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&other, &rid));
+  ASSERT_EQ(dup_num, count_entries(handler, key));
+  ASSERT_EQ(1, count_entries(handler, other));
+
+  for (int i = 0; i < dup_num; i += 3) {
+    rid = make_rid(i);
+    ASSERT_EQ(RC::SUCCESS, handler.delete_entry((const char *)&key, &rid));
+  }
+  ASSERT_EQ(dup_num - (dup_num + 2) / 3, count_entries(handler, key));
+
+  handler.close();
+  theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+}
+
+// 多个线程同时插入相同的key，唯一索引中每个key只能有一个线程成功
+TEST(test_hash_index, concurrent_unique_insert) {
+  std::string file_name = index_file_name("unique");
+  ::unlink(file_name.c_str());
+  HashIndexHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(file_name.c_str(), INTS, sizeof(int)));
+
+  const int key_num = 5000;
+  const int thread_num = 4;
+  std::atomic<int> succeeded(0);
+  std::atomic<int> failed(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_num; t++) {
+    threads.emplace_back([&, t]() {
+      for (int key = 0; key < key_num; key++) {
+        RID rid = make_rid(key * thread_num + t);
+        RC rc = handler.insert_entry((const char *)&key, &rid, true);
+        if (rc == RC::SUCCESS) {
+          succeeded++;
+        } else if (rc != RC::RECORD_DUPLICATE_KEY) {
+          failed++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, failed.load());
+  ASSERT_EQ(key_num, succeeded.load());
+  for (int key = 0; key < key_num; key++) {
+    ASSERT_EQ(1, count_entries(handler, key));
+  }
+
+  handler.close();
+  theGlobalDiskBufferPool()->drop_file(file_name.c_str());
+}
+
+// 浮点数按误差比较相等，不能建hash索引，同一张表的其它字段不受影响
+TEST(test_hash_index, no_hash_index_on_floats) {
+  char dir[] = "/tmp/hash_index_test.XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir));
+  Db db;
+  ASSERT_EQ(RC::SUCCESS, db.init("test", dir));
+  AttrInfo attrs[2];
+  attrs[0].name = (char *)"id";
+  attrs[0].type = INTS;
+  attrs[0].length = sizeof(int);
+  attrs[0].nullable = 0;
+  attrs[1].name = (char *)"f";
+  attrs[1].type = FLOATS;
+  attrs[1].length = sizeof(float);
+  attrs[1].nullable = 0;
+  ASSERT_EQ(RC::SUCCESS, db.create_table("t", 2, attrs));
+  Table *table = db.find_table("t");
+
+  char *float_field[] = {(char *)"f"};
+  char *int_field[] = {(char *)"id"};
+  ASSERT_EQ(RC::SCHEMA_FIELD_TYPE_MISMATCH, table->create_index(nullptr, "i_f", 1, float_field, 0, HASH_INDEX));
+  ASSERT_EQ(RC::SUCCESS, table->create_index(nullptr, "i_f", 1, float_field, 0, BPLUS_TREE_INDEX));
+  ASSERT_EQ(RC::SUCCESS, table->create_index(nullptr, "i_id", 1, int_field, 0, HASH_INDEX));
+
+  ASSERT_EQ(RC::SUCCESS, db.drop_table("t"));
+  ::rmdir(dir);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
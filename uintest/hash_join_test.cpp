@@ -0,0 +1,193 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sql/executor/hash_join_executor.h"
+#include "sql/executor/nest_loop_join_executor.h"
+#include "sql/executor/scan_executor.h"
+#include "sql_test_util.h"
+
+// 测试数据中的一行，a为-1表示null
+struct JoinRow {
+  int a;
+  std::string s;
+};
+
+static std::string row_to_string(const JoinRow &row) {
+  return (row.a < 0 ? std::string("null") : std::to_string(row.a)) + " | " + row.s;
+}
+
+class test_hash_join : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t1(a int nullable, s char(4));"));
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t2(a int nullable, s char(4));"));
+  }
+
+  // 第i行的a为i % distinct，每null_every行有一个null
+  void load(const char *table, std::vector<JoinRow> &rows, int count, int distinct, int null_every) {
+    for (int i = 0; i < count; i++) {
+      JoinRow row;
+      row.a = (null_every > 0 && i % null_every == 0) ? -1 : i % distinct;
+      row.s = std::string(1, 'a' + i % 3) + std::to_string(i % 7);
+      std::string sql = std::string("insert into ") + table + " values(" +
+                        (row.a < 0 ? std::string("null") : std::to_string(row.a)) + ", '" + row.s + "');";
+      ASSERT_EQ(RC::SUCCESS, db_.execute(sql.c_str())) << sql;
+      rows.push_back(row);
+    }
+  }
+
+  static Filter *attr_filter(const char *left_field, CompOp comp_op, const char *right_field) {
+    FilterDesc left = {true, "t1", left_field, Value{}};
+    FilterDesc right = {true, "t2", right_field, Value{}};
+    return new Filter(left, right, comp_op);
+  }
+
+  // 按左表的顺序逐行与右表比较得到的结果
+  std::vector<std::string> expected(bool (*match)(const JoinRow &, const JoinRow &)) {
+    std::vector<std::string> result;
+    for (const JoinRow &left : left_rows_) {
+      for (const JoinRow &right : right_rows_) {
+        if (match(left, right)) {
+          result.push_back(row_to_string(left) + " | " + row_to_string(right));
+        }
+      }
+    }
+    return result;
+  }
+
+  // 用JoinExecutor连接t1和t2，结果按输出的顺序返回
+  template <class JoinExecutor>
+  std::vector<std::string> join(const std::vector<Filter *> &filters) {
+    TupleSchema left_schema;
+    TupleSchema right_schema;
+    TupleSchema::from_table(db_.table("t1"), left_schema);
+    TupleSchema::from_table(db_.table("t2"), right_schema);
+    TupleSchema output_schema;
+    output_schema.append(left_schema);
+    output_schema.append(right_schema);
+
+    ExecutorContext context;
+    ScanExecutor left(&context, db_.table("t1"), left_schema, {}, false);
+    ScanExecutor right(&context, db_.table("t2"), right_schema, {}, false);
+    JoinExecutor join(&context, output_schema, &left, &right, filters);
+    std::vector<std::string> result;
+    EXPECT_EQ(RC::SUCCESS, join.init());
+    TupleSet tuple_set;
+    EXPECT_EQ(RC::SUCCESS, join.next_all(tuple_set));
+    for (const Tuple &tuple : tuple_set.tuples()) {
+      result.push_back(SqlTestDb::tuple_to_string(tuple));
+    }
+    return result;
+  }
+
+protected:
+  SqlTestDb db_;
+  std::vector<JoinRow> left_rows_;
+  std::vector<JoinRow> right_rows_;
+};
+
+static bool equal_a(const JoinRow &left, const JoinRow &right) {
+  return left.a >= 0 && left.a == right.a;
+}
+
+static bool equal_a_and_s_less(const JoinRow &left, const JoinRow &right) {
+  return equal_a(left, right) && left.s < right.s;
+}
+
+static bool equal_s(const JoinRow &left, const JoinRow &right) {
+  return left.s == right.s;
+}
+
+// 右表较小，右表作为build侧，左表跨多个批次流式探测
+TEST_F(test_hash_join, build_right) {
+  load("t1", left_rows_, 3000, 50, 10);
+  load("t2", right_rows_, 200, 60, 7);
+  std::unique_ptr<Filter> filter(attr_filter("a", EQUAL_TO, "a"));
+  std::vector<std::string> expected_rows = expected(equal_a);
+  ASSERT_LT((int)Executor::BATCH_SIZE, (int)expected_rows.size());
+  ASSERT_EQ(expected_rows, join<HashJoinExecutor>({filter.get()}));
+}
+
+// 左表较小，左表作为build侧，输出仍然按左表的顺序
+TEST_F(test_hash_join, build_left) {
+  load("t1", left_rows_, 200, 60, 7);
+  load("t2", right_rows_, 3000, 50, 10);
+  std::unique_ptr<Filter> filter(attr_filter("a", EQUAL_TO, "a"));
+  std::vector<std::string> expected_rows = expected(equal_a);
+  ASSERT_LT((int)Executor::BATCH_SIZE, (int)expected_rows.size());
+  ASSERT_EQ(expected_rows, join<HashJoinExecutor>({filter.get()}));
+}
+
+// 条件写成 t2.a = t1.a 时同样作为hash key
+TEST_F(test_hash_join, reversed_condition) {
+  load("t1", left_rows_, 500, 20, 9);
+  load("t2", right_rows_, 400, 30, 0);
+  FilterDesc left = {true, "t2", "a", Value{}};
+  FilterDesc right = {true, "t1", "a", Value{}};
+  Filter filter(left, right, EQUAL_TO);
+  std::vector<Filter *> filters = {&filter};
+  TupleSchema left_schema;
+  TupleSchema right_schema;
+  TupleSchema::from_table(db_.table("t1"), left_schema);
+  TupleSchema::from_table(db_.table("t2"), right_schema);
+  ASSERT_TRUE(HashJoinExecutor::has_equi_condition(filters, left_schema, right_schema));
+  ASSERT_EQ(expected(equal_a), join<HashJoinExecutor>(filters));
+}
+
+// 字符串作为key，以及hash匹配之后还要检查的非等值条件
+TEST_F(test_hash_join, string_key_and_residual_condition) {
+  load("t1", left_rows_, 700, 40, 5);
+  load("t2", right_rows_, 600, 35, 6);
+  std::unique_ptr<Filter> equal_s_filter(attr_filter("s", EQUAL_TO, "s"));
+  ASSERT_EQ(expected(equal_s), join<HashJoinExecutor>({equal_s_filter.get()}));
+
+  std::unique_ptr<Filter> equal_a_filter(attr_filter("a", EQUAL_TO, "a"));
+  std::unique_ptr<Filter> less_s_filter(attr_filter("s", LESS_THAN, "s"));
+  ASSERT_EQ(expected(equal_a_and_s_less), join<HashJoinExecutor>({equal_a_filter.get(), less_s_filter.get()}));
+}
+
+// 与nested loop join的结果相同
+TEST_F(test_hash_join, same_as_nest_loop_join) {
+  load("t1", left_rows_, 300, 25, 0);
+  load("t2", right_rows_, 250, 25, 0);
+  std::unique_ptr<Filter> filter(attr_filter("a", EQUAL_TO, "a"));
+  std::vector<std::string> hash_rows = join<HashJoinExecutor>({filter.get()});
+  ASSERT_EQ(expected(equal_a), hash_rows);
+  ASSERT_EQ(join<NestLoopJoinExecutor>({filter.get()}), hash_rows);
+}
+
+// null与任何值都不相等，包括另一侧的null
+TEST_F(test_hash_join, null_never_matches) {
+  load("t1", left_rows_, 300, 25, 3);
+  load("t2", right_rows_, 250, 25, 2);
+  std::unique_ptr<Filter> filter(attr_filter("a", EQUAL_TO, "a"));
+  std::vector<std::string> hash_rows = join<HashJoinExecutor>({filter.get()});
+  ASSERT_EQ(expected(equal_a), hash_rows);
+  for (const std::string &row : hash_rows) {
+    ASSERT_EQ(std::string::npos, row.find("null")) << row;
+  }
+}
+
+TEST_F(test_hash_join, empty_input) {
+  load("t1", left_rows_, 100, 10, 0);
+  std::unique_ptr<Filter> filter(attr_filter("a", EQUAL_TO, "a"));
+  ASSERT_TRUE(join<HashJoinExecutor>({filter.get()}).empty());
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,149 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "storage/common/condition_filter.h"
+#include "sql_test_util.h"
+
+static const int ROWS = 6000;
+
+// t(c, a, b, d, e, f)：c = i，其余是i对100、60、70、80、90取模，除了id之外每个字段上都有索引
+class test_index_intersection : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t(id int, c int, a int, b int, d int, e int, f int);"));
+    for (int i = 0; i < ROWS;) {
+      std::string sql = "insert into t values";
+      for (int j = 0; j < 10; i++, j++) {
+        sql += std::string(j == 0 ? "" : ", ") + "(" + std::to_string(i) + ", " + std::to_string(i) + ", " +
+               std::to_string(i % 100) + ", " + std::to_string(i % 60) + ", " + std::to_string(i % 70) + ", " +
+               std::to_string(i % 80) + ", " + std::to_string(i % 90) + ")";
+      }
+      sql += ";";
+      ASSERT_EQ(RC::SUCCESS, db_.execute(sql.c_str()));
+    }
+    for (const char *field : {"c", "a", "b", "d", "e", "f"}) {
+      std::string sql = std::string("create index i") + field + " on t(" + field + ");";
+      ASSERT_EQ(RC::SUCCESS, db_.execute(sql.c_str())) << sql;
+    }
+  }
+
+  void analyze() {
+    Trx trx;
+    ASSERT_EQ(RC::SUCCESS, db_.table("t")->analyze(&trx));
+  }
+
+  // 按where条件扫描t时使用的索引，用逗号连接
+  std::string index_names(const char *where) {
+    std::string names;
+    with_filter(where, [&names](Table *table, CompositeConditionFilter &filter) {
+      std::vector<std::string> index_names;
+      table->scan_index_names(&filter, nullptr, index_names);
+      for (const std::string &name : index_names) {
+        names += (names.empty() ? "" : ",") + name;
+      }
+    });
+    return names;
+  }
+
+  // 按where条件扫描t，返回c字段，保持扫描的顺序
+  std::vector<int> scan(const char *where) {
+    std::vector<int> values;
+    with_filter(where, [&values](Table *table, CompositeConditionFilter &filter) {
+      const int offset = table->table_meta().field("c")->offset();
+      std::pair<std::vector<int> *, int> context(&values, offset);
+      EXPECT_EQ(RC::SUCCESS, table->scan_record(nullptr, &filter, -1, &context, [](const char *data, void *context) {
+        auto &values_and_offset = *(std::pair<std::vector<int> *, int> *)context;
+        values_and_offset.first->push_back(*(const int *)(data + values_and_offset.second));
+      }));
+    });
+    return values;
+  }
+
+  static std::vector<int> expected(std::function<bool(int)> predicate) {
+    std::vector<int> values;
+    for (int i = 0; i < ROWS; i++) {
+      if (predicate(i)) {
+        values.push_back(i);
+      }
+    }
+    return values;
+  }
+
+private:
+  void with_filter(const char *where, std::function<void(Table *, CompositeConditionFilter &)> function) {
+    std::string sql = std::string("select * from t where ") + where + ";";
+    Query *query = query_create();
+    ASSERT_EQ(RC::SUCCESS, parse(sql.c_str(), query)) << sql;
+    const Selects &selects = query->sstr.selection;
+    Table *table = db_.table("t");
+    CompositeConditionFilter filter;
+    ASSERT_EQ(RC::SUCCESS, filter.init(*table, selects.conditions, selects.condition_num)) << sql;
+    function(table, filter);
+    query_destroy(query);
+  }
+
+protected:
+  SqlTestDb db_;
+};
+
+// 没有统计信息时只用一个索引：等值条件优先于范围条件，相同时按条件的顺序
+TEST_F(test_index_intersection, without_stats) {
+  ASSERT_EQ("ia", index_names("a = 5 and b = 5"));
+  ASSERT_EQ("ib", index_names("b = 5 and a = 5"));
+  ASSERT_EQ("ib", index_names("a > 5 and b = 5"));
+  ASSERT_EQ("", index_names("id = 5"));
+  ASSERT_EQ("ic", index_names("id = 5 and c < 100"));
+  ASSERT_EQ(expected([](int i) { return i % 300 == 5; }), scan("a = 5 and b = 5"));
+}
+
+// 有统计信息时选择率最小的索引在前，求交集能减少回表时再加入其它索引
+TEST_F(test_index_intersection, with_stats) {
+  analyze();
+  ASSERT_EQ("ia,ib", index_names("b = 5 and a = 5"));
+  ASSERT_EQ("ic", index_names("a = 5 and c = 105"));
+  // 范围太大的条件读索引的代价超过了减少的回表
+  ASSERT_EQ("ia", index_names("c < 3000 and a = 5"));
+  ASSERT_EQ("ia,ib", index_names("c < 3000 and a = 5 and b = 5"));
+  ASSERT_EQ("", index_names("id = 5"));
+}
+
+// 交集之后按RID的顺序回表，扫描结果与条件的顺序和使用的索引无关
+TEST_F(test_index_intersection, results) {
+  analyze();
+  ASSERT_EQ(expected([](int i) { return i % 300 == 5; }), scan("b = 5 and a = 5"));
+  ASSERT_EQ(expected([](int i) { return i % 300 == 5 && i < 3000; }), scan("c < 3000 and a = 5 and b = 5"));
+  // 5 mod 100 和 7 mod 60 没有公共解，交集为空
+  ASSERT_EQ(std::vector<int>(), scan("a = 5 and b = 7"));
+  ASSERT_EQ(std::vector<int>(), scan("a = 5 and b = 5 and c > 10000"));
+  // 没有用索引的条件在回表之后过滤
+  ASSERT_EQ(std::vector<int>({1505, 1805}), scan("a = 5 and b = 5 and id > 1500 and id < 2000"));
+  ASSERT_EQ(std::vector<std::string>({"305", "5", "605", "905"}),
+            db_.select_sorted("select c from t where a = 5 and b = 5 and c < 1000;"));
+}
+
+// 最多对MAX_INTERSECT_INDEXES个索引求交集
+TEST_F(test_index_intersection, max_indexes) {
+  analyze();
+  const char *where = "a < 50 and b < 30 and d < 35 and e < 40 and f < 45";
+  std::string names = index_names(where);
+  ASSERT_EQ(Table::MAX_INTERSECT_INDEXES, (int)std::count(names.begin(), names.end(), ',') + 1) << names;
+  ASSERT_EQ(expected([](int i) { return i % 100 < 50 && i % 60 < 30 && i % 70 < 35 && i % 80 < 40 && i % 90 < 45; }),
+            scan(where));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,206 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sql/executor/index_nest_loop_join_executor.h"
+#include "sql/executor/scan_executor.h"
+#include "sql_test_util.h"
+
+static const int T1_ROWS = 1500;
+static const int T2_ROWS = 2000;
+
+// t1(a, s)：a每10行有一个null，s与t2的s有一部分相同；t2(b, s, x)：b和s上有索引，b有重复
+class test_index_nest_loop_join : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t1(a int nullable, s char(4));"));
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t2(b int, s char(4), x int);"));
+    for (int i = 0; i < T1_ROWS; i++) {
+      t1_a_.push_back(i % 10 == 0 ? -1 : i % 700);
+      t1_s_.push_back(key_string(i % 50));
+      std::string sql = "insert into t1 values(" + (t1_a_[i] < 0 ? std::string("null") : std::to_string(t1_a_[i])) +
+                        ", '" + t1_s_[i] + "');";
+      ASSERT_EQ(RC::SUCCESS, db_.execute(sql.c_str()));
+    }
+    for (int i = 0; i < T2_ROWS; i++) {
+      t2_b_.push_back(i % 1000);
+      t2_s_.push_back(key_string(i % 80));
+      t2_x_.push_back(i % 4);
+      std::string sql = "insert into t2 values(" + std::to_string(t2_b_[i]) + ", '" + t2_s_[i] + "', " +
+                        std::to_string(t2_x_[i]) + ");";
+      ASSERT_EQ(RC::SUCCESS, db_.execute(sql.c_str()));
+    }
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create index i_b on t2(b);"));
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create index i_s on t2(s);"));
+    TupleSchema::from_table(db_.table("t1"), t1_schema_);
+    TupleSchema::from_table(db_.table("t2"), t2_schema_);
+    output_schema_.append(t1_schema_);
+    output_schema_.append(t2_schema_);
+  }
+
+  // 长度为4的字符串占满CHAR(4)，查找时整个值都要参与比较
+  static std::string key_string(int i) {
+    char buf[8];
+    snprintf(buf, sizeof(buf), "k%03d", i);
+    return buf;
+  }
+
+  static Filter *join_filter(const char *left_field, CompOp comp_op, const char *right_field) {
+    FilterDesc left = {true, "t1", left_field, Value{}};
+    FilterDesc right = {true, "t2", right_field, Value{}};
+    return new Filter(left, right, comp_op);
+  }
+
+  std::string t1_row(int i) const {
+    return (t1_a_[i] < 0 ? std::string("null") : std::to_string(t1_a_[i])) + " | " + t1_s_[i];
+  }
+
+  std::string t2_row(int j) const {
+    return std::to_string(t2_b_[j]) + " | " + t2_s_[j] + " | " + std::to_string(t2_x_[j]);
+  }
+
+  // 按左表的顺序逐行比较得到的结果
+  template <class Match>
+  std::vector<std::string> expected(Match match) const {
+    std::vector<std::string> rows;
+    for (int i = 0; i < T1_ROWS; i++) {
+      for (int j = 0; j < T2_ROWS; j++) {
+        if (match(i, j)) {
+          rows.push_back(t1_row(i) + " | " + t2_row(j));
+        }
+      }
+    }
+    return rows;
+  }
+
+  // right_filters为右表自己的条件
+  std::vector<std::string> join(const std::vector<Filter *> &filters, std::vector<Filter *> right_filters = {}) {
+    ExecutorContext context;
+    ScanExecutor left(&context, db_.table("t1"), t1_schema_, {}, false);
+    ScanExecutor right(&context, db_.table("t2"), t2_schema_, std::move(right_filters), false);
+    IndexNestLoopJoinExecutor join(&context, output_schema_, &left, &right, filters);
+    std::vector<std::string> rows;
+    EXPECT_EQ(RC::SUCCESS, join.init());
+    TupleSet tuple_set;
+    RC rc;
+    while ((rc = join.next(tuple_set)) == RC::SUCCESS) {
+      EXPECT_GE((int)Executor::BATCH_SIZE, tuple_set.size());
+      for (const Tuple &tuple : tuple_set.tuples()) {
+        rows.push_back(SqlTestDb::tuple_to_string(tuple));
+      }
+    }
+    EXPECT_EQ(RC::RECORD_EOF, rc);
+    return rows;
+  }
+
+  // 右表的记录按索引的顺序取出，只检查左表的顺序，同一个左表行的结果不比较顺序
+  static void check_join_result(std::vector<std::string> expected_rows, std::vector<std::string> rows) {
+    ASSERT_EQ(expected_rows.size(), rows.size());
+    for (size_t i = 0; i < rows.size(); i++) {
+      // 左表的两列
+      size_t expected_end = expected_rows[i].find(" | ", expected_rows[i].find(" | ") + 3);
+      ASSERT_EQ(expected_rows[i].substr(0, expected_end), rows[i].substr(0, expected_end)) << i;
+    }
+    std::sort(expected_rows.begin(), expected_rows.end());
+    std::sort(rows.begin(), rows.end());
+    ASSERT_EQ(expected_rows, rows);
+  }
+
+protected:
+  SqlTestDb db_;
+  TupleSchema t1_schema_;
+  TupleSchema t2_schema_;
+  TupleSchema output_schema_;
+  std::vector<int> t1_a_;
+  std::vector<std::string> t1_s_;
+  std::vector<int> t2_b_;
+  std::vector<std::string> t2_s_;
+  std::vector<int> t2_x_;
+};
+
+TEST_F(test_index_nest_loop_join, find_index_key) {
+  int left_index = -1;
+  const FieldMeta *right_field = nullptr;
+  std::unique_ptr<Filter> equal_a(join_filter("a", EQUAL_TO, "b"));
+  ASSERT_TRUE(IndexNestLoopJoinExecutor::find_index_key({equal_a.get()}, t1_schema_, db_.table("t2"),
+                                                        &left_index, &right_field));
+  ASSERT_EQ(0, left_index);
+  ASSERT_STREQ("b", right_field->name());
+
+  // x上没有索引，非等值条件不能用于查找
+  std::unique_ptr<Filter> equal_x(join_filter("a", EQUAL_TO, "x"));
+  std::unique_ptr<Filter> less_b(join_filter("a", LESS_THAN, "b"));
+  ASSERT_FALSE(IndexNestLoopJoinExecutor::find_index_key({equal_x.get(), less_b.get()}, t1_schema_,
+                                                         db_.table("t2"), &left_index, &right_field));
+}
+
+// 左侧跨越多个批次，右表的key有重复，左侧的null不匹配任何记录
+TEST_F(test_index_nest_loop_join, int_key) {
+  std::unique_ptr<Filter> filter(join_filter("a", EQUAL_TO, "b"));
+  std::vector<std::string> expected_rows = expected([this](int i, int j) { return t1_a_[i] >= 0 && t1_a_[i] == t2_b_[j]; });
+  ASSERT_LT((int)Executor::BATCH_SIZE, (int)expected_rows.size());
+  check_join_result(expected_rows, join({filter.get()}));
+}
+
+// 占满字段长度的CHAR值作为key
+TEST_F(test_index_nest_loop_join, full_length_char_key) {
+  std::unique_ptr<Filter> filter(join_filter("s", EQUAL_TO, "s"));
+  std::vector<std::string> expected_rows = expected([this](int i, int j) { return t1_s_[i] == t2_s_[j]; });
+  ASSERT_FALSE(expected_rows.empty());
+  check_join_result(expected_rows, join({filter.get()}));
+}
+
+// 其余的连接条件和右表自己的条件
+TEST_F(test_index_nest_loop_join, other_conditions) {
+  std::unique_ptr<Filter> equal_a(join_filter("a", EQUAL_TO, "b"));
+  std::unique_ptr<Filter> less_s(join_filter("s", LESS_THAN, "s"));
+  Value two;
+  value_init_integer(&two, 2);
+  FilterDesc x_left = {true, "t2", "x", Value{}};
+  FilterDesc x_right = {false, "", "", two};
+  Filter *x_filter = new Filter(x_left, x_right, GREAT_EQUAL);
+  std::vector<std::string> expected_rows = expected([this](int i, int j) {
+    return t1_a_[i] >= 0 && t1_a_[i] == t2_b_[j] && t1_s_[i] < t2_s_[j] && t2_x_[j] >= 2;
+  });
+  ASSERT_FALSE(expected_rows.empty());
+  check_join_result(expected_rows, join({equal_a.get(), less_s.get()}, {x_filter}));
+  delete x_filter;
+  value_destroy(&two);
+}
+
+// 左表很小、右表很大时ExecutorBuilder选择index nested loop join，结果与逐行比较相同
+TEST_F(test_index_nest_loop_join, chosen_by_builder) {
+  ASSERT_EQ(RC::SUCCESS, db_.execute("create table t3(c int);"));
+  ASSERT_EQ(RC::SUCCESS, db_.execute("insert into t3 values(3);"));
+  ASSERT_EQ(RC::SUCCESS, db_.execute("insert into t3 values(998);"));
+  ASSERT_EQ(RC::SUCCESS, db_.execute("insert into t3 values(5000);"));
+  std::vector<std::string> rows = db_.select_sorted("select * from t3, t2 where t3.c = t2.b;");
+  std::vector<std::string> expected_rows;
+  for (int c : {3, 998}) {
+    for (int j = 0; j < T2_ROWS; j++) {
+      if (t2_b_[j] == c) {
+        expected_rows.push_back(std::to_string(c) + " | " + t2_row(j));
+      }
+    }
+  }
+  std::sort(expected_rows.begin(), expected_rows.end());
+  ASSERT_EQ(expected_rows, rows);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,171 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "storage/common/bplus_tree.h"
+#include "storage/common/condition_filter.h"
+#include "storage/common/db.h"
+#include "storage/common/meta_util.h"
+#include "storage/common/table.h"
+#include "storage/trx/trx.h"
+#include "gtest/gtest.h"
+
+struct ScanContext {
+  int key_offset = 0;
+  std::vector<int> keys;
+  std::function<void()> on_first_key;
+};
+
+static void read_key(const char *data, void *context) {
+  ScanContext &scan_context = *(ScanContext *)context;
+  scan_context.keys.push_back(*(const int *)(data + scan_context.key_offset));
+  if (scan_context.keys.size() == 1 && scan_context.on_first_key) {
+    scan_context.on_first_key();
+  }
+}
+
+static RC insert_int(Table *table, Trx *trx, int v) {
+  Value value;
+  value_init_integer(&value, v);
+  RC rc = table->insert_record(trx, 1, &value);
+  value_destroy(&value);
+  return rc;
+}
+
+class test_index_only_scan : public ::testing::Test {
+protected:
+  void SetUp() override {
+    strcpy(dir_, "/tmp/index_only_scan_test.XXXXXX");
+    ASSERT_NE(nullptr, mkdtemp(dir_));
+    db_.reset(new Db());
+    ASSERT_EQ(RC::SUCCESS, db_->init("test", dir_));
+    AttrInfo attr;
+    attr.name = (char *)"id";
+    attr.type = INTS;
+    attr.length = sizeof(int);
+    attr.nullable = 0;
+    ASSERT_EQ(RC::SUCCESS, db_->create_table("t", 1, &attr));
+    table_ = db_->find_table("t");
+    char *field[] = {(char *)"id"};
+    ASSERT_EQ(RC::SUCCESS, table_->create_index(nullptr, "i_id", 1, field, 0, BPLUS_TREE_INDEX));
+    Trx trx;
+    for (int i = 0; i < 10; i++) {
+      ASSERT_EQ(RC::SUCCESS, insert_int(table_, &trx, i));
+    }
+    ASSERT_EQ(RC::SUCCESS, trx.commit());
+    init_filter();
+  }
+
+  void TearDown() override {
+    db_->drop_table("t");
+    db_.reset();
+    ::rmdir(dir_);
+  }
+
+  // id >= 0
+  void init_filter() {
+    const FieldMeta *field_meta = table_->table_meta().field("id");
+    ConDesc left = {true, table_->table_meta().field_index("id"), field_meta->len(), field_meta->offset(), false, nullptr};
+    ConDesc right = {false, 0, 0, 0, false, &zero_};
+    filter_.reset(new DefaultConditionFilter());
+    ASSERT_EQ(RC::SUCCESS, filter_->init(table_, left, right, INTS, GREAT_EQUAL));
+    context_.key_offset = field_meta->offset();
+  }
+
+  void reopen() {
+    db_.reset(new Db());
+    ASSERT_EQ(RC::SUCCESS, db_->init("test", dir_));
+    table_ = db_->find_table("t");
+    ASSERT_NE(nullptr, table_);
+    init_filter();
+  }
+
+  RC scan(Trx *trx) {
+    context_.keys.clear();
+    return table_->scan_record_index_only(trx, filter_.get(), "id", -1, &context_, read_key);
+  }
+
+  char dir_[64];
+  std::unique_ptr<Db> db_;
+  Table *table_ = nullptr;
+  int zero_ = 0;
+  std::unique_ptr<DefaultConditionFilter> filter_;
+  ScanContext context_;
+};
+
+TEST_F(test_index_only_scan, committed_rows) {
+  Trx trx;
+  ASSERT_EQ(RC::SUCCESS, scan(&trx));
+  ASSERT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), context_.keys);
+}
+
+// 已有未提交的修改时不走只读索引的扫描
+TEST_F(test_index_only_scan, refuse_with_pending_operations) {
+  Trx writer;
+  ASSERT_EQ(RC::SUCCESS, insert_int(table_, &writer, 100));
+  Trx reader;
+  ASSERT_EQ(RC::SCHEMA_INDEX_NOT_EXIST, scan(&reader));
+  ASSERT_EQ(RC::SUCCESS, writer.rollback());
+}
+
+// 扫描开始之后其它事务插入的key，在提交之前对扫描的事务不可见
+TEST_F(test_index_only_scan, insert_during_scan) {
+  Trx writer;
+  context_.on_first_key = [&]() {
+    ASSERT_EQ(RC::SUCCESS, insert_int(table_, &writer, 100));
+    ASSERT_EQ(RC::SUCCESS, insert_int(table_, &writer, 5));
+  };
+  Trx reader;
+  ASSERT_EQ(RC::SUCCESS, scan(&reader));
+  ASSERT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), context_.keys);
+
+  // 插入数据的事务自己可以看到，但已有未提交数据时不会走只读索引的扫描
+  ASSERT_EQ(RC::SUCCESS, writer.commit());
+  context_.on_first_key = nullptr;
+  ASSERT_EQ(RC::SUCCESS, scan(&reader));
+  ASSERT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5, 5, 6, 7, 8, 9, 100}), context_.keys);
+}
+
+// 打开旧版本的索引文件时按当前格式从数据重建
+TEST_F(test_index_only_scan, rebuild_old_format_index) {
+  std::string index_file = index_data_file(dir_, "t", "i_id");
+  db_.reset();
+  FILE *file = fopen(index_file.c_str(), "r+b");
+  ASSERT_NE(nullptr, file);
+  const int old_version = INDEX_FILE_VERSION - 1;
+  ASSERT_EQ(0, fseek(file, BP_PAGE_SIZE + offsetof(Page, data) + offsetof(IndexFileHeader, version), SEEK_SET));
+  ASSERT_EQ(1u, fwrite(&old_version, sizeof(old_version), 1, file));
+  fclose(file);
+
+  reopen();
+  Trx trx;
+  ASSERT_EQ(RC::SUCCESS, scan(&trx));
+  ASSERT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), context_.keys);
+  ASSERT_EQ(RC::SUCCESS, insert_int(table_, &trx, 10));
+  ASSERT_EQ(RC::SUCCESS, trx.commit());
+  ASSERT_EQ(RC::SUCCESS, scan(&trx));
+  ASSERT_EQ(11u, context_.keys.size());
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
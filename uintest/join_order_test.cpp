@@ -0,0 +1,194 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sql/optimizer/join_order.h"
+#include "sql_test_util.h"
+
+// C_out：除第一张表之外，每一步连接之后的中间结果行数之和
+static double cost_of(const JoinOrderOptimizer &optimizer, const std::vector<int> &order) {
+  double cost = 0;
+  for (size_t i = 2; i <= order.size(); i++) {
+    cost += optimizer.estimate_rows(order, i);
+  }
+  return cost;
+}
+
+static bool is_permutation_of(const std::vector<int> &order, int n) {
+  std::vector<int> sorted = order;
+  std::sort(sorted.begin(), sorted.end());
+  for (int i = 0; i < n; i++) {
+    if ((int)sorted.size() != n || sorted[i] != i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST(test_join_order, estimate_rows) {
+  JoinOrderOptimizer optimizer;
+  int a = optimizer.add_table(100);
+  int b = optimizer.add_table(20);
+  int c = optimizer.add_table(5);
+  optimizer.add_edge(a, b, 0.01);
+  optimizer.add_edge(b, c, 0.5);
+  std::vector<int> order = {a, c, b};
+  ASSERT_DOUBLE_EQ(100, optimizer.estimate_rows(order, 1));
+  // a和c之间没有条件，是笛卡尔积
+  ASSERT_DOUBLE_EQ(500, optimizer.estimate_rows(order, 2));
+  ASSERT_DOUBLE_EQ(500 * 20 * 0.01 * 0.5, optimizer.estimate_rows(order, 3));
+  // 连接之后的行数与顺序无关
+  ASSERT_DOUBLE_EQ(optimizer.estimate_rows(order, 3), optimizer.estimate_rows({b, a, c}, 3));
+}
+
+// 动态规划得到的顺序的代价与枚举所有顺序得到的最小代价相同
+TEST(test_join_order, dp_is_optimal) {
+  srand(12345);
+  for (int round = 0; round < 50; round++) {
+    JoinOrderOptimizer optimizer;
+    const int n = 2 + round % 6;
+    for (int i = 0; i < n; i++) {
+      optimizer.add_table(1 + rand() % 10000);
+    }
+    for (int i = 0; i < n; i++) {
+      for (int j = i + 1; j < n; j++) {
+        if (rand() % 3 == 0) {
+          optimizer.add_edge(i, j, 1.0 / (1 + rand() % 1000));
+        }
+      }
+    }
+    std::vector<int> order = optimizer.optimize();
+    ASSERT_TRUE(is_permutation_of(order, n));
+
+    std::vector<int> permutation(n);
+    for (int i = 0; i < n; i++) {
+      permutation[i] = i;
+    }
+    double best = -1;
+    do {
+      double cost = cost_of(optimizer, permutation);
+      if (best < 0 || cost < best) {
+        best = cost;
+      }
+    } while (std::next_permutation(permutation.begin(), permutation.end()));
+    ASSERT_NEAR(best, cost_of(optimizer, order), best * 1e-9) << "round " << round;
+  }
+}
+
+// 代价相同时保持加入的顺序；没有连接条件的表放在后面
+TEST(test_join_order, ties_and_cartesian) {
+  JoinOrderOptimizer same;
+  for (int i = 0; i < 4; i++) {
+    same.add_table(10);
+  }
+  ASSERT_EQ(std::vector<int>({0, 1, 2, 3}), same.optimize());
+
+  JoinOrderOptimizer optimizer;
+  int big = optimizer.add_table(1000);
+  int alone = optimizer.add_table(50);
+  int small = optimizer.add_table(10);
+  optimizer.add_edge(big, small, 0.001);
+  std::vector<int> order = optimizer.optimize();
+  ASSERT_EQ(alone, order[2]);
+}
+
+// 表太多时按贪心选择：先选最小的表，之后每次加入使中间结果最小的表
+TEST(test_join_order, greedy_for_many_tables) {
+  const int n = JoinOrderOptimizer::MAX_DP_TABLES + 2;
+  JoinOrderOptimizer optimizer;
+  for (int i = 0; i < n; i++) {
+    optimizer.add_table(i == 5 ? 1 : 100);
+  }
+  // 链状的连接图 0-1-2-...-(n-1)
+  for (int i = 0; i + 1 < n; i++) {
+    optimizer.add_edge(i, i + 1, 0.01);
+  }
+  std::vector<int> expected = {5, 4, 3, 2, 1, 0};
+  for (int i = 6; i < n; i++) {
+    expected.push_back(i);
+  }
+  std::vector<int> order = optimizer.optimize();
+  ASSERT_EQ(expected, order);
+  ASSERT_DOUBLE_EQ(1, optimizer.estimate_rows(order, n));
+}
+
+// 按表的记录数和条件选出FROM中多张表的顺序，子查询中的表也一样
+TEST(test_join_order, optimize_join_order) {
+  SqlTestDb db;
+  ASSERT_EQ(RC::SUCCESS, db.execute("create table big(id int, v int);"));
+  ASSERT_EQ(RC::SUCCESS, db.execute("create table mid(id int, big_id int);"));
+  ASSERT_EQ(RC::SUCCESS, db.execute("create table small(id int, mid_id int);"));
+  ASSERT_EQ(RC::SUCCESS, db.execute("create table k1(v int);"));
+  ASSERT_EQ(RC::SUCCESS, db.execute("create table k2(v int);"));
+  ASSERT_EQ(RC::SUCCESS, db.execute("insert into k1 values(0), (1), (2), (3), (4);"));
+  ASSERT_EQ(RC::SUCCESS, db.execute("insert into k2 values(0), (2);"));
+  for (int i = 0; i < 2000; i++) {
+    std::string sql = "insert into big values(" + std::to_string(i) + ", " + std::to_string(i % 10) + ");";
+    ASSERT_EQ(RC::SUCCESS, db.execute(sql.c_str()));
+    if (i < 200) {
+      sql = "insert into mid values(" + std::to_string(i) + ", " + std::to_string(i * 10) + ");";
+      ASSERT_EQ(RC::SUCCESS, db.execute(sql.c_str()));
+    }
+    if (i < 5) {
+      sql = "insert into small values(" + std::to_string(i) + ", " + std::to_string(i * 40) + ");";
+      ASSERT_EQ(RC::SUCCESS, db.execute(sql.c_str()));
+    }
+  }
+
+  // 没有统计信息时按页数估计行数，mid和small都只有一页，small上的条件使它成为最小的表
+  const char *sql = "select big.id from big, mid, small where big.id = mid.big_id and mid.id = small.mid_id "
+                    "and small.id < 3 and big.v in (select k1.v from k1, k2 where k1.v = k2.v);";
+  Query *query = query_create();
+  ASSERT_EQ(RC::SUCCESS, parse(sql, query));
+  Selects &selects = query->sstr.selection;
+  optimize_join_order(db.db(), &selects);
+  auto order_of = [](const Selects &selects) {
+    std::vector<std::string> order;
+    for (size_t i = 0; i < selects.join_order_num; i++) {
+      order.push_back(selects.relations[selects.join_order[i]]);
+    }
+    return order;
+  };
+  // 前两张表交换顺序时C_out相同，只检查big最后连接
+  std::vector<std::string> order = order_of(selects);
+  ASSERT_EQ(3u, order.size());
+  ASSERT_EQ("big", order[2]);
+  const Condition &sub_query = selects.conditions[selects.condition_num - 1].right_is_select
+                                   ? selects.conditions[selects.condition_num - 1]
+                                   : selects.conditions[0];
+  ASSERT_TRUE(sub_query.right_is_select);
+  ASSERT_EQ(2u, order_of(*sub_query.right_selects).size());
+
+  // 按选出的顺序执行，结果不变
+  ExecutorBuilder builder(db.db());
+  std::unique_ptr<Executor> executor(builder.build(&selects));
+  ASSERT_EQ(RC::SUCCESS, executor->init());
+  TupleSet result;
+  ASSERT_EQ(RC::SUCCESS, executor->next_all(result));
+  std::vector<std::string> rows;
+  for (const Tuple &tuple : result.tuples()) {
+    rows.push_back(SqlTestDb::tuple_to_string(tuple));
+  }
+  std::sort(rows.begin(), rows.end());
+  ASSERT_EQ(std::vector<std::string>({"0", "400", "800"}), rows);
+  ASSERT_EQ(rows, db.select_sorted(sql));
+  query_destroy(query);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,167 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sql/executor/late_materialize_executor.h"
+#include "sql/executor/nest_loop_join_executor.h"
+#include "sql/executor/scan_executor.h"
+#include "sql_test_util.h"
+
+static const int T1_ROWS = 3000;
+static const int T2_ROWS = 40;
+
+// t1(id, b, s)：b每7行有一个null，记录跨越多个页面；t2(k, v)
+class test_late_materialize : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t1(id int, b int nullable, s char(16));"));
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t2(k int, v char(8));"));
+    for (int i = 0; i < T1_ROWS; i++) {
+      std::string sql = "insert into t1 values(" + std::to_string(i) + ", " +
+                        (i % 7 == 0 ? std::string("null") : std::to_string(i * 3)) + ", '" + s_value(i) + "');";
+      ASSERT_EQ(RC::SUCCESS, db_.execute(sql.c_str())) << sql;
+    }
+    for (int i = 0; i < T2_ROWS; i++) {
+      std::string sql = "insert into t2 values(" + std::to_string(i * 50) + ", 'v" + std::to_string(i) + "');";
+      ASSERT_EQ(RC::SUCCESS, db_.execute(sql.c_str())) << sql;
+    }
+  }
+
+  static std::string s_value(int i) {
+    return "row-" + std::to_string(i);
+  }
+
+  static std::string t1_row(int i) {
+    return std::to_string(i) + " | " + (i % 7 == 0 ? std::string("null") : std::to_string(i * 3)) + " | " +
+           s_value(i);
+  }
+
+  // 扫描t1的id和rid，b和s延迟读取
+  LateMaterializeExecutor::LateTable late_t1() {
+    LateMaterializeExecutor::LateTable late_table{db_.table("t1"), TupleSchema()};
+    late_table.fields.add(INTS, "t1", "b");
+    late_table.fields.add(CHARS, "t1", "s");
+    return late_table;
+  }
+
+  TupleSchema t1_rid_schema() {
+    TupleSchema schema;
+    schema.add(INTS, "t1", "id");
+    schema.add(INTS, "t1", TupleRecordConverter::RID_PAGE_FIELD);
+    schema.add(INTS, "t1", TupleRecordConverter::RID_SLOT_FIELD);
+    return schema;
+  }
+
+  static RC drain(Executor &executor, std::vector<std::string> &rows) {
+    rows.clear();
+    TupleSet tuple_set;
+    RC rc;
+    while ((rc = executor.next(tuple_set)) == RC::SUCCESS) {
+      EXPECT_GE((int)Executor::BATCH_SIZE, tuple_set.size());
+      for (const Tuple &tuple : tuple_set.tuples()) {
+        rows.push_back(SqlTestDb::tuple_to_string(tuple));
+      }
+    }
+    return rc == RC::RECORD_EOF ? RC::SUCCESS : rc;
+  }
+
+protected:
+  SqlTestDb db_;
+  ExecutorContext context_;
+};
+
+// 按rid读出的字段与完整扫描相同，跨越多个批次，rewind之后重新读取
+TEST_F(test_late_materialize, fetch_by_rid) {
+  ScanExecutor scan(&context_, db_.table("t1"), t1_rid_schema(), {}, false);
+  LateMaterializeExecutor late(&context_, &scan, {late_t1()});
+  TupleSchema output_schema = late.output_schema();
+  ASSERT_EQ(3, (int)output_schema.fields().size());
+  ASSERT_STREQ("id", output_schema.field(0).field_name());
+  ASSERT_STREQ("b", output_schema.field(1).field_name());
+  ASSERT_STREQ("s", output_schema.field(2).field_name());
+
+  ASSERT_EQ(RC::SUCCESS, late.init());
+  std::vector<std::string> rows;
+  ASSERT_EQ(RC::SUCCESS, drain(late, rows));
+  ASSERT_EQ(T1_ROWS, (int)rows.size());
+  for (int i = 0; i < T1_ROWS; i++) {
+    ASSERT_EQ(t1_row(i), rows[i]);
+  }
+
+  ASSERT_EQ(RC::SUCCESS, late.rewind());
+  std::vector<std::string> rewound_rows;
+  ASSERT_EQ(RC::SUCCESS, drain(late, rewound_rows));
+  ASSERT_EQ(rows, rewound_rows);
+}
+
+// join之后的rid不再按页面的顺序排列，同一条记录可以出现多次
+TEST_F(test_late_materialize, after_join) {
+  TupleSchema t2_schema;
+  TupleSchema::from_table(db_.table("t2"), t2_schema);
+  TupleSchema join_schema;
+  join_schema.append(t2_schema);
+  join_schema.append(t1_rid_schema());
+  ScanExecutor left(&context_, db_.table("t2"), t2_schema, {}, false);
+  ScanExecutor right(&context_, db_.table("t1"), t1_rid_schema(), {}, false);
+  FilterDesc left_desc = {true, "t2", "k", Value{}};
+  FilterDesc right_desc = {true, "t1", "id", Value{}};
+  Filter filter(left_desc, right_desc, LESS_EQUAL);
+  NestLoopJoinExecutor join(&context_, join_schema, &left, &right, {&filter});
+  LateMaterializeExecutor late(&context_, &join, {late_t1()});
+  ASSERT_EQ(RC::SUCCESS, late.init());
+
+  std::vector<std::string> rows;
+  ASSERT_EQ(RC::SUCCESS, drain(late, rows));
+  std::vector<std::string> expected_rows;
+  for (int j = 0; j < T2_ROWS; j++) {
+    for (int i = j * 50; i < T1_ROWS; i++) {
+      expected_rows.push_back(std::to_string(j * 50) + " | v" + std::to_string(j) + " | " + t1_row(i));
+    }
+  }
+  // nested loop join按左右两批组合输出，不比较顺序
+  std::sort(expected_rows.begin(), expected_rows.end());
+  std::sort(rows.begin(), rows.end());
+  ASSERT_EQ(expected_rows, rows);
+}
+
+// 多表有连接条件时ExecutorBuilder对只用于输出的字段使用延迟物化，结果不变
+TEST_F(test_late_materialize, chosen_by_builder) {
+  const char *sql = "select t1.s, t2.v, t1.b from t1, t2 where t1.id = t2.k and t1.id < 500;";
+  Query *query = query_create();
+  ASSERT_EQ(RC::SUCCESS, parse(sql, query));
+  ExecutorBuilder builder(db_.db());
+  std::unique_ptr<Executor> executor(builder.build(&query->sstr.selection));
+  TupleSchema scan_schema;
+  builder.build_scan_schema(&query->sstr.selection, db_.table("t1"), scan_schema);
+  query_destroy(query);
+  ASSERT_EQ(3, (int)scan_schema.fields().size());
+  ASSERT_STREQ("id", scan_schema.field(0).field_name());
+  ASSERT_STREQ(TupleRecordConverter::RID_PAGE_FIELD, scan_schema.field(1).field_name());
+  ASSERT_STREQ(TupleRecordConverter::RID_SLOT_FIELD, scan_schema.field(2).field_name());
+
+  std::vector<std::string> expected_rows;
+  for (int i = 0; i < 500; i += 50) {
+    expected_rows.push_back(s_value(i) + " | v" + std::to_string(i / 50) + " | " +
+                            (i % 7 == 0 ? std::string("null") : std::to_string(i * 3)));
+  }
+  std::sort(expected_rows.begin(), expected_rows.end());
+  ASSERT_EQ(expected_rows, db_.select_sorted(sql));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
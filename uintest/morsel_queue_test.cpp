@@ -0,0 +1,104 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "sql/executor/morsel_queue.h"
+#include "gtest/gtest.h"
+
+static const int MORSEL_RECORDS = 20000;
+
+// 与WorkerPool相同：各线程按编号顺序领取morsel，每条记录是morsel * MORSEL_RECORDS + i
+static void produce(MorselQueue &queue, int worker, int morsel_count, std::atomic<int> &next_morsel) {
+  int morsel;
+  while ((morsel = next_morsel.fetch_add(1)) < morsel_count) {
+    for (int i = 0; i < MORSEL_RECORDS; i++) {
+      int value = morsel * MORSEL_RECORDS + i;
+      if (!queue.push(worker, morsel, (const char *)&value)) {
+        break;
+      }
+    }
+    queue.finish_morsel(worker, morsel);
+  }
+}
+
+TEST(test_morsel_queue, records_in_morsel_order) {
+  const int morsel_count = 8;
+  const int dop = 3;
+  // 上限比一个morsel小得多，扫描线程会反复等待消费者
+  MorselQueue queue(morsel_count, dop, sizeof(int), 4 * MorselQueue::FLUSH_SIZE);
+  std::atomic<int> next_morsel{0};
+  std::vector<std::thread> producers;
+  for (int worker = 0; worker < dop; worker++) {
+    producers.emplace_back(produce, std::ref(queue), worker, morsel_count, std::ref(next_morsel));
+  }
+  std::thread driver([&]() {
+    for (std::thread &producer : producers) {
+      producer.join();
+    }
+    queue.finish(RC::SUCCESS);
+  });
+
+  std::vector<char> records;
+  int count = 0;
+  int expected = 0;
+  RC rc;
+  while ((rc = queue.pop(1000, records, count)) == RC::SUCCESS) {
+    ASSERT_GT(count, 0);
+    ASSERT_LE(count, 1000);
+    for (int i = 0; i < count; i++) {
+      int value;
+      memcpy(&value, records.data() + i * sizeof(int), sizeof(int));
+      ASSERT_EQ(expected++, value);
+    }
+  }
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  ASSERT_EQ(morsel_count * MORSEL_RECORDS, expected);
+  driver.join();
+}
+
+TEST(test_morsel_queue, cancel_releases_producers) {
+  const int morsel_count = 16;
+  const int dop = 2;
+  MorselQueue queue(morsel_count, dop, sizeof(int), MorselQueue::FLUSH_SIZE);
+  std::atomic<int> next_morsel{0};
+  std::thread first(produce, std::ref(queue), 0, morsel_count, std::ref(next_morsel));
+  std::thread second(produce, std::ref(queue), 1, morsel_count, std::ref(next_morsel));
+
+  std::vector<char> records;
+  int count = 0;
+  ASSERT_EQ(RC::SUCCESS, queue.pop(10, records, count));
+  ASSERT_EQ(10, count);
+  // 消费者不再读取，等待中的扫描线程必须能够返回
+  queue.cancel();
+  first.join();
+  second.join();
+  ASSERT_EQ(RC::RECORD_EOF, queue.pop(10, records, count));
+  ASSERT_EQ(0, count);
+}
+
+TEST(test_morsel_queue, scan_error) {
+  MorselQueue queue(2, 1, sizeof(int), MorselQueue::FLUSH_SIZE);
+  int value = 1;
+  ASSERT_TRUE(queue.push(0, 0, (const char *)&value));
+  queue.finish(RC::INTERNAL);
+  std::vector<char> records;
+  int count = 0;
+  ASSERT_EQ(RC::INTERNAL, queue.pop(10, records, count));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
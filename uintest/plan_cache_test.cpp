@@ -0,0 +1,337 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "sql/plan_cache/plan_cache.h"
+#include "sql/plan_cache/prepared_statement.h"
+#include "storage/common/db.h"
+#include "storage/common/table.h"
+#include "gtest/gtest.h"
+
+// 按query_copy遍历的顺序记录语句中所有的常量
+static void record_value(const Value *src, Value *dst, void *context) {
+  value_copy(src, dst);
+  std::vector<std::string> *values = (std::vector<std::string> *)context;
+  if (src->isnull || src->data == nullptr) {
+    values->push_back("null");
+    return;
+  }
+  switch (src->type) {
+    case INTS: {
+      values->push_back("i" + std::to_string(*(int *)src->data));
+    } break;
+    case FLOATS: {
+      values->push_back("f" + std::to_string(*(float *)src->data));
+    } break;
+    case CHARS: {
+      values->push_back("s" + std::string((const char *)src->data));
+    } break;
+    default: {
+      values->push_back("t" + std::to_string(src->type));
+    } break;
+  }
+}
+
+static std::vector<std::string> values_of(const Query *query) {
+  std::vector<std::string> values;
+  Query *copy = query_copy(query, record_value, &values);
+  EXPECT_NE(nullptr, copy);
+  if (copy != nullptr) {
+    query_destroy(copy);
+  }
+  return values;
+}
+
+static Query *parse_sql(const char *sql, ParsedLiterals *literals = nullptr) {
+  Query *query = query_create();
+  if (parse(sql, query, literals) != RC::SUCCESS) {
+    query_destroy(query);
+    return nullptr;
+  }
+  return query;
+}
+
+static std::shared_ptr<CachedPlan> create_plan(const char *sql) {
+  NormalizedSql normalized;
+  if (!normalize_sql(sql, normalized)) {
+    return nullptr;
+  }
+  ParsedLiterals literals;
+  Query *query = parse_sql(sql, &literals);
+  if (query == nullptr) {
+    return nullptr;
+  }
+  std::shared_ptr<CachedPlan> plan = CachedPlan::create(query, literals, normalized);
+  query_destroy(query);
+  return plan;
+}
+
+// 用template_sql的计划代入sql中的常量，结果应当与直接解析sql相同
+static void check_instantiate(const char *template_sql, const char *sql) {
+  NormalizedSql template_normalized;
+  NormalizedSql normalized;
+  ASSERT_TRUE(normalize_sql(template_sql, template_normalized));
+  ASSERT_TRUE(normalize_sql(sql, normalized));
+  ASSERT_EQ(template_normalized.text, normalized.text);
+
+  std::shared_ptr<CachedPlan> plan = create_plan(template_sql);
+  ASSERT_NE(nullptr, plan) << template_sql;
+  Query *instantiated = plan->instantiate(normalized.literals);
+  ASSERT_NE(nullptr, instantiated);
+  Query *parsed = parse_sql(sql);
+  ASSERT_NE(nullptr, parsed);
+
+  Query *template_query = parse_sql(template_sql);
+  ASSERT_NE(nullptr, template_query);
+
+  ASSERT_EQ(parsed->flag, instantiated->flag);
+  std::vector<std::string> expected = values_of(parsed);
+  ASSERT_EQ(expected, values_of(instantiated)) << sql;
+  // 两条sql的常量都不相同，代入之后不能还是模板中的值
+  ASSERT_NE(values_of(template_query), values_of(instantiated)) << sql;
+  query_destroy(instantiated);
+  query_destroy(parsed);
+  query_destroy(template_query);
+}
+
+TEST(test_plan_cache, normalize_sql) {
+  NormalizedSql normalized;
+  ASSERT_TRUE(normalize_sql("select *  from t\twhere a = 12 and b='ab c' and c >= 2.5 limit 3;", normalized));
+  ASSERT_EQ("select * from t where a = ? and b = '?' and c >= ?f limit 3 ;", normalized.text);
+  ASSERT_EQ(3, normalized.literals.size());
+  ASSERT_EQ(NormalizedSql::INT_LITERAL, normalized.literals[0].type);
+  ASSERT_EQ("12", normalized.literals[0].text);
+  ASSERT_EQ(NormalizedSql::STRING_LITERAL, normalized.literals[1].type);
+  ASSERT_EQ("ab c", normalized.literals[1].text);
+  ASSERT_EQ(NormalizedSql::FLOAT_LITERAL, normalized.literals[2].type);
+  ASSERT_EQ("2.5", normalized.literals[2].text);
+
+  // 负号是单独的词，常量记录前面是否有负号
+  ASSERT_TRUE(normalize_sql("delete from t where a = -5;", normalized));
+  ASSERT_EQ("delete from t where a = - ? ;", normalized.text);
+  ASSERT_TRUE(normalized.literals[0].after_sub);
+
+  // LIMIT后面的数字不是常量，不同的LIMIT不能共用计划
+  NormalizedSql other;
+  ASSERT_TRUE(normalize_sql("select * from t where a = 12 and b='x' and c >= 1.0 limit 4;", other));
+  ASSERT_NE(normalized.text, other.text);
+
+  ASSERT_FALSE(normalize_sql("create table t(a int);", normalized));
+  ASSERT_FALSE(normalize_sql("show tables;", normalized));
+  ASSERT_FALSE(normalize_sql("select * from t where a = ?;", normalized));
+  ASSERT_FALSE(normalize_sql("select * from t where b = 'abc;", normalized));
+}
+
+TEST(test_plan_cache, instantiate_same_as_parse) {
+  check_instantiate("select * from t where a = 1 and b = 'x' and c > 2.5;",
+                    "select * from t where a = 42 and b = 'hello' and c > 0.25;");
+  check_instantiate("select * from t where a = -3 and c < -1.5;", "select * from t where a = -17 and c < -0.5;");
+  check_instantiate("select a + 2, b from t where a * 3 > 10 order by b;",
+                    "select a + 7, b from t where a * 9 > 100 order by b;");
+  check_instantiate("select t.a, s.b from t, s where t.a = s.a and s.b <> 'abc';",
+                    "select t.a, s.b from t, s where t.a = s.a and s.b <> 'q';");
+  check_instantiate("select * from t where a in (select a from s where b = 1);",
+                    "select * from t where a in (select a from s where b = 2);");
+  check_instantiate("insert into t values (1, 'a', 1.5), (2, 'b', 2.5);",
+                    "insert into t values (7, 'zz', 3.25), (8, 'yy', 9.0);");
+  check_instantiate("update t set a = 3 where b = 'x';", "update t set a = 30 where b = 'y';");
+  check_instantiate("delete from t where a = 0;", "delete from t where a = 11;");
+}
+
+TEST(test_plan_cache, negative_zero_not_cached) {
+  // -0解析之后还是0，不知道负号是否作用在值上，代入其它值可能得到相反的符号
+  ASSERT_EQ(nullptr, create_plan("select * from t where a = -0;"));
+  ASSERT_NE(nullptr, create_plan("select * from t where a = -1;"));
+}
+
+// 建表删表改变db的版本，创建索引改变表的版本，只有语句用到的表的变化才需要重新检查
+TEST(test_plan_cache, checked_version) {
+  char dir[] = "/tmp/plan_cache_test.XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir));
+  Db db;
+  ASSERT_EQ(RC::SUCCESS, db.init("test", dir));
+  AttrInfo attr;
+  attr.name = (char *)"a";
+  attr.type = INTS;
+  attr.length = sizeof(int);
+  attr.nullable = 0;
+  ASSERT_EQ(RC::SUCCESS, db.create_table("t", 1, &attr));
+  ASSERT_EQ(RC::SUCCESS, db.create_table("u", 1, &attr));
+
+  std::shared_ptr<CachedPlan> plan = create_plan("select * from t where a = 1;");
+  ASSERT_NE(nullptr, plan);
+  ASSERT_FALSE(plan->checked(plan->schema_versions(&db)));
+  plan->set_checked(plan->schema_versions(&db));
+  ASSERT_TRUE(plan->checked(plan->schema_versions(&db)));
+
+  char *field[] = {(char *)"a"};
+  ASSERT_EQ(RC::SUCCESS, db.find_table("u")->create_index(nullptr, "u_a", 1, field, 0, BPLUS_TREE_INDEX));
+  ASSERT_TRUE(plan->checked(plan->schema_versions(&db)));
+  ASSERT_EQ(RC::SUCCESS, db.find_table("t")->create_index(nullptr, "t_a", 1, field, 0, BPLUS_TREE_INDEX));
+  ASSERT_FALSE(plan->checked(plan->schema_versions(&db)));
+
+  plan->set_checked(plan->schema_versions(&db));
+  ASSERT_TRUE(plan->checked(plan->schema_versions(&db)));
+  ASSERT_EQ(RC::SUCCESS, db.drop_table("u"));
+  ASSERT_FALSE(plan->checked(plan->schema_versions(&db)));
+
+  ASSERT_EQ(RC::SUCCESS, db.drop_table("t"));
+  ::rmdir(dir);
+}
+
+TEST(test_plan_cache, lru) {
+  PlanCache cache(2);
+  std::shared_ptr<CachedPlan> plan1 = create_plan("select * from t where a = 1;");
+  std::shared_ptr<CachedPlan> plan2 = create_plan("select * from t where b = 1;");
+  std::shared_ptr<CachedPlan> plan3 = create_plan("select * from t where c = 1;");
+  ASSERT_EQ(nullptr, cache.get("k1"));
+  cache.put("k1", plan1);
+  cache.put("k2", plan2);
+  ASSERT_EQ(plan1, cache.get("k1"));
+  // k2最久没有使用，被淘汰
+  cache.put("k3", plan3);
+  ASSERT_EQ(2, cache.size());
+  ASSERT_EQ(nullptr, cache.get("k2"));
+  ASSERT_EQ(plan1, cache.get("k1"));
+  ASSERT_EQ(plan3, cache.get("k3"));
+  ASSERT_EQ(3, cache.hits());
+  ASSERT_EQ(2, cache.misses());
+}
+
+TEST(test_prepared_statement, parse_command) {
+  PreparedCommand command;
+  ASSERT_EQ(PreparedCommand::PREPARE,
+            parse_prepared_command("PREPARE Stmt FROM \"select * from t where a = ? and b = 'x'\";", command));
+  ASSERT_EQ("stmt", command.name);
+  ASSERT_EQ("select * from t where a = ? and b = 'x'", command.sql);
+
+  ASSERT_EQ(PreparedCommand::EXECUTE, parse_prepared_command("execute stmt using 12, -2.5, 'a b';", command));
+  ASSERT_EQ("stmt", command.name);
+  ASSERT_EQ(3, command.params.size());
+  ASSERT_EQ(NormalizedSql::INT_LITERAL, command.params[0].type);
+  ASSERT_EQ("12", command.params[0].text);
+  ASSERT_EQ(NormalizedSql::FLOAT_LITERAL, command.params[1].type);
+  ASSERT_EQ("-2.5", command.params[1].text);
+  ASSERT_EQ(NormalizedSql::STRING_LITERAL, command.params[2].type);
+  ASSERT_EQ("a b", command.params[2].text);
+
+  ASSERT_EQ(PreparedCommand::EXECUTE, parse_prepared_command("execute stmt", command));
+  ASSERT_EQ(0, command.params.size());
+  ASSERT_EQ(PreparedCommand::DEALLOCATE, parse_prepared_command("deallocate prepare stmt;", command));
+  ASSERT_EQ("stmt", command.name);
+
+  ASSERT_EQ(PreparedCommand::NONE, parse_prepared_command("select * from t;", command));
+  ASSERT_EQ(PreparedCommand::INVALID, parse_prepared_command("prepare stmt 'select * from t'", command));
+  ASSERT_EQ(PreparedCommand::INVALID, parse_prepared_command("execute stmt using", command));
+  ASSERT_EQ(PreparedCommand::INVALID, parse_prepared_command("execute stmt using 1 2", command));
+  ASSERT_EQ(PreparedCommand::INVALID, parse_prepared_command("execute stmt using 1.", command));
+  ASSERT_EQ(PreparedCommand::INVALID, parse_prepared_command("deallocate stmt", command));
+}
+
+TEST(test_prepared_statement, parse_execute_message) {
+  std::string message;
+  message += PREPARED_EXECUTE_MESSAGE;
+  message += "Stmt";
+  message += PREPARED_PARAM_SEPARATOR;
+  message += "i-42";
+  message += PREPARED_PARAM_SEPARATOR;
+  message += "f0.5";
+  message += PREPARED_PARAM_SEPARATOR;
+  message += "sit's; drop table t";
+  PreparedCommand command;
+  ASSERT_EQ(PreparedCommand::EXECUTE, parse_prepared_command(message.c_str(), command));
+  ASSERT_EQ("stmt", command.name);
+  ASSERT_EQ(3, command.params.size());
+  ASSERT_EQ(NormalizedSql::INT_LITERAL, command.params[0].type);
+  ASSERT_EQ("-42", command.params[0].text);
+  ASSERT_EQ(NormalizedSql::FLOAT_LITERAL, command.params[1].type);
+  ASSERT_EQ("0.5", command.params[1].text);
+  ASSERT_EQ(NormalizedSql::STRING_LITERAL, command.params[2].type);
+  ASSERT_EQ("it's; drop table t", command.params[2].text);
+
+  std::string invalid;
+  invalid += PREPARED_EXECUTE_MESSAGE;
+  invalid += "stmt";
+  invalid += PREPARED_PARAM_SEPARATOR;
+  ASSERT_EQ(PreparedCommand::INVALID, parse_prepared_command((invalid + "i4a").c_str(), command));
+  ASSERT_EQ(PreparedCommand::INVALID, parse_prepared_command((invalid + "x1").c_str(), command));
+  ASSERT_EQ(PreparedCommand::INVALID, parse_prepared_command(invalid.c_str(), command));
+}
+
+TEST(test_prepared_statement, bind_same_as_parse) {
+  std::shared_ptr<PreparedStatement> statement =
+      PreparedStatement::create("select * from t where a = ? and b = ? and c > 1.5;");
+  ASSERT_NE(nullptr, statement);
+  ASSERT_EQ(2, statement->param_num());
+
+  std::shared_ptr<CachedPlan> plan;
+  Query *query = statement->bind({{NormalizedSql::INT_LITERAL, "7"}, {NormalizedSql::STRING_LITERAL, "hello"}}, plan);
+  ASSERT_NE(nullptr, query);
+  ASSERT_NE(nullptr, plan);
+  Query *parsed = parse_sql("select * from t where a = 7 and b = 'hello' and c > 1.5;");
+  ASSERT_NE(nullptr, parsed);
+  ASSERT_EQ(values_of(parsed), values_of(query));
+  query_destroy(query);
+  query_destroy(parsed);
+
+  // 参数的类型不同时使用另一个计划
+  std::shared_ptr<CachedPlan> float_plan;
+  query = statement->bind({{NormalizedSql::FLOAT_LITERAL, "2.5"}, {NormalizedSql::STRING_LITERAL, "x"}}, float_plan);
+  ASSERT_NE(nullptr, query);
+  ASSERT_NE(plan, float_plan);
+  parsed = parse_sql("select * from t where a = 2.5 and b = 'x' and c > 1.5;");
+  ASSERT_EQ(values_of(parsed), values_of(query));
+  query_destroy(query);
+  query_destroy(parsed);
+
+  // 负数参数直接作为常量的值，sql中的 -7 解析成取反的表达式，所以只检查值
+  query = statement->bind({{NormalizedSql::INT_LITERAL, "-7"}, {NormalizedSql::STRING_LITERAL, "y"}}, plan);
+  ASSERT_NE(nullptr, query);
+  std::vector<std::string> expected = {"i-7", "sy", "f1.500000"};
+  ASSERT_EQ(expected, values_of(query));
+  query_destroy(query);
+
+  // 参数个数不对
+  ASSERT_EQ(nullptr, statement->bind({{NormalizedSql::INT_LITERAL, "1"}}, plan));
+}
+
+TEST(test_prepared_statement, bound_values_not_lexed) {
+  std::shared_ptr<PreparedStatement> statement = PreparedStatement::create("delete from t where b = ?;");
+  ASSERT_NE(nullptr, statement);
+  // 值原样代入常量，不会改变语句的结构
+  const std::string value = "x' or a > 0 or b = 'y";
+  std::shared_ptr<CachedPlan> plan;
+  Query *query = statement->bind({{NormalizedSql::STRING_LITERAL, value}}, plan);
+  ASSERT_NE(nullptr, query);
+  ASSERT_EQ(SCF_DELETE, query->flag);
+  ASSERT_EQ(1, query->sstr.deletion.condition_num);
+  std::vector<std::string> values = values_of(query);
+  ASSERT_NE(values.end(), std::find(values.begin(), values.end(), "s" + value));
+  query_destroy(query);
+}
+
+TEST(test_prepared_statement, reject_unsupported) {
+  // LIMIT后面的数字不是常量，参数不能代入
+  ASSERT_EQ(nullptr, PreparedStatement::create("select * from t limit ?;"));
+  ASSERT_EQ(nullptr, PreparedStatement::create("create table t(a int);"));
+  ASSERT_EQ(nullptr, PreparedStatement::create("select * from where a = ?;"));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
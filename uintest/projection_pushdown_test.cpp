@@ -0,0 +1,141 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sql/executor/scan_executor.h"
+#include "sql_test_util.h"
+
+class test_projection_pushdown : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t1(id int, a int, b char(8), t char(12));"));
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t2(id int, c int, d float);"));
+    for (int i = 0; i < 20; i++) {
+      std::string sql = "insert into t1 values(" + std::to_string(i) + ", " + std::to_string(i % 4) + ", 'b" +
+                        std::to_string(i) + "', '" + text_value(i) + "');";
+      ASSERT_EQ(RC::SUCCESS, db_.execute(sql.c_str())) << sql;
+      sql = "insert into t2 values(" + std::to_string(i) + ", " + std::to_string(i * 10) + ", " +
+            std::to_string(i) + ".5);";
+      ASSERT_EQ(RC::SUCCESS, db_.execute(sql.c_str())) << sql;
+    }
+  }
+
+  static std::string text_value(int i) {
+    return std::string(8, 'a' + i % 26) + std::to_string(i);
+  }
+
+  // 用ExecutorBuilder生成sql的执行器之后，扫描table时读出的字段，用逗号连接
+  std::string scan_fields(const char *sql, const char *table_name) {
+    Query *query = query_create();
+    EXPECT_EQ(RC::SUCCESS, parse(sql, query)) << sql;
+    ExecutorBuilder builder(db_.db());
+    std::unique_ptr<Executor> executor(builder.build(&query->sstr.selection));
+    TupleSchema schema;
+    builder.build_scan_schema(&query->sstr.selection, db_.table(table_name), schema);
+    query_destroy(query);
+    std::string fields;
+    for (const TupleField &field : schema.fields()) {
+      if (!fields.empty()) {
+        fields.append(",");
+      }
+      fields.append(field.field_name());
+    }
+    return fields;
+  }
+
+protected:
+  SqlTestDb db_;
+};
+
+TEST_F(test_projection_pushdown, single_table) {
+  ASSERT_EQ("a", scan_fields("select a from t1;", "t1"));
+  // 过滤、排序、分组用到的字段也要读出来
+  ASSERT_EQ("id,b", scan_fields("select b from t1 where id > 3;", "t1"));
+  ASSERT_EQ("a,b", scan_fields("select b from t1 order by a;", "t1"));
+  ASSERT_EQ("a,b", scan_fields("select a, count(b) from t1 group by a;", "t1"));
+  ASSERT_EQ("id,a,b,t", scan_fields("select * from t1;", "t1"));
+  // count(*)不需要任何字段，保留第一个字段使每条记录仍然对应一个tuple
+  ASSERT_EQ("id", scan_fields("select count(*) from t1;", "t1"));
+}
+
+// 多表时每个表只读出自己被引用的字段，t1.* 读出t1的全部字段
+TEST_F(test_projection_pushdown, multi_table) {
+  const char *sql = "select t1.b, t2.d from t1, t2 where t1.a > 1 and t2.c < 50;";
+  ASSERT_EQ("a,b", scan_fields(sql, "t1"));
+  ASSERT_EQ("c,d", scan_fields(sql, "t2"));
+  ASSERT_EQ("id,a,b,t", scan_fields("select t1.*, t2.c from t1, t2;", "t1"));
+  ASSERT_EQ("c", scan_fields("select t1.*, t2.c from t1, t2;", "t2"));
+  ASSERT_EQ("b", scan_fields("select t1.b from t1, t2 where t2.c > 1;", "t1"));
+  ASSERT_EQ("c", scan_fields("select t1.b from t1, t2 where t2.c > 1;", "t2"));
+}
+
+// 关联子查询代入的外层字段和子查询自己的字段
+TEST_F(test_projection_pushdown, sub_query) {
+  const char *sql = "select t1.b from t1 where t1.a in (select t2.c from t2 where t2.id = t1.id);";
+  ASSERT_EQ("id,a,b", scan_fields(sql, "t1"));
+  ASSERT_EQ("id,c", scan_fields(sql, "t2"));
+}
+
+// 只扫描一部分字段时，读出的值与完整扫描中对应的值相同，字段的顺序按schema
+TEST_F(test_projection_pushdown, scan_subset_of_fields) {
+  TupleSchema full_schema;
+  TupleSchema::from_table(db_.table("t1"), full_schema);
+  TupleSchema text_schema;
+  text_schema.add(CHARS, "t1", "t");
+  text_schema.add(INTS, "t1", "id");
+  TupleSchema subset_schema;
+  subset_schema.add(CHARS, "t1", "b");
+  subset_schema.add(INTS, "t1", "a");
+
+  ExecutorContext context;
+  ScanExecutor full_scan(&context, db_.table("t1"), full_schema, {}, false);
+  ScanExecutor text_scan(&context, db_.table("t1"), text_schema, {}, false);
+  ScanExecutor subset_scan(&context, db_.table("t1"), subset_schema, {}, false);
+  ASSERT_EQ(RC::SUCCESS, full_scan.init());
+  ASSERT_EQ(RC::SUCCESS, text_scan.init());
+  ASSERT_EQ(RC::SUCCESS, subset_scan.init());
+  TupleSet full;
+  TupleSet text;
+  TupleSet subset;
+  ASSERT_EQ(RC::SUCCESS, full_scan.next_all(full));
+  ASSERT_EQ(RC::SUCCESS, text_scan.next_all(text));
+  ASSERT_EQ(RC::SUCCESS, subset_scan.next_all(subset));
+  ASSERT_EQ(20, full.size());
+  ASSERT_EQ(20, text.size());
+  ASSERT_EQ(20, subset.size());
+  for (int i = 0; i < 20; i++) {
+    ASSERT_EQ(4, full.get(i).size());
+    ASSERT_EQ(2, subset.get(i).size());
+    ASSERT_EQ(std::to_string(i) + " | " + std::to_string(i % 4) + " | b" + std::to_string(i) + " | " + text_value(i),
+              SqlTestDb::tuple_to_string(full.get(i)));
+    ASSERT_EQ(text_value(i) + " | " + std::to_string(i), SqlTestDb::tuple_to_string(text.get(i)));
+    ASSERT_EQ("b" + std::to_string(i) + " | " + std::to_string(i % 4), SqlTestDb::tuple_to_string(subset.get(i)));
+  }
+}
+
+// 下推之后查询结果不变
+TEST_F(test_projection_pushdown, select_results) {
+  ASSERT_EQ(std::vector<std::string>({"b2 | 20", "b6 | 60"}),
+            db_.select_sorted("select t1.b, t2.c from t1, t2 where t1.a = 2 and t2.id = t1.id and t1.id < 10;"));
+  ASSERT_EQ(std::vector<std::string>({"0 | 5", "1 | 5", "2 | 5", "3 | 5"}),
+            db_.select_sorted("select a, count(b) from t1 group by a;"));
+  ASSERT_EQ(std::vector<std::string>({"b0"}),
+            db_.select_sorted("select t1.b from t1 where t1.a in (select t2.c from t2 where t2.id = t1.id);"));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
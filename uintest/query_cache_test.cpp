@@ -0,0 +1,136 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "sql/query_cache/query_cache.h"
+#include "storage/common/db.h"
+#include "storage/common/table.h"
+#include "gtest/gtest.h"
+
+class test_query_cache : public testing::Test {
+protected:
+  void SetUp() override {
+    char dir[] = "/tmp/query_cache_test.XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(dir));
+    dir_ = dir;
+    ASSERT_EQ(RC::SUCCESS, db_.init("test", dir_.c_str()));
+    create_table("t1");
+    create_table("t2");
+  }
+
+  void TearDown() override {
+    db_.drop_table("t1");
+    db_.drop_table("t2");
+    ::rmdir(dir_.c_str());
+  }
+
+  void create_table(const char *name) {
+    AttrInfo attr;
+    attr.name = (char *)"a";
+    attr.type = INTS;
+    attr.length = sizeof(int);
+    attr.nullable = 0;
+    ASSERT_EQ(RC::SUCCESS, db_.create_table(name, 1, &attr));
+  }
+
+  // 按当前的版本生成一个结果
+  QueryCache::Entry entry(const std::vector<std::string> &tables, const std::string &response) {
+    QueryCache::Entry entry;
+    entry.schema_version = db_.schema_version();
+    for (const std::string &table : tables) {
+      entry.tables.push_back(QueryCache::TableVersion{table, db_.find_table(table.c_str())->data_version()});
+    }
+    entry.response = response;
+    return entry;
+  }
+
+protected:
+  std::string dir_;
+  Db db_;
+};
+
+TEST_F(test_query_cache, hit_until_table_changed) {
+  QueryCache cache(1024, 1024);
+  std::string response;
+  ASSERT_FALSE(cache.get("q1", &db_, response));
+  cache.put("q1", entry({"t1"}, "r1"));
+  cache.put("q2", entry({"t1", "t2"}, "r2"));
+  cache.put("q3", entry({"t2"}, "r3"));
+
+  ASSERT_TRUE(cache.get("q1", &db_, response));
+  ASSERT_EQ("r1", response);
+  ASSERT_TRUE(cache.get("q2", &db_, response));
+  ASSERT_EQ("r2", response);
+
+  // t1的数据变了，用到t1的结果过期，只用到t2的结果仍然有效
+  db_.find_table("t1")->increase_data_version();
+  ASSERT_FALSE(cache.get("q1", &db_, response));
+  ASSERT_FALSE(cache.get("q2", &db_, response));
+  ASSERT_TRUE(cache.get("q3", &db_, response));
+  ASSERT_EQ("r3", response);
+  ASSERT_EQ(3, cache.hits());
+  ASSERT_EQ(3, cache.misses());
+
+  // 过期的结果已经删掉
+  ASSERT_EQ(2 + 2, cache.size());
+}
+
+TEST_F(test_query_cache, schema_changed) {
+  QueryCache cache(1024, 1024);
+  std::string response;
+  cache.put("q1", entry({"t1"}, "r1"));
+  create_table("t3");
+  ASSERT_FALSE(cache.get("q1", &db_, response));
+  ASSERT_EQ(RC::SUCCESS, db_.drop_table("t3"));
+
+  // 用到的表被删除
+  cache.put("q2", entry({"t2"}, "r2"));
+  ASSERT_EQ(RC::SUCCESS, db_.drop_table("t2"));
+  create_table("t2");
+  ASSERT_FALSE(cache.get("q2", &db_, response));
+  ASSERT_EQ(0, cache.size());
+}
+
+TEST_F(test_query_cache, size_limit) {
+  // 每个结果是2字节的键加8字节的结果
+  QueryCache cache(25, 8);
+  std::string response;
+  cache.put("q0", entry({"t1"}, std::string(9, 'x')));
+  ASSERT_EQ(0, cache.size());
+
+  cache.put("q1", entry({"t1"}, "11111111"));
+  cache.put("q2", entry({"t1"}, "22222222"));
+  ASSERT_TRUE(cache.get("q1", &db_, response));
+  // 超过容量，淘汰最久没有使用的q2
+  cache.put("q3", entry({"t1"}, "33333333"));
+  ASSERT_EQ(20, cache.size());
+  ASSERT_FALSE(cache.get("q2", &db_, response));
+  ASSERT_TRUE(cache.get("q1", &db_, response));
+  ASSERT_EQ("11111111", response);
+  ASSERT_TRUE(cache.get("q3", &db_, response));
+  ASSERT_EQ("33333333", response);
+
+  // 同一个键的结果被替换
+  cache.put("q3", entry({"t1"}, "3"));
+  ASSERT_EQ(13, cache.size());
+  ASSERT_TRUE(cache.get("q3", &db_, response));
+  ASSERT_EQ("3", response);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
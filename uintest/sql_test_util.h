@@ -0,0 +1,153 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#ifndef __UINTEST_SQL_TEST_UTIL_H__
+#define __UINTEST_SQL_TEST_UTIL_H__
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sql/executor/executor.h"
+#include "sql/executor/executor_builder.h"
+#include "sql/parser/parse.h"
+#include "storage/common/db.h"
+#include "storage/common/table.h"
+#include "storage/trx/trx.h"
+#include "gtest/gtest.h"
+
+/**
+ * 执行器相关单测的公共部分：在临时目录中建一个Db，用SQL建表、建索引、插入数据，
+ * 查询不经过session，直接用ExecutorBuilder生成执行器
+ */
+class SqlTestDb {
+public:
+  SqlTestDb() {
+    strcpy(dir_, "/tmp/sql_test.XXXXXX");
+    EXPECT_NE(nullptr, mkdtemp(dir_));
+    db_.reset(new Db());
+    EXPECT_EQ(RC::SUCCESS, db_->init("test", dir_));
+  }
+
+  ~SqlTestDb() {
+    for (const std::string &table : tables_) {
+      db_->drop_table(table.c_str());
+    }
+    db_.reset();
+    ::rmdir(dir_);
+  }
+
+  Db *db() { return db_.get(); }
+  Table *table(const char *name) { return db_->find_table(name); }
+
+  /**
+   * 执行create table、create index或insert(可以有多行)
+   */
+  RC execute(const char *sql) {
+    Query *query = query_create();
+    RC rc = parse(sql, query);
+    if (rc != RC::SUCCESS) {
+      query_destroy(query);
+      return rc;
+    }
+    Trx trx;
+    switch (query->flag) {
+      case SCF_CREATE_TABLE: {
+        const CreateTable &create_table = query->sstr.create_table;
+        rc = db_->create_table(create_table.relation_name, create_table.attribute_count, create_table.attributes);
+        if (rc == RC::SUCCESS) {
+          tables_.push_back(create_table.relation_name);
+        }
+      } break;
+      case SCF_CREATE_INDEX: {
+        const CreateIndex &create_index = query->sstr.create_index;
+        rc = db_->find_table(create_index.relation_name)->create_index(&trx, create_index.index_name,
+            create_index.attribute_num, create_index.attribute_names, create_index.unique, create_index.index_type);
+      } break;
+      case SCF_INSERT: {
+        const Inserts &inserts = query->sstr.insertion;
+        Table *table = db_->find_table(inserts.relation_name);
+        for (size_t i = 0; i < inserts.pair_num && rc == RC::SUCCESS; i++) {
+          rc = table->insert_record(&trx, inserts.pairs[i].value_num, inserts.pairs[i].values);
+        }
+      } break;
+      default: {
+        rc = RC::GENERIC_ERROR;
+      } break;
+    }
+    if (rc == RC::SUCCESS) {
+      rc = trx.commit();
+    } else {
+      trx.rollback();
+    }
+    query_destroy(query);
+    return rc;
+  }
+
+  /**
+   * 执行select，每行结果的各个值用" | "连接
+   */
+  RC select(const char *sql, std::vector<std::string> &rows) {
+    rows.clear();
+    Query *query = query_create();
+    RC rc = parse(sql, query);
+    if (rc != RC::SUCCESS || query->flag != SCF_SELECT) {
+      query_destroy(query);
+      return rc != RC::SUCCESS ? rc : RC::INVALID_ARGUMENT;
+    }
+    ExecutorBuilder builder(db_.get());
+    std::unique_ptr<Executor> executor(builder.build(&query->sstr.selection));
+    rc = executor->init();
+    TupleSet result;
+    if (rc == RC::SUCCESS) {
+      rc = executor->next_all(result);
+    }
+    if (rc == RC::SUCCESS) {
+      for (const Tuple &tuple : result.tuples()) {
+        rows.push_back(tuple_to_string(tuple));
+      }
+    }
+    executor->rewind();
+    query_destroy(query);
+    return rc;
+  }
+
+  // 不关心顺序时比较排序之后的结果
+  std::vector<std::string> select_sorted(const char *sql) {
+    std::vector<std::string> rows;
+    EXPECT_EQ(RC::SUCCESS, select(sql, rows)) << sql;
+    std::sort(rows.begin(), rows.end());
+    return rows;
+  }
+
+  static std::string tuple_to_string(const Tuple &tuple) {
+    std::stringstream ss;
+    for (int i = 0; i < tuple.size(); i++) {
+      if (i != 0) {
+        ss << " | ";
+      }
+      tuple.get_pointer(i)->to_string(ss);
+    }
+    return ss.str();
+  }
+
+private:
+  char dir_[64];
+  std::unique_ptr<Db> db_;
+  std::vector<std::string> tables_;
+};
+
+#endif  // __UINTEST_SQL_TEST_UTIL_H__
@@ -0,0 +1,135 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sql/executor/sub_query_executor.h"
+#include "sql_test_util.h"
+
+static std::shared_ptr<TupleValue> int_value(int v) {
+  return std::make_shared<IntValue>(v);
+}
+
+static std::shared_ptr<TupleValue> float_value(float v) {
+  return std::make_shared<FloatValue>(v);
+}
+
+static std::shared_ptr<TupleValue> string_value(const char *v) {
+  return std::make_shared<StringValue>(v, strlen(v));
+}
+
+TEST(test_sub_query, value_set_ints_and_strings) {
+  SubQueryValueSet ints;
+  for (int i = 0; i < 100; i += 3) {
+    ints.insert(int_value(i));
+  }
+  ints.build();
+  ASSERT_EQ(34u, ints.size());
+  ASSERT_FALSE(ints.has_null());
+  for (int i = -5; i < 105; i++) {
+    ASSERT_EQ(i >= 0 && i < 100 && i % 3 == 0, ints.contains(int_value(i))) << i;
+  }
+  // 整数集合也可以用浮点数查找
+  ASSERT_TRUE(ints.contains(float_value(27.0f)));
+  ASSERT_FALSE(ints.contains(float_value(27.5f)));
+
+  SubQueryValueSet strings;
+  strings.insert(string_value("abc"));
+  strings.insert(string_value(""));
+  strings.insert(string_value("abcd"));
+  strings.build();
+  ASSERT_TRUE(strings.contains(string_value("abc")));
+  ASSERT_TRUE(strings.contains(string_value("")));
+  ASSERT_FALSE(strings.contains(string_value("ab")));
+  ASSERT_FALSE(strings.contains(string_value("abcde")));
+
+  strings.clear();
+  ASSERT_TRUE(strings.empty());
+  ASSERT_FALSE(strings.contains(string_value("abc")));
+}
+
+// 整数和浮点数混在一起时按数值比较，null不与任何值相等
+TEST(test_sub_query, value_set_numbers_and_null) {
+  SubQueryValueSet set;
+  set.insert(int_value(3));
+  set.insert(std::make_shared<NullValue>());
+  set.insert(float_value(1.5f));
+  set.build();
+  ASSERT_EQ(3u, set.size());
+  ASSERT_TRUE(set.has_null());
+  ASSERT_EQ(3, *(int *)set.first()->value_pointer());
+  ASSERT_TRUE(set.contains(int_value(3)));
+  ASSERT_TRUE(set.contains(float_value(3.0f)));
+  ASSERT_TRUE(set.contains(float_value(1.5f)));
+  ASSERT_FALSE(set.contains(int_value(1)));
+  ASSERT_FALSE(set.contains(int_value(2)));
+  ASSERT_FALSE(set.contains(std::make_shared<NullValue>()));
+}
+
+class test_sub_query_select : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t1(id int, a int nullable, s char(4));"));
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t2(b int nullable, s char(4), f float);"));
+    ASSERT_EQ(RC::SUCCESS, db_.execute(
+        "insert into t1 values(1, 1, 'x1'), (2, 2, 'x2'), (3, null, 'x3'), (4, 4, 'x4'), (5, 2, 'x5');"));
+    ASSERT_EQ(RC::SUCCESS, db_.execute(
+        "insert into t2 values(2, 'x1', 2.0), (4, 'x4', 1.5), (6, 'x9', 4.0);"));
+  }
+
+  std::vector<std::string> ids(const char *sql) {
+    std::string query = std::string("select t1.id from t1 where ") + sql + ";";
+    return db_.select_sorted(query.c_str());
+  }
+
+protected:
+  SqlTestDb db_;
+};
+
+TEST_F(test_sub_query_select, in_and_not_in) {
+  ASSERT_EQ(std::vector<std::string>({"2", "4", "5"}), ids("a in (select b from t2)"));
+  ASSERT_EQ(std::vector<std::string>({"1"}), ids("a not in (select b from t2)"));
+  ASSERT_EQ(std::vector<std::string>({"1", "4"}), ids("s in (select s from t2)"));
+  ASSERT_EQ(std::vector<std::string>({"2", "3", "5"}), ids("s not in (select s from t2)"));
+  // 整数与浮点数比较
+  ASSERT_EQ(std::vector<std::string>({"2", "4", "5"}), ids("a in (select f from t2)"));
+  // 子查询的结果为空
+  ASSERT_EQ(std::vector<std::string>(), ids("a in (select b from t2 where b > 100)"));
+  ASSERT_EQ(std::vector<std::string>({"1", "2", "3", "4", "5"}), ids("a not in (select b from t2 where b > 100)"));
+}
+
+// 子查询的结果中有null时，NOT IN不满足任何一行
+TEST_F(test_sub_query_select, not_in_with_null) {
+  ASSERT_EQ(RC::SUCCESS, db_.execute("insert into t2 values(null, 'x0', 0.0);"));
+  ASSERT_EQ(std::vector<std::string>({"2", "4", "5"}), ids("a in (select b from t2)"));
+  ASSERT_EQ(std::vector<std::string>(), ids("a not in (select b from t2)"));
+}
+
+TEST_F(test_sub_query_select, compare_with_aggregation) {
+  ASSERT_EQ(std::vector<std::string>({"1", "2", "5"}), ids("a < (select avg(b) from t2)"));
+  ASSERT_EQ(std::vector<std::string>({"4"}), ids("a = (select max(f) from t2)"));
+  ASSERT_EQ(std::vector<std::string>(), ids("a > (select min(b) from t2 where b > 100)"));
+}
+
+// 关联子查询的结果按外层的值缓存，外层的值重复时结果相同
+TEST_F(test_sub_query_select, correlated) {
+  ASSERT_EQ(std::vector<std::string>({"2", "4", "5"}), ids("a in (select b from t2 where t2.b = t1.a)"));
+  ASSERT_EQ(std::vector<std::string>({"1", "3"}), ids("a not in (select b from t2 where t2.b = t1.a)"));
+  ASSERT_EQ(std::vector<std::string>({"1", "4"}), ids("s in (select s from t2 where t2.s = t1.s)"));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
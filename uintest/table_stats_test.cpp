@@ -0,0 +1,222 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <stdio.h>
+
+#include <string>
+
+#include "storage/common/table_meta.h"
+#include "storage/common/table_stats.h"
+#include "json/json.h"
+#include "sql_test_util.h"
+
+// splitmix64，把连续的整数打散成均匀分布的hash
+static uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+TEST(test_table_stats, hyper_log_log_estimate) {
+  for (int n : {10, 1000, 5000, 100000}) {
+    HyperLogLog hll;
+    for (int round = 0; round < 2; round++) {
+      for (int i = 0; i < n; i++) {
+        hll.add(mix(i));
+      }
+    }
+    // 重复的值不影响估计，误差在标准误差的3倍以内
+    ASSERT_NEAR(n, hll.estimate(), n * 0.1) << n;
+  }
+  ASSERT_DOUBLE_EQ(0, HyperLogLog().estimate());
+}
+
+TEST(test_table_stats, hyper_log_log_merge_and_string) {
+  HyperLogLog left;
+  HyperLogLog right;
+  HyperLogLog all;
+  for (int i = 0; i < 30000; i++) {
+    (i < 20000 ? left : right).add(mix(i));
+    if (i >= 10000) {
+      right.add(mix(i));
+    }
+    all.add(mix(i));
+  }
+  left.merge(right);
+  ASSERT_DOUBLE_EQ(all.estimate(), left.estimate());
+
+  HyperLogLog loaded;
+  ASSERT_TRUE(loaded.from_string(all.to_string()));
+  ASSERT_EQ(all.to_string(), loaded.to_string());
+  ASSERT_DOUBLE_EQ(all.estimate(), loaded.estimate());
+
+  // 长度不对或有非法字符时保持原来的值
+  ASSERT_FALSE(loaded.from_string("00"));
+  std::string bad = all.to_string();
+  bad[7] = 'x';
+  ASSERT_FALSE(loaded.from_string(bad));
+  ASSERT_EQ(all.to_string(), loaded.to_string());
+}
+
+static const int ROWS = 20000;
+
+// 记录数超过采样的大小，直方图由样本构建
+// a：每10行一个null，其余是i % 1000，共900个不同的值，每个值20行
+// f：(i % 400) / 4，在[0, 100)上均匀分布
+// s：k00到k49
+// e：前一半都是7，后一半各不相同
+class test_table_stats_analyze : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_EQ(RC::SUCCESS, db_.execute("create table t(a int nullable, f float, s char(8), e int);"));
+    for (int i = 0; i < ROWS;) {
+      std::string sql = "insert into t values";
+      for (int j = 0; j < 10; i++, j++) {
+        char s[8];
+        snprintf(s, sizeof(s), "k%02d", i % 50);
+        sql += std::string(j == 0 ? "" : ", ") + "(" + (i % 10 == 0 ? std::string("null") : std::to_string(i % 1000)) +
+               ", " + std::to_string((i % 400) / 4.0) + ", '" + s + "', " + std::to_string(i < ROWS / 2 ? 7 : i) + ")";
+      }
+      sql += ";";
+      ASSERT_EQ(RC::SUCCESS, db_.execute(sql.c_str()));
+    }
+
+    Table *table = db_.table("t");
+    ASSERT_FALSE(table->table_meta().stats().analyzed);
+    Trx trx;
+    ASSERT_EQ(RC::SUCCESS, table->analyze(&trx));
+  }
+
+  const TableStats &table_stats() {
+    return db_.table("t")->table_meta().stats();
+  }
+
+protected:
+  SqlTestDb db_;
+};
+
+TEST_F(test_table_stats_analyze, basic) {
+  const TableStats &stats = table_stats();
+  ASSERT_TRUE(stats.analyzed);
+  ASSERT_EQ(ROWS, stats.row_count);
+  ASSERT_LT(1, stats.page_count);
+  ASSERT_EQ(4u, stats.columns.size());
+  ASSERT_EQ(nullptr, stats.column("x"));
+
+  const ColumnStats *a = stats.column("a");
+  ASSERT_NE(nullptr, a);
+  ASSERT_EQ(INTS, a->type);
+  ASSERT_DOUBLE_EQ(0.1, a->null_fraction);
+  ASSERT_TRUE(a->has_value);
+  ASSERT_DOUBLE_EQ(1, a->min);
+  ASSERT_DOUBLE_EQ(999, a->max);
+  ASSERT_NEAR(900, a->ndv, 90);
+  ASSERT_EQ(TableStatsCollector::HISTOGRAM_BUCKETS + 1, (int)a->histogram.size());
+  ASSERT_DOUBLE_EQ(1, a->histogram.front());
+  ASSERT_DOUBLE_EQ(999, a->histogram.back());
+  for (size_t i = 1; i < a->histogram.size(); i++) {
+    ASSERT_LE(a->histogram[i - 1], a->histogram[i]);
+  }
+
+  const ColumnStats *s = stats.column("s");
+  ASSERT_NE(nullptr, s);
+  ASSERT_DOUBLE_EQ(0, s->null_fraction);
+  ASSERT_NEAR(50, s->ndv, 3);
+  ASSERT_NEAR(10001, stats.column("e")->ndv, 1000);
+}
+
+// 选择率包含null的比例，范围条件由直方图插值
+TEST_F(test_table_stats_analyze, selectivity) {
+  const ColumnStats &a = *table_stats().column("a");
+  ASSERT_NEAR(0.45, a.selectivity(LESS_THAN, 500.0), 0.03);
+  ASSERT_NEAR(0.45, a.selectivity(GREAT_EQUAL, 500.0), 0.03);
+  ASSERT_NEAR(0.9 / 900, a.selectivity(EQUAL_TO, 123.0), 0.0005);
+  ASSERT_NEAR(0.9 - 0.9 / 900, a.selectivity(NOT_EQUAL, 123.0), 0.0005);
+  ASSERT_DOUBLE_EQ(0, a.selectivity(EQUAL_TO, 5000.0));
+  ASSERT_DOUBLE_EQ(0, a.selectivity(LESS_THAN, 1.0));
+  ASSERT_DOUBLE_EQ(0.9, a.selectivity(LESS_EQUAL, 999.0));
+  ASSERT_DOUBLE_EQ(0.9, a.selectivity(LESS_THAN, 2000.0));
+  ASSERT_LT(a.selectivity(IN_OP, 1.0), 0);
+
+  // 与记录格式相同的值
+  int a_value = 250;
+  ASSERT_NEAR(0.225, a.selectivity(LESS_THAN, (const char *)&a_value), 0.03);
+  float f_value = 75;
+  ASSERT_NEAR(0.25, table_stats().column("f")->selectivity(GREAT_EQUAL, (const char *)&f_value), 0.03);
+  const ColumnStats &s = *table_stats().column("s");
+  ASSERT_NEAR(0.02, s.selectivity(EQUAL_TO, "k07"), 0.005);
+  ASSERT_NEAR(0.5, s.selectivity(LESS_THAN, "k25"), 0.05);
+  ASSERT_DOUBLE_EQ(0, s.selectivity(EQUAL_TO, "x"));
+
+  // 一个值占了一半的行时，等值的选择率按它在直方图中占的桶估计
+  ASSERT_NEAR(0.5, table_stats().column("e")->selectivity(EQUAL_TO, 7.0), 0.05);
+  ASSERT_NEAR(0.25, table_stats().column("e")->selectivity(GREAT_THAN, 14999.0), 0.03);
+}
+
+// 查询中的常量按列的类型换算成排序键
+TEST(test_table_stats, stats_key_of_value) {
+  int int_data = 42;
+  float float_data = 2.5f;
+  char date_data[] = "2021-10-03";
+  char chars_data[] = "abc";
+  Value int_value{INTS, 0, &int_data};
+  Value float_value{FLOATS, 0, &float_data};
+  Value date_value{DATES, 0, date_data};
+  Value chars_value{CHARS, 0, chars_data};
+  Value null_value{INTS, 1, nullptr};
+
+  double key = 0;
+  ASSERT_TRUE(stats_key(INTS, int_value, key));
+  ASSERT_DOUBLE_EQ(42, key);
+  ASSERT_TRUE(stats_key(INTS, float_value, key));
+  ASSERT_DOUBLE_EQ(2.5, key);
+  ASSERT_TRUE(stats_key(DATES, date_value, key));
+  ASSERT_DOUBLE_EQ(20211003, key);
+  ASSERT_TRUE(stats_key(CHARS, chars_value, key));
+  ASSERT_DOUBLE_EQ(stats_key(CHARS, "abc\0\0\0\0", 8), key);
+  ASSERT_LT(stats_key(CHARS, "abb", 4), key);
+  ASSERT_GT(stats_key(CHARS, "abcd", 5), key);
+  ASSERT_FALSE(stats_key(INTS, chars_value, key));
+  ASSERT_FALSE(stats_key(CHARS, int_value, key));
+  ASSERT_FALSE(stats_key(INTS, null_value, key));
+}
+
+TEST_F(test_table_stats_analyze, json) {
+  Json::Value json_value;
+  table_stats().to_json(json_value);
+  TableStats loaded;
+  ASSERT_EQ(RC::SUCCESS, TableStats::from_json(json_value, loaded));
+  ASSERT_TRUE(loaded.analyzed);
+  ASSERT_EQ(table_stats().row_count, loaded.row_count);
+  ASSERT_EQ(table_stats().page_count, loaded.page_count);
+  ASSERT_EQ(table_stats().columns.size(), loaded.columns.size());
+  for (size_t i = 0; i < loaded.columns.size(); i++) {
+    const ColumnStats &expected = table_stats().columns[i];
+    const ColumnStats &column = loaded.columns[i];
+    ASSERT_EQ(expected.name, column.name);
+    ASSERT_DOUBLE_EQ(expected.null_fraction, column.null_fraction);
+    ASSERT_EQ(expected.has_value, column.has_value);
+    ASSERT_DOUBLE_EQ(expected.min, column.min);
+    ASSERT_DOUBLE_EQ(expected.max, column.max);
+    ASSERT_DOUBLE_EQ(expected.ndv, column.ndv);
+    ASSERT_EQ(expected.sketch.to_string(), column.sketch.to_string());
+    ASSERT_EQ(expected.histogram, column.histogram);
+  }
+
+  json_value["columns"][0]["sketch"] = "00";
+  ASSERT_NE(RC::SUCCESS, TableStats::from_json(json_value, loaded));
+  ASSERT_NE(RC::SUCCESS, TableStats::from_json(Json::Value(), loaded));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
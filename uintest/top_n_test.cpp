@@ -0,0 +1,130 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "sql/executor/util.h"
+#include "gtest/gtest.h"
+
+// 每个tuple是(排序字段, 加入的顺序)，排序字段有大量重复，用来检查相等的tuple是否按加入的顺序输出
+static bool key_less(const Tuple &lhs, const Tuple &rhs) {
+  return TupleSortUtil::compare_value(lhs.get_pointer(0), rhs.get_pointer(0)) < 0;
+}
+
+static std::vector<Tuple> make_tuples(int count, int distinct) {
+  srand(20211103);
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < count; i++) {
+    Tuple tuple;
+    if (rand() % 10 == 0) {
+      tuple.add_null();
+    } else {
+      tuple.add(rand() % distinct - distinct / 2);
+    }
+    tuple.add(i);
+    tuples.push_back(std::move(tuple));
+  }
+  return tuples;
+}
+
+static int seq_of(const Tuple &tuple) {
+  return *(int *)tuple.get_pointer(1)->value_pointer();
+}
+
+// 与对全部输入做稳定排序后的前limit个比较
+static void check_top_n(int count, int distinct, int limit) {
+  std::vector<Tuple> input = make_tuples(count, distinct);
+  std::vector<Tuple> expected(input);
+  std::stable_sort(expected.begin(), expected.end(), key_less);
+  if (limit >= 0 && limit < count) {
+    expected.erase(expected.begin() + limit, expected.end());
+  }
+
+  TupleTopN top_n(limit, key_less);
+  for (Tuple &tuple : input) {
+    top_n.add(std::move(tuple));
+  }
+  std::vector<Tuple> result;
+  top_n.finish(result);
+
+  ASSERT_EQ(expected.size(), result.size());
+  for (size_t i = 0; i < result.size(); i++) {
+    ASSERT_EQ(seq_of(expected[i]), seq_of(result[i])) << "position " << i;
+  }
+}
+
+TEST(test_top_n, compare_value) {
+  std::shared_ptr<TupleValue> null_value(new NullValue());
+  std::shared_ptr<TupleValue> minus_one(new IntValue(-1));
+  std::shared_ptr<TupleValue> minus_half(new FloatValue(-0.5));
+  std::shared_ptr<TupleValue> zero(new IntValue(0));
+  std::shared_ptr<TupleValue> float_zero(new FloatValue(0));
+  std::shared_ptr<TupleValue> one_and_half(new FloatValue(1.5));
+  std::shared_ptr<TupleValue> two(new IntValue(2));
+
+  // null排在最前
+  ASSERT_EQ(0, TupleSortUtil::compare_value(null_value, null_value));
+  ASSERT_LT(TupleSortUtil::compare_value(null_value, minus_one), 0);
+  ASSERT_GT(TupleSortUtil::compare_value(minus_one, null_value), 0);
+
+  // 整数之间直接比较，不经过float
+  std::shared_ptr<TupleValue> big(new IntValue(16777217));
+  std::shared_ptr<TupleValue> big_minus_one(new IntValue(16777216));
+  ASSERT_GT(TupleSortUtil::compare_value(big, big_minus_one), 0);
+  ASSERT_LT(TupleSortUtil::compare_value(big_minus_one, big), 0);
+
+  // 整数与浮点数按数值比较，包括负数
+  std::vector<std::shared_ptr<TupleValue>> ordered = {minus_one, minus_half, zero, one_and_half, two};
+  for (size_t i = 0; i < ordered.size(); i++) {
+    for (size_t j = 0; j < ordered.size(); j++) {
+      int ret = TupleSortUtil::compare_value(ordered[i], ordered[j]);
+      ASSERT_EQ((i > j) - (i < j), (ret > 0) - (ret < 0)) << i << " " << j;
+    }
+  }
+  ASSERT_EQ(0, TupleSortUtil::compare_value(zero, float_zero));
+
+  std::shared_ptr<TupleValue> abc(new StringValue("abc", 3));
+  std::shared_ptr<TupleValue> abd(new StringValue("abd", 3));
+  std::shared_ptr<TupleValue> ab(new StringValue("ab", 2));
+  ASSERT_LT(TupleSortUtil::compare_value(abc, abd), 0);
+  ASSERT_GT(TupleSortUtil::compare_value(abc, ab), 0);
+  ASSERT_EQ(0, TupleSortUtil::compare_value(abc, abc));
+}
+
+TEST(test_top_n, same_as_stable_sort) {
+  check_top_n(10000, 50, 1);
+  check_top_n(10000, 50, 10);
+  check_top_n(10000, 50, 777);
+  check_top_n(10000, 10000, 100);
+}
+
+TEST(test_top_n, limit_not_less_than_input) {
+  check_top_n(100, 10, 100);
+  check_top_n(100, 10, 1000);
+}
+
+TEST(test_top_n, limit_zero) {
+  check_top_n(100, 10, 0);
+}
+
+TEST(test_top_n, no_limit) {
+  check_top_n(5000, 20, -1);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}